@@ -4,6 +4,7 @@ include $(CLEAR_VARS)
 LOCAL_MODULE    := rtp_msg_server
 LOCAL_SRC_FILES := main.cpp          \
                    msg_db.cpp        \
+                   msg_db_writer.cpp \
                    msg_server.cpp    \
                    db_connection.cpp \
                    sqlite3.c
@@ -12,6 +12,7 @@ rm -rf ./test_msg_client/.deps
 rm -rf ./test_rtp/.deps
 rm -rf ./test_tcp_server/.deps
 rm -rf ./test_tcp_client/.deps
+rm -rf ./test_bench/.deps
 rm -rf ./cfg/.deps
 
 #
@@ -40,6 +41,10 @@ CPPFLAGS="-D_DEBUG                          \
           -DPRO_HAS_ATOMOP                  \
           -DPRO_HAS_ACCEPT4                 \
           -DPRO_HAS_EPOLL                   \
+          -DPRO_HAS_EVENTFD                 \
+          -DPRO_HAS_IO_URING                \
+          -DPRO_HAS_KTLS                    \
+          -DPRO_HAS_MSG_ZEROCOPY            \
           -DPRO_HAS_PTHREAD_EXPLICIT_SCHED" \
 CFLAGS="  -g -O0 -Wall -march=nocona -m64"  \
 CXXFLAGS="-g -O0 -Wall -march=nocona -m64"  \
@@ -104,6 +104,10 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_base_reactor.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_bulk_connector.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_connector.cpp
 # End Source File
 # Begin Source File
@@ -116,6 +120,10 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_handler_mgr.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_io_uring_reactor.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_mcast_transport.cpp
 # End Source File
 # Begin Source File
@@ -132,6 +140,14 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_notify_pipe.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_recv_slab.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_net\pro_ring_io.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_select_reactor.cpp
 # End Source File
 # Begin Source File
@@ -188,6 +204,10 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_base_reactor.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_bulk_connector.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_connector.h
 # End Source File
 # Begin Source File
@@ -204,6 +224,10 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_handler_mgr.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_io_uring_reactor.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_mcast_transport.h
 # End Source File
 # Begin Source File
@@ -220,6 +244,14 @@ SOURCE=..\..\..\src\pronet\pro_net\pro_recv_pool.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_net\pro_recv_slab.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_net\pro_ring_io.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_net\pro_select_reactor.h
 # End Source File
 # Begin Source File
@@ -120,6 +120,14 @@ SOURCE=..\..\..\src\pronet\pro_rtp\rtp_flow_stat.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_pacer.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_pacer.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_rtp\rtp_packet.cpp
 # End Source File
 # Begin Source File
@@ -168,6 +176,22 @@ SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_base.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_dtlsclient_ex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_dtlsclient_ex.h
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_dtlsserver_ex.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_dtlsserver_ex.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_mcast.cpp
 # End Source File
 # Begin Source File
@@ -270,6 +294,14 @@ SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_wrapper.cpp
 
 SOURCE=..\..\..\src\pronet\pro_rtp\rtp_session_wrapper.h
 # End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_udp_demux.cpp
+# End Source File
+# Begin Source File
+
+SOURCE=..\..\..\src\pronet\pro_rtp\rtp_udp_demux.h
+# End Source File
 # End Group
 # Begin Group "rtp_msg"
 
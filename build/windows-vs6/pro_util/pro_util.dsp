@@ -171,6 +171,10 @@ SOURCE=..\..\..\src\pronet\pro_util\pro_functor_command_task.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_util\pro_functor_command_task_pool.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_util\pro_log_file.cpp
 # End Source File
 # Begin Source File
@@ -259,6 +263,10 @@ SOURCE=..\..\..\src\pronet\pro_util\pro_functor_command_task.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\pro_util\pro_functor_command_task_pool.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\pro_util\pro_log_file.h
 # End Source File
 # Begin Source File
@@ -99,6 +99,10 @@ SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_db.cpp
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_db_writer.cpp
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_server.cpp
 # End Source File
 # End Group
@@ -111,6 +115,10 @@ SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_db.h
 # End Source File
 # Begin Source File
 
+SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_db_writer.h
+# End Source File
+# Begin Source File
+
 SOURCE=..\..\..\src\pronet\rtp_msg_server\msg_server.h
 # End Source File
 # End Group
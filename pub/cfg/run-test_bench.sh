@@ -0,0 +1,26 @@
+#!/bin/sh
+
+#
+# usage: run-test_bench.sh [scenario ...]
+#
+# The first run stores its results as the baseline. Later runs are compared
+# against it, and the exit code is non-zero if any metric regressed.
+#
+
+THIS_MOD=$(readlink -f "$0")
+THIS_DIR=$(dirname "${THIS_MOD}")
+
+RESULT="${THIS_DIR}/test_bench_result"
+BASELINE="${THIS_DIR}/test_bench_baseline.csv"
+
+if [ -f "${BASELINE}" ]
+then
+
+  "${THIS_DIR}/test_bench" -o "${RESULT}.json" -c "${RESULT}.csv" -b "${BASELINE}" "$@"
+
+else
+
+  "${THIS_DIR}/test_bench" -o "${RESULT}.json" -c "${RESULT}.csv" "$@" &&
+  cp -f "${RESULT}.csv" "${BASELINE}"
+
+fi
@@ -51,6 +51,13 @@ extern "C" {
  */
 int mbedtls_aesni_has_support( unsigned int what );
 
+/**
+ * \brief          Make mbedtls_aesni_has_support() report no feature
+ *
+ * \param enabled  0 to hide the CPU features, 1 to report them again
+ */
+void mbedtls_aesni_set_enabled( int enabled ); ////
+
 /**
  * \brief          AES-NI AES-ECB block en(de)cryption
  *
@@ -66,6 +73,21 @@ int mbedtls_aesni_crypt_ecb( mbedtls_aes_context *ctx,
                      const unsigned char input[16],
                      unsigned char output[16] );
 
+//// [[[[
+/**
+ * \brief          AES-NI AES-CTR over 4 blocks, which are interleaved
+ *
+ * \param ctx      AES context, set up for encryption
+ * \param ctr      4 counter blocks
+ * \param input    64-byte input
+ * \param output   64-byte output, which may be the same as input
+ */
+void mbedtls_aesni_crypt_ctr4( const mbedtls_aes_context *ctx,
+                               const unsigned char ctr[64],
+                               const unsigned char *input,
+                               unsigned char *output );
+//// ]]]]
+
 /**
  * \brief          GCM multiplication: c = a * b in GF(2^128)
  *
@@ -80,6 +102,23 @@ void mbedtls_aesni_gcm_mult( unsigned char c[16],
                      const unsigned char a[16],
                      const unsigned char b[16] );
 
+//// [[[[
+/**
+ * \brief          GCM multiplication over 4 blocks with one reduction:
+ *                 x = (x + b0) * h^4 + b1 * h^3 + b2 * h^2 + b3 * h
+ *
+ * \param x        The GHASH state, updated in place
+ * \param b        4 blocks
+ * \param h        h^4, h^3, h^2 and h, in this order
+ *
+ * \note           Requires SSSE3 besides CLMUL, which every CPU with
+ *                 AES-NI has.
+ */
+void mbedtls_aesni_gcm_mult4( unsigned char x[16],
+                              const unsigned char b[64],
+                              const unsigned char h[64] );
+//// ]]]]
+
 /**
  * \brief           Compute decryption round keys from encryption round keys
  *
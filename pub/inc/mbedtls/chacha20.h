@@ -205,6 +205,23 @@ int mbedtls_chacha20_crypt( const unsigned char key[32],
 int mbedtls_chacha20_self_test( int verbose );
 #endif /* MBEDTLS_SELF_TEST */
 
+//// [[[[
+/**
+ * \brief           Check if the SIMD path (4 blocks per call) is used.
+ *
+ * \return          \c 1 if it is compiled in and enabled, \c 0 otherwise.
+ */
+int mbedtls_chacha20_has_accel( void );
+
+/**
+ * \brief           Enable or disable the SIMD path, e.g. to compare it with
+ *                  the portable code. (Default: enabled)
+ *
+ * \param enabled   1 to enable, 0 to disable
+ */
+void mbedtls_chacha20_set_accel( int enabled );
+//// ]]]]
+
 #ifdef __cplusplus
 }
 #endif
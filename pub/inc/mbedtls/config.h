@@ -79,7 +79,11 @@ ProFree(void* p);
  *
  * Comment to disable the use of assembly code.
  */
-//// #define MBEDTLS_HAVE_ASM
+//// [[[[
+#if defined(__GNUC__) && ( defined(__amd64__) || defined(__x86_64__) )
+#define MBEDTLS_HAVE_ASM
+#endif
+//// ]]]]
 
 /**
  * \def MBEDTLS_NO_UDBL_DIVISION
@@ -1687,7 +1691,11 @@ ProFree(void* p);
  *
  * This modules adds support for the AES-NI instructions on x86-64
  */
-//// #define MBEDTLS_AESNI_C
+//// [[[[
+#if defined(__GNUC__) && ( defined(__amd64__) || defined(__x86_64__) )
+#define MBEDTLS_AESNI_C
+#endif
+//// ]]]]
 
 /**
  * \def MBEDTLS_AES_C
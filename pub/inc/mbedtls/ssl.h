@@ -192,6 +192,9 @@
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_DISABLED    0
 #define MBEDTLS_SSL_CBC_RECORD_SPLITTING_ENABLED     1
 
+#define MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_SERVER 0 ////
+#define MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_CLIENT 1 ////
+
 #define MBEDTLS_SSL_ARC4_ENABLED                0
 #define MBEDTLS_SSL_ARC4_DISABLED               1
 
@@ -1014,7 +1017,9 @@ struct mbedtls_ssl_config
 #if defined(MBEDTLS_SSL_SRV_C)
     unsigned int cert_req_ca_list : 1;  /*!< enable sending CA list in
                                           Certificate Request messages?     */
+    unsigned int respect_cli_pref : 1;  /*!< pick the client's first choice?  */ ////
 #endif
+    unsigned int keep_traffic_keys : 1; /*!< keep the keys for export?       */ ////
 };
 
 
@@ -1086,6 +1091,8 @@ struct mbedtls_ssl_context
     unsigned char *in_iv;       /*!< ivlen-byte IV                    */
     unsigned char *in_msg;      /*!< message contents (in_iv+ivlen)   */
     unsigned char *in_offt;     /*!< read offset in application data  */
+    size_t in_buf_len;          /*!< size of in_buf, 0 if released    */ ////
+    unsigned char in_ctr_saved[8]; /*!< TLS in_ctr while in_buf is released */ ////
 
     int in_msgtype;             /*!< record header: message type      */
     size_t in_msglen;           /*!< record header: message length    */
@@ -1121,6 +1128,7 @@ struct mbedtls_ssl_context
     unsigned char *out_len;     /*!< two-bytes message length field   */
     unsigned char *out_iv;      /*!< ivlen-byte IV                    */
     unsigned char *out_msg;     /*!< message contents (out_iv+ivlen)  */
+    size_t out_buf_len;         /*!< size of out_buf, 0 if released   */ ////
 
     int out_msgtype;            /*!< record header: message type      */
     size_t out_msglen;          /*!< record header: message length    */
@@ -1992,6 +2000,26 @@ void mbedtls_ssl_conf_ciphersuites_for_version( mbedtls_ssl_config *conf,
                                        const int *ciphersuites,
                                        int major, int minor );
 
+#if defined(MBEDTLS_SSL_SRV_C)
+//// [[[[
+/**
+ * \brief               Pick the ciphersuite by the order of the server or of
+ *                      the client. (Default: the client's order if
+ *                      MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE is defined,
+ *                      the server's order otherwise)
+ *
+ * \note                With the server's order, a client that offers a
+ *                      ChaCha20-Poly1305 suite first is taken to lack AES
+ *                      hardware, and the client's order is used for it.
+ *
+ * \param conf          SSL configuration
+ * \param order         MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_SERVER or
+ *                      MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_CLIENT
+ */
+void mbedtls_ssl_conf_preference_order( mbedtls_ssl_config *conf, int order );
+//// ]]]]
+#endif /* MBEDTLS_SSL_SRV_C */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 /**
  * \brief          Set the X.509 security profile used for verification
@@ -3124,6 +3152,89 @@ int mbedtls_ssl_send_alert_message( mbedtls_ssl_context *ssl,
  */
 int mbedtls_ssl_close_notify( mbedtls_ssl_context *ssl );
 
+//// [[[[
+/**
+ * \brief          Release the record buffers of an idle connection
+ *
+ * \param ssl      SSL context
+ *
+ * \return         0 if successful, or MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the
+ *                 handshake is not over.
+ *
+ * \note           A buffer that still holds a partial record, unread
+ *                 application data or unsent data is kept. Call this
+ *                 after mbedtls_ssl_read() has returned
+ *                 MBEDTLS_ERR_SSL_WANT_READ and all the writes are flushed.
+ *
+ * \note           The buffers are allocated again by the next call that
+ *                 needs them, e.g. mbedtls_ssl_read() or mbedtls_ssl_write().
+ *                 If a max_fragment_length was negotiated and renegotiation
+ *                 is disabled, they are cut down to the negotiated length.
+ */
+int mbedtls_ssl_release_buffers( mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          Return the number of bytes held by the record buffers
+ *
+ * \param ssl      SSL context
+ *
+ * \return         The sizes of the input and output buffers. 0 if both
+ *                 are released.
+ */
+size_t mbedtls_ssl_get_buffer_size( const mbedtls_ssl_context *ssl );
+
+/**
+ * \brief          The record protection state of an established connection,
+ *                 for handing the record layer over to another
+ *                 implementation, e.g. the Linux kernel TLS (kTLS)
+ */
+typedef struct
+{
+    mbedtls_cipher_type_t cipher;   /*!< AES-GCM or ChaCha20-Poly1305      */
+    size_t keylen;                  /*!< key length (bytes)                */
+    size_t fixed_ivlen;             /*!< 4 for AES-GCM, 12 for ChaCha20    */
+    unsigned char key_enc[32];      /*!< key (encryption)                  */
+    unsigned char key_dec[32];      /*!< key (decryption)                  */
+    unsigned char iv_enc[12];       /*!< fixed IV (encryption)             */
+    unsigned char iv_dec[12];       /*!< fixed IV (decryption)             */
+    unsigned char ctr_enc[8];       /*!< next outgoing record sequence     */
+    unsigned char ctr_dec[8];       /*!< next incoming record sequence     */
+}
+mbedtls_ssl_traffic_keys;
+
+/**
+ * \brief          Keep the symmetric keys of the connections set up with
+ *                 this configuration, so that
+ *                 mbedtls_ssl_export_traffic_keys() can hand them over
+ *                 (Default: 0, the keys only live in the cipher contexts)
+ *
+ * \param conf     SSL configuration
+ * \param keep     1 to keep, 0 not to keep
+ */
+void mbedtls_ssl_conf_keep_traffic_keys( mbedtls_ssl_config *conf, int keep );
+
+/**
+ * \brief          Export the record protection state of a TLS 1.2
+ *                 connection using an AEAD ciphersuite
+ *
+ * \param ssl      SSL context
+ * \param keys     the state. Zeroize it after use
+ *
+ * \return         0 if successful, MBEDTLS_ERR_SSL_BAD_INPUT_DATA if the
+ *                 handshake is not over or a record is half read or unsent,
+ *                 or MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE if the keys were
+ *                 not kept or exported already, or the connection is not
+ *                 TLS 1.2 over a stream with AES-GCM or ChaCha20-Poly1305.
+ *
+ * \note           The kept keys are wiped, so this succeeds only once.
+ *                 After that the context can only send a close_notify
+ *                 alert or be freed, since its sequence numbers would go
+ *                 out of sync with the new owner of the record layer.
+ */
+int mbedtls_ssl_export_traffic_keys( mbedtls_ssl_context *ssl,
+                                     mbedtls_ssl_traffic_keys *keys );
+//// ]]]]
+
 /**
  * \brief          Free referenced items in an SSL context and clear memory
  *
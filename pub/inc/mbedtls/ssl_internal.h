@@ -415,6 +415,8 @@ struct mbedtls_ssl_transform
 
     unsigned char iv_enc[16];           /*!<  IV (encryption)         */
     unsigned char iv_dec[16];           /*!<  IV (decryption)         */
+    unsigned char key_enc[32];          /*!<  kept key (encryption)   */ ////
+    unsigned char key_dec[32];          /*!<  kept key (decryption)   */ ////
 
 #if defined(MBEDTLS_SSL_PROTO_SSL3)
     /* Needed only for SSL v3.0 secret */
@@ -63,9 +63,9 @@ public:
 
 private:
 
-    CProStlMap<CProFunctorCommandTask*, unsigned long> m_task2Channels;
-    CProStlMap<PRO_UINT64, CProFunctorCommandTask*>    m_channelId2Task;
-    mutable CProThreadMutex                            m_lock;
+    CProStlMap<CProFunctorCommandTask*, unsigned long>  m_task2Channels;
+    CProStlHashMap<PRO_UINT64, CProFunctorCommandTask*> m_channelId2Task;
+    mutable CProThreadMutex                             m_lock;
 
     DECLARE_SGI_POOL(0)
 };
@@ -18,6 +18,11 @@
 
 /*
  * This is an implementation of the "Active Object" pattern.
+ *
+ * With one thread, the commands are queued in a lock-free MPSC queue by
+ * default. The producers push them with a CAS, and the thread takes all of
+ * them at once, and spins for a while before it sleeps. A producer signals
+ * the thread only if it's asleep.
  */
 
 #if !defined(____PRO_FUNCTOR_COMMAND_TASK_H____)
@@ -45,9 +50,13 @@ public:
 
     virtual ~CProFunctorCommandTask();
 
+    /*
+     * the "lockFree" is valid only if the "threadCount" is 1
+     */
     bool Start(
         bool          realtime    = false,
-        unsigned long threadCount = 1
+        unsigned long threadCount = 1,
+        bool          lockFree    = true
         );
 
     void Stop();
@@ -67,14 +76,27 @@ private:
 
     void StopMe();
 
+    bool PutLockFree(
+        IProFunctorCommand* command,
+        bool                blocking
+        );
+
     virtual void Svc();
 
+    void SvcLockFree();
+
 private:
 
     const void*                       m_userData;
     unsigned long                     m_threadCount;
     unsigned long                     m_curThreadCount;
     bool                              m_wantExit;
+    bool                              m_lockFree;
+    IProFunctorCommand* volatile      m_head;      /* LIFO, linked by the user data */
+    volatile long                     m_size;
+    volatile long                     m_putCount;  /* PutLockFree() calls in progress */
+    volatile long                     m_sleeping;
+    volatile long                     m_exitState; /* 1: no more Put(), 2: can exit */
     CProStlSet<PRO_UINT64>            m_threadIds;
     CProStlDeque<IProFunctorCommand*> m_commands;
     CProThreadMutexCondition          m_commandCond;
@@ -0,0 +1,140 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+/*
+ * A multi-threaded variant of CProFunctorCommandTask.
+ *
+ * The commands are hashed by their keys into slots. A slot is a FIFO, and is
+ * run by at most one thread at a time, so the commands with the same key are
+ * executed in order, and the others are executed in parallel.
+ *
+ * A slot with pending commands is scheduled to the inbox of its home thread.
+ * Each thread moves its inbox into a lock-free work-stealing deque, and an
+ * idle thread steals slots from the others.
+ */
+
+#if !defined(____PRO_FUNCTOR_COMMAND_TASK_POOL_H____)
+#define ____PRO_FUNCTOR_COMMAND_TASK_POOL_H____
+
+#include "pro_a.h"
+#include "pro_memory_pool.h"
+#include "pro_stl.h"
+#include "pro_thread.h"
+#include "pro_thread_mutex.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class IProFunctorCommand;
+struct PRO_TASK_POOL_SLOT;
+struct PRO_TASK_POOL_WORKER;
+
+struct PRO_TASK_POOL_STATS
+{
+    unsigned long threadCount;
+    unsigned long pendingCount;    /* commands put but not started */
+    unsigned long maxPendingCount;
+    PRO_UINT64    doneCount;
+    PRO_UINT64    stealCount;      /* slot runs by a thread other than the home one */
+    PRO_UINT64    avgWaitMs;       /* from Put() to Execute() */
+    PRO_UINT64    maxWaitMs;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CProFunctorCommandTaskPool : public CProThreadBase
+{
+public:
+
+    CProFunctorCommandTaskPool();
+
+    virtual ~CProFunctorCommandTaskPool();
+
+    /*
+     * the "threadCount" can be 0, which means the number of processors
+     */
+    bool Start(
+        unsigned long threadCount = 0,
+        bool          realtime    = false
+        );
+
+    void Stop();
+
+    /*
+     * the commands with the same "key" are executed in order
+     */
+    bool Put(
+        PRO_UINT64          key,
+        IProFunctorCommand* command,
+        bool                blocking = false
+        );
+
+    unsigned long GetSize() const;
+
+    void GetStats(PRO_TASK_POOL_STATS* stats) const;
+
+private:
+
+    void StopMe();
+
+    virtual void Svc();
+
+    bool FindWork(
+        unsigned long  index,
+        unsigned long& slotIndex,
+        bool&          stolen
+        );
+
+    bool HasWork() const;
+
+    void RunSlot(
+        unsigned long index,
+        unsigned long slotIndex,
+        bool          stolen
+        );
+
+    void Schedule(unsigned long slotIndex);
+
+    void Wake(unsigned long index);
+
+private:
+
+    unsigned long            m_threadCount;
+    unsigned long            m_curThreadCount;
+    PRO_TASK_POOL_SLOT*      m_slots;
+    PRO_TASK_POOL_WORKER*    m_workers;
+    volatile long            m_pendingCount;
+    volatile long            m_maxPendingCount;
+    volatile long            m_idleCount;
+    volatile long            m_putCount;    /* Put() calls in progress */
+    volatile long            m_wantExit;
+    volatile long            m_canExit;
+    CProThreadMutexCondition m_initCond;
+    mutable CProThreadMutex  m_lock;
+    CProThreadMutex          m_lockAtom;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* ____PRO_FUNCTOR_COMMAND_TASK_POOL_H____ */
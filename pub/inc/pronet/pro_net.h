@@ -107,6 +107,7 @@ extern "C" {
 #include "pro_ssl.h"
 
 class  IProAcceptor;      /*  */
+class  IProBulkConnector; /*  */
 class  IProConnector;     /*  */
 class  IProServiceHost;   /* host */
 class  IProServiceHub;    /* hub */
@@ -135,6 +136,115 @@ struct PRO_NONCE
     char nonce[32];
 };
 
+/*
+ * [[[[ Ӧ߳
+ */
+typedef unsigned char PRO_REACTOR_THREAD_TYPE;
+
+static const PRO_REACTOR_THREAD_TYPE PRO_RTT_ACCEPT  = 1;
+static const PRO_REACTOR_THREAD_TYPE PRO_RTT_IO      = 2;
+static const PRO_REACTOR_THREAD_TYPE PRO_RTT_TIMER   = 3;
+static const PRO_REACTOR_THREAD_TYPE PRO_RTT_MMTIMER = 4;
+/*
+ * ]]]]
+ */
+
+/*
+ * [[[[ Ӧ
+ */
+typedef unsigned char PRO_REACTOR_BACKEND;
+
+static const PRO_REACTOR_BACKEND PRO_RB_DEFAULT  = 0; /* epollselect */
+static const PRO_REACTOR_BACKEND PRO_RB_IO_URING = 1; /* Linux io_uring */
+/*
+ * ]]]]
+ */
+
+/*
+ * Ӧ̵߳ͳϢ
+ *
+ * handlerCounttimerCountΪǰֵ, Ϊ߳ۼֵ.
+ * ʹ߿ζȡ, õһʱڵ
+ *
+ * շ̺߳ͽ߳, histogramΪÿѭæµʱ(ȴ)ķֲ;
+ * ڶʱ߳, histogramΪʱӳ(ʵƻʱ֮)ķֲ.
+ * ͰϽΪ10us, 100us, 1ms, 10ms, 100ms, 1s, 10s, һͰûϽ
+ */
+struct PRO_REACTOR_STATS
+{
+    PRO_REACTOR_THREAD_TYPE threadType;
+    PRO_REACTOR_BACKEND     backend;         /* ʵʹõĺ(շ/߳) */
+    char                    reserved[6];
+    PRO_UINT64              handlerCount;    /* ǰ׽(շ/߳) */
+    PRO_UINT64              timerCount;      /* ǰĶʱ(ʱ߳) */
+    PRO_UINT64              loopCount;       /* ѭ */
+    PRO_UINT64              loopBusyUs;      /* ѭæµʱ(us) */
+    PRO_UINT64              loopBusyMaxUs;   /* ѭæµʱ(us) */
+    PRO_UINT64              eventCount;      /* ¼ڶʱ */
+    PRO_UINT64              eventMaxPerLoop; /* ѭ¼ */
+    PRO_UINT64              upcallCount;     /* ص */
+    PRO_UINT64              upcallUs;        /* صʱ(us) */
+    PRO_UINT64              upcallMaxUs;     /* λصʱ(us) */
+    PRO_UINT64              notifyCount;     /* ֪ͨܵѵĴ */
+    PRO_UINT64              timerLagUs;      /* ʱӳ(us), Ϊ1ms */
+    PRO_UINT64              timerLagMaxUs;   /* ʱӳ(us) */
+    PRO_UINT64              histogram[PRO_STAT_HISTOGRAM_SIZE];
+};
+
+/*
+ * ķͳϢ
+ *
+ * zcPendingCount, tlsBufBytes, tlsMaxFragLentlsKtlsΪǰֵ, Ϊ
+ * ۼֵ
+ *
+ * 㿽ͽڿ㿽tcp. μIProTransport::EnableZeroCopy(...)
+ *
+ * tls*ssl. μProSslServerConfig_EnableLeanBuffers(...)
+ * ProSslServerConfig_EnableKtls(...)
+ */
+struct PRO_TRANSPORT_STATS
+{
+    PRO_UINT64 copySendCount;   /* Ƶͳصķʹ */
+    PRO_UINT64 copySendBytes;   /* Ƶͳصֽ */
+    PRO_UINT64 zcSendCount;     /* 㿽ķʹ */
+    PRO_UINT64 zcSendBytes;     /* 㿽ֽ */
+    PRO_UINT64 zcDoneCount;     /* ں֪ͨɵ㿽ʹ */
+    PRO_UINT64 zcCopiedCount;   /* ںʵ˸ƵĴ */
+    PRO_UINT64 zcPendingCount;  /* ȴں֪ͨɵ㿽ʹ */
+    PRO_UINT64 tlsBufBytes;     /* SSL/TLS¼ֽ */
+    PRO_UINT64 tlsReleaseCount; /* ʱͷż¼Ĵ */
+    PRO_UINT64 tlsMaxFragLen;   /* ͼ¼󳤶 */
+    PRO_UINT64 tlsKtls;         /* ں˼ӽܵķ. PRO_SSL_KTLS_TX/RX */
+};
+
+/*
+ * ճذͳϢ
+ *
+ * borrowCountoverflowCountΪۼֵ, Ϊǰֵֵ.
+ * μIProReactor::SetRecvSlabCap(...)
+ */
+struct PRO_RECV_SLAB_STATS
+{
+    PRO_UINT64 maxSlabCount;     /* slab */
+    PRO_UINT64 leanPoolCount;    /* Ľճ */
+    PRO_UINT64 busySlabCount;    /* slab */
+    PRO_UINT64 busySlabBytes;    /* slabֽ */
+    PRO_UINT64 maxBusySlabCount; /* slabķֵ */
+    PRO_UINT64 freeSlabCount;    /* еslab */
+    PRO_UINT64 borrowCount;      /*  */
+    PRO_UINT64 overflowCount;    /* ʱ޵Ĵ */
+};
+
+/*
+ * ӵĿ. μProBulkConnect(...)
+ */
+struct PRO_CONNECT_TARGET
+{
+    const char*    remoteIp;    /* Զ˵ipַ */
+    unsigned short remotePort;  /* Զ˵Ķ˿ں */
+    const char*    localBindIp; /* Ҫ󶨵ıipַ. ΪNULL */
+};
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -236,6 +346,37 @@ public:
         char*  buf,
         size_t size
         ) const = 0;
+
+    /*
+     * ȡ̵߳ͳϢ
+     *
+     * Ϊ߳, շ߳, ͨʱ߳, ý嶨ʱ߳.
+     * С, ʺ϶ڶȡ
+     *
+     * ֵΪĸ. statsΪNULL, 򷵻ĸ
+     */
+    virtual unsigned long PRO_CALLTYPE GetStats(
+        PRO_REACTOR_STATS* stats,
+        unsigned long      count
+        ) const = 0;
+
+    /*
+     * tcp/sslճصİ
+     *
+     * maxSlabCountΪ0ʾر(Ĭ), ʾ÷Ӧslab.
+     * , ֮󴴽tcp/sslĽճΪʱֻһС,
+     * Ҫݴ治Ϣʱ, ŴӸ÷Ӧslabһ
+     * ճ, ճرպ黹. ޵slabڹ黹ʱͷŵ.
+     * ʺϴӵĳ, c2sϵmsgͻ
+     */
+    virtual void PRO_CALLTYPE SetRecvSlabCap(unsigned long maxSlabCount) = 0;
+
+    /*
+     * ȡճذͳϢ
+     */
+    virtual void PRO_CALLTYPE GetRecvSlabStats(
+        PRO_RECV_SLAB_STATS* stats
+        ) const = 0;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -476,6 +617,20 @@ public:
     virtual unsigned long PRO_CALLTYPE GetFreeSize() const = 0;
 };
 
+/*
+ * ü
+ *
+ * 㿽. , ֱں˲ٷ
+ */
+class IProRefObject
+{
+public:
+
+    virtual unsigned long PRO_CALLTYPE AddRef() = 0;
+
+    virtual unsigned long PRO_CALLTYPE Release() = 0;
+};
+
 /*
  * 
  */
@@ -605,6 +760,36 @@ public:
     virtual void PRO_CALLTYPE UdpConnResetAsError(
         const pbsd_sockaddr_in* remoteAddr
         ) = 0;
+
+    /*
+     * 㿽(for CProTcpTransport only)
+     *
+     * , СthresholdֽڵSendDataZeroCopy(...)ʹMSG_ZEROCOPY,
+     * ݲٸƵͳ. thresholdΪ0ʱ, ʹĬֵ(1024 * 16).
+     * ҪLinux 4.14. ֮󲻿
+     *
+     * false, ʾ֧, SendDataZeroCopy(...)ͬSendData(...)
+     */
+    virtual bool PRO_CALLTYPE EnableZeroCopy(size_t threshold) = 0;
+
+    /*
+     * (㿽)
+     *
+     * SendData(...)ͬ. 㿽, sizeСֵ, ô
+     * holder, ֱں֪ͨ. ڴ֮ǰ, ϲ㲻޸buf.
+     * , ݽƵͳ
+     */
+    virtual bool PRO_CALLTYPE SendDataZeroCopy(
+        const void*    buf,
+        size_t         size,
+        IProRefObject* holder,
+        PRO_UINT64     actionId = 0
+        ) = 0;
+
+    /*
+     * ȡͳϢ
+     */
+    virtual void PRO_CALLTYPE GetStats(PRO_TRANSPORT_STATS* stats) const = 0;
 };
 
 /*
@@ -720,6 +905,30 @@ PRO_CALLTYPE
 ProCreateReactor(unsigned long ioThreadCount,
                  long          ioThreadPriority = 0);
 
+/*
+ * : һӦ, ָ
+ *
+ * :
+ * ioThreadCount    : շ¼߳
+ * ioThreadPriority : շ̵߳ȼ(0/1/2)
+ * backend          : Ӧ
+ *
+ * ֵ: ӦNULL
+ *
+ * ˵: ProCreateReactor(...)ʹPRO_RB_DEFAULT.
+ *       PRO_RB_IO_URINGҪʱPRO_HAS_IO_URING, Ҫں˵֧
+ *       (Linux 6.0+), 䵽PRO_RB_DEFAULT. ʵʹõĺ˿ͨ
+ *       IProReactor::GetStats(...)õ.
+ *       PRO_RB_IO_URING, TCPӺTCP˿ɷʽշ(multishot
+ *       accept/recvsend), UDP/SSL/unix socketpollʽ
+ */
+PRO_NET_API
+IProReactor*
+PRO_CALLTYPE
+ProCreateReactorEx(unsigned long       ioThreadCount,
+                   long                ioThreadPriority,
+                   PRO_REACTOR_BACKEND backend);
+
 /*
  * : ɾһӦ
  *
@@ -890,6 +1099,74 @@ void
 PRO_CALLTYPE
 ProDeleteConnector(IProConnector* connector);
 
+/*
+ * : һ
+ *
+ * :
+ * enableServiceExt  : ǷʹչЭ
+ * serviceId         : id. չЭ
+ * serviceOpt        : ѡ. չЭ
+ * observer          : صĿ
+ * reactor           : Ӧ
+ * connectsPerSecond : ÿշ߳ÿ뷢. Ĭ2000
+ * timeoutInSeconds  : ÿӵĳʱ. Ĭ20
+ *
+ * ֵ: NULL
+ *
+ * ˵: ѹԻҪһηӵĳ.
+ *       ͨProBulkConnect(...)ͶĿ, ɸշֱ߳ӷ,
+ *       ӵĳʱһĶʱ, ΪÿӴʱ
+ *       . ÿĿĽͨobserverص, connectorΪ
+ *       תɵIProConnector*.
+ *       ֧unix׽.
+ *       ʹProDeleteBulkConnector(...)ɾ
+ */
+PRO_NET_API
+IProBulkConnector*
+PRO_CALLTYPE
+ProCreateBulkConnector(bool                   enableServiceExt,
+                       unsigned char          serviceId,
+                       unsigned char          serviceOpt,
+                       IProConnectorObserver* observer,
+                       IProReactor*           reactor,
+                       unsigned long          connectsPerSecond = 0,
+                       unsigned long          timeoutInSeconds  = 0);
+
+/*
+ * : ͶһĿ
+ *
+ * :
+ * connector : 
+ * targets   : Ŀ
+ * count     : Ŀ
+ *
+ * ֵ: ܵĿ. ַǷĿ꽫, Ҳص
+ *
+ * ˵: Ŀ걻շ߳, Ŷӷ.
+ *       ͬһĿظ, ÿγֶӦһ
+ */
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProBulkConnect(IProBulkConnector*        connector,
+               const PRO_CONNECT_TARGET* targets,
+               unsigned long             count);
+
+/*
+ * : ɾһ
+ *
+ * :
+ * connector : 
+ *
+ * ֵ: 
+ *
+ * ˵: Ŷкͽеӽ, Ҳص
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProDeleteBulkConnector(IProBulkConnector* connector);
+
 /*
  * : һtcp
  *
@@ -1046,6 +1323,41 @@ ProCreateUdpTransport(IProTransportObserver* observer,
                       const char*            defaultRemoteIp   = NULL,
                       unsigned short         defaultRemotePort = 0);
 
+/*
+ * : һɶԶ˹udp
+ *
+ * :
+ * observer        : صĿ
+ * reactor         : Ӧ
+ * localIp         : Ҫ󶨵ıipַ. ΪNULL, ϵͳʹ0.0.0.0
+ * localPort       : Ҫ󶨵ıض˿ں. Ϊ0, ϵͳһ
+ * sockBufSizeRecv : ׽ֵϵͳջֽ. Ĭauto
+ * sockBufSizeSend : ׽ֵϵͳͻֽ. Ĭauto
+ * recvPoolSize    : ճصֽ. Ĭ(1024 * 65)
+ * reusePort       : ǷSO_REUSEPORT, ʹͬһ˿
+ *
+ * ֵ: NULL
+ *
+ * ˵: ProCreateUdpTransport(...):
+ *       (1)SendData(...)ֱӷ, ȴҲOnSend(...). ʧʱ,
+ *          ԵRequestOnSend(...)ȴһOnSend(...);
+ *       (2)epollӦΪش, һλѿնݱ;
+ *       (3)UdpConnResetAsError(...)Ч.
+ *       reusePortΪtrueʱ, ں˰Ԫݱɵ׽.
+ *       ϵͳ֧SO_REUSEPORTʱ, reusePortΪtrue´ʧ
+ */
+PRO_NET_API
+IProTransport*
+PRO_CALLTYPE
+ProCreateUdpTransportEx(IProTransportObserver* observer,
+                        IProReactor*           reactor,
+                        const char*            localIp         = NULL,
+                        unsigned short         localPort       = 0,
+                        size_t                 sockBufSizeRecv = 0,
+                        size_t                 sockBufSizeSend = 0,
+                        size_t                 recvPoolSize    = 0,
+                        bool                   reusePort       = false);
+
 /*
  * : һಥ
  *
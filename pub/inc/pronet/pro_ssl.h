@@ -35,6 +35,9 @@ struct PRO_SSL_CLIENT_CONFIG; /* derived from mbedtls_ssl_config */
 struct PRO_SSL_CTX;           /* derived from mbedtls_ssl_context */
 struct PRO_SSL_SERVER_CONFIG; /* derived from mbedtls_ssl_config */
 
+class  IProTransport;         /* for dtls */
+struct pbsd_sockaddr_in;      /* for dtls */
+
 /*
  * [[[[ authentication levels
  */
@@ -47,6 +50,15 @@ static const PRO_SSL_AUTH_LEVEL PRO_SSL_AUTHLV_REQUIRED = (PRO_SSL_AUTH_LEVEL)2;
  * ]]]]
  */
 
+/*
+ * [[[[ kTLS directions. please refer to ProSslCtx_EnableKtls(...)
+ */
+static const unsigned long PRO_SSL_KTLS_TX = 0x01; /* ں˼ܷ */
+static const unsigned long PRO_SSL_KTLS_RX = 0x02; /* ں˽ܽ */
+/*
+ * ]]]]
+ */
+
 /*
  * [[[[ SSL/TLS suites
  *
@@ -120,7 +132,8 @@ ProSslServerConfig_Delete(PRO_SSL_SERVER_CONFIG* config);
  *
  * :
  * config     : SSLö
- * suites     : ׼б. ͻ˵׼б˳
+ * suites     : ׼б. Ĭϰб˳ѡ,
+ *              μProSslServerConfig_EnableServerPreference()
  * suiteCount : б
  *
  * ֵ: trueɹ, falseʧ
@@ -339,6 +352,63 @@ ProSslServerConfig_SetSniAuthLevel(PRO_SSL_SERVER_CONFIG* config,
                                    const char*            sniName,
                                    PRO_SSL_AUTH_LEVEL     level);
 
+/*
+ * : ǷӿʱͷSSL/TLS¼
+ *
+ * :
+ * config : SSLö
+ * enable : trueͷ, falseͷ
+ *
+ * ֵ: 
+ *
+ * ˵: Ĭϲͷ. ÿӵշ¼Լ17KB, ڴеĳ,
+ *       Խʡ󲿷ڴ. ´շʱ·, client
+ *       Эmax_fragment_length, Э̵ĳȷ
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableLeanBuffers(PRO_SSL_SERVER_CONFIG* config,
+                                     bool                   enable);
+
+/*
+ * : Ƿserver׼б˳ѡ׼
+ *
+ * :
+ * config : SSLö
+ * enable : trueserver˳, falseclient˳
+ *
+ * ֵ: 
+ *
+ * ˵: Ĭϰserver˳. Ĭϵ׼бCPU, AESָʱAES-GCM
+ *       , ChaCha20-Poly1305. clientChaCha20-Poly1305
+ *       λ(ͨûAESָ), Ըclientclient˳ѡ
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableServerPreference(PRO_SSL_SERVER_CONFIG* config,
+                                          bool                   enable);
+
+/*
+ * : ǷɺѼ¼ļӽܽLinuxں(kTLS)
+ *
+ * :
+ * config : SSLö
+ * enable : trueں, falseں
+ *
+ * ֵ: 
+ *
+ * ˵: Ĭϲں. LinuxϵTLS 1.2 AES-GCMChaCha20-Poly1305
+ *       . ںûмtlsģָ֧׼ʱ, mbedtlsӽ.
+ *       μProSslCtx_EnableKtls(...)
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableKtls(PRO_SSL_SERVER_CONFIG* config,
+                              bool                   enable);
+
 /*-------------------------------------------------------------------------*/
 
 /*
@@ -491,6 +561,59 @@ PRO_CALLTYPE
 ProSslClientConfig_SetAuthLevel(PRO_SSL_CLIENT_CONFIG* config,
                                 PRO_SSL_AUTH_LEVEL     level);
 
+/*
+ * : ǷӿʱͷSSL/TLS¼
+ *
+ * :
+ * config : SSLö
+ * enable : trueͷ, falseͷ
+ *
+ * ֵ: 
+ *
+ * ˵: μProSslServerConfig_EnableLeanBuffers(...)
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslClientConfig_EnableLeanBuffers(PRO_SSL_CLIENT_CONFIG* config,
+                                     bool                   enable);
+
+/*
+ * : serverЭ̵ļ¼󳤶(max_fragment_length)
+ *
+ * :
+ * config  : SSLö
+ * fragLen : ¼󳤶. 512, 1024, 2048, 4096, 0ʾЭ
+ *
+ * ֵ: trueɹ, falseʧ
+ *
+ * ˵: ĬϲЭ. ָ֧չserverԸ.
+ *       ProSslClientConfig_EnableLeanBuffers(...)ʹ, С
+ *       ӵļ¼
+ */
+PRO_NET_API
+bool
+PRO_CALLTYPE
+ProSslClientConfig_SetMaxFragLen(PRO_SSL_CLIENT_CONFIG* config,
+                                 size_t                 fragLen);
+
+/*
+ * : ǷɺѼ¼ļӽܽLinuxں(kTLS)
+ *
+ * :
+ * config : SSLö
+ * enable : trueں, falseں
+ *
+ * ֵ: 
+ *
+ * ˵: μProSslServerConfig_EnableKtls(...)
+ */
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslClientConfig_EnableKtls(PRO_SSL_CLIENT_CONFIG* config,
+                              bool                   enable);
+
 /*-------------------------------------------------------------------------*/
 
 /*
@@ -588,6 +711,206 @@ const char*
 PRO_CALLTYPE
 ProSslCtx_GetAlpn(PRO_SSL_CTX* ctx);
 
+/*
+ * : ͷſӵļ¼
+ *
+ * :
+ * ctx : SSLĶ
+ *
+ * ֵ: ͷŵֽ
+ *
+ * ˵: SSLÿ˻ͷʱЧ. δδݵ
+ *       ᱻͷ. μProSslServerConfig_EnableLeanBuffers(...)
+ */
+PRO_NET_API
+size_t
+PRO_CALLTYPE
+ProSslCtx_ReleaseBuffers(PRO_SSL_CTX* ctx);
+
+/*
+ * : ȡ¼ռõֽ
+ *
+ * :
+ * ctx : SSLĶ
+ *
+ * ֵ: շ¼ֽ
+ *
+ * ˵: 
+ */
+PRO_NET_API
+size_t
+PRO_CALLTYPE
+ProSslCtx_GetBufferSize(PRO_SSL_CTX* ctx);
+
+/*
+ * : Ѽ¼ļӽܽLinuxں(kTLS)
+ *
+ * :
+ * ctx : SSLĶ
+ *
+ * ֵ: ں˵ķ. PRO_SSL_KTLS_TX, PRO_SSL_KTLS_RX, 0ʾ
+ *         mbedtlsӽ
+ *
+ * ˵: SSLÿkTLSʱЧ. μProSslServerConfig_EnableKtls(...)
+ *
+ *       SSL/TLSɺ, շӦǰ. sslڳʼʱ.
+ *       ں˵ķ, ʹӦֱ׽շ, ٵmbedtls
+ *       շ. 򶼽ں˺, ¼ͷ.
+ *
+ *       Ŷ, Ŷֽ(16KB)շ֮ǰں
+ */
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProSslCtx_EnableKtls(PRO_SSL_CTX* ctx);
+
+/*
+ * : ȡں˼ӽܵķ
+ *
+ * :
+ * ctx : SSLĶ
+ *
+ * ֵ: PRO_SSL_KTLS_TX, PRO_SSL_KTLS_RX
+ *
+ * ˵: 
+ */
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProSslCtx_GetKtls(PRO_SSL_CTX* ctx);
+
+/*
+ * : һDTLS
+ *
+ * :
+ * config : SSLö
+ * trans  : udp. ڷDTLS¼
+ *
+ * ֵ: SSLĶNULL
+ *
+ * ˵: DTLSĸһconfig, Ϊݱ. ֤, ׼
+ *       config, configڱ볤, Ҵ֮Ӧ
+ *       ޸config
+ *
+ *       ˿cookie(HelloVerifyRequest). δЧcookie
+ *       ClientHelloֻõһСӦ, ᴥ֤鷢ͺԿ
+ */
+PRO_NET_API
+PRO_SSL_CTX*
+PRO_CALLTYPE
+ProSslCtx_CreateDtlss(const PRO_SSL_SERVER_CONFIG* config,
+                      IProTransport*               trans);
+
+/*
+ * : һͻDTLS
+ *
+ * :
+ * config         : SSLö
+ * serverHostName : server. Ч, ֤server֤
+ * trans          : udp. ڷDTLS¼, ĬϵԶ˵ַ
+ *
+ * ֵ: SSLĶNULL
+ *
+ * ˵: μProSslCtx_CreateDtlss(...)
+ */
+PRO_NET_API
+PRO_SSL_CTX*
+PRO_CALLTYPE
+ProSslCtx_CreateDtlsc(const PRO_SSL_CLIENT_CONFIG* config,
+                      const char*                  serverHostName, /* = NULL */
+                      IProTransport*               trans);
+
+/*
+ * : ƽDTLS
+ *
+ * :
+ * ctx        : DTLSĶ
+ * datagram   : յݱ. NULLʾشʱ
+ * size       : ݱֽ
+ * remoteAddr : ݱԴַ
+ *
+ * ֵ: 1, 0ֽ, <0ʧ(mbedtls)
+ *
+ * ˵: յݱʱ, ӦԵ(100)NULL, Ա
+ *       ʱشϢ
+ *
+ *       cookie֤֮ͨǰ, Դݱ; ֤֮ͨ,
+ *       ֻܸԴݱ
+ */
+PRO_NET_API
+long
+PRO_CALLTYPE
+ProSslCtx_DtlsHandshake(PRO_SSL_CTX*            ctx,
+                        const void*             datagram,
+                        size_t                  size,
+                        const pbsd_sockaddr_in* remoteAddr);
+
+/*
+ * : һDTLSݱ
+ *
+ * :
+ * ctx        : DTLSĶ
+ * datagram   : յݱ. NULLʾȡݱʣļ¼
+ * size       : ݱֽ
+ * remoteAddr : ݱԴַ
+ * buf        : Ļ
+ * bufSize    : Ļֽ
+ *
+ * ֵ: >0ĵֽ, 0, <0ʧܻԶ˹ر(mbedtls)
+ *
+ * ˵: ɺ. һݱЯ¼, >0ʱ, ʹӦ
+ *       NULL, ֱֵ<=0
+ *
+ *       ط, ۸ĻԴݱĬ, 0
+ */
+PRO_NET_API
+long
+PRO_CALLTYPE
+ProSslCtx_DtlsRecv(PRO_SSL_CTX*            ctx,
+                   const void*             datagram,
+                   size_t                  size,
+                   const pbsd_sockaddr_in* remoteAddr,
+                   void*                   buf,
+                   size_t                  bufSize);
+
+/*
+ * : ܷһDTLS¼
+ *
+ * :
+ * ctx  : DTLSĶ
+ * buf  : 
+ * size : ĵֽ
+ *
+ * ֵ: trueɹ, falseʧ
+ *
+ * ˵: һεöӦһ¼, һݱ. udpͬ, ݱܶʧ.
+ *       æʱfalse, ü¼, OnSend()
+ */
+PRO_NET_API
+bool
+PRO_CALLTYPE
+ProSslCtx_DtlsSend(PRO_SSL_CTX* ctx,
+                   const void*  buf,
+                   size_t       size);
+
+/*
+ * : ѧȫ
+ *
+ * :
+ * buf  : 
+ * size : ֽ
+ *
+ * ֵ: trueɹ, falseʧ
+ *
+ * ˵: ϵͳԴֵCTR_DRBG, , Կ.
+ *       ṵ́߳ȫ
+ */
+PRO_NET_API
+bool
+PRO_CALLTYPE
+ProSslRandom(void*  buf,
+             size_t size);
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -117,6 +117,14 @@ ProSha256All(const void* buf,
              size_t      size,
              char        hashValue[32]);
 
+void
+PRO_CALLTYPE
+ProHmacSha256All(const void* key,
+                 size_t      keySize,
+                 const void* buf,
+                 size_t      size,
+                 char        hashValue[32]);
+
 /*-------------------------------------------------------------------------*/
 
 void*
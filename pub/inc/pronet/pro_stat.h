@@ -133,4 +133,11 @@ private:
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+unsigned long
+PRO_CALLTYPE
+ProStatHistogramIndex(PRO_INT64 durationInUs);
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 #endif /* ____PRO_STAT_H____ */
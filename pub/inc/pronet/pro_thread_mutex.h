@@ -180,6 +180,14 @@ public:
      */
     void Waitrc(CProRecursiveThreadMutex* rcmutex);
 
+    /*
+     * returns false if it's not signalled within "milliseconds"
+     */
+    bool TimedWait(
+        CProThreadMutex* mutex,
+        unsigned long    milliseconds
+        );
+
     void Signal();
 
 private:
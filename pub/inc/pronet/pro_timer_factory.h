@@ -21,6 +21,7 @@
 
 #include "pro_a.h"
 #include "pro_memory_pool.h"
+#include "pro_stat.h"
 #include "pro_stl.h"
 #include "pro_thread_mutex.h"
 
@@ -77,6 +78,42 @@ struct PRO_TIMER_NODE
     DECLARE_SGI_POOL(0)
 };
 
+/*
+ * counters of the timer thread, accumulated since Start(...)
+ */
+struct PRO_TIMER_STATS
+{
+    PRO_TIMER_STATS()
+    {
+        Reset();
+    }
+
+    void Reset()
+    {
+        loopCount   = 0;
+        upcallCount = 0;
+        upcallUs    = 0;
+        upcallMaxUs = 0;
+        lagUs       = 0;
+        lagMaxUs    = 0;
+
+        for (int i = 0; i < PRO_STAT_HISTOGRAM_SIZE; ++i)
+        {
+            lagHistogram[i] = 0;
+        }
+    }
+
+    PRO_UINT64 loopCount;
+    PRO_UINT64 upcallCount;
+    PRO_UINT64 upcallUs;
+    PRO_UINT64 upcallMaxUs;
+    PRO_UINT64 lagUs;    /* actual minus scheduled firing time, 1ms resolution */
+    PRO_UINT64 lagMaxUs;
+    PRO_UINT64 lagHistogram[PRO_STAT_HISTOGRAM_SIZE];
+
+    DECLARE_SGI_POOL(0)
+};
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -136,6 +173,8 @@ public:
 
     unsigned long GetHeartbeatInterval() const;
 
+    void GetStats(PRO_TIMER_STATS& stats) const;
+
 private:
 
     void WorkerRun(PRO_INT64* args);
@@ -150,6 +189,7 @@ private:
     CProStlMap<PRO_UINT64, PRO_INT64> m_timerId2ExpireTick;
     PRO_INT64                         m_htbtTimeSpan;
     CProStlVector<unsigned long>      m_htbtCounts;
+    PRO_TIMER_STATS                   m_stats;
     CProThreadMutexCondition          m_cond;
     mutable CProThreadMutex           m_lock;
     CProThreadMutex                   m_lockAtom;
@@ -611,6 +611,27 @@ MBEDTLS_DEPRECATED void mbedtls_aes_decrypt( mbedtls_aes_context *ctx,
 #undef MBEDTLS_DEPRECATED
 #endif /* !MBEDTLS_DEPRECATED_REMOVED */
 
+//// [[[[
+/**
+ * \brief          Check if the AES-NI paths (and PCLMUL for GCM) are used.
+ *
+ * \return         \c 1 if they are compiled in, supported by the CPU and
+ *                 enabled, \c 0 otherwise.
+ */
+int mbedtls_aes_has_accel( void );
+
+/**
+ * \brief          Enable or disable the hardware-accelerated paths, e.g. to
+ *                 compare them with the portable code. (Default: enabled)
+ *
+ * \note           Call it before any key is set up. A key set up by one
+ *                 path must not be used by the other.
+ *
+ * \param enabled  1 to enable, 0 to disable
+ */
+void mbedtls_aes_set_accel( int enabled );
+//// ]]]]
+
 /**
  * \brief          Checkup routine.
  *
@@ -66,6 +66,8 @@ typedef struct mbedtls_gcm_context
     int mode;                             /*!< The operation to perform:
                                                #MBEDTLS_GCM_ENCRYPT or
                                                #MBEDTLS_GCM_DECRYPT. */
+    unsigned int aesni;                   /*!< The MBEDTLS_AESNI_xxx features ////
+                                               the table was built for. */ ////
 }
 mbedtls_gcm_context;
 
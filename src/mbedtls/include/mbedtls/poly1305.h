@@ -174,6 +174,23 @@ int mbedtls_poly1305_mac( const unsigned char key[32],
 int mbedtls_poly1305_self_test( int verbose );
 #endif /* MBEDTLS_SELF_TEST */
 
+//// [[[[
+/**
+ * \brief           Check if the 64-bit multiplier path is used.
+ *
+ * \return          \c 1 if it is compiled in and enabled, \c 0 otherwise.
+ */
+int mbedtls_poly1305_has_accel( void );
+
+/**
+ * \brief           Enable or disable the 64-bit multiplier path, e.g. to
+ *                  compare it with the portable code. (Default: enabled)
+ *
+ * \param enabled   1 to enable, 0 to disable
+ */
+void mbedtls_poly1305_set_accel( int enabled );
+//// ]]]]
+
 #ifdef __cplusplus
 }
 #endif
@@ -1383,6 +1383,28 @@ int mbedtls_aes_crypt_ctr( mbedtls_aes_context *ctx,
 
 #endif /* !MBEDTLS_AES_ALT */
 
+//// [[[[
+int mbedtls_aes_has_accel( void )
+{
+#if !defined(MBEDTLS_AES_ALT) && \
+    defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+    return( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) );
+#else
+    return( 0 );
+#endif
+}
+
+void mbedtls_aes_set_accel( int enabled )
+{
+#if !defined(MBEDTLS_AES_ALT) && \
+    defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+    mbedtls_aesni_set_enabled( enabled );
+#else
+    (void) enabled;
+#endif
+}
+//// ]]]]
+
 #if defined(MBEDTLS_SELF_TEST)
 /*
  * AES test vectors from:
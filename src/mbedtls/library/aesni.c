@@ -51,11 +51,21 @@
 /*
  * AES-NI support detection routine
  */
+static int aesni_enabled = 1; ////
+
+void mbedtls_aesni_set_enabled( int enabled ) ////
+{ ////
+    aesni_enabled = enabled; ////
+} ////
+
 int mbedtls_aesni_has_support( unsigned int what )
 {
     static int done = 0;
     static unsigned int c = 0;
 
+    if( ! aesni_enabled ) ////
+        return( 0 ); ////
+
     if( ! done )
     {
         asm( "movl  $1, %%eax   \n\t"
@@ -92,8 +102,14 @@ int mbedtls_aesni_has_support( unsigned int what )
 #define xmm0_xmm2   "0xD0"
 #define xmm0_xmm3   "0xD8"
 #define xmm0_xmm4   "0xE0"
+#define xmm0_xmm5   "0xE8" ////
+#define xmm0_xmm6   "0xF0" ////
 #define xmm1_xmm0   "0xC1"
 #define xmm1_xmm2   "0xD1"
+#define xmm4_xmm0   "0xC4" ////
+#define xmm4_xmm1   "0xCC" ////
+#define xmm4_xmm2   "0xD4" ////
+#define xmm4_xmm3   "0xDC" ////
 
 /*
  * AES-NI AES-ECB block en(de)cryption
@@ -140,6 +156,64 @@ int mbedtls_aesni_crypt_ecb( mbedtls_aes_context *ctx,
     return( 0 );
 }
 
+//// [[[[
+/*
+ * AES-NI AES-CTR over 4 interleaved blocks, so that the rounds of one block
+ * hide the latency of the others
+ */
+void mbedtls_aesni_crypt_ctr4( const mbedtls_aes_context *ctx,
+                               const unsigned char ctr[64],
+                               const unsigned char *input,
+                               unsigned char *output )
+{
+    int nr = ctx->nr;
+    const uint32_t *rk = ctx->rk;
+
+    asm volatile( "movdqu    (%1), %%xmm4    \n\t" // load round key 0
+                  "movdqu    (%2), %%xmm0    \n\t" // load counters
+                  "movdqu  16(%2), %%xmm1    \n\t"
+                  "movdqu  32(%2), %%xmm2    \n\t"
+                  "movdqu  48(%2), %%xmm3    \n\t"
+                  "pxor      %%xmm4, %%xmm0  \n\t" // round 0
+                  "pxor      %%xmm4, %%xmm1  \n\t"
+                  "pxor      %%xmm4, %%xmm2  \n\t"
+                  "pxor      %%xmm4, %%xmm3  \n\t"
+                  "add       $16, %1         \n\t" // point to next round key
+                  "subl      $1, %0          \n\t" // normal rounds = nr - 1
+
+                  "1:                        \n\t" // encryption loop
+                  "movdqu    (%1), %%xmm4    \n\t" // load round key
+                  AESENC     xmm4_xmm0      "\n\t" // do round
+                  AESENC     xmm4_xmm1      "\n\t"
+                  AESENC     xmm4_xmm2      "\n\t"
+                  AESENC     xmm4_xmm3      "\n\t"
+                  "add       $16, %1         \n\t" // point to next round key
+                  "subl      $1, %0          \n\t" // loop
+                  "jnz       1b              \n\t"
+                  "movdqu    (%1), %%xmm4    \n\t" // load round key
+                  AESENCLAST xmm4_xmm0      "\n\t" // last round
+                  AESENCLAST xmm4_xmm1      "\n\t"
+                  AESENCLAST xmm4_xmm2      "\n\t"
+                  AESENCLAST xmm4_xmm3      "\n\t"
+
+                  "movdqu    (%3), %%xmm4    \n\t" // xor with input
+                  "pxor      %%xmm4, %%xmm0  \n\t"
+                  "movdqu  16(%3), %%xmm4    \n\t"
+                  "pxor      %%xmm4, %%xmm1  \n\t"
+                  "movdqu  32(%3), %%xmm4    \n\t"
+                  "pxor      %%xmm4, %%xmm2  \n\t"
+                  "movdqu  48(%3), %%xmm4    \n\t"
+                  "pxor      %%xmm4, %%xmm3  \n\t"
+                  "movdqu    %%xmm0,   (%4)  \n\t" // export output
+                  "movdqu    %%xmm1, 16(%4)  \n\t"
+                  "movdqu    %%xmm2, 32(%4)  \n\t"
+                  "movdqu    %%xmm3, 48(%4)  \n\t"
+                  : "+r" (nr), "+r" (rk)
+                  : "r" (ctr), "r" (input), "r" (output)
+                  : "memory", "cc", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4" );
+}
+//// ]]]]
+
 /*
  * GCM multiplication: c = a times b in GF(2^128)
  * Based on [CLMUL-WP] algorithms 1 (with equation 27) and 5.
@@ -252,6 +326,123 @@ void mbedtls_aesni_gcm_mult( unsigned char c[16],
     return;
 }
 
+//// [[[[
+/*
+ * GHASH over 4 blocks with one reduction:
+ * x = (x + b0) * h4 + b1 * h3 + b2 * h2 + b3 * h1
+ */
+void mbedtls_aesni_gcm_mult4( unsigned char x[16],
+                              const unsigned char b[64],
+                              const unsigned char h[64] )
+{
+    static const unsigned char rev[16] =
+        { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+
+    asm( "movdqu (%3), %%xmm8               \n\t" // byte-reverse mask
+         "pxor %%xmm1, %%xmm1               \n\t" // sum of products, low
+         "pxor %%xmm2, %%xmm2               \n\t" // sum of products, high
+         "movdqu (%0), %%xmm0               \n\t" // x
+         "movdqu (%1), %%xmm3               \n\t" // b0
+         "pxor %%xmm3, %%xmm0               \n\t" // x + b0
+         "xor %%eax, %%eax                  \n\t"
+
+         "1:                                \n\t"
+         "test %%eax, %%eax                 \n\t"
+         "jz 2f                             \n\t"
+         "movdqu (%1,%%rax), %%xmm0         \n\t" // b1, b2, b3
+         "2:                                \n\t"
+         "movdqu (%2,%%rax), %%xmm3         \n\t" // h4, h3, h2, h1
+         "pshufb %%xmm8, %%xmm0             \n\t" // a1:a0
+         "pshufb %%xmm8, %%xmm3             \n\t" // h1:h0
+         "movdqa %%xmm3, %%xmm4             \n\t"
+         "movdqa %%xmm3, %%xmm5             \n\t"
+         "movdqa %%xmm3, %%xmm6             \n\t"
+         PCLMULQDQ xmm0_xmm3 ",0x00         \n\t" // a0*h0 = c1:c0
+         PCLMULQDQ xmm0_xmm4 ",0x11         \n\t" // a1*h1 = d1:d0
+         PCLMULQDQ xmm0_xmm5 ",0x10         \n\t" // a0*h1 = e1:e0
+         PCLMULQDQ xmm0_xmm6 ",0x01         \n\t" // a1*h0 = f1:f0
+         "pxor %%xmm5, %%xmm6               \n\t" // e1+f1:e0+f0
+         "movdqa %%xmm6, %%xmm5             \n\t" // same
+         "psrldq $8, %%xmm6                 \n\t" // 0:e1+f1
+         "pslldq $8, %%xmm5                 \n\t" // e0+f0:0
+         "pxor %%xmm6, %%xmm4               \n\t" // d1:d0+e1+f1
+         "pxor %%xmm5, %%xmm3               \n\t" // c1+e0+f1:c0
+         "pxor %%xmm3, %%xmm1               \n\t" // add to the sum
+         "pxor %%xmm4, %%xmm2               \n\t"
+         "add $16, %%eax                    \n\t"
+         "cmp $64, %%eax                    \n\t"
+         "jne 1b                            \n\t"
+
+         /*
+          * Now shift the result one bit to the left,
+          * taking advantage of [CLMUL-WP] eq 27 (p. 20)
+          */
+         "movdqa %%xmm1, %%xmm3             \n\t" // r1:r0
+         "movdqa %%xmm2, %%xmm4             \n\t" // r3:r2
+         "psllq $1, %%xmm1                  \n\t" // r1<<1:r0<<1
+         "psllq $1, %%xmm2                  \n\t" // r3<<1:r2<<1
+         "psrlq $63, %%xmm3                 \n\t" // r1>>63:r0>>63
+         "psrlq $63, %%xmm4                 \n\t" // r3>>63:r2>>63
+         "movdqa %%xmm3, %%xmm5             \n\t" // r1>>63:r0>>63
+         "pslldq $8, %%xmm3                 \n\t" // r0>>63:0
+         "pslldq $8, %%xmm4                 \n\t" // r2>>63:0
+         "psrldq $8, %%xmm5                 \n\t" // 0:r1>>63
+         "por %%xmm3, %%xmm1                \n\t" // r1<<1|r0>>63:r0<<1
+         "por %%xmm4, %%xmm2                \n\t" // r3<<1|r2>>62:r2<<1
+         "por %%xmm5, %%xmm2                \n\t" // r3<<1|r2>>62:r2<<1|r1>>63
+
+         /*
+          * Now reduce modulo the GCM polynomial x^128 + x^7 + x^2 + x + 1
+          * using [CLMUL-WP] algorithm 5 (p. 20).
+          * Currently xmm2:xmm1 holds x3:x2:x1:x0 (already shifted).
+          */
+         /* Step 2 (1) */
+         "movdqa %%xmm1, %%xmm3             \n\t" // x1:x0
+         "movdqa %%xmm1, %%xmm4             \n\t" // same
+         "movdqa %%xmm1, %%xmm5             \n\t" // same
+         "psllq $63, %%xmm3                 \n\t" // x1<<63:x0<<63 = stuff:a
+         "psllq $62, %%xmm4                 \n\t" // x1<<62:x0<<62 = stuff:b
+         "psllq $57, %%xmm5                 \n\t" // x1<<57:x0<<57 = stuff:c
+
+         /* Step 2 (2) */
+         "pxor %%xmm4, %%xmm3               \n\t" // stuff:a+b
+         "pxor %%xmm5, %%xmm3               \n\t" // stuff:a+b+c
+         "pslldq $8, %%xmm3                 \n\t" // a+b+c:0
+         "pxor %%xmm3, %%xmm1               \n\t" // x1+a+b+c:x0 = d:x0
+
+         /* Steps 3 and 4 */
+         "movdqa %%xmm1,%%xmm0              \n\t" // d:x0
+         "movdqa %%xmm1,%%xmm4              \n\t" // same
+         "movdqa %%xmm1,%%xmm5              \n\t" // same
+         "psrlq $1, %%xmm0                  \n\t" // e1:x0>>1 = e1:e0'
+         "psrlq $2, %%xmm4                  \n\t" // f1:x0>>2 = f1:f0'
+         "psrlq $7, %%xmm5                  \n\t" // g1:x0>>7 = g1:g0'
+         "pxor %%xmm4, %%xmm0               \n\t" // e1+f1:e0'+f0'
+         "pxor %%xmm5, %%xmm0               \n\t" // e1+f1+g1:e0'+f0'+g0'
+         // e0'+f0'+g0' is almost e0+f0+g0, ex\tcept for some missing
+         // bits carried from d. Now get those\t bits back in.
+         "movdqa %%xmm1,%%xmm3              \n\t" // d:x0
+         "movdqa %%xmm1,%%xmm4              \n\t" // same
+         "movdqa %%xmm1,%%xmm5              \n\t" // same
+         "psllq $63, %%xmm3                 \n\t" // d<<63:stuff
+         "psllq $62, %%xmm4                 \n\t" // d<<62:stuff
+         "psllq $57, %%xmm5                 \n\t" // d<<57:stuff
+         "pxor %%xmm4, %%xmm3               \n\t" // d<<63+d<<62:stuff
+         "pxor %%xmm5, %%xmm3               \n\t" // missing bits of d:stuff
+         "psrldq $8, %%xmm3                 \n\t" // 0:missing bits of d
+         "pxor %%xmm3, %%xmm0               \n\t" // e1+f1+g1:e0+f0+g0
+         "pxor %%xmm1, %%xmm0               \n\t" // h1:h0
+         "pxor %%xmm2, %%xmm0               \n\t" // x3+h1:x2+h0
+
+         "pshufb %%xmm8, %%xmm0             \n\t"
+         "movdqu %%xmm0, (%0)               \n\t" // done
+         :
+         : "r" (x), "r" (b), "r" (h), "r" (rev)
+         : "memory", "cc", "rax", "xmm0", "xmm1", "xmm2", "xmm3", "xmm4",
+           "xmm5", "xmm6", "xmm8" );
+}
+//// ]]]]
+
 /*
  * Compute decryption round keys from encryption round keys
  */
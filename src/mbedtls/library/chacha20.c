@@ -179,6 +179,110 @@ static void chacha20_block( const uint32_t initial_state[16],
     mbedtls_platform_zeroize( working_state, sizeof( working_state ) );
 }
 
+//// [[[[
+#if ( defined(__GNUC__) && defined(__SSE2__) ) || \
+    ( defined(_MSC_VER) && ( defined(_M_X64) || defined(_M_AMD64) ) )
+#define CHACHA20_HAVE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(CHACHA20_HAVE_SSE2)
+
+static int chacha20_accel = 1;
+
+#define CHACHA20_ROTL_SSE2( v, n )                                          \
+    _mm_or_si128( _mm_slli_epi32( v, n ), _mm_srli_epi32( v, 32 - ( n ) ) )
+
+#define CHACHA20_QUARTER_ROUND_SSE2( a, b, c, d )                           \
+    do                                                                      \
+    {                                                                       \
+        a = _mm_add_epi32( a, b );                                          \
+        d = _mm_xor_si128( d, a );                                          \
+        d = CHACHA20_ROTL_SSE2( d, 16 );                                    \
+        c = _mm_add_epi32( c, d );                                          \
+        b = _mm_xor_si128( b, c );                                          \
+        b = CHACHA20_ROTL_SSE2( b, 12 );                                    \
+        a = _mm_add_epi32( a, b );                                          \
+        d = _mm_xor_si128( d, a );                                          \
+        d = CHACHA20_ROTL_SSE2( d, 8 );                                     \
+        c = _mm_add_epi32( c, d );                                          \
+        b = _mm_xor_si128( b, c );                                          \
+        b = CHACHA20_ROTL_SSE2( b, 7 );                                     \
+    } while( 0 )
+
+/**
+ * \brief               Encrypts 4 blocks at once, one block per SSE2 lane,
+ *                      and advances the block counter by 4.
+ *
+ * \param state         The ChaCha20 state (key, nonce, counter).
+ * \param input         The 256 bytes to encrypt.
+ * \param output        The 256 encrypted bytes. May be the same as input.
+ */
+static void chacha20_xor4_sse2( uint32_t state[16],
+                                const unsigned char *input,
+                                unsigned char *output )
+{
+    __m128i x[16];
+    __m128i s[16];
+    __m128i t0, t1, t2, t3;
+    size_t off;
+    size_t i;
+
+    for( i = 0U; i < 16U; i++ )
+        s[i] = _mm_set1_epi32( (int) state[i] );
+    s[CHACHA20_CTR_INDEX] = _mm_add_epi32( s[CHACHA20_CTR_INDEX],
+                                           _mm_set_epi32( 3, 2, 1, 0 ) );
+
+    for( i = 0U; i < 16U; i++ )
+        x[i] = s[i];
+
+    for( i = 0U; i < 10U; i++ )
+    {
+        CHACHA20_QUARTER_ROUND_SSE2( x[0], x[4], x[8],  x[12] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[1], x[5], x[9],  x[13] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[2], x[6], x[10], x[14] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[3], x[7], x[11], x[15] );
+
+        CHACHA20_QUARTER_ROUND_SSE2( x[0], x[5], x[10], x[15] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[1], x[6], x[11], x[12] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[2], x[7], x[8],  x[13] );
+        CHACHA20_QUARTER_ROUND_SSE2( x[3], x[4], x[9],  x[14] );
+    }
+
+    for( i = 0U; i < 16U; i++ )
+        x[i] = _mm_add_epi32( x[i], s[i] );
+
+    /* Transpose each group of 4 words, so x[i + j] holds them for block j */
+    for( i = 0U; i < 16U; i += 4U )
+    {
+        t0 = _mm_unpacklo_epi32( x[i    ], x[i + 1] );
+        t1 = _mm_unpacklo_epi32( x[i + 2], x[i + 3] );
+        t2 = _mm_unpackhi_epi32( x[i    ], x[i + 1] );
+        t3 = _mm_unpackhi_epi32( x[i + 2], x[i + 3] );
+
+        x[i    ] = _mm_unpacklo_epi64( t0, t1 );
+        x[i + 1] = _mm_unpackhi_epi64( t0, t1 );
+        x[i + 2] = _mm_unpacklo_epi64( t2, t3 );
+        x[i + 3] = _mm_unpackhi_epi64( t2, t3 );
+    }
+
+    for( i = 0U; i < 16U; i++ )
+    {
+        off = ( i & 3U ) * CHACHA20_BLOCK_SIZE_BYTES + ( i >> 2 ) * 16U;
+
+        _mm_storeu_si128( (__m128i *) ( output + off ),
+            _mm_xor_si128( x[i],
+                _mm_loadu_si128( (const __m128i *) ( input + off ) ) ) );
+    }
+
+    state[CHACHA20_CTR_INDEX] += 4U;
+
+    mbedtls_platform_zeroize( x, sizeof( x ) );
+}
+
+#endif /* CHACHA20_HAVE_SSE2 */
+//// ]]]]
+
 void mbedtls_chacha20_init( mbedtls_chacha20_context *ctx )
 {
     if( ctx != NULL )
@@ -280,6 +384,15 @@ int mbedtls_chacha20_update( mbedtls_chacha20_context *ctx,
         size--;
     }
 
+#if defined(CHACHA20_HAVE_SSE2) ////
+    while( chacha20_accel && size >= 4U * CHACHA20_BLOCK_SIZE_BYTES ) ////
+    { ////
+        chacha20_xor4_sse2( ctx->state, input + offset, output + offset ); ////
+        offset += 4U * CHACHA20_BLOCK_SIZE_BYTES; ////
+        size   -= 4U * CHACHA20_BLOCK_SIZE_BYTES; ////
+    } ////
+#endif ////
+
     /* Process full blocks */
     while( size >= CHACHA20_BLOCK_SIZE_BYTES )
     {
@@ -351,6 +464,26 @@ cleanup:
 
 #endif /* !MBEDTLS_CHACHA20_ALT */
 
+//// [[[[
+int mbedtls_chacha20_has_accel( void )
+{
+#if !defined(MBEDTLS_CHACHA20_ALT) && defined(CHACHA20_HAVE_SSE2)
+    return( chacha20_accel );
+#else
+    return( 0 );
+#endif
+}
+
+void mbedtls_chacha20_set_accel( int enabled )
+{
+#if !defined(MBEDTLS_CHACHA20_ALT) && defined(CHACHA20_HAVE_SSE2)
+    chacha20_accel = enabled;
+#else
+    (void) enabled;
+#endif
+}
+//// ]]]]
+
 #if defined(MBEDTLS_SELF_TEST)
 
 static const unsigned char test_keys[2][32] =
@@ -44,6 +44,7 @@
 
 #if defined(MBEDTLS_AESNI_C)
 #include "mbedtls/aesni.h"
+#include "mbedtls/cipher_internal.h" ////
 #endif
 
 #if defined(MBEDTLS_SELF_TEST) && defined(MBEDTLS_AES_C)
@@ -122,10 +123,40 @@ static int gcm_gen_table( mbedtls_gcm_context *ctx )
     ctx->HL[8] = vl;
     ctx->HH[8] = vh;
 
+    ctx->aesni = 0; ////
+
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
     /* With CLMUL support, we need only h, not the rest of the table */
     if( mbedtls_aesni_has_support( MBEDTLS_AESNI_CLMUL ) )
+    {
+        //// [[[[
+        unsigned char hp[16];
+
+        /*
+         * gcm_mult() and mbedtls_gcm_update() test these bits, not the CPU,
+         * because the table below is only valid for the CLMUL path
+         */
+        ctx->aesni = MBEDTLS_AESNI_CLMUL;
+        if( mbedtls_aesni_has_support( MBEDTLS_AESNI_AES ) )
+            ctx->aesni |= MBEDTLS_AESNI_AES;
+
+        /* h^2, h^3 and h^4 for the 4-block path go to the unused slots 1 ~ 3 */
+        memcpy( hp, h, 16 );
+        for( i = 1; i <= 3; i++ )
+        {
+            mbedtls_aesni_gcm_mult( hp, hp, h );
+
+            GET_UINT32_BE( hi, hp, 0  );
+            GET_UINT32_BE( lo, hp, 4  );
+            ctx->HH[i] = (uint64_t) hi << 32 | lo;
+
+            GET_UINT32_BE( hi, hp, 8  );
+            GET_UINT32_BE( lo, hp, 12 );
+            ctx->HL[i] = (uint64_t) hi << 32 | lo;
+        }
+        //// ]]]]
         return( 0 );
+    }
 #endif
 
     /* 0 corresponds to 0 in GF(2^128) */
@@ -214,7 +245,7 @@ static void gcm_mult( mbedtls_gcm_context *ctx, const unsigned char x[16],
     uint64_t zh, zl;
 
 #if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
-    if( mbedtls_aesni_has_support( MBEDTLS_AESNI_CLMUL ) ) {
+    if( ctx->aesni & MBEDTLS_AESNI_CLMUL ) { ////
         unsigned char h[16];
 
         PUT_UINT32_BE( ctx->HH[8] >> 32, h,  0 );
@@ -345,6 +376,45 @@ int mbedtls_gcm_starts( mbedtls_gcm_context *ctx,
     return( 0 );
 }
 
+//// [[[[
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64)
+/*
+ * The AES context if the 4-block AES-NI/PCLMUL path applies, NULL otherwise.
+ * It applies only if both features were there at setkey time, since only then
+ * gcm_gen_table() has put the powers of h into the table
+ */
+static const mbedtls_aes_context *gcm_aesni_context( const mbedtls_gcm_context *ctx )
+{
+    if( ctx->cipher_ctx.cipher_info == NULL ||
+        ctx->cipher_ctx.cipher_info->base->cipher != MBEDTLS_CIPHER_ID_AES ||
+        ( ctx->aesni & MBEDTLS_AESNI_AES ) == 0 ||
+        ( ctx->aesni & MBEDTLS_AESNI_CLMUL ) == 0 )
+    {
+        return( NULL );
+    }
+
+    return( (const mbedtls_aes_context *) ctx->cipher_ctx.cipher_ctx );
+}
+
+/*
+ * h^4, h^3, h^2 and h, big-endian, for mbedtls_aesni_gcm_mult4()
+ */
+static void gcm_hpowers( const mbedtls_gcm_context *ctx, unsigned char hp[64] )
+{
+    static const int slots[4] = { 3, 2, 1, 8 };
+    int i;
+
+    for( i = 0; i < 4; i++ )
+    {
+        PUT_UINT32_BE( ctx->HH[slots[i]] >> 32, hp, i * 16      );
+        PUT_UINT32_BE( ctx->HH[slots[i]],       hp, i * 16 + 4  );
+        PUT_UINT32_BE( ctx->HL[slots[i]] >> 32, hp, i * 16 + 8  );
+        PUT_UINT32_BE( ctx->HL[slots[i]],       hp, i * 16 + 12 );
+    }
+}
+#endif /* MBEDTLS_AESNI_C && MBEDTLS_HAVE_X86_64 */
+//// ]]]]
+
 int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
                 size_t length,
                 const unsigned char *input,
@@ -356,6 +426,12 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
     const unsigned char *p;
     unsigned char *out_p = output;
     size_t use_len, olen = 0;
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64) ////
+    const mbedtls_aes_context *aes; ////
+    unsigned char ctr[64]; ////
+    unsigned char hp[64]; ////
+    size_t j; ////
+#endif ////
 
     if( output > input && (size_t) ( output - input ) < length )
         return( MBEDTLS_ERR_GCM_BAD_INPUT );
@@ -375,6 +451,33 @@ int mbedtls_gcm_update( mbedtls_gcm_context *ctx,
     ctx->len += length;
 
     p = input;
+
+#if defined(MBEDTLS_AESNI_C) && defined(MBEDTLS_HAVE_X86_64) ////
+    aes = gcm_aesni_context( ctx ); ////
+    if( aes != NULL && length >= 64 ) ////
+        gcm_hpowers( ctx, hp ); ////
+    while( aes != NULL && length >= 64 ) ////
+    { ////
+        for( j = 0; j < 64; j += 16 ) ////
+        { ////
+            for( i = 16; i > 12; i-- ) ////
+                if( ++ctx->y[i - 1] != 0 ) ////
+                    break; ////
+            memcpy( ctr + j, ctx->y, 16 ); ////
+        } ////
+
+        if( ctx->mode == MBEDTLS_GCM_DECRYPT ) ////
+            mbedtls_aesni_gcm_mult4( ctx->buf, p, hp ); ////
+        mbedtls_aesni_crypt_ctr4( aes, ctr, p, out_p ); ////
+        if( ctx->mode == MBEDTLS_GCM_ENCRYPT ) ////
+            mbedtls_aesni_gcm_mult4( ctx->buf, out_p, hp ); ////
+
+        length -= 64; ////
+        p += 64; ////
+        out_p += 64; ////
+    } ////
+#endif ////
+
     while( length > 0 )
     {
         use_len = ( length < 16 ) ? length : 16;
@@ -85,6 +85,94 @@ static inline uint64_t mul64( uint32_t a, uint32_t b )
 }
 #endif
 
+//// [[[[
+#if defined(__GNUC__) && defined(__SIZEOF_INT128__) && \
+    !defined(MBEDTLS_NO_64BIT_MULTIPLICATION)
+#define POLY1305_HAVE_U128
+#endif
+
+#if defined(POLY1305_HAVE_U128)
+
+typedef unsigned int poly1305_u128 __attribute__((mode(TI)));
+
+static int poly1305_accel = 1;
+
+/* 1 if a + b carried, where a is the sum; free of branches */
+#define POLY1305_CARRY( a, b ) \
+    ( ( (a) ^ ( ( (a) ^ (b) ) | ( ( (a) - (b) ) ^ (b) ) ) ) >> 63 )
+
+#define BYTES_TO_U64_LE( data, offset )                           \
+    ( (uint64_t) BYTES_TO_U32_LE( data, offset )                  \
+          | ( (uint64_t) BYTES_TO_U32_LE( data, ( offset ) + 4 ) << 32 ) \
+    )
+
+/**
+ * \brief                   Process blocks with Poly1305, using 2 limbs of
+ *                          64 bits and a 64x64->128 multiplier.
+ *
+ *                          The accumulator keeps the layout of the 32-bit
+ *                          code, so the two can be mixed on the same context.
+ */
+static void poly1305_process_u128( mbedtls_poly1305_context *ctx,
+                                   size_t nblocks,
+                                   const unsigned char *input,
+                                   uint32_t needs_padding )
+{
+    poly1305_u128 d0, d1;
+    uint64_t h0, h1, h2;
+    uint64_t r0, r1, s1;
+    uint64_t c;
+    size_t offset  = 0U;
+    size_t i;
+
+    r0 = (uint64_t) ctx->r[0] | ( (uint64_t) ctx->r[1] << 32 );
+    r1 = (uint64_t) ctx->r[2] | ( (uint64_t) ctx->r[3] << 32 );
+    s1 = r1 + ( r1 >> 2U );
+
+    h0 = (uint64_t) ctx->acc[0] | ( (uint64_t) ctx->acc[1] << 32 );
+    h1 = (uint64_t) ctx->acc[2] | ( (uint64_t) ctx->acc[3] << 32 );
+    h2 = ctx->acc[4];
+
+    for( i = 0U; i < nblocks; i++ )
+    {
+        /* Compute: acc += (padded) block as a 130-bit integer */
+        d0  = (poly1305_u128) h0 + BYTES_TO_U64_LE( input, offset );
+        d1  = (poly1305_u128) h1 + ( d0 >> 64 )
+            + BYTES_TO_U64_LE( input, offset + 8 );
+        h0  = (uint64_t) d0;
+        h1  = (uint64_t) d1;
+        h2 += (uint64_t) ( d1 >> 64 ) + needs_padding;
+
+        /* Compute: acc *= r */
+        d0 = (poly1305_u128) h0 * r0 + (poly1305_u128) h1 * s1;
+        d1 = (poly1305_u128) h0 * r1 + (poly1305_u128) h1 * r0 + h2 * s1;
+        h2 = h2 * r0;
+
+        /* Compute: acc %= (2^130 - 5) (partial remainder) */
+        d1 += d0 >> 64;
+        h0  = (uint64_t) d0;
+        h1  = (uint64_t) d1;
+        h2 += (uint64_t) ( d1 >> 64 );
+
+        c   = ( h2 >> 2 ) + ( h2 & ~(uint64_t) 3U );
+        h2 &= 3U;
+        h0 += c;
+        c   = POLY1305_CARRY( h0, c );
+        h1 += c;
+        h2 += POLY1305_CARRY( h1, c );
+
+        offset += POLY1305_BLOCK_SIZE_BYTES;
+    }
+
+    ctx->acc[0] = (uint32_t) h0;
+    ctx->acc[1] = (uint32_t) ( h0 >> 32 );
+    ctx->acc[2] = (uint32_t) h1;
+    ctx->acc[3] = (uint32_t) ( h1 >> 32 );
+    ctx->acc[4] = (uint32_t) h2;
+}
+
+#endif /* POLY1305_HAVE_U128 */
+//// ]]]]
 
 /**
  * \brief                   Process blocks with Poly1305.
@@ -109,6 +197,14 @@ static void poly1305_process( mbedtls_poly1305_context *ctx,
     size_t offset  = 0U;
     size_t i;
 
+#if defined(POLY1305_HAVE_U128) ////
+    if( poly1305_accel ) ////
+    { ////
+        poly1305_process_u128( ctx, nblocks, input, needs_padding ); ////
+        return; ////
+    } ////
+#endif ////
+
     r0 = ctx->r[0];
     r1 = ctx->r[1];
     r2 = ctx->r[2];
@@ -451,6 +547,26 @@ cleanup:
 
 #endif /* MBEDTLS_POLY1305_ALT */
 
+//// [[[[
+int mbedtls_poly1305_has_accel( void )
+{
+#if !defined(MBEDTLS_POLY1305_ALT) && defined(POLY1305_HAVE_U128)
+    return( poly1305_accel );
+#else
+    return( 0 );
+#endif
+}
+
+void mbedtls_poly1305_set_accel( int enabled )
+{
+#if !defined(MBEDTLS_POLY1305_ALT) && defined(POLY1305_HAVE_U128)
+    poly1305_accel = enabled;
+#else
+    (void) enabled;
+#endif
+}
+//// ]]]]
+
 #if defined(MBEDTLS_SELF_TEST)
 
 static const unsigned char test_keys[2][32] =
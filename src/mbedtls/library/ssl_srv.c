@@ -1202,10 +1202,43 @@ have_ciphersuite_v2:
 /* This function doesn't alert on errors that happen early during
    ClientHello parsing because they might indicate that the client is
    not talking SSL/TLS at all and would not understand our alert. */
+//// [[[[
+/*
+ * Decide whose ciphersuite order to follow. With the server's order, a
+ * client that puts a ChaCha20-Poly1305 suite first (most likely a CPU
+ * without AES hardware) still gets its own order.
+ */
+static int ssl_srv_use_client_order( const mbedtls_ssl_context *ssl,
+                                     const unsigned char *p, size_t len )
+{
+    const mbedtls_ssl_ciphersuite_t *suite;
+    size_t j;
+
+    if( ssl->conf->respect_cli_pref )
+        return( 1 );
+
+    for( j = 0; j + 1 < len; j += 2 )
+    {
+        suite = mbedtls_ssl_ciphersuite_from_id( ( p[j] << 8 ) | p[j + 1] );
+        if( suite == NULL )
+            continue;
+
+#if defined(MBEDTLS_CHACHAPOLY_C)
+        return( suite->cipher == MBEDTLS_CIPHER_CHACHA20_POLY1305 );
+#else
+        return( 0 );
+#endif
+    }
+
+    return( 0 );
+}
+//// ]]]]
+
 static int ssl_parse_client_hello( mbedtls_ssl_context *ssl )
 {
     int ret, got_common_suite;
     size_t i, j;
+    size_t k, l, n, cli_order; ////
     size_t ciph_offset, comp_offset, ext_offset;
     size_t msg_len, ciph_len, sess_len, comp_len, ext_len;
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -1978,14 +2011,17 @@ read_record_header:
     got_common_suite = 0;
     ciphersuites = ssl->conf->ciphersuite_list[ssl->minor_ver];
     ciphersuite_info = NULL;
-#if defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE)
-    for( j = 0, p = buf + ciph_offset + 2; j < ciph_len; j += 2, p += 2 )
-        for( i = 0; ciphersuites[i] != 0; i++ )
-#else
-    for( i = 0; ciphersuites[i] != 0; i++ )
-        for( j = 0, p = buf + ciph_offset + 2; j < ciph_len; j += 2, p += 2 )
-#endif
+//// [[[[
+    cli_order = ssl_srv_use_client_order( ssl, buf + ciph_offset + 2, ciph_len );
+    for( n = 0; ciphersuites[n] != 0; n++ );
+
+    for( k = 0; k < ( cli_order ? ciph_len / 2 : n ); k++ )
+        for( l = 0; l < ( cli_order ? n : ciph_len / 2 ); l++ )
         {
+            i = cli_order ? l : k;
+            j = ( cli_order ? k : l ) * 2;
+            p = buf + ciph_offset + 2 + j;
+//// ]]]]
             if( p[0] != ( ( ciphersuites[i] >> 8 ) & 0xFF ) ||
                 p[1] != ( ( ciphersuites[i]      ) & 0xFF ) )
                 continue;
@@ -55,6 +55,7 @@
 #endif
 
 static void ssl_reset_in_out_pointers( mbedtls_ssl_context *ssl );
+static int ssl_regrow_buffers( mbedtls_ssl_context *ssl ); ////
 static uint32_t ssl_get_hs_total_len( mbedtls_ssl_context const *ssl );
 
 /* Length of the "epoch" field in the record header */
@@ -1027,6 +1028,15 @@ int mbedtls_ssl_derive_keys( mbedtls_ssl_context *ssl )
     }
 #endif
 
+    //// [[[[
+    if( ssl->conf->keep_traffic_keys &&
+        transform->keylen <= sizeof( transform->key_enc ) )
+    {
+        memcpy( transform->key_enc, key1, transform->keylen );
+        memcpy( transform->key_dec, key2, transform->keylen );
+    }
+    //// ]]]]
+
     if( ( ret = mbedtls_cipher_setup( &transform->cipher_ctx_enc,
                                  cipher_info ) ) != 0 )
     {
@@ -2538,7 +2548,7 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
     }
 
-    if( nb_want > MBEDTLS_SSL_IN_BUFFER_LEN - (size_t)( ssl->in_hdr - ssl->in_buf ) )
+    if( nb_want > ssl->in_buf_len - (size_t)( ssl->in_hdr - ssl->in_buf ) ) ////
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "requesting more data than fits" ) );
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
@@ -2624,7 +2634,7 @@ int mbedtls_ssl_fetch_input( mbedtls_ssl_context *ssl, size_t nb_want )
         }
         else
         {
-            len = MBEDTLS_SSL_IN_BUFFER_LEN - ( ssl->in_hdr - ssl->in_buf );
+            len = ssl->in_buf_len - ( ssl->in_hdr - ssl->in_buf ); ////
 
             if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER )
                 timeout = ssl->handshake->retransmit_timeout;
@@ -4082,7 +4092,7 @@ static int ssl_parse_record_header( mbedtls_ssl_context *ssl )
     }
 
     /* Check length against the size of our buffer */
-    if( ssl->in_msglen > MBEDTLS_SSL_IN_BUFFER_LEN
+    if( ssl->in_msglen > ssl->in_buf_len ////
                          - (size_t)( ssl->in_msg - ssl->in_buf ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "bad message length" ) );
@@ -4871,7 +4881,7 @@ static int ssl_load_buffered_record( mbedtls_ssl_context *ssl )
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "Found buffered record from current epoch - load" ) );
 
     /* Double-check that the record is not too large */
-    if( rec_len > MBEDTLS_SSL_IN_BUFFER_LEN -
+    if( rec_len > ssl->in_buf_len - ////
         (size_t)( ssl->in_hdr - ssl->in_buf ) )
     {
         MBEDTLS_SSL_DEBUG_MSG( 1, ( "should never happen" ) );
@@ -5241,6 +5251,9 @@ int mbedtls_ssl_send_alert_message( mbedtls_ssl_context *ssl,
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+    if( ( ret = ssl_regrow_buffers( ssl ) ) != 0 ) ////
+        return( ret );                             ////
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> send alert message" ) );
     MBEDTLS_SSL_DEBUG_MSG( 3, ( "send alert level=%u message=%u", level, message ));
 
@@ -6783,6 +6796,271 @@ void mbedtls_ssl_init( mbedtls_ssl_context *ssl )
     memset( ssl, 0, sizeof( mbedtls_ssl_context ) );
 }
 
+//// [[[[
+/*
+ * Allocate the record buffers with the given sizes, keeping their contents
+ * up to the smaller size. A released input buffer gets back the incoming
+ * record counter saved by mbedtls_ssl_release_buffers(), since the TLS
+ * counter lives in its first 8 bytes.
+ *
+ * The caller has to update the record pointers.
+ */
+static int ssl_resize_buffers( mbedtls_ssl_context *ssl,
+                               size_t in_len, size_t out_len )
+{
+    unsigned char *buf;
+
+    if( ssl->in_buf == NULL || ssl->in_buf_len != in_len )
+    {
+        buf = mbedtls_calloc( 1, in_len );
+        if( buf == NULL )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", (int) in_len ) );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+
+        if( ssl->in_buf != NULL )
+        {
+            memcpy( buf, ssl->in_buf,
+                    in_len < ssl->in_buf_len ? in_len : ssl->in_buf_len );
+            mbedtls_platform_zeroize( ssl->in_buf, ssl->in_buf_len );
+            mbedtls_free( ssl->in_buf );
+        }
+        else
+            memcpy( buf, ssl->in_ctr_saved, 8 );
+
+        ssl->in_buf     = buf;
+        ssl->in_buf_len = in_len;
+    }
+
+    if( ssl->out_buf == NULL || ssl->out_buf_len != out_len )
+    {
+        buf = mbedtls_calloc( 1, out_len );
+        if( buf == NULL )
+        {
+            MBEDTLS_SSL_DEBUG_MSG( 1, ( "alloc(%d bytes) failed", (int) out_len ) );
+            return( MBEDTLS_ERR_SSL_ALLOC_FAILED );
+        }
+
+        if( ssl->out_buf != NULL )
+        {
+            memcpy( buf, ssl->out_buf,
+                    out_len < ssl->out_buf_len ? out_len : ssl->out_buf_len );
+            mbedtls_platform_zeroize( ssl->out_buf, ssl->out_buf_len );
+            mbedtls_free( ssl->out_buf );
+        }
+
+        ssl->out_buf     = buf;
+        ssl->out_buf_len = out_len;
+    }
+
+    return( 0 );
+}
+
+/*
+ * The sizes of the record buffers of an established connection.
+ *
+ * They are cut down to the negotiated max_fragment_length, unless a new
+ * handshake (renegotiation) or compression may need the full size.
+ */
+static void ssl_get_buffer_lens( const mbedtls_ssl_context *ssl,
+                                 size_t *in_len, size_t *out_len )
+{
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    size_t mfl;
+#endif
+
+    *in_len  = MBEDTLS_SSL_IN_BUFFER_LEN;
+    *out_len = MBEDTLS_SSL_OUT_BUFFER_LEN;
+
+#if defined(MBEDTLS_SSL_MAX_FRAGMENT_LENGTH)
+    if( ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER || ssl->handshake != NULL ||
+        ssl->session == NULL )
+        return;
+
+#if defined(MBEDTLS_SSL_RENEGOTIATION)
+    if( ssl->conf->disable_renegotiation != MBEDTLS_SSL_RENEGOTIATION_DISABLED )
+        return;
+#endif
+
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    if( ssl->session->compression == MBEDTLS_SSL_COMPRESS_DEFLATE )
+        return;
+#endif
+
+    mfl = ssl_mfl_code_to_length( ssl->session->mfl_code );
+
+    if( mfl < MBEDTLS_SSL_IN_CONTENT_LEN )
+        *in_len  = MBEDTLS_SSL_IN_BUFFER_LEN - MBEDTLS_SSL_IN_CONTENT_LEN + mfl;
+    if( mfl < MBEDTLS_SSL_OUT_CONTENT_LEN )
+        *out_len = MBEDTLS_SSL_OUT_BUFFER_LEN - MBEDTLS_SSL_OUT_CONTENT_LEN + mfl;
+#endif /* MBEDTLS_SSL_MAX_FRAGMENT_LENGTH */
+}
+
+/*
+ * Allocate the record buffers released by mbedtls_ssl_release_buffers()
+ */
+static int ssl_regrow_buffers( mbedtls_ssl_context *ssl )
+{
+    int ret;
+    int in_released  = ( ssl->in_buf  == NULL );
+    int out_released = ( ssl->out_buf == NULL );
+    size_t in_len, out_len;
+
+    if( !in_released && !out_released )
+        return( 0 );
+
+    ssl_get_buffer_lens( ssl, &in_len, &out_len );
+    if( !in_released )
+        in_len  = ssl->in_buf_len;
+    if( !out_released )
+        out_len = ssl->out_buf_len;
+
+    if( ( ret = ssl_resize_buffers( ssl, in_len, out_len ) ) != 0 )
+        return( ret );
+
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+    if( ssl->conf->transport == MBEDTLS_SSL_TRANSPORT_DATAGRAM )
+    {
+        if( in_released )
+            ssl->in_hdr  = ssl->in_buf;
+        if( out_released )
+            ssl->out_hdr = ssl->out_buf;
+    }
+    else
+#endif /* MBEDTLS_SSL_PROTO_DTLS */
+    {
+        if( in_released )
+            ssl->in_hdr  = ssl->in_buf  + 8;
+        if( out_released )
+            ssl->out_hdr = ssl->out_buf + 8;
+    }
+
+    if( in_released )
+        ssl_update_in_pointers ( ssl, ssl->transform_in );
+    if( out_released )
+        ssl_update_out_pointers( ssl, ssl->transform_out );
+
+    return( 0 );
+}
+
+int mbedtls_ssl_release_buffers( mbedtls_ssl_context *ssl )
+{
+    if( ssl == NULL || ssl->conf == NULL ||
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER || ssl->handshake != NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Nothing is half read or left unread */
+    if( ssl->in_buf != NULL && ssl->in_left == 0 && ssl->in_msglen == 0 &&
+        ssl->in_offt == NULL && ssl->in_hslen == 0 &&
+        ssl->keep_current_message == 0
+#if defined(MBEDTLS_SSL_PROTO_DTLS)
+        && ssl->next_record_offset == 0
+#endif
+        )
+    {
+        memcpy( ssl->in_ctr_saved, ssl->in_buf, 8 );
+        mbedtls_platform_zeroize( ssl->in_buf, ssl->in_buf_len );
+        mbedtls_free( ssl->in_buf );
+
+        ssl->in_buf     = NULL;
+        ssl->in_buf_len = 0;
+        ssl->in_ctr     = NULL;
+        ssl->in_hdr     = NULL;
+        ssl->in_len     = NULL;
+        ssl->in_iv      = NULL;
+        ssl->in_msg     = NULL;
+    }
+
+    /* Nothing is left unsent */
+    if( ssl->out_buf != NULL && ssl->out_left == 0 )
+    {
+        mbedtls_platform_zeroize( ssl->out_buf, ssl->out_buf_len );
+        mbedtls_free( ssl->out_buf );
+
+        ssl->out_buf     = NULL;
+        ssl->out_buf_len = 0;
+        ssl->out_ctr     = NULL;
+        ssl->out_hdr     = NULL;
+        ssl->out_len     = NULL;
+        ssl->out_iv      = NULL;
+        ssl->out_msg     = NULL;
+    }
+
+    return( 0 );
+}
+
+size_t mbedtls_ssl_get_buffer_size( const mbedtls_ssl_context *ssl )
+{
+    return( ssl->in_buf_len + ssl->out_buf_len );
+}
+
+void mbedtls_ssl_conf_keep_traffic_keys( mbedtls_ssl_config *conf, int keep )
+{
+    conf->keep_traffic_keys = ( keep != 0 );
+}
+
+int mbedtls_ssl_export_traffic_keys( mbedtls_ssl_context *ssl,
+                                     mbedtls_ssl_traffic_keys *keys )
+{
+    mbedtls_ssl_transform *transform;
+    mbedtls_cipher_type_t cipher;
+    const unsigned char zeros[32] = { 0 };
+
+    if( ssl == NULL || ssl->conf == NULL || keys == NULL ||
+        ssl->state != MBEDTLS_SSL_HANDSHAKE_OVER || ssl->handshake != NULL )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    /* Whatever is buffered here would be lost to the new owner */
+    if( ssl->in_left != 0 || ssl->in_msglen != 0 || ssl->in_offt != NULL ||
+        ssl->in_hslen != 0 || ssl->keep_current_message != 0 ||
+        ssl->out_left != 0 )
+        return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
+
+    transform = ssl->transform_out;
+    if( transform == NULL || transform != ssl->transform_in ||
+        transform->cipher_ctx_enc.cipher_info == NULL ||
+        !ssl->conf->keep_traffic_keys ||
+        ssl->conf->transport != MBEDTLS_SSL_TRANSPORT_STREAM ||
+        ssl->minor_ver != MBEDTLS_SSL_MINOR_VERSION_3 ||
+        transform->maclen != 0 )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+
+#if defined(MBEDTLS_ZLIB_SUPPORT)
+    if( ssl->session->compression != MBEDTLS_SSL_COMPRESS_NULL )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+#endif
+
+    cipher = transform->cipher_ctx_enc.cipher_info->type;
+    if( cipher != MBEDTLS_CIPHER_AES_128_GCM &&
+        cipher != MBEDTLS_CIPHER_AES_256_GCM &&
+        cipher != MBEDTLS_CIPHER_CHACHA20_POLY1305 )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+
+    if( transform->keylen > sizeof( keys->key_enc ) ||
+        transform->fixed_ivlen > sizeof( keys->iv_enc ) ||
+        memcmp( transform->key_enc, zeros, transform->keylen ) == 0 )
+        return( MBEDTLS_ERR_SSL_FEATURE_UNAVAILABLE );
+
+    memset( keys, 0, sizeof( mbedtls_ssl_traffic_keys ) );
+    keys->cipher      = cipher;
+    keys->keylen      = transform->keylen;
+    keys->fixed_ivlen = transform->fixed_ivlen;
+    memcpy( keys->key_enc, transform->key_enc, transform->keylen );
+    memcpy( keys->key_dec, transform->key_dec, transform->keylen );
+    memcpy( keys->iv_enc,  transform->iv_enc,  transform->fixed_ivlen );
+    memcpy( keys->iv_dec,  transform->iv_dec,  transform->fixed_ivlen );
+    memcpy( keys->ctr_enc, ssl->cur_out_ctr, 8 );
+    memcpy( keys->ctr_dec,
+            ssl->in_buf != NULL ? ssl->in_ctr : ssl->in_ctr_saved, 8 );
+
+    mbedtls_platform_zeroize( transform->key_enc, sizeof( transform->key_enc ) );
+    mbedtls_platform_zeroize( transform->key_dec, sizeof( transform->key_dec ) );
+
+    return( 0 );
+}
+//// ]]]]
+
 /*
  * Setup an SSL context
  */
@@ -6829,6 +7107,7 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
+    ssl->in_buf_len = MBEDTLS_SSL_IN_BUFFER_LEN; ////
 
     ssl->out_buf = mbedtls_calloc( 1, MBEDTLS_SSL_OUT_BUFFER_LEN );
     if( ssl->out_buf == NULL )
@@ -6837,6 +7116,7 @@ int mbedtls_ssl_setup( mbedtls_ssl_context *ssl,
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto error;
     }
+    ssl->out_buf_len = MBEDTLS_SSL_OUT_BUFFER_LEN; ////
 
     ssl_reset_in_out_pointers( ssl );
 
@@ -6853,6 +7133,8 @@ error:
 
     ssl->in_buf = NULL;
     ssl->out_buf = NULL;
+    ssl->in_buf_len = 0;  ////
+    ssl->out_buf_len = 0; ////
 
     ssl->in_hdr = NULL;
     ssl->in_ctr = NULL;
@@ -6900,6 +7182,13 @@ static int ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
 #endif
     ssl->secure_renegotiation = MBEDTLS_SSL_LEGACY_RENEGOTIATION;
 
+    //// [[[[
+    /* A new handshake needs the full-size buffers */
+    if( ( ret = ssl_resize_buffers( ssl, MBEDTLS_SSL_IN_BUFFER_LEN,
+                                    MBEDTLS_SSL_OUT_BUFFER_LEN ) ) != 0 )
+        return( ret );
+    //// ]]]]
+
     ssl->in_offt = NULL;
     ssl_reset_in_out_pointers( ssl );
 
@@ -6934,14 +7223,14 @@ static int ssl_session_reset_int( mbedtls_ssl_context *ssl, int partial )
     ssl->session_in = NULL;
     ssl->session_out = NULL;
 
-    memset( ssl->out_buf, 0, MBEDTLS_SSL_OUT_BUFFER_LEN );
+    memset( ssl->out_buf, 0, ssl->out_buf_len ); ////
 
 #if defined(MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE) && defined(MBEDTLS_SSL_SRV_C)
     if( partial == 0 )
 #endif /* MBEDTLS_SSL_DTLS_CLIENT_PORT_REUSE && MBEDTLS_SSL_SRV_C */
     {
         ssl->in_left = 0;
-        memset( ssl->in_buf, 0, MBEDTLS_SSL_IN_BUFFER_LEN );
+        memset( ssl->in_buf, 0, ssl->in_buf_len ); ////
     }
 
 #if defined(MBEDTLS_SSL_HW_RECORD_ACCEL)
@@ -7167,6 +7456,15 @@ void mbedtls_ssl_conf_ciphersuites_for_version( mbedtls_ssl_config *conf,
     conf->ciphersuite_list[minor] = ciphersuites;
 }
 
+#if defined(MBEDTLS_SSL_SRV_C)
+//// [[[[
+void mbedtls_ssl_conf_preference_order( mbedtls_ssl_config *conf, int order )
+{
+    conf->respect_cli_pref = ( order == MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_CLIENT );
+}
+//// ]]]]
+#endif /* MBEDTLS_SSL_SRV_C */
+
 #if defined(MBEDTLS_X509_CRT_PARSE_C)
 void mbedtls_ssl_conf_cert_profile( mbedtls_ssl_config *conf,
                                     const mbedtls_x509_crt_profile *profile )
@@ -7996,6 +8294,9 @@ int mbedtls_ssl_handshake_step( mbedtls_ssl_context *ssl )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+    if( ssl_regrow_buffers( ssl ) != 0 )        ////
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED ); ////
+
 #if defined(MBEDTLS_SSL_CLI_C)
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_CLIENT )
         ret = mbedtls_ssl_handshake_client_step( ssl );
@@ -8116,6 +8417,9 @@ int mbedtls_ssl_renegotiate( mbedtls_ssl_context *ssl )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+    if( ssl_regrow_buffers( ssl ) != 0 )        ////
+        return( MBEDTLS_ERR_SSL_ALLOC_FAILED ); ////
+
 #if defined(MBEDTLS_SSL_SRV_C)
     /* On server, just send the request */
     if( ssl->conf->endpoint == MBEDTLS_SSL_IS_SERVER )
@@ -8204,6 +8508,9 @@ int mbedtls_ssl_read( mbedtls_ssl_context *ssl, unsigned char *buf, size_t len )
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+    if( ( ret = ssl_regrow_buffers( ssl ) ) != 0 ) ////
+        return( ret );                             ////
+
     MBEDTLS_SSL_DEBUG_MSG( 2, ( "=> read" ) );
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -8621,6 +8928,9 @@ int mbedtls_ssl_write( mbedtls_ssl_context *ssl, const unsigned char *buf, size_
     if( ssl == NULL || ssl->conf == NULL )
         return( MBEDTLS_ERR_SSL_BAD_INPUT_DATA );
 
+    if( ( ret = ssl_regrow_buffers( ssl ) ) != 0 ) ////
+        return( ret );                             ////
+
 #if defined(MBEDTLS_SSL_RENEGOTIATION)
     if( ( ret = ssl_check_ctr_renegotiate( ssl ) ) != 0 )
     {
@@ -8867,13 +9177,13 @@ void mbedtls_ssl_free( mbedtls_ssl_context *ssl )
 
     if( ssl->out_buf != NULL )
     {
-        mbedtls_platform_zeroize( ssl->out_buf, MBEDTLS_SSL_OUT_BUFFER_LEN );
+        mbedtls_platform_zeroize( ssl->out_buf, ssl->out_buf_len ); ////
         mbedtls_free( ssl->out_buf );
     }
 
     if( ssl->in_buf != NULL )
     {
-        mbedtls_platform_zeroize( ssl->in_buf, MBEDTLS_SSL_IN_BUFFER_LEN );
+        mbedtls_platform_zeroize( ssl->in_buf, ssl->in_buf_len ); ////
         mbedtls_free( ssl->in_buf );
     }
 
@@ -9036,6 +9346,11 @@ int mbedtls_ssl_config_defaults( mbedtls_ssl_config *conf,
 
 #if defined(MBEDTLS_SSL_SRV_C)
     conf->cert_req_ca_list = MBEDTLS_SSL_CERT_REQ_CA_LIST_ENABLED;
+#if defined(MBEDTLS_SSL_SRV_RESPECT_CLIENT_PREFERENCE) ////
+    conf->respect_cli_pref = MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_CLIENT; ////
+#else ////
+    conf->respect_cli_pref = MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_SERVER; ////
+#endif ////
 #endif
 
 #if defined(MBEDTLS_SSL_PROTO_DTLS)
@@ -19,6 +19,7 @@
 #include "pro_acceptor.h"
 #include "pro_event_handler.h"
 #include "pro_net.h"
+#include "pro_ring_io.h"
 #include "pro_tp_reactor_task.h"
 #include "../pro_shared/pro_shared.h"
 #include "../pro_util/pro_bsd_wrapper.h"
@@ -174,11 +175,15 @@ CProAcceptor::Init(IProAcceptorObserver* observer,
             goto EXIT;
         }
 
+        EnableRingIo(true); /* the multishot accept of an io_uring reactor */
+
         if (!reactorTask->AddHandler(sockId, this, PRO_MASK_ACCEPT))
         {
             goto EXIT;
         }
 
+        EnableRingIo(false);
+
 #if !defined(_WIN32) && !defined(_WIN32_WCE)
 
         sockIdUn = pbsd_socket(AF_LOCAL, SOCK_STREAM, 0);
@@ -252,8 +257,8 @@ EXIT:
 void
 CProAcceptor::Fini()
 {
-    IProAcceptorObserver*                     observer = NULL;
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE> handshaker2Nonce;
+    IProAcceptorObserver*                         observer = NULL;
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE> handshaker2Nonce;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -273,8 +278,8 @@ CProAcceptor::Fini()
         m_observer = NULL;
     }
 
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator       itr = handshaker2Nonce.begin();
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const end = handshaker2Nonce.end();
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator       itr = handshaker2Nonce.begin();
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const end = handshaker2Nonce.end();
 
     for (; itr != end; ++itr)
     {
@@ -340,7 +345,27 @@ CProAcceptor::OnInput(PRO_INT64 sockId)
             return;
         }
 
-        if (sockId == m_sockId)
+        if (sockId == m_sockId && GetRingIo() != NULL)
+        {
+            newSockId  = GetRingIo()->Accept();
+            unixSocket = false;
+
+            if (newSockId == -1)
+            {
+                SetWouldBlock(PRO_MASK_READ);
+
+                return;
+            }
+
+            if (!m_enableServiceExt &&
+                pbsd_getpeername(newSockId, &remoteAddr) != 0)
+            {
+                ProCloseSockId(newSockId);
+
+                return;
+            }
+        }
+        else if (sockId == m_sockId)
         {
             newSockId  = pbsd_accept(m_sockId, &remoteAddr);
             unixSocket = false;
@@ -462,7 +487,7 @@ CProAcceptor::OnHandshakeOk(IProTcpHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
             m_handshaker2Nonce.find(handshaker);
         if (itr == m_handshaker2Nonce.end())
         {
@@ -545,7 +570,7 @@ CProAcceptor::OnHandshakeError(IProTcpHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
             m_handshaker2Nonce.find(handshaker);
         if (itr == m_handshaker2Nonce.end())
         {
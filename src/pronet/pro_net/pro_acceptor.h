@@ -86,18 +86,18 @@ private:
 
 private:
 
-    const bool                                m_enableServiceExt;
-    IProAcceptorObserver*                     m_observer;
-    CProTpReactorTask*                        m_reactorTask;
-    PRO_INT64                                 m_sockId;
-    PRO_INT64                                 m_sockIdUn;
-    pbsd_sockaddr_in                          m_localAddr;
-    pbsd_sockaddr_un                          m_localAddrUn;
-    unsigned long                             m_timeoutInSeconds;
-
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE> m_handshaker2Nonce;
-
-    mutable CProThreadMutex                   m_lock;
+    const bool                                    m_enableServiceExt;
+    IProAcceptorObserver*                         m_observer;
+    CProTpReactorTask*                            m_reactorTask;
+    PRO_INT64                                     m_sockId;
+    PRO_INT64                                     m_sockIdUn;
+    pbsd_sockaddr_in                              m_localAddr;
+    pbsd_sockaddr_un                              m_localAddrUn;
+    unsigned long                                 m_timeoutInSeconds;
+
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE> m_handshaker2Nonce;
+
+    mutable CProThreadMutex                       m_lock;
 
     DECLARE_SGI_POOL(0)
 };
@@ -22,7 +22,10 @@
 #include "pro_notify_pipe.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stat.h"
 #include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
+#include <cstring>
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -32,6 +35,9 @@ CProBaseReactor::CProBaseReactor()
     m_threadId   = 0;
     m_wantExit   = false;
     m_notifyPipe = new CProNotifyPipe;
+
+    memset(&m_stats, 0, sizeof(PRO_REACTOR_STATS));
+    memset(&m_delta, 0, sizeof(PRO_REACTOR_STATS));
 }
 
 unsigned long
@@ -48,3 +54,84 @@ CProBaseReactor::GetHandlerCount() const
 
     return (count);
 }
+
+void
+PRO_CALLTYPE
+CProBaseReactor::GetStats(PRO_REACTOR_STATS& stats) const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    stats = m_stats;
+    stats.backend = GetBackend();
+
+    const unsigned long count = m_handlerMgr.GetHandlerCount();
+    stats.handlerCount = count > 0 ? count - 1 : 0; /* exclude the signal socket */
+}
+
+void
+CProBaseReactor::FlushStats()
+{
+    m_stats.loopCount   += m_delta.loopCount;
+    m_stats.loopBusyUs  += m_delta.loopBusyUs;
+    m_stats.eventCount  += m_delta.eventCount;
+    m_stats.upcallCount += m_delta.upcallCount;
+    m_stats.upcallUs    += m_delta.upcallUs;
+    m_stats.notifyCount += m_delta.notifyCount;
+
+    if (m_delta.loopBusyMaxUs > m_stats.loopBusyMaxUs)
+    {
+        m_stats.loopBusyMaxUs = m_delta.loopBusyMaxUs;
+    }
+    if (m_delta.eventMaxPerLoop > m_stats.eventMaxPerLoop)
+    {
+        m_stats.eventMaxPerLoop = m_delta.eventMaxPerLoop;
+    }
+    if (m_delta.upcallMaxUs > m_stats.upcallMaxUs)
+    {
+        m_stats.upcallMaxUs = m_delta.upcallMaxUs;
+    }
+
+    for (int i = 0; i < PRO_STAT_HISTOGRAM_SIZE; ++i)
+    {
+        m_stats.histogram[i] += m_delta.histogram[i];
+    }
+
+    memset(&m_delta, 0, sizeof(PRO_REACTOR_STATS));
+}
+
+void
+CProBaseReactor::AddUpcallStats(PRO_INT64& startUs)
+{
+    const PRO_INT64 nowUs    = ProGetTickCount64Us();
+    const PRO_INT64 upcallUs = nowUs - startUs;
+
+    ++m_delta.upcallCount;
+    m_delta.upcallUs += upcallUs;
+    if ((PRO_UINT64)upcallUs > m_delta.upcallMaxUs)
+    {
+        m_delta.upcallMaxUs = upcallUs;
+    }
+
+    startUs = nowUs;
+}
+
+void
+CProBaseReactor::AddLoopStats(PRO_INT64     wakeUs,
+                              PRO_INT64     doneUs,
+                              unsigned long eventCount)
+{
+    const PRO_INT64 busyUs = doneUs - wakeUs;
+
+    ++m_delta.loopCount;
+    m_delta.loopBusyUs += busyUs;
+    m_delta.eventCount += eventCount;
+    ++m_delta.histogram[ProStatHistogramIndex(busyUs)];
+    if ((PRO_UINT64)busyUs > m_delta.loopBusyMaxUs)
+    {
+        m_delta.loopBusyMaxUs = busyUs;
+    }
+    if (eventCount > m_delta.eventMaxPerLoop)
+    {
+        m_delta.eventMaxPerLoop = eventCount;
+    }
+}
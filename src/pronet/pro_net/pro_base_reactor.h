@@ -21,6 +21,7 @@
 
 #include "pro_event_handler.h"
 #include "pro_handler_mgr.h"
+#include "pro_net.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_thread_mutex.h"
@@ -60,10 +61,33 @@ public:
 
     virtual unsigned long PRO_CALLTYPE GetHandlerCount() const;
 
+    virtual void PRO_CALLTYPE GetStats(PRO_REACTOR_STATS& stats) const;
+
+    virtual PRO_REACTOR_BACKEND PRO_CALLTYPE GetBackend() const
+    {
+        return (PRO_RB_DEFAULT);
+    }
+
     virtual void PRO_CALLTYPE WorkerRun() = 0;
 
 protected:
 
+    /*
+     * The following are called by the worker thread only. The counters of
+     * a round are collected lock-free into m_delta, and are published into
+     * m_stats under m_lock at the beginning of the next round.
+     */
+
+    void FlushStats();
+
+    void AddUpcallStats(PRO_INT64& startUs);
+
+    void AddLoopStats(
+        PRO_INT64     wakeUs,
+        PRO_INT64     doneUs,
+        unsigned long eventCount
+        );
+
     virtual unsigned long PRO_CALLTYPE AddRef()
     {
         return (1);
@@ -80,6 +104,8 @@ protected:
     bool                    m_wantExit;
     CProHandlerMgr          m_handlerMgr;
     CProNotifyPipe*         m_notifyPipe;
+    PRO_REACTOR_STATS       m_stats;
+    PRO_REACTOR_STATS       m_delta;
     mutable CProThreadMutex m_lock;
 
     DECLARE_SGI_POOL(0)
@@ -0,0 +1,907 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#include "pro_bulk_connector.h"
+#include "pro_event_handler.h"
+#include "pro_net.h"
+#include "pro_notify_pipe.h"
+#include "pro_tp_reactor_task.h"
+#include "../pro_shared/pro_shared.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define SERVICE_HANDSHAKE_BYTES     4    /* serviceId + serviceOpt + (r) + (r+1) */
+#define DEFAULT_CONNECTS_PER_SECOND 2000 /* per io reactor */
+#define DEFAULT_TIMEOUT             20
+#define TICK_INTERVAL_MS            20
+#define BURST_MS                    100
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProBulkConn::CProBulkConn(CProBulkConnector*      connector,
+                           unsigned long           laneIndex,
+                           const pbsd_sockaddr_in& remoteAddr)
+                           :
+m_connector(connector),
+m_laneIndex(laneIndex),
+m_remoteAddr(remoteAddr)
+{
+    m_connector->AddRef();
+
+    m_sockId      = -1;
+    m_handshaking = false;
+    m_nonceSize   = 0;
+
+    memset(&m_nonce, 0, sizeof(PRO_NONCE));
+}
+
+CProBulkConn::~CProBulkConn()
+{
+    m_connector->Release();
+}
+
+void
+PRO_CALLTYPE
+CProBulkConn::OnInput(PRO_INT64 sockId)
+{
+    m_connector->OnConnInput(this, sockId);
+}
+
+void
+PRO_CALLTYPE
+CProBulkConn::OnOutput(PRO_INT64 sockId)
+{
+    m_connector->OnConnOutput(this, sockId);
+}
+
+void
+PRO_CALLTYPE
+CProBulkConn::OnException(PRO_INT64 sockId)
+{
+    m_connector->OnConnError(this, sockId);
+}
+
+void
+PRO_CALLTYPE
+CProBulkConn::OnError(PRO_INT64 sockId,
+                      long      errorCode)
+{
+    m_connector->OnConnError(this, sockId);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProBulkLane::CProBulkLane(CProBulkConnector* connector,
+                           unsigned long      laneIndex)
+                           :
+m_connector(connector),
+m_laneIndex(laneIndex)
+{
+    m_connector->AddRef();
+
+    m_ioReactor  = NULL;
+    m_tokens     = 0;
+    m_refillTick = 0;
+}
+
+CProBulkLane::~CProBulkLane()
+{
+    m_pipe.Fini();
+    m_connector->Release();
+}
+
+void
+PRO_CALLTYPE
+CProBulkLane::OnInput(PRO_INT64 sockId)
+{
+    m_connector->OnLaneInput(this, sockId);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProBulkConnector*
+CProBulkConnector::CreateInstance(bool          enableServiceExt,
+                                  unsigned char serviceId,
+                                  unsigned char serviceOpt)
+{
+    CProBulkConnector* const connector = new CProBulkConnector(
+        enableServiceExt, serviceId, serviceOpt);
+
+    return (connector);
+}
+
+CProBulkConnector::CProBulkConnector(bool          enableServiceExt,
+                                     unsigned char serviceId,
+                                     unsigned char serviceOpt)
+                                     :
+m_enableServiceExt(enableServiceExt),
+m_serviceId (enableServiceExt ? serviceId  : 0),
+m_serviceOpt(enableServiceExt ? serviceOpt : 0)
+{
+    m_observer          = NULL;
+    m_reactorTask       = NULL;
+    m_connectsPerSecond = DEFAULT_CONNECTS_PER_SECOND;
+    m_timeoutInSeconds  = DEFAULT_TIMEOUT;
+    m_timerId           = 0;
+    m_nextLane          = 0;
+}
+
+CProBulkConnector::~CProBulkConnector()
+{
+    Fini();
+}
+
+bool
+CProBulkConnector::Init(IProConnectorObserver* observer,
+                        CProTpReactorTask*     reactorTask,
+                        unsigned long          connectsPerSecond, /* = 0 */
+                        unsigned long          timeoutInSeconds)  /* = 0 */
+{
+    assert(observer != NULL);
+    assert(reactorTask != NULL);
+    if (observer == NULL || reactorTask == NULL)
+    {
+        return (false);
+    }
+
+    if (connectsPerSecond == 0)
+    {
+        connectsPerSecond = DEFAULT_CONNECTS_PER_SECOND;
+    }
+    if (timeoutInSeconds == 0)
+    {
+        timeoutInSeconds = DEFAULT_TIMEOUT;
+    }
+
+    const unsigned long laneCount = reactorTask->GetIoThreadCount();
+    if (laneCount == 0)
+    {
+        return (false);
+    }
+
+    double burst = (double)connectsPerSecond * BURST_MS / 1000;
+    if (burst < 1)
+    {
+        burst = 1;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_observer == NULL);
+        assert(m_reactorTask == NULL);
+        if (m_observer != NULL || m_reactorTask != NULL)
+        {
+            return (false);
+        }
+
+        const PRO_INT64 now = ProGetTickCount64();
+        bool            ok  = true;
+
+        for (int i = 0; i < (int)laneCount; ++i)
+        {
+            CProBaseReactor* const ioReactor = reactorTask->GetIoReactor(i);
+            if (ioReactor == NULL)
+            {
+                ok = false;
+                break;
+            }
+
+            CProBulkLane* const lane = new CProBulkLane(this, i);
+            lane->m_ioReactor  = ioReactor;
+            lane->m_tokens     = burst;
+            lane->m_refillTick = now;
+            lane->m_pipe.Init();
+
+            const PRO_INT64 sockId = lane->m_pipe.GetReaderSockId();
+
+            lane->SetReactor(ioReactor); /* pin it */
+            if (sockId == -1 ||
+                !reactorTask->AddHandler(sockId, lane, PRO_MASK_READ))
+            {
+                lane->Release();
+                ok = false;
+                break;
+            }
+
+            m_lanes.push_back(lane);
+        }
+
+        if (ok)
+        {
+            m_timerId = reactorTask->ScheduleTimer(
+                this, TICK_INTERVAL_MS, true, 0);
+            ok = m_timerId != 0;
+        }
+
+        if (!ok)
+        {
+            int       i = 0;
+            const int c = (int)m_lanes.size();
+
+            for (; i < c; ++i)
+            {
+                CProBulkLane* const lane = m_lanes[i];
+                reactorTask->RemoveHandler(
+                    lane->m_pipe.GetReaderSockId(), lane, PRO_MASK_READ);
+                lane->Release();
+            }
+
+            m_lanes.clear();
+
+            return (false);
+        }
+
+        observer->AddRef();
+        m_observer          = observer;
+        m_reactorTask       = reactorTask;
+        m_connectsPerSecond = connectsPerSecond;
+        m_timeoutInSeconds  = timeoutInSeconds;
+    }
+
+    return (true);
+}
+
+void
+CProBulkConnector::Fini()
+{
+    IProConnectorObserver*       observer = NULL;
+    CProStlVector<CProBulkConn*> conns;
+    CProStlVector<CProBulkLane*> lanes;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        m_reactorTask->CancelTimer(m_timerId);
+        m_timerId = 0;
+
+        CProStlMultimap<PRO_INT64, CProBulkConn*>::iterator       itr = m_deadlines.begin();
+        CProStlMultimap<PRO_INT64, CProBulkConn*>::iterator const end = m_deadlines.end();
+
+        for (; itr != end; ++itr)
+        {
+            CProBulkConn* const conn = itr->second;
+            m_reactorTask->RemoveHandler(
+                conn->m_sockId, conn, PRO_MASK_CONNECT | PRO_MASK_READ);
+            ProCloseSockId(conn->m_sockId);
+            conn->m_sockId = -1;
+            conns.push_back(conn);
+        }
+
+        m_deadlines.clear();
+
+        int       i = 0;
+        const int c = (int)m_lanes.size();
+
+        for (; i < c; ++i)
+        {
+            CProBulkLane* const lane = m_lanes[i];
+            m_reactorTask->RemoveHandler(
+                lane->m_pipe.GetReaderSockId(), lane, PRO_MASK_READ);
+            lane->m_targets.clear();
+            lanes.push_back(lane);
+        }
+
+        m_lanes.clear();
+
+        m_reactorTask = NULL;
+        observer = m_observer;
+        m_observer = NULL;
+    }
+
+    int       i = 0;
+    const int c = (int)conns.size();
+
+    for (; i < c; ++i)
+    {
+        conns[i]->Release();
+    }
+
+    int       j = 0;
+    const int d = (int)lanes.size();
+
+    for (; j < d; ++j)
+    {
+        lanes[j]->Release();
+    }
+
+    observer->Release();
+}
+
+unsigned long
+CProBulkConnector::Connect(const PRO_CONNECT_TARGET* targets,
+                           unsigned long             count)
+{
+    assert(targets != NULL);
+    assert(count > 0);
+    if (targets == NULL || count == 0)
+    {
+        return (0);
+    }
+
+    CProStlVector<PRO_BULK_TARGET> bulkTargets;
+    bulkTargets.reserve(count);
+
+    int       i = 0;
+    const int c = (int)count;
+
+    for (; i < c; ++i)
+    {
+        const char* const remoteIp    = targets[i].remoteIp;
+        const char*       localBindIp = targets[i].localBindIp;
+        if (remoteIp == NULL || remoteIp[0] == '\0' ||
+            targets[i].remotePort == 0)
+        {
+            continue;
+        }
+
+        if (localBindIp == NULL || localBindIp[0] == '\0')
+        {
+            localBindIp = "0.0.0.0";
+        }
+
+        PRO_BULK_TARGET target;
+        memset(&target, 0, sizeof(PRO_BULK_TARGET));
+        target.localAddr.sin_family       = AF_INET;
+        target.localAddr.sin_addr.s_addr  = pbsd_inet_aton(localBindIp);
+        target.remoteAddr.sin_family      = AF_INET;
+        target.remoteAddr.sin_port        = pbsd_hton16(targets[i].remotePort);
+        target.remoteAddr.sin_addr.s_addr = pbsd_inet_aton(remoteIp); /* DNS */
+
+        if (target.localAddr.sin_addr.s_addr  == (PRO_UINT32)-1 ||
+            target.remoteAddr.sin_addr.s_addr == (PRO_UINT32)-1 ||
+            target.remoteAddr.sin_addr.s_addr == 0)
+        {
+            continue;
+        }
+
+        bulkTargets.push_back(target);
+    }
+
+    if (bulkTargets.size() == 0)
+    {
+        return (0);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return (0);
+        }
+
+        const unsigned long laneCount = (unsigned long)m_lanes.size();
+
+        int       j = 0;
+        const int d = (int)bulkTargets.size();
+
+        for (; j < d; ++j)
+        {
+            m_lanes[m_nextLane % laneCount]->m_targets.push_back(bulkTargets[j]);
+            ++m_nextLane;
+        }
+
+        int       k = 0;
+        const int e = (int)laneCount;
+
+        for (; k < e; ++k)
+        {
+            if (m_lanes[k]->m_targets.size() > 0)
+            {
+                m_lanes[k]->m_pipe.Notify();
+            }
+        }
+    }
+
+    return ((unsigned long)bulkTargets.size());
+}
+
+unsigned long
+PRO_CALLTYPE
+CProBulkConnector::AddRef()
+{
+    const unsigned long refCount = CProEventHandler::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CProBulkConnector::Release()
+{
+    const unsigned long refCount = CProEventHandler::Release();
+
+    return (refCount);
+}
+
+void
+CProBulkConnector::OnLaneInput(CProBulkLane* lane,
+                               PRO_INT64     sockId)
+{
+    assert(lane != NULL);
+    assert(sockId != -1);
+    if (lane == NULL || sockId == -1)
+    {
+        return;
+    }
+
+    IProConnectorObserver*         observer = NULL;
+    CProStlVector<PRO_BULK_RESULT> results;
+    CProStlVector<CProBulkConn*>   doneConns;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        if (sockId != lane->m_pipe.GetReaderSockId())
+        {
+            return;
+        }
+
+        lane->m_pipe.Recv();
+        lane->m_pipe.EnableNotify();
+
+        IssueConnects_i(lane, results);
+        if (results.size() == 0)
+        {
+            return;
+        }
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    Report(observer, results, false, doneConns);
+}
+
+void
+CProBulkConnector::OnConnOutput(CProBulkConn* conn,
+                                PRO_INT64     sockId)
+{
+    assert(conn != NULL);
+    assert(sockId != -1);
+    if (conn == NULL || sockId == -1)
+    {
+        return;
+    }
+
+    IProConnectorObserver*         observer = NULL;
+    CProStlVector<PRO_BULK_RESULT> results;
+    CProStlVector<CProBulkConn*>   doneConns;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        if (sockId != conn->m_sockId || conn->m_handshaking)
+        {
+            return;
+        }
+
+        if (m_enableServiceExt)
+        {
+            unsigned char serviceData[SERVICE_HANDSHAKE_BYTES];
+            serviceData[0] = m_serviceId;                          /* serviceId */
+            serviceData[1] = m_serviceOpt;                         /* serviceOpt */
+            serviceData[2] = (unsigned char)(ProRand_0_1() * 255); /* r */
+            serviceData[3] = (unsigned char)(serviceData[2] + 1);  /* r + 1 */
+
+            m_reactorTask->RemoveHandler(sockId, conn, PRO_MASK_CONNECT);
+
+            /*
+             * the send buffer of a new connection always takes them
+             */
+            if (pbsd_send(sockId, serviceData, sizeof(serviceData), 0) ==
+                (int)sizeof(serviceData) &&
+                AddConnHandler_i(conn, PRO_MASK_READ))
+            {
+                conn->m_handshaking = true;
+
+                return;
+            }
+
+            RemoveConn_i(conn, false, results, doneConns);
+        }
+        else
+        {
+            RemoveConn_i(conn, true, results, doneConns);
+        }
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    Report(observer, results, false, doneConns);
+}
+
+void
+CProBulkConnector::OnConnInput(CProBulkConn* conn,
+                               PRO_INT64     sockId)
+{
+    assert(conn != NULL);
+    assert(sockId != -1);
+    if (conn == NULL || sockId == -1)
+    {
+        return;
+    }
+
+    IProConnectorObserver*         observer = NULL;
+    CProStlVector<PRO_BULK_RESULT> results;
+    CProStlVector<CProBulkConn*>   doneConns;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        if (sockId != conn->m_sockId)
+        {
+            return;
+        }
+
+        bool ok = false;
+
+        if (conn->m_handshaking)
+        {
+            const size_t idleSize = sizeof(PRO_NONCE) - conn->m_nonceSize;
+            const int    recvSize = pbsd_recv(sockId,
+                (char*)&conn->m_nonce + conn->m_nonceSize, (int)idleSize, 0);
+
+            if (recvSize > 0 && recvSize <= (int)idleSize)
+            {
+                conn->m_nonceSize += recvSize;
+                if (conn->m_nonceSize < sizeof(PRO_NONCE))
+                {
+                    return;
+                }
+
+                ok = true;
+            }
+            else if (recvSize < 0 &&
+                pbsd_errno((void*)&pbsd_recv) == PBSD_EWOULDBLOCK)
+            {
+                return;
+            }
+            else
+            {
+            }
+        }
+
+        RemoveConn_i(conn, ok, results, doneConns);
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    Report(observer, results, false, doneConns);
+}
+
+void
+CProBulkConnector::OnConnError(CProBulkConn* conn,
+                               PRO_INT64     sockId)
+{
+    assert(conn != NULL);
+    assert(sockId != -1);
+    if (conn == NULL || sockId == -1)
+    {
+        return;
+    }
+
+    IProConnectorObserver*         observer = NULL;
+    CProStlVector<PRO_BULK_RESULT> results;
+    CProStlVector<CProBulkConn*>   doneConns;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        if (sockId != conn->m_sockId)
+        {
+            return;
+        }
+
+        RemoveConn_i(conn, false, results, doneConns);
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    Report(observer, results, false, doneConns);
+}
+
+void
+PRO_CALLTYPE
+CProBulkConnector::OnTimer(void*      factory,
+                           PRO_UINT64 timerId,
+                           PRO_INT64  userData)
+{
+    assert(factory != NULL);
+    assert(timerId > 0);
+    if (factory == NULL || timerId == 0)
+    {
+        return;
+    }
+
+    IProConnectorObserver*         observer = NULL;
+    CProStlVector<PRO_BULK_RESULT> results;
+    CProStlVector<CProBulkConn*>   doneConns;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_timerId)
+        {
+            return;
+        }
+
+        int       i = 0;
+        const int c = (int)m_lanes.size();
+
+        for (; i < c; ++i)
+        {
+            if (m_lanes[i]->m_targets.size() > 0)
+            {
+                m_lanes[i]->m_pipe.Notify(); /* the budget has been refilled */
+            }
+        }
+
+        const PRO_INT64 now = ProGetTickCount64();
+
+        while (m_deadlines.size() > 0 && m_deadlines.begin()->first <= now)
+        {
+            RemoveConn_i(m_deadlines.begin()->second, false, results, doneConns);
+        }
+
+        if (results.size() == 0)
+        {
+            return;
+        }
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    Report(observer, results, true, doneConns); /* timeout */
+}
+
+void
+CProBulkConnector::IssueConnects_i(CProBulkLane*                   lane,
+                                   CProStlVector<PRO_BULK_RESULT>& results)
+{
+    assert(lane != NULL);
+
+    const PRO_INT64 now = ProGetTickCount64();
+
+    double burst = (double)m_connectsPerSecond * BURST_MS / 1000;
+    if (burst < 1)
+    {
+        burst = 1;
+    }
+
+    lane->m_tokens += (double)m_connectsPerSecond * (now - lane->m_refillTick) / 1000;
+    if (lane->m_tokens > burst)
+    {
+        lane->m_tokens = burst;
+    }
+    lane->m_refillTick = now;
+
+    while (lane->m_tokens >= 1 && lane->m_targets.size() > 0)
+    {
+        const PRO_BULK_TARGET target = lane->m_targets.front();
+        lane->m_targets.pop_front();
+        lane->m_tokens -= 1;
+
+        CProBulkConn* conn   = NULL;
+        PRO_INT64     sockId = pbsd_socket(AF_INET, SOCK_STREAM, 0);
+
+        do
+        {
+            if (sockId == -1)
+            {
+                break;
+            }
+
+            const int option = 1;
+            pbsd_setsockopt(
+                sockId, IPPROTO_TCP, TCP_NODELAY, &option, sizeof(int));
+
+            /*
+             * binding to 0.0.0.0:0 would take an ephemeral port of its
+             * own for each socket, and exhaust them long before the
+             * 4-tuples run out. Let connect() choose it instead
+             */
+            if (target.localAddr.sin_addr.s_addr != 0)
+            {
+#if defined(IP_BIND_ADDRESS_NO_PORT)
+                pbsd_setsockopt(sockId, IPPROTO_IP,
+                    IP_BIND_ADDRESS_NO_PORT, &option, sizeof(int));
+#endif
+                if (pbsd_bind(sockId, &target.localAddr, false) != 0)
+                {
+                    break;
+                }
+            }
+
+            if (pbsd_connect(sockId, &target.remoteAddr) != 0 &&
+                pbsd_errno((void*)&pbsd_connect) != PBSD_EINPROGRESS)
+            {
+                break;
+            }
+
+            conn = new CProBulkConn(this, lane->m_laneIndex, target.remoteAddr);
+            conn->m_sockId = sockId;
+
+            if (!AddConnHandler_i(conn, PRO_MASK_CONNECT))
+            {
+                conn->m_sockId = -1;
+                conn->Release();
+                conn = NULL;
+                break;
+            }
+
+            conn->m_deadlineItr = m_deadlines.insert(std::make_pair(
+                now + (PRO_INT64)m_timeoutInSeconds * 1000, conn));
+        }
+        while (0);
+
+        if (conn == NULL)
+        {
+            ProCloseSockId(sockId);
+
+            PRO_BULK_RESULT result;
+            memset(&result, 0, sizeof(PRO_BULK_RESULT));
+            result.sockId     = -1;
+            result.remoteAddr = target.remoteAddr;
+            results.push_back(result);
+        }
+    }
+}
+
+bool
+CProBulkConnector::AddConnHandler_i(CProBulkConn* conn,
+                                    unsigned long mask)
+{
+    assert(conn != NULL);
+
+    conn->SetReactor(m_lanes[conn->m_laneIndex]->m_ioReactor); /* the lane's */
+
+    return (m_reactorTask->AddHandler(conn->m_sockId, conn, mask));
+}
+
+void
+CProBulkConnector::RemoveConn_i(CProBulkConn*                   conn,
+                                bool                            ok,
+                                CProStlVector<PRO_BULK_RESULT>& results,
+                                CProStlVector<CProBulkConn*>&   doneConns)
+{
+    assert(conn != NULL);
+    assert(conn->m_sockId != -1);
+
+    m_reactorTask->RemoveHandler(
+        conn->m_sockId, conn, PRO_MASK_CONNECT | PRO_MASK_READ);
+    m_deadlines.erase(conn->m_deadlineItr);
+
+    PRO_BULK_RESULT result;
+    memset(&result, 0, sizeof(PRO_BULK_RESULT));
+    result.sockId     = ok ? conn->m_sockId : -1;
+    result.remoteAddr = conn->m_remoteAddr;
+    result.hasNonce   = ok && conn->m_handshaking;
+    result.nonce      = conn->m_nonce;
+    results.push_back(result);
+
+    if (!ok)
+    {
+        ProCloseSockId(conn->m_sockId);
+    }
+    conn->m_sockId = -1; /* cut */
+
+    doneConns.push_back(conn);
+}
+
+void
+CProBulkConnector::Report(IProConnectorObserver*                observer,
+                          const CProStlVector<PRO_BULK_RESULT>& results,
+                          bool                                  timeout,
+                          CProStlVector<CProBulkConn*>&         doneConns)
+{
+    assert(observer != NULL);
+
+    int       i = 0;
+    const int c = (int)results.size();
+
+    for (; i < c; ++i)
+    {
+        const PRO_BULK_RESULT& result = results[i];
+
+        char remoteIp[64] = "";
+        pbsd_inet_ntoa(result.remoteAddr.sin_addr.s_addr, remoteIp);
+
+        if (result.sockId != -1)
+        {
+            observer->OnConnectOk(
+                (IProConnector*)this,
+                result.sockId,
+                false, /* unixSocket */
+                remoteIp,
+                pbsd_ntoh16(result.remoteAddr.sin_port),
+                m_serviceId,
+                m_serviceOpt,
+                result.hasNonce ? &result.nonce : NULL
+                );
+        }
+        else
+        {
+            observer->OnConnectError(
+                (IProConnector*)this,
+                remoteIp,
+                pbsd_ntoh16(result.remoteAddr.sin_port),
+                m_serviceId,
+                m_serviceOpt,
+                timeout
+                );
+        }
+    }
+
+    observer->Release();
+
+    int       j = 0;
+    const int d = (int)doneConns.size();
+
+    for (; j < d; ++j)
+    {
+        doneConns[j]->Release();
+    }
+}
@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#if !defined(PRO_BULK_CONNECTOR_H)
+#define PRO_BULK_CONNECTOR_H
+
+#include "pro_event_handler.h"
+#include "pro_net.h"
+#include "pro_notify_pipe.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CProBulkConnector;
+class CProTpReactorTask;
+
+struct PRO_BULK_TARGET
+{
+    pbsd_sockaddr_in localAddr;
+    pbsd_sockaddr_in remoteAddr;
+};
+
+struct PRO_BULK_RESULT
+{
+    PRO_INT64        sockId; /* -1 for an error */
+    pbsd_sockaddr_in remoteAddr;
+    bool             hasNonce;
+    PRO_NONCE        nonce;
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * a connection in flight. The members are guarded by the connector's lock
+ */
+class CProBulkConn : public CProEventHandler
+{
+public:
+
+    CProBulkConn(
+        CProBulkConnector*      connector,
+        unsigned long           laneIndex,
+        const pbsd_sockaddr_in& remoteAddr
+        );
+
+    virtual ~CProBulkConn();
+
+    virtual void PRO_CALLTYPE OnInput(PRO_INT64 sockId);
+
+    virtual void PRO_CALLTYPE OnOutput(PRO_INT64 sockId);
+
+    virtual void PRO_CALLTYPE OnException(PRO_INT64 sockId);
+
+    virtual void PRO_CALLTYPE OnError(
+        PRO_INT64 sockId,
+        long      errorCode
+        );
+
+public:
+
+    CProBulkConnector* const                            m_connector;
+    const unsigned long                                 m_laneIndex;
+    const pbsd_sockaddr_in                              m_remoteAddr;
+    PRO_INT64                                           m_sockId;
+    bool                                                m_handshaking;
+    size_t                                              m_nonceSize;
+    PRO_NONCE                                           m_nonce;
+    CProStlMultimap<PRO_INT64, CProBulkConn*>::iterator m_deadlineItr;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * a lane pinned to an io reactor. The members are guarded by the
+ * connector's lock
+ */
+class CProBulkLane : public CProEventHandler
+{
+public:
+
+    CProBulkLane(
+        CProBulkConnector* connector,
+        unsigned long      laneIndex
+        );
+
+    virtual ~CProBulkLane();
+
+    virtual void PRO_CALLTYPE OnInput(PRO_INT64 sockId);
+
+public:
+
+    CProBulkConnector* const      m_connector;
+    const unsigned long           m_laneIndex;
+    CProBaseReactor*              m_ioReactor;
+    CProNotifyPipe                m_pipe;
+    CProStlDeque<PRO_BULK_TARGET> m_targets;
+    double                        m_tokens;
+    PRO_INT64                     m_refillTick;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * The bulk connector opens a large number of outbound connections without
+ * a timer or a handshaker per connection.
+ *
+ * It has a lane per io reactor. The targets are spread over the lanes
+ * round-robin, and each lane issues its connects from its own io thread,
+ * at most connectsPerSecond per second. The sockets stay on the io thread
+ * of their lane.
+ *
+ * The deadlines of all the connections in flight are kept in one ordered
+ * map. A single recurring timer expires them, and wakes up the lanes that
+ * have targets left after their budget has been refilled.
+ *
+ * With the service extension, the connector sends (serviceId, serviceOpt)
+ * and receives the nonce by itself.
+ */
+class CProBulkConnector : public CProEventHandler
+{
+public:
+
+    static CProBulkConnector* CreateInstance(
+        bool          enableServiceExt,
+        unsigned char serviceId,
+        unsigned char serviceOpt
+        );
+
+    bool Init(
+        IProConnectorObserver* observer,
+        CProTpReactorTask*     reactorTask,
+        unsigned long          connectsPerSecond, /* = 0 */
+        unsigned long          timeoutInSeconds   /* = 0 */
+        );
+
+    void Fini();
+
+    unsigned long Connect(
+        const PRO_CONNECT_TARGET* targets,
+        unsigned long             count
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+    void OnLaneInput(
+        CProBulkLane* lane,
+        PRO_INT64     sockId
+        );
+
+    void OnConnOutput(
+        CProBulkConn* conn,
+        PRO_INT64     sockId
+        );
+
+    void OnConnInput(
+        CProBulkConn* conn,
+        PRO_INT64     sockId
+        );
+
+    void OnConnError(
+        CProBulkConn* conn,
+        PRO_INT64     sockId
+        );
+
+private:
+
+    CProBulkConnector(
+        bool          enableServiceExt,
+        unsigned char serviceId,
+        unsigned char serviceOpt
+        );
+
+    virtual ~CProBulkConnector();
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+    void IssueConnects_i(
+        CProBulkLane*                   lane,
+        CProStlVector<PRO_BULK_RESULT>& results
+        );
+
+    bool AddConnHandler_i(
+        CProBulkConn* conn,
+        unsigned long mask
+        );
+
+    void RemoveConn_i(
+        CProBulkConn*                   conn,
+        bool                            ok,
+        CProStlVector<PRO_BULK_RESULT>& results,
+        CProStlVector<CProBulkConn*>&   doneConns
+        );
+
+    void Report(
+        IProConnectorObserver*                observer,
+        const CProStlVector<PRO_BULK_RESULT>& results,
+        bool                                  timeout,
+        CProStlVector<CProBulkConn*>&         doneConns
+        );
+
+private:
+
+    const bool                                m_enableServiceExt;
+    const unsigned char                       m_serviceId;
+    const unsigned char                       m_serviceOpt;
+    IProConnectorObserver*                    m_observer;
+    CProTpReactorTask*                        m_reactorTask;
+    unsigned long                             m_connectsPerSecond;
+    unsigned long                             m_timeoutInSeconds;
+    PRO_UINT64                                m_timerId;
+    CProStlVector<CProBulkLane*>              m_lanes;
+    unsigned long                             m_nextLane;
+    CProStlMultimap<PRO_INT64, CProBulkConn*> m_deadlines;
+    CProThreadMutex                           m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* PRO_BULK_CONNECTOR_H */
@@ -48,8 +48,40 @@
 #define PRO_EPOLLEX_SET  EPOLLPRI
 #define PRO_EPOLLHUP     EPOLLHUP
 #define PRO_EPOLLERR     EPOLLERR
+#define PRO_EPOLLET      EPOLLET
 
-static char g_s_buffer[1024];
+/*
+ * a private mask of the dispatching list. The handler is called repeatedly
+ * within PRO_EPOLLET_BUDGET, and then the masks it reported as would-block
+ * are fed back in the same field
+ */
+static const unsigned long PRO_MASK_EDGE = 1 << 16;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+short
+PRO_CALLTYPE
+MaskToEvents_i(unsigned long mask)
+{
+    short events = 0;
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_WRITE))
+    {
+        events |= PRO_EPOLLOUT_SET;
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_READ))
+    {
+        events |= PRO_EPOLLIN_SET;
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
+    {
+        events |= PRO_EPOLLEX_SET;
+    }
+
+    return (events);
+}
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -210,32 +242,91 @@ CProEpollReactor::AddHandler(PRO_INT64         sockId,
             return (true);
         }
 
-        short oldEvents = 0;
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_WRITE))
-        {
-            oldEvents |= PRO_EPOLLOUT_SET;
-        }
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_READ))
-        {
-            oldEvents |= PRO_EPOLLIN_SET;
-        }
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_EXCEPTION))
+#if !defined(PRO_LACKS_EPOLLET)
+        CProStlMap<PRO_INT64, unsigned long>::const_iterator const itr =
+            m_edgeReadyMasks.find(sockId);
+        if (itr != m_edgeReadyMasks.end())
         {
-            oldEvents |= PRO_EPOLLEX_SET;
-        }
+            /*
+             * the socket is in the kernel with EPOLLET. It's only a mask change
+             * of the handler, and the worker thread is woken up only if the
+             * socket is known to be ready for the new mask
+             */
+            assert(!PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION));
 
-        short events = oldEvents;
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_WRITE))
-        {
-            events |= PRO_EPOLLOUT_SET;
+            if (!m_handlerMgr.AddHandler(sockId, handler, mask))
+            {
+                return (false);
+            }
+
+            if ((itr->second & mask) != 0)
+            {
+                m_edgeRunnables.insert(sockId);
+
+                if (ProGetThreadId() != m_threadId)
+                {
+                    m_notifyPipe->Notify();
+                }
+            }
+
+            return (true);
         }
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_READ))
+
+        if (oldInfo.handler == NULL && handler->IsEdgeTrigger() &&
+            !PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
         {
-            events |= PRO_EPOLLIN_SET;
+            pbsd_epoll_event ev;
+            memset(&ev, 0, sizeof(pbsd_epoll_event));
+            ev.events  = PRO_EPOLLIN_SET | PRO_EPOLLOUT_SET | PRO_EPOLLET;
+            ev.data.fd = (int)sockId;
+
+            if (pbsd_epoll_ctl(m_epfd, EPOLL_CTL_ADD, ev.data.fd, &ev) != 0)
+            {
+                return (false);
+            }
+
+            if (!m_handlerMgr.AddHandler(sockId, handler, mask))
+            {
+                pbsd_epoll_ctl(m_epfd, EPOLL_CTL_DEL, ev.data.fd, &ev); /* rollback */
+
+                return (false);
+            }
+
+            m_edgeReadyMasks[sockId] = 0;
+
+            return (true);
         }
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
+#endif /* PRO_LACKS_EPOLLET */
+
+        const short oldEvents = MaskToEvents_i(oldInfo.mask);
+        const short events    = MaskToEvents_i(oldInfo.mask | mask);
+
+        if (oldEvents != 0)
         {
-            events |= PRO_EPOLLEX_SET;
+            /*
+             * a mask change of a registered socket. It's deferred and applied
+             * by the worker thread at the beginning of the next round
+             */
+            if (!m_handlerMgr.AddHandler(sockId, handler, mask))
+            {
+                return (false);
+            }
+
+            CProStlMap<PRO_INT64, short>::const_iterator const itr =
+                m_pendingEvents.find(sockId);
+            const short kernelEvents =
+                itr != m_pendingEvents.end() ? itr->second : oldEvents;
+            if (itr == m_pendingEvents.end())
+            {
+                m_pendingEvents[sockId] = oldEvents;
+            }
+
+            if ((events & ~kernelEvents) != 0 && ProGetThreadId() != m_threadId)
+            {
+                m_notifyPipe->Notify();
+            }
+
+            return (true);
         }
 
         pbsd_epoll_event ev;
@@ -243,42 +334,17 @@ CProEpollReactor::AddHandler(PRO_INT64         sockId,
         ev.events  = events;
         ev.data.fd = (int)sockId;
 
-        int retc = -1;
-        if (oldEvents == 0)
-        {
-            retc = pbsd_epoll_ctl(m_epfd, EPOLL_CTL_ADD, ev.data.fd, &ev);
-        }
-        else
-        {
-            retc = pbsd_epoll_ctl(m_epfd, EPOLL_CTL_MOD, ev.data.fd, &ev);
-        }
-        if (retc != 0)
+        if (pbsd_epoll_ctl(m_epfd, EPOLL_CTL_ADD, ev.data.fd, &ev) != 0)
         {
             return (false);
         }
 
         if (!m_handlerMgr.AddHandler(sockId, handler, mask))
         {
-            /*
-             * rollback
-             */
-            if (oldEvents == 0)
-            {
-                pbsd_epoll_ctl(m_epfd, EPOLL_CTL_DEL, ev.data.fd, &ev);
-            }
-            else
-            {
-                ev.events = oldEvents;
-                pbsd_epoll_ctl(m_epfd, EPOLL_CTL_MOD, ev.data.fd, &ev);
-            }
+            pbsd_epoll_ctl(m_epfd, EPOLL_CTL_DEL, ev.data.fd, &ev); /* rollback */
 
             return (false);
         }
-
-        if (ProGetThreadId() != m_threadId)
-        {
-            m_notifyPipe->Notify();
-        }
     }
 
     return (true);
@@ -329,54 +395,36 @@ CProEpollReactor::RemoveHandler(PRO_INT64     sockId,
             return;
         }
 
-        short oldEvents = 0;
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_WRITE))
-        {
-            oldEvents |= PRO_EPOLLOUT_SET;
-        }
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_READ))
-        {
-            oldEvents |= PRO_EPOLLIN_SET;
-        }
-        if (PRO_BIT_ENABLED(oldInfo.mask, PRO_MASK_EXCEPTION))
-        {
-            oldEvents |= PRO_EPOLLEX_SET;
-        }
-
-        short events = oldEvents;
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_WRITE))
-        {
-            events &= ~PRO_EPOLLOUT_SET;
-        }
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_READ))
-        {
-            events &= ~PRO_EPOLLIN_SET;
-        }
-        if (PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
-        {
-            events &= ~PRO_EPOLLEX_SET;
-        }
-
-        pbsd_epoll_event ev;
-        memset(&ev, 0, sizeof(pbsd_epoll_event));
-        ev.events  = events;
-        ev.data.fd = (int)sockId;
+        const short oldEvents = MaskToEvents_i(oldInfo.mask);
+        const short events    = MaskToEvents_i(oldInfo.mask & ~mask);
 
         if (events == 0)
         {
+            pbsd_epoll_event ev;
+            memset(&ev, 0, sizeof(pbsd_epoll_event));
+            ev.data.fd = (int)sockId;
+
             pbsd_epoll_ctl(m_epfd, EPOLL_CTL_DEL, ev.data.fd, &ev);
+            m_pendingEvents.erase(sockId);
+            m_edgeReadyMasks.erase(sockId);
+            m_edgeRunnables.erase(sockId);
         }
-        else
+        else if (m_edgeReadyMasks.find(sockId) != m_edgeReadyMasks.end())
         {
-            pbsd_epoll_ctl(m_epfd, EPOLL_CTL_MOD, ev.data.fd, &ev);
+            /*
+             * EPOLLET. Nothing to do with the kernel
+             */
         }
-
-        m_handlerMgr.RemoveHandler(sockId, mask);
-
-        if (ProGetThreadId() != m_threadId)
+        else if (m_pendingEvents.find(sockId) == m_pendingEvents.end())
         {
-            m_notifyPipe->Notify();
+            /*
+             * no wakeup is needed. A stale event of the kernel at most wakes
+             * the worker thread once, and then the change will be applied
+             */
+            m_pendingEvents[sockId] = oldEvents;
         }
+
+        m_handlerMgr.RemoveHandler(sockId, mask);
     }
 }
 
@@ -390,28 +438,46 @@ CProEpollReactor::WorkerRun()
         m_threadId = ProGetThreadId();
     }
 
+    CProStlVector<CProEventHandler*> retired;
+
     while (1)
     {
+        int timeout = -1;
+
         {
             CProThreadMutexGuard mon(m_lock);
 
+            m_handlerMgr.LeaveEpoch(retired); /* the upcalls of the last loop are over */
+            FlushStats();
+
             if (m_epfd == -1 || m_wantExit)
             {
                 break;
             }
+
+            ApplyPendingEvents();
+
+            if (!m_edgeRunnables.empty())
+            {
+                timeout = 0; /* go on with the handlers out of budget */
+            }
         }
 
+        CProHandlerMgr::ReleaseRetired(retired);
+
         /*
          * epoll_wait(...)
          */
         const int retc = pbsd_epoll_wait(
-            m_epfd, m_events, PRO_EPOLLFD_GETSIZE, -1);
-        if (retc <= 0)
+            m_epfd, m_events, PRO_EPOLLFD_GETSIZE, timeout);
+        if (retc < 0 || (retc == 0 && timeout != 0))
         {
             ProSleep(1);
             continue;
         }
 
+        const PRO_INT64 wakeUs = ProGetTickCount64Us();
+
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO> handlers;
 
         {
@@ -422,6 +488,8 @@ CProEpollReactor::WorkerRun()
                 break;
             }
 
+            m_handlerMgr.EnterEpoch();
+
             for (int i = 0; i < retc; ++i)
             {
                 const pbsd_epoll_event& ev = m_events[i];
@@ -437,75 +505,284 @@ CProEpollReactor::WorkerRun()
                     continue;
                 }
 
+                CProStlMap<PRO_INT64, unsigned long>::iterator const itr =
+                    m_edgeReadyMasks.find(ev.data.fd);
+                if (itr != m_edgeReadyMasks.end())
+                {
+                    /*
+                     * an edge-triggered handler gets its errors from recv()
+                     * and send(). the error queue (MSG_ZEROCOPY) also raises
+                     * EPOLLERR, and the edge must not be lost
+                     */
+                    if ((ev.events & PRO_EPOLLERR) != 0)
+                    {
+                        PRO_SET_BITS(itr->second, PRO_MASK_WRITE | PRO_MASK_READ);
+                    }
+                    if ((ev.events & PRO_EPOLLOUT_SET) != 0)
+                    {
+                        PRO_SET_BITS(itr->second, PRO_MASK_WRITE);
+                    }
+                    if ((ev.events & (PRO_EPOLLIN_SET | PRO_EPOLLHUP)) != 0)
+                    {
+                        PRO_SET_BITS(itr->second, PRO_MASK_READ);
+                    }
+                    if ((itr->second & info.mask) != 0)
+                    {
+                        m_edgeRunnables.insert(ev.data.fd);
+                        continue;
+                    }
+                    if ((ev.events & PRO_EPOLLERR) == 0)
+                    {
+                        continue;
+                    }
+                }
+
                 if ((ev.events & PRO_EPOLLERR) != 0)
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[ev.data.fd]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_ERROR);
                     continue;
                 }
 
-                if ((ev.events & PRO_EPOLLOUT_SET) != 0)
+                if ((ev.events & PRO_EPOLLOUT_SET) != 0 &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[ev.data.fd]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_WRITE);
                 }
 
-                if ((ev.events & (PRO_EPOLLIN_SET | PRO_EPOLLHUP)) != 0)
+                if ((ev.events & PRO_EPOLLHUP) != 0 ||
+                    ((ev.events & PRO_EPOLLIN_SET) != 0 &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_READ)))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[ev.data.fd]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_READ);
                 }
 
-                if ((ev.events & PRO_EPOLLEX_SET) != 0)
+                if ((ev.events & PRO_EPOLLEX_SET) != 0 &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_EXCEPTION))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[ev.data.fd]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_EXCEPTION);
                 }
             } /* end of for (...) */
+
+            CollectEdgeRunnables(handlers);
         }
 
+        PRO_INT64 upcallUs = ProGetTickCount64Us();
+        bool      edge     = false;
+
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator       itr = handlers.begin();
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator const end = handlers.end();
 
         for (; itr != end; ++itr)
         {
-            const PRO_INT64         sockId = itr->first;
-            const PRO_HANDLER_INFO& info   = itr->second;
+            const PRO_INT64   sockId = itr->first;
+            PRO_HANDLER_INFO& info   = itr->second;
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_EDGE))
+            {
+                CProEventHandler* const handler = info.handler;
+                unsigned long           blocked = 0;
+
+                for (int i = 0; i < PRO_EPOLLET_BUDGET &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE); ++i)
+                {
+                    handler->ClearWouldBlock();
+                    handler->OnOutput(sockId);
+                    AddUpcallStats(upcallUs);
+
+                    if (PRO_BIT_ENABLED(handler->GetWouldBlock(), PRO_MASK_WRITE))
+                    {
+                        PRO_SET_BITS(blocked, PRO_MASK_WRITE);
+                        break;
+                    }
+                    if (!PRO_BIT_ENABLED(handler->GetMask(), PRO_MASK_WRITE))
+                    {
+                        break;
+                    }
+                }
+
+                for (int j = 0; j < PRO_EPOLLET_BUDGET &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_READ); ++j)
+                {
+                    handler->ClearWouldBlock();
+                    handler->OnInput(sockId);
+                    AddUpcallStats(upcallUs);
+
+                    if (PRO_BIT_ENABLED(handler->GetWouldBlock(), PRO_MASK_READ))
+                    {
+                        PRO_SET_BITS(blocked, PRO_MASK_READ);
+                        break;
+                    }
+                    if (!PRO_BIT_ENABLED(handler->GetMask(), PRO_MASK_READ))
+                    {
+                        break;
+                    }
+                }
+
+                info.mask = PRO_MASK_EDGE | blocked; /* feedback */
+                edge      = true;
+                continue;
+            }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_ERROR))
             {
                 info.handler->OnError(sockId, -1);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
                 continue;
             }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE))
             {
                 info.handler->OnOutput(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_READ))
             {
                 info.handler->OnInput(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_EXCEPTION))
             {
                 info.handler->OnException(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
         } /* end of for (...) */
+
+        if (edge)
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            UpdateEdgeRunnables(handlers);
+        }
+
+        AddLoopStats(wakeUs, upcallUs, retc);
     } /* end of while (...) */
+
+    CProHandlerMgr::ReleaseRetired(retired);
+}
+
+void
+CProEpollReactor::ApplyPendingEvents()
+{
+    if (m_pendingEvents.empty())
+    {
+        return;
+    }
+
+    pbsd_epoll_event ev;
+    memset(&ev, 0, sizeof(pbsd_epoll_event));
+
+    CProStlMap<PRO_INT64, short>::const_iterator       itr = m_pendingEvents.begin();
+    CProStlMap<PRO_INT64, short>::const_iterator const end = m_pendingEvents.end();
+
+    for (; itr != end; ++itr)
+    {
+        const PRO_HANDLER_INFO info = m_handlerMgr.FindHandler(itr->first);
+        if (info.handler == NULL)
+        {
+            continue;
+        }
+
+        const short events = MaskToEvents_i(info.mask);
+        if (events == 0 || events == itr->second)
+        {
+            continue;
+        }
+
+        ev.events  = events;
+        ev.data.fd = (int)itr->first;
+        pbsd_epoll_ctl(m_epfd, EPOLL_CTL_MOD, ev.data.fd, &ev);
+    }
+
+    m_pendingEvents.clear();
+}
+
+void
+CProEpollReactor::CollectEdgeRunnables(CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers)
+{
+    CProStlSet<PRO_INT64>::iterator       itr = m_edgeRunnables.begin();
+    CProStlSet<PRO_INT64>::iterator const end = m_edgeRunnables.end();
+
+    while (itr != end)
+    {
+        const PRO_INT64        sockId = *itr;
+        const PRO_HANDLER_INFO info   = m_handlerMgr.FindHandler(sockId);
+
+        CProStlMap<PRO_INT64, unsigned long>::const_iterator const itr2 =
+            m_edgeReadyMasks.find(sockId);
+
+        unsigned long mask = 0;
+        if (info.handler != NULL && itr2 != m_edgeReadyMasks.end())
+        {
+            mask = itr2->second & info.mask & (PRO_MASK_WRITE | PRO_MASK_READ);
+        }
+
+        if (mask == 0)
+        {
+            m_edgeRunnables.erase(itr++);
+            continue;
+        }
+
+        PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
+        if (info2.handler == NULL) /* not in error */
+        {
+            info2.handler = info.handler;
+            info2.mask    = PRO_MASK_EDGE | mask;
+        }
+
+        ++itr;
+    }
+}
+
+void
+CProEpollReactor::UpdateEdgeRunnables(
+    const CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers)
+{
+    CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::const_iterator       itr = handlers.begin();
+    CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::const_iterator const end = handlers.end();
+
+    for (; itr != end; ++itr)
+    {
+        if (!PRO_BIT_ENABLED(itr->second.mask, PRO_MASK_EDGE))
+        {
+            continue;
+        }
+
+        /*
+         * the handler may have been removed or replaced in the upcalls
+         */
+        const PRO_HANDLER_INFO info = m_handlerMgr.FindHandler(itr->first);
+        if (info.handler != itr->second.handler)
+        {
+            continue;
+        }
+
+        CProStlMap<PRO_INT64, unsigned long>::iterator const itr2 =
+            m_edgeReadyMasks.find(itr->first);
+        if (itr2 == m_edgeReadyMasks.end())
+        {
+            continue;
+        }
+
+        /*
+         * the would-block masks wait for the next edge. The others are still
+         * ready, and the handler stays runnable in the next round
+         */
+        PRO_CLR_BITS(itr2->second, itr->second.mask);
+        if ((itr2->second & info.mask) == 0)
+        {
+            m_edgeRunnables.erase(itr->first);
+        }
+    }
 }
 
 void
@@ -518,14 +795,10 @@ CProEpollReactor::OnInput(PRO_INT64 sockId)
         return;
     }
 
-    const int recvSize = pbsd_recv(sockId, g_s_buffer, sizeof(g_s_buffer), 0); /* connected */
-    if (
-        (recvSize > 0 && recvSize <= (int)sizeof(g_s_buffer))
-        ||
-        (recvSize < 0 && pbsd_errno((void*)&pbsd_recv) == PBSD_EWOULDBLOCK)
-       )
+    if (m_notifyPipe->Recv())
     {
         m_notifyPipe->EnableNotify();
+        ++m_delta.notifyCount;
     }
     else
     {
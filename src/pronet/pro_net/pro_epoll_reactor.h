@@ -20,6 +20,8 @@
 #define PRO_EPOLL_REACTOR_H
 
 #include "pro_base_reactor.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
 
 #if defined(PRO_HAS_EPOLL)
 
@@ -53,6 +55,14 @@ public:
 
 private:
 
+    void ApplyPendingEvents();
+
+    void CollectEdgeRunnables(CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers);
+
+    void UpdateEdgeRunnables(
+        const CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers
+        );
+
     virtual void PRO_CALLTYPE OnInput(PRO_INT64 sockId);
 
     virtual void PRO_CALLTYPE OnError(
@@ -62,8 +72,11 @@ private:
 
 private:
 
-    int              m_epfd;
-    pbsd_epoll_event m_events[PRO_EPOLLFD_GETSIZE]; /* sizeof(epoll_event) is 16 */
+    int                                  m_epfd;
+    pbsd_epoll_event                     m_events[PRO_EPOLLFD_GETSIZE]; /* sizeof(epoll_event) is 16 */
+    CProStlMap<PRO_INT64, short>         m_pendingEvents; /* sockId ---> events in the kernel */
+    CProStlMap<PRO_INT64, unsigned long> m_edgeReadyMasks; /* sockId ---> ready mask, for EPOLLET */
+    CProStlSet<PRO_INT64>                m_edgeRunnables; /* sockIds with ready and wanted masks */
 
     DECLARE_SGI_POOL(0)
 };
@@ -19,6 +19,7 @@
 #if !defined(PRO_EVENT_HANDLER_H)
 #define PRO_EVENT_HANDLER_H
 
+#include "pro_ring_io.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_ref_count.h"
 #include "../pro_util/pro_timer_factory.h"
@@ -113,22 +114,97 @@ public:
         return (m_mask);
     }
 
+    /*
+     * A handler that keeps reading or writing until its socket is drained
+     * may call EnableEdgeTrigger() before its first registration. Then the
+     * epoll reactor registers the socket only once with EPOLLET, and calls
+     * OnInput()/OnOutput() repeatedly within a budget until the handler
+     * reports the end of the data with SetWouldBlock() in the upcall.
+     *
+     * The other reactors ignore it.
+     */
+    void EnableEdgeTrigger()
+    {
+        m_edgeTrigger = true;
+    }
+
+    bool IsEdgeTrigger() const
+    {
+        return (m_edgeTrigger);
+    }
+
+    /*
+     * A stream or listening handler may call EnableRingIo() before its first
+     * registration. Then the io_uring reactor does the socket I/O itself in
+     * the completion mode, and the handler gets a CProRingIo with GetRingIo()
+     * to take the results from in its upcalls. Such a handler is dispatched
+     * as an edge-triggered one, and it stays on the same reactor.
+     *
+     * The other reactors ignore it, and GetRingIo() returns NULL.
+     */
+    void EnableRingIo(bool enable)
+    {
+        m_ringIoWanted = enable;
+    }
+
+    bool IsRingIoWanted() const
+    {
+        return (m_ringIoWanted);
+    }
+
+    void SetRingIo(CProRingIo* ringIo) /* called by the reactor */
+    {
+        m_ringIo = ringIo;
+    }
+
+    CProRingIo* GetRingIo() const
+    {
+        return (m_ringIo);
+    }
+
+    void SetWouldBlock(unsigned long mask)
+    {
+        PRO_SET_BITS(m_wouldBlock, mask);
+    }
+
+    unsigned long GetWouldBlock() const
+    {
+        return (m_wouldBlock);
+    }
+
+    void ClearWouldBlock()
+    {
+        m_wouldBlock = 0;
+    }
+
 protected:
 
     CProEventHandler()
     {
-        m_reactor = NULL;
-        m_mask    = 0;
+        m_reactor     = NULL;
+        m_mask        = 0;
+        m_edgeTrigger  = false;
+        m_wouldBlock   = 0;
+        m_ringIoWanted = false;
+        m_ringIo       = NULL;
     }
 
     virtual ~CProEventHandler()
     {
+        if (m_ringIo != NULL)
+        {
+            m_ringIo->Release();
+        }
     }
 
 private:
 
     CProBaseReactor* m_reactor;
     unsigned long    m_mask;
+    bool             m_edgeTrigger;
+    unsigned long    m_wouldBlock; /* written and read by the reactor thread only */
+    bool             m_ringIoWanted;
+    CProRingIo*      m_ringIo;
 
     DECLARE_SGI_POOL(0)
 };
@@ -38,6 +38,8 @@ CProHandlerMgr::~CProHandlerMgr()
     }
 
     m_sockId2HandlerInfo.clear();
+
+    ReleaseRetired(m_retired);
 }
 
 bool
@@ -102,7 +104,15 @@ CProHandlerMgr::RemoveHandler(PRO_INT64     sockId,
 
     if (info.mask == 0)
     {
-        info.handler->Release();
+        if (m_inEpoch)
+        {
+            m_retired.push_back(info.handler);
+        }
+        else
+        {
+            info.handler->Release();
+        }
+
         m_sockId2HandlerInfo.erase(itr);
     }
 }
@@ -154,3 +164,35 @@ CProHandlerMgr::GetAllHandlers() const
 {
     return (m_sockId2HandlerInfo);
 }
+
+void
+CProHandlerMgr::EnterEpoch()
+{
+    m_inEpoch = true;
+}
+
+void
+CProHandlerMgr::LeaveEpoch(CProStlVector<CProEventHandler*>& retired)
+{
+    m_inEpoch = false;
+
+    if (!m_retired.empty())
+    {
+        retired.insert(retired.end(), m_retired.begin(), m_retired.end());
+        m_retired.clear();
+    }
+}
+
+void
+CProHandlerMgr::ReleaseRetired(CProStlVector<CProEventHandler*>& retired)
+{
+    int       i = 0;
+    const int c = (int)retired.size();
+
+    for (; i < c; ++i)
+    {
+        retired[i]->Release();
+    }
+
+    retired.clear();
+}
@@ -51,6 +51,7 @@ public:
 
     CProHandlerMgr()
     {
+        m_inEpoch = false;
     }
 
     ~CProHandlerMgr();
@@ -74,9 +75,23 @@ public:
 
     const CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& GetAllHandlers() const;
 
+    /*
+     * the handlers found in an epoch are pinned by the epoch, not by their
+     * reference counts. A handler removed in an epoch is retired instead of
+     * being released, and the caller of LeaveEpoch() releases it later,
+     * out of the reactor lock
+     */
+    void EnterEpoch();
+
+    void LeaveEpoch(CProStlVector<CProEventHandler*>& retired);
+
+    static void ReleaseRetired(CProStlVector<CProEventHandler*>& retired);
+
 private:
 
     CProStlMap<PRO_INT64, PRO_HANDLER_INFO> m_sockId2HandlerInfo;
+    bool                                    m_inEpoch;
+    CProStlVector<CProEventHandler*>        m_retired;
 
     DECLARE_SGI_POOL(0)
 };
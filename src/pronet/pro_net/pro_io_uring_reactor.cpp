@@ -0,0 +1,1621 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "pro_io_uring_reactor.h"
+#include "pro_base_reactor.h"
+#include "pro_notify_pipe.h"
+#include "pro_ring_io.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_thread.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+#if defined(PRO_HAS_IO_URING)
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#if !defined(PRO_IO_URING_ENTRIES)
+#define PRO_IO_URING_ENTRIES 1024
+#endif
+
+#if !defined(PRO_IO_URING_BUF_COUNT)
+#define PRO_IO_URING_BUF_COUNT 256         /* a power of 2, for the provided buffer ring */
+#endif
+
+#if !defined(PRO_IO_URING_BUF_SIZE)
+#define PRO_IO_URING_BUF_SIZE  (1024 * 16)
+#endif
+
+#define PRO_IO_URING_FEATURES (IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | \
+    IORING_FEAT_POLL_32BITS | IORING_FEAT_RSRC_TAGS) /* multishot poll, 5.13 */
+
+#define PRO_IO_URING_BGID 0
+
+/*
+ * a private mask of the dispatching list, the same as CProEpollReactor
+ */
+static const unsigned long PRO_MASK_EDGE = 1 << 16;
+
+/*
+ * the user_data of a completion-mode request is the CProRingIo with the
+ * request type in the low bits, and with the top bit set. The polls have
+ * the top bit clear, and the removals and the cancellations have 0
+ */
+static const PRO_UINT64 PRO_RING_FLAG  = (PRO_UINT64)1 << 63;
+static const PRO_UINT64 PRO_RING_MASK  = 7;
+static const PRO_UINT64 PRO_RING_INPUT = 1;
+static const PRO_UINT64 PRO_RING_SEND  = 2;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+unsigned int
+PRO_CALLTYPE
+LoadAcquire_i(const unsigned int* p)
+{
+    const unsigned int value = *(const volatile unsigned int*)p;
+    __sync_synchronize();
+
+    return (value);
+}
+
+static
+inline
+void
+PRO_CALLTYPE
+StoreRelease_i(unsigned int* p,
+               unsigned int  value)
+{
+    __sync_synchronize();
+    *(volatile unsigned int*)p = value;
+}
+
+static
+inline
+unsigned int
+PRO_CALLTYPE
+MaskToEvents_i(unsigned long mask)
+{
+    unsigned int events = 0;
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_WRITE))
+    {
+        events |= POLLOUT;
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_READ))
+    {
+        events |= POLLIN;
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
+    {
+        events |= POLLPRI;
+    }
+
+    return (events);
+}
+
+static
+inline
+PRO_UINT64
+PRO_CALLTYPE
+MakeUserData_i(PRO_INT64  sockId,
+               PRO_UINT32 gen)
+{
+    return (((PRO_UINT64)gen << 32) | (PRO_UINT32)sockId);
+}
+
+static
+inline
+PRO_UINT64
+PRO_CALLTYPE
+MakeRingUserData_i(CProRingIo* ringIo,
+                   PRO_UINT64  type)
+{
+    assert(((PRO_UINT64)(unsigned long)ringIo & PRO_RING_MASK) == 0);
+
+    return (PRO_RING_FLAG | (PRO_UINT64)(unsigned long)ringIo | type);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProIoUringReactor::CProIoUringReactor()
+{
+    m_ringFd      = -1;
+    m_ringPtr     = NULL;
+    m_ringSize    = 0;
+    m_sqes        = NULL;
+    m_sqesSize    = 0;
+    m_sqHead      = NULL;
+    m_sqTail      = NULL;
+    m_sqArray     = NULL;
+    m_sqMask      = 0;
+    m_sqEntries   = 0;
+    m_sqLocalTail = 0;
+    m_cqHead      = NULL;
+    m_cqTail      = NULL;
+    m_cqMask      = 0;
+    m_cqes        = NULL;
+    m_nextGen     = 0;
+    m_bufRing     = NULL;
+    m_bufs        = NULL;
+    m_bufTail     = 0;
+}
+
+CProIoUringReactor::~CProIoUringReactor()
+{
+    Fini();
+
+    /*
+     * the data in the provided buffers is copied out before they are gone
+     */
+    CProStlVector<unsigned short> bids;
+
+    CProStlSet<CProRingIo*>::iterator       itr = m_ringIos.begin();
+    CProStlSet<CProRingIo*>::iterator const end = m_ringIos.end();
+
+    for (; itr != end; ++itr)
+    {
+        (*itr)->Compact(bids);
+    }
+
+    CleanupRing(); /* the kernel cancels all the requests */
+
+    for (itr = m_ringIos.begin(); itr != end; ++itr)
+    {
+        (*itr)->Abort();
+        (*itr)->Release();
+    }
+
+    m_ringIos.clear();
+    m_touchedRingIos.clear();
+
+    delete m_notifyPipe;
+    m_notifyPipe = NULL;
+}
+
+bool
+PRO_CALLTYPE
+CProIoUringReactor::Init()
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_ringFd == -1);
+        if (m_ringFd != -1)
+        {
+            return (false);
+        }
+
+        if (!SetupRing())
+        {
+            return (false);
+        }
+
+        if (!SetupBufRing())
+        {
+            CleanupRing();
+
+            return (false);
+        }
+
+        m_notifyPipe->Init();
+
+        const PRO_INT64 sockId = m_notifyPipe->GetReaderSockId();
+        if (sockId == -1)
+        {
+            CleanupRing();
+
+            return (false);
+        }
+
+        if (!m_handlerMgr.AddHandler(sockId, this, PRO_MASK_READ))
+        {
+            CleanupRing();
+
+            return (false);
+        }
+
+        m_polls[sockId] = PRO_IO_URING_POLL();
+        m_dirtySockIds.insert(sockId);
+    }
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CProIoUringReactor::Fini()
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ringFd == -1)
+        {
+            return;
+        }
+
+        m_wantExit = true;
+        m_notifyPipe->Notify();
+    }
+}
+
+bool
+PRO_CALLTYPE
+CProIoUringReactor::AddHandler(PRO_INT64         sockId,
+                               CProEventHandler* handler,
+                               unsigned long     mask)
+{
+    mask &= (PRO_MASK_ACCEPT | PRO_MASK_CONNECT |
+        PRO_MASK_WRITE | PRO_MASK_READ | PRO_MASK_EXCEPTION);
+
+    assert(sockId != -1);
+    assert(handler != NULL);
+    assert(mask != 0);
+    if (sockId == -1 || handler == NULL || mask == 0)
+    {
+        return (false);
+    }
+
+    const bool listener = PRO_BIT_ENABLED(mask, PRO_MASK_ACCEPT);
+
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_ACCEPT))
+    {
+        PRO_CLR_BITS(mask, PRO_MASK_ACCEPT);
+        PRO_SET_BITS(mask, PRO_MASK_READ);
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_CONNECT))
+    {
+        PRO_CLR_BITS(mask, PRO_MASK_CONNECT);
+        PRO_SET_BITS(mask,
+            PRO_MASK_WRITE | PRO_MASK_READ | PRO_MASK_EXCEPTION);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ringFd == -1 || m_wantExit)
+        {
+            return (false);
+        }
+
+        const PRO_HANDLER_INFO oldInfo = m_handlerMgr.FindHandler(sockId);
+        if (oldInfo.handler != NULL && handler != oldInfo.handler)
+        {
+            return (false);
+        }
+
+        mask &= ~oldInfo.mask;
+        if (mask == 0)
+        {
+            return (true);
+        }
+
+        if (!m_handlerMgr.AddHandler(sockId, handler, mask))
+        {
+            return (false);
+        }
+
+        PRO_IO_URING_POLL& poll = m_polls[sockId]; /* insert */
+        if (oldInfo.handler == NULL)
+        {
+            poll = PRO_IO_URING_POLL();
+
+            /*
+             * a handler has one CProRingIo. The other sockets of it, such as
+             * the unix socket of CProAcceptor, are polled
+             */
+            CProRingIo* ringIo = handler->GetRingIo();
+            if (ringIo == NULL && handler->IsRingIoWanted() &&
+                !PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION))
+            {
+                ringIo = CProRingIo::CreateInstance(sockId, listener);
+                handler->SetRingIo(ringIo);
+            }
+
+            if (ringIo != NULL && ringIo->GetSockId() == sockId)
+            {
+                ringIo->SetRegistered(true);
+                if (m_ringIos.insert(ringIo).second)
+                {
+                    ringIo->AddRef();
+                }
+
+                poll.edge   = true;
+                poll.ringIo = ringIo;
+            }
+            else
+            {
+#if !defined(PRO_LACKS_EPOLLET)
+                poll.edge = handler->IsEdgeTrigger() &&
+                    !PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION);
+#endif
+            }
+        }
+
+        /*
+         * the SQEs are prepared by the worker thread at the beginning of the
+         * next round. It's woken up only if something new is wanted
+         */
+        bool wakeup = false;
+
+        if (poll.ringIo != NULL)
+        {
+            if (PRO_BIT_ENABLED(mask, PRO_MASK_READ))
+            {
+                if (poll.ringIo->IsReadable())
+                {
+                    PRO_SET_BITS(poll.readyMask, PRO_MASK_READ);
+                }
+                if (!poll.ringIo->IsInputArmed())
+                {
+                    m_dirtySockIds.insert(sockId); /* to be armed */
+                    wakeup = true;
+                }
+            }
+            if (PRO_BIT_ENABLED(mask, PRO_MASK_WRITE) &&
+                poll.ringIo->IsWritable())
+            {
+                PRO_SET_BITS(poll.readyMask, PRO_MASK_WRITE);
+            }
+            if ((poll.readyMask & mask) != 0)
+            {
+                m_edgeRunnables.insert(sockId);
+                wakeup = true;
+            }
+        }
+        else if (poll.edge)
+        {
+            assert(!PRO_BIT_ENABLED(mask, PRO_MASK_EXCEPTION));
+
+            if (poll.events == 0)
+            {
+                m_dirtySockIds.insert(sockId);
+                wakeup = true;
+            }
+            else if ((poll.readyMask & mask) != 0)
+            {
+                m_edgeRunnables.insert(sockId);
+                wakeup = true;
+            }
+            else
+            {
+            }
+        }
+        else if ((MaskToEvents_i(oldInfo.mask | mask) & ~poll.events) != 0)
+        {
+            m_dirtySockIds.insert(sockId);
+            wakeup = true;
+        }
+        else
+        {
+        }
+
+        if (wakeup && ProGetThreadId() != m_threadId)
+        {
+            m_notifyPipe->Notify();
+        }
+    }
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CProIoUringReactor::RemoveHandler(PRO_INT64     sockId,
+                                  unsigned long mask)
+{
+    mask &= (PRO_MASK_ACCEPT | PRO_MASK_CONNECT |
+        PRO_MASK_WRITE | PRO_MASK_READ | PRO_MASK_EXCEPTION);
+
+    if (sockId == -1 || mask == 0)
+    {
+        return;
+    }
+
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_ACCEPT))
+    {
+        PRO_CLR_BITS(mask, PRO_MASK_ACCEPT);
+        PRO_SET_BITS(mask, PRO_MASK_READ);
+    }
+    if (PRO_BIT_ENABLED(mask, PRO_MASK_CONNECT))
+    {
+        PRO_CLR_BITS(mask, PRO_MASK_CONNECT);
+        PRO_SET_BITS(mask,
+            PRO_MASK_WRITE | PRO_MASK_READ | PRO_MASK_EXCEPTION);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ringFd == -1)
+        {
+            return;
+        }
+
+        const PRO_HANDLER_INFO oldInfo = m_handlerMgr.FindHandler(sockId);
+        if (oldInfo.handler == NULL)
+        {
+            return;
+        }
+
+        mask &= oldInfo.mask;
+        if (mask == 0)
+        {
+            return;
+        }
+
+        m_handlerMgr.RemoveHandler(sockId, mask);
+
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr =
+            m_polls.find(sockId);
+
+        /*
+         * a partial removal needs nothing, but the input of the completion
+         * mode is cancelled. A stale one-shot poll fires at most once, and
+         * then it's armed again with the current mask
+         */
+        if ((oldInfo.mask & ~mask) != 0)
+        {
+            if (itr != m_polls.end() && itr->second.ringIo != NULL &&
+                PRO_BIT_ENABLED(mask, PRO_MASK_READ))
+            {
+                m_dirtySockIds.insert(sockId);
+
+                if (ProGetThreadId() != m_threadId)
+                {
+                    m_notifyPipe->Notify();
+                }
+            }
+
+            return;
+        }
+
+        if (itr != m_polls.end())
+        {
+            if (itr->second.ringIo != NULL)
+            {
+                DetachRing(sockId, itr->second.ringIo);
+            }
+            else if (itr->second.events != 0)
+            {
+                /*
+                 * the armed poll holds a reference to the file, so the socket
+                 * isn't closed really until the poll is removed
+                 */
+                m_pendingRemoves.push_back(
+                    MakeUserData_i(sockId, itr->second.gen));
+
+                if (ProGetThreadId() != m_threadId)
+                {
+                    m_notifyPipe->Notify();
+                }
+            }
+
+            m_polls.erase(itr);
+        }
+
+        m_dirtySockIds.erase(sockId);
+        m_edgeRunnables.erase(sockId);
+    }
+}
+
+void
+PRO_CALLTYPE
+CProIoUringReactor::WorkerRun()
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_threadId = ProGetThreadId();
+    }
+
+    CProStlVector<CProEventHandler*> retired;
+
+    while (1)
+    {
+        unsigned int minComplete = 1;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_handlerMgr.LeaveEpoch(retired); /* the upcalls of the last loop are over */
+            FlushStats();
+
+            if (m_ringFd == -1 || m_wantExit)
+            {
+                break;
+            }
+
+            FinishRings();
+            SubmitChanges();
+
+            if (!m_edgeRunnables.empty() || !m_touchedRingIos.empty())
+            {
+                minComplete = 0; /* go on with the handlers out of budget */
+            }
+        }
+
+        CProHandlerMgr::ReleaseRetired(retired);
+
+        /*
+         * io_uring_enter(...), to submit and to wait
+         */
+        if (Submit(minComplete) < 0 && errno != EINTR && errno != EBUSY)
+        {
+            ProSleep(1);
+        }
+
+        const PRO_INT64 wakeUs = ProGetTickCount64Us();
+
+        CProStlMap<PRO_INT64, PRO_HANDLER_INFO> handlers;
+        unsigned long                           cqeCount = 0;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            if (m_ringFd == -1 || m_wantExit)
+            {
+                break;
+            }
+
+            m_handlerMgr.EnterEpoch();
+
+            ReapCompletions(handlers, cqeCount);
+            CollectEdgeRunnables(handlers);
+        }
+
+        PRO_INT64 upcallUs = ProGetTickCount64Us();
+        bool      edge     = false;
+
+        CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator       itr = handlers.begin();
+        CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator const end = handlers.end();
+
+        for (; itr != end; ++itr)
+        {
+            const PRO_INT64   sockId = itr->first;
+            PRO_HANDLER_INFO& info   = itr->second;
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_EDGE))
+            {
+                CProEventHandler* const handler = info.handler;
+                unsigned long           blocked = 0;
+
+                for (int i = 0; i < PRO_EPOLLET_BUDGET &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE); ++i)
+                {
+                    handler->ClearWouldBlock();
+                    handler->OnOutput(sockId);
+                    AddUpcallStats(upcallUs);
+
+                    if (PRO_BIT_ENABLED(handler->GetWouldBlock(), PRO_MASK_WRITE))
+                    {
+                        PRO_SET_BITS(blocked, PRO_MASK_WRITE);
+                        break;
+                    }
+                    if (!PRO_BIT_ENABLED(handler->GetMask(), PRO_MASK_WRITE))
+                    {
+                        break;
+                    }
+                }
+
+                for (int j = 0; j < PRO_EPOLLET_BUDGET &&
+                    PRO_BIT_ENABLED(info.mask, PRO_MASK_READ); ++j)
+                {
+                    handler->ClearWouldBlock();
+                    handler->OnInput(sockId);
+                    AddUpcallStats(upcallUs);
+
+                    if (PRO_BIT_ENABLED(handler->GetWouldBlock(), PRO_MASK_READ))
+                    {
+                        PRO_SET_BITS(blocked, PRO_MASK_READ);
+                        break;
+                    }
+                    if ((handler->GetMask() & (PRO_MASK_ACCEPT | PRO_MASK_READ)) == 0)
+                    {
+                        break;
+                    }
+                }
+
+                info.mask = PRO_MASK_EDGE | blocked; /* feedback */
+                edge      = true;
+                continue;
+            }
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_ERROR))
+            {
+                info.handler->OnError(sockId, -1);
+                AddUpcallStats(upcallUs);
+                continue;
+            }
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE))
+            {
+                info.handler->OnOutput(sockId);
+                AddUpcallStats(upcallUs);
+            }
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_READ))
+            {
+                info.handler->OnInput(sockId);
+                AddUpcallStats(upcallUs);
+            }
+
+            if (PRO_BIT_ENABLED(info.mask, PRO_MASK_EXCEPTION))
+            {
+                info.handler->OnException(sockId);
+                AddUpcallStats(upcallUs);
+            }
+        } /* end of for (...) */
+
+        if (edge)
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            UpdateEdgeRunnables(handlers);
+        }
+
+        AddLoopStats(wakeUs, upcallUs, cqeCount);
+    } /* end of while (...) */
+
+    CProHandlerMgr::ReleaseRetired(retired);
+}
+
+bool
+CProIoUringReactor::SetupRing()
+{
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(struct io_uring_params));
+
+    const int ringFd = pbsd_io_uring_setup(PRO_IO_URING_ENTRIES, &params);
+    if (ringFd == -1)
+    {
+        return (false);
+    }
+
+    if ((params.features & PRO_IO_URING_FEATURES) != PRO_IO_URING_FEATURES)
+    {
+        close(ringFd);
+
+        return (false);
+    }
+
+    /*
+     * the multishot recv of the completion mode came with IORING_OP_SEND_ZC
+     * in Linux 6.0
+     */
+    {
+        const size_t probeSize = sizeof(struct io_uring_probe) +
+            IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+        struct io_uring_probe* const probe =
+            (struct io_uring_probe*)ProCalloc(1, probeSize);
+        if (probe == NULL)
+        {
+            close(ringFd);
+
+            return (false);
+        }
+
+        const bool supported = pbsd_io_uring_register(
+            ringFd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0 &&
+            probe->last_op >= IORING_OP_SEND_ZC                        &&
+            (probe->ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED) != 0;
+        ProFree(probe);
+
+        if (!supported)
+        {
+            close(ringFd);
+
+            return (false);
+        }
+    }
+
+    const size_t sqSize =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    const size_t cqSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+
+    m_ringSize = sqSize > cqSize ? sqSize : cqSize;
+    m_ringPtr  = mmap(NULL, m_ringSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+    if (m_ringPtr == MAP_FAILED)
+    {
+        m_ringPtr  = NULL;
+        m_ringSize = 0;
+        close(ringFd);
+
+        return (false);
+    }
+
+    m_sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* const sqes = mmap(NULL, m_sqesSize, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        munmap(m_ringPtr, m_ringSize);
+        m_ringPtr  = NULL;
+        m_ringSize = 0;
+        m_sqesSize = 0;
+        close(ringFd);
+
+        return (false);
+    }
+
+    char* const ring = (char*)m_ringPtr;
+
+    m_sqes        = (struct io_uring_sqe*)sqes;
+    m_sqHead      = (unsigned int*)(ring + params.sq_off.head);
+    m_sqTail      = (unsigned int*)(ring + params.sq_off.tail);
+    m_sqArray     = (unsigned int*)(ring + params.sq_off.array);
+    m_sqMask      = *(unsigned int*)(ring + params.sq_off.ring_mask);
+    m_sqEntries   = *(unsigned int*)(ring + params.sq_off.ring_entries);
+    m_sqLocalTail = *m_sqTail;
+    m_cqHead      = (unsigned int*)(ring + params.cq_off.head);
+    m_cqTail      = (unsigned int*)(ring + params.cq_off.tail);
+    m_cqMask      = *(unsigned int*)(ring + params.cq_off.ring_mask);
+    m_cqes        = (struct io_uring_cqe*)(ring + params.cq_off.cqes);
+    m_ringFd      = ringFd;
+
+    return (true);
+}
+
+bool
+CProIoUringReactor::SetupBufRing()
+{
+    assert(m_ringFd != -1);
+    assert(m_bufRing == NULL);
+
+    const size_t ringSize = PRO_IO_URING_BUF_COUNT * sizeof(struct io_uring_buf);
+    const size_t bufsSize = PRO_IO_URING_BUF_COUNT * PRO_IO_URING_BUF_SIZE;
+
+    void* const ring = mmap(NULL, ringSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring == MAP_FAILED)
+    {
+        return (false);
+    }
+
+    void* const bufs = mmap(NULL, bufsSize, PROT_READ | PROT_WRITE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (bufs == MAP_FAILED)
+    {
+        munmap(ring, ringSize);
+
+        return (false);
+    }
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0, sizeof(struct io_uring_buf_reg));
+    reg.ring_addr    = (unsigned long)ring;
+    reg.ring_entries = PRO_IO_URING_BUF_COUNT;
+    reg.bgid         = PRO_IO_URING_BGID;
+
+    if (pbsd_io_uring_register(m_ringFd, IORING_REGISTER_PBUF_RING, &reg, 1) != 0)
+    {
+        munmap(bufs, bufsSize);
+        munmap(ring, ringSize);
+
+        return (false);
+    }
+
+    m_bufRing = (struct io_uring_buf_ring*)ring;
+    m_bufs    = (char*)bufs;
+    m_bufTail = 0;
+
+    CProStlVector<unsigned short> bids;
+
+    int       i = 0;
+    const int c = PRO_IO_URING_BUF_COUNT;
+
+    for (; i < c; ++i)
+    {
+        bids.push_back((unsigned short)i);
+    }
+
+    RecycleBufs(bids);
+
+    return (true);
+}
+
+void
+CProIoUringReactor::CleanupRing()
+{
+    if (m_ringFd == -1)
+    {
+        return;
+    }
+
+    munmap(m_sqes, m_sqesSize);
+    munmap(m_ringPtr, m_ringSize);
+    close(m_ringFd);
+
+    /*
+     * the provided buffer ring is unregistered with the ring
+     */
+    if (m_bufRing != NULL)
+    {
+        munmap(m_bufs, PRO_IO_URING_BUF_COUNT * PRO_IO_URING_BUF_SIZE);
+        munmap(m_bufRing, PRO_IO_URING_BUF_COUNT * sizeof(struct io_uring_buf));
+    }
+
+    m_ringFd   = -1;
+    m_ringPtr  = NULL;
+    m_ringSize = 0;
+    m_sqes     = NULL;
+    m_sqesSize = 0;
+    m_bufRing  = NULL;
+    m_bufs     = NULL;
+    m_bufTail  = 0;
+}
+
+void
+CProIoUringReactor::RecycleBufs(const CProStlVector<unsigned short>& bids)
+{
+    if (bids.size() == 0)
+    {
+        return;
+    }
+
+    int       i = 0;
+    const int c = (int)bids.size();
+
+    for (; i < c; ++i)
+    {
+        /*
+         * not m_bufRing->bufs, which C++ moves past the empty member of
+         * __DECLARE_FLEX_ARRAY
+         */
+        struct io_uring_buf& buf = ((struct io_uring_buf*)m_bufRing)
+            [m_bufTail & (PRO_IO_URING_BUF_COUNT - 1)];
+        buf.addr = (unsigned long)(m_bufs + bids[i] * PRO_IO_URING_BUF_SIZE);
+        buf.len  = PRO_IO_URING_BUF_SIZE;
+        buf.bid  = bids[i];
+        ++m_bufTail;
+    }
+
+    __sync_synchronize();
+    *(volatile unsigned short*)&m_bufRing->tail = m_bufTail;
+}
+
+struct io_uring_sqe*
+CProIoUringReactor::GetSqe()
+{
+    if (m_sqLocalTail - LoadAcquire_i(m_sqHead) >= m_sqEntries)
+    {
+        Submit(0); /* the ring is full */
+
+        if (m_sqLocalTail - LoadAcquire_i(m_sqHead) >= m_sqEntries)
+        {
+            return (NULL);
+        }
+    }
+
+    const unsigned int index = m_sqLocalTail & m_sqMask;
+    m_sqArray[index] = index;
+    ++m_sqLocalTail;
+
+    struct io_uring_sqe* const sqe = &m_sqes[index];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+    return (sqe);
+}
+
+int
+CProIoUringReactor::Submit(unsigned int minComplete)
+{
+    StoreRelease_i(m_sqTail, m_sqLocalTail);
+
+    const unsigned int toSubmit = m_sqLocalTail - LoadAcquire_i(m_sqHead);
+    if (toSubmit == 0 && minComplete == 0)
+    {
+        return (0);
+    }
+
+    return (pbsd_io_uring_enter(m_ringFd, toSubmit, minComplete,
+        minComplete > 0 ? IORING_ENTER_GETEVENTS : 0));
+}
+
+void
+CProIoUringReactor::SubmitChanges()
+{
+    while (!m_pendingRemoves.empty())
+    {
+        struct io_uring_sqe* const sqe = GetSqe();
+        if (sqe == NULL)
+        {
+            return;
+        }
+
+        sqe->opcode    = IORING_OP_POLL_REMOVE;
+        sqe->fd        = -1;
+        sqe->addr      = m_pendingRemoves.back();
+        sqe->user_data = 0;
+        m_pendingRemoves.pop_back();
+    }
+
+    while (!m_pendingCancels.empty())
+    {
+        struct io_uring_sqe* const sqe = GetSqe();
+        if (sqe == NULL)
+        {
+            return;
+        }
+
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->fd        = -1;
+        sqe->addr      = m_pendingCancels.back();
+        sqe->user_data = 0;
+        m_pendingCancels.pop_back();
+    }
+
+    CProStlSet<PRO_INT64>::iterator       itr = m_dirtySockIds.begin();
+    CProStlSet<PRO_INT64>::iterator const end = m_dirtySockIds.end();
+
+    while (itr != end)
+    {
+        const PRO_INT64        sockId = *itr;
+        const PRO_HANDLER_INFO info   = m_handlerMgr.FindHandler(sockId);
+
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr2 =
+            m_polls.find(sockId);
+        if (info.handler == NULL || itr2 == m_polls.end())
+        {
+            m_dirtySockIds.erase(itr++);
+            continue;
+        }
+
+        if (itr2->second.ringIo != NULL)
+        {
+            if (!UpdateRingInput(sockId, info.mask, itr2->second.ringIo))
+            {
+                return;
+            }
+
+            m_dirtySockIds.erase(itr++);
+            continue;
+        }
+
+        PRO_IO_URING_POLL& poll   = itr2->second;
+        unsigned int       events = 0;
+        if (!poll.edge)
+        {
+            events = MaskToEvents_i(info.mask);
+        }
+        else if ((info.mask & (PRO_MASK_WRITE | PRO_MASK_READ)) != 0)
+        {
+            events = POLLOUT | POLLIN;
+        }
+        else
+        {
+        }
+
+        if (poll.events != 0 && (events & ~poll.events) == 0)
+        {
+            m_dirtySockIds.erase(itr++);
+            continue;
+        }
+
+        if (poll.events != 0)
+        {
+            struct io_uring_sqe* const sqe = GetSqe();
+            if (sqe == NULL)
+            {
+                return;
+            }
+
+            sqe->opcode    = IORING_OP_POLL_REMOVE;
+            sqe->fd        = -1;
+            sqe->addr      = MakeUserData_i(sockId, poll.gen);
+            sqe->user_data = 0;
+            poll.events    = 0;
+        }
+
+        if (events != 0)
+        {
+            struct io_uring_sqe* const sqe = GetSqe();
+            if (sqe == NULL)
+            {
+                return;
+            }
+
+            m_nextGen = (m_nextGen + 1) & 0x7FFFFFFF; /* the top bit of user_data is clear */
+            if (m_nextGen == 0)
+            {
+                ++m_nextGen;
+            }
+
+#if defined(PRO_WORDS_BIGENDIAN)
+            sqe->poll32_events = (events << 16) | (events >> 16); /* the kernel swaps the halves */
+#else
+            sqe->poll32_events = events;
+#endif
+            sqe->opcode        = IORING_OP_POLL_ADD;
+            sqe->fd            = (int)sockId;
+            sqe->len           = poll.edge ? IORING_POLL_ADD_MULTI : 0;
+            sqe->user_data     = MakeUserData_i(sockId, m_nextGen);
+            poll.gen           = m_nextGen;
+            poll.events        = events;
+        }
+
+        m_dirtySockIds.erase(itr++);
+    }
+}
+
+bool
+CProIoUringReactor::UpdateRingInput(PRO_INT64     sockId,
+                                    unsigned long mask,
+                                    CProRingIo*   ringIo)
+{
+    const bool wanted =
+        PRO_BIT_ENABLED(mask, PRO_MASK_READ) && ringIo->WantsInput();
+    if (wanted == ringIo->IsInputArmed())
+    {
+        return (true);
+    }
+
+    struct io_uring_sqe* const sqe = GetSqe();
+    if (sqe == NULL)
+    {
+        return (false);
+    }
+
+    if (!wanted)
+    {
+        /*
+         * it's disarmed by its last completion
+         */
+        sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+        sqe->fd        = -1;
+        sqe->addr      = MakeRingUserData_i(ringIo, PRO_RING_INPUT);
+        sqe->user_data = 0;
+
+        return (true);
+    }
+
+    if (ringIo->IsListener())
+    {
+        sqe->opcode       = IORING_OP_ACCEPT;
+        sqe->ioprio       = IORING_ACCEPT_MULTISHOT;
+        sqe->accept_flags = SOCK_NONBLOCK | SOCK_CLOEXEC;
+    }
+    else
+    {
+        sqe->opcode       = IORING_OP_RECV;
+        sqe->ioprio       = IORING_RECV_MULTISHOT;
+        sqe->flags        = IOSQE_BUFFER_SELECT;
+        sqe->buf_group    = PRO_IO_URING_BGID;
+    }
+
+    sqe->fd        = (int)sockId;
+    sqe->user_data = MakeRingUserData_i(ringIo, PRO_RING_INPUT);
+    ringIo->SetInputArmed(true);
+
+    return (true);
+}
+
+void
+CProIoUringReactor::FinishRings()
+{
+    if (m_touchedRingIos.empty())
+    {
+        return;
+    }
+
+    CProStlSet<CProRingIo*>       ringIos;
+    CProStlVector<unsigned short> bids;
+
+    ringIos.swap(m_touchedRingIos);
+
+    CProStlSet<CProRingIo*>::iterator       itr = ringIos.begin();
+    CProStlSet<CProRingIo*>::iterator const end = ringIos.end();
+
+    for (; itr != end; ++itr)
+    {
+        CProRingIo* const ringIo = *itr;
+
+        /*
+         * the data left in the provided buffers is copied out, and all the
+         * buffers of the last round go back to the kernel
+         */
+        ringIo->Compact(bids);
+
+        const char* buf  = NULL;
+        size_t      size = 0;
+
+        if (ringIo->PreSend(buf, size))
+        {
+            struct io_uring_sqe* const sqe = GetSqe();
+            if (sqe != NULL)
+            {
+                sqe->opcode    = IORING_OP_SEND;
+                sqe->fd        = (int)ringIo->GetFd();
+                sqe->addr      = (unsigned long)buf;
+                sqe->len       = (unsigned int)size;
+                sqe->msg_flags = MSG_WAITALL | MSG_NOSIGNAL; /* no short send */
+                sqe->user_data = MakeRingUserData_i(ringIo, PRO_RING_SEND);
+
+                if (ringIo->IsWritable()) /* the stage is taken */
+                {
+                    UpdateRingReady(ringIo, PRO_MASK_WRITE, false);
+                }
+            }
+            else
+            {
+                ringIo->OnSendDone(0);
+                m_touchedRingIos.insert(ringIo); /* at the next round */
+            }
+        }
+
+        if (!ringIo->HasWork())
+        {
+            m_touchedRingIos.erase(ringIo);
+            m_ringIos.erase(ringIo);
+            ringIo->Release();
+        }
+    }
+
+    RecycleBufs(bids);
+}
+
+void
+CProIoUringReactor::DetachRing(PRO_INT64   sockId,
+                               CProRingIo* ringIo)
+{
+    /*
+     * the staged data goes on with a dup of the socket, for the handler is
+     * going to close it
+     */
+    if (ringIo->HasSendData())
+    {
+        const int fd = fcntl((int)sockId, F_DUPFD_CLOEXEC, 0);
+        if (fd >= 0)
+        {
+            ringIo->KeepFd(fd);
+        }
+    }
+
+    ringIo->SetRegistered(false);
+
+    if (ringIo->IsInputArmed())
+    {
+        m_pendingCancels.push_back(
+            MakeRingUserData_i(ringIo, PRO_RING_INPUT));
+    }
+
+    m_touchedRingIos.insert(ringIo);
+
+    if (ProGetThreadId() != m_threadId)
+    {
+        m_notifyPipe->Notify();
+    }
+}
+
+void
+CProIoUringReactor::ReapRing(const struct io_uring_cqe& cqe)
+{
+    CProRingIo* const ringIo = (CProRingIo*)(unsigned long)
+        (cqe.user_data & ~(PRO_RING_FLAG | PRO_RING_MASK));
+    const PRO_UINT64  type   = cqe.user_data & PRO_RING_MASK;
+    unsigned long     ready  = 0;
+    bool              update = false;
+
+    m_touchedRingIos.insert(ringIo);
+
+    if (type == PRO_RING_SEND)
+    {
+        ringIo->OnSendDone(cqe.res);
+
+        if (ringIo->IsWritable())
+        {
+            PRO_SET_BITS(ready, PRO_MASK_WRITE);
+        }
+        if (cqe.res < 0)
+        {
+            PRO_SET_BITS(ready, PRO_MASK_READ);
+        }
+    }
+    else
+    {
+        if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+        {
+            ringIo->SetInputArmed(false);
+            update = true;
+        }
+
+        if (ringIo->IsListener())
+        {
+            if (cqe.res >= 0)
+            {
+                ringIo->OnAccepted(cqe.res);
+                PRO_SET_BITS(ready, PRO_MASK_READ);
+            }
+        }
+        else if (cqe.res >= 0)
+        {
+            const bool           fromRing = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+            const unsigned short bid      =
+                (unsigned short)(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+
+            ringIo->OnRecvDone(fromRing ? m_bufs + bid * PRO_IO_URING_BUF_SIZE : NULL,
+                cqe.res, bid, fromRing);
+            PRO_SET_BITS(ready, PRO_MASK_READ);
+        }
+        else if (cqe.res != -ENOBUFS && cqe.res != -ECANCELED)
+        {
+            ringIo->OnInputError(-cqe.res);
+            PRO_SET_BITS(ready, PRO_MASK_WRITE | PRO_MASK_READ);
+        }
+        else
+        {
+            /*
+             * out of the provided buffers, or cancelled. It's armed again
+             * after the buffers are recycled
+             */
+        }
+
+        if (!ringIo->WantsInput())
+        {
+            update = true; /* to be cancelled */
+        }
+    }
+
+    UpdateRingReady(ringIo, ready, update);
+}
+
+void
+CProIoUringReactor::UpdateRingReady(CProRingIo*   ringIo,
+                                    unsigned long ready,
+                                    bool          update)
+{
+    CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr =
+        m_polls.find(ringIo->GetSockId());
+    if (itr == m_polls.end() || itr->second.ringIo != ringIo) /* detached */
+    {
+        return;
+    }
+
+    if (update)
+    {
+        m_dirtySockIds.insert(itr->first);
+    }
+
+    PRO_SET_BITS(itr->second.readyMask, ready);
+
+    const PRO_HANDLER_INFO info = m_handlerMgr.FindHandler(itr->first);
+    if ((itr->second.readyMask & info.mask) != 0)
+    {
+        m_edgeRunnables.insert(itr->first);
+    }
+}
+
+void
+CProIoUringReactor::ReapCompletions(CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers,
+                                    unsigned long&                           cqeCount)
+{
+    unsigned int       head = *m_cqHead;
+    const unsigned int tail = LoadAcquire_i(m_cqTail);
+
+    for (; head != tail; ++head)
+    {
+        const struct io_uring_cqe& cqe = m_cqes[head & m_cqMask];
+        ++cqeCount;
+
+        if (cqe.user_data == 0) /* POLL_REMOVE, ASYNC_CANCEL */
+        {
+            continue;
+        }
+
+        if ((cqe.user_data & PRO_RING_FLAG) != 0)
+        {
+            ReapRing(cqe);
+            continue;
+        }
+
+        const PRO_INT64  sockId = (int)(PRO_UINT32)cqe.user_data;
+        const PRO_UINT32 gen    = (PRO_UINT32)(cqe.user_data >> 32);
+
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr =
+            m_polls.find(sockId);
+        if (itr == m_polls.end() || itr->second.gen != gen ||
+            itr->second.events == 0) /* stale */
+        {
+            continue;
+        }
+
+        PRO_IO_URING_POLL& poll = itr->second;
+        if ((cqe.flags & IORING_CQE_F_MORE) == 0)
+        {
+            poll.events = 0;
+            m_dirtySockIds.insert(sockId); /* to be armed again */
+        }
+
+        const PRO_HANDLER_INFO info = m_handlerMgr.FindHandler(sockId);
+        if (info.handler == NULL || cqe.res == -ECANCELED)
+        {
+            continue;
+        }
+
+        if (cqe.res >= 0 && poll.edge)
+        {
+            const unsigned int revents = (unsigned int)cqe.res;
+
+            /*
+             * see CProEpollReactor. POLLERR is also raised by the error
+             * queue (MSG_ZEROCOPY)
+             */
+            if ((revents & POLLERR) != 0)
+            {
+                PRO_SET_BITS(poll.readyMask, PRO_MASK_WRITE | PRO_MASK_READ);
+            }
+            if ((revents & POLLOUT) != 0)
+            {
+                PRO_SET_BITS(poll.readyMask, PRO_MASK_WRITE);
+            }
+            if ((revents & (POLLIN | POLLHUP)) != 0)
+            {
+                PRO_SET_BITS(poll.readyMask, PRO_MASK_READ);
+            }
+            if ((poll.readyMask & info.mask) != 0)
+            {
+                m_edgeRunnables.insert(sockId);
+                continue;
+            }
+            if ((revents & POLLERR) == 0)
+            {
+                continue;
+            }
+        }
+
+        if (cqe.res < 0 || (cqe.res & POLLERR) != 0)
+        {
+            PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
+            if (info2.handler == NULL)
+            {
+                info2.handler = info.handler;
+                info2.mask    = PRO_MASK_ERROR;
+            }
+            continue;
+        }
+
+        const unsigned int revents = (unsigned int)cqe.res;
+
+        PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
+        if (info2.handler != NULL) /* in error */
+        {
+            continue;
+        }
+
+        if ((revents & POLLOUT) != 0 &&
+            PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE))
+        {
+            PRO_SET_BITS(info2.mask, PRO_MASK_WRITE);
+        }
+
+        if ((revents & POLLHUP) != 0 ||
+            ((revents & POLLIN) != 0 &&
+            PRO_BIT_ENABLED(info.mask, PRO_MASK_READ)))
+        {
+            PRO_SET_BITS(info2.mask, PRO_MASK_READ);
+        }
+
+        if ((revents & POLLPRI) != 0 &&
+            PRO_BIT_ENABLED(info.mask, PRO_MASK_EXCEPTION))
+        {
+            PRO_SET_BITS(info2.mask, PRO_MASK_EXCEPTION);
+        }
+
+        if (info2.mask != 0)
+        {
+            info2.handler = info.handler;
+        }
+        else
+        {
+            handlers.erase(sockId);
+        }
+    } /* end of for (...) */
+
+    StoreRelease_i(m_cqHead, head);
+}
+
+void
+CProIoUringReactor::CollectEdgeRunnables(CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers)
+{
+    CProStlSet<PRO_INT64>::iterator       itr = m_edgeRunnables.begin();
+    CProStlSet<PRO_INT64>::iterator const end = m_edgeRunnables.end();
+
+    while (itr != end)
+    {
+        const PRO_INT64        sockId = *itr;
+        const PRO_HANDLER_INFO info   = m_handlerMgr.FindHandler(sockId);
+
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::const_iterator const itr2 =
+            m_polls.find(sockId);
+
+        unsigned long mask = 0;
+        if (info.handler != NULL && itr2 != m_polls.end())
+        {
+            mask = itr2->second.readyMask & info.mask &
+                (PRO_MASK_WRITE | PRO_MASK_READ);
+        }
+
+        if (mask == 0)
+        {
+            m_edgeRunnables.erase(itr++);
+            continue;
+        }
+
+        PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
+        if (info2.handler == NULL) /* not in error */
+        {
+            info2.handler = info.handler;
+            info2.mask    = PRO_MASK_EDGE | mask;
+        }
+
+        ++itr;
+    }
+}
+
+void
+CProIoUringReactor::UpdateEdgeRunnables(
+    const CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers)
+{
+    CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::const_iterator       itr = handlers.begin();
+    CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::const_iterator const end = handlers.end();
+
+    for (; itr != end; ++itr)
+    {
+        if (!PRO_BIT_ENABLED(itr->second.mask, PRO_MASK_EDGE))
+        {
+            continue;
+        }
+
+        const PRO_HANDLER_INFO info = m_handlerMgr.FindHandler(itr->first);
+        if (info.handler != itr->second.handler)
+        {
+            continue;
+        }
+
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr2 =
+            m_polls.find(itr->first);
+        if (itr2 == m_polls.end())
+        {
+            continue;
+        }
+
+        /*
+         * the completion mode. The data staged in the upcalls is sent at the
+         * next round, and the input consumed may be armed again
+         */
+        CProRingIo* const ringIo = itr2->second.ringIo;
+        if (ringIo != NULL)
+        {
+            m_touchedRingIos.insert(ringIo);
+            if (!ringIo->IsInputArmed())
+            {
+                m_dirtySockIds.insert(itr->first);
+            }
+        }
+
+        PRO_CLR_BITS(itr2->second.readyMask, itr->second.mask);
+        if ((itr2->second.readyMask & info.mask) == 0)
+        {
+            m_edgeRunnables.erase(itr->first);
+        }
+    }
+}
+
+void
+PRO_CALLTYPE
+CProIoUringReactor::OnInput(PRO_INT64 sockId)
+{
+    assert(sockId != -1);
+    if (sockId == -1)
+    {
+        return;
+    }
+
+    if (m_notifyPipe->Recv())
+    {
+        m_notifyPipe->EnableNotify();
+        ++m_delta.notifyCount;
+    }
+    else
+    {
+        OnError(sockId, -1);
+    }
+}
+
+void
+PRO_CALLTYPE
+CProIoUringReactor::OnError(PRO_INT64 sockId,
+                            long      errorCode)
+{
+    assert(sockId != -1);
+    if (sockId == -1)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ringFd == -1 || m_wantExit ||
+            sockId != m_notifyPipe->GetReaderSockId())
+        {
+            return;
+        }
+
+        CProNotifyPipe* const newPipe = new CProNotifyPipe;
+        newPipe->Init();
+
+        const PRO_INT64 newSockId = newPipe->GetReaderSockId();
+        if (newSockId == -1)
+        {
+            delete newPipe;
+
+            return;
+        }
+
+        if (!m_handlerMgr.AddHandler(newSockId, this, PRO_MASK_READ))
+        {
+            delete newPipe;
+
+            return;
+        }
+
+        m_polls[newSockId] = PRO_IO_URING_POLL();
+        m_dirtySockIds.insert(newSockId);
+
+        /*
+         * unregister old
+         */
+        CProStlMap<PRO_INT64, PRO_IO_URING_POLL>::iterator const itr =
+            m_polls.find(sockId);
+        if (itr != m_polls.end())
+        {
+            if (itr->second.events != 0)
+            {
+                m_pendingRemoves.push_back(
+                    MakeUserData_i(sockId, itr->second.gen));
+            }
+
+            m_polls.erase(itr);
+        }
+        m_dirtySockIds.erase(sockId);
+        m_handlerMgr.RemoveHandler(sockId, PRO_MASK_READ);
+        delete m_notifyPipe;
+        m_notifyPipe = NULL;
+
+        /*
+         * register new
+         */
+        m_notifyPipe = newPipe;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* PRO_HAS_IO_URING */
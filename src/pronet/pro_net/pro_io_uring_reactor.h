@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#if !defined(PRO_IO_URING_REACTOR_H)
+#define PRO_IO_URING_REACTOR_H
+
+#include "pro_base_reactor.h"
+#include "pro_ring_io.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_z.h"
+
+#if defined(PRO_HAS_IO_URING)
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+struct PRO_IO_URING_POLL
+{
+    PRO_IO_URING_POLL()
+    {
+        gen       = 0;
+        events    = 0;
+        edge      = false;
+        readyMask = 0;
+        ringIo    = NULL;
+    }
+
+    PRO_UINT32    gen;       /* generation of the armed poll */
+    unsigned int  events;    /* events of the armed poll, 0 for none */
+    bool          edge;      /* multishot, for the edge-triggered handlers */
+    unsigned long readyMask; /* for the edge-triggered handlers */
+    CProRingIo*   ringIo;    /* the completion mode, with no poll */
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * A reactor on Linux io_uring. All the requests of a round are queued as
+ * SQEs, and are submitted together with the wait in one io_uring_enter().
+ *
+ * A handler that asked for EnableRingIo() runs in the completion mode. The
+ * reactor keeps a multishot accept, or a multishot recv on a provided buffer
+ * ring, armed on its socket, and submits its staged data with one send per
+ * round. The handler takes the results from its CProRingIo in the upcalls,
+ * so there is no readiness wait and no socket call per event.
+ *
+ * The other handlers wait for readiness with IORING_OP_POLL_ADD, and keep the
+ * OnInput()/OnOutput() contract. A level-triggered handler is armed with a
+ * one-shot poll, and is re-armed after its upcalls. An edge-triggered handler
+ * is armed once with a multishot poll. The edge-triggered and the completion-
+ * mode handlers are dispatched within a budget as CProEpollReactor does.
+ *
+ * It's used only for the reactors created with PRO_RB_IO_URING. Init() fails
+ * if the kernel lacks the features (Linux 6.0+) or forbids io_uring, and
+ * then the caller should fall back to CProEpollReactor.
+ */
+class CProIoUringReactor : public CProBaseReactor
+{
+public:
+
+    CProIoUringReactor();
+
+    virtual ~CProIoUringReactor();
+
+    virtual bool PRO_CALLTYPE Init();
+
+    virtual void PRO_CALLTYPE Fini();
+
+    virtual bool PRO_CALLTYPE AddHandler(
+        PRO_INT64         sockId,
+        CProEventHandler* handler,
+        unsigned long     mask
+        );
+
+    virtual void PRO_CALLTYPE RemoveHandler(
+        PRO_INT64     sockId,
+        unsigned long mask
+        );
+
+    virtual void PRO_CALLTYPE WorkerRun();
+
+    virtual PRO_REACTOR_BACKEND PRO_CALLTYPE GetBackend() const
+    {
+        return (PRO_RB_IO_URING);
+    }
+
+private:
+
+    bool SetupRing();
+
+    bool SetupBufRing();
+
+    void CleanupRing();
+
+    void RecycleBufs(const CProStlVector<unsigned short>& bids);
+
+    struct io_uring_sqe* GetSqe();
+
+    int Submit(unsigned int minComplete);
+
+    void SubmitChanges();
+
+    bool UpdateRingInput(
+        PRO_INT64     sockId,
+        unsigned long mask,
+        CProRingIo*   ringIo
+        );
+
+    void FinishRings();
+
+    void DetachRing(
+        PRO_INT64   sockId,
+        CProRingIo* ringIo
+        );
+
+    void ReapRing(const struct io_uring_cqe& cqe);
+
+    void UpdateRingReady(
+        CProRingIo*   ringIo,
+        unsigned long ready,
+        bool          update
+        );
+
+    void ReapCompletions(
+        CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers,
+        unsigned long&                           cqeCount
+        );
+
+    void CollectEdgeRunnables(CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers);
+
+    void UpdateEdgeRunnables(
+        const CProStlMap<PRO_INT64, PRO_HANDLER_INFO>& handlers
+        );
+
+    virtual void PRO_CALLTYPE OnInput(PRO_INT64 sockId);
+
+    virtual void PRO_CALLTYPE OnError(
+        PRO_INT64 sockId,
+        long      errorCode
+        );
+
+private:
+
+    int                                      m_ringFd;
+    void*                                    m_ringPtr;
+    size_t                                   m_ringSize;
+    struct io_uring_sqe*                     m_sqes;
+    size_t                                   m_sqesSize;
+    unsigned int*                            m_sqHead;
+    unsigned int*                            m_sqTail;
+    unsigned int*                            m_sqArray;
+    unsigned int                             m_sqMask;
+    unsigned int                             m_sqEntries;
+    unsigned int                             m_sqLocalTail;
+    unsigned int*                            m_cqHead;
+    unsigned int*                            m_cqTail;
+    unsigned int                             m_cqMask;
+    struct io_uring_cqe*                     m_cqes;
+    PRO_UINT32                               m_nextGen;
+    struct io_uring_buf_ring*                m_bufRing;        /* the provided buffer ring */
+    char*                                    m_bufs;
+    unsigned short                           m_bufTail;
+
+    CProStlMap<PRO_INT64, PRO_IO_URING_POLL> m_polls;          /* sockId ---> poll */
+    CProStlSet<PRO_INT64>                    m_dirtySockIds;   /* sockIds to be armed again */
+    CProStlVector<PRO_UINT64>                m_pendingRemoves; /* user_data of the polls to be removed */
+    CProStlSet<PRO_INT64>                    m_edgeRunnables;  /* sockIds with ready and wanted masks */
+    CProStlVector<PRO_UINT64>                m_pendingCancels; /* user_data of the requests to be cancelled */
+    CProStlSet<CProRingIo*>                  m_ringIos;        /* with a reference, while they have work */
+    CProStlSet<CProRingIo*>                  m_touchedRingIos; /* to be finished at the next round */
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* PRO_HAS_IO_URING */
+
+#endif /* PRO_IO_URING_REACTOR_H */
@@ -18,6 +18,7 @@
 
 #include "pro_net.h"
 #include "pro_acceptor.h"
+#include "pro_bulk_connector.h"
 #include "pro_connector.h"
 #include "pro_mcast_transport.h"
 #include "pro_service_host.h"
@@ -95,7 +96,27 @@ ProCreateReactor(unsigned long ioThreadCount,
     ProNetInit();
 
     CProTpReactorTask* const reactorTask = new CProTpReactorTask;
-    if (!reactorTask->Start(ioThreadCount, ioThreadPriority))
+    if (!reactorTask->Start(ioThreadCount, ioThreadPriority, PRO_RB_DEFAULT))
+    {
+        delete reactorTask;
+
+        return (NULL);
+    }
+
+    return (reactorTask);
+}
+
+PRO_NET_API
+IProReactor*
+PRO_CALLTYPE
+ProCreateReactorEx(unsigned long       ioThreadCount,
+                   long                ioThreadPriority,
+                   PRO_REACTOR_BACKEND backend)
+{
+    ProNetInit();
+
+    CProTpReactorTask* const reactorTask = new CProTpReactorTask;
+    if (!reactorTask->Start(ioThreadCount, ioThreadPriority, backend))
     {
         delete reactorTask;
 
@@ -285,6 +306,71 @@ ProDeleteConnector(IProConnector* connector)
     p->Release();
 }
 
+PRO_NET_API
+IProBulkConnector*
+PRO_CALLTYPE
+ProCreateBulkConnector(bool                   enableServiceExt,
+                       unsigned char          serviceId,
+                       unsigned char          serviceOpt,
+                       IProConnectorObserver* observer,
+                       IProReactor*           reactor,
+                       unsigned long          connectsPerSecond, /* = 0 */
+                       unsigned long          timeoutInSeconds)  /* = 0 */
+{
+    ProNetInit();
+
+    CProBulkConnector* const connector = CProBulkConnector::CreateInstance(
+        enableServiceExt, serviceId, serviceOpt);
+    if (connector == NULL)
+    {
+        return (NULL);
+    }
+
+    if (!connector->Init(observer, (CProTpReactorTask*)reactor,
+        connectsPerSecond, timeoutInSeconds))
+    {
+        connector->Release();
+
+        return (NULL);
+    }
+
+    return ((IProBulkConnector*)connector);
+}
+
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProBulkConnect(IProBulkConnector*        connector,
+               const PRO_CONNECT_TARGET* targets,
+               unsigned long             count)
+{
+    assert(connector != NULL);
+    if (connector == NULL)
+    {
+        return (0);
+    }
+
+    CProBulkConnector* const p = (CProBulkConnector*)connector;
+    const unsigned long      n = p->Connect(targets, count);
+
+    return (n);
+}
+
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProDeleteBulkConnector(IProBulkConnector* connector)
+{
+    if (connector == NULL)
+    {
+        return;
+    }
+
+    CProBulkConnector* const p = (CProBulkConnector*)connector;
+    p->Fini();
+    p->Release();
+}
+
 PRO_NET_API
 IProTcpHandshaker*
 PRO_CALLTYPE
@@ -430,7 +516,7 @@ ProCreateUdpTransport(IProTransportObserver* observer,
     ProNetInit();
 
     CProUdpTransport* const trans =
-        CProUdpTransport::CreateInstance(recvPoolSize);
+        CProUdpTransport::CreateInstance(recvPoolSize, false);
     if (trans == NULL)
     {
         return (NULL);
@@ -438,7 +524,40 @@ ProCreateUdpTransport(IProTransportObserver* observer,
 
     if (!trans->Init(observer, (CProTpReactorTask*)reactor,
         localIp, localPort, defaultRemoteIp, defaultRemotePort,
-        sockBufSizeRecv, sockBufSizeSend))
+        sockBufSizeRecv, sockBufSizeSend, false))
+    {
+        trans->Release();
+
+        return (NULL);
+    }
+
+    return (trans);
+}
+
+PRO_NET_API
+IProTransport*
+PRO_CALLTYPE
+ProCreateUdpTransportEx(IProTransportObserver* observer,
+                        IProReactor*           reactor,
+                        const char*            localIp,         /* = NULL */
+                        unsigned short         localPort,       /* = 0 */
+                        size_t                 sockBufSizeRecv, /* = 0 */
+                        size_t                 sockBufSizeSend, /* = 0 */
+                        size_t                 recvPoolSize,    /* = 0 */
+                        bool                   reusePort)       /* = false */
+{
+    ProNetInit();
+
+    CProUdpTransport* const trans =
+        CProUdpTransport::CreateInstance(recvPoolSize, true);
+    if (trans == NULL)
+    {
+        return (NULL);
+    }
+
+    if (!trans->Init(observer, (CProTpReactorTask*)reactor,
+        localIp, localPort, NULL, 0,
+        sockBufSizeRecv, sockBufSizeSend, reusePort))
     {
         trans->Release();
 
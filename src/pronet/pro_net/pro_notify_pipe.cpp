@@ -19,10 +19,16 @@
 #include "pro_notify_pipe.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
-#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_thread_mutex.h"
 #include "../pro_util/pro_z.h"
 #include <cassert>
 
+#if defined(_WIN32) || defined(_WIN32_WCE)
+#include <windows.h>
+#elif defined(PRO_HAS_EVENTFD)
+#include <sys/eventfd.h>
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -34,10 +40,9 @@
 
 CProNotifyPipe::CProNotifyPipe()
 {
-    m_sockIds[0]   = -1;
-    m_sockIds[1]   = -1;
-    m_enableNotify = true;
-    m_notifyTick   = 0;
+    m_sockIds[0] = -1;
+    m_sockIds[1] = -1;
+    m_signalled  = 0;
 }
 
 CProNotifyPipe::~CProNotifyPipe()
@@ -101,6 +106,17 @@ CProNotifyPipe::Init()
     m_sockIds[0] = sockId;
     m_sockIds[1] = sockId;
 
+#elif defined(PRO_HAS_EVENTFD)
+
+    const int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    m_sockIds[0] = fd;
+    m_sockIds[1] = fd;
+
 #else  /* _WIN32, _WIN32_WCE */
 
     PRO_INT64 sockIds[2] = { -1, -1 };
@@ -122,15 +138,19 @@ CProNotifyPipe::Fini()
 {
 #if defined(_WIN32) || defined(_WIN32_WCE)
     pbsd_closesocket(m_sockIds[0]);
+#elif defined(PRO_HAS_EVENTFD)
+    if (m_sockIds[0] != -1)
+    {
+        close((int)m_sockIds[0]);
+    }
 #else
     pbsd_closesocket(m_sockIds[0]);
     pbsd_closesocket(m_sockIds[1]);
 #endif
 
-    m_sockIds[0]   = -1;
-    m_sockIds[1]   = -1;
-    m_enableNotify = true;
-    m_notifyTick   = 0;
+    m_sockIds[0] = -1;
+    m_sockIds[1] = -1;
+    m_signalled  = 0;
 }
 
 PRO_INT64
@@ -145,11 +165,44 @@ CProNotifyPipe::GetWriterSockId() const
     return (m_sockIds[1]);
 }
 
+bool
+CProNotifyPipe::Recv()
+{
+    const PRO_INT64 sockId = GetReaderSockId();
+    if (sockId == -1)
+    {
+        return (false);
+    }
+
+#if defined(PRO_HAS_EVENTFD)
+
+    PRO_UINT64 value = 0;
+    const int  readSize = (int)read((int)sockId, &value, sizeof(PRO_UINT64));
+
+    return (
+        readSize == (int)sizeof(PRO_UINT64)
+        ||
+        (readSize < 0 && errno == EAGAIN)
+        );
+
+#else  /* PRO_HAS_EVENTFD */
+
+    char      buf[64];
+    const int recvSize = pbsd_recv(sockId, buf, sizeof(buf), 0); /* connected */
+
+    return (
+        (recvSize > 0 && recvSize <= (int)sizeof(buf))
+        ||
+        (recvSize < 0 && pbsd_errno((void*)&pbsd_recv) == PBSD_EWOULDBLOCK)
+        );
+
+#endif /* PRO_HAS_EVENTFD */
+}
+
 void
 CProNotifyPipe::EnableNotify()
 {
-    m_enableNotify = true;
-    m_notifyTick   = 0;
+    SetSignalled(false);
 }
 
 void
@@ -161,20 +214,42 @@ CProNotifyPipe::Notify()
         return;
     }
 
-    PRO_INT64 tick = 0;
-    if (!m_enableNotify)
+    if (SetSignalled(true))
     {
-        tick = ProGetTickCount64();
-        if (tick <= m_notifyTick)
-        {
-            return;
-        }
+        return;
     }
 
+#if defined(PRO_HAS_EVENTFD)
+    const PRO_UINT64 value = 1;
+    const bool       ret   =
+        write((int)sockId, &value, sizeof(PRO_UINT64)) == (int)sizeof(PRO_UINT64);
+#else
     const char buf[] = { 0 };
-    if (pbsd_send(sockId, buf, sizeof(buf), 0) > 0) /* connected */
+    const bool ret   = pbsd_send(sockId, buf, sizeof(buf), 0) > 0; /* connected */
+#endif
+
+    if (!ret)
     {
-        m_enableNotify = false;
-        m_notifyTick   = tick > 0 ? tick : ProGetTickCount64();
+        SetSignalled(false);
     }
 }
+
+bool
+CProNotifyPipe::SetSignalled(bool signalled)
+{
+    const long value = signalled ? 1 : 0;
+
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    const long oldValue = ::InterlockedExchange((long*)&m_signalled, value);
+#elif defined(PRO_HAS_ATOMOP)
+    __sync_synchronize();
+    const long oldValue = __sync_lock_test_and_set(&m_signalled, value);
+#else
+    m_lock.Lock();
+    const long oldValue = m_signalled;
+    m_signalled = value;
+    m_lock.Unlock();
+#endif
+
+    return (oldValue != 0);
+}
@@ -20,10 +20,18 @@
 #define PRO_NOTIFY_PIPE_H
 
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_thread_mutex.h"
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+/*
+ * The signal is an eventfd on the platforms having PRO_HAS_EVENTFD, or a
+ * connected socket pair otherwise. At most one signal is pending at any
+ * time. Notify() only sets the "signalled" flag and writes the signal if
+ * the flag was clear, so that a burst of notifications costs one wakeup.
+ * The reader calls Recv() and then EnableNotify() to re-arm it.
+ */
 class CProNotifyPipe
 {
 public:
@@ -40,15 +48,25 @@ public:
 
     PRO_INT64 GetWriterSockId() const;
 
+    bool Recv();
+
     void EnableNotify();
 
     void Notify();
 
 private:
 
-    PRO_INT64 m_sockIds[2];
-    bool      m_enableNotify;
-    PRO_INT64 m_notifyTick;
+    bool SetSignalled(bool signalled);
+
+private:
+
+    PRO_INT64       m_sockIds[2];
+#if defined(_WIN32) || defined(_WIN32_WCE) || defined(PRO_HAS_ATOMOP)
+    volatile long   m_signalled;
+#else
+    long            m_signalled;
+    CProThreadMutex m_lock;
+#endif
 
     DECLARE_SGI_POOL(0)
 };
@@ -20,6 +20,7 @@
 #define PRO_RECV_POOL_H
 
 #include "pro_net.h"
+#include "pro_recv_slab.h"
 #include "../pro_util/pro_buffer.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_z.h"
@@ -27,6 +28,11 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#define PRO_LEAN_RECV_POOL_SIZE 1024
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 class CProRecvPool : public IProRecvPool
 {
 public:
@@ -39,45 +45,94 @@ public:
         m_dataSize = 0;
         m_idle     = NULL;
         m_idleSize = 0;
+        m_slab     = NULL;
+        m_slabBuf  = NULL;
+        m_slabSize = 0;
     }
 
     virtual ~CProRecvPool()
     {
-        m_begin    = NULL;
-        m_end      = NULL;
-        m_data     = NULL;
-        m_dataSize = 0;
-        m_idle     = NULL;
-        m_idleSize = 0;
+        DetachSlab();
+        Attach(NULL, 0);
     }
 
-    bool Resize(size_t size)
+    /*
+     * the "slab" selects the lean mode. the pool holds a small buffer while
+     * it's empty, and borrows a slab of "size" bytes only to hold more
+     */
+    bool Resize(
+        size_t        size,
+        CProRecvSlab* slab = NULL
+        )
     {
         if (size == 0)
         {
             return (false);
         }
 
-        m_begin    = NULL;
-        m_end      = NULL;
-        m_data     = NULL;
-        m_dataSize = 0;
-        m_idle     = NULL;
-        m_idleSize = 0;
+        DetachSlab();
+        Attach(NULL, 0);
+
+        if (slab != NULL && size > PRO_LEAN_RECV_POOL_SIZE)
+        {
+            if (!m_buf.Resize(PRO_LEAN_RECV_POOL_SIZE))
+            {
+                return (false);
+            }
+
+            slab->AddRef();
+            slab->AttachPool();
+            m_slab     = slab;
+            m_slabSize = size;
+            Attach((char*)m_buf.Data(), PRO_LEAN_RECV_POOL_SIZE);
+        }
+        else
+        {
+            if (!m_buf.Resize(size))
+            {
+                return (false);
+            }
+
+            Attach((char*)m_buf.Data(), size);
+        }
+
+        return (true);
+    }
+
+    /*
+     * lean mode. moves the data held by the small buffer into a slab
+     */
+    bool Expand()
+    {
+        if (m_slab == NULL || m_slabBuf != NULL || m_dataSize == 0)
+        {
+            return (true);
+        }
 
-        if (!m_buf.Resize(size))
+        char* const buf = m_slab->Borrow(m_slabSize);
+        if (buf == NULL)
         {
             return (false);
         }
 
-        m_begin    = (char*)m_buf.Data();
-        m_end      = m_begin + size;
-        m_idle     = m_begin;
-        m_idleSize = size;
+        const size_t dataSize = m_dataSize;
+        PeekData(buf, dataSize);
+
+        Attach(buf, m_slabSize);
+        m_slabBuf  = buf;
+        m_data     = m_begin;
+        m_dataSize = dataSize;
+        m_idle     = m_begin + dataSize;
+        m_idleSize = m_slabSize - dataSize;
 
         return (true);
     }
 
+    bool IsSmall() const
+    {
+        return (m_slab != NULL && m_slabBuf == NULL);
+    }
+
     virtual unsigned long PRO_CALLTYPE PeekDataSize() const
     {
         return ((unsigned long)m_dataSize);
@@ -148,10 +203,28 @@ public:
         }
 
         m_dataSize -= size;
+
+        /*
+         * lean mode. the slab goes back once the pool is empty
+         */
+        if (m_dataSize == 0 && m_slabBuf != NULL)
+        {
+            m_slab->Return(m_slabBuf, m_slabSize);
+            m_slabBuf = NULL;
+            Attach((char*)m_buf.Data(), PRO_LEAN_RECV_POOL_SIZE);
+        }
     }
 
+    /*
+     * in lean mode, a small pool counts the slab it can borrow
+     */
     virtual unsigned long PRO_CALLTYPE GetFreeSize() const
     {
+        if (IsSmall())
+        {
+            return ((unsigned long)(m_slabSize - m_dataSize));
+        }
+
         return ((unsigned long)m_idleSize);
     }
 
@@ -202,6 +275,34 @@ public:
 
 private:
 
+    void Attach(
+        char*  buf,
+        size_t size
+        )
+    {
+        m_begin    = buf;
+        m_end      = buf + size;
+        m_data     = NULL;
+        m_dataSize = 0;
+        m_idle     = size > 0 ? buf : NULL;
+        m_idleSize = size;
+    }
+
+    void DetachSlab()
+    {
+        if (m_slab == NULL)
+        {
+            return;
+        }
+
+        m_slab->Return(m_slabBuf, m_slabSize);
+        m_slab->DetachPool();
+        m_slab->Release();
+        m_slab     = NULL;
+        m_slabBuf  = NULL;
+        m_slabSize = 0;
+    }
+
     size_t ContinuousDataSize() const
     {
         if (m_data + m_dataSize > m_end)
@@ -214,13 +315,16 @@ private:
 
 private:
 
-    CProBuffer m_buf;
-    char*      m_begin; /* const */
-    char*      m_end;   /* const */
-    char*      m_data;
-    size_t     m_dataSize;
-    char*      m_idle;
-    size_t     m_idleSize;
+    CProBuffer    m_buf;
+    char*         m_begin; /* const */
+    char*         m_end;   /* const */
+    char*         m_data;
+    size_t        m_dataSize;
+    char*         m_idle;
+    size_t        m_idleSize;
+    CProRecvSlab* m_slab;     /* lean mode */
+    char*         m_slabBuf;  /* borrowed from m_slab */
+    size_t        m_slabSize;
 
     DECLARE_SGI_POOL(0)
 };
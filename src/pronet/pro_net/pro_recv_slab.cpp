@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "pro_recv_slab.h"
+#include "pro_net.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProRecvSlab*
+CProRecvSlab::CreateInstance(unsigned long maxSlabCount)
+{
+    CProRecvSlab* const slab = new CProRecvSlab(maxSlabCount);
+
+    return (slab);
+}
+
+CProRecvSlab::CProRecvSlab(unsigned long maxSlabCount)
+{
+    m_maxSlabCount  = maxSlabCount;
+    m_poolCount     = 0;
+    m_busyCount     = 0;
+    m_maxBusyCount  = 0;
+    m_busyBytes     = 0;
+    m_freeCount     = 0;
+    m_borrowCount   = 0;
+    m_overflowCount = 0;
+}
+
+CProRecvSlab::~CProRecvSlab()
+{
+    CProStlMap<size_t, CProStlVector<char*> >::iterator       itr = m_freeSlabs.begin();
+    CProStlMap<size_t, CProStlVector<char*> >::iterator const end = m_freeSlabs.end();
+
+    for (; itr != end; ++itr)
+    {
+        CProStlVector<char*>& slabs = itr->second;
+
+        int       i = 0;
+        const int c = (int)slabs.size();
+
+        for (; i < c; ++i)
+        {
+            ProFree(slabs[i]);
+        }
+    }
+
+    m_freeSlabs.clear();
+}
+
+void
+CProRecvSlab::SetMaxSlabCount(unsigned long maxSlabCount)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_maxSlabCount = maxSlabCount;
+}
+
+char*
+CProRecvSlab::Borrow(size_t size)
+{
+    assert(size > 0);
+    if (size == 0)
+    {
+        return (NULL);
+    }
+
+    char* buf = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlMap<size_t, CProStlVector<char*> >::iterator const itr =
+            m_freeSlabs.find(size);
+        if (itr != m_freeSlabs.end() && itr->second.size() > 0)
+        {
+            buf = itr->second.back();
+            itr->second.pop_back();
+            --m_freeCount;
+        }
+        else
+        {
+            buf = (char*)ProMalloc(size);
+            if (buf == NULL)
+            {
+                return (NULL);
+            }
+        }
+
+        ++m_busyCount;
+        if (m_busyCount > m_maxBusyCount)
+        {
+            m_maxBusyCount = m_busyCount;
+        }
+        if (m_busyCount > m_maxSlabCount)
+        {
+            ++m_overflowCount;
+        }
+
+        m_busyBytes += size;
+        ++m_borrowCount;
+    }
+
+    return (buf);
+}
+
+void
+CProRecvSlab::Return(char*  buf,
+                     size_t size)
+{
+    if (buf == NULL || size == 0)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_busyCount > 0);
+        --m_busyCount;
+        m_busyBytes -= size;
+
+        /*
+         * the slabs beyond the cap go back to the heap
+         */
+        if (m_busyCount + m_freeCount < m_maxSlabCount)
+        {
+            m_freeSlabs[size].push_back(buf);
+            ++m_freeCount;
+            buf = NULL;
+        }
+    }
+
+    ProFree(buf);
+}
+
+void
+CProRecvSlab::AttachPool()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    ++m_poolCount;
+}
+
+void
+CProRecvSlab::DetachPool()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    assert(m_poolCount > 0);
+    --m_poolCount;
+}
+
+void
+CProRecvSlab::GetStats(PRO_RECV_SLAB_STATS& stats) const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    stats.maxSlabCount     = m_maxSlabCount;
+    stats.leanPoolCount    = m_poolCount;
+    stats.busySlabCount    = m_busyCount;
+    stats.busySlabBytes    = m_busyBytes;
+    stats.maxBusySlabCount = m_maxBusyCount;
+    stats.freeSlabCount    = m_freeCount;
+    stats.borrowCount      = m_borrowCount;
+    stats.overflowCount    = m_overflowCount;
+}
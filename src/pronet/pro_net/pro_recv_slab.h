@@ -0,0 +1,86 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+/*
+ * A shared source of the receive buffers of the recv pools in lean mode.
+ *
+ * A lean pool keeps a small buffer while it's empty, and borrows a slab
+ * only when it has to hold a partial message. The slabs returned are kept
+ * for reuse up to the cap, and the others go back to the heap.
+ */
+
+#if !defined(PRO_RECV_SLAB_H)
+#define PRO_RECV_SLAB_H
+
+#include "pro_net.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CProRecvSlab : public CProRefCount
+{
+public:
+
+    static CProRecvSlab* CreateInstance(unsigned long maxSlabCount);
+
+    void SetMaxSlabCount(unsigned long maxSlabCount);
+
+    char* Borrow(size_t size);
+
+    void Return(
+        char*  buf,
+        size_t size
+        );
+
+    void AttachPool();
+
+    void DetachPool();
+
+    void GetStats(PRO_RECV_SLAB_STATS& stats) const;
+
+private:
+
+    CProRecvSlab(unsigned long maxSlabCount);
+
+    virtual ~CProRecvSlab();
+
+private:
+
+    unsigned long                             m_maxSlabCount;
+    unsigned long                             m_poolCount;
+    unsigned long                             m_busyCount;
+    unsigned long                             m_maxBusyCount;
+    PRO_UINT64                                m_busyBytes;
+    unsigned long                             m_freeCount;
+    PRO_UINT64                                m_borrowCount;
+    PRO_UINT64                                m_overflowCount;
+    CProStlMap<size_t, CProStlVector<char*> > m_freeSlabs; /* size ---> slabs */
+    mutable CProThreadMutex                   m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* PRO_RECV_SLAB_H */
@@ -0,0 +1,596 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "pro_ring_io.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProRingIo*
+CProRingIo::CreateInstance(PRO_INT64 sockId,
+                           bool      listener)
+{
+    assert(sockId != -1);
+    if (sockId == -1)
+    {
+        return (NULL);
+    }
+
+    CProRingIo* const ringIo = new CProRingIo(sockId, listener);
+
+    return (ringIo);
+}
+
+CProRingIo::CProRingIo(PRO_INT64 sockId,
+                       bool      listener)
+: m_sockId(sockId),
+  m_listener(listener)
+{
+    m_fd         = -1;
+    m_registered = false;
+    m_inputArmed = false;
+    m_eof        = false;
+    m_errorCode  = 0;
+    m_recvSize   = 0;
+    m_flightSent = 0;
+    m_sending    = false;
+}
+
+CProRingIo::~CProRingIo()
+{
+    assert(!m_sending);
+    assert(!m_inputArmed);
+
+    int       i = 0;
+    const int c = (int)m_fds.size();
+
+    for (; i < c; ++i)
+    {
+        pbsd_closesocket(m_fds[i]);
+    }
+
+    int       j = 0;
+    const int d = (int)m_segments.size();
+
+    for (; j < d; ++j)
+    {
+        if (m_segments[j].owned)
+        {
+            ProFree(m_segments[j].buf);
+        }
+    }
+
+    pbsd_closesocket(m_fd, true); /* after the staged data */
+
+    m_fds.clear();
+    m_segments.clear();
+    m_fd = -1;
+}
+
+PRO_INT64
+CProRingIo::Accept()
+{
+    PRO_INT64 fd = -1;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_fds.size() > 0)
+        {
+            fd = m_fds.front();
+            m_fds.pop_front();
+        }
+    }
+
+    return (fd);
+}
+
+int
+CProRingIo::Recv(void*  buf,
+                 size_t size,
+                 int&   errorCode)
+{
+    assert(buf != NULL);
+    assert(size > 0);
+    if (buf == NULL || size == 0)
+    {
+        errorCode = -1;
+
+        return (-1);
+    }
+
+    errorCode = 0;
+
+    size_t recvSize = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        while (recvSize < size && m_segments.size() > 0)
+        {
+            PRO_RING_SEGMENT& segment = m_segments.front();
+
+            size_t copySize = segment.size - segment.offset;
+            if (copySize > size - recvSize)
+            {
+                copySize = size - recvSize;
+            }
+
+            memcpy((char*)buf + recvSize, segment.buf + segment.offset, copySize);
+            segment.offset += copySize;
+            recvSize       += copySize;
+            m_recvSize     -= copySize;
+
+            if (segment.offset < segment.size)
+            {
+                break;
+            }
+
+            if (segment.owned)
+            {
+                ProFree(segment.buf);
+            }
+            else
+            {
+                m_freeBids.push_back(segment.bid);
+            }
+
+            m_segments.pop_front();
+        }
+
+        if (recvSize > 0)
+        {
+            return ((int)recvSize);
+        }
+
+        if (m_errorCode != 0)
+        {
+            errorCode = m_errorCode;
+
+            return (-1);
+        }
+
+        if (m_eof)
+        {
+            return (0);
+        }
+    }
+
+    errorCode = PBSD_EWOULDBLOCK;
+
+    return (-1);
+}
+
+int
+CProRingIo::Send(const void* buf,
+                 size_t      size,
+                 int&        errorCode)
+{
+    assert(buf != NULL);
+    assert(size > 0);
+    if (buf == NULL || size == 0)
+    {
+        errorCode = -1;
+
+        return (-1);
+    }
+
+    errorCode = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_errorCode != 0)
+        {
+            errorCode = m_errorCode;
+
+            return (-1);
+        }
+
+        if (m_registered && m_stage.size() < PRO_RING_SEND_SIZE)
+        {
+            if (size > PRO_RING_SEND_SIZE - m_stage.size())
+            {
+                size = PRO_RING_SEND_SIZE - m_stage.size();
+            }
+
+            m_stage.append((const char*)buf, size);
+
+            return ((int)size);
+        }
+    }
+
+    errorCode = PBSD_EWOULDBLOCK;
+
+    return (-1);
+}
+
+PRO_INT64
+CProRingIo::GetFd() const
+{
+    PRO_INT64 fd = -1;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_fd != -1)
+        {
+            fd = m_fd;
+        }
+        else if (m_registered)
+        {
+            fd = m_sockId;
+        }
+        else
+        {
+        }
+    }
+
+    return (fd);
+}
+
+void
+CProRingIo::KeepFd(PRO_INT64 fd)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_fd != -1)
+        {
+            pbsd_closesocket(fd, true);
+
+            return;
+        }
+
+        m_fd = fd;
+    }
+}
+
+void
+CProRingIo::SetRegistered(bool registered)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_registered = registered;
+    }
+}
+
+bool
+CProRingIo::IsRegistered() const
+{
+    bool registered = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        registered = m_registered;
+    }
+
+    return (registered);
+}
+
+void
+CProRingIo::SetInputArmed(bool armed)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_inputArmed = armed;
+    }
+}
+
+bool
+CProRingIo::IsInputArmed() const
+{
+    bool armed = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        armed = m_inputArmed;
+    }
+
+    return (armed);
+}
+
+bool
+CProRingIo::WantsInput() const
+{
+    bool wants = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_listener)
+        {
+            wants = m_fds.size() < PRO_RING_ACCEPT_QUEUE_SIZE;
+        }
+        else
+        {
+            wants = m_errorCode == 0 && !m_eof &&
+                m_recvSize < PRO_RING_RECV_QUEUE_SIZE;
+        }
+    }
+
+    return (wants);
+}
+
+bool
+CProRingIo::IsReadable() const
+{
+    bool readable = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_listener)
+        {
+            readable = m_fds.size() > 0;
+        }
+        else
+        {
+            readable = m_segments.size() > 0 || m_eof || m_errorCode != 0;
+        }
+    }
+
+    return (readable);
+}
+
+bool
+CProRingIo::IsWritable() const
+{
+    bool writable = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        writable = m_errorCode != 0 || m_stage.size() < PRO_RING_SEND_SIZE;
+    }
+
+    return (writable);
+}
+
+bool
+CProRingIo::HasSendData() const
+{
+    bool has = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        has = m_errorCode == 0 &&
+            (m_sending || m_flightSent < m_flight.size() || m_stage.size() > 0);
+    }
+
+    return (has);
+}
+
+bool
+CProRingIo::HasWork() const
+{
+    bool has = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        /*
+         * the flight is referenced by the kernel until the completion, even
+         * in error
+         */
+        has = m_registered || m_inputArmed || m_sending ||
+            (m_errorCode == 0 && m_fd != -1 &&
+            (m_flightSent < m_flight.size() || m_stage.size() > 0));
+    }
+
+    return (has);
+}
+
+void
+CProRingIo::OnAccepted(PRO_INT64 fd)
+{
+    assert(fd != -1);
+    if (fd == -1)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_fds.push_back(fd);
+    }
+}
+
+void
+CProRingIo::OnRecvDone(char*          buf,
+                       int            res,
+                       unsigned short bid,
+                       bool           fromRing)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (res > 0)
+        {
+            PRO_RING_SEGMENT segment;
+            segment.buf    = buf;
+            segment.size   = res;
+            segment.offset = 0;
+            segment.bid    = bid;
+            segment.owned  = !fromRing;
+
+            m_segments.push_back(segment);
+            m_recvSize += res;
+        }
+        else
+        {
+            if (fromRing)
+            {
+                m_freeBids.push_back(bid);
+            }
+
+            m_eof = true;
+        }
+    }
+}
+
+void
+CProRingIo::OnInputError(int errorCode)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_errorCode == 0)
+        {
+            m_errorCode = errorCode != 0 ? errorCode : -1;
+        }
+    }
+}
+
+void
+CProRingIo::Compact(CProStlVector<unsigned short>& bids)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        int       i = 0;
+        const int c = (int)m_segments.size();
+
+        for (; i < c; ++i)
+        {
+            PRO_RING_SEGMENT& segment = m_segments[i];
+            if (segment.owned)
+            {
+                continue;
+            }
+
+            const size_t size = segment.size - segment.offset;
+            char* const  buf  = (char*)ProMalloc(size);
+            if (buf == NULL)
+            {
+                m_errorCode = -1; /* the data can't be kept */
+                break;
+            }
+
+            memcpy(buf, segment.buf + segment.offset, size);
+            bids.push_back(segment.bid);
+
+            segment.buf    = buf;
+            segment.size   = size;
+            segment.offset = 0;
+            segment.owned  = true;
+        }
+
+        if (m_errorCode != 0)
+        {
+            while (m_segments.size() > 0 && !m_segments.back().owned)
+            {
+                bids.push_back(m_segments.back().bid);
+                m_recvSize -= m_segments.back().size - m_segments.back().offset;
+                m_segments.pop_back();
+            }
+        }
+
+        bids.insert(bids.end(), m_freeBids.begin(), m_freeBids.end());
+        m_freeBids.clear();
+    }
+}
+
+bool
+CProRingIo::PreSend(const char*& buf,
+                    size_t&      size)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_sending || m_errorCode != 0 || (!m_registered && m_fd == -1))
+        {
+            return (false);
+        }
+
+        if (m_flightSent == m_flight.size())
+        {
+            if (m_stage.size() == 0)
+            {
+                return (false);
+            }
+
+            m_flight.swap(m_stage);
+            m_stage.clear();
+            m_flightSent = 0;
+        }
+
+        buf       = m_flight.data() + m_flightSent;
+        size      = m_flight.size() - m_flightSent;
+        m_sending = true;
+    }
+
+    return (true);
+}
+
+void
+CProRingIo::OnSendDone(int res)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_sending);
+        m_sending = false;
+
+        if (res < 0)
+        {
+            if (m_errorCode == 0)
+            {
+                m_errorCode = -res;
+            }
+
+            return;
+        }
+
+        m_flightSent += res;
+        if (m_flightSent >= m_flight.size())
+        {
+            m_flight.clear();
+            m_flightSent = 0;
+        }
+    }
+}
+
+void
+CProRingIo::Abort()
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_registered = false;
+        m_inputArmed = false;
+        m_sending    = false;
+
+        if (m_errorCode == 0)
+        {
+            m_errorCode = -1;
+        }
+    }
+}
@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+/*
+ * The completion-mode I/O of a socket on an io_uring reactor.
+ *
+ * The reactor keeps a multishot accept or a multishot recv armed on the
+ * socket, and queues the results here. The handler takes them with Accept()
+ * or Recv() in its upcalls, which have the results of pbsd_accept() and
+ * pbsd_recv() and never enter the kernel. Send() stages the data, and the
+ * reactor submits the staged data with one send per round.
+ *
+ * The handler calls the handler side in its upcalls, and the reactor calls
+ * the others in its worker thread. The object is shared by reference, for
+ * the reactor may still have requests in flight after the handler is gone.
+ */
+
+#if !defined(PRO_RING_IO_H)
+#define PRO_RING_IO_H
+
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#if !defined(PRO_RING_RECV_QUEUE_SIZE)
+#define PRO_RING_RECV_QUEUE_SIZE   (1024 * 256) /* the recv is cancelled beyond it */
+#endif
+
+#if !defined(PRO_RING_ACCEPT_QUEUE_SIZE)
+#define PRO_RING_ACCEPT_QUEUE_SIZE 1024         /* the accept is cancelled beyond it */
+#endif
+
+#if !defined(PRO_RING_SEND_SIZE)
+#define PRO_RING_SEND_SIZE         (1024 * 64)  /* staged per socket */
+#endif
+
+/*
+ * a piece of the received data. It's a provided buffer of the reactor within
+ * the round, or a copy owned by the queue after the round
+ */
+struct PRO_RING_SEGMENT
+{
+    char*          buf;
+    size_t         size;
+    size_t         offset; /* the bytes taken */
+    unsigned short bid;    /* the provided buffer id */
+    bool           owned;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CProRingIo : public CProRefCount
+{
+public:
+
+    static CProRingIo* CreateInstance(
+        PRO_INT64 sockId,
+        bool      listener
+        );
+
+    /*
+     * the handler side. They return what pbsd_accept() and pbsd_recv()/
+     * pbsd_send() would return, and "errorCode" is PBSD_EWOULDBLOCK if
+     * there is nothing to do now
+     */
+
+    PRO_INT64 Accept();
+
+    int Recv(
+        void*  buf,
+        size_t size,
+        int&   errorCode
+        );
+
+    int Send(
+        const void* buf,
+        size_t      size,
+        int&        errorCode
+        );
+
+    /*
+     * the reactor side
+     */
+
+    PRO_INT64 GetSockId() const
+    {
+        return (m_sockId);
+    }
+
+    bool IsListener() const
+    {
+        return (m_listener);
+    }
+
+    PRO_INT64 GetFd() const;
+
+    void KeepFd(PRO_INT64 fd);
+
+    void SetRegistered(bool registered);
+
+    bool IsRegistered() const;
+
+    void SetInputArmed(bool armed);
+
+    bool IsInputArmed() const;
+
+    bool WantsInput() const;
+
+    bool IsReadable() const;
+
+    bool IsWritable() const;
+
+    bool HasSendData() const;
+
+    bool HasWork() const;
+
+    void OnAccepted(PRO_INT64 fd);
+
+    void OnRecvDone(
+        char*          buf,
+        int            res,
+        unsigned short bid,
+        bool           fromRing
+        );
+
+    void OnInputError(int errorCode);
+
+    void Compact(CProStlVector<unsigned short>& bids);
+
+    bool PreSend(
+        const char*& buf,
+        size_t&      size
+        );
+
+    void OnSendDone(int res);
+
+    void Abort();
+
+private:
+
+    CProRingIo(
+        PRO_INT64 sockId,
+        bool      listener
+        );
+
+    virtual ~CProRingIo();
+
+private:
+
+    const PRO_INT64                   m_sockId;
+    const bool                        m_listener;
+    PRO_INT64                         m_fd;          /* a dup of m_sockId after the handler left */
+    bool                              m_registered;
+    bool                              m_inputArmed;
+    bool                              m_eof;
+    int                               m_errorCode;
+    CProStlDeque<PRO_INT64>           m_fds;
+    CProStlDeque<PRO_RING_SEGMENT>    m_segments;
+    size_t                            m_recvSize;
+    CProStlVector<unsigned short>     m_freeBids;    /* consumed provided buffers */
+    CProStlString                     m_stage;
+    CProStlString                     m_flight;
+    size_t                            m_flightSent;
+    bool                              m_sending;
+    mutable CProThreadMutex           m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* PRO_RING_IO_H */
@@ -28,11 +28,6 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-static char g_s_buffer[1024];
-
-/////////////////////////////////////////////////////////////////////////////
-////
-
 static
 inline
 bool
@@ -348,6 +343,8 @@ CProSelectReactor::WorkerRun()
         m_threadId = ProGetThreadId();
     }
 
+    CProStlVector<CProEventHandler*> retired;
+
     while (1)
     {
         PRO_INT64 maxSockId = -1;
@@ -355,6 +352,9 @@ CProSelectReactor::WorkerRun()
         {
             CProThreadMutexGuard mon(m_lock);
 
+            m_handlerMgr.LeaveEpoch(retired); /* the upcalls of the last loop are over */
+            FlushStats();
+
             if (m_wantExit)
             {
                 break;
@@ -366,6 +366,8 @@ CProSelectReactor::WorkerRun()
             m_fdsEx[1] = m_fdsEx[0];
         }
 
+        CProHandlerMgr::ReleaseRetired(retired);
+
         /*
          * select(...)
          */
@@ -395,16 +397,9 @@ CProSelectReactor::WorkerRun()
                     break;
                 }
 
-                allHandlers = m_handlerMgr.GetAllHandlers();
-
-                CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator       itr = allHandlers.begin();
-                CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator const end = allHandlers.end();
+                m_handlerMgr.EnterEpoch();
 
-                for (; itr != end; ++itr)
-                {
-                    const PRO_HANDLER_INFO& info = itr->second;
-                    info.handler->AddRef();
-                }
+                allHandlers = m_handlerMgr.GetAllHandlers();
             }
 
             CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator       itr = allHandlers.begin();
@@ -425,13 +420,11 @@ CProSelectReactor::WorkerRun()
                 retc = pbsd_select(sockId + 1, &m_fdsRd[1], NULL, NULL, &tv);
                 if (retc >= 0)
                 {
-                    info.handler->Release();
                     continue;
                 }
 
                 if (pbsd_errno((void*)&pbsd_select) != PBSD_EBADF)
                 {
-                    info.handler->Release();
                     continue;
                 }
 
@@ -439,7 +432,6 @@ CProSelectReactor::WorkerRun()
                  * This descriptor is not a socket.
                  */
                 info.handler->OnError(sockId, PBSD_EBADF);
-                info.handler->Release();
             } /* end of for (...) */
 
             /*
@@ -448,6 +440,8 @@ CProSelectReactor::WorkerRun()
             continue;
         }
 
+        const PRO_INT64 wakeUs = ProGetTickCount64Us();
+
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO> handlers;
 
         {
@@ -458,6 +452,8 @@ CProSelectReactor::WorkerRun()
                 break;
             }
 
+            m_handlerMgr.EnterEpoch();
+
 #if defined(_WIN32) || defined(_WIN32_WCE)
 
             for (int i = 0; i < (int)m_fdsWr[1].fd_count; ++i)
@@ -478,7 +474,6 @@ CProSelectReactor::WorkerRun()
 
                 if (info.handler != NULL)
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_WRITE);
@@ -503,7 +498,6 @@ CProSelectReactor::WorkerRun()
 
                 if (info.handler != NULL)
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_READ);
@@ -528,7 +522,6 @@ CProSelectReactor::WorkerRun()
 
                 if (info.handler != NULL)
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_EXCEPTION);
@@ -550,7 +543,6 @@ CProSelectReactor::WorkerRun()
 
                 if (PBSD_FD_ISSET(sockId, &m_fdsWr[1]))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_WRITE);
@@ -558,7 +550,6 @@ CProSelectReactor::WorkerRun()
 
                 if (PBSD_FD_ISSET(sockId, &m_fdsRd[1]))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_READ);
@@ -566,7 +557,6 @@ CProSelectReactor::WorkerRun()
 
                 if (PBSD_FD_ISSET(sockId, &m_fdsEx[1]))
                 {
-                    info.handler->AddRef();
                     PRO_HANDLER_INFO& info2 = handlers[sockId]; /* insert */
                     info2.handler = info.handler;
                     PRO_SET_BITS(info2.mask, PRO_MASK_EXCEPTION);
@@ -576,6 +566,8 @@ CProSelectReactor::WorkerRun()
 #endif /* _WIN32, _WIN32_WCE */
         }
 
+        PRO_INT64 upcallUs = ProGetTickCount64Us();
+
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator       itr = handlers.begin();
         CProStlMap<PRO_INT64, PRO_HANDLER_INFO>::iterator const end = handlers.end();
 
@@ -587,22 +579,26 @@ CProSelectReactor::WorkerRun()
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_WRITE))
             {
                 info.handler->OnOutput(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_READ))
             {
                 info.handler->OnInput(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
 
             if (PRO_BIT_ENABLED(info.mask, PRO_MASK_EXCEPTION))
             {
                 info.handler->OnException(sockId);
-                info.handler->Release();
+                AddUpcallStats(upcallUs);
             }
         } /* end of for (...) */
+
+        AddLoopStats(wakeUs, upcallUs, (unsigned long)retc);
     } /* end of while (...) */
+
+    CProHandlerMgr::ReleaseRetired(retired);
 }
 
 void
@@ -615,14 +611,10 @@ CProSelectReactor::OnInput(PRO_INT64 sockId)
         return;
     }
 
-    const int recvSize = pbsd_recv(sockId, g_s_buffer, sizeof(g_s_buffer), 0); /* connected */
-    if (
-        (recvSize > 0 && recvSize <= (int)sizeof(g_s_buffer))
-        ||
-        (recvSize < 0 && pbsd_errno((void*)&pbsd_recv) == PBSD_EWOULDBLOCK)
-       )
+    if (m_notifyPipe->Recv())
     {
         m_notifyPipe->EnableNotify();
+        ++m_delta.notifyCount;
     }
     else
     {
@@ -21,13 +21,17 @@
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
 #include "../pro_util/pro_z.h"
 
+#include "mbedtls/aes.h"
 #include "mbedtls/ctr_drbg.h"
 #include "mbedtls/entropy.h"
 #include "mbedtls/md.h"
 #include "mbedtls/net_sockets.h"
+#include "mbedtls/platform_util.h"
 #include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cookie.h"
 #include "mbedtls/threading.h"
 #include "mbedtls/x509_crt.h"
 
@@ -262,16 +266,20 @@ struct PRO_SSL_SERVER_CONFIG : public mbedtls_ssl_config
         mbedtls_entropy_init(&entropy);
         mbedtls_ctr_drbg_init(&rng);
         mbedtls_ssl_config_init(this);
+        mbedtls_ssl_cookie_init(&cookies);
 
         sha0Profile = mbedtls_x509_crt_profile_default;
         sha1Profile = mbedtls_x509_crt_profile_default;
         sha1Profile.allowed_mds |= MBEDTLS_X509_ID_FLAG(MBEDTLS_MD_SHA1);
+        leanBuffers = false;
+        ktls        = false;
 
         return (true);
     }
 
     void Fini()
     {
+        mbedtls_ssl_cookie_free(&cookies);
         pro_ssl_config_free(this);
 
         CProStlMap<CProStlString, PRO_SSL_AUTH_ITEM>::iterator       itr = sni2Auth.begin();
@@ -298,6 +306,9 @@ struct PRO_SSL_SERVER_CONFIG : public mbedtls_ssl_config
     PRO_SSL_ALPN_LIST                            alpns;
     mbedtls_x509_crt_profile                     sha0Profile;
     mbedtls_x509_crt_profile                     sha1Profile;
+    bool                                         leanBuffers;
+    bool                                         ktls;
+    mbedtls_ssl_cookie_ctx                       cookies; /* for dtls */
 
     DECLARE_SGI_POOL(0)
 };
@@ -333,6 +344,8 @@ struct PRO_SSL_CLIENT_CONFIG : public mbedtls_ssl_config
         sha0Profile = mbedtls_x509_crt_profile_default;
         sha1Profile = mbedtls_x509_crt_profile_default;
         sha1Profile.allowed_mds |= MBEDTLS_X509_ID_FLAG(MBEDTLS_MD_SHA1);
+        leanBuffers = false;
+        ktls        = false;
 
         return (true);
     }
@@ -354,6 +367,8 @@ struct PRO_SSL_CLIENT_CONFIG : public mbedtls_ssl_config
     PRO_SSL_ALPN_LIST        alpns;
     mbedtls_x509_crt_profile sha0Profile;
     mbedtls_x509_crt_profile sha1Profile;
+    bool                     leanBuffers;
+    bool                     ktls;
 
     DECLARE_SGI_POOL(0)
 };
@@ -368,8 +383,22 @@ struct PRO_SSL_CTX : public mbedtls_ssl_context
     sockId(__sockId),
     hasNonce(__nonce != NULL)
     {
-        sentBytes = 0;
-        recvBytes = 0;
+        sentBytes   = 0;
+        recvBytes   = 0;
+        leanBuffers = false;
+        ktls        = false;
+        ktlsMask    = 0;
+        dtlsConf    = NULL;
+        dtlsTrans   = NULL;
+        dtlsBound   = false;
+        dtlsSent    = false;
+        dtlsInBuf   = NULL;
+        dtlsInSize  = 0;
+        timerStart  = 0;
+        timerIntMs  = 0;
+        timerFinMs  = 0;
+
+        memset(&dtlsPeer, 0, sizeof(pbsd_sockaddr_in));
 
         if (__nonce != NULL)
         {
@@ -386,6 +415,26 @@ struct PRO_SSL_CTX : public mbedtls_ssl_context
     PRO_NONCE        nonce;
     PRO_INT64        sentBytes;
     PRO_INT64        recvBytes;
+    bool             leanBuffers; /* release the record buffers while idle */
+    bool             ktls;        /* hand the record layer over to the kernel */
+    unsigned long    ktlsMask;    /* PRO_SSL_KTLS_TX | PRO_SSL_KTLS_RX */
+
+    /*
+     * [[[[ for dtls
+     */
+    mbedtls_ssl_config*  dtlsConf;   /* a datagram copy of the config */
+    IProTransport*       dtlsTrans;
+    pbsd_sockaddr_in     dtlsPeer;
+    bool                 dtlsBound;  /* the cookie of the peer is verified */
+    bool                 dtlsSent;   /* the last datagram left the transport */
+    const unsigned char* dtlsInBuf;  /* the datagram being fed to mbedtls */
+    size_t               dtlsInSize;
+    PRO_INT64            timerStart;
+    unsigned long        timerIntMs;
+    unsigned long        timerFinMs; /* 0 means cancelled */
+    /*
+     * ]]]]
+     */
 
     DECLARE_SGI_POOL(0)
 };
@@ -723,6 +772,201 @@ ProRecv_i(void*          ctx,
     }
 }
 
+/*
+ * a record goes out as one datagram. a busy socket is the same as a lost
+ * datagram, and the retransmission timer takes care of the handshake
+ */
+static
+int
+ProDtlsSend_i(void*                ctx,
+              const unsigned char* buf,
+              size_t               size)
+{
+    PRO_SSL_CTX* const ctx2 = (PRO_SSL_CTX*)ctx;
+    if (ctx2 == NULL || ctx2->dtlsTrans == NULL)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    if (buf == NULL || size == 0)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    const bool server = ctx2->dtlsConf->endpoint == MBEDTLS_SSL_IS_SERVER;
+
+    /*
+     * a datagram the transport can't take now is lost, as on the wire
+     */
+    ctx2->dtlsSent = ctx2->dtlsTrans->SendData(
+        buf, size, 0, server ? &ctx2->dtlsPeer : NULL);
+    ctx2->sentBytes += size;
+
+    return ((int)size);
+}
+
+static
+int
+ProDtlsRecv_i(void*          ctx,
+              unsigned char* buf,
+              size_t         size)
+{
+    PRO_SSL_CTX* const ctx2 = (PRO_SSL_CTX*)ctx;
+    if (ctx2 == NULL || ctx2->dtlsTrans == NULL)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    if (buf == NULL || size == 0)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    if (ctx2->dtlsInBuf == NULL)
+    {
+        return (MBEDTLS_ERR_SSL_WANT_READ);
+    }
+
+    /*
+     * a datagram is consumed as a whole, and a truncated one fails to
+     * authenticate
+     */
+    if (size > ctx2->dtlsInSize)
+    {
+        size = ctx2->dtlsInSize;
+    }
+
+    memcpy(buf, ctx2->dtlsInBuf, size);
+    ctx2->dtlsInBuf  = NULL;
+    ctx2->dtlsInSize = 0;
+    ctx2->recvBytes += size;
+
+    return ((int)size);
+}
+
+static
+void
+ProDtlsSetTimer_i(void*    ctx,
+                  uint32_t intMs,
+                  uint32_t finMs)
+{
+    PRO_SSL_CTX* const ctx2 = (PRO_SSL_CTX*)ctx;
+
+    ctx2->timerStart = ProGetTickCount64();
+    ctx2->timerIntMs = intMs;
+    ctx2->timerFinMs = finMs;
+}
+
+static
+int
+ProDtlsGetTimer_i(void* ctx)
+{
+    PRO_SSL_CTX* const ctx2 = (PRO_SSL_CTX*)ctx;
+    if (ctx2->timerFinMs == 0)
+    {
+        return (-1);
+    }
+
+    const PRO_INT64 elapsed = ProGetTickCount64() - ctx2->timerStart;
+    if (elapsed >= (PRO_INT64)ctx2->timerFinMs)
+    {
+        return (2);
+    }
+    if (elapsed >= (PRO_INT64)ctx2->timerIntMs)
+    {
+        return (1);
+    }
+
+    return (0);
+}
+
+static
+bool
+IsSameAddr_i(const pbsd_sockaddr_in& addr1,
+             const pbsd_sockaddr_in& addr2)
+{
+    return (
+        addr1.sin_addr.s_addr == addr2.sin_addr.s_addr &&
+        addr1.sin_port        == addr2.sin_port
+        );
+}
+
+#if defined(PRO_HAS_KTLS)
+
+/*
+ * the explicit nonce of AES-GCM is the record sequence number in mbedtls,
+ * and the kernel goes on counting from it
+ */
+static
+bool
+SetKtlsKey_i(PRO_INT64                       sockId,
+             const mbedtls_ssl_traffic_keys& keys,
+             bool                            tx)
+{
+    union
+    {
+        struct tls12_crypto_info_aes_gcm_128       gcm128;
+        struct tls12_crypto_info_aes_gcm_256       gcm256;
+#if defined(TLS_CIPHER_CHACHA20_POLY1305)
+        struct tls12_crypto_info_chacha20_poly1305 chacha;
+#endif
+    } info;
+
+    const unsigned char* const key  = tx ? keys.key_enc : keys.key_dec;
+    const unsigned char* const iv   = tx ? keys.iv_enc  : keys.iv_dec;
+    const unsigned char* const ctr  = tx ? keys.ctr_enc : keys.ctr_dec;
+    int                        size = 0;
+
+    memset(&info, 0, sizeof(info));
+
+    if (keys.cipher == MBEDTLS_CIPHER_AES_128_GCM &&
+        keys.keylen == TLS_CIPHER_AES_GCM_128_KEY_SIZE)
+    {
+        info.gcm128.info.version     = TLS_1_2_VERSION;
+        info.gcm128.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+        memcpy(info.gcm128.iv     , ctr, TLS_CIPHER_AES_GCM_128_IV_SIZE);
+        memcpy(info.gcm128.key    , key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+        memcpy(info.gcm128.salt   , iv , TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+        memcpy(info.gcm128.rec_seq, ctr, TLS_CIPHER_AES_GCM_128_REC_SEQ_SIZE);
+        size = sizeof(info.gcm128);
+    }
+    else if (keys.cipher == MBEDTLS_CIPHER_AES_256_GCM &&
+        keys.keylen == TLS_CIPHER_AES_GCM_256_KEY_SIZE)
+    {
+        info.gcm256.info.version     = TLS_1_2_VERSION;
+        info.gcm256.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+        memcpy(info.gcm256.iv     , ctr, TLS_CIPHER_AES_GCM_256_IV_SIZE);
+        memcpy(info.gcm256.key    , key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+        memcpy(info.gcm256.salt   , iv , TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+        memcpy(info.gcm256.rec_seq, ctr, TLS_CIPHER_AES_GCM_256_REC_SEQ_SIZE);
+        size = sizeof(info.gcm256);
+    }
+#if defined(TLS_CIPHER_CHACHA20_POLY1305)
+    else if (keys.cipher == MBEDTLS_CIPHER_CHACHA20_POLY1305 &&
+        keys.keylen == TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE)
+    {
+        info.chacha.info.version     = TLS_1_2_VERSION;
+        info.chacha.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+        memcpy(info.chacha.iv     , iv , TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+        memcpy(info.chacha.key    , key, TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE);
+        memcpy(info.chacha.rec_seq, ctr, TLS_CIPHER_CHACHA20_POLY1305_REC_SEQ_SIZE);
+        size = sizeof(info.chacha);
+    }
+#endif
+    else
+    {
+        return (false);
+    }
+
+    const int retc = pbsd_setsockopt(
+        sockId, SOL_TLS, tx ? TLS_TX : TLS_RX, &info, size);
+    mbedtls_platform_zeroize(&info, sizeof(info));
+
+    return (retc == 0);
+}
+
+#endif /* PRO_HAS_KTLS */
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -745,6 +989,47 @@ ProSslInit()
         );
 }
 
+/*
+ * AES-GCM goes first when the CPU has AES instructions, and ChaCha20-Poly1305
+ * goes first otherwise
+ */
+static
+void
+PushDefaultSuites_i(CProStlVector<int>& suites)
+{
+    const bool aesFirst = mbedtls_aes_has_accel() != 0;
+
+    if (aesFirst)
+    {
+        suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384);
+        suites.push_back(PRO_SSL_ECDHE_RSA_WITH_AES_256_GCM_SHA384);
+        suites.push_back(PRO_SSL_DHE_RSA_WITH_AES_256_GCM_SHA384);
+    }
+    suites.push_back(PRO_SSL_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
+    if (!aesFirst)
+    {
+        suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384);
+        suites.push_back(PRO_SSL_ECDHE_RSA_WITH_AES_256_GCM_SHA384);
+        suites.push_back(PRO_SSL_DHE_RSA_WITH_AES_256_GCM_SHA384);
+    }
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_CCM);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_AES_256_CCM);
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_256_GCM_SHA384);
+    suites.push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256);
+    suites.push_back(PRO_SSL_ECDHE_RSA_WITH_AES_128_GCM_SHA256);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_AES_128_GCM_SHA256);
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_CCM);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_AES_128_CCM);
+    suites.push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_128_GCM_SHA256);
+    suites.push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
+    suites.push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
+    suites.push_back(0);
+}
+
 PRO_NET_API
 PRO_SSL_SERVER_CONFIG*
 PRO_CALLTYPE
@@ -770,32 +1055,19 @@ ProSslServerConfig_Create()
 
     mbedtls_ssl_conf_rng(config, &ProRngs_i, config);
 
+    if (mbedtls_ssl_cookie_setup(&config->cookies, &ProRngs_i, config) != 0)
+    {
+        goto EXIT;
+    }
+
     if (mbedtls_ssl_config_defaults(config, MBEDTLS_SSL_IS_SERVER,
         MBEDTLS_SSL_TRANSPORT_STREAM, MBEDTLS_SSL_PRESET_DEFAULT) != 0)
     {
         goto EXIT;
     }
 
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_CCM);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_256_CCM);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_CCM);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_128_CCM);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(0);
+    PushDefaultSuites_i(*config->suites.suites);
+    mbedtls_ssl_conf_preference_order(config, MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_SERVER);
 
     mbedtls_ssl_conf_ciphersuites(config, &(*config->suites.suites)[0]);
 
@@ -1405,6 +1677,54 @@ ProSslServerConfig_SetSniAuthLevel(PRO_SSL_SERVER_CONFIG* config,
     return (true);
 }
 
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableLeanBuffers(PRO_SSL_SERVER_CONFIG* config,
+                                     bool                   enable)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return;
+    }
+
+    config->leanBuffers = enable;
+}
+
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableServerPreference(PRO_SSL_SERVER_CONFIG* config,
+                                          bool                   enable)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return;
+    }
+
+    mbedtls_ssl_conf_preference_order(config, enable
+        ? MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_SERVER
+        : MBEDTLS_SSL_SRV_CIPHERSUITE_ORDER_CLIENT);
+}
+
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslServerConfig_EnableKtls(PRO_SSL_SERVER_CONFIG* config,
+                              bool                   enable)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return;
+    }
+
+    config->ktls = enable;
+    mbedtls_ssl_conf_keep_traffic_keys(config, enable ? 1 : 0);
+}
+
 /*-------------------------------------------------------------------------*/
 
 PRO_NET_API
@@ -1438,26 +1758,7 @@ ProSslClientConfig_Create()
         goto EXIT;
     }
 
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CHACHA20_POLY1305_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_256_CCM);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_256_CCM);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_256_GCM_SHA384);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_AES_128_CCM);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_AES_128_CCM);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_ECDSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_ECDHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(PRO_SSL_DHE_RSA_WITH_CAMELLIA_128_GCM_SHA256);
-    config->suites.suites->push_back(0);
+    PushDefaultSuites_i(*config->suites.suites);
 
     mbedtls_ssl_conf_ciphersuites(config, &(*config->suites.suites)[0]);
 
@@ -1804,6 +2105,75 @@ ProSslClientConfig_SetAuthLevel(PRO_SSL_CLIENT_CONFIG* config,
     return (true);
 }
 
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslClientConfig_EnableLeanBuffers(PRO_SSL_CLIENT_CONFIG* config,
+                                     bool                   enable)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return;
+    }
+
+    config->leanBuffers = enable;
+}
+
+PRO_NET_API
+bool
+PRO_CALLTYPE
+ProSslClientConfig_SetMaxFragLen(PRO_SSL_CLIENT_CONFIG* config,
+                                 size_t                 fragLen)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return (false);
+    }
+
+    unsigned char mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+
+    switch (fragLen)
+    {
+    case 0:
+        mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_NONE;
+        break;
+    case 512:
+        mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_512;
+        break;
+    case 1024:
+        mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_1024;
+        break;
+    case 2048:
+        mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_2048;
+        break;
+    case 4096:
+        mflCode = MBEDTLS_SSL_MAX_FRAG_LEN_4096;
+        break;
+    default:
+        return (false);
+    }
+
+    return (mbedtls_ssl_conf_max_frag_len(config, mflCode) == 0);
+}
+
+PRO_NET_API
+void
+PRO_CALLTYPE
+ProSslClientConfig_EnableKtls(PRO_SSL_CLIENT_CONFIG* config,
+                              bool                   enable)
+{
+    assert(config != NULL);
+    if (config == NULL)
+    {
+        return;
+    }
+
+    config->ktls = enable;
+    mbedtls_ssl_conf_keep_traffic_keys(config, enable ? 1 : 0);
+}
+
 /*-------------------------------------------------------------------------*/
 
 PRO_NET_API
@@ -1821,6 +2191,8 @@ ProSslCtx_Creates(const PRO_SSL_SERVER_CONFIG* config,
     }
 
     PRO_SSL_CTX* const ctx = new PRO_SSL_CTX(sockId, nonce);
+    ctx->leanBuffers = config->leanBuffers;
+    ctx->ktls        = config->ktls;
     mbedtls_ssl_init(ctx);
 
     if (mbedtls_ssl_setup(ctx, config) != 0)
@@ -1857,6 +2229,8 @@ ProSslCtx_Createc(const PRO_SSL_CLIENT_CONFIG* config,
     }
 
     PRO_SSL_CTX* const ctx = new PRO_SSL_CTX(sockId, nonce);
+    ctx->leanBuffers = config->leanBuffers;
+    ctx->ktls        = config->ktls;
     mbedtls_ssl_init(ctx);
 
     if (mbedtls_ssl_setup(ctx, config) != 0)
@@ -1891,6 +2265,7 @@ ProSslCtx_Delete(PRO_SSL_CTX* ctx)
     }
 
     pro_ssl_free(ctx);
+    ProFree(ctx->dtlsConf); /* the copy owns nothing */
     delete ctx;
 }
 
@@ -1933,6 +2308,440 @@ ProSslCtx_GetAlpn(PRO_SSL_CTX* ctx)
     return (mbedtls_ssl_get_alpn_protocol(ctx));
 }
 
+PRO_NET_API
+size_t
+PRO_CALLTYPE
+ProSslCtx_ReleaseBuffers(PRO_SSL_CTX* ctx)
+{
+    assert(ctx != NULL);
+    if (ctx == NULL || !ctx->leanBuffers)
+    {
+        return (0);
+    }
+
+    const size_t oldSize = mbedtls_ssl_get_buffer_size(ctx);
+    if (oldSize == 0 || mbedtls_ssl_release_buffers(ctx) != 0)
+    {
+        return (0);
+    }
+
+    return (oldSize - mbedtls_ssl_get_buffer_size(ctx));
+}
+
+PRO_NET_API
+size_t
+PRO_CALLTYPE
+ProSslCtx_GetBufferSize(PRO_SSL_CTX* ctx)
+{
+    assert(ctx != NULL);
+    if (ctx == NULL)
+    {
+        return (0);
+    }
+
+    return (mbedtls_ssl_get_buffer_size(ctx));
+}
+
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProSslCtx_EnableKtls(PRO_SSL_CTX* ctx)
+{
+    assert(ctx != NULL);
+    if (ctx == NULL)
+    {
+        return (0);
+    }
+
+#if defined(PRO_HAS_KTLS)
+
+    if (!ctx->ktls || ctx->ktlsMask != 0)
+    {
+        return (ctx->ktlsMask);
+    }
+
+    /*
+     * the kernel knows nothing about the nonce scrambling
+     */
+    if (ctx->hasNonce &&
+        (ctx->sentBytes < MAGIC_BYTES || ctx->recvBytes < MAGIC_BYTES))
+    {
+        return (0);
+    }
+
+    mbedtls_ssl_traffic_keys keys;
+    if (mbedtls_ssl_export_traffic_keys(ctx, &keys) != 0)
+    {
+        return (0);
+    }
+
+    unsigned long mask = 0;
+
+    /*
+     * fails with ENOENT if the tls module is not loaded. the socket is
+     * untouched until a key is set, so mbedtls goes on as before
+     */
+    if (pbsd_setsockopt(
+        ctx->sockId, IPPROTO_TCP, TCP_ULP, "tls", sizeof("tls")) == 0)
+    {
+        if (SetKtlsKey_i(ctx->sockId, keys, true))
+        {
+            mask |= PRO_SSL_KTLS_TX;
+
+            /*
+             * a kernel without the receive side leaves it to mbedtls
+             */
+            if (SetKtlsKey_i(ctx->sockId, keys, false))
+            {
+                mask |= PRO_SSL_KTLS_RX;
+            }
+        }
+    }
+
+    mbedtls_platform_zeroize(&keys, sizeof(mbedtls_ssl_traffic_keys));
+
+    ctx->ktlsMask = mask;
+    if (mask == (PRO_SSL_KTLS_TX | PRO_SSL_KTLS_RX))
+    {
+        mbedtls_ssl_release_buffers(ctx); /* no more records pass through */
+    }
+
+    return (mask);
+
+#else  /* PRO_HAS_KTLS */
+
+    return (0);
+
+#endif /* PRO_HAS_KTLS */
+}
+
+PRO_NET_API
+unsigned long
+PRO_CALLTYPE
+ProSslCtx_GetKtls(PRO_SSL_CTX* ctx)
+{
+    assert(ctx != NULL);
+    if (ctx == NULL)
+    {
+        return (0);
+    }
+
+    return (ctx->ktlsMask);
+}
+
+/*-------------------------------------------------------------------------*/
+
+static
+PRO_SSL_CTX*
+CreateDtlsCtx_i(const mbedtls_ssl_config* config,
+                mbedtls_ssl_cookie_ctx*   cookies,        /* for server */
+                const char*               serverHostName, /* for client */
+                IProTransport*            trans)
+{
+    mbedtls_ssl_config* const conf =
+        (mbedtls_ssl_config*)ProMalloc(sizeof(mbedtls_ssl_config));
+    if (conf == NULL)
+    {
+        return (NULL);
+    }
+
+    /*
+     * the copy shares the certificates, suites and rng with the original
+     */
+    *conf = *config;
+    mbedtls_ssl_conf_transport(conf, MBEDTLS_SSL_TRANSPORT_DATAGRAM);
+    if (conf->min_minor_ver < MBEDTLS_SSL_MINOR_VERSION_2)
+    {
+        conf->min_minor_ver = MBEDTLS_SSL_MINOR_VERSION_2; /* DTLS 1.0 */
+    }
+    if (cookies != NULL)
+    {
+        mbedtls_ssl_conf_dtls_cookies(conf,
+            &mbedtls_ssl_cookie_write, &mbedtls_ssl_cookie_check, cookies);
+    }
+
+    PRO_SSL_CTX* const ctx = new PRO_SSL_CTX(trans->GetSockId(), NULL);
+    ctx->dtlsConf  = conf;
+    ctx->dtlsTrans = trans;
+    mbedtls_ssl_init(ctx);
+
+    if (mbedtls_ssl_setup(ctx, conf) != 0)
+    {
+        ProSslCtx_Delete(ctx);
+
+        return (NULL);
+    }
+
+    if (cookies == NULL && mbedtls_ssl_set_hostname(ctx, serverHostName) != 0)
+    {
+        ProSslCtx_Delete(ctx);
+
+        return (NULL);
+    }
+
+    mbedtls_ssl_set_bio(ctx, ctx, &ProDtlsSend_i, &ProDtlsRecv_i, NULL);
+    mbedtls_ssl_set_timer_cb(ctx, ctx, &ProDtlsSetTimer_i, &ProDtlsGetTimer_i);
+
+    return (ctx);
+}
+
+PRO_NET_API
+PRO_SSL_CTX*
+PRO_CALLTYPE
+ProSslCtx_CreateDtlss(const PRO_SSL_SERVER_CONFIG* config,
+                      IProTransport*               trans)
+{
+    assert(config != NULL);
+    assert(trans != NULL);
+    if (config == NULL || trans == NULL)
+    {
+        return (NULL);
+    }
+
+    return (CreateDtlsCtx_i(config,
+        (mbedtls_ssl_cookie_ctx*)&config->cookies, NULL, trans));
+}
+
+PRO_NET_API
+PRO_SSL_CTX*
+PRO_CALLTYPE
+ProSslCtx_CreateDtlsc(const PRO_SSL_CLIENT_CONFIG* config,
+                      const char*                  serverHostName, /* = NULL */
+                      IProTransport*               trans)
+{
+    assert(config != NULL);
+    assert(trans != NULL);
+    if (config == NULL || trans == NULL)
+    {
+        return (NULL);
+    }
+
+    if (serverHostName != NULL && serverHostName[0] == '\0')
+    {
+        serverHostName = NULL;
+    }
+
+    return (CreateDtlsCtx_i(config, NULL, serverHostName, trans));
+}
+
+PRO_NET_API
+long
+PRO_CALLTYPE
+ProSslCtx_DtlsHandshake(PRO_SSL_CTX*            ctx,
+                        const void*             datagram,
+                        size_t                  size,
+                        const pbsd_sockaddr_in* remoteAddr)
+{
+    assert(ctx != NULL);
+    if (ctx == NULL || ctx->dtlsConf == NULL)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    if (ctx->state == MBEDTLS_SSL_HANDSHAKE_OVER)
+    {
+        return (1);
+    }
+
+    const bool server = ctx->dtlsConf->endpoint == MBEDTLS_SSL_IS_SERVER;
+
+    if (datagram != NULL && size > 0)
+    {
+        if (server)
+        {
+            if (remoteAddr == NULL)
+            {
+                return (0);
+            }
+
+            if (ctx->dtlsBound)
+            {
+                if (!IsSameAddr_i(*remoteAddr, ctx->dtlsPeer))
+                {
+                    return (0);
+                }
+            }
+            else
+            {
+                /*
+                 * the cookie is bound to the address of the sender
+                 */
+                unsigned char id[6];
+                memcpy(id, &remoteAddr->sin_addr.s_addr, 4);
+                memcpy(id + 4, &remoteAddr->sin_port, 2);
+
+                if (mbedtls_ssl_set_client_transport_id(ctx, id, sizeof(id)) != 0)
+                {
+                    return (MBEDTLS_ERR_SSL_ALLOC_FAILED);
+                }
+
+                ctx->dtlsPeer = *remoteAddr;
+            }
+        }
+
+        ctx->dtlsInBuf  = (const unsigned char*)datagram;
+        ctx->dtlsInSize = size;
+    }
+
+    const int ret = mbedtls_ssl_handshake(ctx);
+    ctx->dtlsInBuf  = NULL;
+    ctx->dtlsInSize = 0;
+
+    if (ret == 0)
+    {
+        ctx->dtlsBound = true;
+
+        return (1);
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        if (server && ctx->state > MBEDTLS_SSL_CLIENT_HELLO)
+        {
+            ctx->dtlsBound = true;
+        }
+
+        return (0);
+    }
+
+    /*
+     * before the cookie is verified, neither a HelloVerifyRequest nor a
+     * garbage datagram from anywhere may break the session
+     */
+    if (server && !ctx->dtlsBound)
+    {
+        mbedtls_ssl_session_reset(ctx);
+
+        return (0);
+    }
+
+    return (ret);
+}
+
+PRO_NET_API
+long
+PRO_CALLTYPE
+ProSslCtx_DtlsRecv(PRO_SSL_CTX*            ctx,
+                   const void*             datagram,
+                   size_t                  size,
+                   const pbsd_sockaddr_in* remoteAddr,
+                   void*                   buf,
+                   size_t                  bufSize)
+{
+    assert(ctx != NULL);
+    assert(buf != NULL);
+    assert(bufSize > 0);
+    if (ctx == NULL || ctx->dtlsConf == NULL || buf == NULL || bufSize == 0)
+    {
+        return (MBEDTLS_ERR_SSL_BAD_INPUT_DATA);
+    }
+
+    if (datagram != NULL && size > 0)
+    {
+        if (remoteAddr != NULL && ctx->dtlsBound &&
+            ctx->dtlsConf->endpoint == MBEDTLS_SSL_IS_SERVER &&
+            !IsSameAddr_i(*remoteAddr, ctx->dtlsPeer))
+        {
+            return (0);
+        }
+
+        ctx->dtlsInBuf  = (const unsigned char*)datagram;
+        ctx->dtlsInSize = size;
+    }
+
+    const int ret = mbedtls_ssl_read(ctx, (unsigned char*)buf, bufSize);
+    ctx->dtlsInBuf  = NULL;
+    ctx->dtlsInSize = 0;
+
+    if (ret >= 0)
+    {
+        return (ret);
+    }
+
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE)
+    {
+        return (0);
+    }
+
+    return (ret);
+}
+
+PRO_NET_API
+bool
+PRO_CALLTYPE
+ProSslCtx_DtlsSend(PRO_SSL_CTX* ctx,
+                   const void*  buf,
+                   size_t       size)
+{
+    assert(ctx != NULL);
+    assert(buf != NULL);
+    assert(size > 0);
+    if (ctx == NULL || ctx->dtlsConf == NULL || buf == NULL || size == 0)
+    {
+        return (false);
+    }
+
+    if (ctx->state != MBEDTLS_SSL_HANDSHAKE_OVER)
+    {
+        return (false);
+    }
+
+    ctx->dtlsSent = false;
+
+    const int ret = mbedtls_ssl_write(ctx, (const unsigned char*)buf, size);
+
+    return (ret == (int)size && ctx->dtlsSent);
+}
+
+static mbedtls_entropy_context  g_s_entropy;
+static mbedtls_ctr_drbg_context g_s_rng;
+static bool                     g_s_rngSeeded = false;
+static CProThreadMutex          g_s_rngLock;
+
+bool
+PRO_CALLTYPE
+ProSslRandom(void*  buf,
+             size_t size)
+{
+    assert(buf != NULL);
+    assert(size > 0);
+    if (buf == NULL || size == 0)
+    {
+        return (false);
+    }
+
+    ProSslInit();
+
+    int ret = 0;
+
+    {
+        CProThreadMutexGuard mon(g_s_rngLock);
+
+        if (!g_s_rngSeeded)
+        {
+            const char* const pers = "r";
+
+            mbedtls_entropy_init(&g_s_entropy);
+            mbedtls_ctr_drbg_init(&g_s_rng);
+
+            if (mbedtls_ctr_drbg_seed(&g_s_rng, &mbedtls_entropy_func,
+                &g_s_entropy, (unsigned char*)pers, strlen(pers)) != 0)
+            {
+                pro_ctr_drbg_free(&g_s_rng);
+                pro_entropy_free(&g_s_entropy);
+
+                return (false);
+            }
+
+            g_s_rngSeeded = true;
+        }
+
+        ret = mbedtls_ctr_drbg_random(&g_s_rng, (unsigned char*)buf, size);
+    }
+
+    return (ret == 0);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -18,11 +18,13 @@
 
 #include "pro_ssl_transport.h"
 #include "pro_net.h"
+#include "pro_recv_slab.h"
 #include "pro_tcp_transport.h"
 #include "pro_tp_reactor_task.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_z.h"
 
+#include "mbedtls/net_sockets.h"
 #include "mbedtls/ssl.h"
 
 #include <cassert>
@@ -30,6 +32,155 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#if defined(PRO_HAS_KTLS)
+
+/*
+ * the kernel hands out a record of another type through a control message,
+ * and stops at the record boundary
+ */
+static
+int
+KtlsRecv_i(PRO_INT64 sockId,
+           void*     buf,
+           size_t    size)
+{
+    char         control[CMSG_SPACE(sizeof(unsigned char))];
+    struct iovec iov;
+    pbsd_msghdr  msg;
+
+    memset(&msg, 0, sizeof(pbsd_msghdr));
+    iov.iov_base       = buf;
+    iov.iov_len        = size;
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    const int recvSize = pbsd_recvmsg(sockId, &msg, 0);
+    if (recvSize < 0)
+    {
+        if (pbsd_errno((void*)&pbsd_recvmsg) == PBSD_EWOULDBLOCK)
+        {
+            return (MBEDTLS_ERR_SSL_WANT_READ);
+        }
+        else
+        {
+            return (MBEDTLS_ERR_NET_RECV_FAILED);
+        }
+    }
+
+    const struct cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+    if (cmsg == NULL || cmsg->cmsg_level != SOL_TLS ||
+        cmsg->cmsg_type != TLS_GET_RECORD_TYPE)
+    {
+        return (recvSize);
+    }
+
+    const unsigned char recordType = *(const unsigned char*)CMSG_DATA(cmsg);
+    if (recordType == MBEDTLS_SSL_MSG_APPLICATION_DATA)
+    {
+        return (recvSize);
+    }
+
+    if (recordType != MBEDTLS_SSL_MSG_ALERT)
+    {
+        return (MBEDTLS_ERR_SSL_UNEXPECTED_MESSAGE); /* e.g. renegotiation */
+    }
+
+    if (recvSize >= 2 &&
+        ((unsigned char*)buf)[1] == MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY)
+    {
+        return (MBEDTLS_ERR_SSL_PEER_CLOSE_NOTIFY);
+    }
+    else
+    {
+        return (MBEDTLS_ERR_SSL_FATAL_ALERT_MESSAGE);
+    }
+}
+
+static
+int
+KtlsSend_i(PRO_INT64   sockId,
+           const void* buf,
+           size_t      size)
+{
+    const int sentSize = pbsd_send(sockId, buf, (int)size, 0);
+    if (sentSize >= 0)
+    {
+        return (sentSize);
+    }
+
+    if (pbsd_errno((void*)&pbsd_send) == PBSD_EWOULDBLOCK)
+    {
+        return (MBEDTLS_ERR_SSL_WANT_WRITE);
+    }
+    else
+    {
+        return (MBEDTLS_ERR_NET_SEND_FAILED);
+    }
+}
+
+static
+void
+KtlsCloseNotify_i(PRO_INT64 sockId)
+{
+    unsigned char alert[2];
+    char          control[CMSG_SPACE(sizeof(unsigned char))];
+    struct iovec  iov;
+    pbsd_msghdr   msg;
+
+    alert[0] = MBEDTLS_SSL_ALERT_LEVEL_WARNING;
+    alert[1] = MBEDTLS_SSL_ALERT_MSG_CLOSE_NOTIFY;
+
+    memset(control, 0, sizeof(control));
+    memset(&msg, 0, sizeof(pbsd_msghdr));
+    iov.iov_base       = alert;
+    iov.iov_len        = sizeof(alert);
+    msg.msg_iov        = &iov;
+    msg.msg_iovlen     = 1;
+    msg.msg_control    = control;
+    msg.msg_controllen = sizeof(control);
+
+    struct cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+    cmsg->cmsg_level = SOL_TLS;
+    cmsg->cmsg_type  = TLS_SET_RECORD_TYPE;
+    cmsg->cmsg_len   = CMSG_LEN(sizeof(unsigned char));
+    *(unsigned char*)CMSG_DATA(cmsg) = MBEDTLS_SSL_MSG_ALERT;
+
+    pbsd_sendmsg(sockId, &msg, 0);
+}
+
+#else  /* PRO_HAS_KTLS */
+
+static
+int
+KtlsRecv_i(PRO_INT64 sockId,
+           void*     buf,
+           size_t    size)
+{
+    return (MBEDTLS_ERR_SSL_INTERNAL_ERROR);
+}
+
+static
+int
+KtlsSend_i(PRO_INT64   sockId,
+           const void* buf,
+           size_t      size)
+{
+    return (MBEDTLS_ERR_SSL_INTERNAL_ERROR);
+}
+
+static
+void
+KtlsCloseNotify_i(PRO_INT64 sockId)
+{
+}
+
+#endif /* PRO_HAS_KTLS */
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CProSslTransport*
 CProSslTransport::CreateInstance(size_t recvPoolSize)   /* = 0 */
 {
@@ -43,6 +194,7 @@ CProSslTransport::CProSslTransport(size_t recvPoolSize) /* = 0 */
 {
     m_ctx     = NULL;
     m_suiteId = PRO_SSL_SUITE_NONE;
+    m_ktls    = 0;
 
     strcpy(m_suiteName, "NONE");
 }
@@ -160,11 +312,22 @@ CProSslTransport::Init(IProTransportObserver* observer,
             }
         }
 
-        if (!m_recvPool.Resize(m_recvPoolSize))
+        CProRecvSlab* const slab = reactorTask->GetRecvSlab();
+        const bool          ret  = m_recvPool.Resize(m_recvPoolSize, slab);
+        if (slab != NULL)
+        {
+            slab->Release();
+        }
+        if (!ret)
         {
             return (false);
         }
 
+        /*
+         * the kernel takes over from here, or mbedtls goes on
+         */
+        m_ktls = ProSslCtx_EnableKtls(ctx);
+
         if (suspendRecv)
         {
             if (!reactorTask->AddHandler(sockId, this, PRO_MASK_WRITE))
@@ -203,7 +366,14 @@ CProSslTransport::Fini()
 
         if (m_ctx != NULL && m_sockId != -1)
         {
-            mbedtls_ssl_close_notify((mbedtls_ssl_context*)m_ctx);
+            if (m_ktls & PRO_SSL_KTLS_TX)
+            {
+                KtlsCloseNotify_i(m_sockId);
+            }
+            else
+            {
+                mbedtls_ssl_close_notify((mbedtls_ssl_context*)m_ctx);
+            }
         }
 
         if (m_observer == NULL || m_reactorTask == NULL || m_ctx == NULL)
@@ -248,6 +418,31 @@ CProSslTransport::GetSslSuite(char suiteName[64]) const
     return (suiteId);
 }
 
+void
+PRO_CALLTYPE
+CProSslTransport::GetStats(PRO_TRANSPORT_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    CProTcpTransport::GetStats(stats);
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ctx != NULL)
+        {
+            stats->tlsBufBytes   = ProSslCtx_GetBufferSize(m_ctx);
+            stats->tlsMaxFragLen = mbedtls_ssl_get_max_frag_len(
+                (mbedtls_ssl_context*)m_ctx);
+            stats->tlsKtls       = m_ktls;
+        }
+    }
+}
+
 void
 PRO_CALLTYPE
 CProSslTransport::OnInput(PRO_INT64 sockId)
@@ -300,6 +495,8 @@ CProSslTransport::DoRecv(PRO_INT64 sockId)
                 return;
             }
 
+            m_recvPool.Expand(); /* lean mode. a partial message moves into a slab */
+
             const size_t idleSize = m_recvPool.ContinuousIdleSize();
             const size_t minSize  = (msgSize == 0 || msgSize > idleSize) ? idleSize : msgSize;
 
@@ -312,8 +509,16 @@ CProSslTransport::DoRecv(PRO_INT64 sockId)
                 goto EXIT;
             }
 
-            recvSize = mbedtls_ssl_read((mbedtls_ssl_context*)m_ctx,
-                (unsigned char*)m_recvPool.ContinuousIdleBuf(), minSize);
+            if (m_ktls & PRO_SSL_KTLS_RX)
+            {
+                recvSize = KtlsRecv_i(
+                    m_sockId, m_recvPool.ContinuousIdleBuf(), minSize);
+            }
+            else
+            {
+                recvSize = mbedtls_ssl_read((mbedtls_ssl_context*)m_ctx,
+                    (unsigned char*)m_recvPool.ContinuousIdleBuf(), minSize);
+            }
             assert(recvSize <= (int)minSize);
 
             if (recvSize > (int)minSize)
@@ -325,8 +530,11 @@ CProSslTransport::DoRecv(PRO_INT64 sockId)
             else if (recvSize > 0)
             {
                 m_recvPool.Fill(recvSize);
-                msgSize = mbedtls_ssl_get_bytes_avail( /* remaining message */
-                    (mbedtls_ssl_context*)m_ctx);
+                if ((m_ktls & PRO_SSL_KTLS_RX) == 0)
+                {
+                    msgSize = mbedtls_ssl_get_bytes_avail( /* remaining message */
+                        (mbedtls_ssl_context*)m_ctx);
+                }
             }
             else if (recvSize == 0)
             {
@@ -348,6 +556,11 @@ CProSslTransport::DoRecv(PRO_INT64 sockId)
                 sslCode   = recvSize;
             }
 
+            if (!error && msgSize == 0 && !m_pendingWr)
+            {
+                ReleaseBuffers(); /* idle until the next record */
+            }
+
             if (!error && !m_onWr && (regWr || m_pendingWr || m_requestOnSend))
             {
                 if (m_reactorTask->AddHandler(m_sockId, this, PRO_MASK_WRITE)) /* !!! */
@@ -377,7 +590,7 @@ EXIT:
             else if (recvSize > 0)
             {
                 observer->OnRecv(this, &m_remoteAddr);
-                assert(m_recvPool.ContinuousIdleSize() > 0);
+                assert(m_recvPool.ContinuousIdleSize() > 0 || m_recvPool.IsSmall());
             }
             else
             {
@@ -432,6 +645,7 @@ CProSslTransport::DoSend(PRO_INT64 sockId)
         if (theBuf == NULL || theSize == 0)
         {
             m_pendingWr = false;
+            ReleaseBuffers();
 
             if (!m_requestOnSend)
             {
@@ -447,8 +661,15 @@ CProSslTransport::DoSend(PRO_INT64 sockId)
         }
         else
         {
-            sentSize = mbedtls_ssl_write(
-                (mbedtls_ssl_context*)m_ctx, (unsigned char*)theBuf, theSize);
+            if (m_ktls & PRO_SSL_KTLS_TX)
+            {
+                sentSize = KtlsSend_i(m_sockId, theBuf, theSize);
+            }
+            else
+            {
+                sentSize = mbedtls_ssl_write((mbedtls_ssl_context*)m_ctx,
+                    (unsigned char*)theBuf, theSize);
+            }
             assert(sentSize <= (int)theSize);
 
             if (sentSize > (int)theSize)
@@ -537,3 +758,20 @@ CProSslTransport::DoSend(PRO_INT64 sockId)
         Fini();
     }
 }
+
+void
+CProSslTransport::ReleaseBuffers()
+{
+    if (m_ctx == NULL)
+    {
+        return;
+    }
+
+    /*
+     * only with a lean config. a buffer still in use is kept by mbedtls
+     */
+    if (ProSslCtx_ReleaseBuffers(m_ctx) > 0)
+    {
+        ++m_stats.tlsReleaseCount;
+    }
+}
@@ -50,6 +50,18 @@ public:
         char suiteName[64]
         ) const;
 
+    virtual void PRO_CALLTYPE GetStats(PRO_TRANSPORT_STATS* stats) const;
+
+    /*
+     * the records are encrypted from the send pool, so there is nothing
+     * to send in place. with kTLS, the kernel refuses MSG_ZEROCOPY on a
+     * tls socket, and copies the data anyway
+     */
+    virtual bool PRO_CALLTYPE EnableZeroCopy(size_t threshold)
+    {
+        return (false);
+    }
+
 private:
 
     CProSslTransport(size_t recvPoolSize); /* = 0 */
@@ -64,11 +76,14 @@ private:
 
     void DoSend(PRO_INT64 sockId);
 
+    void ReleaseBuffers();
+
 private:
 
     PRO_SSL_CTX*     m_ctx;
     PRO_SSL_SUITE_ID m_suiteId;
     char             m_suiteName[64];
+    unsigned long    m_ktls;          /* the directions handed over to the kernel */
 
     DECLARE_SGI_POOL(0)
 };
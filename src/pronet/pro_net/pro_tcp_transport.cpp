@@ -20,19 +20,27 @@
 #include "pro_event_handler.h"
 #include "pro_net.h"
 #include "pro_recv_pool.h"
+#include "pro_recv_slab.h"
+#include "pro_ring_io.h"
 #include "pro_send_pool.h"
 #include "pro_service_pipe.h"
 #include "pro_tp_reactor_task.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
 #include "../pro_util/pro_z.h"
 #include <cassert>
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-#define DEFAULT_RECV_POOL_SIZE (1024 * 65)
+#define DEFAULT_RECV_POOL_SIZE     (1024 * 65)
+#define DEFAULT_ZEROCOPY_THRESHOLD (1024 * 16)
+#define ZEROCOPY_REAP_INTERVAL     100
+#define ZEROCOPY_REAP_TIMEOUT      (1000 * 60)
 
 #if !defined(_WIN32) && !defined(_WIN32_WCE)
 
@@ -44,6 +52,304 @@ union PRO_CMSG_CTRL
 
 #endif /* _WIN32, _WIN32_WCE */
 
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+union PRO_ZEROCOPY_CTRL
+{
+    struct cmsghdr cmsg;
+    char           control[CMSG_SPACE(sizeof(struct sock_extended_err))];
+};
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+void
+PRO_CALLTYPE
+ReleaseHolders_i(const CProStlVector<IProRefObject*>& holders)
+{
+    int       i = 0;
+    const int c = (int)holders.size();
+
+    for (; i < c; ++i)
+    {
+        holders[i]->Release();
+    }
+}
+
+/*
+ * the notification ids wrap around, so they are compared by difference
+ */
+static
+inline
+void
+PRO_CALLTYPE
+AddZeroCopyDone_i(PRO_ZEROCOPY_SEND* zcSend,
+                  PRO_UINT32         lo,
+                  PRO_UINT32         hi,
+                  bool               copied)
+{
+    if (zcSend->idCount == 0)
+    {
+        return;
+    }
+
+    const PRO_UINT32 first = zcSend->firstId;
+    const PRO_UINT32 last  = zcSend->firstId + zcSend->idCount - 1;
+    const PRO_UINT32 begin = (PRO_INT32)(lo - first) > 0 ? lo : first;
+    const PRO_UINT32 end   = (PRO_INT32)(hi - last)  < 0 ? hi : last;
+
+    if ((PRO_INT32)(end - begin) < 0)
+    {
+        return;
+    }
+
+    zcSend->doneCount += end - begin + 1;
+    if (copied)
+    {
+        zcSend->copied = true;
+    }
+}
+
+/*
+ * moves the holders of the sends whose completions are all in to "holders"
+ */
+static
+void
+PRO_CALLTYPE
+TakeZeroCopyDone_i(CProStlDeque<PRO_ZEROCOPY_SEND*>& zcSends,
+                   PRO_TRANSPORT_STATS*              stats, /* = NULL */
+                   CProStlVector<IProRefObject*>&    holders)
+{
+    CProStlDeque<PRO_ZEROCOPY_SEND*>::iterator itr = zcSends.begin();
+
+    while (itr != zcSends.end())
+    {
+        PRO_ZEROCOPY_SEND* const zcSend = *itr;
+        if (zcSend->doneCount < zcSend->idCount)
+        {
+            ++itr;
+            continue;
+        }
+
+        if (stats != NULL && zcSend->idCount > 0)
+        {
+            ++stats->zcDoneCount;
+            if (zcSend->copied)
+            {
+                ++stats->zcCopiedCount;
+            }
+        }
+
+        holders.push_back(zcSend->holder);
+        delete zcSend;
+        itr = zcSends.erase(itr);
+    }
+}
+
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+/*
+ * reads a MSG_ZEROCOPY completion from the error queue of the socket.
+ * returns false if there is none
+ */
+static
+bool
+PRO_CALLTYPE
+RecvZeroCopyDone_i(PRO_INT64   sockId,
+                   PRO_UINT32& lo,
+                   PRO_UINT32& hi,
+                   bool&       copied)
+{
+    while (1)
+    {
+        PRO_ZEROCOPY_CTRL ctrl;
+
+        pbsd_msghdr msg;
+        memset(&msg, 0, sizeof(pbsd_msghdr));
+        msg.msg_control    = ctrl.control;
+        msg.msg_controllen = sizeof(ctrl.control);
+
+        if (pbsd_recvmsg_errqueue(sockId, &msg) < 0)
+        {
+            break;
+        }
+
+        const struct cmsghdr* const cmsg = CMSG_FIRSTHDR(&msg);
+        if (cmsg == NULL                    ||
+            cmsg->cmsg_level != SOL_IP      ||
+            cmsg->cmsg_type  != IP_RECVERR)
+        {
+            continue;
+        }
+
+        const struct sock_extended_err* const err =
+            (const struct sock_extended_err*)CMSG_DATA(cmsg);
+        if (err->ee_errno != 0 || err->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+        {
+            continue;
+        }
+
+        lo     = err->ee_info;
+        hi     = err->ee_data;
+        copied = (err->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) != 0;
+
+        return (true);
+    }
+
+    return (false);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * takes over the socket of a finished transport, while the kernel still
+ * sends from the pages of its MSG_ZEROCOPY sends. The holders are released
+ * as the completions come in, and the socket is closed after the last one.
+ * If they are not all in before the timeout, or the reactor stops first,
+ * the socket is reset. The kernel drops the pages then, and the remaining
+ * holders are released
+ */
+class CProZeroCopyReaper : public IProOnTimer, public CProRefCount
+{
+public:
+
+    /*
+     * takes "sockId" and the sends in "zcSends" on success
+     */
+    static bool Retire(
+        CProTpReactorTask*                reactorTask,
+        PRO_INT64                         sockId,
+        CProStlDeque<PRO_ZEROCOPY_SEND*>& zcSends
+        )
+    {
+        CProZeroCopyReaper* const reaper = new CProZeroCopyReaper;
+
+        {
+            CProThreadMutexGuard mon(reaper->m_lock);
+
+            reaper->m_reactorTask = reactorTask;
+            reaper->m_timerId     = reactorTask->ScheduleTimer(
+                reaper, ZEROCOPY_REAP_INTERVAL, true, 0);
+            if (reaper->m_timerId != 0)
+            {
+                reaper->m_sockId = sockId;
+                reaper->m_zcSends.swap(zcSends);
+            }
+        }
+
+        const bool ret = reaper->m_timerId != 0; /* held by the timer */
+        reaper->Release();
+
+        return (ret);
+    }
+
+    virtual unsigned long PRO_CALLTYPE AddRef()
+    {
+        const unsigned long refCount = CProRefCount::AddRef();
+
+        return (refCount);
+    }
+
+    virtual unsigned long PRO_CALLTYPE Release()
+    {
+        const unsigned long refCount = CProRefCount::Release();
+
+        return (refCount);
+    }
+
+private:
+
+    CProZeroCopyReaper()
+    {
+        m_reactorTask = NULL;
+        m_sockId      = -1;
+        m_timerId     = 0;
+        m_deadline    = ProGetTickCount64() + ZEROCOPY_REAP_TIMEOUT;
+    }
+
+    virtual ~CProZeroCopyReaper()
+    {
+        /*
+         * a reset drops what the kernel still has to send
+         */
+        ProCloseSockId(m_sockId, m_zcSends.size() == 0);
+        m_sockId = -1;
+
+        int       i = 0;
+        const int c = (int)m_zcSends.size();
+
+        for (; i < c; ++i)
+        {
+            m_zcSends[i]->holder->Release();
+            delete m_zcSends[i];
+        }
+
+        m_zcSends.clear();
+    }
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        )
+    {
+        CProStlVector<IProRefObject*> holders;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            if (timerId != m_timerId)
+            {
+                return;
+            }
+
+            PRO_UINT32 lo     = 0;
+            PRO_UINT32 hi     = 0;
+            bool       copied = false;
+
+            while (m_zcSends.size() > 0 &&
+                RecvZeroCopyDone_i(m_sockId, lo, hi, copied))
+            {
+                int       i = 0;
+                const int c = (int)m_zcSends.size();
+
+                for (; i < c; ++i)
+                {
+                    AddZeroCopyDone_i(m_zcSends[i], lo, hi, copied);
+                }
+            }
+
+            TakeZeroCopyDone_i(m_zcSends, NULL, holders);
+
+            if (m_zcSends.size() == 0 || ProGetTickCount64() >= m_deadline)
+            {
+                m_reactorTask->CancelTimer(m_timerId); /* to the destructor */
+                m_timerId = 0;
+            }
+        }
+
+        ReleaseHolders_i(holders);
+    }
+
+private:
+
+    CProTpReactorTask*               m_reactorTask;
+    PRO_INT64                        m_sockId;
+    PRO_UINT64                       m_timerId;
+    PRO_INT64                        m_deadline;
+    CProStlDeque<PRO_ZEROCOPY_SEND*> m_zcSends;
+    CProThreadMutex                  m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -75,11 +381,15 @@ m_recvPoolSize(recvPoolSize > 0 ? recvPoolSize : DEFAULT_RECV_POOL_SIZE)
     m_requestOnSend = false;
     m_sendingFd     = -1;
     m_timerId       = 0;
+    m_zcThreshold   = 0;
+    m_zcNextId      = 0;
+    m_zcSend        = NULL;
 
     m_canUpcall     = true;
 
     memset(&m_localAddr , 0, sizeof(pbsd_sockaddr_in));
     memset(&m_remoteAddr, 0, sizeof(pbsd_sockaddr_in));
+    memset(&m_stats     , 0, sizeof(PRO_TRANSPORT_STATS));
 }
 
 CProTcpTransport::~CProTcpTransport()
@@ -184,11 +494,27 @@ CProTcpTransport::Init(IProTransportObserver* observer,
             }
         }
 
-        if (!m_recvPool.Resize(m_recvPoolSize))
+        CProRecvSlab* const slab = reactorTask->GetRecvSlab();
+        const bool          ret  = m_recvPool.Resize(m_recvPoolSize, slab);
+        if (slab != NULL)
+        {
+            slab->Release();
+        }
+        if (!ret)
         {
             return (false);
         }
 
+        if (!m_recvFdMode)
+        {
+            EnableEdgeTrigger(); /* OnInputData() and OnOutput() report EWOULDBLOCK */
+
+            if (!unixSocket)
+            {
+                EnableRingIo(true); /* on an io_uring reactor */
+            }
+        }
+
         if (!suspendRecv &&
             !reactorTask->AddHandler(sockId, this, PRO_MASK_READ))
         {
@@ -207,7 +533,8 @@ CProTcpTransport::Init(IProTransportObserver* observer,
 void
 CProTcpTransport::Fini()
 {
-    IProTransportObserver* observer = NULL;
+    IProTransportObserver*        observer = NULL;
+    CProStlVector<IProRefObject*> holders;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -223,11 +550,49 @@ CProTcpTransport::Fini()
         m_reactorTask->RemoveHandler(
             m_sockId, this, PRO_MASK_WRITE | PRO_MASK_READ);
 
+        if (m_zcSend != NULL)
+        {
+            m_zcSends.push_back(m_zcSend);
+            m_zcSend = NULL;
+        }
+
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+        /*
+         * the kernel may still send from the pages of a holder, even after
+         * the socket is closed. A reaper keeps the socket and the holders
+         * until the completions are in. Without one, the socket is reset,
+         * so that the kernel drops the pages before the holders go
+         */
+        ReapZeroCopy(holders);
+        TakeZeroCopyDone_i(m_zcSends, &m_stats, holders);
+        if (m_zcSends.size() > 0)
+        {
+            if (!CProZeroCopyReaper::Retire(
+                m_reactorTask, m_sockId, m_zcSends))
+            {
+                ProCloseSockId(m_sockId, false);
+            }
+            m_sockId = -1;
+        }
+#endif
+
+        int       i = 0;
+        const int c = (int)m_zcSends.size();
+
+        for (; i < c; ++i)
+        {
+            holders.push_back(m_zcSends[i]->holder);
+            delete m_zcSends[i];
+        }
+
+        m_zcSends.clear();
+
         m_reactorTask = NULL;
         observer = m_observer;
         m_observer = NULL;
     }
 
+    ReleaseHolders_i(holders);
     observer->Release();
 }
 
@@ -349,6 +714,64 @@ CProTcpTransport::SendData(const void*             buf,
                            size_t                  size,
                            PRO_UINT64              actionId,   /* = 0 */
                            const pbsd_sockaddr_in* remoteAddr) /* = NULL */
+{
+    const bool ret = SendDataZeroCopy(buf, size, NULL, actionId);
+
+    return (ret);
+}
+
+bool
+PRO_CALLTYPE
+CProTcpTransport::EnableZeroCopy(size_t threshold)
+{
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactorTask == NULL)
+        {
+            return (false);
+        }
+
+        /*
+         * the completion mode of an io_uring reactor sends from its stage
+         */
+        if (GetRingIo() != NULL)
+        {
+            return (false);
+        }
+
+        EnableRingIo(false);
+
+        if (m_zcThreshold == 0)
+        {
+            int option = 1;
+            if (pbsd_setsockopt(m_sockId, SOL_SOCKET, SO_ZEROCOPY,
+                &option, sizeof(int)) != 0) /* unix sockets fail here */
+            {
+                return (false);
+            }
+        }
+
+        m_zcThreshold = threshold > 0 ? threshold : DEFAULT_ZEROCOPY_THRESHOLD;
+    }
+
+    return (true);
+
+#else  /* PRO_HAS_MSG_ZEROCOPY */
+
+    return (false);
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+}
+
+bool
+PRO_CALLTYPE
+CProTcpTransport::SendDataZeroCopy(const void*    buf,
+                                   size_t         size,
+                                   IProRefObject* holder,
+                                   PRO_UINT64     actionId) /* = 0 */
 {
     assert(buf != NULL);
     assert(size > 0);
@@ -380,13 +803,61 @@ CProTcpTransport::SendData(const void*             buf,
             m_onWr = true;
         }
 
-        m_sendPool.Fill(buf, size, actionId);
+        if (holder != NULL && m_zcThreshold > 0 && size >= m_zcThreshold)
+        {
+            PRO_ZEROCOPY_SEND* const zcSend = new PRO_ZEROCOPY_SEND;
+            zcSend->buf       = (const char*)buf;
+            zcSend->size      = size;
+            zcSend->sentSize  = 0;
+            zcSend->holder    = holder;
+            zcSend->actionId  = actionId;
+            zcSend->firstId   = m_zcNextId;
+            zcSend->idCount   = 0;
+            zcSend->doneCount = 0;
+            zcSend->copied    = false;
+
+            holder->AddRef();
+            m_zcSend = zcSend;
+
+            ++m_stats.zcSendCount;
+            m_stats.zcSendBytes += size;
+        }
+        else
+        {
+            m_sendPool.Fill(buf, size, actionId);
+
+            ++m_stats.copySendCount;
+            m_stats.copySendBytes += size;
+        }
+
         m_pendingWr = true;
     }
 
     return (true);
 }
 
+void
+PRO_CALLTYPE
+CProTcpTransport::GetStats(PRO_TRANSPORT_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        *stats = m_stats;
+        stats->zcPendingCount = m_zcSends.size();
+        if (m_zcSend != NULL)
+        {
+            ++stats->zcPendingCount;
+        }
+    }
+}
+
 bool
 CProTcpTransport::SendFd(const PRO_SERVICE_PACKET& s2cPacket)
 {
@@ -552,10 +1023,12 @@ CProTcpTransport::OnInputData(PRO_INT64 sockId)
         return;
     }
 
-    IProTransportObserver* observer  = NULL;
-    int                    recvSize  = 0;
-    int                    errorCode = 0;
-    const int              sslCode   = 0;
+    IProTransportObserver*        observer  = NULL;
+    CProRingIo*                   ringIo    = NULL;
+    int                           recvSize  = 0;
+    int                           errorCode = 0;
+    const int                     sslCode   = 0;
+    CProStlVector<IProRefObject*> holders;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -570,6 +1043,10 @@ CProTcpTransport::OnInputData(PRO_INT64 sockId)
             return;
         }
 
+        ReapZeroCopy(holders); /* the completions are reported as EPOLLERR */
+
+        m_recvPool.Expand(); /* lean mode. a partial message moves into a slab */
+
         const size_t idleSize = m_recvPool.ContinuousIdleSize();
 
         assert(idleSize > 0);
@@ -581,8 +1058,17 @@ CProTcpTransport::OnInputData(PRO_INT64 sockId)
             goto EXIT;
         }
 
-        recvSize = pbsd_recv(
-            m_sockId, m_recvPool.ContinuousIdleBuf(), (int)idleSize, 0);
+        ringIo = GetRingIo();
+        if (ringIo != NULL)
+        {
+            recvSize = ringIo->Recv(
+                m_recvPool.ContinuousIdleBuf(), idleSize, errorCode);
+        }
+        else
+        {
+            recvSize = pbsd_recv(
+                m_sockId, m_recvPool.ContinuousIdleBuf(), (int)idleSize, 0);
+        }
         assert(recvSize <= (int)idleSize);
 
         if (recvSize > (int)idleSize)
@@ -593,13 +1079,25 @@ CProTcpTransport::OnInputData(PRO_INT64 sockId)
         else if (recvSize > 0)
         {
             m_recvPool.Fill(recvSize);
+
+            if (recvSize < (int)idleSize) /* the socket buffer is drained */
+            {
+                SetWouldBlock(PRO_MASK_READ);
+            }
         }
         else if (recvSize == 0)
         {
         }
         else
         {
-            errorCode = pbsd_errno((void*)&pbsd_recv);
+            if (ringIo == NULL)
+            {
+                errorCode = pbsd_errno((void*)&pbsd_recv);
+            }
+            if (errorCode == PBSD_EWOULDBLOCK)
+            {
+                SetWouldBlock(PRO_MASK_READ);
+            }
         }
 
 EXIT:
@@ -608,12 +1106,14 @@ EXIT:
         observer = m_observer;
     }
 
+    ReleaseHolders_i(holders);
+
     if (m_canUpcall)
     {
         if (recvSize > 0)
         {
             observer->OnRecv(this, &m_remoteAddr);
-            assert(m_recvPool.ContinuousIdleSize() > 0);
+            assert(m_recvPool.ContinuousIdleSize() > 0 || m_recvPool.IsSmall());
         }
         else if (
             (recvSize < 0 && errorCode != PBSD_EWOULDBLOCK)
@@ -748,13 +1248,14 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
         return;
     }
 
-    IProTransportObserver* observer      = NULL;
-    int                    sentSize      = 0;
-    int                    errorCode     = 0;
-    const int              sslCode       = 0;
-    const CProBuffer*      onSendBuf     = NULL;
-    bool                   requestOnSend = false;
-    PRO_UINT64             actionId      = 0;
+    IProTransportObserver*        observer      = NULL;
+    int                           sentSize      = 0;
+    int                           errorCode     = 0;
+    const int                     sslCode       = 0;
+    bool                          onSent        = false;
+    bool                          requestOnSend = false;
+    PRO_UINT64                    actionId      = 0;
+    CProStlVector<IProRefObject*> holders;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -769,8 +1270,20 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
             return;
         }
 
-        unsigned long     theSize = 0;
-        const void* const theBuf  = m_sendPool.PreSend(theSize);
+        ReapZeroCopy(holders);
+
+        unsigned long theSize = 0;
+        const void*   theBuf  = NULL;
+
+        if (m_zcSend != NULL)
+        {
+            theSize = (unsigned long)(m_zcSend->size - m_zcSend->sentSize);
+            theBuf  = m_zcSend->buf + m_zcSend->sentSize;
+        }
+        else
+        {
+            theBuf  = m_sendPool.PreSend(theSize);
+        }
 
         if (theBuf == NULL || theSize == 0)
         {
@@ -785,12 +1298,26 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
                     m_onWr = false;
                 }
 
+                ReleaseHolders_i(holders);
+
                 return;
             }
         }
         else if (m_sendingFd == -1)
         {
-            sentSize = pbsd_send(m_sockId, theBuf, theSize, 0);
+            CProRingIo* const ringIo = GetRingIo();
+            if (m_zcSend != NULL)
+            {
+                sentSize = SendZeroCopy(theBuf, theSize);
+            }
+            else if (ringIo != NULL)
+            {
+                sentSize = ringIo->Send(theBuf, theSize, errorCode);
+            }
+            else
+            {
+                sentSize = pbsd_send(m_sockId, theBuf, theSize, 0);
+            }
             assert(sentSize <= (int)theSize);
 
             if (sentSize > (int)theSize)
@@ -800,23 +1327,61 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
             }
             else if (sentSize > 0)
             {
-                m_sendPool.Flush(sentSize);
+                if (sentSize < (int)theSize) /* the socket buffer is full */
+                {
+                    SetWouldBlock(PRO_MASK_WRITE);
+                }
 
-                onSendBuf = m_sendPool.OnSendBuf();
-                if (onSendBuf != NULL)
+                if (m_zcSend != NULL)
+                {
+                    m_zcSend->sentSize += sentSize;
+                    if (m_zcSend->sentSize == m_zcSend->size)
+                    {
+                        onSent   = true;
+                        actionId = m_zcSend->actionId;
+
+                        /*
+                         * the completions may all be in already, or the
+                         * chunks left were copied after ENOBUFS
+                         */
+                        m_zcSends.push_back(m_zcSend);
+                        TakeZeroCopyDone_i(m_zcSends, &m_stats, holders);
+
+                        m_zcSend    = NULL;
+                        m_pendingWr = false;
+                    }
+                }
+                else
                 {
-                    m_sendPool.PostSend();
-                    m_pendingWr = false;
+                    m_sendPool.Flush(sentSize);
+
+                    const CProBuffer* const onSendBuf = m_sendPool.OnSendBuf();
+                    if (onSendBuf != NULL)
+                    {
+                        onSent   = true;
+                        actionId = onSendBuf->GetMagic();
+
+                        m_sendPool.PostSend();
+                        m_pendingWr = false;
+                    }
                 }
             }
             else if (sentSize == 0)
             {
                 sentSize  = -1;
                 errorCode = PBSD_EWOULDBLOCK;
+                SetWouldBlock(PRO_MASK_WRITE);
             }
             else
             {
-                errorCode = pbsd_errno((void*)&pbsd_send);
+                if (ringIo == NULL)
+                {
+                    errorCode = pbsd_errno((void*)&pbsd_send);
+                }
+                if (errorCode == PBSD_EWOULDBLOCK)
+                {
+                    SetWouldBlock(PRO_MASK_WRITE);
+                }
             }
         }
         else
@@ -854,15 +1419,13 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
 
         requestOnSend = m_requestOnSend;
         m_requestOnSend = false;
-        if (onSendBuf != NULL)
-        {
-            actionId = onSendBuf->GetMagic();
-        }
 
         m_observer->AddRef();
         observer = m_observer;
     }
 
+    ReleaseHolders_i(holders);
+
     if (m_canUpcall)
     {
         if (sentSize < 0 && errorCode != PBSD_EWOULDBLOCK)
@@ -870,7 +1433,7 @@ CProTcpTransport::OnOutput(PRO_INT64 sockId)
             m_canUpcall = false;
             observer->OnClose(this, errorCode, sslCode);
         }
-        else if (onSendBuf != NULL || requestOnSend)
+        else if (onSent || requestOnSend)
         {
             observer->OnSend(this, actionId);
 
@@ -914,8 +1477,10 @@ CProTcpTransport::OnError(PRO_INT64 sockId,
         return;
     }
 
-    IProTransportObserver* observer = NULL;
-    const int              sslCode  = 0;
+    IProTransportObserver*        observer = NULL;
+    const int                     sslCode  = 0;
+    bool                          zcOnly   = false;
+    CProStlVector<IProRefObject*> holders;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -930,10 +1495,32 @@ CProTcpTransport::OnError(PRO_INT64 sockId,
             return;
         }
 
+        if (m_zcThreshold > 0)
+        {
+            ReapZeroCopy(holders);
+
+            int sockError = 0;
+            int optionLen = sizeof(int);
+            if (pbsd_getsockopt(m_sockId, SOL_SOCKET, SO_ERROR,
+                &sockError, &optionLen) == 0 && sockError == 0)
+            {
+                zcOnly = true; /* only the zero-copy completions */
+            }
+        }
+
         m_observer->AddRef();
         observer = m_observer;
     }
 
+    ReleaseHolders_i(holders);
+
+    if (zcOnly)
+    {
+        observer->Release();
+
+        return;
+    }
+
     if (m_canUpcall)
     {
         m_canUpcall = false;
@@ -986,3 +1573,87 @@ CProTcpTransport::OnTimer(void*      factory,
 
     observer->Release();
 }}
+
+int
+CProTcpTransport::SendZeroCopy(const void* buf,
+                               size_t      size)
+{
+    assert(m_zcSend != NULL);
+
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+    int sentSize = pbsd_send(m_sockId, buf, (int)size, MSG_ZEROCOPY);
+    if (sentSize > 0)
+    {
+        ++m_zcSend->idCount;
+        ++m_zcNextId;
+    }
+    else if (sentSize < 0 && pbsd_errno((void*)&pbsd_send) == ENOBUFS)
+    {
+        /*
+         * the pages pinned for the notifications exceed the socket's
+         * optmem limit. copy this chunk
+         */
+        sentSize = pbsd_send(m_sockId, buf, (int)size, 0);
+        if (sentSize > 0)
+        {
+            m_zcSend->copied = true;
+        }
+    }
+    else
+    {
+    }
+
+#else  /* PRO_HAS_MSG_ZEROCOPY */
+
+    const int sentSize = pbsd_send(m_sockId, buf, (int)size, 0);
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+
+    return (sentSize);
+}
+
+void
+CProTcpTransport::ReapZeroCopy(CProStlVector<IProRefObject*>& holders)
+{
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+    PRO_UINT32 lo     = 0;
+    PRO_UINT32 hi     = 0;
+    bool       copied = false;
+
+    while (m_zcSends.size() > 0 ||
+        (m_zcSend != NULL && m_zcSend->idCount > 0))
+    {
+        if (!RecvZeroCopyDone_i(m_sockId, lo, hi, copied))
+        {
+            break;
+        }
+
+        OnZeroCopyDone(lo, hi, copied, holders);
+    }
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+}
+
+void
+CProTcpTransport::OnZeroCopyDone(PRO_UINT32                     lo,
+                                 PRO_UINT32                     hi,
+                                 bool                           copied,
+                                 CProStlVector<IProRefObject*>& holders)
+{
+    int       i = 0;
+    const int c = (int)m_zcSends.size();
+
+    for (; i < c; ++i)
+    {
+        AddZeroCopyDone_i(m_zcSends[i], lo, hi, copied);
+    }
+
+    if (m_zcSend != NULL)
+    {
+        AddZeroCopyDone_i(m_zcSend, lo, hi, copied);
+    }
+
+    TakeZeroCopyDone_i(m_zcSends, &m_stats, holders);
+}
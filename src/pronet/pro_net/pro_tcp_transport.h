@@ -25,6 +25,7 @@
 #include "pro_send_pool.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread_mutex.h"
 #include "../pro_util/pro_z.h"
 
@@ -34,6 +35,24 @@
 class  CProTpReactorTask;
 struct PRO_SERVICE_PACKET;
 
+/*
+ * a MSG_ZEROCOPY send, from SendDataZeroCopy() to the kernel's completion
+ */
+struct PRO_ZEROCOPY_SEND
+{
+    const char*    buf;
+    size_t         size;
+    size_t         sentSize;
+    IProRefObject* holder;
+    PRO_UINT64     actionId;
+    PRO_UINT32     firstId;   /* the notification id of the first chunk */
+    PRO_UINT32     idCount;   /* the chunks sent with MSG_ZEROCOPY */
+    PRO_UINT32     doneCount; /* the chunks completed by the kernel */
+    bool           copied;    /* the kernel or we fell back to copying */
+
+    DECLARE_SGI_POOL(0)
+};
+
 class IProTransportObserverEx : public IProTransportObserver
 {
 public:
@@ -124,6 +143,17 @@ public:
     {
     }
 
+    virtual bool PRO_CALLTYPE EnableZeroCopy(size_t threshold);
+
+    virtual bool PRO_CALLTYPE SendDataZeroCopy(
+        const void*    buf,
+        size_t         size,
+        IProRefObject* holder,
+        PRO_UINT64     actionId /* = 0 */
+        );
+
+    virtual void PRO_CALLTYPE GetStats(PRO_TRANSPORT_STATS* stats) const;
+
     bool SendFd(const PRO_SERVICE_PACKET& s2cPacket);
 
 protected:
@@ -154,26 +184,45 @@ protected:
 
     void OnInputFd(PRO_INT64 sockId);
 
+    int SendZeroCopy(
+        const void* buf,
+        size_t      size
+        );
+
+    void ReapZeroCopy(CProStlVector<IProRefObject*>& holders);
+
+    void OnZeroCopyDone(
+        PRO_UINT32                     lo,
+        PRO_UINT32                     hi,
+        bool                           copied,
+        CProStlVector<IProRefObject*>& holders
+        );
+
 protected:
 
-    const bool              m_recvFdMode;
-    const size_t            m_recvPoolSize;
-    IProTransportObserver*  m_observer;
-    CProTpReactorTask*      m_reactorTask;
-    PRO_INT64               m_sockId;
-    pbsd_sockaddr_in        m_localAddr;
-    pbsd_sockaddr_in        m_remoteAddr;
-    bool                    m_onWr;
-    bool                    m_pendingWr;
-    bool                    m_requestOnSend;
-    CProRecvPool            m_recvPool;
-    CProSendPool            m_sendPool;
-    PRO_INT64               m_sendingFd;
-    PRO_UINT64              m_timerId;
-    mutable CProThreadMutex m_lock;
-
-    bool                    m_canUpcall;
-    CProThreadMutex         m_lockUpcall;
+    const bool                       m_recvFdMode;
+    const size_t                     m_recvPoolSize;
+    IProTransportObserver*           m_observer;
+    CProTpReactorTask*               m_reactorTask;
+    PRO_INT64                        m_sockId;
+    pbsd_sockaddr_in                 m_localAddr;
+    pbsd_sockaddr_in                 m_remoteAddr;
+    bool                             m_onWr;
+    bool                             m_pendingWr;
+    bool                             m_requestOnSend;
+    CProRecvPool                     m_recvPool;
+    CProSendPool                     m_sendPool;
+    PRO_INT64                        m_sendingFd;
+    PRO_UINT64                       m_timerId;
+    size_t                           m_zcThreshold; /* 0: disabled */
+    PRO_UINT32                       m_zcNextId;
+    PRO_ZEROCOPY_SEND*               m_zcSend;      /* being sent to the kernel */
+    CProStlDeque<PRO_ZEROCOPY_SEND*> m_zcSends;     /* waiting for the completions */
+    PRO_TRANSPORT_STATS              m_stats;
+    mutable CProThreadMutex          m_lock;
+
+    bool                             m_canUpcall;
+    CProThreadMutex                  m_lockUpcall;
 
     DECLARE_SGI_POOL(0)
 };
@@ -20,9 +20,12 @@
 #include "pro_base_reactor.h"
 #include "pro_epoll_reactor.h"
 #include "pro_event_handler.h"
+#include "pro_io_uring_reactor.h"
 #include "pro_net.h"
+#include "pro_recv_slab.h"
 #include "pro_select_reactor.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stat.h"
 #include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread.h"
 #include "../pro_util/pro_thread_mutex.h"
@@ -34,6 +37,7 @@
 #endif
 
 #include <cassert>
+#include <cstring>
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -47,6 +51,38 @@ typedef CProSelectReactor CProReactorImpl;
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+static
+CProBaseReactor*
+PRO_CALLTYPE
+CreateReactor_i(PRO_REACTOR_BACKEND backend)
+{
+#if defined(PRO_HAS_IO_URING)
+    if (backend == PRO_RB_IO_URING)
+    {
+        CProBaseReactor* const reactor = new CProIoUringReactor;
+        if (reactor->Init())
+        {
+            return (reactor);
+        }
+
+        delete reactor; /* the kernel lacks it or forbids it. fall back */
+    }
+#endif
+
+    CProBaseReactor* const reactor = new CProReactorImpl;
+    if (!reactor->Init())
+    {
+        delete reactor;
+
+        return (NULL);
+    }
+
+    return (reactor);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CProTpReactorTask::CProTpReactorTask()
 {
     m_acceptReactor     = NULL;
@@ -55,16 +91,21 @@ CProTpReactorTask::CProTpReactorTask()
     m_ioThreadPriority  = 0;
     m_curThreadCount    = 0;
     m_wantExit          = false;
+    m_recvSlab          = CProRecvSlab::CreateInstance(0);
+    m_recvSlabCap       = 0;
 }
 
 CProTpReactorTask::~CProTpReactorTask()
 {
     Stop();
+
+    m_recvSlab->Release(); /* the lean pools alive keep their references */
 }
 
 bool
-CProTpReactorTask::Start(unsigned long ioThreadCount,
-                         long          ioThreadPriority) /* = 0, 1, 2 */
+CProTpReactorTask::Start(unsigned long       ioThreadCount,
+                         long                ioThreadPriority, /* = 0, 1, 2 */
+                         PRO_REACTOR_BACKEND backend)
 {{
     CProThreadMutexGuard mon(m_lockAtom);
 
@@ -102,18 +143,17 @@ CProTpReactorTask::Start(unsigned long ioThreadCount,
          * reactors
          */
         {
-            m_acceptReactor = new CProReactorImpl;
-            if (!m_acceptReactor->Init())
+            m_acceptReactor = CreateReactor_i(backend);
+            if (m_acceptReactor == NULL)
             {
                 goto EXIT;
             }
 
             for (int i = 0; i < (int)m_ioThreadCount; ++i)
             {
-                CProBaseReactor* const reactor = new CProReactorImpl;
-                if (!reactor->Init())
+                CProBaseReactor* const reactor = CreateReactor_i(backend);
+                if (reactor == NULL)
                 {
-                    delete reactor;
                     break;
                 }
 
@@ -354,7 +394,12 @@ CProTpReactorTask::RemoveHandler(PRO_INT64         sockId,
         {
             const unsigned long newMask = handler->GetMask();
 
-            if (!PRO_BIT_ENABLED(newMask, newMask & ~PRO_MASK_ACCEPT))
+            /*
+             * a handler in the completion mode keeps its reactor, which has
+             * its requests and data
+             */
+            if (!PRO_BIT_ENABLED(newMask, newMask & ~PRO_MASK_ACCEPT) &&
+                handler->GetRingIo() == NULL)
             {
                 handler->SetReactor(NULL);
             }
@@ -563,6 +608,75 @@ CProTpReactorTask::GetTraceInfo(char*  buf,
     }
 }
 
+unsigned long
+PRO_CALLTYPE
+CProTpReactorTask::GetStats(PRO_REACTOR_STATS* stats,
+                            unsigned long      count) const
+{
+    unsigned long filled = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_acceptThreadCount + m_ioThreadCount == 0                ||
+            m_curThreadCount != m_acceptThreadCount + m_ioThreadCount ||
+            m_wantExit)
+        {
+            return (0);
+        }
+
+        if (stats == NULL)
+        {
+            return (m_acceptThreadCount + m_ioThreadCount + 2); /* + timer threads */
+        }
+
+        if (filled < count)
+        {
+            PRO_REACTOR_STATS& theStats = stats[filled++];
+
+            m_acceptReactor->GetStats(theStats);
+            theStats.threadType = PRO_RTT_ACCEPT;
+        }
+
+        for (int i = 0; i < (int)m_ioThreadCount && filled < count; ++i)
+        {
+            PRO_REACTOR_STATS& theStats = stats[filled++];
+
+            m_ioReactors[i]->GetStats(theStats);
+            theStats.threadType = PRO_RTT_IO;
+        }
+
+        for (int j = 0; j < 2 && filled < count; ++j)
+        {
+            const CProTimerFactory& factory =
+                j == 0 ? m_timerFactory : m_mmTimerFactory;
+
+            PRO_TIMER_STATS timerStats;
+            factory.GetStats(timerStats);
+
+            PRO_REACTOR_STATS& theStats = stats[filled++];
+            memset(&theStats, 0, sizeof(PRO_REACTOR_STATS));
+
+            theStats.threadType    = j == 0 ? PRO_RTT_TIMER : PRO_RTT_MMTIMER;
+            theStats.timerCount    = factory.GetTimerCount();
+            theStats.loopCount     = timerStats.loopCount;
+            theStats.eventCount    = timerStats.upcallCount;
+            theStats.upcallCount   = timerStats.upcallCount;
+            theStats.upcallUs      = timerStats.upcallUs;
+            theStats.upcallMaxUs   = timerStats.upcallMaxUs;
+            theStats.timerLagUs    = timerStats.lagUs;
+            theStats.timerLagMaxUs = timerStats.lagMaxUs;
+
+            for (int k = 0; k < PRO_STAT_HISTOGRAM_SIZE; ++k)
+            {
+                theStats.histogram[k] = timerStats.lagHistogram[k];
+            }
+        }
+    }
+
+    return (filled);
+}
+
 void
 CProTpReactorTask::Svc()
 {
@@ -597,3 +711,64 @@ CProTpReactorTask::Svc()
         m_threadIds.erase(threadId);
     }
 }
+
+void
+PRO_CALLTYPE
+CProTpReactorTask::SetRecvSlabCap(unsigned long maxSlabCount)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_recvSlab->SetMaxSlabCount(maxSlabCount);
+    m_recvSlabCap = maxSlabCount;
+}
+
+void
+PRO_CALLTYPE
+CProTpReactorTask::GetRecvSlabStats(PRO_RECV_SLAB_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    m_recvSlab->GetStats(*stats);
+}
+
+CProRecvSlab*
+CProTpReactorTask::GetRecvSlab()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_recvSlabCap == 0)
+    {
+        return (NULL);
+    }
+
+    m_recvSlab->AddRef();
+
+    return (m_recvSlab);
+}
+
+CProBaseReactor*
+CProTpReactorTask::GetIoReactor(unsigned long index) const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_ioThreadCount == 0                                      ||
+        m_curThreadCount != m_acceptThreadCount + m_ioThreadCount ||
+        m_wantExit)
+    {
+        return (NULL);
+    }
+
+    return (m_ioReactors[index % m_ioReactors.size()]);
+}
+
+unsigned long
+CProTpReactorTask::GetIoThreadCount() const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    return (m_ioThreadCount);
+}
@@ -36,6 +36,7 @@
 
 class CProBaseReactor;
 class CProEventHandler;
+class CProRecvSlab;
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -49,8 +50,9 @@ public:
     virtual ~CProTpReactorTask();
 
     bool Start(
-        unsigned long ioThreadCount,
-        long          ioThreadPriority /* = 0, 1, 2 */
+        unsigned long       ioThreadCount,
+        long                ioThreadPriority, /* = 0, 1, 2 */
+        PRO_REACTOR_BACKEND backend
         );
 
     void Stop();
@@ -99,6 +101,31 @@ public:
         size_t size
         ) const;
 
+    virtual unsigned long PRO_CALLTYPE GetStats(
+        PRO_REACTOR_STATS* stats,
+        unsigned long      count
+        ) const;
+
+    virtual void PRO_CALLTYPE SetRecvSlabCap(unsigned long maxSlabCount);
+
+    virtual void PRO_CALLTYPE GetRecvSlabStats(
+        PRO_RECV_SLAB_STATS* stats
+        ) const;
+
+    /*
+     * returns the slab with a reference, or NULL if it's off
+     */
+    CProRecvSlab* GetRecvSlab();
+
+    /*
+     * returns the io reactor of the index (modulo the io thread count), or
+     * NULL if the task isn't running. A handler set to it by SetReactor()
+     * before AddHandler() is served by that io thread
+     */
+    CProBaseReactor* GetIoReactor(unsigned long index) const;
+
+    unsigned long GetIoThreadCount() const;
+
 private:
 
     void StopMe();
@@ -116,6 +143,8 @@ private:
     long                            m_ioThreadPriority;
     unsigned long                   m_curThreadCount;
     bool                            m_wantExit;
+    CProRecvSlab*                   m_recvSlab;
+    unsigned long                   m_recvSlabCap; /* 0: off */
     CProStlSet<PRO_UINT64>          m_threadIds;
     CProThreadMutexCondition        m_initCond;
     mutable CProThreadMutex         m_lock;
@@ -36,15 +36,18 @@
 ////
 
 CProUdpTransport*
-CProUdpTransport::CreateInstance(size_t recvPoolSize)   /* = 0 */
+CProUdpTransport::CreateInstance(size_t recvPoolSize, /* = 0 */
+                                 bool   shared)       /* = false */
 {
-    CProUdpTransport* const trans = new CProUdpTransport(recvPoolSize);
+    CProUdpTransport* const trans = new CProUdpTransport(recvPoolSize, shared);
 
     return (trans);
 }
 
-CProUdpTransport::CProUdpTransport(size_t recvPoolSize) /* = 0 */
-: m_recvPoolSize(recvPoolSize > 0 ? recvPoolSize : DEFAULT_RECV_POOL_SIZE)
+CProUdpTransport::CProUdpTransport(size_t recvPoolSize, /* = 0 */
+                                   bool   shared)       /* = false */
+: m_recvPoolSize(recvPoolSize > 0 ? recvPoolSize : DEFAULT_RECV_POOL_SIZE),
+  m_shared(shared)
 {
     m_observer         = NULL;
     m_reactorTask      = NULL;
@@ -79,7 +82,8 @@ CProUdpTransport::Init(IProTransportObserver* observer,
                        const char*            defaultRemoteIp,   /* = NULL */
                        unsigned short         defaultRemotePort, /* = 0 */
                        size_t                 sockBufSizeRecv,   /* = 0 */
-                       size_t                 sockBufSizeSend)   /* = 0 */
+                       size_t                 sockBufSizeSend,   /* = 0 */
+                       bool                   reusePort)         /* = false */
 {
     assert(observer != NULL);
     assert(reactorTask != NULL);
@@ -143,6 +147,18 @@ CProUdpTransport::Init(IProTransportObserver* observer,
         option = (int)sockBufSizeSend;
         pbsd_setsockopt(sockId, SOL_SOCKET, SO_SNDBUF, &option, sizeof(int));
 
+        if (reusePort)
+        {
+#if defined(SO_REUSEPORT)
+            option = 1;
+            pbsd_setsockopt(sockId, SOL_SOCKET, SO_REUSEPORT, &option, sizeof(int));
+#else
+            ProCloseSockId(sockId);
+
+            return (false);
+#endif
+        }
+
         if (pbsd_bind(sockId, &localAddr, false) != 0)
         {
             ProCloseSockId(sockId);
@@ -157,6 +173,11 @@ CProUdpTransport::Init(IProTransportObserver* observer,
             return (false);
         }
 
+        if (m_shared)
+        {
+            EnableEdgeTrigger(); /* OnInput() reports EWOULDBLOCK */
+        }
+
         if (!reactorTask->AddHandler(sockId, this, PRO_MASK_READ))
         {
             ProCloseSockId(sockId);
@@ -343,6 +364,18 @@ CProUdpTransport::SendData(const void*             buf,
             return (false);
         }
 
+        if (m_shared)
+        {
+            /*
+             * no OnSend() for each datagram. The peers take turns by
+             * RequestOnSend() when the socket is full
+             */
+            const int sentSize = pbsd_sendto(
+                m_sockId, buf, (int)size, 0, realAddr);
+
+            return (sentSize == (int)size);
+        }
+
         if (m_pendingWr || m_connRefused)
         {
             return (false);
@@ -494,6 +527,11 @@ CProUdpTransport::UdpConnResetAsError(const pbsd_sockaddr_in* remoteAddr)
             return;
         }
 
+        if (m_shared)
+        {
+            return; /* not for a single peer */
+        }
+
         m_connResetAsError = true;
 
 #if defined(_WIN32) || defined(_WIN32_WCE)
@@ -507,6 +545,19 @@ CProUdpTransport::UdpConnResetAsError(const pbsd_sockaddr_in* remoteAddr)
     }
 }
 
+void
+PRO_CALLTYPE
+CProUdpTransport::GetStats(PRO_TRANSPORT_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(PRO_TRANSPORT_STATS)); /* no send pool */
+}
+
 void
 PRO_CALLTYPE
 CProUdpTransport::OnInput(PRO_INT64 sockId)
@@ -567,6 +618,10 @@ CProUdpTransport::OnInput(PRO_INT64 sockId)
         else
         {
             errorCode = pbsd_errno((void*)&pbsd_recvfrom);
+            if (errorCode == PBSD_EWOULDBLOCK)
+            {
+                SetWouldBlock(PRO_MASK_READ);
+            }
         }
 
 EXIT:
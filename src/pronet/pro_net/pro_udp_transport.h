@@ -39,7 +39,10 @@ class CProUdpTransport : public IProTransport, public CProEventHandler
 {
 public:
 
-    static CProUdpTransport* CreateInstance(size_t recvPoolSize); /* = 0 */
+    static CProUdpTransport* CreateInstance(
+        size_t recvPoolSize, /* = 0 */
+        bool   shared        /* = false */
+        );
 
     bool Init(
         IProTransportObserver* observer,
@@ -49,7 +52,8 @@ public:
         const char*            defaultRemoteIp,   /* = NULL */
         unsigned short         defaultRemotePort, /* = 0 */
         size_t                 sockBufSizeRecv,   /* = 0 */
-        size_t                 sockBufSizeSend    /* = 0 */
+        size_t                 sockBufSizeSend,   /* = 0 */
+        bool                   reusePort          /* = false */
         );
 
     void Fini();
@@ -106,15 +110,36 @@ public:
         const pbsd_sockaddr_in* remoteAddr
         );
 
+    virtual bool PRO_CALLTYPE EnableZeroCopy(size_t threshold)
+    {
+        return (false);
+    }
+
+    virtual bool PRO_CALLTYPE SendDataZeroCopy(
+        const void*    buf,
+        size_t         size,
+        IProRefObject* holder,
+        PRO_UINT64     actionId /* = 0 */
+        )
+    {
+        return (SendData(buf, size, actionId, NULL));
+    }
+
+    virtual void PRO_CALLTYPE GetStats(PRO_TRANSPORT_STATS* stats) const;
+
 protected:
 
-    CProUdpTransport(size_t recvPoolSize); /* = 0 */
+    CProUdpTransport(
+        size_t recvPoolSize, /* = 0 */
+        bool   shared        /* = false */
+        );
 
     virtual ~CProUdpTransport();
 
 protected:
 
     const size_t            m_recvPoolSize;
+    const bool              m_shared; /* by many peers */
     IProTransportObserver*  m_observer;
     CProTpReactorTask*      m_reactorTask;
     PRO_INT64               m_sockId;
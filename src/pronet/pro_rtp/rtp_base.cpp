@@ -54,12 +54,17 @@ static CRtpPortAllocator*     g_s_tcpPortAllocator   = NULL;
 static volatile unsigned long g_s_keepaliveInSeconds = 60;
 static volatile unsigned long g_s_flowctrlInSeconds  = 1;
 static volatile unsigned long g_s_statInSeconds      = 5;
-static unsigned long          g_s_udpSockBufSizeRecv[256]; /* mmType0 ~ mmType255 */
-static unsigned long          g_s_udpSockBufSizeSend[256]; /* mmType0 ~ mmType255 */
-static unsigned long          g_s_udpRecvPoolSize[256];    /* mmType0 ~ mmType255 */
-static unsigned long          g_s_tcpSockBufSizeRecv[256]; /* mmType0 ~ mmType255 */
-static unsigned long          g_s_tcpSockBufSizeSend[256]; /* mmType0 ~ mmType255 */
-static unsigned long          g_s_tcpRecvPoolSize[256];    /* mmType0 ~ mmType255 */
+static unsigned long          g_s_udpSockBufSizeRecv[256];   /* mmType0 ~ mmType255 */
+static unsigned long          g_s_udpSockBufSizeSend[256];   /* mmType0 ~ mmType255 */
+static unsigned long          g_s_udpRecvPoolSize[256];      /* mmType0 ~ mmType255 */
+static unsigned long          g_s_tcpSockBufSizeRecv[256];   /* mmType0 ~ mmType255 */
+static unsigned long          g_s_tcpSockBufSizeSend[256];   /* mmType0 ~ mmType255 */
+static unsigned long          g_s_tcpRecvPoolSize[256];      /* mmType0 ~ mmType255 */
+static unsigned long          g_s_tcpZeroCopyThreshold[256]; /* mmType0 ~ mmType255 */
+static bool                   g_s_lockFreeBucket[256];       /* mmType0 ~ mmType255 */
+static unsigned short         g_s_udpSharedPort[256];        /* mmType0 ~ mmType255 */
+static unsigned long          g_s_udpSharedSockets[256];     /* mmType0 ~ mmType255 */
+static unsigned long          g_s_tcpResumeInSeconds[256];   /* mmType0 ~ mmType255 */
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -87,9 +92,17 @@ ProRtpInit()
         g_s_udpSockBufSizeSend[i] = 0;
         g_s_udpRecvPoolSize[i]    = 1024 * 65;
 
-        g_s_tcpSockBufSizeRecv[i] = 0;
-        g_s_tcpSockBufSizeSend[i] = 0;
-        g_s_tcpRecvPoolSize[i]    = 1024 * 65;
+        g_s_tcpSockBufSizeRecv[i]   = 0;
+        g_s_tcpSockBufSizeSend[i]   = 0;
+        g_s_tcpRecvPoolSize[i]      = 1024 * 65;
+        g_s_tcpZeroCopyThreshold[i] = 0;
+
+        g_s_lockFreeBucket[i] = false;
+
+        g_s_udpSharedPort[i]    = 0;
+        g_s_udpSharedSockets[i] = 1;
+
+        g_s_tcpResumeInSeconds[i] = 0;
     }
 
 #if !defined(_WIN32_WCE)
@@ -198,6 +211,18 @@ ParseRtpStreamToPacket(const void* streamBuffer,
     return (packet);
 }
 
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+ParseRtpStreams(const void* const streamBuffers[],
+                const PRO_UINT16  streamSizes[],
+                unsigned long     count,
+                RTP_STREAM_INFO   infos[])
+{
+    return (CRtpPacket::ParseRtpBuffers(
+        (const char* const*)streamBuffers, streamSizes, count, infos));
+}
+
 PRO_RTP_API
 const void*
 PRO_CALLTYPE
@@ -449,6 +474,155 @@ GetRtpTcpSocketParams(RTP_MM_TYPE    mmType,
     }
 }
 
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpTcpZeroCopyThreshold(RTP_MM_TYPE   mmType,
+                           unsigned long threshold) /* = 0 */
+{
+    g_s_tcpZeroCopyThreshold[mmType] = threshold;
+}
+
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+GetRtpTcpZeroCopyThreshold(RTP_MM_TYPE mmType)
+{
+    return (g_s_tcpZeroCopyThreshold[mmType]);
+}
+
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpLockFreeBucket(RTP_MM_TYPE mmType,
+                     bool        enable) /* = false */
+{
+    g_s_lockFreeBucket[mmType] = enable;
+}
+
+PRO_RTP_API
+bool
+PRO_CALLTYPE
+GetRtpLockFreeBucket(RTP_MM_TYPE mmType)
+{
+    return (g_s_lockFreeBucket[mmType]);
+}
+
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpUdpSharedPort(RTP_MM_TYPE    mmType,
+                    unsigned short sharedPort,  /* = 0 */
+                    unsigned long  socketCount) /* = 1 */
+{
+    if (socketCount == 0)
+    {
+        socketCount = 1;
+    }
+
+    g_s_udpSharedPort[mmType]    = sharedPort;
+    g_s_udpSharedSockets[mmType] = socketCount;
+}
+
+PRO_RTP_API
+unsigned short
+PRO_CALLTYPE
+GetRtpUdpSharedPort(RTP_MM_TYPE    mmType,
+                    unsigned long* socketCount) /* = NULL */
+{
+    if (socketCount != NULL)
+    {
+        *socketCount = g_s_udpSharedSockets[mmType];
+    }
+
+    return (g_s_udpSharedPort[mmType]);
+}
+
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpTcpResumeTimeout(RTP_MM_TYPE   mmType,
+                       unsigned long resumeInSeconds) /* = 0 */
+{
+    g_s_tcpResumeInSeconds[mmType] = resumeInSeconds;
+}
+
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+GetRtpTcpResumeTimeout(RTP_MM_TYPE mmType)
+{
+    return (g_s_tcpResumeInSeconds[mmType]);
+}
+
+bool
+PRO_CALLTYPE
+IsZeroRtpToken(const char token[16])
+{
+    int       i = 0;
+    const int c = 16;
+
+    for (; i < c; ++i)
+    {
+        if (token[i] != 0)
+        {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+bool
+PRO_CALLTYPE
+MakeRtpResumeToken(char token[16])
+{
+    do
+    {
+        if (!ProSslRandom(token, 16))
+        {
+            memset(token, 0, 16);
+
+            return (false);
+        }
+    }
+    while (IsZeroRtpToken(token)); /* zero means no token */
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CalcRtpResumeId(const char token[16],
+                char       resumeId[16])
+{
+    char hashValue[32];
+    ProSha256All(token, 16, hashValue);
+    memcpy(resumeId, hashValue, 16);
+}
+
+void
+PRO_CALLTYPE
+CalcRtpResumeMac(const char        token[16],
+                 char              role, /* 'c' or 's' */
+                 const PRO_NONCE&  nonce,
+                 const char        userData[64],
+                 RTP_MM_TYPE       mmType,
+                 RTP_EXT_PACK_MODE packMode,
+                 char              mac[16])
+{
+    char buf[1 + 32 + 64 + 2];
+    buf[0] = role;
+    memcpy(buf + 1     , nonce.nonce, 32);
+    memcpy(buf + 1 + 32, userData   , 64);
+    buf[1 + 32 + 64]     = (char)mmType;
+    buf[1 + 32 + 64 + 1] = (char)packMode;
+
+    char hashValue[32];
+    ProHmacSha256All(token, 16, buf, sizeof(buf), hashValue);
+    memcpy(mac, hashValue, 16);
+}
+
 PRO_RTP_API
 IRtpService*
 PRO_CALLTYPE
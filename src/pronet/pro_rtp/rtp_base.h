@@ -163,6 +163,8 @@ static const RTP_SESSION_TYPE RTP_ST_SSLCLIENT_EX =  9; /* ssl-
 static const RTP_SESSION_TYPE RTP_ST_SSLSERVER_EX = 10; /* ssl-չЭ */
 static const RTP_SESSION_TYPE RTP_ST_MCAST        = 11; /* mcast-׼rtpЭ */
 static const RTP_SESSION_TYPE RTP_ST_MCAST_EX     = 12; /* mcast-չЭ */
+static const RTP_SESSION_TYPE RTP_ST_DTLSCLIENT_EX = 13; /* dtls-չЭͻ */
+static const RTP_SESSION_TYPE RTP_ST_DTLSSERVER_EX = 14; /* dtls-չЭ */
 /*
  * ]]]]
  */
@@ -179,7 +181,9 @@ struct RTP_SESSION_INFO
     RTP_EXT_PACK_MODE packMode;         /* ģʽ=====<            >, for tcp_ex, ssl_ex */
     char              reserved1;
     char              passwordHash[32]; /* hashֵ===[c, s>, for tcp_ex, ssl_ex */
-    char              reserved2[40];
+    char              resumeId[16];     /* ָid===[            ], for tcp_ex */
+    char              resumeMac[16];    /* ָУֵ===[            ], for tcp_ex */
+    char              reserved2[8];
 
     PRO_UINT32        someId;           /* ĳid. 緿id, Ŀڵid, ϲ㶨 */
     PRO_UINT32        mmId;             /* ڵid */
@@ -194,12 +198,29 @@ struct RTP_SESSION_INFO
  */
 struct RTP_SESSION_ACK
 {
-    PRO_UINT16 version;      /* the current protocol version is 02 */
-    char       reserved[30]; /* zero value */
+    PRO_UINT16 version;         /* the current protocol version is 02 */
+    char       resumeToken[16]; /* zero value if the session can't be resumed. the mac of the server on a resume */
+    char       reserved[14];    /* zero value */
 
     char       userData[64];
 };
 
+/*
+ * rtpĽ. ֶΪֽ
+ */
+struct RTP_STREAM_INFO
+{
+    PRO_UINT32 ts;            /* ʱ */
+    PRO_UINT32 ssrc;          /* ͬԴ */
+    PRO_UINT16 seq;           /* к */
+    PRO_UINT16 payloadOffset; /* ָƫ. ΪʱΪ0 */
+    PRO_UINT16 payloadSize;   /* س. Ϊ0 */
+    char       pt;            /*  */
+    bool       marker;        /* λ */
+    bool       valid;         /* ǷΪϷrtp. Ϸʱ, ֶΪ0 */
+    char       reserved[3];
+};
+
 /*
  * rtpỰʼ
  *
@@ -495,6 +516,63 @@ struct RTP_INIT_MCAST_EX
     IRtpBucket*                  bucket;           /* = NULL */
 };
 
+/*
+ * rtpỰʼ
+ *
+ * observer         : صĿ
+ * reactor          : Ӧ
+ * sslConfig        : ssl
+ * sslSni           : ssl. Ч, ֤֤
+ * remoteIp         : Զ˵ipַ
+ * remotePort       : Զ˵Ķ˿ں
+ * localIp          : Ҫ󶨵ıipַ. Ϊ"", ϵͳʹ0.0.0.0
+ * timeoutInSeconds : ֳʱ. Ĭ20
+ * bucket           : Ͱ. ΪNULL, ϵͳԶһ
+ *
+ * ˵: sslConfigָĶڻỰһֱЧ
+ *
+ *       udpչЭͬ, һrtpӦһݱ, ش
+ */
+struct RTP_INIT_DTLSCLIENT_EX
+{
+    IRtpSessionObserver*         observer;
+    IProReactor*                 reactor;
+    const PRO_SSL_CLIENT_CONFIG* sslConfig;
+    char                         sslSni[64];       /* = "" */
+    char                         remoteIp[64];
+    unsigned short               remotePort;
+    char                         localIp[64];      /* = "" */
+    unsigned long                timeoutInSeconds; /* = 0 */
+    IRtpBucket*                  bucket;           /* = NULL */
+};
+
+/*
+ * rtpỰʼ
+ *
+ * observer         : صĿ
+ * reactor          : Ӧ
+ * sslConfig        : ssl
+ * localIp          : Ҫ󶨵ıipַ. Ϊ"", ϵͳʹ0.0.0.0
+ * localPort        : Ҫ󶨵ıض˿ں. Ϊ0, ϵͳһ
+ * timeoutInSeconds : ֳʱ. Ĭ20
+ * bucket           : Ͱ. ΪNULL, ϵͳԶһ
+ *
+ * ˵: sslConfigָĶڻỰһֱЧ
+ *
+ *       cookie(HelloVerifyRequest)ȷϿͻ˵ĵַ֮, ŷ
+ *       ֤, Ұ󶨸õַ
+ */
+struct RTP_INIT_DTLSSERVER_EX
+{
+    IRtpSessionObserver*         observer;
+    IProReactor*                 reactor;
+    const PRO_SSL_SERVER_CONFIG* sslConfig;
+    char                         localIp[64];      /* = "" */
+    unsigned short               localPort;        /* = 0 */
+    unsigned long                timeoutInSeconds; /* = 0 */
+    IRtpBucket*                  bucket;           /* = NULL */
+};
+
 /*
  * rtpỰʼ
  */
@@ -521,6 +599,8 @@ union RTP_INIT_ARGS
     RTP_INIT_SSLSERVER_EX        sslserverEx;
     RTP_INIT_MCAST               mcast;
     RTP_INIT_MCAST_EX            mcastEx;
+    RTP_INIT_DTLSCLIENT_EX       dtlsclientEx;
+    RTP_INIT_DTLSSERVER_EX       dtlsserverEx;
     RTP_INIT_COMMON              comm;
 };
 
@@ -757,7 +837,8 @@ public:
     /*
      * ȡỰļ׼
      *
-     * RTP_ST_SSLCLIENT_EX, RTP_ST_SSLSERVER_EX͵ĻỰ
+     * RTP_ST_SSLCLIENT_EX, RTP_ST_SSLSERVER_EX,
+     * RTP_ST_DTLSCLIENT_EX, RTP_ST_DTLSSERVER_EX͵ĻỰ
      */
     virtual PRO_SSL_SUITE_ID PRO_CALLTYPE GetSslSuite(
         char suiteName[64]
@@ -909,6 +990,9 @@ public:
 
     /*
      * rtpͳ(for CRtpSessionWrapper only)------------------------------
+     *
+     * ˵: ͳֵշıķ, ȡʱӻỰ, ˿ͺ500.
+     *       500δͳֵ, ɶȡ¼
      */
 
     virtual void PRO_CALLTYPE GetInputStat(
@@ -984,7 +1068,8 @@ public:
      * ͵ĻỰ:
      * RTP_ST_UDPCLIENT_EX, RTP_ST_UDPSERVER_EX,
      * RTP_ST_TCPCLIENT_EX, RTP_ST_TCPSERVER_EX,
-     * RTP_ST_SSLCLIENT_EX, RTP_ST_SSLSERVER_EX
+     * RTP_ST_SSLCLIENT_EX, RTP_ST_SSLSERVER_EX,
+     * RTP_ST_DTLSCLIENT_EX, RTP_ST_DTLSSERVER_EX
      *
      * Ҫڵ
      */
@@ -1110,6 +1195,29 @@ PRO_CALLTYPE
 ParseRtpStreamToPacket(const void* streamBuffer,
                        PRO_UINT16  streamSize);
 
+/*
+ * : ׼rtp
+ *
+ * :
+ * streamBuffers : ָ
+ * streamSizes   : 
+ * count         : ĸ
+ * infos         : Ľ
+ *
+ * ֵ: Ϸĸ
+ *
+ * ˵: УParseRtpStreamToPacket()ͬ, rtp.
+ *       (, չͷ)SIMDָ(SSE2/AVX2/NEON)У,
+ *       
+ */
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+ParseRtpStreams(const void* const streamBuffers[],
+                const PRO_UINT16  streamSizes[],
+                unsigned long     count,
+                RTP_STREAM_INFO   infos[]);
+
 /*
  * : һrtpвһα׼rtp
  *
@@ -1368,6 +1476,168 @@ GetRtpTcpSocketParams(RTP_MM_TYPE    mmType,
                       unsigned long* sockBufSizeSend, /* = NULL */
                       unsigned long* recvPoolSize);   /* = NULL */
 
+/*
+ * : õײtcp㿽ֵ
+ *
+ * :
+ * mmType    : ý
+ * threshold : ʹ㿽͵Сֽ. Ĭ0, ʾʹ㿽
+ *
+ * ֵ: 
+ *
+ * ˵: RTP_ST_TCPCLIENT, RTP_ST_TCPSERVER, RTP_ST_TCPCLIENT_EX,
+ *       RTP_ST_TCPSERVER_EX͵ĻỰ, ҪLinux 4.14.
+ *       Сֵrtpںֱ, ٸƵͳ, ֱں֪ͨ
+ *       . ڴ֮ǰ, ϲ㲻޸İ.
+ *       ֻӰ֮ĻỰ.
+ *       ʺRTP_EPM_TCP4ȴת, һӦô(1024 * 10)
+ */
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpTcpZeroCopyThreshold(RTP_MM_TYPE   mmType,
+                           unsigned long threshold); /* = 0 */
+
+/*
+ * : ȡײtcp㿽ֵ
+ *
+ * :
+ * mmType : ý
+ *
+ * ֵ: 㿽͵Сֽ. 0ʾʹ㿽
+ *
+ * ˵: 
+ */
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+GetRtpTcpZeroCopyThreshold(RTP_MM_TYPE mmType);
+
+/*
+ * : ûỰװǷʹͰ
+ *
+ * :
+ * mmType : ý
+ * enable : Ƿʹ. Ĭfalse
+ *
+ * ֵ: 
+ *
+ * ˵: Ӱ֮ʼ, δָbucketĻỰװ.
+ *       Ự, SendPacket(...)rtpһнĻζ, ټ,
+ *       io߳ȡ, ٰԭеĺ߼ؼ֡غͷ.
+ *       ͬһỰֻһ̵߳SendPacket(...), Ҳ
+ *       SendPacketByTimer(...).
+ *       ʺϱ߳io߳̾ҵԴ
+ */
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpLockFreeBucket(RTP_MM_TYPE mmType,
+                     bool        enable); /* = false */
+
+/*
+ * : ȡỰװǷʹͰ
+ *
+ * :
+ * mmType : ý
+ *
+ * ֵ: trueʹ, falseʹ
+ *
+ * ˵: 
+ */
+PRO_RTP_API
+bool
+PRO_CALLTYPE
+GetRtpLockFreeBucket(RTP_MM_TYPE mmType);
+
+/*
+ * : udp˻Ựıض˿
+ *
+ * :
+ * mmType      : ý
+ * sharedPort  : ıض˿. 0ʾ, Ĭ0
+ * socketCount : 󶨸ö˿ڵ׽. Ĭ1
+ *
+ * ֵ: 
+ *
+ * ˵: Ӱ֮ʼ, localPortΪ0sharedPort
+ *       RTP_ST_UDPSERVER, RTP_ST_UDPSERVER_EXỰ.
+ *       ЩỰøö˿ϵ׽, յݱԶ˵ַ;
+ *       Զ˵׸ݱrtpssrc, rtp_exͬmmId,
+ *       ỰinSrcMmIdƥ, inSrcMmIdΪ0ĻỰԶ.
+ *       ͬһ˿ϵĻỰͬһ, ͬһӦ.
+ *       sharedPortӦSetRtpPortRange(...)ķΧ֮.
+ *       socketCount1ʱ, ʹSO_REUSEPORTڶ׽ֵּ(linux)
+ */
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpUdpSharedPort(RTP_MM_TYPE    mmType,
+                    unsigned short sharedPort,   /* = 0 */
+                    unsigned long  socketCount); /* = 1 */
+
+/*
+ * : ȡudp˻Ựıض˿
+ *
+ * :
+ * mmType      : ý
+ * socketCount : ص׽
+ *
+ * ֵ: ıض˿. 0ʾ
+ *
+ * ˵: 
+ */
+PRO_RTP_API
+unsigned short
+PRO_CALLTYPE
+GetRtpUdpSharedPort(RTP_MM_TYPE    mmType,
+                    unsigned long* socketCount); /* = NULL */
+
+/*
+ * : tcpչЭỰĻָʱ
+ *
+ * :
+ * mmType          : ý
+ * resumeInSeconds : ӶϿ, Ựȴָʱ. 0ʾָ, Ĭ0
+ *
+ * ֵ: 
+ *
+ * ˵: Ӱ֮ʼRTP_ST_TCPCLIENT_EX, RTP_ST_TCPSERVER_EXỰ,
+ *       ͻ˺ͷ˶Ҫ.
+ *       Ӧ·һָ. ỰӶϿʱ, ˫ص
+ *       OnCloseSession(...): ͻ, ƶӵӦ
+ *       У, Ʊϴ; ˵rtpУͨ, 
+ *       ҵԭỰ, ٻصOnAcceptSession(...), ҲУ.
+ *       ԭȻʱָܻ, ͻʱ, ֱҲ
+ *       ӶϿ. , ָʱӦôʱ.
+ *       ״Ӧ·, ˻Ựָֻڿŵ.
+ *       Ͱδrtp, Լδдһrtp, ڻָ֮
+ *       η. Ѿд׽ֻݿܶʧ, ն˵ͳϢ
+ *       ⲿֶ.
+ *       ʱδָ, ԶϿʱĴصOnCloseSession(...).
+ *       Ựָ, GetSockId(), GetLocalIp(...), GetLocalPort()ӵֵ
+ */
+PRO_RTP_API
+void
+PRO_CALLTYPE
+SetRtpTcpResumeTimeout(RTP_MM_TYPE   mmType,
+                       unsigned long resumeInSeconds); /* = 0 */
+
+/*
+ * : ȡtcpչЭỰĻָʱ
+ *
+ * :
+ * mmType : ý
+ *
+ * ֵ: Ựȴָ. 0ʾָ
+ *
+ * ˵: 
+ */
+PRO_RTP_API
+unsigned long
+PRO_CALLTYPE
+GetRtpTcpResumeTimeout(RTP_MM_TYPE mmType);
+
 /*
  * : һrtp
  *
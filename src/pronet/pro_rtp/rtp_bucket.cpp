@@ -20,7 +20,9 @@
 #include "rtp_base.h"
 #include "rtp_flow_stat.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
 #include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
 #include "../pro_util/pro_time_util.h"
 #include "../pro_util/pro_z.h"
 #include <cassert>
@@ -35,6 +37,8 @@
 #define MAX_FRAME_SIZE       (1024 * 1024)
 #define MAX_AUDIO_DELAY_MS   1000
 #define MAX_VIDEO_DELAY_MS   1200
+#define SPSC_RING_SIZE       1024
+#define MAX_SPSC_RING_SIZE   (1024 * 64)
 
 struct RTP_VIDEO_FRAME
 {
@@ -687,10 +691,279 @@ CRtpVideoBucket::ResetFlowctrlInfo()
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+CRtpSpscBucket::CRtpSpscBucket(IRtpBucket*   bucket,
+                               bool          markerFrame,
+                               unsigned long ringSize) /* = 0 */
+                               :
+m_bucket(bucket),
+m_markerFrame(markerFrame)
+{
+    assert(bucket != NULL);
+
+    if (ringSize == 0)
+    {
+        ringSize = SPSC_RING_SIZE;
+    }
+    if (ringSize > MAX_SPSC_RING_SIZE)
+    {
+        ringSize = MAX_SPSC_RING_SIZE;
+    }
+
+    unsigned long size = 2;
+    while (size < ringSize)
+    {
+        size <<= 1;
+    }
+
+    m_ring            = new IRtpPacket*[size];
+    m_ringMask        = size - 1;
+
+    m_tail            = 0;
+    m_srcFrames       = 0;
+    m_srcBytes        = 0;
+    m_ringBytes       = 0;
+    m_ringDropped     = 0;
+
+    m_head            = 0;
+    m_drainBytes      = 0;
+    m_lastSrcFrames   = 0;
+    m_lastSrcBytes    = 0;
+    m_lastRingDropped = 0;
+    m_erased          = false;
+
+    m_flowStat.SetTimeSpan(GetRtpFlowctrlTimeSpan());
+}
+
+CRtpSpscBucket::~CRtpSpscBucket()
+{
+    Reset();
+
+    m_bucket->Destroy();
+    delete [] m_ring;
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::Destroy()
+{
+    delete this;
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpSpscBucket::GetTotalBytes() const
+{
+    const unsigned long ringBytes =
+        (unsigned long)ProAtomicLoad(&m_ringBytes) - m_drainBytes;
+
+    return (m_bucket->GetTotalBytes() + ringBytes);
+}
+
+IRtpPacket*
+PRO_CALLTYPE
+CRtpSpscBucket::GetFront()
+{
+    Drain();
+
+    return (m_bucket->GetFront());
+}
+
+bool
+PRO_CALLTYPE
+CRtpSpscBucket::PushBackAddRef(IRtpPacket* packet)
+{
+    assert(packet != NULL);
+    if (packet == NULL)
+    {
+        return (false);
+    }
+
+    const unsigned long size   = packet->GetPayloadSize();
+    const unsigned long frames = !m_markerFrame || packet->GetMarker() ? 1 : 0;
+
+    /*
+     * only this thread writes the producer side
+     */
+    ProAtomicStore(&m_srcFrames, (long)((unsigned long)m_srcFrames + frames));
+    ProAtomicStore(&m_srcBytes, (long)((unsigned long)m_srcBytes  + size));
+
+    const unsigned long tail = (unsigned long)m_tail;
+    const unsigned long head = (unsigned long)ProAtomicLoad(&m_head);
+    if (tail - head > m_ringMask)
+    {
+        ProAtomicStore(&m_ringDropped, m_ringDropped + 1);
+
+        return (false);
+    }
+
+    packet->AddRef();
+    m_ring[tail & m_ringMask] = packet;
+
+    ProAtomicStore(&m_ringBytes, (long)((unsigned long)m_ringBytes + size));
+    ProAtomicStore(&m_tail, (long)(tail + 1)); /* publish */
+
+    return (true);
+}
+
+void
+CRtpSpscBucket::Drain()
+{
+    const unsigned long tail = (unsigned long)ProAtomicLoad(&m_tail);
+    unsigned long       head = (unsigned long)m_head;
+
+    for (; head != tail; ++head)
+    {
+        IRtpPacket* const packet = m_ring[head & m_ringMask];
+
+        m_drainBytes += packet->GetPayloadSize();
+        if (!m_bucket->PushBackAddRef(packet))
+        {
+            m_erased = true;
+        }
+        packet->Release();
+    }
+
+    ProAtomicStore(&m_head, (long)head);
+
+    SyncFlowStat();
+}
+
+void
+CRtpSpscBucket::SyncFlowStat() const
+{
+    const long srcFrames = ProAtomicLoad(&m_srcFrames);
+    const long srcBytes  = ProAtomicLoad(&m_srcBytes);
+
+    const unsigned long frames =
+        (unsigned long)srcFrames - (unsigned long)m_lastSrcFrames;
+    const unsigned long bytes  =
+        (unsigned long)srcBytes  - (unsigned long)m_lastSrcBytes;
+    if (frames > 0 || bytes > 0)
+    {
+        m_flowStat.PushData(frames, bytes);
+    }
+
+    m_lastSrcFrames = srcFrames;
+    m_lastSrcBytes  = srcBytes;
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::PopFrontRelease(IRtpPacket* packet)
+{
+    if (packet == NULL || packet != m_bucket->GetFront())
+    {
+        return;
+    }
+
+    const unsigned long frames =
+        !m_markerFrame || packet->GetMarker() ? 1 : 0;
+    m_flowStat.PopData(frames, packet->GetPayloadSize());
+
+    m_bucket->PopFrontRelease(packet);
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::Reset()
+{
+    const unsigned long tail = (unsigned long)ProAtomicLoad(&m_tail);
+    unsigned long       head = (unsigned long)m_head;
+
+    for (; head != tail; ++head)
+    {
+        IRtpPacket* const packet = m_ring[head & m_ringMask];
+
+        m_drainBytes += packet->GetPayloadSize();
+        packet->Release();
+    }
+
+    ProAtomicStore(&m_head, (long)head);
+
+    m_bucket->Reset();
+    m_lastSrcFrames   = ProAtomicLoad(&m_srcFrames);
+    m_lastSrcBytes    = ProAtomicLoad(&m_srcBytes);
+    m_lastRingDropped = ProAtomicLoad(&m_ringDropped);
+    m_erased          = false;
+
+    m_flowStat.Reset();
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::SetRedline(unsigned long redlineBytes,   /* = 0 */
+                           unsigned long redlineFrames,  /* = 0 */
+                           unsigned long redlineDelayMs) /* = 0 */
+{
+    m_bucket->SetRedline(redlineBytes, redlineFrames, redlineDelayMs);
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::GetRedline(unsigned long* redlineBytes,         /* = NULL */
+                           unsigned long* redlineFrames,        /* = NULL */
+                           unsigned long* redlineDelayMs) const /* = NULL */
+{
+    m_bucket->GetRedline(redlineBytes, redlineFrames, redlineDelayMs);
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::GetFlowctrlInfo(float*         srcFrameRate,       /* = NULL */
+                                float*         srcBitRate,         /* = NULL */
+                                float*         outFrameRate,       /* = NULL */
+                                float*         outBitRate,         /* = NULL */
+                                unsigned long* cachedBytes,        /* = NULL */
+                                unsigned long* cachedFrames) const /* = NULL */
+{
+    SyncFlowStat();
+    m_flowStat.CalcInfo(srcFrameRate, srcBitRate, outFrameRate, outBitRate);
+
+    unsigned long frames = 0;
+    m_bucket->GetFlowctrlInfo(NULL, NULL, NULL, NULL, NULL, &frames);
+
+    if (cachedBytes != NULL)
+    {
+        *cachedBytes  = GetTotalBytes();
+    }
+    if (cachedFrames != NULL)
+    {
+        /*
+         * the packets in the ring are counted as frames
+         */
+        *cachedFrames = frames +
+            ((unsigned long)ProAtomicLoad(&m_tail) - (unsigned long)m_head);
+    }
+}
+
+void
+PRO_CALLTYPE
+CRtpSpscBucket::ResetFlowctrlInfo()
+{
+    SyncFlowStat();
+    m_flowStat.Reset();
+}
+
+bool
+CRtpSpscBucket::PopErased()
+{
+    const long ringDropped = ProAtomicLoad(&m_ringDropped);
+
+    const bool erased = m_erased || ringDropped != m_lastRingDropped;
+    m_erased          = false;
+    m_lastRingDropped = ringDropped;
+
+    return (erased);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 IRtpBucket*
 PRO_CALLTYPE
 CreateRtpBucket(RTP_MM_TYPE      mmType,
-                RTP_SESSION_TYPE sessionType)
+                RTP_SESSION_TYPE sessionType,
+                bool             lockFree) /* = false */
 {
     assert(mmType != 0);
     if (mmType == 0)
@@ -698,7 +971,8 @@ CreateRtpBucket(RTP_MM_TYPE      mmType,
         return (NULL);
     }
 
-    IRtpBucket* bucket = NULL;
+    IRtpBucket* bucket      = NULL;
+    bool        markerFrame = false;
 
     if (mmType >= RTP_MMT_AUDIO_MIN && mmType <= RTP_MMT_AUDIO_MAX)
     {
@@ -713,7 +987,8 @@ CreateRtpBucket(RTP_MM_TYPE      mmType,
         case RTP_ST_SSLCLIENT_EX:
         case RTP_ST_SSLSERVER_EX:
             {
-                bucket = new CRtpVideoBucket;
+                bucket      = new CRtpVideoBucket;
+                markerFrame = true;
                 break;
             }
         default:
@@ -728,5 +1003,10 @@ CreateRtpBucket(RTP_MM_TYPE      mmType,
         bucket = new CRtpBucket;
     }
 
+    if (lockFree)
+    {
+        bucket = new CRtpSpscBucket(bucket, markerFrame);
+    }
+
     return (bucket);
 }
@@ -180,10 +180,122 @@ private:
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+/*
+ * A bucket shared by one sender thread and one io thread.
+ *
+ * PushBackAddRef() is the producer side. It only appends the packet to a
+ * bounded ring, and takes no lock. The other methods are the consumer side,
+ * and must be serialized by the caller. The consumer moves the ring into an
+ * inner bucket, where the redline and key-frame rules of that bucket apply,
+ * so the redline delay is counted from the move, not from the push.
+ */
+class CRtpSpscBucket : public IRtpBucket
+{
+public:
+
+    /*
+     * the "bucket" is owned by this object. "ringSize" is rounded up to a
+     * power of 2, and 0 means the default
+     */
+    CRtpSpscBucket(
+        IRtpBucket*   bucket,
+        bool          markerFrame,  /* frames are counted by the marker bit */
+        unsigned long ringSize = 0
+        );
+
+    virtual ~CRtpSpscBucket();
+
+    virtual void PRO_CALLTYPE Destroy();
+
+    virtual unsigned long PRO_CALLTYPE GetTotalBytes() const;
+
+    virtual IRtpPacket* PRO_CALLTYPE GetFront();
+
+    virtual bool PRO_CALLTYPE PushBackAddRef(IRtpPacket* packet);
+
+    virtual void PRO_CALLTYPE PopFrontRelease(IRtpPacket* packet);
+
+    virtual void PRO_CALLTYPE Reset();
+
+    virtual void PRO_CALLTYPE SetRedline(
+        unsigned long redlineBytes,   /* = 0 */
+        unsigned long redlineFrames,  /* = 0 */
+        unsigned long redlineDelayMs  /* = 0 */
+        );
+
+    virtual void PRO_CALLTYPE GetRedline(
+        unsigned long* redlineBytes,  /* = NULL */
+        unsigned long* redlineFrames, /* = NULL */
+        unsigned long* redlineDelayMs /* = NULL */
+        ) const;
+
+    virtual void PRO_CALLTYPE GetFlowctrlInfo(
+        float*         srcFrameRate, /* = NULL */
+        float*         srcBitRate,   /* = NULL */
+        float*         outFrameRate, /* = NULL */
+        float*         outBitRate,   /* = NULL */
+        unsigned long* cachedBytes,  /* = NULL */
+        unsigned long* cachedFrames  /* = NULL */
+        ) const;
+
+    virtual void PRO_CALLTYPE ResetFlowctrlInfo();
+
+    /*
+     * consumer side. whether some packets were discarded by the ring or by
+     * the redline since the last call
+     */
+    bool PopErased();
+
+private:
+
+    void Drain();
+
+    void SyncFlowStat() const;
+
+private:
+
+    IRtpBucket* const    m_bucket;
+    const bool           m_markerFrame;
+    IRtpPacket**         m_ring;
+    unsigned long        m_ringMask;
+
+    /*
+     * producer side
+     */
+    char                 m_pad1[64]; /* not sharing cache lines */
+    volatile long        m_tail;
+    volatile long        m_srcFrames;
+    volatile long        m_srcBytes;
+    volatile long        m_ringBytes;
+    volatile long        m_ringDropped;
+
+    /*
+     * consumer side
+     */
+    char                 m_pad2[64];
+    volatile long        m_head;
+    unsigned long        m_drainBytes;
+    mutable long         m_lastSrcFrames;
+    mutable long         m_lastSrcBytes;
+    long                 m_lastRingDropped;
+    bool                 m_erased;
+
+    mutable CRtpFlowStat m_flowStat;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * the "lockFree" selects a CRtpSpscBucket around the bucket of the type
+ */
 IRtpBucket*
 PRO_CALLTYPE
 CreateRtpBucket(RTP_MM_TYPE      mmType,
-                RTP_SESSION_TYPE sessionType);
+                RTP_SESSION_TYPE sessionType,
+                bool             lockFree = false);
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -241,6 +241,37 @@ struct RTP_MSG_USER
     PRO_UINT16    instId;
 };
 
+/*
+ * for CProStlHashMap and CProStlHashSet. the same mixing as
+ * ProStlHash(PRO_UINT64) in pro_stl.h
+ */
+inline
+PRO_UINT32
+ProStlHash(const RTP_MSG_USER& user)
+{
+    PRO_UINT64 key = user.classId;
+    key <<= 40;
+    key |=  user.UserId();
+    key <<= 16;
+    key |=  user.instId;
+
+    PRO_UINT32 h = (PRO_UINT32)(key >> 32);
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    h ^= (PRO_UINT32)key;
+    h ^= h >> 16;
+    h *= 0x85EBCA6B;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35;
+    h ^= h >> 16;
+
+    return (h);
+}
+
 /*
  * Ϣͷ
  */
@@ -532,6 +563,10 @@ public:
  * ϢصĿ
  *
  * ʹҪʵָýӿ
+ *
+ * OnCheckUser(...), OnOkUser(...)OnCloseUser(...)ڷڲ̳߳
+ * лص, ߳Ϊ. ͬһûĻص˳, ͬûĻص
+ * ڶ߳в, ϲӦñ֤Щص̰߳ȫ
  */
 class IRtpMsgServerObserver
 {
@@ -735,6 +770,9 @@ public:
  * Ϣc2sصĿ
  *
  * ʹҪʵָýӿ
+ *
+ * ߳ûʱ, OnCloseUser(...)c2sڲ̳߳лص. ͬû
+ * صڶ߳в, ϲӦñ֤ûص̰߳ȫ
  */
 class IRtpMsgC2sObserver
 {
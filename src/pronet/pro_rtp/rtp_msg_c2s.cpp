@@ -27,7 +27,7 @@
 #include "../pro_util/pro_config_file.h"
 #include "../pro_util/pro_config_stream.h"
 #include "../pro_util/pro_functor_command.h"
-#include "../pro_util/pro_functor_command_task.h"
+#include "../pro_util/pro_functor_command_task_pool.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_ref_count.h"
 #include "../pro_util/pro_ssl_util.h"
@@ -179,9 +179,9 @@ CRtpMsgC2s::Init(IRtpMsgC2sObserver* observer,
         localTimeoutInSeconds  = DEFAULT_TIMEOUT;
     }
 
-    CProFunctorCommandTask* task      = NULL;
-    CRtpMsgClient*          msgClient = NULL;
-    IRtpService*            service   = NULL;
+    CProFunctorCommandTaskPool* task      = NULL;
+    CRtpMsgClient*              msgClient = NULL;
+    IRtpService*                service   = NULL;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -197,7 +197,7 @@ CRtpMsgC2s::Init(IRtpMsgC2sObserver* observer,
             return (false);
         }
 
-        task = new CProFunctorCommandTask;
+        task = new CProFunctorCommandTaskPool;
         if (!task->Start())
         {
             goto EXIT;
@@ -277,11 +277,11 @@ EXIT:
 void
 CRtpMsgC2s::Fini()
 {
-    IRtpMsgC2sObserver*                    observer  = NULL;
-    CProFunctorCommandTask*                task      = NULL;
-    CRtpMsgClient*                         msgClient = NULL;
-    IRtpService*                           service   = NULL;
-    CProStlMap<IRtpSession*, RTP_MSG_USER> session2User;
+    IRtpMsgC2sObserver*                        observer  = NULL;
+    CProFunctorCommandTaskPool*                task      = NULL;
+    CRtpMsgClient*                             msgClient = NULL;
+    IRtpService*                               service   = NULL;
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER> session2User;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -330,8 +330,8 @@ CRtpMsgC2s::Fini()
         m_observer = NULL;
     }
 
-    CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator       itr = session2User.begin();
-    CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator const end = session2User.end();
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator       itr = session2User.begin();
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator const end = session2User.end();
 
     for (; itr != end; ++itr)
     {
@@ -571,7 +571,7 @@ CRtpMsgC2s::GetLocalSslSuite(const RTP_MSG_USER* user,
     {
         CProThreadMutexGuard mon(m_lock);
 
-        CProStlMap<RTP_MSG_USER, IRtpSession*>::const_iterator const itr =
+        CProStlHashMap<RTP_MSG_USER, IRtpSession*>::const_iterator const itr =
             m_user2Session.find(*user);
         if (itr != m_user2Session.end())
         {
@@ -628,7 +628,7 @@ CRtpMsgC2s::KickoutLocalUser(const RTP_MSG_USER* user)
             (PRO_INT64)user->UserId(),
             (PRO_INT64)user->instId
             );
-        m_task->Put(command);
+        m_task->Put(((PRO_UINT64)user->classId << 40) | user->UserId(), command);
     }
 }
 
@@ -654,7 +654,7 @@ CRtpMsgC2s::AsyncKickoutLocalUser(PRO_INT64* args)
             return;
         }
 
-        CProStlMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
+        CProStlHashMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
             m_user2Session.find(user);
         if (itr == m_user2Session.end())
         {
@@ -731,7 +731,7 @@ CRtpMsgC2s::GetLocalSendingBytes(const RTP_MSG_USER* user) const
     {
         CProThreadMutexGuard mon(m_lock);
 
-        CProStlMap<RTP_MSG_USER, IRtpSession*>::const_iterator const itr =
+        CProStlHashMap<RTP_MSG_USER, IRtpSession*>::const_iterator const itr =
             m_user2Session.find(*user);
         if (itr != m_user2Session.end())
         {
@@ -1045,7 +1045,7 @@ CRtpMsgC2s::OnRecvSession(IRtpSession* session,
             return;
         }
 
-        CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
+        CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
             m_session2User.find(session);
         if (itr == m_session2User.end() || srcUser != itr->second)
         {
@@ -1062,7 +1062,7 @@ CRtpMsgC2s::OnRecvSession(IRtpSession* session,
                 continue;
             }
 
-            CProStlMap<RTP_MSG_USER, IRtpSession*>::iterator const itr2 =
+            CProStlHashMap<RTP_MSG_USER, IRtpSession*>::iterator const itr2 =
                 m_user2Session.find(dstUser);
             if (itr2 != m_user2Session.end())
             {
@@ -1126,7 +1126,7 @@ CRtpMsgC2s::OnCloseSession(IRtpSession* session,
             return;
         }
 
-        CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
+        CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
             m_session2User.find(session);
         if (itr == m_session2User.end())
         {
@@ -1176,7 +1176,7 @@ CRtpMsgC2s::OnHeartbeatSession(IRtpSession* session,
             return;
         }
 
-        CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
+        CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator const itr =
             m_session2User.find(session);
         if (itr == m_session2User.end())
         {
@@ -1408,7 +1408,7 @@ CRtpMsgC2s::ProcessMsg_client_login_ok(IRtpMsgClient*          msgClient,
             {
                 newSession->SetOutputRedline(m_localRedlineBytes, 0, 0);
 
-                CProStlMap<RTP_MSG_USER, IRtpSession*>::iterator const itr2 =
+                CProStlHashMap<RTP_MSG_USER, IRtpSession*>::iterator const itr2 =
                     m_user2Session.find(user);
                 if (itr2 != m_user2Session.end())
                 {
@@ -1535,7 +1535,7 @@ CRtpMsgC2s::ProcessMsg_client_kickout(IRtpMsgClient*          msgClient,
             return;
         }
 
-        CProStlMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
+        CProStlHashMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
             m_user2Session.find(user);
         if (itr == m_user2Session.end())
         {
@@ -1598,7 +1598,7 @@ CRtpMsgC2s::OnTransferMsg(IRtpMsgClient*      msgClient,
 
         for (int i = 0; i < (int)dstUserCount; ++i)
         {
-            CProStlMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
+            CProStlHashMap<RTP_MSG_USER, IRtpSession*>::iterator const itr =
                 m_user2Session.find(dstUsers[i]);
             if (itr != m_user2Session.end())
             {
@@ -1632,8 +1632,8 @@ CRtpMsgC2s::OnCloseMsg(IRtpMsgClient* msgClient,
         return;
     }
 
-    IRtpMsgC2sObserver*                    observer = NULL;
-    CProStlMap<IRtpSession*, RTP_MSG_USER> session2User;
+    IRtpMsgC2sObserver*                        observer = NULL;
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER> session2User;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -1675,8 +1675,8 @@ CRtpMsgC2s::OnCloseMsg(IRtpMsgClient* msgClient,
         observer = m_observer;
     }
 
-    CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator       itr = session2User.begin();
-    CProStlMap<IRtpSession*, RTP_MSG_USER>::iterator const end = session2User.end();
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator       itr = session2User.begin();
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER>::iterator const end = session2User.end();
 
     for (; itr != end; ++itr)
     {
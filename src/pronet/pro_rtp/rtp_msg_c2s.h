@@ -33,7 +33,7 @@
 ////
 
 class CProConfigStream;
-class CProFunctorCommandTask;
+class CProFunctorCommandTaskPool;
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -284,7 +284,7 @@ private:
 
     IRtpMsgC2sObserver*                                  m_observer;
     IProReactor*                                         m_reactor;
-    CProFunctorCommandTask*                              m_task;
+    CProFunctorCommandTaskPool*                          m_task;
     CRtpMsgClient*                                       m_msgClient;
     IRtpService*                                         m_service;
     unsigned short                                       m_serviceHubPort;
@@ -303,8 +303,8 @@ private:
     RTP_MSG_USER                                         m_myUserBak;
 
     CProStlMap<PRO_UINT64, RTP_MSG_AsyncOnAcceptSession> m_timerId2Info;
-    CProStlMap<IRtpSession*, RTP_MSG_USER>               m_session2User;
-    CProStlMap<RTP_MSG_USER, IRtpSession*>               m_user2Session;
+    CProStlHashMap<IRtpSession*, RTP_MSG_USER>           m_session2User;
+    CProStlHashMap<RTP_MSG_USER, IRtpSession*>           m_user2Session;
 
     mutable CProThreadMutex                              m_lock;
     CProThreadMutex                                      m_lockUpcall;
@@ -25,7 +25,7 @@
 #include "../pro_util/pro_config_file.h"
 #include "../pro_util/pro_config_stream.h"
 #include "../pro_util/pro_functor_command.h"
-#include "../pro_util/pro_functor_command_task.h"
+#include "../pro_util/pro_functor_command_task_pool.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_ref_count.h"
 #include "../pro_util/pro_stl.h"
@@ -97,6 +97,35 @@ MakeClientId_i()
     return (userId);
 }
 
+/*
+ * the commands of a user are executed in order
+ */
+static
+inline
+PRO_UINT64
+PRO_CALLTYPE
+MakeTaskKey_i(const RTP_MSG_USER& user)
+{
+    return (((PRO_UINT64)user.classId << 40) | user.UserId());
+}
+
+static
+PRO_UINT64
+PRO_CALLTYPE
+MakeAcceptKey_i(const RTP_SESSION_INFO& remoteInfo,
+                PRO_INT64               sockId)
+{
+    RTP_MSG_HEADER0 hdr0;
+    memcpy(&hdr0, remoteInfo.userData, sizeof(RTP_MSG_HEADER0));
+
+    if (hdr0.user.UserId() == 0) /* to be assigned */
+    {
+        return ((PRO_UINT64)sockId);
+    }
+
+    return (MakeTaskKey_i(hdr0.user));
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -160,8 +189,8 @@ CRtpMsgServer::Init(IRtpMsgServerObserver* observer,
         timeoutInSeconds = DEFAULT_TIMEOUT;
     }
 
-    CProFunctorCommandTask* task    = NULL;
-    IRtpService*            service = NULL;
+    CProFunctorCommandTaskPool* task    = NULL;
+    IRtpService*                service = NULL;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -176,7 +205,7 @@ CRtpMsgServer::Init(IRtpMsgServerObserver* observer,
             return (false);
         }
 
-        task = new CProFunctorCommandTask;
+        task = new CProFunctorCommandTaskPool;
         if (!task->Start())
         {
             goto EXIT;
@@ -217,7 +246,7 @@ void
 CRtpMsgServer::Fini()
 {
     IRtpMsgServerObserver*                      observer = NULL;
-    CProFunctorCommandTask*                     task     = NULL;
+    CProFunctorCommandTaskPool*                 task     = NULL;
     IRtpService*                                service  = NULL;
     CProStlMap<IRtpSession*, RTP_MSG_LINK_CTX*> session2Ctx;
 
@@ -380,7 +409,7 @@ CRtpMsgServer::KickoutUser(const RTP_MSG_USER* user)
             (PRO_INT64)user->UserId(),
             (PRO_INT64)user->instId
             );
-        m_task->Put(command);
+        m_task->Put(MakeTaskKey_i(*user), command);
     }
 }
 
@@ -759,7 +788,7 @@ CRtpMsgServer::OnAcceptSession(IRtpService*            service,
             &CRtpMsgServer::AsyncOnAcceptSession,
             (PRO_INT64)arg
             );
-        m_task->Put(command);
+        m_task->Put(MakeAcceptKey_i(*remoteInfo, sockId), command);
     }
 
     return;
@@ -837,7 +866,7 @@ CRtpMsgServer::OnAcceptSession(IRtpService*            service,
             &CRtpMsgServer::AsyncOnAcceptSession,
             (PRO_INT64)arg
             );
-        m_task->Put(command);
+        m_task->Put(MakeAcceptKey_i(*remoteInfo, sockId), command);
     }
 
     return;
@@ -1201,6 +1230,17 @@ CRtpMsgServer::OnRecvSession(IRtpSession* session,
                 break;
             }
 
+            PRO_UINT64    clientIndex = 0;
+            CProStlString clientId    = "";
+            arg->msgStream.GetUint64(TAG_client_index, clientIndex);
+            arg->msgStream.Get      (TAG_client_id   , clientId);
+
+            RTP_MSG_USER subUser;
+            RtpMsgString2User(clientId.c_str(), &subUser);
+
+            const PRO_UINT64 key = subUser.UserId() != 0
+                ? MakeTaskKey_i(subUser) : clientIndex;
+
             arg->session->AddRef();
             IProFunctorCommand* const command =
                 CProFunctorCommand_cpp<CRtpMsgServer, ACTION>::CreateInstance(
@@ -1208,7 +1248,7 @@ CRtpMsgServer::OnRecvSession(IRtpSession* session,
                 &CRtpMsgServer::AsyncOnRecvSession,
                 (PRO_INT64)arg
                 );
-            m_task->Put(command);
+            m_task->Put(key, command);
         }
         while (0);
 
@@ -1565,6 +1605,18 @@ CRtpMsgServer::OnCloseSession(IRtpSession* session,
             return;
         }
 
+        /*
+         * after the commands of its base user
+         */
+        PRO_UINT64 key = (PRO_UINT64)session;
+
+        CProStlMap<IRtpSession*, RTP_MSG_LINK_CTX*>::const_iterator const itr =
+            m_session2Ctx.find(session);
+        if (itr != m_session2Ctx.end())
+        {
+            key = MakeTaskKey_i(itr->second->baseUser);
+        }
+
         session->AddRef();
         IProFunctorCommand* const command =
             CProFunctorCommand_cpp<CRtpMsgServer, ACTION>::CreateInstance(
@@ -1574,7 +1626,7 @@ CRtpMsgServer::OnCloseSession(IRtpSession* session,
             (PRO_INT64)errorCode,
             (PRO_INT64)sslCode
             );
-        m_task->Put(command);
+        m_task->Put(key, command);
     }
 }
 
@@ -0,0 +1,385 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "rtp_pacer.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_timer_factory.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+#include <cstring>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define SLOT_MASK (RTP_PACER_SLOTS - 1)
+
+static CProStlMap<IProReactor*, CRtpPacer*> g_s_pacers; /* reactor ---> pacer */
+static CProThreadMutex                      g_s_lock;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CRtpPacer*
+CRtpPacer::Attach(IProReactor* reactor)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (NULL);
+    }
+
+    CRtpPacer* pacer = NULL;
+
+    {
+        CProThreadMutexGuard mon(g_s_lock);
+
+        CProStlMap<IProReactor*, CRtpPacer*>::const_iterator const itr =
+            g_s_pacers.find(reactor);
+        if (itr != g_s_pacers.end())
+        {
+            pacer = itr->second;
+        }
+        else
+        {
+            pacer = new CRtpPacer(reactor); /* the reference of the map */
+            g_s_pacers[reactor] = pacer;
+        }
+
+        pacer->AddRef();
+        ++pacer->m_attachCount;
+    }
+
+    return (pacer);
+}
+
+void
+CRtpPacer::Detach()
+{
+    bool last = false;
+
+    {
+        CProThreadMutexGuard mon(g_s_lock);
+
+        assert(m_attachCount > 0);
+        --m_attachCount;
+
+        if (m_attachCount == 0)
+        {
+            g_s_pacers.erase(m_reactor);
+            last = true;
+        }
+    }
+
+    if (last)
+    {
+        PRO_UINT64                              timerId = 0;
+        CProStlMap<IRtpPacedSender*, PRO_INT64> sender2DueTick;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            timerId = m_timerId;
+            m_timerId = 0;
+            sender2DueTick = m_sender2DueTick;
+            m_sender2DueTick.clear();
+
+            for (int i = 0; i < RTP_PACER_SLOTS; ++i)
+            {
+                m_slots[i].clear();
+            }
+            memset(m_bitmap, 0, sizeof(m_bitmap));
+        }
+
+        m_reactor->CancelMmTimer(timerId);
+
+        CProStlMap<IRtpPacedSender*, PRO_INT64>::const_iterator       itr = sender2DueTick.begin();
+        CProStlMap<IRtpPacedSender*, PRO_INT64>::const_iterator const end = sender2DueTick.end();
+
+        for (; itr != end; ++itr)
+        {
+            itr->first->Release();
+        }
+
+        Release(); /* the reference of the map */
+    }
+
+    Release();
+}
+
+CRtpPacer::CRtpPacer(IProReactor* reactor)
+: m_reactor(reactor)
+{
+    m_attachCount = 0;
+    m_timerId     = 0;
+    m_timerTick   = 0;
+    m_cursor      = ProGetTickCount64();
+
+    memset(m_bitmap, 0, sizeof(m_bitmap));
+}
+
+CRtpPacer::~CRtpPacer()
+{
+    assert(m_sender2DueTick.size() == 0);
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpPacer::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpPacer::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+void
+CRtpPacer::Schedule(IRtpPacedSender* sender,
+                    PRO_INT64        dueTick)
+{
+    assert(sender != NULL);
+    assert(dueTick > 0);
+    if (sender == NULL || dueTick <= 0)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlMap<IRtpPacedSender*, PRO_INT64>::const_iterator const itr =
+            m_sender2DueTick.find(sender);
+        if (itr != m_sender2DueTick.end())
+        {
+            if (itr->second <= dueTick)
+            {
+                return;
+            }
+        }
+        else
+        {
+            sender->AddRef();
+        }
+
+        /*
+         * the old entry becomes stale, and is dropped when its slot is fired
+         */
+        Insert(sender, dueTick);
+
+        if (m_timerId == 0 || dueTick < m_timerTick)
+        {
+            ArmTimer(ProGetTickCount64(), dueTick);
+        }
+    }
+}
+
+void
+CRtpPacer::Cancel(IRtpPacedSender* sender)
+{
+    bool found = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        found = m_sender2DueTick.erase(sender) > 0;
+    }
+
+    if (found)
+    {
+        sender->Release();
+    }
+}
+
+void
+PRO_CALLTYPE
+CRtpPacer::OnTimer(void*      factory,
+                   PRO_UINT64 timerId,
+                   PRO_INT64  userData)
+{
+    assert(factory != NULL);
+    assert(timerId > 0);
+    if (factory == NULL || timerId == 0)
+    {
+        return;
+    }
+
+    const PRO_INT64                 tick = ProGetTickCount64();
+    CProStlVector<IRtpPacedSender*> senders;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (timerId != m_timerId)
+        {
+            return;
+        }
+
+        m_timerId = 0;
+
+        PRO_INT64 first = m_cursor;
+        if (tick - first >= RTP_PACER_SLOTS)
+        {
+            first = tick - RTP_PACER_SLOTS + 1; /* each slot at most once */
+        }
+
+        for (PRO_INT64 t = first; t <= tick; ++t)
+        {
+            const int index = (int)(t & SLOT_MASK);
+            if ((m_bitmap[index / 64] & ((PRO_UINT64)1 << (index % 64))) == 0)
+            {
+                continue;
+            }
+
+            CProStlVector<RTP_PACER_ENTRY>& slot = m_slots[index];
+            size_t                          kept = 0;
+
+            for (size_t i = 0; i < slot.size(); ++i)
+            {
+                const RTP_PACER_ENTRY entry = slot[i];
+
+                CProStlMap<IRtpPacedSender*, PRO_INT64>::iterator const itr =
+                    m_sender2DueTick.find(entry.sender);
+                if (itr == m_sender2DueTick.end() ||
+                    itr->second != entry.dueTick) /* stale */
+                {
+                    continue;
+                }
+
+                if (entry.dueTick > tick) /* a later lap */
+                {
+                    slot[kept] = entry;
+                    ++kept;
+                    continue;
+                }
+
+                m_sender2DueTick.erase(itr);
+                senders.push_back(entry.sender); /* the reference is moved */
+            }
+
+            slot.resize(kept);
+            if (kept == 0)
+            {
+                m_bitmap[index / 64] &= ~((PRO_UINT64)1 << (index % 64));
+            }
+        }
+
+        m_cursor = tick + 1;
+    }
+
+    int       i = 0;
+    const int c = (int)senders.size();
+
+    for (; i < c; ++i)
+    {
+        const PRO_INT64 nextTick = senders[i]->OnPace(tick);
+        if (nextTick > 0)
+        {
+            Schedule(senders[i], nextTick);
+        }
+
+        senders[i]->Release();
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        const PRO_INT64 nextTick = FindNextTick();
+        if (nextTick > 0 && (m_timerId == 0 || nextTick < m_timerTick))
+        {
+            ArmTimer(ProGetTickCount64(), nextTick);
+        }
+    }
+}
+
+void
+CRtpPacer::Insert(IRtpPacedSender* sender,
+                  PRO_INT64        dueTick)
+{
+    if (dueTick < m_cursor)
+    {
+        dueTick = m_cursor;
+    }
+
+    RTP_PACER_ENTRY entry;
+    entry.sender  = sender;
+    entry.dueTick = dueTick;
+
+    const int index = (int)(dueTick & SLOT_MASK);
+    m_slots[index].push_back(entry);
+    m_bitmap[index / 64] |= (PRO_UINT64)1 << (index % 64);
+    m_sender2DueTick[sender] = dueTick;
+}
+
+PRO_INT64
+CRtpPacer::FindNextTick() const
+{
+    const int start = (int)(m_cursor & SLOT_MASK);
+
+    for (int i = 0; i < RTP_PACER_SLOTS; )
+    {
+        const int  index = (start + i) & SLOT_MASK;
+        PRO_UINT64 bits  = m_bitmap[index / 64] >> (index % 64);
+
+        if (bits != 0)
+        {
+            int offset = 0;
+            while ((bits & 1) == 0)
+            {
+                bits >>= 1;
+                ++offset;
+            }
+
+            return (m_cursor + i + offset); /* maybe a later lap or stale */
+        }
+
+        i += 64 - index % 64;
+    }
+
+    return (0);
+}
+
+void
+CRtpPacer::ArmTimer(PRO_INT64 tick,
+                    PRO_INT64 dueTick)
+{
+    if (m_timerId != 0)
+    {
+        m_reactor->CancelMmTimer(m_timerId);
+    }
+
+    PRO_INT64 timeSpan = dueTick - tick;
+    if (timeSpan < 0)
+    {
+        timeSpan = 0;
+    }
+
+    m_timerId   = m_reactor->ScheduleMmTimer(this, (PRO_UINT64)timeSpan, false);
+    m_timerTick = tick + timeSpan;
+}
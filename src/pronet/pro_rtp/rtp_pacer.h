@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+/*
+ * A pacing scheduler shared by all the paced senders of a reactor.
+ *
+ * The senders are kept in a calendar queue of 1ms slots, keyed by their
+ * next release ticks. Only one mm timer is armed, for the earliest slot, so
+ * the cost scales with the releases rather than with the senders.
+ */
+
+#if !defined(RTP_PACER_H)
+#define RTP_PACER_H
+
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_timer_factory.h"
+#include "../pro_util/pro_z.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define RTP_PACER_SLOTS 1024 /* 1ms per slot, a power of 2 */
+
+class IRtpPacedSender
+{
+public:
+
+    virtual ~IRtpPacedSender() {}
+
+    virtual unsigned long PRO_CALLTYPE AddRef() = 0;
+
+    virtual unsigned long PRO_CALLTYPE Release() = 0;
+
+    /*
+     * releases the packets due at "tick", and returns the tick of the next
+     * release, or 0 if nothing is queued
+     */
+    virtual PRO_INT64 PRO_CALLTYPE OnPace(PRO_INT64 tick) = 0;
+};
+
+struct RTP_PACER_ENTRY
+{
+    IRtpPacedSender* sender;
+    PRO_INT64        dueTick;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CRtpPacer : public IProOnTimer, public CProRefCount
+{
+public:
+
+    /*
+     * returns the pacer of the reactor, shared by all its attachers
+     */
+    static CRtpPacer* Attach(IProReactor* reactor);
+
+    void Detach();
+
+    /*
+     * queues the sender at "dueTick", or moves it earlier
+     */
+    void Schedule(
+        IRtpPacedSender* sender,
+        PRO_INT64        dueTick
+        );
+
+    void Cancel(IRtpPacedSender* sender);
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CRtpPacer(IProReactor* reactor);
+
+    virtual ~CRtpPacer();
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+    void Insert(
+        IRtpPacedSender* sender,
+        PRO_INT64        dueTick
+        );
+
+    PRO_INT64 FindNextTick() const;
+
+    void ArmTimer(
+        PRO_INT64 tick,
+        PRO_INT64 dueTick
+        );
+
+private:
+
+    IProReactor* const                      m_reactor;
+    unsigned long                           m_attachCount;
+    PRO_UINT64                              m_timerId;
+    PRO_INT64                               m_timerTick;
+    PRO_INT64                               m_cursor; /* the first tick not fired */
+    CProStlVector<RTP_PACER_ENTRY>          m_slots[RTP_PACER_SLOTS];
+    PRO_UINT64                              m_bitmap[RTP_PACER_SLOTS / 64]; /* non-empty slots */
+    CProStlMap<IRtpPacedSender*, PRO_INT64> m_sender2DueTick;
+    CProThreadMutex                         m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* RTP_PACER_H */
@@ -24,6 +24,197 @@
 #include "../pro_util/pro_z.h"
 #include <cassert>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define RTP_PARSE_AVX2
+#define RTP_PARSE_LANES 8
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define RTP_PARSE_SSE2
+#define RTP_PARSE_LANES 4
+#elif (defined(__ARM_NEON) || defined(__ARM_NEON__)) && \
+    !defined(PRO_WORDS_BIGENDIAN)
+#include <arm_neon.h>
+#define RTP_PARSE_NEON
+#define RTP_PARSE_LANES 4
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#if defined(RTP_PARSE_LANES)
+
+/*
+ * the fixed headers of a group of buffers, one lane per buffer. The words
+ * are in memory order
+ */
+struct RTP_PARSE_GROUP
+{
+    PRO_UINT32 w0[RTP_PARSE_LANES];      /* v, p, x, cc, m, pt, seq */
+    PRO_UINT32 ts[RTP_PARSE_LANES];
+    PRO_UINT32 ssrc[RTP_PARSE_LANES];
+    PRO_UINT32 size[RTP_PARSE_LANES];
+
+    PRO_UINT32 ok[RTP_PARSE_LANES];      /* v == 2, p == 0, x == 0, size >= hdrSize */
+    PRO_UINT32 hdrSize[RTP_PARSE_LANES];
+    PRO_UINT32 mpt[RTP_PARSE_LANES];     /* m, pt */
+    PRO_UINT32 seq[RTP_PARSE_LANES];
+
+    DECLARE_SGI_POOL(0)
+};
+
+#if defined(RTP_PARSE_AVX2)
+
+static
+inline
+void
+PRO_CALLTYPE
+ParseGroup_i(RTP_PARSE_GROUP& group)
+{
+    const __m256i swap = _mm256_setr_epi8(
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+        3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+
+    const __m256i w0   = _mm256_loadu_si256((const __m256i*)group.w0);
+    const __m256i size = _mm256_loadu_si256((const __m256i*)group.size);
+    const __m256i fast = _mm256_cmpeq_epi32(
+        _mm256_and_si256(w0, _mm256_set1_epi32(0xF0)), _mm256_set1_epi32(0x80));
+    const __m256i hdrSize = _mm256_add_epi32(
+        _mm256_slli_epi32(_mm256_and_si256(w0, _mm256_set1_epi32(0x0F)), 2),
+        _mm256_set1_epi32((int)sizeof(RTP_HEADER)));
+    const __m256i ok   = _mm256_andnot_si256(
+        _mm256_cmpgt_epi32(hdrSize, size), fast);
+    const __m256i sw0  = _mm256_shuffle_epi8(w0, swap);
+    const __m256i mask = _mm256_set1_epi32(0xFFFF);
+
+    _mm256_storeu_si256((__m256i*)group.ok     , ok);
+    _mm256_storeu_si256((__m256i*)group.hdrSize, hdrSize);
+    _mm256_storeu_si256((__m256i*)group.mpt    ,
+        _mm256_and_si256(_mm256_srli_epi32(sw0, 16), _mm256_set1_epi32(0xFF)));
+    _mm256_storeu_si256((__m256i*)group.seq    , _mm256_and_si256(sw0, mask));
+    _mm256_storeu_si256((__m256i*)group.ts     , _mm256_shuffle_epi8(
+        _mm256_loadu_si256((const __m256i*)group.ts), swap));
+    _mm256_storeu_si256((__m256i*)group.ssrc   , _mm256_shuffle_epi8(
+        _mm256_loadu_si256((const __m256i*)group.ssrc), swap));
+}
+
+#elif defined(RTP_PARSE_SSE2)
+
+static
+inline
+__m128i
+PRO_CALLTYPE
+Swap32_i(__m128i x)
+{
+    x = _mm_or_si128(_mm_slli_epi16(x, 8), _mm_srli_epi16(x, 8));
+    x = _mm_shufflelo_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+    x = _mm_shufflehi_epi16(x, _MM_SHUFFLE(2, 3, 0, 1));
+
+    return (x);
+}
+
+static
+inline
+void
+PRO_CALLTYPE
+ParseGroup_i(RTP_PARSE_GROUP& group)
+{
+    const __m128i w0   = _mm_loadu_si128((const __m128i*)group.w0);
+    const __m128i size = _mm_loadu_si128((const __m128i*)group.size);
+    const __m128i fast = _mm_cmpeq_epi32(
+        _mm_and_si128(w0, _mm_set1_epi32(0xF0)), _mm_set1_epi32(0x80));
+    const __m128i hdrSize = _mm_add_epi32(
+        _mm_slli_epi32(_mm_and_si128(w0, _mm_set1_epi32(0x0F)), 2),
+        _mm_set1_epi32((int)sizeof(RTP_HEADER)));
+    const __m128i ok   = _mm_andnot_si128(_mm_cmpgt_epi32(hdrSize, size), fast);
+    const __m128i sw0  = Swap32_i(w0);
+
+    _mm_storeu_si128((__m128i*)group.ok     , ok);
+    _mm_storeu_si128((__m128i*)group.hdrSize, hdrSize);
+    _mm_storeu_si128((__m128i*)group.mpt    ,
+        _mm_and_si128(_mm_srli_epi32(sw0, 16), _mm_set1_epi32(0xFF)));
+    _mm_storeu_si128((__m128i*)group.seq    ,
+        _mm_and_si128(sw0, _mm_set1_epi32(0xFFFF)));
+    _mm_storeu_si128((__m128i*)group.ts     ,
+        Swap32_i(_mm_loadu_si128((const __m128i*)group.ts)));
+    _mm_storeu_si128((__m128i*)group.ssrc   ,
+        Swap32_i(_mm_loadu_si128((const __m128i*)group.ssrc)));
+}
+
+#else  /* RTP_PARSE_NEON */
+
+static
+inline
+void
+PRO_CALLTYPE
+ParseGroup_i(RTP_PARSE_GROUP& group)
+{
+    const uint32x4_t w0      = vld1q_u32(group.w0);
+    const uint32x4_t size    = vld1q_u32(group.size);
+    const uint32x4_t fast    = vceqq_u32(
+        vandq_u32(w0, vdupq_n_u32(0xF0)), vdupq_n_u32(0x80));
+    const uint32x4_t hdrSize = vaddq_u32(
+        vshlq_n_u32(vandq_u32(w0, vdupq_n_u32(0x0F)), 2),
+        vdupq_n_u32(sizeof(RTP_HEADER)));
+    const uint32x4_t ok      = vandq_u32(vcgeq_u32(size, hdrSize), fast);
+    const uint32x4_t sw0     =
+        vreinterpretq_u32_u8(vrev32q_u8(vreinterpretq_u8_u32(w0)));
+
+    vst1q_u32(group.ok     , ok);
+    vst1q_u32(group.hdrSize, hdrSize);
+    vst1q_u32(group.mpt    , vandq_u32(vshrq_n_u32(sw0, 16), vdupq_n_u32(0xFF)));
+    vst1q_u32(group.seq    , vandq_u32(sw0, vdupq_n_u32(0xFFFF)));
+    vst1q_u32(group.ts     , vreinterpretq_u32_u8(
+        vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(group.ts)))));
+    vst1q_u32(group.ssrc   , vreinterpretq_u32_u8(
+        vrev32q_u8(vreinterpretq_u8_u32(vld1q_u32(group.ssrc)))));
+}
+
+#endif /* RTP_PARSE_AVX2, RTP_PARSE_SSE2, RTP_PARSE_NEON */
+
+#endif /* RTP_PARSE_LANES */
+
+static
+inline
+bool
+PRO_CALLTYPE
+ParseOne_i(const char*      buffer,
+           PRO_UINT16       size,
+           RTP_STREAM_INFO& info)
+{
+    memset(&info, 0, sizeof(RTP_STREAM_INFO));
+
+    if (buffer == NULL || size == 0)
+    {
+        return (false);
+    }
+
+    RTP_HEADER  hdr;
+    const char* payloadBuffer = NULL;
+    PRO_UINT16  payloadSize   = 0;
+
+    if (!CRtpPacket::ParseRtpBuffer(buffer, size, hdr, payloadBuffer, payloadSize))
+    {
+        return (false);
+    }
+
+    info.ts          = pbsd_ntoh32(hdr.ts);
+    info.ssrc        = pbsd_ntoh32(hdr.ssrc);
+    info.seq         = pbsd_ntoh16(hdr.seq);
+    info.payloadSize = payloadSize;
+    info.pt          = (char)hdr.pt;
+    info.marker      = hdr.m != 0;
+    info.valid       = true;
+
+    if (payloadBuffer != NULL)
+    {
+        info.payloadOffset = (PRO_UINT16)(payloadBuffer - buffer);
+    }
+
+    return (true);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -302,6 +493,104 @@ CRtpPacket::ParseExtBuffer(const char* buffer,
     return (true);
 }
 
+unsigned long
+CRtpPacket::ParseRtpBuffers(const char* const buffers[],
+                            const PRO_UINT16  sizes[],
+                            unsigned long     count,
+                            RTP_STREAM_INFO   infos[])
+{
+    assert(buffers != NULL);
+    assert(sizes != NULL);
+    assert(infos != NULL);
+    if (buffers == NULL || sizes == NULL || infos == NULL)
+    {
+        return (0);
+    }
+
+    unsigned long validCount = 0;
+    unsigned long i          = 0;
+
+#if defined(RTP_PARSE_LANES)
+
+    RTP_PARSE_GROUP group;
+
+    for (; i + RTP_PARSE_LANES <= count; i += RTP_PARSE_LANES)
+    {
+        int j = 0;
+
+        for (j = 0; j < RTP_PARSE_LANES; ++j)
+        {
+            const char* const buffer = buffers[i + j];
+            const PRO_UINT16  size   = sizes[i + j];
+
+            if (buffer != NULL && size >= sizeof(RTP_HEADER))
+            {
+                memcpy(&group.w0[j]  , buffer    , 4);
+                memcpy(&group.ts[j]  , buffer + 4, 4);
+                memcpy(&group.ssrc[j], buffer + 8, 4);
+            }
+            else
+            {
+                group.w0[j]   = 0; /* v == 0 */
+                group.ts[j]   = 0;
+                group.ssrc[j] = 0;
+            }
+
+            group.size[j] = size;
+        }
+
+        ParseGroup_i(group);
+
+        for (j = 0; j < RTP_PARSE_LANES; ++j)
+        {
+            RTP_STREAM_INFO& info = infos[i + j];
+
+            if (group.ok[j] == 0)
+            {
+                if ((group.w0[j] & 0xC0) != 0x80) /* v != 2 */
+                {
+                    memset(&info, 0, sizeof(RTP_STREAM_INFO));
+                }
+                else if (ParseOne_i(buffers[i + j], sizes[i + j], info))
+                {
+                    ++validCount;
+                }
+                else
+                {
+                }
+                continue;
+            }
+
+            const PRO_UINT16 payloadSize =
+                (PRO_UINT16)(group.size[j] - group.hdrSize[j]);
+
+            info.ts            = group.ts[j];
+            info.ssrc          = group.ssrc[j];
+            info.seq           = (PRO_UINT16)group.seq[j];
+            info.payloadOffset = payloadSize > 0 ? (PRO_UINT16)group.hdrSize[j] : 0;
+            info.payloadSize   = payloadSize;
+            info.pt            = (char)(group.mpt[j] & 0x7F);
+            info.marker        = (group.mpt[j] & 0x80) != 0;
+            info.valid         = true;
+            memset(info.reserved, 0, sizeof(info.reserved));
+
+            ++validCount;
+        }
+    }
+
+#endif /* RTP_PARSE_LANES */
+
+    for (; i < count; ++i)
+    {
+        if (ParseOne_i(buffers[i], sizes[i], infos[i]))
+        {
+            ++validCount;
+        }
+    }
+
+    return (validCount);
+}
+
 CRtpPacket::CRtpPacket(RTP_EXT_PACK_MODE packMode)
 : m_packMode(packMode)
 {
@@ -109,7 +109,7 @@ struct RTP_PACKET
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-class CRtpPacket : public IRtpPacket, public CProRefCount
+class CRtpPacket : public IRtpPacket, public IProRefObject, public CProRefCount
 {
 public:
 
@@ -139,6 +139,17 @@ public:
         PRO_UINT16  size
         );
 
+    /*
+     * the common buffers (no padding, no extension) are checked in SIMD
+     * lanes, and the others are parsed by ParseRtpBuffer()
+     */
+    static unsigned long ParseRtpBuffers(
+        const char* const buffers[],
+        const PRO_UINT16  sizes[],
+        unsigned long     count,
+        RTP_STREAM_INFO   infos[]
+        );
+
     virtual unsigned long PRO_CALLTYPE AddRef();
 
     virtual unsigned long PRO_CALLTYPE Release();
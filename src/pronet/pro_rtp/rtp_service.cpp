@@ -19,6 +19,7 @@
 #include "rtp_service.h"
 #include "rtp_base.h"
 #include "rtp_packet.h"
+#include "rtp_session_tcpserver_ex.h"
 #include "../pro_net/pro_net.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_memory_pool.h"
@@ -114,10 +115,10 @@ CRtpService::Init(IRtpServiceObserver* observer,
 void
 CRtpService::Fini()
 {
-    IRtpServiceObserver*                      observer    = NULL;
-    IProServiceHost*                          serviceHost = NULL;
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE> tcpHandshaker2Nonce;
-    CProStlMap<IProSslHandshaker*, PRO_NONCE> sslHandshaker2Nonce;
+    IRtpServiceObserver*                          observer    = NULL;
+    IProServiceHost*                              serviceHost = NULL;
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE> tcpHandshaker2Nonce;
+    CProStlHashMap<IProSslHandshaker*, PRO_NONCE> sslHandshaker2Nonce;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -139,8 +140,8 @@ CRtpService::Fini()
     }
 
     {
-        CProStlMap<IProSslHandshaker*, PRO_NONCE>::iterator       itr = sslHandshaker2Nonce.begin();
-        CProStlMap<IProSslHandshaker*, PRO_NONCE>::iterator const end = sslHandshaker2Nonce.end();
+        CProStlHashMap<IProSslHandshaker*, PRO_NONCE>::iterator       itr = sslHandshaker2Nonce.begin();
+        CProStlHashMap<IProSslHandshaker*, PRO_NONCE>::iterator const end = sslHandshaker2Nonce.end();
 
         for (; itr != end; ++itr)
         {
@@ -149,8 +150,8 @@ CRtpService::Fini()
     }
 
     {
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator       itr = tcpHandshaker2Nonce.begin();
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const end = tcpHandshaker2Nonce.end();
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator       itr = tcpHandshaker2Nonce.begin();
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const end = tcpHandshaker2Nonce.end();
 
         for (; itr != end; ++itr)
         {
@@ -325,7 +326,7 @@ CRtpService::OnHandshakeOk(IProTcpHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
             m_tcpHandshaker2Nonce.find(handshaker);
         if (itr == m_tcpHandshaker2Nonce.end())
         {
@@ -405,6 +406,17 @@ CRtpService::OnHandshakeOk(IProTcpHandshaker* handshaker,
         {
             ProCloseSockId(sockId);
         }
+        else if (remoteInfo.sessionType == RTP_ST_TCPCLIENT_EX &&
+                 !IsZeroRtpToken(remoteInfo.resumeId))
+        {
+            /*
+             * a resume. it's attached to the session of the token, with no
+             * password and no OnAcceptSession(...). the mac over the nonce
+             * stands for the password
+             */
+            CRtpSessionTcpserverEx::Resume(
+                m_mmType, sockId, unixSocket, remoteInfo, nonce);
+        }
         else
         {
             observer->OnAcceptSession(
@@ -441,7 +453,7 @@ CRtpService::OnHandshakeError(IProTcpHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProTcpHandshaker*, PRO_NONCE>::iterator const itr =
             m_tcpHandshaker2Nonce.find(handshaker);
         if (itr == m_tcpHandshaker2Nonce.end())
         {
@@ -486,7 +498,7 @@ CRtpService::OnHandshakeOk(IProSslHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProSslHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProSslHandshaker*, PRO_NONCE>::iterator const itr =
             m_sslHandshaker2Nonce.find(handshaker);
         if (itr == m_sslHandshaker2Nonce.end())
         {
@@ -611,7 +623,7 @@ CRtpService::OnHandshakeError(IProSslHandshaker* handshaker,
             return;
         }
 
-        CProStlMap<IProSslHandshaker*, PRO_NONCE>::iterator const itr =
+        CProStlHashMap<IProSslHandshaker*, PRO_NONCE>::iterator const itr =
             m_sslHandshaker2Nonce.find(handshaker);
         if (itr == m_sslHandshaker2Nonce.end())
         {
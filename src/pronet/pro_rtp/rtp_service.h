@@ -106,17 +106,17 @@ private:
 
 private:
 
-    const PRO_SSL_SERVER_CONFIG* const        m_sslConfig;
-    const RTP_MM_TYPE                         m_mmType;
-    IRtpServiceObserver*                      m_observer;
-    IProReactor*                              m_reactor;
-    IProServiceHost*                          m_serviceHost;
-    unsigned long                             m_timeoutInSeconds;
+    const PRO_SSL_SERVER_CONFIG* const            m_sslConfig;
+    const RTP_MM_TYPE                             m_mmType;
+    IRtpServiceObserver*                          m_observer;
+    IProReactor*                                  m_reactor;
+    IProServiceHost*                              m_serviceHost;
+    unsigned long                                 m_timeoutInSeconds;
 
-    CProStlMap<IProTcpHandshaker*, PRO_NONCE> m_tcpHandshaker2Nonce;
-    CProStlMap<IProSslHandshaker*, PRO_NONCE> m_sslHandshaker2Nonce;
+    CProStlHashMap<IProTcpHandshaker*, PRO_NONCE> m_tcpHandshaker2Nonce;
+    CProStlHashMap<IProSslHandshaker*, PRO_NONCE> m_sslHandshaker2Nonce;
 
-    CProThreadMutex                           m_lock;
+    CProThreadMutex                               m_lock;
 
     DECLARE_SGI_POOL(0)
 };
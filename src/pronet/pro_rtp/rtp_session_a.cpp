@@ -18,6 +18,8 @@
 
 #include "rtp_session_a.h"
 #include "rtp_base.h"
+#include "rtp_session_dtlsclient_ex.h"
+#include "rtp_session_dtlsserver_ex.h"
 #include "rtp_session_mcast.h"
 #include "rtp_session_mcast_ex.h"
 #include "rtp_session_sslclient_ex.h"
@@ -371,6 +373,64 @@ CreateRtpSessionMcastEx(IRtpSessionObserver*    observer,
     return (session);
 }
 
+IRtpSession*
+PRO_CALLTYPE
+CreateRtpSessionDtlsclientEx(IRtpSessionObserver*         observer,
+                             IProReactor*                 reactor,
+                             const RTP_SESSION_INFO*      localInfo,
+                             const PRO_SSL_CLIENT_CONFIG* sslConfig,
+                             const char*                  sslSni, /* = NULL */
+                             const char*                  remoteIp,
+                             unsigned short               remotePort,
+                             const char*                  localIp,          /* = NULL */
+                             unsigned long                timeoutInSeconds) /* = 0 */
+{
+    CRtpSessionDtlsclientEx* const session =
+        CRtpSessionDtlsclientEx::CreateInstance(localInfo);
+    if (session == NULL)
+    {
+        return (NULL);
+    }
+
+    if (!session->Init(observer, reactor, sslConfig, sslSni,
+        remoteIp, remotePort, localIp, timeoutInSeconds))
+    {
+        session->Release();
+
+        return (NULL);
+    }
+
+    return (session);
+}
+
+IRtpSession*
+PRO_CALLTYPE
+CreateRtpSessionDtlsserverEx(IRtpSessionObserver*         observer,
+                             IProReactor*                 reactor,
+                             const RTP_SESSION_INFO*      localInfo,
+                             const PRO_SSL_SERVER_CONFIG* sslConfig,
+                             const char*                  localIp,          /* = NULL */
+                             unsigned short               localPort,        /* = 0 */
+                             unsigned long                timeoutInSeconds) /* = 0 */
+{
+    CRtpSessionDtlsserverEx* const session =
+        CRtpSessionDtlsserverEx::CreateInstance(localInfo);
+    if (session == NULL)
+    {
+        return (NULL);
+    }
+
+    if (!session->Init(
+        observer, reactor, sslConfig, localIp, localPort, timeoutInSeconds))
+    {
+        session->Release();
+
+        return (NULL);
+    }
+
+    return (session);
+}
+
 void
 PRO_CALLTYPE
 DeleteRtpSession(IRtpSession* session)
@@ -469,5 +529,19 @@ DeleteRtpSession(IRtpSession* session)
             p->Release();
             break;
         }
+    case RTP_ST_DTLSCLIENT_EX:
+        {
+            CRtpSessionDtlsclientEx* const p = (CRtpSessionDtlsclientEx*)session;
+            p->Fini();
+            p->Release();
+            break;
+        }
+    case RTP_ST_DTLSSERVER_EX:
+        {
+            CRtpSessionDtlsserverEx* const p = (CRtpSessionDtlsserverEx*)session;
+            p->Fini();
+            p->Release();
+            break;
+        }
     } /* end of switch (...) */
 }
@@ -357,6 +357,64 @@ CreateRtpSessionMcastEx(IRtpSessionObserver*    observer,
                         unsigned short          mcastPort = 0,
                         const char*             localIp   = NULL);
 
+/*
+ * : һRTP_ST_DTLSCLIENT_EX͵ĻỰ
+ *
+ * :
+ * observer         : صĿ
+ * reactor          : Ӧ
+ * localInfo        : ỰϢ
+ * sslConfig        : ssl
+ * sslSni           : ssl. Ч, ֤֤
+ * remoteIp         : Զ˵ipַ
+ * remotePort       : Զ˵Ķ˿ں
+ * localIp          : Ҫ󶨵ıipַ. ΪNULL, ϵͳʹ0.0.0.0
+ * timeoutInSeconds : ֳʱ. Ĭ20
+ *
+ * ֵ: ỰNULL
+ *
+ * ˵: sslConfigָĶڻỰһֱЧ
+ */
+IRtpSession*
+PRO_CALLTYPE
+CreateRtpSessionDtlsclientEx(IRtpSessionObserver*         observer,
+                             IProReactor*                 reactor,
+                             const RTP_SESSION_INFO*      localInfo,
+                             const PRO_SSL_CLIENT_CONFIG* sslConfig,
+                             const char*                  sslSni, /* = NULL */
+                             const char*                  remoteIp,
+                             unsigned short               remotePort,
+                             const char*                  localIp          = NULL,
+                             unsigned long                timeoutInSeconds = 0);
+
+/*
+ * : һRTP_ST_DTLSSERVER_EX͵ĻỰ
+ *
+ * :
+ * observer         : صĿ
+ * reactor          : Ӧ
+ * localInfo        : ỰϢ
+ * sslConfig        : ssl
+ * localIp          : Ҫ󶨵ıipַ. ΪNULL, ϵͳʹ0.0.0.0
+ * localPort        : Ҫ󶨵ıض˿ں. Ϊ0, ϵͳһ
+ * timeoutInSeconds : ֳʱ. Ĭ20
+ *
+ * ֵ: ỰNULL
+ *
+ * ˵: sslConfigָĶڻỰһֱЧ
+ *
+ *       ʹIRtpSession::GetLocalPort(...)ȡض˿ں
+ */
+IRtpSession*
+PRO_CALLTYPE
+CreateRtpSessionDtlsserverEx(IRtpSessionObserver*         observer,
+                             IProReactor*                 reactor,
+                             const RTP_SESSION_INFO*      localInfo,
+                             const PRO_SSL_SERVER_CONFIG* sslConfig,
+                             const char*                  localIp          = NULL,
+                             unsigned short               localPort        = 0,
+                             unsigned long                timeoutInSeconds = 0);
+
 /*
  * : ɾһỰ
  *
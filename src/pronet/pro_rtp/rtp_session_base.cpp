@@ -55,28 +55,91 @@ extern CProFileMonitor g_fileMonitor;
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+/*
+ * keeps a packet of any IRtpPacket implementation alive, while the
+ * transport sends from its buffer in place
+ */
+class CRtpPacketHolder : public IProRefObject, public CProRefCount
+{
+public:
+
+    static CRtpPacketHolder* CreateInstance(IRtpPacket* packet)
+    {
+        assert(packet != NULL);
+        if (packet == NULL)
+        {
+            return (NULL);
+        }
+
+        return (new CRtpPacketHolder(packet));
+    }
+
+    virtual unsigned long PRO_CALLTYPE AddRef()
+    {
+        const unsigned long refCount = CProRefCount::AddRef();
+
+        return (refCount);
+    }
+
+    virtual unsigned long PRO_CALLTYPE Release()
+    {
+        const unsigned long refCount = CProRefCount::Release();
+
+        return (refCount);
+    }
+
+private:
+
+    CRtpPacketHolder(IRtpPacket* packet)
+    {
+        packet->AddRef();
+        m_packet = packet;
+    }
+
+    virtual ~CRtpPacketHolder()
+    {
+        m_packet->Release();
+        m_packet = NULL;
+    }
+
+private:
+
+    IRtpPacket* m_packet;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CRtpSessionBase::CRtpSessionBase(bool suspendRecv)
 : m_suspendRecv(suspendRecv)
 {
-    m_magic          = 0;
-    m_observer       = NULL;
-    m_reactor        = NULL;
-    m_trans          = NULL;
-    m_dummySockId    = -1;
-    m_actionId       = 0;
-    m_initTick       = ProGetTickCount64();
-    m_sendTick       = m_initTick;
-    m_onSendTick1    = m_initTick;
-    m_onSendTick2    = m_initTick; /* assert(m_onSendTick2 >= m_onSendTick1) */
-    m_peerAliveTick  = m_initTick;
-    m_timeoutTimerId = 0;
-    m_onOkTimerId    = 0;
-    m_tcpConnected   = false;
-    m_handshakeOk    = false;
-    m_onOkCalled     = false;
-    m_bigPacket      = NULL;
-
-    m_canUpcall      = true;
+    m_magic           = 0;
+    m_observer        = NULL;
+    m_reactor         = NULL;
+    m_trans           = NULL;
+    m_dtlsCtx         = NULL;
+    m_dummySockId     = -1;
+    m_actionId        = 0;
+    m_zcThreshold     = 0;
+    m_initTick        = ProGetTickCount64();
+    m_sendTick        = m_initTick;
+    m_onSendTick1     = m_initTick;
+    m_onSendTick2     = m_initTick; /* assert(m_onSendTick2 >= m_onSendTick1) */
+    m_peerAliveTick   = m_initTick;
+    m_timeoutTimerId  = 0;
+    m_onOkTimerId     = 0;
+    m_tcpConnected    = false;
+    m_handshakeOk     = false;
+    m_onOkCalled      = false;
+    m_detached        = false;
+    m_resendPacket    = false;
+    m_unsentPacket    = NULL;
+    m_unsentOtherSize = 0;
+    m_bigPacket       = NULL;
+
+    m_canUpcall       = true;
 
     memset(&m_info            , 0, sizeof(RTP_SESSION_INFO));
     memset(&m_ack             , 0, sizeof(RTP_SESSION_ACK));
@@ -87,6 +150,11 @@ CRtpSessionBase::CRtpSessionBase(bool suspendRecv)
 
 CRtpSessionBase::~CRtpSessionBase()
 {
+    if (m_unsentPacket != NULL)
+    {
+        m_unsentPacket->Release();
+        m_unsentPacket = NULL;
+    }
     if (m_bigPacket != NULL)
     {
         m_bigPacket->Release();
@@ -164,7 +232,11 @@ CRtpSessionBase::GetSslSuite(char suiteName[64]) const
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_trans != NULL)
+        if (m_dtlsCtx != NULL)
+        {
+            suiteId = ProSslCtx_GetSuite(m_dtlsCtx, suiteName);
+        }
+        else if (m_trans != NULL)
         {
             suiteId = m_trans->GetSslSuite(suiteName);
         }
@@ -343,6 +415,8 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
     case RTP_ST_UDPCLIENT_EX:
     case RTP_ST_UDPSERVER_EX:
     case RTP_ST_MCAST_EX:
+    case RTP_ST_DTLSCLIENT_EX:
+    case RTP_ST_DTLSSERVER_EX:
         {
             otherSize = sizeof(RTP_EXT) + sizeof(RTP_HEADER);
             break;
@@ -379,8 +453,21 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_observer == NULL || m_reactor == NULL || m_trans == NULL)
+        if (m_observer == NULL || m_reactor == NULL)
+        {
+            return (false);
+        }
+
+        if (m_trans == NULL)
         {
+            /*
+             * keep the packet in the bucket until the session is resumed
+             */
+            if (m_detached && tryAgain != NULL)
+            {
+                *tryAgain = true;
+            }
+
             return (false);
         }
 
@@ -394,6 +481,20 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
             return (false);
         }
 
+        /*
+         * the packet that the dropped transport didn't finish goes first
+         */
+        if (m_resendPacket)
+        {
+            SendUnsentPacket();
+            if (tryAgain != NULL)
+            {
+                *tryAgain = true;
+            }
+
+            return (false);
+        }
+
         assert(
             m_info.outSrcMmId == 0 ||
             packet->GetMmId() == m_info.outSrcMmId
@@ -441,7 +542,24 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
             {
             }
         }
-        else
+        else if (m_dtlsCtx != NULL)
+        {
+            /*
+             * one record, one datagram
+             */
+            ret = ProSslCtx_DtlsSend(
+                m_dtlsCtx,
+                (char*)packet->GetPayloadBuffer() - otherSize,
+                packet->GetPayloadSize() + otherSize
+                );
+            if (!ret && tryAgain != NULL)
+            {
+                *tryAgain = true;
+            }
+        }
+        else if (m_info.sessionType == RTP_ST_UDPCLIENT_EX ||
+                 m_info.sessionType == RTP_ST_UDPSERVER_EX ||
+                 m_info.sessionType == RTP_ST_MCAST_EX)
         {
             ret = m_trans->SendData(
                 (char*)packet->GetPayloadBuffer() - otherSize,
@@ -454,6 +572,38 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
                 *tryAgain = true;
             }
         }
+        else if (m_zcThreshold > 0 &&
+            packet->GetPayloadSize() + otherSize >= m_zcThreshold)
+        {
+            /*
+             * the holder keeps the packet, while it is sent in place
+             */
+            CRtpPacketHolder* const holder =
+                CRtpPacketHolder::CreateInstance(packet);
+            ret = m_trans->SendDataZeroCopy(
+                (char*)packet->GetPayloadBuffer() - otherSize,
+                packet->GetPayloadSize() + otherSize,
+                holder,
+                m_actionId + 1
+                );
+            holder->Release();
+            if (!ret && tryAgain != NULL)
+            {
+                *tryAgain = true;
+            }
+        }
+        else
+        {
+            ret = m_trans->SendData(
+                (char*)packet->GetPayloadBuffer() - otherSize,
+                packet->GetPayloadSize() + otherSize,
+                m_actionId + 1
+                );
+            if (!ret && tryAgain != NULL)
+            {
+                *tryAgain = true;
+            }
+        }
 
         m_sendTick = ProGetTickCount64();
 
@@ -471,12 +621,54 @@ CRtpSessionBase::SendPacket(IRtpPacket* packet,
                 m_onSendTick1 = m_sendTick;
                 m_onSendTick2 = m_sendTick - 1; /* assert(m_onSendTick2 < m_onSendTick1) */
             }
+
+            /*
+             * a resumed session sends it again, if the dropped transport
+             * didn't write all of it
+             */
+            if (m_info.sessionType == RTP_ST_TCPCLIENT_EX ||
+                m_info.sessionType == RTP_ST_TCPSERVER_EX)
+            {
+                packet->AddRef();
+                if (m_unsentPacket != NULL)
+                {
+                    m_unsentPacket->Release();
+                }
+                m_unsentPacket    = packet;
+                m_unsentOtherSize = otherSize;
+            }
         }
     }
 
     return (ret);
 }
 
+bool
+CRtpSessionBase::SendUnsentPacket()
+{
+    assert(m_unsentPacket != NULL);
+    if (m_trans == NULL || m_unsentPacket == NULL)
+    {
+        return (false);
+    }
+
+    const bool ret = m_trans->SendData(
+        (char*)m_unsentPacket->GetPayloadBuffer() - m_unsentOtherSize,
+        m_unsentPacket->GetPayloadSize() + m_unsentOtherSize,
+        m_actionId + 1
+        );
+    if (ret)
+    {
+        ++m_actionId;
+        m_sendTick     = ProGetTickCount64();
+        m_onSendTick1  = m_sendTick;
+        m_onSendTick2  = m_sendTick - 1; /* assert(m_onSendTick2 < m_onSendTick1) */
+        m_resendPacket = false;
+    }
+
+    return (ret);
+}
+
 void
 PRO_CALLTYPE
 CRtpSessionBase::GetSendOnSendTick(PRO_INT64* onSendTick1,       /* = NULL */
@@ -615,11 +807,22 @@ CRtpSessionBase::OnSend(IProTransport* trans,
                 if (actionId > 0 && actionId == m_actionId)
                 {
                     m_onSendTick2 = ProGetTickCount64();
+
+                    if (m_unsentPacket != NULL)
+                    {
+                        m_unsentPacket->Release();
+                        m_unsentPacket = NULL;
+                    }
                 }
                 break;
             }
         }
 
+        if (m_resendPacket)
+        {
+            SendUnsentPacket();
+        }
+
         m_observer->AddRef();
         observer = m_observer;
     }
@@ -665,7 +868,7 @@ CRtpSessionBase::OnClose(IProTransport* trans,
         observer = m_observer;
     }
 
-    if (m_canUpcall)
+    if (m_canUpcall && !DoDetach(errorCode))
     {
         m_canUpcall = false;
         observer->OnCloseSession(this, errorCode, sslCode, m_tcpConnected);
@@ -673,7 +876,10 @@ CRtpSessionBase::OnClose(IProTransport* trans,
 
     observer->Release();
 
-    Fini();
+    if (!m_canUpcall)
+    {
+        Fini();
+    }
 }}
 
 void
@@ -731,7 +937,14 @@ CRtpSessionBase::OnHeartbeat(IProTransport* trans)
             }
 
             char suiteName[64] = "";
-            m_trans->GetSslSuite(suiteName);
+            if (m_dtlsCtx != NULL)
+            {
+                ProSslCtx_GetSuite(m_dtlsCtx, suiteName);
+            }
+            else
+            {
+                m_trans->GetSslSuite(suiteName);
+            }
 
             char localIp[64]        = "";
             char remoteIp[64]       = "";
@@ -1152,6 +1365,15 @@ CRtpSessionBase::OnHeartbeat(IProTransport* trans)
                 m_trans->SendData(&ext, sizeof(RTP_EXT));
                 break;
             }
+        case RTP_ST_DTLSCLIENT_EX:
+        case RTP_ST_DTLSSERVER_EX:
+            {
+                RTP_EXT ext;
+                memset(&ext, 0, sizeof(RTP_EXT));
+                ext.mmType = m_info.mmType;
+                ProSslCtx_DtlsSend(m_dtlsCtx, &ext, sizeof(RTP_EXT));
+                break;
+            }
         case RTP_ST_TCPCLIENT_EX:
         case RTP_ST_TCPSERVER_EX:
         case RTP_ST_SSLCLIENT_EX:
@@ -1196,8 +1418,11 @@ CRtpSessionBase::OnHeartbeat(IProTransport* trans)
         if (tick - peerAliveTick >=
             (PRO_INT64)GetRtpKeepaliveTimeout() * 1000)
         {
-            m_canUpcall = false;
-            observer->OnCloseSession(this, PBSD_ETIMEDOUT, 0, m_tcpConnected);
+            if (!DoDetach(PBSD_ETIMEDOUT))
+            {
+                m_canUpcall = false;
+                observer->OnCloseSession(this, PBSD_ETIMEDOUT, 0, m_tcpConnected);
+            }
         }
         else
         {
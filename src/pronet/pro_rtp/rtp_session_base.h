@@ -40,6 +40,51 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/*
+ * the resume of tcp_ex. the token never goes back on the wire, the client
+ * sends the id of the token and a mac over the nonce of the new connection,
+ * and the server answers with a mac of its own. the mac is bound to the
+ * ack data, which carries the user identity of the session
+ */
+
+extern
+bool
+PRO_CALLTYPE
+IsZeroRtpToken(const char token[16]);
+
+extern
+bool
+PRO_CALLTYPE
+MakeRtpResumeToken(char token[16]);
+
+extern
+void
+PRO_CALLTYPE
+CalcRtpResumeId(const char token[16],
+                char       resumeId[16]);
+
+extern
+void
+PRO_CALLTYPE
+CalcRtpResumeMac(const char        token[16],
+                 char              role, /* 'c' or 's' */
+                 const PRO_NONCE&  nonce,
+                 const char        userData[64],
+                 RTP_MM_TYPE       mmType,
+                 RTP_EXT_PACK_MODE packMode,
+                 char              mac[16]);
+
+#if defined(__cplusplus)
+} /* extern "C" */
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 class CRtpSessionBase
 :
 public IRtpSession,
@@ -215,6 +260,21 @@ protected:
     {
     }
 
+    /*
+     * for tcp_ex. true if the transport is dropped and the session waits
+     * for a resume, instead of being closed
+     */
+    virtual bool DoDetach(long errorCode)
+    {
+        return (false);
+    }
+
+    /*
+     * for tcp_ex. sends the packet that a dropped transport didn't finish
+     * again, on the transport of the resume. call it with m_lock held
+     */
+    bool SendUnsentPacket();
+
 protected:
 
     const bool              m_suspendRecv;
@@ -224,11 +284,13 @@ protected:
     IRtpSessionObserver*    m_observer;
     IProReactor*            m_reactor;
     IProTransport*          m_trans;
+    PRO_SSL_CTX*            m_dtlsCtx;          /* for dtls_ex */
     pbsd_sockaddr_in        m_localAddr;
     pbsd_sockaddr_in        m_remoteAddr;
     pbsd_sockaddr_in        m_remoteAddrConfig; /* for udp */
     PRO_INT64               m_dummySockId;
     PRO_UINT64              m_actionId;
+    unsigned long           m_zcThreshold;      /* for tcp, tcp_ex */
     PRO_INT64               m_initTick;
     PRO_INT64               m_sendTick;
     PRO_INT64               m_onSendTick1;      /* for tcp, tcp_ex, ssl_ex */
@@ -239,6 +301,10 @@ protected:
     bool                    m_tcpConnected;     /* for tcp, tcp_ex, ssl_ex */
     bool                    m_handshakeOk;      /* for udp_ex, tcp_ex, ssl_ex */
     bool                    m_onOkCalled;
+    bool                    m_detached;         /* for tcp_ex */
+    bool                    m_resendPacket;     /* for tcp_ex */
+    IRtpPacket*             m_unsentPacket;     /* for tcp_ex */
+    PRO_UINT16              m_unsentOtherSize;  /* for tcp_ex */
     CRtpPacket*             m_bigPacket;
     mutable CProThreadMutex m_lock;
 
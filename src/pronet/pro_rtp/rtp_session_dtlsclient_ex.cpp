@@ -0,0 +1,494 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#include "rtp_session_dtlsclient_ex.h"
+#include "rtp_packet.h"
+#include "rtp_session_base.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define MAX_TRY_TIMES        100
+#define HANDSHAKE_TIMER_MS   100
+#define DEFAULT_TIMEOUT      20
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CRtpSessionDtlsclientEx*
+CRtpSessionDtlsclientEx::CreateInstance(const RTP_SESSION_INFO* localInfo)
+{
+    assert(localInfo != NULL);
+    assert(localInfo->mmType != 0);
+    if (localInfo == NULL || localInfo->mmType == 0)
+    {
+        return (NULL);
+    }
+
+    CRtpSessionDtlsclientEx* const session =
+        new CRtpSessionDtlsclientEx(*localInfo);
+
+    return (session);
+}
+
+CRtpSessionDtlsclientEx::CRtpSessionDtlsclientEx(const RTP_SESSION_INFO& localInfo)
+: CRtpSessionBase(false)
+{
+    m_info               = localInfo;
+    m_info.localVersion  = RTP_SESSION_PROTOCOL_VERSION;
+    m_info.remoteVersion = 0;
+    m_info.sessionType   = RTP_ST_DTLSCLIENT_EX;
+
+    m_handshakeTimerId   = 0;
+}
+
+CRtpSessionDtlsclientEx::~CRtpSessionDtlsclientEx()
+{
+    Fini();
+}
+
+bool
+CRtpSessionDtlsclientEx::Init(IRtpSessionObserver*         observer,
+                              IProReactor*                 reactor,
+                              const PRO_SSL_CLIENT_CONFIG* sslConfig,
+                              const char*                  sslSni,           /* = NULL */
+                              const char*                  remoteIp,
+                              unsigned short               remotePort,
+                              const char*                  localIp,          /* = NULL */
+                              unsigned long                timeoutInSeconds) /* = 0 */
+{
+    assert(observer != NULL);
+    assert(reactor != NULL);
+    assert(sslConfig != NULL);
+    assert(remoteIp != NULL);
+    assert(remoteIp[0] != '\0');
+    assert(remotePort > 0);
+    if (observer == NULL || reactor == NULL || sslConfig == NULL ||
+        remoteIp == NULL || remoteIp[0] == '\0' || remotePort == 0)
+    {
+        return (false);
+    }
+
+    if (timeoutInSeconds == 0)
+    {
+        timeoutInSeconds = DEFAULT_TIMEOUT;
+    }
+
+    unsigned long sockBufSizeRecv = 0;
+    unsigned long sockBufSizeSend = 0;
+    unsigned long recvPoolSize    = 0;
+    GetRtpUdpSocketParams(
+        m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_observer == NULL);
+        assert(m_reactor == NULL);
+        assert(m_trans == NULL);
+        assert(m_dtlsCtx == NULL);
+        if (m_observer != NULL || m_reactor != NULL || m_trans != NULL ||
+            m_dtlsCtx != NULL)
+        {
+            return (false);
+        }
+
+        for (int i = 0; i < MAX_TRY_TIMES; ++i)
+        {
+            m_trans = ProCreateUdpTransport(
+                this, reactor, localIp, AllocRtpUdpPort(), sockBufSizeRecv,
+                sockBufSizeSend, recvPoolSize, remoteIp, remotePort);
+            if (m_trans != NULL)
+            {
+                break;
+            }
+        }
+
+        if (m_trans == NULL)
+        {
+            return (false);
+        }
+
+        char theIp[64] = "";
+        m_localAddr.sin_family       = AF_INET;
+        m_localAddr.sin_port         = pbsd_hton16(m_trans->GetLocalPort());
+        m_localAddr.sin_addr.s_addr  = pbsd_inet_aton(m_trans->GetLocalIp(theIp));
+        m_remoteAddr.sin_family      = AF_INET;
+        m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
+        m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
+
+        observer->AddRef();
+        m_observer = observer;
+        m_reactor  = reactor;
+
+        m_dtlsCtx = ProSslCtx_CreateDtlsc(sslConfig, sslSni, m_trans);
+        if (m_dtlsCtx == NULL)
+        {
+            goto EXIT;
+        }
+
+        /*
+         * send the ClientHello
+         */
+        if (ProSslCtx_DtlsHandshake(m_dtlsCtx, NULL, 0, NULL) < 0)
+        {
+            goto EXIT;
+        }
+
+        m_trans->StartHeartbeat();
+
+        m_timeoutTimerId   = reactor->ScheduleTimer(this, (PRO_UINT64)timeoutInSeconds * 1000, false);
+        m_handshakeTimerId = reactor->ScheduleTimer(this, HANDSHAKE_TIMER_MS, true);
+    }
+
+    return (true);
+
+EXIT:
+
+    Fini();
+
+    return (false);
+}
+
+void
+CRtpSessionDtlsclientEx::Fini()
+{
+    IRtpSessionObserver* observer = NULL;
+    IProTransport*       trans    = NULL;
+    PRO_SSL_CTX*         ctx      = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL)
+        {
+            return;
+        }
+
+        m_reactor->CancelTimer(m_timeoutTimerId);
+        m_reactor->CancelTimer(m_handshakeTimerId);
+        m_timeoutTimerId   = 0;
+        m_handshakeTimerId = 0;
+
+        ctx = m_dtlsCtx;
+        m_dtlsCtx = NULL;
+        trans = m_trans;
+        m_trans = NULL;
+        m_reactor = NULL;
+        observer = m_observer;
+        m_observer = NULL;
+    }
+
+    ProDeleteTransport(trans);
+    ProSslCtx_Delete(ctx);
+    observer->Release();
+}
+
+void
+PRO_CALLTYPE
+CRtpSessionDtlsclientEx::OnRecv(IProTransport*          trans,
+                                const pbsd_sockaddr_in* remoteAddr)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    assert(trans != NULL);
+    assert(remoteAddr != NULL);
+    if (trans == NULL || remoteAddr == NULL)
+    {
+        return;
+    }
+
+    IRtpSessionObserver*       observer = NULL;
+    CProStlVector<CRtpPacket*> packets;
+    long                       sslCode  = 0;
+    bool                       error    = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL || m_trans == NULL ||
+            m_dtlsCtx == NULL)
+        {
+            return;
+        }
+
+        if (trans != m_trans)
+        {
+            return;
+        }
+
+        IProRecvPool&       recvPool = *m_trans->GetRecvPool();
+        const unsigned long dataSize = recvPool.PeekDataSize();
+
+        if (dataSize == 0)
+        {
+            return;
+        }
+
+        /*
+         * the client talks to the configured address only, and the server
+         * to the one that has finished the handshake
+         */
+        if (
+            (m_info.sessionType == RTP_ST_DTLSCLIENT_EX || m_handshakeOk)
+            &&
+            (remoteAddr->sin_addr.s_addr != m_remoteAddr.sin_addr.s_addr ||
+             remoteAddr->sin_port        != m_remoteAddr.sin_port)
+           )
+        {
+            recvPool.Flush(dataSize);
+
+            return;
+        }
+
+        /*
+         * the second half receives the plaintext, which is never larger
+         * than the datagram
+         */
+        char* const buffer = (char*)ProMalloc(dataSize * 2);
+        if (buffer == NULL)
+        {
+            recvPool.Flush(dataSize);
+
+            return;
+        }
+
+        recvPool.PeekData(buffer, dataSize);
+        recvPool.Flush(dataSize);
+
+        if (!m_handshakeOk)
+        {
+            const long ret = ProSslCtx_DtlsHandshake(
+                m_dtlsCtx, buffer, dataSize, remoteAddr);
+            if (ret < 0)
+            {
+                sslCode = ret;
+                error   = true;
+            }
+            else if (ret > 0)
+            {
+                if (m_info.sessionType == RTP_ST_DTLSSERVER_EX)
+                {
+                    m_remoteAddr = *remoteAddr; /* bind */
+                }
+
+                m_peerAliveTick = ProGetTickCount64();
+                m_handshakeOk   = true;
+
+                m_reactor->CancelTimer(m_timeoutTimerId);
+                m_reactor->CancelTimer(m_handshakeTimerId);
+                m_timeoutTimerId   = 0;
+                m_handshakeTimerId = 0;
+
+                /*
+                 * Activate ECONNRESET event
+                 */
+                m_trans->UdpConnResetAsError(&m_remoteAddr);
+            }
+            else
+            {
+            }
+        }
+        else
+        {
+            char* const plain    = buffer + dataSize;
+            const char* datagram = buffer;
+
+            while (1)
+            {
+                const long size = ProSslCtx_DtlsRecv(
+                    m_dtlsCtx, datagram, dataSize, remoteAddr, plain, dataSize);
+                datagram = NULL; /* the rest records of the datagram */
+
+                if (size < 0)
+                {
+                    sslCode = size;
+                    error   = true;
+                    break;
+                }
+
+                if (size == 0)
+                {
+                    break;
+                }
+
+                m_peerAliveTick = ProGetTickCount64();
+
+                CRtpPacket* const packet = UnpackRecord(plain, size);
+                if (packet != NULL)
+                {
+                    packets.push_back(packet);
+                }
+            }
+        }
+
+        ProFree(buffer);
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        if (error)
+        {
+            m_canUpcall = false;
+            observer->OnCloseSession(this, -1, sslCode, m_tcpConnected);
+        }
+        else if (m_handshakeOk)
+        {
+            if (!m_onOkCalled)
+            {
+                m_onOkCalled = true;
+                observer->OnOkSession(this);
+            }
+
+            for (int i = 0; i < (int)packets.size(); ++i)
+            {
+                observer->OnRecvSession(this, packets[i]);
+            }
+        }
+        else
+        {
+        }
+    }
+
+    for (int i = 0; i < (int)packets.size(); ++i)
+    {
+        packets[i]->Release();
+    }
+
+    observer->Release();
+
+    if (!m_canUpcall)
+    {
+        Fini();
+    }
+}}
+
+void
+PRO_CALLTYPE
+CRtpSessionDtlsclientEx::OnTimer(void*      factory,
+                                 PRO_UINT64 timerId,
+                                 PRO_INT64  userData)
+{
+    CRtpSessionBase::OnTimer(factory, timerId, userData);
+
+    assert(factory != NULL);
+    assert(timerId > 0);
+    if (factory == NULL || timerId == 0)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL || m_dtlsCtx == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_handshakeTimerId)
+        {
+            return;
+        }
+
+        if (!m_handshakeOk)
+        {
+            /*
+             * retransmit the last flight if its timer has expired. a broken
+             * handshake is left to the timeout timer
+             */
+            ProSslCtx_DtlsHandshake(m_dtlsCtx, NULL, 0, NULL);
+        }
+        else
+        {
+            m_reactor->CancelTimer(m_handshakeTimerId);
+            m_handshakeTimerId = 0;
+        }
+    }
+}
+
+CRtpPacket*
+CRtpSessionDtlsclientEx::UnpackRecord(const char*   buffer,
+                                      unsigned long size) const
+{
+    if (size < sizeof(RTP_EXT) || size > 65535)
+    {
+        return (NULL);
+    }
+
+    RTP_EXT ext;
+    memcpy(&ext, buffer, sizeof(RTP_EXT));
+    ext.hdrAndPayloadSize = pbsd_ntoh16(ext.hdrAndPayloadSize);
+
+    /*
+     * a heartbeat, or not a single rtp packet
+     */
+    if (ext.hdrAndPayloadSize == 0 ||
+        sizeof(RTP_EXT) + ext.hdrAndPayloadSize != size || ext.udpxSync)
+    {
+        return (NULL);
+    }
+
+    if (!CRtpPacket::ParseExtBuffer(buffer, (PRO_UINT16)size))
+    {
+        return (NULL);
+    }
+
+    CRtpPacket* const packet = CRtpPacket::CreateInstance(size, RTP_EPM_DEFAULT);
+    if (packet == NULL)
+    {
+        return (NULL);
+    }
+
+    memcpy(packet->GetPayloadBuffer(), buffer, size);
+
+    RTP_PACKET& magicPacket = packet->GetPacket();
+
+    magicPacket.ext = (RTP_EXT*)packet->GetPayloadBuffer();
+    magicPacket.hdr = (RTP_HEADER*)(magicPacket.ext + 1);
+
+    assert(
+        m_info.inSrcMmId  == 0 ||
+        packet->GetMmId() == m_info.inSrcMmId
+        );
+    assert(packet->GetMmType() == m_info.mmType);
+    if (
+        (m_info.inSrcMmId  != 0 &&
+         packet->GetMmId() != m_info.inSrcMmId)
+        ||
+        packet->GetMmType() != m_info.mmType /* drop this packet */
+       )
+    {
+        packet->Release();
+
+        return (NULL);
+    }
+
+    return (packet);
+}
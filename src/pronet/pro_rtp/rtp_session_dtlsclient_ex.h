@@ -0,0 +1,83 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#if !defined(RTP_SESSION_DTLSCLIENT_EX_H)
+#define RTP_SESSION_DTLSCLIENT_EX_H
+
+#include "rtp_session_base.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CRtpSessionDtlsclientEx : public CRtpSessionBase
+{
+public:
+
+    static CRtpSessionDtlsclientEx* CreateInstance(
+        const RTP_SESSION_INFO* localInfo
+        );
+
+    bool Init(
+        IRtpSessionObserver*         observer,
+        IProReactor*                 reactor,
+        const PRO_SSL_CLIENT_CONFIG* sslConfig,
+        const char*                  sslSni,          /* = NULL */
+        const char*                  remoteIp,
+        unsigned short               remotePort,
+        const char*                  localIp,         /* = NULL */
+        unsigned long                timeoutInSeconds /* = 0 */
+        );
+
+    virtual void Fini();
+
+protected:
+
+    CRtpSessionDtlsclientEx(const RTP_SESSION_INFO& localInfo);
+
+    virtual ~CRtpSessionDtlsclientEx();
+
+private:
+
+    virtual void PRO_CALLTYPE OnRecv(
+        IProTransport*          trans,
+        const pbsd_sockaddr_in* remoteAddr
+        );
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+    CRtpPacket* UnpackRecord(
+        const char*   buffer,
+        unsigned long size
+        ) const;
+
+protected:
+
+    PRO_UINT64 m_handshakeTimerId;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* RTP_SESSION_DTLSCLIENT_EX_H */
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#include "rtp_session_dtlsserver_ex.h"
+#include "rtp_session_base.h"
+#include "rtp_session_dtlsclient_ex.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define MAX_TRY_TIMES        100
+#define HANDSHAKE_TIMER_MS   100
+#define DEFAULT_TIMEOUT      20
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CRtpSessionDtlsserverEx*
+CRtpSessionDtlsserverEx::CreateInstance(const RTP_SESSION_INFO* localInfo)
+{
+    assert(localInfo != NULL);
+    assert(localInfo->mmType != 0);
+    if (localInfo == NULL || localInfo->mmType == 0)
+    {
+        return (NULL);
+    }
+
+    CRtpSessionDtlsserverEx* const session =
+        new CRtpSessionDtlsserverEx(*localInfo);
+
+    return (session);
+}
+
+CRtpSessionDtlsserverEx::CRtpSessionDtlsserverEx(const RTP_SESSION_INFO& localInfo)
+: CRtpSessionDtlsclientEx(localInfo)
+{
+    m_info.sessionType = RTP_ST_DTLSSERVER_EX;
+}
+
+bool
+CRtpSessionDtlsserverEx::Init(IRtpSessionObserver*         observer,
+                              IProReactor*                 reactor,
+                              const PRO_SSL_SERVER_CONFIG* sslConfig,
+                              const char*                  localIp,          /* = NULL */
+                              unsigned short               localPort,        /* = 0 */
+                              unsigned long                timeoutInSeconds) /* = 0 */
+{
+    assert(observer != NULL);
+    assert(reactor != NULL);
+    assert(sslConfig != NULL);
+    if (observer == NULL || reactor == NULL || sslConfig == NULL)
+    {
+        return (false);
+    }
+
+    if (timeoutInSeconds == 0)
+    {
+        timeoutInSeconds = DEFAULT_TIMEOUT;
+    }
+
+    unsigned long sockBufSizeRecv = 0;
+    unsigned long sockBufSizeSend = 0;
+    unsigned long recvPoolSize    = 0;
+    GetRtpUdpSocketParams(
+        m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_observer == NULL);
+        assert(m_reactor == NULL);
+        assert(m_trans == NULL);
+        assert(m_dtlsCtx == NULL);
+        if (m_observer != NULL || m_reactor != NULL || m_trans != NULL ||
+            m_dtlsCtx != NULL)
+        {
+            return (false);
+        }
+
+        int count = MAX_TRY_TIMES;
+        if (localPort > 0)
+        {
+            count = 1;
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            unsigned short localPort2 = localPort;
+            if (localPort2 == 0)
+            {
+                localPort2 = AllocRtpUdpPort();
+            }
+
+            m_trans = ProCreateUdpTransport(
+                this, reactor, localIp, localPort2,
+                sockBufSizeRecv, sockBufSizeSend, recvPoolSize);
+            if (m_trans != NULL)
+            {
+                break;
+            }
+        }
+
+        if (m_trans == NULL)
+        {
+            return (false);
+        }
+
+        char theIp[64] = "";
+        m_localAddr.sin_family      = AF_INET;
+        m_localAddr.sin_port        = pbsd_hton16(m_trans->GetLocalPort());
+        m_localAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetLocalIp(theIp));
+
+        observer->AddRef();
+        m_observer = observer;
+        m_reactor  = reactor;
+
+        /*
+         * the peer is unknown until a ClientHello echoes a valid cookie
+         */
+        m_dtlsCtx = ProSslCtx_CreateDtlss(sslConfig, m_trans);
+        if (m_dtlsCtx == NULL)
+        {
+            goto EXIT;
+        }
+
+        m_trans->StartHeartbeat();
+
+        m_timeoutTimerId   = reactor->ScheduleTimer(this, (PRO_UINT64)timeoutInSeconds * 1000, false);
+        m_handshakeTimerId = reactor->ScheduleTimer(this, HANDSHAKE_TIMER_MS, true);
+    }
+
+    return (true);
+
+EXIT:
+
+    Fini();
+
+    return (false);
+}
@@ -229,6 +229,8 @@ CRtpSessionTcpclient::OnConnectOk(IProConnector*   connector,
     unsigned long recvPoolSize    = 0;
     GetRtpTcpSocketParams(
         m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+    const unsigned long zcThreshold =
+        GetRtpTcpZeroCopyThreshold(m_info.mmType);
 
     IRtpSessionObserver* observer = NULL;
 
@@ -270,6 +272,11 @@ CRtpSessionTcpclient::OnConnectOk(IProConnector*   connector,
             m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
             m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
 
+            if (zcThreshold > 0 && m_trans->EnableZeroCopy(zcThreshold))
+            {
+                m_zcThreshold = zcThreshold;
+            }
+
             m_trans->StartHeartbeat();
         }
 
@@ -31,6 +31,7 @@
 ////
 
 #define DEFAULT_TIMEOUT 20
+#define RESUME_INTERVAL 1
 
 /////////////////////////////////////////////////////////////////////////////
 ////
@@ -80,6 +81,14 @@ m_sslSni(sslSni != NULL ? sslSni : "")
 
     m_password           = "";
     m_timeoutInSeconds   = DEFAULT_TIMEOUT;
+    m_remoteIp           = "";
+    m_remotePort         = 0;
+    m_localIp            = "";
+    m_resumeInSeconds    = 0;
+    m_resumeErrorCode    = 0;
+    m_resumeDeadline     = 0;
+    m_resumeTimerId      = 0;
+    memset(&m_resumeNonce, 0, sizeof(PRO_NONCE));
 
     m_connector          = NULL;
     m_tcpHandshaker      = NULL;
@@ -145,6 +154,10 @@ CRtpSessionTcpclientEx::Init(IRtpSessionObserver* observer,
     pbsd_inet_ntoa(localAddr.sin_addr.s_addr , localIp2);
     pbsd_inet_ntoa(remoteAddr.sin_addr.s_addr, remoteIp2);
 
+    const unsigned long resumeInSeconds =
+        m_info.sessionType == RTP_ST_TCPCLIENT_EX
+        ? GetRtpTcpResumeTimeout(m_info.mmType) : 0;
+
     {
         CProThreadMutexGuard mon(m_lock);
 
@@ -185,6 +198,10 @@ CRtpSessionTcpclientEx::Init(IRtpSessionObserver* observer,
         m_timeoutTimerId   = reactor->ScheduleTimer(this, (PRO_UINT64)timeoutInSeconds * 1000, false);
         m_password         = password != NULL ? password : "";
         m_timeoutInSeconds = timeoutInSeconds;
+        m_remoteIp         = remoteIp2;
+        m_remotePort       = remotePort;
+        m_localIp          = localIp2;
+        m_resumeInSeconds  = resumeInSeconds;
     }
 
     return (true);
@@ -208,7 +225,9 @@ CRtpSessionTcpclientEx::Fini()
         }
 
         m_reactor->CancelTimer(m_timeoutTimerId);
+        m_reactor->CancelTimer(m_resumeTimerId);
         m_timeoutTimerId = 0;
+        m_resumeTimerId  = 0;
 
         if (!m_password.empty())
         {
@@ -276,6 +295,7 @@ CRtpSessionTcpclientEx::OnConnectOk(IProConnector*   connector,
     }
 
     IRtpSessionObserver* observer = NULL;
+    bool                 detached = false;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -294,6 +314,7 @@ CRtpSessionTcpclientEx::OnConnectOk(IProConnector*   connector,
             return;
         }
 
+        detached       = m_detached;
         m_tcpConnected = true;
         assert(m_tcpHandshaker == NULL);
         assert(m_sslHandshaker == NULL);
@@ -310,7 +331,10 @@ CRtpSessionTcpclientEx::OnConnectOk(IProConnector*   connector,
         observer = m_observer;
     }
 
-    if (m_canUpcall)
+    /*
+     * a failed resume is retried by the resume timer
+     */
+    if (m_canUpcall && !detached)
     {
         if (sockId == -1)
         {
@@ -341,6 +365,7 @@ CRtpSessionTcpclientEx::OnConnectError(IProConnector* connector,
     }
 
     IRtpSessionObserver* observer  = NULL;
+    bool                 detached  = false;
     const long           errorCode = timeout ? PBSD_ETIMEDOUT : -1;
 
     {
@@ -356,13 +381,14 @@ CRtpSessionTcpclientEx::OnConnectError(IProConnector* connector,
             return;
         }
 
+        detached    = m_detached;
         m_connector = NULL;
 
         m_observer->AddRef();
         observer = m_observer;
     }
 
-    if (m_canUpcall)
+    if (m_canUpcall && !detached)
     {
         m_canUpcall = false;
         observer->OnCloseSession(this, errorCode, 0, m_tcpConnected);
@@ -394,8 +420,12 @@ CRtpSessionTcpclientEx::OnHandshakeOk(IProTcpHandshaker* handshaker,
     unsigned long recvPoolSize    = 0;
     GetRtpTcpSocketParams(
         m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+    const unsigned long zcThreshold =
+        GetRtpTcpZeroCopyThreshold(m_info.mmType);
 
     IRtpSessionObserver* observer = NULL;
+    bool                 detached = false;
+    bool                 resumed  = false;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -417,6 +447,15 @@ CRtpSessionTcpclientEx::OnHandshakeOk(IProTcpHandshaker* handshaker,
         assert(m_sslConfig == NULL);
         assert(m_trans == NULL);
 
+        detached = m_detached;
+
+        char resumeMac[16];
+        if (detached)
+        {
+            CalcRtpResumeMac(m_ack.resumeToken, 's', m_resumeNonce,
+                m_ack.userData, m_info.mmType, m_info.packMode, resumeMac);
+        }
+
         assert(buf != NULL);
         assert(size == sizeof(RTP_EXT) + sizeof(RTP_HEADER) +
             sizeof(RTP_SESSION_ACK));
@@ -434,17 +473,35 @@ CRtpSessionTcpclientEx::OnHandshakeOk(IProTcpHandshaker* handshaker,
                 ProCloseSockId(sockId);
                 sockId = -1;
             }
+            else if (detached &&
+                memcmp(
+                ((RTP_SESSION_ACK*)((char*)buf + sizeof(RTP_EXT) + sizeof(RTP_HEADER)))->resumeToken,
+                resumeMac,
+                16
+                ) != 0) /* not the session resumed */
+            {
+                ProCloseSockId(sockId);
+                sockId = -1;
+            }
             else
             {
                 /*
-                 * grab the ACK result
+                 * grab the ACK result. the token of a resume is kept, the
+                 * ACK has the mac instead
                  */
+                char resumeToken[16];
+                memcpy(resumeToken, m_ack.resumeToken, 16);
+
                 memcpy(
                     &m_ack,
                     (char*)buf + sizeof(RTP_EXT) + sizeof(RTP_HEADER),
                     sizeof(RTP_SESSION_ACK)
                     );
                 m_ack.version = pbsd_ntoh16(m_ack.version);
+                if (detached)
+                {
+                    memcpy(m_ack.resumeToken, resumeToken, 16);
+                }
 
                 m_info.remoteVersion = m_ack.version;
 
@@ -466,12 +523,27 @@ CRtpSessionTcpclientEx::OnHandshakeOk(IProTcpHandshaker* handshaker,
                     m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
                     m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
 
+                    if (zcThreshold > 0 && m_trans->EnableZeroCopy(zcThreshold))
+                    {
+                        m_zcThreshold = zcThreshold;
+                    }
+
                     m_trans->StartHeartbeat();
 
                     m_handshakeOk = true;
 
                     m_reactor->CancelTimer(m_timeoutTimerId);
                     m_timeoutTimerId = 0;
+
+                    if (detached)
+                    {
+                        m_reactor->CancelTimer(m_resumeTimerId);
+                        m_resumeTimerId = 0;
+                        m_detached      = false;
+                        m_peerAliveTick = ProGetTickCount64();
+
+                        resumed = true;
+                    }
                 }
             }
         }
@@ -486,12 +558,19 @@ CRtpSessionTcpclientEx::OnHandshakeOk(IProTcpHandshaker* handshaker,
     {
         if (sockId == -1)
         {
-            m_canUpcall = false;
-            observer->OnCloseSession(this, -1, 0, m_tcpConnected);
+            if (!detached)
+            {
+                m_canUpcall = false;
+                observer->OnCloseSession(this, -1, 0, m_tcpConnected);
+            }
         }
         else if (m_handshakeOk)
         {
-            if (!m_onOkCalled)
+            /*
+             * on a resume, the wrapper republishes the connection, and the
+             * application doesn't see it
+             */
+            if (!m_onOkCalled || resumed)
             {
                 m_onOkCalled = true;
                 observer->OnOkSession(this);
@@ -520,6 +599,7 @@ CRtpSessionTcpclientEx::OnHandshakeError(IProTcpHandshaker* handshaker,
     }
 
     IRtpSessionObserver* observer = NULL;
+    bool                 detached = false;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -534,13 +614,14 @@ CRtpSessionTcpclientEx::OnHandshakeError(IProTcpHandshaker* handshaker,
             return;
         }
 
+        detached        = m_detached;
         m_tcpHandshaker = NULL;
 
         m_observer->AddRef();
         observer = m_observer;
     }
 
-    if (m_canUpcall)
+    if (m_canUpcall && !detached)
     {
         m_canUpcall = false;
         observer->OnCloseSession(this, errorCode, 0, m_tcpConnected);
@@ -827,6 +908,160 @@ CRtpSessionTcpclientEx::OnRecv(IProTransport*          trans,
     } /* end of while (...) */
 }}
 
+void
+PRO_CALLTYPE
+CRtpSessionTcpclientEx::OnTimer(void*      factory,
+                                PRO_UINT64 timerId,
+                                PRO_INT64  userData)
+{
+    bool resumeTimer = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        resumeTimer = timerId > 0 && timerId == m_resumeTimerId;
+    }
+
+    if (resumeTimer)
+    {
+        OnResumeTimer(timerId);
+    }
+    else
+    {
+        CRtpSessionBase::OnTimer(factory, timerId, userData);
+    }
+}
+
+void
+CRtpSessionTcpclientEx::OnResumeTimer(PRO_UINT64 timerId)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    IRtpSessionObserver* observer  = NULL;
+    long                 errorCode = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_resumeTimerId)
+        {
+            return;
+        }
+
+        if (ProGetTickCount64() < m_resumeDeadline)
+        {
+            if (m_connector == NULL && m_tcpHandshaker == NULL)
+            {
+                DoConnect(); /* try again */
+            }
+
+            return;
+        }
+
+        /*
+         * the grace period is over
+         */
+        m_reactor->CancelTimer(m_resumeTimerId);
+        m_resumeTimerId = 0;
+
+        errorCode = m_resumeErrorCode;
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        m_canUpcall = false;
+        observer->OnCloseSession(this, errorCode, 0, m_tcpConnected);
+    }
+
+    observer->Release();
+
+    if (!m_canUpcall)
+    {
+        Fini();
+    }
+}}
+
+bool
+CRtpSessionTcpclientEx::DoDetach(long errorCode)
+{
+    IProTransport* trans = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL || m_trans == NULL)
+        {
+            return (false);
+        }
+
+        /*
+         * the server issues no token, if it doesn't resume sessions
+         */
+        if (m_resumeInSeconds == 0 || !m_onOkCalled ||
+            IsZeroRtpToken(m_ack.resumeToken))
+        {
+            return (false);
+        }
+
+        if (!DoConnect())
+        {
+            return (false);
+        }
+
+        if (m_bigPacket != NULL)
+        {
+            m_bigPacket->Release();
+            m_bigPacket = NULL;
+        }
+
+        trans = m_trans;
+        m_trans = NULL;
+        m_detached        = true;
+        m_resendPacket    = m_unsentPacket != NULL;
+        m_resumeErrorCode = errorCode;
+        m_resumeDeadline  =
+            ProGetTickCount64() + (PRO_INT64)m_resumeInSeconds * 1000;
+        m_resumeTimerId   = m_reactor->ScheduleTimer(
+            this, RESUME_INTERVAL * 1000, true);
+    }
+
+    ProDeleteTransport(trans);
+
+    return (true);
+}
+
+bool
+CRtpSessionTcpclientEx::DoConnect()
+{
+    assert(m_connector == NULL);
+    if (m_connector != NULL)
+    {
+        return (false);
+    }
+
+    m_connector = ProCreateConnectorEx(
+        true,                /* enable unixSocket */
+        m_info.mmType,       /* serviceId.  [0 for ipc-pipe, !0 for media-link] */
+        m_sslConfig != NULL, /* serviceOpt. [0 for tcp     , !0 for ssl] */
+        this,
+        m_reactor,
+        m_remoteIp.c_str(),
+        m_remotePort,
+        m_localIp.c_str(),
+        m_timeoutInSeconds
+        );
+
+    return (m_connector != NULL);
+}
+
 bool
 CRtpSessionTcpclientEx::Recv0(CRtpPacket*& packet)
 {{
@@ -1102,6 +1337,13 @@ CRtpSessionTcpclientEx::DoHandshake(PRO_INT64        sockId,
     localInfo.outSrcMmId    = pbsd_hton32(localInfo.outSrcMmId);
     ProCalcPasswordHash(
         nonce.nonce, m_password.c_str(), localInfo.passwordHash);
+    if (m_detached)
+    {
+        CalcRtpResumeId(m_ack.resumeToken, localInfo.resumeId);
+        CalcRtpResumeMac(m_ack.resumeToken, 'c', nonce, m_ack.userData,
+            m_info.mmType, m_info.packMode, localInfo.resumeMac);
+        m_resumeNonce = nonce;
+    }
 
     if (!m_password.empty())
     {
@@ -119,6 +119,18 @@ protected:
         const pbsd_sockaddr_in* remoteAddr
         );
 
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+    void OnResumeTimer(PRO_UINT64 timerId);
+
+    virtual bool DoDetach(long errorCode);
+
+    bool DoConnect();
+
     bool Recv0(CRtpPacket*& packet);
 
     bool Recv2(CRtpPacket*& packet);
@@ -137,6 +149,14 @@ private:
     const CProStlString                m_sslSni;
     CProStlString                      m_password;
     unsigned long                      m_timeoutInSeconds;
+    CProStlString                      m_remoteIp;
+    unsigned short                     m_remotePort;
+    CProStlString                      m_localIp;
+    unsigned long                      m_resumeInSeconds; /* 0: not resumable */
+    long                               m_resumeErrorCode;
+    PRO_INT64                          m_resumeDeadline;
+    PRO_UINT64                         m_resumeTimerId;
+    PRO_NONCE                          m_resumeNonce;     /* the nonce of the resume in handshake */
 
     IProConnector*                     m_connector;
     IProTcpHandshaker*                 m_tcpHandshaker;
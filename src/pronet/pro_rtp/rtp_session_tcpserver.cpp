@@ -247,6 +247,8 @@ CRtpSessionTcpserver::OnAccept(IProAcceptor*    acceptor,
     unsigned long recvPoolSize    = 0;
     GetRtpTcpSocketParams(
         m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+    const unsigned long zcThreshold =
+        GetRtpTcpZeroCopyThreshold(m_info.mmType);
 
     IRtpSessionObserver* observer = NULL;
 
@@ -288,6 +290,11 @@ CRtpSessionTcpserver::OnAccept(IProAcceptor*    acceptor,
             m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
             m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
 
+            if (zcThreshold > 0 && m_trans->EnableZeroCopy(zcThreshold))
+            {
+                m_zcThreshold = zcThreshold;
+            }
+
             m_trans->StartHeartbeat();
 
             m_reactor->CancelTimer(m_timeoutTimerId);
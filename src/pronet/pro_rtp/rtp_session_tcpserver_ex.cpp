@@ -20,7 +20,11 @@
 #include "rtp_packet.h"
 #include "rtp_session_base.h"
 #include "../pro_net/pro_net.h"
+#include "../pro_shared/pro_shared.h"
 #include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_ssl_util.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
 #include "../pro_util/pro_time_util.h"
 #include "../pro_util/pro_z.h"
 #include <cassert>
@@ -28,6 +32,12 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+static CProStlMap<CProStlString, CRtpSessionTcpserverEx*> g_s_sessions[256]; /* mmType0 ~ mmType255, resumeId ---> session */
+static CProThreadMutex                                    g_s_lock;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CRtpSessionTcpserverEx*
 CRtpSessionTcpserverEx::CreateInstance(const RTP_SESSION_INFO* localInfo,
                                        bool                    suspendRecv)
@@ -67,6 +77,10 @@ m_sslCtx(sslCtx)
     m_info              = localInfo;
     m_info.localVersion = RTP_SESSION_PROTOCOL_VERSION;
     m_info.sessionType  = RTP_ST_TCPSERVER_EX;
+
+    m_resumeInSeconds   = 0;
+    m_resumeErrorCode   = 0;
+    m_resumeTimerId     = 0;
 }
 
 CRtpSessionTcpserverEx::~CRtpSessionTcpserverEx()
@@ -98,6 +112,10 @@ CRtpSessionTcpserverEx::Init(IRtpSessionObserver* observer,
     unsigned long recvPoolSize    = 0;
     GetRtpTcpSocketParams(
         m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+    const unsigned long zcThreshold =
+        GetRtpTcpZeroCopyThreshold(m_info.mmType);
+    const unsigned long resumeInSeconds =
+        GetRtpTcpResumeTimeout(m_info.mmType);
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -139,6 +157,11 @@ CRtpSessionTcpserverEx::Init(IRtpSessionObserver* observer,
         m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
         m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
 
+        if (zcThreshold > 0 && m_trans->EnableZeroCopy(zcThreshold))
+        {
+            m_zcThreshold = zcThreshold;
+        }
+
         m_trans->StartHeartbeat();
 
         observer->AddRef();
@@ -148,7 +171,33 @@ CRtpSessionTcpserverEx::Init(IRtpSessionObserver* observer,
         m_handshakeOk  = true; /* !!! */
         m_onOkTimerId  = reactor->ScheduleTimer(this, 0, false);
 
-        if (!DoHandshake(useAckData, ackData))
+        m_ack.version = m_info.localVersion;
+        if (useAckData)
+        {
+            memcpy(m_ack.userData, ackData, 64);
+        }
+
+        if (m_info.sessionType == RTP_ST_TCPSERVER_EX && resumeInSeconds > 0)
+        {
+            CProThreadMutexGuard g_mon(g_s_lock);
+
+            CProStlMap<CProStlString, CRtpSessionTcpserverEx*>& sessions =
+                g_s_sessions[m_info.mmType];
+            char resumeId[16];
+
+            while (MakeRtpResumeToken(m_ack.resumeToken))
+            {
+                CalcRtpResumeId(m_ack.resumeToken, resumeId);
+                if (sessions.find(CProStlString(resumeId, 16)) == sessions.end())
+                {
+                    sessions[CProStlString(resumeId, 16)] = this;
+                    m_resumeInSeconds = resumeInSeconds;
+                    break;
+                }
+            }
+        }
+
+        if (!DoHandshake(m_trans))
         {
             m_reactor->CancelTimer(m_onOkTimerId);
             m_onOkTimerId = 0;
@@ -169,8 +218,9 @@ EXIT:
 void
 CRtpSessionTcpserverEx::Fini()
 {
-    IRtpSessionObserver* observer = NULL;
-    IProTransport*       trans    = NULL;
+    IRtpSessionObserver* observer  = NULL;
+    IProTransport*       trans     = NULL;
+    bool                 resumable = false;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -181,7 +231,12 @@ CRtpSessionTcpserverEx::Fini()
         }
 
         m_reactor->CancelTimer(m_onOkTimerId);
-        m_onOkTimerId = 0;
+        m_reactor->CancelTimer(m_resumeTimerId);
+        m_onOkTimerId   = 0;
+        m_resumeTimerId = 0;
+
+        resumable = m_resumeInSeconds > 0;
+        m_resumeInSeconds = 0;
 
         trans = m_trans;
         m_trans = NULL;
@@ -190,10 +245,71 @@ CRtpSessionTcpserverEx::Fini()
         m_observer = NULL;
     }
 
+    if (resumable)
+    {
+        char resumeId[16];
+        CalcRtpResumeId(m_ack.resumeToken, resumeId);
+
+        CProThreadMutexGuard mon(g_s_lock);
+
+        CProStlMap<CProStlString, CRtpSessionTcpserverEx*>& sessions =
+            g_s_sessions[m_info.mmType];
+
+        CProStlMap<CProStlString, CRtpSessionTcpserverEx*>::iterator const itr =
+            sessions.find(CProStlString(resumeId, 16));
+        if (itr != sessions.end() && itr->second == this)
+        {
+            sessions.erase(itr);
+        }
+    }
+
     ProDeleteTransport(trans);
     observer->Release();
 }
 
+bool
+CRtpSessionTcpserverEx::Resume(RTP_MM_TYPE             mmType,
+                               PRO_INT64               sockId,
+                               bool                    unixSocket,
+                               const RTP_SESSION_INFO& remoteInfo,
+                               const PRO_NONCE&        nonce)
+{
+    assert(sockId != -1);
+    if (sockId == -1)
+    {
+        return (false);
+    }
+
+    CRtpSessionTcpserverEx* session = NULL;
+
+    {
+        CProThreadMutexGuard mon(g_s_lock);
+
+        const CProStlMap<CProStlString, CRtpSessionTcpserverEx*>& sessions =
+            g_s_sessions[mmType];
+
+        CProStlMap<CProStlString, CRtpSessionTcpserverEx*>::const_iterator const itr =
+            sessions.find(CProStlString(remoteInfo.resumeId, 16));
+        if (itr != sessions.end())
+        {
+            session = itr->second;
+            session->AddRef();
+        }
+    }
+
+    if (session == NULL)
+    {
+        ProCloseSockId(sockId);
+
+        return (false);
+    }
+
+    const bool ret = session->DoResume(sockId, unixSocket, remoteInfo, nonce);
+    session->Release();
+
+    return (ret);
+}
+
 unsigned long
 PRO_CALLTYPE
 CRtpSessionTcpserverEx::AddRef()
@@ -305,6 +421,244 @@ CRtpSessionTcpserverEx::OnRecv(IProTransport*          trans,
     } /* end of while (...) */
 }}
 
+void
+PRO_CALLTYPE
+CRtpSessionTcpserverEx::OnTimer(void*      factory,
+                                PRO_UINT64 timerId,
+                                PRO_INT64  userData)
+{
+    bool resumeTimer = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        resumeTimer = timerId > 0 && timerId == m_resumeTimerId;
+    }
+
+    if (resumeTimer)
+    {
+        OnResumeTimer(timerId);
+    }
+    else
+    {
+        CRtpSessionBase::OnTimer(factory, timerId, userData);
+    }
+}
+
+void
+CRtpSessionTcpserverEx::OnResumeTimer(PRO_UINT64 timerId)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    IRtpSessionObserver* observer  = NULL;
+    long                 errorCode = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_resumeTimerId)
+        {
+            return;
+        }
+
+        /*
+         * the grace period is over
+         */
+        m_reactor->CancelTimer(m_resumeTimerId);
+        m_resumeTimerId = 0;
+
+        errorCode = m_resumeErrorCode;
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        m_canUpcall = false;
+        observer->OnCloseSession(this, errorCode, 0, m_tcpConnected);
+    }
+
+    observer->Release();
+
+    if (!m_canUpcall)
+    {
+        Fini();
+    }
+}}
+
+bool
+CRtpSessionTcpserverEx::DoDetach(long errorCode)
+{
+    IProTransport* trans = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL || m_trans == NULL)
+        {
+            return (false);
+        }
+
+        if (m_resumeInSeconds == 0 || !m_onOkCalled)
+        {
+            return (false);
+        }
+
+        if (m_bigPacket != NULL)
+        {
+            m_bigPacket->Release();
+            m_bigPacket = NULL;
+        }
+
+        trans = m_trans;
+        m_trans = NULL;
+        m_detached        = true;
+        m_resendPacket    = m_unsentPacket != NULL;
+        m_resumeErrorCode = errorCode;
+        m_resumeTimerId   = m_reactor->ScheduleTimer(
+            this, (PRO_UINT64)m_resumeInSeconds * 1000, false);
+    }
+
+    ProDeleteTransport(trans);
+
+    return (true);
+}
+
+bool
+CRtpSessionTcpserverEx::DoResume(PRO_INT64               sockId,
+                                 bool                    unixSocket,
+                                 const RTP_SESSION_INFO& remoteInfo,
+                                 const PRO_NONCE&        nonce)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    unsigned long sockBufSizeRecv = 0;
+    unsigned long sockBufSizeSend = 0;
+    unsigned long recvPoolSize    = 0;
+    GetRtpTcpSocketParams(
+        m_info.mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+    const unsigned long zcThreshold =
+        GetRtpTcpZeroCopyThreshold(m_info.mmType);
+
+    IRtpSessionObserver* observer = NULL;
+    IProTransport*       trans    = NULL; /* the one to be deleted */
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_reactor == NULL ||
+            m_resumeInSeconds == 0 || !m_onOkCalled)
+        {
+            ProCloseSockId(sockId);
+
+            return (false);
+        }
+
+        /*
+         * a live connection is never taken over. the client tries again,
+         * until the server finds the loss and detaches the session
+         */
+        if (m_trans != NULL || !m_detached)
+        {
+            ProCloseSockId(sockId);
+
+            return (false);
+        }
+
+        if (remoteInfo.mmType   != m_info.mmType ||
+            remoteInfo.packMode != m_info.packMode)
+        {
+            ProCloseSockId(sockId);
+
+            return (false);
+        }
+
+        char mac[16];
+        CalcRtpResumeMac(m_ack.resumeToken, 'c', nonce, m_ack.userData,
+            m_info.mmType, m_info.packMode, mac);
+        if (memcmp(mac, remoteInfo.resumeMac, 16) != 0)
+        {
+            ProCloseSockId(sockId);
+
+            return (false);
+        }
+
+        IProTransport* const newTrans = ProCreateTcpTransport(
+            this, m_reactor, sockId, unixSocket, sockBufSizeRecv,
+            sockBufSizeSend, recvPoolSize, m_suspendRecv);
+        if (newTrans == NULL)
+        {
+            ProCloseSockId(sockId);
+
+            return (false);
+        }
+
+        if (!DoHandshake(newTrans, &nonce))
+        {
+            trans = newTrans;
+        }
+        else
+        {
+            m_trans = newTrans;
+
+            char theIp[64] = "";
+            m_localAddr.sin_family       = AF_INET;
+            m_localAddr.sin_port         = pbsd_hton16(m_trans->GetLocalPort());
+            m_localAddr.sin_addr.s_addr  = pbsd_inet_aton(m_trans->GetLocalIp(theIp));
+            m_remoteAddr.sin_family      = AF_INET;
+            m_remoteAddr.sin_port        = pbsd_hton16(m_trans->GetRemotePort());
+            m_remoteAddr.sin_addr.s_addr = pbsd_inet_aton(m_trans->GetRemoteIp(theIp));
+
+            if (zcThreshold > 0 && m_trans->EnableZeroCopy(zcThreshold))
+            {
+                m_zcThreshold = zcThreshold;
+            }
+
+            m_trans->StartHeartbeat();
+
+            if (m_bigPacket != NULL)
+            {
+                m_bigPacket->Release();
+                m_bigPacket = NULL;
+            }
+
+            m_reactor->CancelTimer(m_resumeTimerId);
+            m_resumeTimerId = 0;
+            m_detached      = false;
+            m_peerAliveTick = ProGetTickCount64();
+
+            m_observer->AddRef();
+            observer = m_observer;
+        }
+    }
+
+    ProDeleteTransport(trans);
+
+    if (observer == NULL)
+    {
+        return (false);
+    }
+
+    /*
+     * the wrapper republishes the connection, the application doesn't see
+     * the resume
+     */
+    if (m_canUpcall)
+    {
+        observer->OnOkSession(this);
+    }
+
+    observer->Release();
+
+    return (true);
+}}
+
 bool
 CRtpSessionTcpserverEx::Recv0(CRtpPacket*& packet)
 {{
@@ -559,24 +913,25 @@ CRtpSessionTcpserverEx::Recv4(CRtpPacket*& packet)
 }}
 
 bool
-CRtpSessionTcpserverEx::DoHandshake(bool useAckData,
-                                    char ackData[64])
+CRtpSessionTcpserverEx::DoHandshake(IProTransport*   trans,
+                                    const PRO_NONCE* nonce) /* = NULL */
 {
-    assert(m_trans != NULL);
-    if (m_trans == NULL)
+    assert(trans != NULL);
+    if (trans == NULL)
     {
         return (false);
     }
 
     /*
-     * send the ACK result
+     * send the ACK result. on a resume, the token is replaced with the mac
+     * of the server
      */
-    RTP_SESSION_ACK ack;
-    memset(&ack, 0, sizeof(RTP_SESSION_ACK));
-    ack.version = pbsd_hton16(m_info.localVersion);
-    if (useAckData)
+    RTP_SESSION_ACK ack = m_ack;
+    ack.version = pbsd_hton16(ack.version);
+    if (nonce != NULL)
     {
-        memcpy(ack.userData, ackData, 64);
+        CalcRtpResumeMac(m_ack.resumeToken, 's', *nonce, m_ack.userData,
+            m_info.mmType, m_info.packMode, ack.resumeToken);
     }
 
     IRtpPacket* const packet = CreateRtpPacket(&ack, sizeof(RTP_SESSION_ACK));
@@ -588,7 +943,7 @@ CRtpSessionTcpserverEx::DoHandshake(bool useAckData,
     packet->SetMmId(m_info.mmId);
     packet->SetMmType(m_info.mmType);
 
-    const bool ret = m_trans->SendData(
+    const bool ret = trans->SendData(
         (char*)packet->GetPayloadBuffer() - sizeof(RTP_HEADER) - sizeof(RTP_EXT),
         packet->GetPayloadSize() + sizeof(RTP_HEADER) + sizeof(RTP_EXT)
         );
@@ -44,6 +44,18 @@ public:
 
     virtual void Fini();
 
+    /*
+     * attaches the connection of a resume to the detached session of the
+     * service that issued the token. the sockId is taken in any case
+     */
+    static bool Resume(
+        RTP_MM_TYPE             mmType,
+        PRO_INT64               sockId,
+        bool                    unixSocket,
+        const RTP_SESSION_INFO& remoteInfo,
+        const PRO_NONCE&        nonce
+        );
+
     virtual unsigned long PRO_CALLTYPE AddRef();
 
     virtual unsigned long PRO_CALLTYPE Release();
@@ -65,6 +77,23 @@ private:
         const pbsd_sockaddr_in* remoteAddr
         );
 
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+    void OnResumeTimer(PRO_UINT64 timerId);
+
+    virtual bool DoDetach(long errorCode);
+
+    bool DoResume(
+        PRO_INT64               sockId,
+        bool                    unixSocket,
+        const RTP_SESSION_INFO& remoteInfo,
+        const PRO_NONCE&        nonce
+        );
+
     bool Recv0(CRtpPacket*& packet);
 
     bool Recv2(CRtpPacket*& packet);
@@ -72,13 +101,16 @@ private:
     bool Recv4(CRtpPacket*& packet);
 
     bool DoHandshake(
-        bool useAckData,
-        char ackData[64]
+        IProTransport*   trans,
+        const PRO_NONCE* nonce = NULL
         );
 
 private:
 
-    PRO_SSL_CTX* m_sslCtx;
+    PRO_SSL_CTX*  m_sslCtx;
+    unsigned long m_resumeInSeconds; /* 0: not resumable */
+    long          m_resumeErrorCode;
+    PRO_UINT64    m_resumeTimerId;
 
     DECLARE_SGI_POOL(0)
 };
@@ -19,6 +19,7 @@
 #include "rtp_session_udpclient.h"
 #include "rtp_packet.h"
 #include "rtp_session_base.h"
+#include "rtp_udp_demux.h"
 #include "../pro_net/pro_net.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_time_util.h"
@@ -55,6 +56,8 @@ CRtpSessionUdpclient::CRtpSessionUdpclient(const RTP_SESSION_INFO& localInfo)
     m_info.localVersion  = RTP_SESSION_PROTOCOL_VERSION;
     m_info.remoteVersion = 0;
     m_info.sessionType   = RTP_ST_UDPCLIENT;
+
+    m_udpPort            = NULL;
 }
 
 CRtpSessionUdpclient::~CRtpSessionUdpclient()
@@ -92,11 +95,33 @@ CRtpSessionUdpclient::Init(IRtpSessionObserver* observer,
             return (false);
         }
 
+        unsigned long        socketCount = 0;
+        const unsigned short sharedPort  = m_info.sessionType == RTP_ST_UDPSERVER
+            ? GetRtpUdpSharedPort(m_info.mmType, &socketCount) : 0;
+        if (sharedPort > 0 && (localPort == 0 || localPort == sharedPort))
+        {
+            m_udpPort = CRtpUdpPort::CreateInstance();
+            if (!m_udpPort->Init(this, reactor, m_info.mmType, localIp,
+                sharedPort, socketCount, m_info.inSrcMmId, false))
+            {
+                m_udpPort->Release();
+                m_udpPort = NULL;
+
+                return (false);
+            }
+
+            m_trans = m_udpPort;
+        }
+
         int count = MAX_TRY_TIMES;
         if (localPort > 0)
         {
             count = 1;
         }
+        if (m_trans != NULL)
+        {
+            count = 0; /* shared */
+        }
 
         for (int i = 0; i < count; ++i)
         {
@@ -153,6 +178,7 @@ CRtpSessionUdpclient::Fini()
 {
     IRtpSessionObserver* observer = NULL;
     IProTransport*       trans    = NULL;
+    CRtpUdpPort*         udpPort  = NULL;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -168,6 +194,8 @@ CRtpSessionUdpclient::Fini()
         ProCloseSockId(m_dummySockId);
         m_dummySockId = -1;
 
+        udpPort = m_udpPort;
+        m_udpPort = NULL;
         trans = m_trans;
         m_trans = NULL;
         m_reactor = NULL;
@@ -175,7 +203,15 @@ CRtpSessionUdpclient::Fini()
         m_observer = NULL;
     }
 
-    ProDeleteTransport(trans);
+    if (udpPort != NULL)
+    {
+        udpPort->Fini();
+        udpPort->Release();
+    }
+    else
+    {
+        ProDeleteTransport(trans);
+    }
     observer->Release();
 }
 
@@ -28,6 +28,11 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+class CRtpUdpPort;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 class CRtpSessionUdpclient : public CRtpSessionBase
 {
 public:
@@ -63,6 +68,10 @@ private:
         const pbsd_sockaddr_in* remoteAddr
         );
 
+private:
+
+    CRtpUdpPort* m_udpPort; /* for a shared udp port */
+
     DECLARE_SGI_POOL(0)
 };
 
@@ -19,6 +19,7 @@
 #include "rtp_session_udpserver_ex.h"
 #include "rtp_packet.h"
 #include "rtp_session_base.h"
+#include "rtp_udp_demux.h"
 #include "../pro_net/pro_net.h"
 #include "../pro_util/pro_bsd_wrapper.h"
 #include "../pro_util/pro_time_util.h"
@@ -63,6 +64,7 @@ CRtpSessionUdpserverEx::CRtpSessionUdpserverEx(const RTP_SESSION_INFO& localInfo
     memset(&m_syncToPeer, 0, sizeof(RTP_UDPX_SYNC));
     m_syncToPeer.version = pbsd_hton16(RTP_SESSION_PROTOCOL_VERSION);
     m_syncTimerId        = 0;
+    m_udpPort            = NULL;
 }
 
 CRtpSessionUdpserverEx::~CRtpSessionUdpserverEx()
@@ -106,11 +108,32 @@ CRtpSessionUdpserverEx::Init(IRtpSessionObserver* observer,
             return (false);
         }
 
+        unsigned long        socketCount = 0;
+        const unsigned short sharedPort  = GetRtpUdpSharedPort(m_info.mmType, &socketCount);
+        if (sharedPort > 0 && (localPort == 0 || localPort == sharedPort))
+        {
+            m_udpPort = CRtpUdpPort::CreateInstance();
+            if (!m_udpPort->Init(this, reactor, m_info.mmType, localIp,
+                sharedPort, socketCount, m_info.inSrcMmId, true))
+            {
+                m_udpPort->Release();
+                m_udpPort = NULL;
+
+                return (false);
+            }
+
+            m_trans = m_udpPort;
+        }
+
         int count = MAX_TRY_TIMES;
         if (localPort > 0)
         {
             count = 1;
         }
+        if (m_trans != NULL)
+        {
+            count = 0; /* shared */
+        }
 
         for (int i = 0; i < count; ++i)
         {
@@ -156,6 +179,7 @@ CRtpSessionUdpserverEx::Fini()
 {
     IRtpSessionObserver* observer = NULL;
     IProTransport*       trans    = NULL;
+    CRtpUdpPort*         udpPort  = NULL;
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -170,6 +194,8 @@ CRtpSessionUdpserverEx::Fini()
         m_timeoutTimerId = 0;
         m_syncTimerId    = 0;
 
+        udpPort = m_udpPort;
+        m_udpPort = NULL;
         trans = m_trans;
         m_trans = NULL;
         m_reactor = NULL;
@@ -177,7 +203,15 @@ CRtpSessionUdpserverEx::Fini()
         m_observer = NULL;
     }
 
-    ProDeleteTransport(trans);
+    if (udpPort != NULL)
+    {
+        udpPort->Fini();
+        udpPort->Release();
+    }
+    else
+    {
+        ProDeleteTransport(trans);
+    }
     observer->Release();
 }
 
@@ -24,6 +24,11 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+class CRtpUdpPort;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 struct RTP_UDPX_SYNC
 {
     PRO_UINT16 CalcChecksum() const
@@ -91,6 +96,7 @@ private:
     bool          m_syncReceived;
     RTP_UDPX_SYNC m_syncToPeer; /* network byte order */
     PRO_UINT64    m_syncTimerId;
+    CRtpUdpPort*  m_udpPort; /* for a shared udp port */
 
     DECLARE_SGI_POOL(0)
 };
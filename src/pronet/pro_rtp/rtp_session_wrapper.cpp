@@ -19,6 +19,7 @@
 #include "rtp_session_wrapper.h"
 #include "rtp_base.h"
 #include "rtp_bucket.h"
+#include "rtp_pacer.h"
 #include "rtp_session_a.h"
 #include "../pro_net/pro_net.h"
 #include "../pro_util/pro_file_monitor.h"
@@ -42,8 +43,15 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-#define TRACE_INTERVAL     20
-#define HEARTBEAT_INTERVAL 1
+#define TRACE_INTERVAL        20
+#define HEARTBEAT_INTERVAL    1
+#define STAT_PUBLISH_INTERVAL 100 /* ms */
+#define STAT_SNAPSHOT_TIMEOUT 500 /* ms */
+#define SPSC_SEND_BATCH       64  /* packets per OnSendSession() */
+
+#define STATE_INIT            0
+#define STATE_READY           1 /* OnOkSession() was called */
+#define STATE_CLOSED          2
 
 #if defined(__cplusplus)
 extern "C" {
@@ -84,18 +92,33 @@ CRtpSessionWrapper::CRtpSessionWrapper(const RTP_SESSION_INFO& localInfo)
     m_reactor          = NULL;
     m_session          = NULL;
     m_bucket           = NULL;
+    m_spscBucket       = NULL;
+    m_spscPushCount    = 0;
+    m_spscKicked       = 0;
     m_pushToBucketRet1 = true; /* !!! */
     m_pushToBucketRet2 = true; /* !!! */
     m_packetErased     = false;
-    m_enableInput      = true;
-    m_enableOutput     = true;
+    m_enableInput      = 1;
+    m_enableOutput     = 1;
+    m_state            = STATE_INIT;
     m_timerId          = 0;
     m_onOkCalled       = false;
     m_traceTick        = 0;
 
-    m_sendTimerId      = 0;
+    m_pacer            = NULL;
     m_sendDurationMs   = 0;
     m_pushTick         = 0;
+    m_paceTick         = 0;
+
+    memset(&m_snapshot, 0, sizeof(RTP_SESSION_SNAPSHOT));
+    memset(&m_inputStat, 0, sizeof(RTP_STAT_SNAPSHOT));
+    memset(&m_outputStat, 0, sizeof(RTP_STAT_SNAPSHOT));
+    m_snapshot.info       = localInfo;
+    m_snapshot.sockId     = -1;
+    strcpy(m_snapshot.localIp, "0.0.0.0");
+    m_snapshotSeq         = 0;
+    m_inputStatSeq        = 0;
+    m_outputStatSeq       = 0;
 }
 
 CRtpSessionWrapper::~CRtpSessionWrapper()
@@ -187,6 +210,18 @@ CRtpSessionWrapper::Init(RTP_SESSION_TYPE     sessionType,
             initArgs2.mcastEx.localIp[sizeof(initArgs2.mcastEx.localIp) - 1] = '\0';
             break;
         }
+    case RTP_ST_DTLSCLIENT_EX:
+        {
+            initArgs2.dtlsclientEx.sslSni[sizeof(initArgs2.dtlsclientEx.sslSni) - 1]     = '\0';
+            initArgs2.dtlsclientEx.remoteIp[sizeof(initArgs2.dtlsclientEx.remoteIp) - 1] = '\0';
+            initArgs2.dtlsclientEx.localIp[sizeof(initArgs2.dtlsclientEx.localIp) - 1]   = '\0';
+            break;
+        }
+    case RTP_ST_DTLSSERVER_EX:
+        {
+            initArgs2.dtlsserverEx.localIp[sizeof(initArgs2.dtlsserverEx.localIp) - 1] = '\0';
+            break;
+        }
     default:
         {
             assert(0);
@@ -208,7 +243,9 @@ CRtpSessionWrapper::Init(RTP_SESSION_TYPE     sessionType,
             return (false);
         }
 
-        IRtpBucket* sysBucket = CreateRtpBucket(m_info.mmType, sessionType);
+        const bool  lockFree  = GetRtpLockFreeBucket(m_info.mmType);
+        IRtpBucket* sysBucket =
+            CreateRtpBucket(m_info.mmType, sessionType, lockFree);
         if (sysBucket == NULL)
         {
             return (false);
@@ -551,12 +588,72 @@ CRtpSessionWrapper::Init(RTP_SESSION_TYPE     sessionType,
                 }
                 break;
             }
+        case RTP_ST_DTLSCLIENT_EX:
+            {
+                m_session = CreateRtpSessionDtlsclientEx(
+                    this,
+                    initArgs2.comm.reactor,
+                    &m_info,
+                    initArgs2.dtlsclientEx.sslConfig,
+                    initArgs2.dtlsclientEx.sslSni,
+                    initArgs2.dtlsclientEx.remoteIp,
+                    initArgs2.dtlsclientEx.remotePort,
+                    initArgs2.dtlsclientEx.localIp,
+                    initArgs2.dtlsclientEx.timeoutInSeconds
+                    );
+                if (m_session == NULL)
+                {
+                    break;
+                }
+
+                if (initArgs2.dtlsclientEx.bucket == NULL)
+                {
+                    m_bucket  = sysBucket;
+                    sysBucket = NULL;
+                }
+                else
+                {
+                    m_bucket  = initArgs2.dtlsclientEx.bucket;
+                }
+                break;
+            }
+        case RTP_ST_DTLSSERVER_EX:
+            {
+                m_session = CreateRtpSessionDtlsserverEx(
+                    this,
+                    initArgs2.comm.reactor,
+                    &m_info,
+                    initArgs2.dtlsserverEx.sslConfig,
+                    initArgs2.dtlsserverEx.localIp,
+                    initArgs2.dtlsserverEx.localPort,
+                    initArgs2.dtlsserverEx.timeoutInSeconds
+                    );
+                if (m_session == NULL)
+                {
+                    break;
+                }
+
+                if (initArgs2.dtlsserverEx.bucket == NULL)
+                {
+                    m_bucket  = sysBucket;
+                    sysBucket = NULL;
+                }
+                else
+                {
+                    m_bucket  = initArgs2.dtlsserverEx.bucket;
+                }
+                break;
+            }
         } /* end of switch (...) */
 
         if (sysBucket != NULL)
         {
             sysBucket->Destroy();
         }
+        else if (lockFree)
+        {
+            m_spscBucket = (CRtpSpscBucket*)m_bucket;
+        }
 
         if (m_session == NULL)
         {
@@ -588,6 +685,7 @@ CRtpSessionWrapper::Init(RTP_SESSION_TYPE     sessionType,
         m_session->GetInfo(&m_info); /* retrieve the real info */
         m_observer = initArgs2.comm.observer;
         m_reactor  = initArgs2.comm.reactor;
+        PublishSnapshot();
 
 #if !defined(_WIN32_WCE)
         bool enableTrace = false;
@@ -621,6 +719,7 @@ CRtpSessionWrapper::Fini()
     IRtpSessionObserver*      observer = NULL;
     IRtpSession*              session  = NULL;
     IRtpBucket*               bucket   = NULL;
+    CRtpPacer*                pacer    = NULL;
     CProStlDeque<IRtpPacket*> pushPackets;
 
     {
@@ -633,21 +732,37 @@ CRtpSessionWrapper::Fini()
         }
 
         m_reactor->CancelTimer(m_timerId);
-        m_reactor->CancelMmTimer(m_sendTimerId);
-        m_timerId     = 0;
-        m_sendTimerId = 0;
+        m_timerId = 0;
+        ProAtomicStore(&m_state, STATE_CLOSED); /* closes the lock-free pushes */
 
+        pacer = m_pacer;
+        m_pacer = NULL;
         pushPackets = m_pushPackets;
         m_pushPackets.clear();
         bucket = m_bucket;
         m_bucket = NULL;
-        session = m_session;
-        m_session = NULL;
+        session = m_session; /* m_session and m_spscBucket are kept for the pushes */
         m_reactor = NULL;
         observer = m_observer;
         m_observer = NULL;
     }
 
+    /*
+     * wait outside the lock for the lock-free pushes that have passed the
+     * gate. no one enters after this point
+     */
+    while (ProAtomicLoad(&m_spscPushCount) > 0)
+    {
+        ProSleep(1);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_spscBucket = NULL;
+        m_session    = NULL;
+    }
+
     int       i = 0;
     const int c = (int)pushPackets.size();
 
@@ -656,6 +771,12 @@ CRtpSessionWrapper::Fini()
         pushPackets[i]->Release();
     }
 
+    if (pacer != NULL)
+    {
+        pacer->Cancel(this);
+        pacer->Detach();
+    }
+
     bucket->Destroy();
     DeleteRtpSession(session);
     observer->Release();
@@ -689,11 +810,10 @@ CRtpSessionWrapper::GetInfo(RTP_SESSION_INFO* info) const
         return;
     }
 
-    {
-        CProThreadMutexGuard mon(m_lock);
+    RTP_SESSION_SNAPSHOT snapshot;
+    ReadSnapshot(snapshot);
 
-        *info = m_info;
-    }
+    *info = snapshot.info;
 }
 
 void
@@ -758,6 +878,19 @@ PRO_INT64
 PRO_CALLTYPE
 CRtpSessionWrapper::GetSockId() const
 {
+    const long state = ProAtomicLoad(&m_state);
+    if (state == STATE_READY)
+    {
+        RTP_SESSION_SNAPSHOT snapshot;
+        ReadSnapshot(snapshot);
+
+        return (snapshot.sockId);
+    }
+    if (state == STATE_CLOSED)
+    {
+        return (-1);
+    }
+
     PRO_INT64 sockId = -1;
 
     {
@@ -776,7 +909,21 @@ const char*
 PRO_CALLTYPE
 CRtpSessionWrapper::GetLocalIp(char localIp[64]) const
 {
+    const long state = ProAtomicLoad(&m_state);
+    if (state == STATE_READY)
+    {
+        RTP_SESSION_SNAPSHOT snapshot;
+        ReadSnapshot(snapshot);
+        strcpy(localIp, snapshot.localIp);
+
+        return (localIp);
+    }
+
     strcpy(localIp, "0.0.0.0");
+    if (state == STATE_CLOSED)
+    {
+        return (localIp);
+    }
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -794,6 +941,19 @@ unsigned short
 PRO_CALLTYPE
 CRtpSessionWrapper::GetLocalPort() const
 {
+    const long state = ProAtomicLoad(&m_state);
+    if (state == STATE_READY)
+    {
+        RTP_SESSION_SNAPSHOT snapshot;
+        ReadSnapshot(snapshot);
+
+        return (snapshot.localPort);
+    }
+    if (state == STATE_CLOSED)
+    {
+        return (0);
+    }
+
     unsigned short localPort = 0;
 
     {
@@ -884,6 +1044,12 @@ bool
 PRO_CALLTYPE
 CRtpSessionWrapper::IsReady() const
 {
+    const long state = ProAtomicLoad(&m_state);
+    if (state != STATE_INIT)
+    {
+        return (state == STATE_READY);
+    }
+
     bool ready = false;
 
     {
@@ -914,6 +1080,17 @@ CRtpSessionWrapper::SendPacket(IRtpPacket* packet,
         return (false);
     }
 
+    if (ProAtomicLoad(&m_state) == STATE_CLOSED ||
+        ProAtomicLoad(&m_enableOutput) == 0)
+    {
+        return (false);
+    }
+
+    if (ProAtomicLoad(&m_state) == STATE_READY && m_spscBucket != NULL)
+    {
+        return (PushSpscPacket(packet));
+    }
+
     bool ret = false;
 
     {
@@ -961,20 +1138,131 @@ CRtpSessionWrapper::SendPacketByTimer(IRtpPacket*   packet,
             return (false);
         }
 
-        if (m_sendTimerId == 0)
+        if (m_pacer == NULL)
         {
-            m_sendTimerId = m_reactor->ScheduleMmTimer(this, 1, true); /* 1ms */
+            m_pacer = CRtpPacer::Attach(m_reactor);
+            if (m_pacer == NULL)
+            {
+                return (false);
+            }
         }
 
+        if (m_pushPackets.size() == 0)
+        {
+            m_paceTick = 0; /* restart the bucket */
+        }
+
+        const PRO_INT64 tick = ProGetTickCount64();
+
         packet->AddRef();
         m_pushPackets.push_back(packet);
         m_sendDurationMs = sendDurationMs;
-        m_pushTick       = ProGetTickCount64();
+        m_pushTick       = tick;
+
+        /*
+         * lock order: session ---> pacer ---> timer factory
+         */
+        m_pacer->Schedule(this, NextPaceTick(tick));
     }
 
     return (true);
 }
 
+PRO_INT64
+PRO_CALLTYPE
+CRtpSessionWrapper::OnPace(PRO_INT64 tick)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_observer == NULL || m_reactor == NULL || m_session == NULL ||
+        m_bucket == NULL)
+    {
+        return (0);
+    }
+
+    if (m_pushPackets.size() == 0)
+    {
+        return (0);
+    }
+
+    PRO_INT64 sendDurationMs = m_pushTick + m_sendDurationMs - tick;
+    if (sendDurationMs < 1)
+    {
+        sendDurationMs = 1;
+    }
+
+    /*
+     * token bucket. the tokens accrued since the last release are spent at
+     * once, so a late wakeup catches up rather than drifting
+     */
+    PRO_INT64 elapsedMs = m_paceTick > 0 ? tick - m_paceTick : 1;
+    if (elapsedMs < 1)
+    {
+        elapsedMs = 1;
+    }
+    if (elapsedMs > sendDurationMs)
+    {
+        elapsedMs = sendDurationMs;
+    }
+
+    PRO_INT64 maxSendCount =
+        (m_pushPackets.size() * elapsedMs + sendDurationMs / 2) / sendDurationMs; /* rounded */
+    if (maxSendCount < 1)
+    {
+        maxSendCount = 1;
+    }
+
+    for (int i = 0; i < (int)maxSendCount; ++i)
+    {
+        if (m_pushPackets.size() == 0)
+        {
+            break;
+        }
+
+        IRtpPacket* const packet = m_pushPackets.front();
+        m_pushPackets.pop_front();
+        PushPacket(packet);
+        packet->Release();
+    }
+
+    m_paceTick = tick;
+
+    if (m_pushPackets.size() == 0)
+    {
+        return (0);
+    }
+
+    return (NextPaceTick(tick));
+}
+
+PRO_INT64
+CRtpSessionWrapper::NextPaceTick(PRO_INT64 tick) const
+{
+    if (m_paceTick == 0)
+    {
+        return (tick); /* the first packet goes at once */
+    }
+
+    PRO_INT64 sendDurationMs = m_pushTick + m_sendDurationMs - tick;
+    if (sendDurationMs < 1)
+    {
+        sendDurationMs = 1;
+    }
+
+    /*
+     * the interval of one packet over the remaining duration
+     */
+    PRO_INT64 intervalMs = sendDurationMs / (PRO_INT64)m_pushPackets.size();
+    if (intervalMs < 1)
+    {
+        intervalMs = 1;
+    }
+
+    const PRO_INT64 nextTick = m_paceTick + intervalMs;
+
+    return (nextTick > tick ? nextTick : tick);
+}
+
 bool
 CRtpSessionWrapper::PushPacket(IRtpPacket* packet)
 {
@@ -1003,7 +1291,40 @@ CRtpSessionWrapper::PushPacket(IRtpPacket* packet)
 }
 
 bool
-CRtpSessionWrapper::DoSendPacket()
+CRtpSessionWrapper::PushSpscPacket(IRtpPacket* packet)
+{
+    assert(packet != NULL);
+
+    ProAtomicAdd(&m_spscPushCount, 1);
+
+    if (ProAtomicLoad(&m_state) != STATE_READY ||
+        ProAtomicLoad(&m_enableOutput) == 0)
+    {
+        ProAtomicAdd(&m_spscPushCount, -1);
+
+        return (false);
+    }
+
+    /*
+     * m_spscBucket and m_session are kept by Fini() until we leave
+     */
+    const bool ret = m_spscBucket->PushBackAddRef(packet);
+
+    /*
+     * wake up the io thread if it's idle
+     */
+    if (ProAtomicCas(&m_spscKicked, 0, 1))
+    {
+        m_session->RequestOnSend();
+    }
+
+    ProAtomicAdd(&m_spscPushCount, -1);
+
+    return (ret);
+}
+
+bool
+CRtpSessionWrapper::DoSendPacket(bool* tryAgain) /* = NULL */
 {
     assert(m_session != NULL);
     assert(m_bucket != NULL);
@@ -1014,8 +1335,13 @@ CRtpSessionWrapper::DoSendPacket()
         return (false);
     }
 
-    bool       tryAgain = false;
-    const bool ret      = m_session->SendPacket(packet, &tryAgain);
+    bool       tryAgain2 = false;
+    const bool ret       = m_session->SendPacket(packet, &tryAgain2);
+
+    if (tryAgain != NULL)
+    {
+        *tryAgain = tryAgain2;
+    }
 
     if (ret)
     {
@@ -1029,9 +1355,15 @@ CRtpSessionWrapper::DoSendPacket()
         m_statBitRateOutput.PushDataBytes(packet->GetPayloadSize());
         m_statLossRateOutput.PushData(packet->GetSequence());
 
+        const PRO_INT64 tick = ProGetTickCount64();
+        if (tick - m_outputStat.tick >= STAT_PUBLISH_INTERVAL)
+        {
+            PublishStat(true, tick);
+        }
+
         m_bucket->PopFrontRelease(packet);
     }
-    else if (!tryAgain)
+    else if (!tryAgain2)
     {
         m_bucket->PopFrontRelease(packet);
     }
@@ -1042,6 +1374,155 @@ CRtpSessionWrapper::DoSendPacket()
     return (ret);
 }
 
+bool
+CRtpSessionWrapper::DoSendSpscPackets()
+{
+    assert(m_session != NULL);
+    assert(m_spscBucket != NULL);
+
+    if (!m_enableOutput)
+    {
+        m_bucket->Reset(); /* the pushes racing with EnableOutput(false) */
+        ProAtomicStore(&m_spscKicked, 0);
+
+        return (false);
+    }
+
+    bool sent = false;
+
+    for (int i = 0; i < SPSC_SEND_BATCH; ++i)
+    {
+        bool tryAgain = false;
+        if (DoSendPacket(&tryAgain))
+        {
+            sent = true;
+            continue;
+        }
+
+        if (tryAgain)
+        {
+            return (sent); /* OnSendSession() will come again */
+        }
+
+        if (m_bucket->GetFront() == NULL)
+        {
+            /*
+             * idle. the pushes after this point kick once more
+             */
+            ProAtomicStore(&m_spscKicked, 0);
+            if (m_bucket->GetFront() != NULL &&
+                ProAtomicCas(&m_spscKicked, 0, 1))
+            {
+                m_session->RequestOnSend();
+            }
+
+            return (sent);
+        }
+    }
+
+    m_session->RequestOnSend(); /* let the other handlers run */
+
+    return (sent);
+}
+
+void
+CRtpSessionWrapper::PublishSnapshot()
+{
+    assert(m_session != NULL);
+
+    RTP_SESSION_SNAPSHOT snapshot;
+    snapshot.info      = m_info;
+    snapshot.sockId    = m_session->GetSockId();
+    m_session->GetLocalIp(snapshot.localIp);
+    snapshot.localPort = m_session->GetLocalPort();
+
+    ProAtomicAdd(&m_snapshotSeq, 1);
+    m_snapshot = snapshot;
+    ProAtomicAdd(&m_snapshotSeq, 1);
+}
+
+void
+CRtpSessionWrapper::ReadSnapshot(RTP_SESSION_SNAPSHOT& snapshot) const
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        const long seq1 = ProAtomicLoad(&m_snapshotSeq);
+        if ((seq1 & 1) != 0)
+        {
+            continue;
+        }
+
+        snapshot = m_snapshot;
+
+        if (ProAtomicLoad(&m_snapshotSeq) == seq1)
+        {
+            return;
+        }
+    }
+
+    /*
+     * the writers hold the lock
+     */
+    CProThreadMutexGuard mon(m_lock);
+
+    snapshot = m_snapshot;
+}
+
+void
+CRtpSessionWrapper::PublishStat(bool      output,
+                                PRO_INT64 tick) const
+{
+    CProStatBitRate&   frameRate = output ? m_statFrameRateOutput : m_statFrameRateInput;
+    CProStatBitRate&   bitRate   = output ? m_statBitRateOutput   : m_statBitRateInput;
+    CProStatLossRate&  lossRate  = output ? m_statLossRateOutput  : m_statLossRateInput;
+    RTP_STAT_SNAPSHOT& stat      = output ? m_outputStat          : m_inputStat;
+    volatile long&     seq       = output ? m_outputStatSeq       : m_inputStatSeq;
+
+    const float      frameRate2 = (float)frameRate.CalcBitRate();
+    const float      bitRate2   = (float)bitRate.CalcBitRate();
+    const float      lossRate2  = (float)lossRate.CalcLossRate();
+    const PRO_UINT64 lossCount  = (PRO_UINT64)lossRate.CalcLossCount();
+
+    ProAtomicAdd(&seq, 1);
+    stat.frameRate = frameRate2;
+    stat.bitRate   = bitRate2;
+    stat.lossRate  = lossRate2;
+    stat.lossCount = lossCount;
+    stat.tick      = tick;
+    ProAtomicAdd(&seq, 1);
+}
+
+bool
+CRtpSessionWrapper::ReadStat(bool               output,
+                             PRO_INT64          tick,
+                             RTP_STAT_SNAPSHOT& stat) const
+{
+    const RTP_STAT_SNAPSHOT& stat2 = output ? m_outputStat    : m_inputStat;
+    volatile long&           seq   = output ? m_outputStatSeq : m_inputStatSeq;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const long seq1 = ProAtomicLoad(&seq);
+        if ((seq1 & 1) != 0)
+        {
+            continue;
+        }
+
+        stat = stat2;
+
+        if (ProAtomicLoad(&seq) == seq1)
+        {
+            /*
+             * an idle stream is not republished, so a stale snapshot is
+             * refreshed by the reader
+             */
+            return (stat.tick > 0 && tick - stat.tick <= STAT_SNAPSHOT_TIMEOUT);
+        }
+    }
+
+    return (false);
+}
+
 void
 PRO_CALLTYPE
 CRtpSessionWrapper::GetSendOnSendTick(PRO_INT64* onSendTick1,       /* = NULL */
@@ -1070,6 +1551,11 @@ void
 PRO_CALLTYPE
 CRtpSessionWrapper::RequestOnSend()
 {
+    if (ProAtomicLoad(&m_state) == STATE_CLOSED)
+    {
+        return;
+    }
+
     {
         CProThreadMutexGuard mon(m_lock);
 
@@ -1159,7 +1645,12 @@ void
 PRO_CALLTYPE
 CRtpSessionWrapper::EnableInput(bool enable)
 {
-    enable = enable ? true : false;
+    const long enable2 = enable ? 1 : 0;
+
+    if (ProAtomicLoad(&m_enableInput) == enable2)
+    {
+        return;
+    }
 
     {
         CProThreadMutexGuard mon(m_lock);
@@ -1170,16 +1661,17 @@ CRtpSessionWrapper::EnableInput(bool enable)
             return;
         }
 
-        if (enable == m_enableInput)
+        if (enable2 == m_enableInput)
         {
             return;
         }
 
-        m_enableInput = enable;
+        ProAtomicStore(&m_enableInput, enable2);
 
         m_statFrameRateInput.Reset();
         m_statBitRateInput.Reset();
         m_statLossRateInput.Reset();
+        PublishStat(false, ProGetTickCount64());
     }
 }
 
@@ -1187,7 +1679,7 @@ void
 PRO_CALLTYPE
 CRtpSessionWrapper::EnableOutput(bool enable)
 {
-    enable = enable ? true : false;
+    const long enable2 = enable ? 1 : 0;
 
     CProStlDeque<IRtpPacket*> pushPackets;
 
@@ -1200,12 +1692,12 @@ CRtpSessionWrapper::EnableOutput(bool enable)
             return;
         }
 
-        if (enable == m_enableOutput)
+        if (enable2 == m_enableOutput)
         {
             return;
         }
 
-        m_enableOutput = enable;
+        ProAtomicStore(&m_enableOutput, enable2);
 
         m_bucket->Reset();
         m_pushToBucketRet1 = true; /* !!! */
@@ -1220,6 +1712,7 @@ CRtpSessionWrapper::EnableOutput(bool enable)
         m_statFrameRateOutput.Reset();
         m_statBitRateOutput.Reset();
         m_statLossRateOutput.Reset();
+        PublishStat(true, ProGetTickCount64());
     }
 
     int       i = 0;
@@ -1354,25 +1847,32 @@ CRtpSessionWrapper::GetInputStat(float*      frameRate,       /* = NULL */
                                  float*      lossRate,        /* = NULL */
                                  PRO_UINT64* lossCount) const /* = NULL */
 {
+    const PRO_INT64   tick = ProGetTickCount64();
+    RTP_STAT_SNAPSHOT stat;
+
+    if (!ReadStat(false, tick, stat))
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (frameRate != NULL)
-        {
-            *frameRate = (float)m_statFrameRateInput.CalcBitRate();
-        }
-        if (bitRate != NULL)
-        {
-            *bitRate   = (float)m_statBitRateInput.CalcBitRate();
-        }
-        if (lossRate != NULL)
-        {
-            *lossRate  = (float)m_statLossRateInput.CalcLossRate();
-        }
-        if (lossCount != NULL)
-        {
-            *lossCount = (PRO_UINT64)m_statLossRateInput.CalcLossCount();
-        }
+        PublishStat(false, tick);
+        stat = m_inputStat;
+    }
+
+    if (frameRate != NULL)
+    {
+        *frameRate = stat.frameRate;
+    }
+    if (bitRate != NULL)
+    {
+        *bitRate   = stat.bitRate;
+    }
+    if (lossRate != NULL)
+    {
+        *lossRate  = stat.lossRate;
+    }
+    if (lossCount != NULL)
+    {
+        *lossCount = stat.lossCount;
     }
 }
 
@@ -1383,25 +1883,32 @@ CRtpSessionWrapper::GetOutputStat(float*      frameRate,       /* = NULL */
                                   float*      lossRate,        /* = NULL */
                                   PRO_UINT64* lossCount) const /* = NULL */
 {
+    const PRO_INT64   tick = ProGetTickCount64();
+    RTP_STAT_SNAPSHOT stat;
+
+    if (!ReadStat(true, tick, stat))
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (frameRate != NULL)
-        {
-            *frameRate = (float)m_statFrameRateOutput.CalcBitRate();
-        }
-        if (bitRate != NULL)
-        {
-            *bitRate   = (float)m_statBitRateOutput.CalcBitRate();
-        }
-        if (lossRate != NULL)
-        {
-            *lossRate  = (float)m_statLossRateOutput.CalcLossRate();
-        }
-        if (lossCount != NULL)
-        {
-            *lossCount = (PRO_UINT64)m_statLossRateOutput.CalcLossCount();
-        }
+        PublishStat(true, tick);
+        stat = m_outputStat;
+    }
+
+    if (frameRate != NULL)
+    {
+        *frameRate = stat.frameRate;
+    }
+    if (bitRate != NULL)
+    {
+        *bitRate   = stat.bitRate;
+    }
+    if (lossRate != NULL)
+    {
+        *lossRate  = stat.lossRate;
+    }
+    if (lossCount != NULL)
+    {
+        *lossCount = stat.lossCount;
     }
 }
 
@@ -1421,6 +1928,7 @@ CRtpSessionWrapper::ResetInputStat()
         m_statFrameRateInput.Reset();
         m_statBitRateInput.Reset();
         m_statLossRateInput.Reset();
+        PublishStat(false, ProGetTickCount64());
     }
 }
 
@@ -1440,6 +1948,7 @@ CRtpSessionWrapper::ResetOutputStat()
         m_statFrameRateOutput.Reset();
         m_statBitRateOutput.Reset();
         m_statLossRateOutput.Reset();
+        PublishStat(true, ProGetTickCount64());
     }
 }
 
@@ -1496,14 +2005,22 @@ CRtpSessionWrapper::OnOkSession(IRtpSession* session)
         }
 
         m_session->GetInfo(&m_info);
-        m_onOkCalled = true;
+        PublishSnapshot(); /* once more if resumed */
+        ProAtomicStore(&m_state, STATE_READY);
 
-        m_observer->AddRef();
-        observer = m_observer;
+        if (!m_onOkCalled)
+        {
+            m_observer->AddRef();
+            observer = m_observer;
+        }
+        m_onOkCalled = true;
     }
 
-    observer->OnOkSession(this);
-    observer->Release();
+    if (observer != NULL)
+    {
+        observer->OnOkSession(this);
+        observer->Release();
+    }
 
     RequestOnSend();
 }
@@ -1520,6 +2037,11 @@ CRtpSessionWrapper::OnRecvSession(IRtpSession* session,
         return;
     }
 
+    if (ProAtomicLoad(&m_enableInput) == 0)
+    {
+        return;
+    }
+
     IRtpSessionObserver* observer = NULL;
 
     {
@@ -1551,6 +2073,12 @@ CRtpSessionWrapper::OnRecvSession(IRtpSession* session,
         m_statBitRateInput.PushDataBytes(packet->GetPayloadSize());
         m_statLossRateInput.PushData(packet->GetSequence());
 
+        const PRO_INT64 tick = ProGetTickCount64();
+        if (tick - m_inputStat.tick >= STAT_PUBLISH_INTERVAL)
+        {
+            PublishStat(false, tick);
+        }
+
         m_observer->AddRef();
         observer = m_observer;
     }
@@ -1590,7 +2118,20 @@ CRtpSessionWrapper::OnSendSession(IRtpSession* session,
         /*
          * 1. first
          */
-        if (DoSendPacket() && !m_packetErased)
+        if (m_spscBucket != NULL)
+        {
+            const bool sent = DoSendSpscPackets();
+            if (m_spscBucket->PopErased())
+            {
+                m_packetErased = true;
+            }
+
+            if (sent && !m_packetErased)
+            {
+                return;
+            }
+        }
+        else if (DoSendPacket() && !m_packetErased)
         {
             return;
         }
@@ -1892,34 +2433,6 @@ CRtpSessionWrapper::OnTimer(void*      factory,
             while (0);
 #endif /* _WIN32_WCE */
         }
-        else if (timerId == m_sendTimerId)
-        {
-            PRO_INT64 sendDurationMs = m_pushTick + m_sendDurationMs - tick;
-            if (sendDurationMs < 1)
-            {
-                sendDurationMs = 1;
-            }
-
-            PRO_INT64 maxSendCount =
-                (m_pushPackets.size() + sendDurationMs / 2) / sendDurationMs; /* rounded */
-            if (maxSendCount < 1)
-            {
-                maxSendCount = 1;
-            }
-
-            for (int i = 0; i < (int)maxSendCount; ++i)
-            {
-                if (m_pushPackets.size() == 0)
-                {
-                    break;
-                }
-
-                IRtpPacket* const packet = m_pushPackets.front();
-                m_pushPackets.pop_front();
-                PushPacket(packet);
-                packet->Release();
-            }
-        }
         else
         {
         }
@@ -24,6 +24,7 @@
 #define RTP_SESSION_WRAPPER_H
 
 #include "rtp_base.h"
+#include "rtp_pacer.h"
 #include "../pro_util/pro_memory_pool.h"
 #include "../pro_util/pro_ref_count.h"
 #include "../pro_util/pro_stat.h"
@@ -34,11 +35,50 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+class CRtpSpscBucket;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * the values read without the session lock. a snapshot of the session is
+ * published by Init() and once more by OnOkSession(), under a sequence
+ * lock. a resumed tcp_ex session calls OnOkSession() again, and publishes
+ * the new connection the same way
+ */
+struct RTP_SESSION_SNAPSHOT
+{
+    RTP_SESSION_INFO info;
+    PRO_INT64        sockId;
+    char             localIp[64];
+    unsigned short   localPort;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/*
+ * the stats are republished while the packets flow, under a sequence lock
+ */
+struct RTP_STAT_SNAPSHOT
+{
+    float      frameRate;
+    float      bitRate;
+    float      lossRate;
+    PRO_UINT64 lossCount;
+    PRO_INT64  tick;      /* 0: none */
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 class CRtpSessionWrapper
 :
 public IRtpSession,
 public IRtpSessionObserver,
 public IProOnTimer,
+public IRtpPacedSender,
 public CProRefCount
 {
 public:
@@ -197,9 +237,32 @@ private:
         PRO_INT64  userData
         );
 
+    virtual PRO_INT64 PRO_CALLTYPE OnPace(PRO_INT64 tick);
+
+    PRO_INT64 NextPaceTick(PRO_INT64 tick) const;
+
     bool PushPacket(IRtpPacket* packet);
 
-    bool DoSendPacket();
+    bool PushSpscPacket(IRtpPacket* packet);
+
+    bool DoSendPacket(bool* tryAgain = NULL);
+
+    bool DoSendSpscPackets();
+
+    void PublishSnapshot();
+
+    void ReadSnapshot(RTP_SESSION_SNAPSHOT& snapshot) const;
+
+    void PublishStat(
+        bool      output,
+        PRO_INT64 tick
+        ) const;
+
+    bool ReadStat(
+        bool               output,
+        PRO_INT64          tick,
+        RTP_STAT_SNAPSHOT& stat
+        ) const;
 
 private:
 
@@ -209,18 +272,23 @@ private:
     IProReactor*              m_reactor;
     IRtpSession*              m_session;
     IRtpBucket*               m_bucket;
+    CRtpSpscBucket*           m_spscBucket;    /* m_bucket, if it's lock-free */
+    volatile long             m_spscPushCount; /* lock-free pushes in progress */
+    volatile long             m_spscKicked;    /* the io thread will drain */
     bool                      m_pushToBucketRet1;
     bool                      m_pushToBucketRet2;
     bool                      m_packetErased;
-    bool                      m_enableInput;
-    bool                      m_enableOutput;
+    volatile long             m_enableInput;
+    volatile long             m_enableOutput;
+    volatile long             m_state;
     PRO_UINT64                m_timerId;
     bool                      m_onOkCalled;
     PRO_INT64                 m_traceTick;
 
-    PRO_UINT64                m_sendTimerId;
+    CRtpPacer*                m_pacer;
     unsigned long             m_sendDurationMs;
     PRO_INT64                 m_pushTick;
+    PRO_INT64                 m_paceTick; /* the last release */
     CProStlDeque<IRtpPacket*> m_pushPackets;
 
     mutable CProStatBitRate   m_statFrameRateInput;
@@ -230,6 +298,13 @@ private:
     mutable CProStatLossRate  m_statLossRateInput;
     mutable CProStatLossRate  m_statLossRateOutput;
 
+    RTP_SESSION_SNAPSHOT      m_snapshot;
+    volatile long             m_snapshotSeq;  /* odd: being written */
+    mutable RTP_STAT_SNAPSHOT m_inputStat;
+    mutable RTP_STAT_SNAPSHOT m_outputStat;
+    mutable volatile long     m_inputStatSeq; /* odd: being written */
+    mutable volatile long     m_outputStatSeq;
+
     mutable CProThreadMutex   m_lock;
 
     DECLARE_SGI_POOL(0)
@@ -0,0 +1,1134 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#include "rtp_udp_demux.h"
+#include "rtp_base.h"
+#include "rtp_packet.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+#include <cstring>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define MAX_SOCKET_COUNT 64
+
+static CProStlMap<PRO_UINT64, CRtpUdpDemux*> g_s_demuxes; /* ip:port ---> demux */
+static CProThreadMutex                       g_s_lock;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+PRO_UINT64
+MakeKey_i(const pbsd_sockaddr_in& addr)
+{
+    return (((PRO_UINT64)addr.sin_addr.s_addr << 16) | addr.sin_port);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CRtpUdpPort*
+CRtpUdpPort::CreateInstance()
+{
+    CRtpUdpPort* const port = new CRtpUdpPort;
+
+    return (port);
+}
+
+CRtpUdpPort::CRtpUdpPort()
+{
+    m_demux         = NULL;
+    m_observer      = NULL;
+    m_sendTrans     = NULL;
+    m_recvPool      = NULL;
+    m_peerId        = 0;
+    m_pendingWr     = false;
+    m_requestOnSend = false;
+    m_actionId      = 0;
+    m_heartbeat     = false;
+    m_recvSuspended = false;
+
+    m_canUpcall     = true;
+
+    memset(&m_localAddr , 0, sizeof(pbsd_sockaddr_in));
+    memset(&m_remoteAddr, 0, sizeof(pbsd_sockaddr_in));
+}
+
+CRtpUdpPort::~CRtpUdpPort()
+{
+    Fini();
+}
+
+bool
+CRtpUdpPort::Init(IProTransportObserver* observer,
+                  IProReactor*           reactor,
+                  RTP_MM_TYPE            mmType,
+                  const char*            localIp,     /* = NULL */
+                  unsigned short         localPort,
+                  unsigned long          socketCount, /* = 1 */
+                  PRO_UINT32             peerId,
+                  bool                   ex)
+{
+    assert(observer != NULL);
+    assert(reactor != NULL);
+    assert(localPort > 0);
+    if (observer == NULL || reactor == NULL || localPort == 0)
+    {
+        return (false);
+    }
+
+    CRtpUdpDemux* const demux = CRtpUdpDemux::Attach(
+        reactor, mmType, localIp, localPort, socketCount, ex);
+    if (demux == NULL)
+    {
+        return (false);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_observer == NULL);
+        assert(m_demux == NULL);
+        if (m_observer != NULL || m_demux != NULL)
+        {
+            demux->Detach();
+
+            return (false);
+        }
+
+        IProTransport* const trans = demux->GetFirstTransport();
+
+        char theIp[64] = "";
+        m_localAddr.sin_family      = AF_INET;
+        m_localAddr.sin_port        = pbsd_hton16(trans->GetLocalPort());
+        m_localAddr.sin_addr.s_addr = pbsd_inet_aton(trans->GetLocalIp(theIp));
+
+        observer->AddRef();
+        m_observer  = observer;
+        m_demux     = demux;
+        m_sendTrans = trans;
+        m_recvPool  = trans->GetRecvPool();
+        m_peerId    = peerId;
+    }
+
+    /*
+     * lock order: demux ---> port is never taken, so the port is added
+     * out of its own lock
+     */
+    if (!demux->AddPort(this))
+    {
+        Fini();
+
+        return (false);
+    }
+
+    return (true);
+}
+
+void
+CRtpUdpPort::Fini()
+{
+    IProTransportObserver* observer = NULL;
+    CRtpUdpDemux*          demux    = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        demux = m_demux;
+        m_demux = NULL;
+        observer = m_observer;
+        m_observer = NULL;
+    }
+
+    demux->RemovePort(this);
+    demux->Detach();
+    observer->Release();
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpUdpPort::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpUdpPort::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+PRO_SSL_SUITE_ID
+PRO_CALLTYPE
+CRtpUdpPort::GetSslSuite(char suiteName[64]) const
+{
+    strcpy(suiteName, "NONE");
+
+    return (PRO_SSL_SUITE_NONE);
+}
+
+PRO_INT64
+PRO_CALLTYPE
+CRtpUdpPort::GetSockId() const
+{
+    PRO_INT64 sockId = -1;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_sendTrans != NULL)
+        {
+            sockId = m_sendTrans->GetSockId();
+        }
+    }
+
+    return (sockId);
+}
+
+const char*
+PRO_CALLTYPE
+CRtpUdpPort::GetLocalIp(char localIp[64]) const
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        pbsd_inet_ntoa(m_localAddr.sin_addr.s_addr, localIp);
+    }
+
+    return (localIp);
+}
+
+unsigned short
+PRO_CALLTYPE
+CRtpUdpPort::GetLocalPort() const
+{
+    unsigned short localPort = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        localPort = pbsd_ntoh16(m_localAddr.sin_port);
+    }
+
+    return (localPort);
+}
+
+const char*
+PRO_CALLTYPE
+CRtpUdpPort::GetRemoteIp(char remoteIp[64]) const
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        pbsd_inet_ntoa(m_remoteAddr.sin_addr.s_addr, remoteIp);
+    }
+
+    return (remoteIp);
+}
+
+unsigned short
+PRO_CALLTYPE
+CRtpUdpPort::GetRemotePort() const
+{
+    unsigned short remotePort = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        remotePort = pbsd_ntoh16(m_remoteAddr.sin_port);
+    }
+
+    return (remotePort);
+}
+
+IProRecvPool*
+PRO_CALLTYPE
+CRtpUdpPort::GetRecvPool()
+{
+    IProRecvPool* recvPool = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        recvPool = m_recvPool; /* the socket's, valid within OnRecv() */
+    }
+
+    return (recvPool);
+}
+
+bool
+PRO_CALLTYPE
+CRtpUdpPort::SendData(const void*             buf,
+                      size_t                  size,
+                      PRO_UINT64              actionId,   /* = 0 */
+                      const pbsd_sockaddr_in* remoteAddr) /* = NULL */
+{
+    assert(buf != NULL);
+    assert(size > 0);
+    if (buf == NULL || size == 0)
+    {
+        return (false);
+    }
+
+    CRtpUdpDemux*  demux = NULL;
+    IProTransport* trans = NULL;
+    bool           ret   = false;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return (false);
+        }
+
+        if (m_pendingWr)
+        {
+            return (false);
+        }
+
+        const pbsd_sockaddr_in* const realAddr =
+            remoteAddr != NULL ? remoteAddr : &m_remoteAddr;
+        if (realAddr->sin_addr.s_addr == 0 || realAddr->sin_port == 0)
+        {
+            return (false);
+        }
+
+        ret = m_sendTrans->SendData(buf, size, 0, realAddr);
+        if (ret)
+        {
+            m_pendingWr = true;
+            m_actionId  = actionId;
+        }
+        else
+        {
+            m_requestOnSend = true; /* the socket is full */
+        }
+
+        m_demux->AddRef();
+        demux = m_demux;
+        trans = m_sendTrans;
+    }
+
+    demux->WaitOnSend(this, trans);
+    demux->Release();
+
+    return (ret);
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::RequestOnSend()
+{
+    CRtpUdpDemux*  demux = NULL;
+    IProTransport* trans = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        if (m_requestOnSend)
+        {
+            return;
+        }
+
+        m_requestOnSend = true;
+
+        m_demux->AddRef();
+        demux = m_demux;
+        trans = m_sendTrans;
+    }
+
+    demux->WaitOnSend(this, trans);
+    demux->Release();
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::SuspendRecv()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_recvSuspended = true; /* the datagrams are dropped */
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::ResumeRecv()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_recvSuspended = false;
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::StartHeartbeat()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_heartbeat = true;
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::StopHeartbeat()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_heartbeat = false;
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpPort::GetStats(PRO_TRANSPORT_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(PRO_TRANSPORT_STATS)); /* no send pool */
+}
+
+void
+CRtpUdpPort::OnDemuxRecv(IProTransport*          trans,
+                         const pbsd_sockaddr_in* remoteAddr)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    assert(trans != NULL);
+    assert(remoteAddr != NULL);
+    if (trans == NULL || remoteAddr == NULL)
+    {
+        return;
+    }
+
+    IProTransportObserver* observer = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        if (m_recvSuspended)
+        {
+            return;
+        }
+
+        if (m_remoteAddr.sin_addr.s_addr == 0)
+        {
+            m_remoteAddr = *remoteAddr;
+        }
+
+        /*
+         * the replies go out of the socket the peer came in on, and the
+         * session reads the datagram from its pool
+         */
+        m_sendTrans = trans;
+        m_recvPool  = trans->GetRecvPool();
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        observer->OnRecv(this, remoteAddr);
+    }
+
+    observer->Release();
+}}
+
+void
+CRtpUdpPort::OnDemuxSend(PRO_UINT64 actionId)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    IProTransportObserver* observer  = NULL;
+    PRO_UINT64             actionId2 = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        if (!m_pendingWr && !m_requestOnSend)
+        {
+            return;
+        }
+
+        actionId2 = m_actionId;
+
+        m_pendingWr     = false;
+        m_requestOnSend = false;
+        m_actionId      = 0;
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        observer->OnSend(this, actionId2);
+    }
+
+    observer->Release();
+}}
+
+void
+CRtpUdpPort::OnDemuxClose(long errorCode)
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    IProTransportObserver* observer = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        m_canUpcall = false;
+        observer->OnClose(this, errorCode, 0);
+    }
+
+    observer->Release();
+}}
+
+void
+CRtpUdpPort::OnDemuxHeartbeat()
+{{
+    CProThreadMutexGuard mon(m_lockUpcall);
+
+    IProTransportObserver* observer = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_observer == NULL || m_demux == NULL)
+        {
+            return;
+        }
+
+        if (!m_heartbeat)
+        {
+            return;
+        }
+
+        m_observer->AddRef();
+        observer = m_observer;
+    }
+
+    if (m_canUpcall)
+    {
+        observer->OnHeartbeat(this);
+    }
+
+    observer->Release();
+}}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CRtpUdpDemux*
+CRtpUdpDemux::Attach(IProReactor*   reactor,
+                     RTP_MM_TYPE    mmType,
+                     const char*    localIp,     /* = NULL */
+                     unsigned short localPort,
+                     unsigned long  socketCount, /* = 1 */
+                     bool           ex)
+{
+    assert(reactor != NULL);
+    assert(localPort > 0);
+    if (reactor == NULL || localPort == 0)
+    {
+        return (NULL);
+    }
+
+    if (localIp == NULL || localIp[0] == '\0')
+    {
+        localIp = "0.0.0.0";
+    }
+
+    pbsd_sockaddr_in localAddr;
+    memset(&localAddr, 0, sizeof(pbsd_sockaddr_in));
+    localAddr.sin_family      = AF_INET;
+    localAddr.sin_port        = pbsd_hton16(localPort);
+    localAddr.sin_addr.s_addr = pbsd_inet_aton(localIp);
+
+    if (localAddr.sin_addr.s_addr == (PRO_UINT32)-1)
+    {
+        return (NULL);
+    }
+
+    const PRO_UINT64 key   = MakeKey_i(localAddr);
+    CRtpUdpDemux*    demux = NULL;
+
+    {
+        CProThreadMutexGuard mon(g_s_lock);
+
+        CProStlMap<PRO_UINT64, CRtpUdpDemux*>::const_iterator const itr =
+            g_s_demuxes.find(key);
+        if (itr != g_s_demuxes.end())
+        {
+            demux = itr->second;
+
+            /*
+             * the sockets are driven by one reactor, and speak one protocol
+             */
+            if (demux->m_reactor != reactor || demux->m_ex != ex)
+            {
+                return (NULL);
+            }
+        }
+        else
+        {
+            demux = new CRtpUdpDemux(reactor, key, ex); /* the reference of the map */
+            if (!demux->Init(mmType, localIp, localPort, socketCount))
+            {
+                demux->Fini();
+                demux->Release();
+
+                return (NULL);
+            }
+
+            g_s_demuxes[key] = demux;
+        }
+
+        demux->AddRef();
+        ++demux->m_attachCount;
+    }
+
+    return (demux);
+}
+
+void
+CRtpUdpDemux::Detach()
+{
+    bool last = false;
+
+    {
+        CProThreadMutexGuard mon(g_s_lock);
+
+        assert(m_attachCount > 0);
+        --m_attachCount;
+
+        if (m_attachCount == 0)
+        {
+            CProStlMap<PRO_UINT64, CRtpUdpDemux*>::iterator const itr =
+                g_s_demuxes.find(m_key);
+            if (itr != g_s_demuxes.end() && itr->second == this)
+            {
+                g_s_demuxes.erase(itr);
+            }
+            last = true;
+        }
+    }
+
+    if (last)
+    {
+        Fini();
+        Release(); /* the reference of the map */
+    }
+
+    Release();
+}
+
+CRtpUdpDemux::CRtpUdpDemux(IProReactor* reactor,
+                           PRO_UINT64   key,
+                           bool         ex)
+: m_reactor(reactor),
+  m_key(key),
+  m_ex(ex)
+{
+    m_attachCount = 0;
+}
+
+CRtpUdpDemux::~CRtpUdpDemux()
+{
+    assert(m_ports.size() == 0);
+}
+
+bool
+CRtpUdpDemux::Init(RTP_MM_TYPE    mmType,
+                   const char*    localIp,
+                   unsigned short localPort,
+                   unsigned long  socketCount)
+{
+    if (socketCount == 0)
+    {
+        socketCount = 1;
+    }
+    else if (socketCount > MAX_SOCKET_COUNT)
+    {
+        socketCount = MAX_SOCKET_COUNT;
+    }
+
+    unsigned long sockBufSizeRecv = 0;
+    unsigned long sockBufSizeSend = 0;
+    unsigned long recvPoolSize    = 0;
+    GetRtpUdpSocketParams(
+        mmType, &sockBufSizeRecv, &sockBufSizeSend, &recvPoolSize);
+
+    CProStlVector<IProTransport*> transes;
+
+    for (int i = 0; i < (int)socketCount; ++i)
+    {
+        IProTransport* const trans = ProCreateUdpTransportEx(
+            this, m_reactor, localIp, localPort,
+            sockBufSizeRecv, sockBufSizeSend, recvPoolSize, socketCount > 1);
+        if (trans == NULL)
+        {
+            break;
+        }
+
+        transes.push_back(trans);
+    }
+
+    if (transes.size() != socketCount)
+    {
+        for (int j = 0; j < (int)transes.size(); ++j)
+        {
+            ProDeleteTransport(transes[j]);
+        }
+
+        return (false);
+    }
+
+    transes[0]->StartHeartbeat(); /* one for all the ports */
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_transes = transes;
+    }
+
+    return (true);
+}
+
+void
+CRtpUdpDemux::Fini()
+{
+    CProStlVector<IProTransport*> transes;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        transes = m_transes;
+        m_transes.clear();
+    }
+
+    for (int i = 0; i < (int)transes.size(); ++i)
+    {
+        ProDeleteTransport(transes[i]);
+    }
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpUdpDemux::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CRtpUdpDemux::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CRtpUdpDemux::AddPort(CRtpUdpPort* port)
+{
+    assert(port != NULL);
+    if (port == NULL)
+    {
+        return (false);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_transes.size() == 0)
+        {
+            return (false);
+        }
+
+        if (m_ports.find(port) != m_ports.end())
+        {
+            return (false);
+        }
+
+        port->AddRef();
+        m_ports.insert(port);
+        m_peerId2Ports.insert(std::make_pair(port->GetPeerId(), port));
+    }
+
+    return (true);
+}
+
+void
+CRtpUdpDemux::RemovePort(CRtpUdpPort* port)
+{
+    assert(port != NULL);
+    if (port == NULL)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ports.find(port) == m_ports.end())
+        {
+            return;
+        }
+
+        m_ports.erase(port);
+        m_sendWaiters.erase(port);
+
+        /*
+         * a port is in either of the indexes
+         */
+        CProStlMultimap<PRO_UINT32, CRtpUdpPort*>::iterator       itr = m_peerId2Ports.lower_bound(port->GetPeerId());
+        CProStlMultimap<PRO_UINT32, CRtpUdpPort*>::iterator const end = m_peerId2Ports.upper_bound(port->GetPeerId());
+
+        for (; itr != end; ++itr)
+        {
+            if (itr->second == port)
+            {
+                m_peerId2Ports.erase(itr);
+                break;
+            }
+        }
+
+        if (itr == end)
+        {
+            CProStlHashMap<PRO_UINT64, CRtpUdpPort*>::iterator       itr2 = m_addr2Port.begin();
+            CProStlHashMap<PRO_UINT64, CRtpUdpPort*>::iterator const end2 = m_addr2Port.end();
+
+            for (; itr2 != end2; ++itr2)
+            {
+                if (itr2->second == port)
+                {
+                    m_addr2Port.erase(itr2);
+                    break;
+                }
+            }
+        }
+    }
+
+    port->Release();
+}
+
+void
+CRtpUdpDemux::WaitOnSend(CRtpUdpPort*   port,
+                         IProTransport* trans)
+{
+    assert(port != NULL);
+    assert(trans != NULL);
+    if (port == NULL || trans == NULL)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_ports.find(port) == m_ports.end())
+        {
+            return;
+        }
+
+        m_sendWaiters[port] = trans;
+    }
+
+    trans->RequestOnSend();
+}
+
+bool
+CRtpUdpDemux::ParsePeerId(IProRecvPool& recvPool,
+                          PRO_UINT32&   peerId) const
+{
+    peerId = 0;
+
+    const unsigned long dataSize = recvPool.PeekDataSize();
+
+    if (m_ex)
+    {
+        /*
+         * the first datagram of a peer must be a sync packet
+         */
+        if (dataSize < sizeof(RTP_EXT) + sizeof(RTP_HEADER))
+        {
+            return (false);
+        }
+
+        RTP_EXT ext;
+        recvPool.PeekData(&ext, sizeof(RTP_EXT));
+        if (!ext.udpxSync)
+        {
+            return (false);
+        }
+
+        peerId = pbsd_ntoh32(ext.mmId);
+    }
+    else
+    {
+        if (dataSize < sizeof(RTP_HEADER))
+        {
+            return (false);
+        }
+
+        unsigned char hdr[sizeof(RTP_HEADER)];
+        recvPool.PeekData(hdr, sizeof(RTP_HEADER));
+        if ((hdr[0] >> 6) != 2)
+        {
+            return (false);
+        }
+
+        PRO_UINT32 ssrc = 0;
+        memcpy(&ssrc, hdr + 8, sizeof(PRO_UINT32));
+        peerId = pbsd_ntoh32(ssrc);
+    }
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpDemux::OnRecv(IProTransport*          trans,
+                     const pbsd_sockaddr_in* remoteAddr)
+{
+    assert(trans != NULL);
+    assert(remoteAddr != NULL);
+    if (trans == NULL || remoteAddr == NULL)
+    {
+        return;
+    }
+
+    IProRecvPool& recvPool = *trans->GetRecvPool();
+    CRtpUdpPort*  port     = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        const PRO_UINT64 key = MakeKey_i(*remoteAddr);
+
+        CProStlHashMap<PRO_UINT64, CRtpUdpPort*>::const_iterator const itr =
+            m_addr2Port.find(key);
+        if (itr != m_addr2Port.end())
+        {
+            port = itr->second;
+        }
+        else
+        {
+            PRO_UINT32 peerId = 0;
+            if (ParsePeerId(recvPool, peerId))
+            {
+                /*
+                 * the sessions waiting for this peer, and then for anyone
+                 */
+                CProStlMultimap<PRO_UINT32, CRtpUdpPort*>::iterator itr2 =
+                    m_peerId2Ports.find(peerId);
+                if (itr2 == m_peerId2Ports.end() && peerId != 0)
+                {
+                    itr2 = m_peerId2Ports.find(0);
+                }
+
+                if (itr2 != m_peerId2Ports.end())
+                {
+                    port = itr2->second;
+                    m_peerId2Ports.erase(itr2);
+                    m_addr2Port[key] = port;
+                }
+            }
+        }
+
+        if (port != NULL)
+        {
+            port->AddRef();
+        }
+    }
+
+    if (port != NULL)
+    {
+        port->OnDemuxRecv(trans, remoteAddr);
+        port->Release();
+    }
+
+    recvPool.Flush(recvPool.PeekDataSize()); /* what's left, or a stray */
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpDemux::OnSend(IProTransport* trans,
+                     PRO_UINT64     actionId)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProStlVector<CRtpUdpPort*> ports;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlMap<CRtpUdpPort*, IProTransport*>::iterator       itr = m_sendWaiters.begin();
+        CProStlMap<CRtpUdpPort*, IProTransport*>::iterator const end = m_sendWaiters.end();
+
+        while (itr != end)
+        {
+            if (itr->second == trans)
+            {
+                itr->first->AddRef();
+                ports.push_back(itr->first);
+                m_sendWaiters.erase(itr++);
+            }
+            else
+            {
+                ++itr;
+            }
+        }
+    }
+
+    for (int i = 0; i < (int)ports.size(); ++i)
+    {
+        ports[i]->OnDemuxSend(actionId);
+        ports[i]->Release();
+    }
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpDemux::OnClose(IProTransport* trans,
+                      long           errorCode,
+                      long           sslCode)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProStlVector<CRtpUdpPort*> ports;
+
+    {
+        CProThreadMutexGuard g_mon(g_s_lock);
+        CProThreadMutexGuard mon(m_lock);
+
+        /*
+         * the next attacher gets a new demux
+         */
+        CProStlMap<PRO_UINT64, CRtpUdpDemux*>::iterator const itr =
+            g_s_demuxes.find(m_key);
+        if (itr != g_s_demuxes.end() && itr->second == this)
+        {
+            g_s_demuxes.erase(itr);
+            Release(); /* the reference of the map */
+        }
+
+        CProStlSet<CRtpUdpPort*>::const_iterator       itr2 = m_ports.begin();
+        CProStlSet<CRtpUdpPort*>::const_iterator const end2 = m_ports.end();
+
+        for (; itr2 != end2; ++itr2)
+        {
+            (*itr2)->AddRef();
+            ports.push_back(*itr2);
+        }
+    }
+
+    for (int i = 0; i < (int)ports.size(); ++i)
+    {
+        ports[i]->OnDemuxClose(errorCode);
+        ports[i]->Release();
+    }
+}
+
+void
+PRO_CALLTYPE
+CRtpUdpDemux::OnHeartbeat(IProTransport* trans)
+{
+    CProStlVector<CRtpUdpPort*> ports;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlSet<CRtpUdpPort*>::const_iterator       itr = m_ports.begin();
+        CProStlSet<CRtpUdpPort*>::const_iterator const end = m_ports.end();
+
+        for (; itr != end; ++itr)
+        {
+            (*itr)->AddRef();
+            ports.push_back(*itr);
+        }
+    }
+
+    for (int i = 0; i < (int)ports.size(); ++i)
+    {
+        ports[i]->OnDemuxHeartbeat();
+        ports[i]->Release();
+    }
+}
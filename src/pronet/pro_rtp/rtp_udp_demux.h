@@ -0,0 +1,303 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+/*
+ * Many udp server sessions on one local port.
+ *
+ * A demux owns the socket of a local ip:port, or a few SO_REUSEPORT ones,
+ * and hands each datagram to the port of the session it belongs to: by the
+ * remote address once the session has heard from it, or else by the first
+ * datagram of the peer, i.e., the ssrc of rtp or the mmId of the rtp_ex
+ * sync packet, against the inSrcMmId of the sessions not bound yet.
+ *
+ * A port is the IProTransport of its session, so the session code doesn't
+ * know the socket is shared. A port sends one datagram per OnSend(), as
+ * a udp transport of its own does.
+ */
+
+#if !defined(RTP_UDP_DEMUX_H)
+#define RTP_UDP_DEMUX_H
+
+#include "rtp_base.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_z.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CRtpUdpDemux;
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CRtpUdpPort : public IProTransport, public CProRefCount
+{
+public:
+
+    static CRtpUdpPort* CreateInstance();
+
+    /*
+     * peerId is the ssrc of rtp, or the mmId of rtp_ex. 0 for any peer
+     */
+    bool Init(
+        IProTransportObserver* observer,
+        IProReactor*           reactor,
+        RTP_MM_TYPE            mmType,
+        const char*            localIp,     /* = NULL */
+        unsigned short         localPort,
+        unsigned long          socketCount, /* = 1 */
+        PRO_UINT32             peerId,
+        bool                   ex
+        );
+
+    void Fini();
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+    virtual PRO_TRANS_TYPE PRO_CALLTYPE GetType() const
+    {
+        return (PRO_TRANS_UDP);
+    }
+
+    virtual PRO_SSL_SUITE_ID PRO_CALLTYPE GetSslSuite(
+        char suiteName[64]
+        ) const;
+
+    virtual PRO_INT64 PRO_CALLTYPE GetSockId() const;
+
+    virtual const char* PRO_CALLTYPE GetLocalIp(char localIp[64]) const;
+
+    virtual unsigned short PRO_CALLTYPE GetLocalPort() const;
+
+    virtual const char* PRO_CALLTYPE GetRemoteIp(char remoteIp[64]) const;
+
+    virtual unsigned short PRO_CALLTYPE GetRemotePort() const;
+
+    virtual IProRecvPool* PRO_CALLTYPE GetRecvPool();
+
+    virtual bool PRO_CALLTYPE SendData(
+        const void*             buf,
+        size_t                  size,
+        PRO_UINT64              actionId,  /* = 0 */
+        const pbsd_sockaddr_in* remoteAddr /* = NULL */
+        );
+
+    virtual void PRO_CALLTYPE RequestOnSend();
+
+    virtual void PRO_CALLTYPE SuspendRecv();
+
+    virtual void PRO_CALLTYPE ResumeRecv();
+
+    virtual bool PRO_CALLTYPE AddMcastReceiver(const char* mcastIp)
+    {
+        return (false);
+    }
+
+    virtual void PRO_CALLTYPE RemoveMcastReceiver(const char* mcastIp)
+    {
+    }
+
+    virtual void PRO_CALLTYPE StartHeartbeat();
+
+    virtual void PRO_CALLTYPE StopHeartbeat();
+
+    virtual void PRO_CALLTYPE UdpConnResetAsError(
+        const pbsd_sockaddr_in* remoteAddr
+        )
+    {
+    }
+
+    virtual bool PRO_CALLTYPE EnableZeroCopy(size_t threshold)
+    {
+        return (false);
+    }
+
+    virtual bool PRO_CALLTYPE SendDataZeroCopy(
+        const void*    buf,
+        size_t         size,
+        IProRefObject* holder,
+        PRO_UINT64     actionId /* = 0 */
+        )
+    {
+        return (SendData(buf, size, actionId, NULL));
+    }
+
+    virtual void PRO_CALLTYPE GetStats(PRO_TRANSPORT_STATS* stats) const;
+
+    /*
+     * [[[[ for the demux
+     */
+    PRO_UINT32 GetPeerId() const
+    {
+        return (m_peerId);
+    }
+
+    void OnDemuxRecv(
+        IProTransport*          trans,
+        const pbsd_sockaddr_in* remoteAddr
+        );
+
+    void OnDemuxSend(PRO_UINT64 actionId);
+
+    void OnDemuxClose(long errorCode);
+
+    void OnDemuxHeartbeat();
+    /*
+     * ]]]]
+     */
+
+private:
+
+    CRtpUdpPort();
+
+    virtual ~CRtpUdpPort();
+
+private:
+
+    CRtpUdpDemux*           m_demux;
+    IProTransportObserver*  m_observer;
+    IProTransport*          m_sendTrans; /* the socket the peer came in on */
+    IProRecvPool*           m_recvPool;
+    PRO_UINT32              m_peerId;
+    pbsd_sockaddr_in        m_localAddr;
+    pbsd_sockaddr_in        m_remoteAddr; /* bound by the first datagram */
+    bool                    m_pendingWr;
+    bool                    m_requestOnSend;
+    PRO_UINT64              m_actionId;
+    bool                    m_heartbeat;
+    bool                    m_recvSuspended;
+    mutable CProThreadMutex m_lock;
+
+    bool                    m_canUpcall;
+    CProThreadMutex         m_lockUpcall;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CRtpUdpDemux : public IProTransportObserver, public CProRefCount
+{
+public:
+
+    /*
+     * returns the demux of localIp:localPort, shared by all its attachers
+     */
+    static CRtpUdpDemux* Attach(
+        IProReactor*   reactor,
+        RTP_MM_TYPE    mmType,
+        const char*    localIp,     /* = NULL */
+        unsigned short localPort,
+        unsigned long  socketCount, /* = 1 */
+        bool           ex
+        );
+
+    void Detach();
+
+    bool AddPort(CRtpUdpPort* port);
+
+    void RemovePort(CRtpUdpPort* port);
+
+    /*
+     * the port gets OnDemuxSend() when "trans" is writable
+     */
+    void WaitOnSend(
+        CRtpUdpPort*   port,
+        IProTransport* trans
+        );
+
+    IProTransport* GetFirstTransport() const
+    {
+        return (m_transes[0]); /* set up before Attach() returns */
+    }
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CRtpUdpDemux(
+        IProReactor* reactor,
+        PRO_UINT64   key,
+        bool         ex
+        );
+
+    virtual ~CRtpUdpDemux();
+
+    bool Init(
+        RTP_MM_TYPE    mmType,
+        const char*    localIp,
+        unsigned short localPort,
+        unsigned long  socketCount
+        );
+
+    void Fini();
+
+    bool ParsePeerId(
+        IProRecvPool& recvPool,
+        PRO_UINT32&   peerId
+        ) const;
+
+    virtual void PRO_CALLTYPE OnRecv(
+        IProTransport*          trans,
+        const pbsd_sockaddr_in* remoteAddr
+        );
+
+    virtual void PRO_CALLTYPE OnSend(
+        IProTransport* trans,
+        PRO_UINT64     actionId
+        );
+
+    virtual void PRO_CALLTYPE OnClose(
+        IProTransport* trans,
+        long           errorCode,
+        long           sslCode
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeat(IProTransport* trans);
+
+private:
+
+    IProReactor* const                        m_reactor;
+    const PRO_UINT64                          m_key;
+    const bool                                m_ex;
+    unsigned long                             m_attachCount;
+    CProStlVector<IProTransport*>             m_transes;
+    CProStlSet<CRtpUdpPort*>                  m_ports;
+    CProStlHashMap<PRO_UINT64, CRtpUdpPort*>  m_addr2Port;
+    CProStlMultimap<PRO_UINT32, CRtpUdpPort*> m_peerId2Ports; /* not bound yet */
+    CProStlMap<CRtpUdpPort*, IProTransport*>  m_sendWaiters;
+    mutable CProThreadMutex                   m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* RTP_UDP_DEMUX_H */
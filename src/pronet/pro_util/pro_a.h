@@ -154,6 +154,12 @@
 
 #endif /* _MSC_VER, __MINGW32__, __CYGWIN__ */
 
+/*
+ * decade buckets of a duration histogram. the upper bounds are
+ * 10us, 100us, 1ms, 10ms, 100ms, 1s and 10s, the last bucket is open
+ */
+#define PRO_STAT_HISTOGRAM_SIZE 8
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -24,6 +24,10 @@
 #include "pro_z.h"
 #include "../pro_shared/pro_shared.h"
 
+#if defined(PRO_HAS_IO_URING)
+#include <sys/syscall.h>
+#endif
+
 #if defined(__cplusplus)
 extern "C" {
 #endif
@@ -1328,6 +1332,26 @@ pbsd_recvmsg(PRO_INT64    fd,
     return (retc);
 }
 
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+int
+PRO_CALLTYPE
+pbsd_recvmsg_errqueue(PRO_INT64    fd,
+                      pbsd_msghdr* msg)
+{
+    int retc = -1;
+
+    do
+    {
+        retc = recvmsg((int)fd, msg, MSG_ERRQUEUE | MSG_DONTWAIT);
+    }
+    while (retc < 0 && pbsd_errno((void*)&pbsd_recvmsg_errqueue) == PBSD_EINTR);
+
+    return (retc);
+}
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+
 int
 PRO_CALLTYPE
 pbsd_select(PRO_INT64       nfds,
@@ -1410,6 +1434,51 @@ pbsd_epoll_wait(int               epfd,
 
 #endif /* PRO_HAS_EPOLL */
 
+#if defined(PRO_HAS_IO_URING)
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_setup(unsigned int            entries,
+                    struct io_uring_params* params)
+{
+    const int ringfd = (int)syscall(__NR_io_uring_setup, entries, params);
+    if (ringfd < 0)
+    {
+        return (-1);
+    }
+
+    pbsd_ioctl_closexec(ringfd);
+
+    return (ringfd);
+}
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_enter(int          ringfd,
+                    unsigned int toSubmit,
+                    unsigned int minComplete,
+                    unsigned int flags)
+{
+    /*
+     * no retry for EINTR. The caller recalculates "toSubmit" from the ring
+     */
+    return ((int)syscall(__NR_io_uring_enter,
+        ringfd, toSubmit, minComplete, flags, NULL, 0));
+}
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_register(int          ringfd,
+                       unsigned int opcode,
+                       void*        arg,
+                       unsigned int argCount)
+{
+    return ((int)syscall(__NR_io_uring_register,
+        ringfd, opcode, arg, argCount));
+}
+
+#endif /* PRO_HAS_IO_URING */
+
 void
 PRO_CALLTYPE
 pbsd_shutdown_send(PRO_INT64 fd)
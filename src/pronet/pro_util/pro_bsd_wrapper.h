@@ -53,6 +53,15 @@
 #if defined(PRO_HAS_EPOLL)
 #include <sys/epoll.h>
 #endif
+#if defined(PRO_HAS_IO_URING)
+#include <linux/io_uring.h>
+#endif
+#if defined(PRO_HAS_KTLS)
+#include <linux/tls.h>
+#endif
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+#include <linux/errqueue.h>
+#endif
 #include <sys/ioctl.h>
 #include <sys/select.h>
 #include <sys/socket.h>
@@ -170,6 +179,10 @@ struct pbsd_msghdr : public msghdr
 #define PRO_EPOLLFD_GETSIZE 1024
 #endif
 
+#if !defined(PRO_EPOLLET_BUDGET)
+#define PRO_EPOLLET_BUDGET  16 /* upcalls per direction per round */
+#endif
+
 struct pbsd_epoll_event : public epoll_event
 {
     DECLARE_SGI_POOL(0)
@@ -177,6 +190,29 @@ struct pbsd_epoll_event : public epoll_event
 
 #endif /* PRO_HAS_EPOLL */
 
+#if defined(PRO_HAS_IO_URING) && !defined(IORING_RECV_MULTISHOT)
+#undef  PRO_HAS_IO_URING /* the kernel headers are older than Linux 6.0 */
+#endif
+
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+#if !defined(MSG_ZEROCOPY) || !defined(SO_ZEROCOPY) || !defined(SO_EE_ORIGIN_ZEROCOPY)
+#undef  PRO_HAS_MSG_ZEROCOPY /* the headers are older than Linux 4.14 */
+#endif
+#endif
+
+#if defined(PRO_HAS_KTLS)
+#if !defined(TLS_RX) || !defined(TLS_GET_RECORD_TYPE) || !defined(TLS_CIPHER_AES_GCM_256)
+#undef  PRO_HAS_KTLS /* the headers are older than Linux 4.17 */
+#else
+#if !defined(SOL_TLS)
+#define SOL_TLS 282
+#endif
+#if !defined(TCP_ULP)
+#define TCP_ULP 31
+#endif
+#endif
+#endif
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
@@ -359,6 +395,18 @@ pbsd_recvmsg(PRO_INT64    fd,
              pbsd_msghdr* msg,
              int          flags);
 
+#if defined(PRO_HAS_MSG_ZEROCOPY)
+
+/*
+ * reads a message from the error queue, without waiting
+ */
+int
+PRO_CALLTYPE
+pbsd_recvmsg_errqueue(PRO_INT64    fd,
+                      pbsd_msghdr* msg);
+
+#endif /* PRO_HAS_MSG_ZEROCOPY */
+
 int
 PRO_CALLTYPE
 pbsd_select(PRO_INT64       nfds,
@@ -389,6 +437,29 @@ pbsd_epoll_wait(int               epfd,
 
 #endif /* PRO_HAS_EPOLL */
 
+#if defined(PRO_HAS_IO_URING)
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_setup(unsigned int            entries,
+                    struct io_uring_params* params);
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_enter(int          ringfd,
+                    unsigned int toSubmit,
+                    unsigned int minComplete,
+                    unsigned int flags);
+
+int
+PRO_CALLTYPE
+pbsd_io_uring_register(int          ringfd,
+                       unsigned int opcode,
+                       void*        arg,
+                       unsigned int argCount);
+
+#endif /* PRO_HAS_IO_URING */
+
 void
 PRO_CALLTYPE
 pbsd_shutdown_send(PRO_INT64 fd);
@@ -161,7 +161,7 @@ CProChannelTaskPool::RemoveChannel(PRO_UINT64 channelId)
             return;
         }
 
-        CProStlMap<PRO_UINT64, CProFunctorCommandTask*>::iterator const itr =
+        CProStlHashMap<PRO_UINT64, CProFunctorCommandTask*>::iterator const itr =
             m_channelId2Task.find(channelId);
         if (itr == m_channelId2Task.end())
         {
@@ -191,7 +191,7 @@ CProChannelTaskPool::Put(PRO_UINT64          channelId,
             return (false);
         }
 
-        CProStlMap<PRO_UINT64, CProFunctorCommandTask*>::iterator const itr =
+        CProStlHashMap<PRO_UINT64, CProFunctorCommandTask*>::iterator const itr =
             m_channelId2Task.find(channelId);
         if (itr == m_channelId2Task.end())
         {
@@ -20,21 +20,88 @@
 #include "pro_functor_command_task.h"
 #include "pro_functor_command.h"
 #include "pro_memory_pool.h"
+#include "pro_ref_count.h"
 #include "pro_stl.h"
 #include "pro_thread.h"
 #include "pro_thread_mutex.h"
+#include "pro_time_util.h"
 #include "pro_z.h"
 #include <cassert>
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#define SPIN_COUNT 2000 /* polls before sleeping */
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * the user data of a queued command is the link, so a blocking command is
+ * wrapped, and its producer waits on the wrapper
+ */
+class CProBlockingCommand : public IProFunctorCommand
+{
+public:
+
+    CProBlockingCommand(IProFunctorCommand* command)
+    : m_command(command)
+    {
+        m_userData = NULL;
+    }
+
+    void Wait()
+    {
+        m_cond.Wait(NULL);
+    }
+
+private:
+
+    virtual void PRO_CALLTYPE Destroy()
+    {
+        m_command->Destroy();
+        m_cond.Signal();
+    }
+
+    virtual void PRO_CALLTYPE Execute()
+    {
+        m_command->Execute();
+    }
+
+    virtual void PRO_CALLTYPE SetUserData(const void* userData)
+    {
+        m_userData = userData;
+    }
+
+    virtual const void* PRO_CALLTYPE GetUserData() const
+    {
+        return (m_userData);
+    }
+
+private:
+
+    IProFunctorCommand* const m_command;
+    const void*               m_userData;
+    CProThreadMutexCondition  m_cond;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CProFunctorCommandTask::CProFunctorCommandTask()
 {
     m_userData       = NULL;
     m_threadCount    = 0;
     m_curThreadCount = 0;
     m_wantExit       = false;
+    m_lockFree       = false;
+    m_head           = NULL;
+    m_size           = 0;
+    m_putCount       = 0;
+    m_sleeping       = 0;
+    m_exitState      = 0;
 }
 
 CProFunctorCommandTask::~CProFunctorCommandTask()
@@ -44,7 +111,8 @@ CProFunctorCommandTask::~CProFunctorCommandTask()
 
 bool
 CProFunctorCommandTask::Start(bool          realtime,    /* = false */
-                              unsigned long threadCount) /* = 1 */
+                              unsigned long threadCount, /* = 1 */
+                              bool          lockFree)    /* = true */
 {{
     CProThreadMutexGuard mon(m_lockAtom);
 
@@ -64,6 +132,7 @@ CProFunctorCommandTask::Start(bool          realtime,    /* = false */
         }
 
         m_threadCount = threadCount; /* for StopMe(...) */
+        m_lockFree    = lockFree && threadCount == 1;
 
         /*
          * threads
@@ -124,6 +193,21 @@ CProFunctorCommandTask::StopMe()
 
         m_wantExit = true;
 
+        if (m_lockFree)
+        {
+            ProAtomicStore(&m_exitState, 1);
+
+            /*
+             * no command is put after this point
+             */
+            while (ProAtomicLoad(&m_putCount) > 0)
+            {
+                ProSleep(1);
+            }
+
+            ProAtomicStore(&m_exitState, 2);
+        }
+
         while (GetThreadCount() > 0)
         {
             m_commandCond.Signal();
@@ -137,6 +221,11 @@ CProFunctorCommandTask::StopMe()
         m_threadCount    = 0;
         m_curThreadCount = 0;
         m_wantExit       = false;
+        m_lockFree       = false;
+        m_head           = NULL;
+        m_size           = 0;
+        m_sleeping       = 0;
+        m_exitState      = 0;
     }
 }}
 
@@ -150,6 +239,11 @@ CProFunctorCommandTask::Put(IProFunctorCommand* command,
         return (false);
     }
 
+    if (m_lockFree)
+    {
+        return (PutLockFree(command, blocking));
+    }
+
     CProThreadMutexCondition cond;
 
     {
@@ -181,9 +275,64 @@ CProFunctorCommandTask::Put(IProFunctorCommand* command,
     return (true);
 }
 
+bool
+CProFunctorCommandTask::PutLockFree(IProFunctorCommand* command,
+                                    bool                blocking)
+{
+    ProAtomicAdd(&m_putCount, 1);
+
+    if (ProAtomicLoad(&m_exitState) != 0 || m_curThreadCount == 0)
+    {
+        ProAtomicAdd(&m_putCount, -1);
+
+        return (false);
+    }
+
+    CProBlockingCommand blockingCommand(command);
+    if (blocking)
+    {
+        command = &blockingCommand;
+    }
+
+    ProAtomicAdd(&m_size, 1);
+
+    while (1)
+    {
+        IProFunctorCommand* const head = (IProFunctorCommand*)ProAtomicLoadPtr((void**)&m_head);
+        command->SetUserData(head);
+
+        if (ProAtomicCasPtr((void**)&m_head, head, command))
+        {
+            break;
+        }
+    }
+
+    /*
+     * the consumer checks the queue after setting "m_sleeping"
+     */
+    if (ProAtomicLoad(&m_sleeping) != 0 && ProAtomicCas(&m_sleeping, 1, 0))
+    {
+        m_commandCond.Signal();
+    }
+
+    ProAtomicAdd(&m_putCount, -1);
+
+    if (blocking)
+    {
+        blockingCommand.Wait();
+    }
+
+    return (true);
+}
+
 unsigned long
 CProFunctorCommandTask::GetSize() const
 {
+    if (m_lockFree)
+    {
+        return ((unsigned long)ProAtomicLoad((volatile long*)&m_size));
+    }
+
     unsigned long size = 0;
 
     {
@@ -232,6 +381,19 @@ CProFunctorCommandTask::Svc()
         m_initCond.Signal();
     }
 
+    if (m_lockFree)
+    {
+        SvcLockFree();
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_threadIds.erase(threadId);
+        }
+
+        return;
+    }
+
     CProStlDeque<IProFunctorCommand*> commands;
 
     while (1)
@@ -298,3 +460,76 @@ CProFunctorCommandTask::Svc()
         m_threadIds.erase(threadId);
     }
 }
+
+void
+CProFunctorCommandTask::SvcLockFree()
+{
+    CProStlVector<IProFunctorCommand*> commands;
+
+    while (1)
+    {
+        IProFunctorCommand* command = (IProFunctorCommand*)ProAtomicExchangePtr((void**)&m_head, NULL);
+
+        if (command == NULL)
+        {
+            if (ProAtomicLoad(&m_exitState) == 2)
+            {
+                command = (IProFunctorCommand*)ProAtomicExchangePtr((void**)&m_head, NULL);
+                if (command == NULL)
+                {
+                    break;
+                }
+            }
+        }
+
+        if (command == NULL)
+        {
+            for (int i = 0; i < SPIN_COUNT; ++i)
+            {
+                if ((IProFunctorCommand*)ProAtomicLoadPtr((void**)&m_head) != NULL)
+                {
+                    break;
+                }
+            }
+
+            if ((IProFunctorCommand*)ProAtomicLoadPtr((void**)&m_head) != NULL)
+            {
+                continue;
+            }
+
+            /*
+             * the producers check "m_sleeping" after pushing
+             */
+            ProAtomicStore(&m_sleeping, 1);
+
+            if ((IProFunctorCommand*)ProAtomicLoadPtr((void**)&m_head) == NULL &&
+                ProAtomicLoad(&m_exitState) != 2)
+            {
+                m_commandCond.Wait(NULL);
+            }
+
+            ProAtomicStore(&m_sleeping, 0);
+
+            continue;
+        }
+
+        /*
+         * the newest is the first
+         */
+        commands.clear();
+
+        for (; command != NULL;
+            command = (IProFunctorCommand*)command->GetUserData())
+        {
+            commands.push_back(command);
+        }
+
+        ProAtomicAdd(&m_size, -(long)commands.size());
+
+        for (int i = (int)commands.size() - 1; i >= 0; --i)
+        {
+            commands[i]->Execute();
+            commands[i]->Destroy();
+        }
+    } /* end of while (...) */
+}
@@ -0,0 +1,762 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "pro_a.h"
+#include "pro_functor_command_task_pool.h"
+#include "pro_functor_command.h"
+#include "pro_memory_pool.h"
+#include "pro_ref_count.h"
+#include "pro_stl.h"
+#include "pro_thread.h"
+#include "pro_thread_mutex.h"
+#include "pro_time_util.h"
+#include "pro_z.h"
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN32_WCE)
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define SLOT_COUNT  256 /* a power of 2 */
+#define SLOT_MASK   (SLOT_COUNT - 1)
+#define BATCH_COUNT 32  /* commands of a slot per run */
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+struct PRO_TASK_POOL_ITEM
+{
+    IProFunctorCommand* command;
+    PRO_INT64           putTick;
+
+    DECLARE_SGI_POOL(0)
+};
+
+struct PRO_TASK_POOL_SLOT
+{
+    PRO_TASK_POOL_SLOT()
+    {
+        scheduled = false;
+    }
+
+    bool                             scheduled; /* in an inbox or a deque, or running */
+    CProStlDeque<PRO_TASK_POOL_ITEM> items;
+    CProThreadMutex                  lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/*
+ * "top", "bottom" and "entries" are a Chase-Lev deque. The owner pushes and
+ * pops at the bottom, and the thieves steal at the top. A slot is queued at
+ * most once, so the deque never overflows.
+ */
+struct PRO_TASK_POOL_WORKER
+{
+    PRO_TASK_POOL_WORKER()
+    {
+        top         = 0;
+        bottom      = 0;
+        inboxSize   = 0;
+        sleeping    = 0;
+        doneCount   = 0;
+        stealCount  = 0;
+        totalWaitMs = 0;
+        maxWaitMs   = 0;
+    }
+
+    volatile long                top;
+    volatile long                bottom;
+    unsigned long                entries[SLOT_COUNT];
+    CProStlVector<unsigned long> inbox;     /* slots scheduled by Put() */
+    volatile long                inboxSize;
+    CProThreadMutex              inboxLock;
+    volatile long                sleeping;
+    CProThreadMutexCondition     wakeCond;
+    PRO_UINT64                   doneCount;
+    PRO_UINT64                   stealCount;
+    PRO_UINT64                   totalWaitMs;
+    PRO_UINT64                   maxWaitMs;
+    mutable CProThreadMutex      statLock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * the distance from "from" to "to", wrap-around safe
+ */
+static
+inline
+long
+PRO_CALLTYPE
+Distance_i(long from,
+           long to)
+{
+    return ((long)((unsigned long)to - (unsigned long)from));
+}
+
+static
+inline
+void
+PRO_CALLTYPE
+DequePush_i(PRO_TASK_POOL_WORKER& worker,
+            unsigned long         slotIndex)
+{
+    const long bottom = ProAtomicLoad(&worker.bottom);
+
+    worker.entries[(unsigned long)bottom & SLOT_MASK] = slotIndex;
+    ProAtomicStore(&worker.bottom, (long)((unsigned long)bottom + 1));
+}
+
+static
+bool
+PRO_CALLTYPE
+DequePop_i(PRO_TASK_POOL_WORKER& worker,
+           unsigned long&        slotIndex)
+{
+    const long bottom = (long)((unsigned long)ProAtomicLoad(&worker.bottom) - 1);
+    ProAtomicStore(&worker.bottom, bottom);
+
+    const long top  = ProAtomicLoad(&worker.top);
+    const long size = Distance_i(top, bottom) + 1;
+    if (size <= 0)
+    {
+        ProAtomicStore(&worker.bottom, (long)((unsigned long)bottom + 1));
+
+        return (false);
+    }
+
+    slotIndex = worker.entries[(unsigned long)bottom & SLOT_MASK];
+    if (size > 1)
+    {
+        return (true);
+    }
+
+    /*
+     * the last one, racing with the thieves
+     */
+    const bool ret = ProAtomicCas(&worker.top, top, (long)((unsigned long)top + 1));
+    ProAtomicStore(&worker.bottom, (long)((unsigned long)top + 1));
+
+    return (ret);
+}
+
+static
+bool
+PRO_CALLTYPE
+DequeSteal_i(PRO_TASK_POOL_WORKER& worker,
+             unsigned long&        slotIndex)
+{
+    const long top    = ProAtomicLoad(&worker.top);
+    const long bottom = ProAtomicLoad(&worker.bottom);
+    if (Distance_i(top, bottom) <= 0)
+    {
+        return (false);
+    }
+
+    slotIndex = worker.entries[(unsigned long)top & SLOT_MASK];
+
+    return (ProAtomicCas(&worker.top, top, (long)((unsigned long)top + 1)));
+}
+
+static
+inline
+long
+PRO_CALLTYPE
+DequeSize_i(PRO_TASK_POOL_WORKER& worker)
+{
+    const long top    = ProAtomicLoad(&worker.top);
+    const long bottom = ProAtomicLoad(&worker.bottom);
+
+    return (Distance_i(top, bottom));
+}
+
+static
+unsigned long
+PRO_CALLTYPE
+GetProcessorCount_i()
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    SYSTEM_INFO info;
+    ::GetSystemInfo(&info);
+    const long count = (long)info.dwNumberOfProcessors;
+#else
+    const long count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+    return (count > 0 ? (unsigned long)count : 1);
+}
+
+static
+void
+PRO_CALLTYPE
+Execute_i(IProFunctorCommand* command)
+{
+    command->Execute();
+
+    CProThreadMutexCondition* const cond =
+        (CProThreadMutexCondition*)command->GetUserData();
+    if (cond != NULL)
+    {
+        cond->Signal();
+    }
+
+    command->Destroy();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CProFunctorCommandTaskPool::CProFunctorCommandTaskPool()
+{
+    m_threadCount     = 0;
+    m_curThreadCount  = 0;
+    m_slots           = NULL;
+    m_workers         = NULL;
+    m_pendingCount    = 0;
+    m_maxPendingCount = 0;
+    m_idleCount       = 0;
+    m_putCount        = 0;
+    m_wantExit        = 0;
+    m_canExit         = 0;
+}
+
+CProFunctorCommandTaskPool::~CProFunctorCommandTaskPool()
+{
+    Stop();
+}
+
+bool
+CProFunctorCommandTaskPool::Start(unsigned long threadCount, /* = 0 */
+                                  bool          realtime)    /* = false */
+{{
+    CProThreadMutexGuard mon(m_lockAtom);
+
+    if (threadCount == 0)
+    {
+        threadCount = GetProcessorCount_i();
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_threadCount == 0);
+        if (m_threadCount != 0)
+        {
+            return (false);
+        }
+
+        m_slots       = new PRO_TASK_POOL_SLOT[SLOT_COUNT];
+        m_workers     = new PRO_TASK_POOL_WORKER[threadCount];
+        m_threadCount = threadCount; /* for StopMe(...) */
+
+        /*
+         * threads
+         */
+        {
+            int i;
+
+            for (i = 0; i < (int)m_threadCount; ++i)
+            {
+                if (!Spawn(realtime))
+                {
+                    break;
+                }
+            }
+
+            assert(i == (int)m_threadCount);
+            if (i != (int)m_threadCount)
+            {
+                goto EXIT;
+            }
+        }
+
+        while (m_curThreadCount < m_threadCount)
+        {
+            m_initCond.Wait(&m_lock);
+        }
+    }
+
+    return (true);
+
+EXIT:
+
+    StopMe();
+
+    return (false);
+}}
+
+void
+CProFunctorCommandTaskPool::Stop()
+{{
+    CProThreadMutexGuard mon(m_lockAtom);
+
+    StopMe();
+}}
+
+void
+CProFunctorCommandTaskPool::StopMe()
+{{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_threadCount == 0)
+        {
+            return;
+        }
+
+        ProAtomicStore(&m_wantExit, 1);
+
+        /*
+         * no command is put after this point
+         */
+        while (ProAtomicLoad(&m_putCount) > 0)
+        {
+            ProSleep(1);
+        }
+
+        ProAtomicStore(&m_canExit, 1);
+
+        while (GetThreadCount() > 0)
+        {
+            for (int i = 0; i < (int)m_threadCount; ++i)
+            {
+                m_workers[i].wakeCond.Signal();
+            }
+
+            m_lock.Unlock();
+            Wait1();
+            m_lock.Lock();
+        }
+
+        delete [] m_workers;
+        delete [] m_slots;
+        m_threadCount     = 0;
+        m_curThreadCount  = 0;
+        m_slots           = NULL;
+        m_workers         = NULL;
+        m_pendingCount    = 0;
+        m_maxPendingCount = 0;
+        m_idleCount       = 0;
+        m_wantExit        = 0;
+        m_canExit         = 0;
+    }
+}}
+
+bool
+CProFunctorCommandTaskPool::Put(PRO_UINT64          key,
+                                IProFunctorCommand* command,
+                                bool                blocking) /* = false */
+{
+    assert(command != NULL);
+    if (command == NULL)
+    {
+        return (false);
+    }
+
+    ProAtomicAdd(&m_putCount, 1);
+
+    if (ProAtomicLoad(&m_wantExit) != 0 || m_threadCount == 0 ||
+        m_curThreadCount < m_threadCount)
+    {
+        ProAtomicAdd(&m_putCount, -1);
+
+        return (false);
+    }
+
+    CProThreadMutexCondition cond;
+
+    if (blocking)
+    {
+        command->SetUserData(&cond);
+    }
+    else
+    {
+        command->SetUserData(NULL);
+    }
+
+    PRO_TASK_POOL_ITEM item;
+    item.command = command;
+    item.putTick = ProGetTickCount64();
+
+    const unsigned long slotIndex = (unsigned long)ProStlHash(key) & SLOT_MASK;
+    PRO_TASK_POOL_SLOT& slot      = m_slots[slotIndex];
+    bool                schedule  = false;
+
+    const long pendingCount = ProAtomicAdd(&m_pendingCount, 1);
+
+    {
+        CProThreadMutexGuard mon(slot.lock);
+
+        slot.items.push_back(item);
+        if (!slot.scheduled)
+        {
+            slot.scheduled = true;
+            schedule       = true;
+        }
+    }
+
+    if (schedule)
+    {
+        Schedule(slotIndex);
+    }
+
+    while (1)
+    {
+        const long maxPendingCount = ProAtomicLoad(&m_maxPendingCount);
+        if (pendingCount <= maxPendingCount ||
+            ProAtomicCas(&m_maxPendingCount, maxPendingCount, pendingCount))
+        {
+            break;
+        }
+    }
+
+    ProAtomicAdd(&m_putCount, -1);
+
+    if (blocking)
+    {
+        cond.Wait(NULL);
+    }
+
+    return (true);
+}
+
+unsigned long
+CProFunctorCommandTaskPool::GetSize() const
+{
+    return ((unsigned long)ProAtomicLoad((volatile long*)&m_pendingCount));
+}
+
+void
+CProFunctorCommandTaskPool::GetStats(PRO_TASK_POOL_STATS* stats) const
+{
+    assert(stats != NULL);
+    if (stats == NULL)
+    {
+        return;
+    }
+
+    memset(stats, 0, sizeof(PRO_TASK_POOL_STATS));
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_threadCount == 0)
+        {
+            return;
+        }
+
+        stats->threadCount     = m_threadCount;
+        stats->pendingCount    = (unsigned long)ProAtomicLoad((volatile long*)&m_pendingCount);
+        stats->maxPendingCount = (unsigned long)ProAtomicLoad((volatile long*)&m_maxPendingCount);
+
+        PRO_UINT64 totalWaitMs = 0;
+
+        for (int i = 0; i < (int)m_threadCount; ++i)
+        {
+            const PRO_TASK_POOL_WORKER& worker = m_workers[i];
+
+            CProThreadMutexGuard mon2(worker.statLock);
+
+            stats->doneCount  += worker.doneCount;
+            stats->stealCount += worker.stealCount;
+            totalWaitMs       += worker.totalWaitMs;
+            if (worker.maxWaitMs > stats->maxWaitMs)
+            {
+                stats->maxWaitMs = worker.maxWaitMs;
+            }
+        }
+
+        if (stats->doneCount > 0)
+        {
+            stats->avgWaitMs = totalWaitMs / stats->doneCount;
+        }
+    }
+}
+
+void
+CProFunctorCommandTaskPool::Svc()
+{
+    unsigned long index = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        index = m_curThreadCount;
+        ++m_curThreadCount;
+        m_initCond.Signal();
+    }
+
+    PRO_TASK_POOL_WORKER& worker = m_workers[index];
+
+    while (1)
+    {
+        unsigned long slotIndex = 0;
+        bool          stolen    = false;
+
+        if (FindWork(index, slotIndex, stolen))
+        {
+            RunSlot(index, slotIndex, stolen);
+            continue;
+        }
+
+        if (ProAtomicLoad(&m_canExit) != 0)
+        {
+            break;
+        }
+
+        /*
+         * park. Put() checks "sleeping" after queueing, and we check the
+         * queues after setting it, so no wakeup is lost
+         */
+        ProAtomicStore(&worker.sleeping, 1);
+        ProAtomicAdd(&m_idleCount, 1);
+
+        if (HasWork() || ProAtomicLoad(&m_canExit) != 0)
+        {
+            ProAtomicStore(&worker.sleeping, 0);
+        }
+        else
+        {
+            worker.wakeCond.Wait(NULL);
+        }
+
+        ProAtomicAdd(&m_idleCount, -1);
+    }
+}
+
+bool
+CProFunctorCommandTaskPool::FindWork(unsigned long  index,
+                                     unsigned long& slotIndex,
+                                     bool&          stolen)
+{
+    PRO_TASK_POOL_WORKER& worker = m_workers[index];
+
+    stolen = false;
+
+    if (DequePop_i(worker, slotIndex))
+    {
+        return (true);
+    }
+
+    if (ProAtomicLoad(&worker.inboxSize) > 0)
+    {
+        CProStlVector<unsigned long> inbox;
+
+        {
+            CProThreadMutexGuard mon(worker.inboxLock);
+
+            inbox.swap(worker.inbox);
+            ProAtomicStore(&worker.inboxSize, 0);
+        }
+
+        if (inbox.size() > 0)
+        {
+            for (int i = 1; i < (int)inbox.size(); ++i)
+            {
+                DequePush_i(worker, inbox[i]);
+            }
+
+            if (inbox.size() > 1 && ProAtomicLoad(&m_idleCount) > 0)
+            {
+                Wake(index); /* a thief */
+            }
+
+            slotIndex = inbox[0];
+
+            return (true);
+        }
+    }
+
+    /*
+     * steal from the others
+     */
+    for (int i = 1; i < (int)m_threadCount; ++i)
+    {
+        PRO_TASK_POOL_WORKER& victim = m_workers[(index + i) % m_threadCount];
+
+        if (DequeSteal_i(victim, slotIndex))
+        {
+            stolen = true;
+
+            return (true);
+        }
+
+        if (ProAtomicLoad(&victim.inboxSize) > 0)
+        {
+            CProThreadMutexGuard mon(victim.inboxLock);
+
+            if (victim.inbox.size() > 0)
+            {
+                slotIndex = victim.inbox.back();
+                victim.inbox.pop_back();
+                ProAtomicStore(&victim.inboxSize, (long)victim.inbox.size());
+                stolen = true;
+
+                return (true);
+            }
+        }
+    }
+
+    return (false);
+}
+
+bool
+CProFunctorCommandTaskPool::HasWork() const
+{
+    for (int i = 0; i < (int)m_threadCount; ++i)
+    {
+        PRO_TASK_POOL_WORKER& worker = m_workers[i];
+
+        if (DequeSize_i(worker) > 0 || ProAtomicLoad(&worker.inboxSize) > 0)
+        {
+            return (true);
+        }
+    }
+
+    return (false);
+}
+
+void
+CProFunctorCommandTaskPool::RunSlot(unsigned long index,
+                                    unsigned long slotIndex,
+                                    bool          stolen)
+{
+    PRO_TASK_POOL_WORKER& worker = m_workers[index];
+    PRO_TASK_POOL_SLOT&   slot   = m_slots[slotIndex];
+    PRO_UINT64            done   = 0;
+    PRO_UINT64            waitMs = 0;
+    PRO_UINT64            maxMs  = 0;
+    bool                  more   = true;
+
+    for (int i = 0; i < BATCH_COUNT; ++i)
+    {
+        PRO_TASK_POOL_ITEM item;
+
+        {
+            CProThreadMutexGuard mon(slot.lock);
+
+            if (slot.items.size() == 0)
+            {
+                slot.scheduled = false;
+                more           = false;
+                break;
+            }
+
+            item = slot.items.front();
+            slot.items.pop_front();
+        }
+
+        ProAtomicAdd(&m_pendingCount, -1);
+
+        const PRO_INT64 tick = ProGetTickCount64();
+        if (tick > item.putTick)
+        {
+            const PRO_UINT64 ms = (PRO_UINT64)(tick - item.putTick);
+            waitMs += ms;
+            if (ms > maxMs)
+            {
+                maxMs = ms;
+            }
+        }
+
+        Execute_i(item.command);
+        ++done;
+    }
+
+    if (more)
+    {
+        CProThreadMutexGuard mon(slot.lock);
+
+        if (slot.items.size() == 0)
+        {
+            slot.scheduled = false;
+            more           = false;
+        }
+    }
+
+    if (more)
+    {
+        DequePush_i(worker, slotIndex); /* still scheduled, and stealable */
+    }
+
+    {
+        CProThreadMutexGuard mon(worker.statLock);
+
+        worker.doneCount   += done;
+        worker.totalWaitMs += waitMs;
+        if (maxMs > worker.maxWaitMs)
+        {
+            worker.maxWaitMs = maxMs;
+        }
+        if (stolen)
+        {
+            ++worker.stealCount;
+        }
+    }
+}
+
+void
+CProFunctorCommandTaskPool::Schedule(unsigned long slotIndex)
+{
+    const unsigned long   index  = slotIndex % m_threadCount; /* the home thread */
+    PRO_TASK_POOL_WORKER& worker = m_workers[index];
+
+    {
+        CProThreadMutexGuard mon(worker.inboxLock);
+
+        worker.inbox.push_back(slotIndex);
+        ProAtomicStore(&worker.inboxSize, (long)worker.inbox.size());
+    }
+
+    if (ProAtomicCas(&worker.sleeping, 1, 0))
+    {
+        worker.wakeCond.Signal();
+    }
+    else if (ProAtomicLoad(&m_idleCount) > 0)
+    {
+        Wake(index); /* a thief, for the busy home thread */
+    }
+    else
+    {
+    }
+}
+
+void
+CProFunctorCommandTaskPool::Wake(unsigned long index)
+{
+    for (int i = 1; i < (int)m_threadCount; ++i)
+    {
+        PRO_TASK_POOL_WORKER& worker = m_workers[(index + i) % m_threadCount];
+
+        if (ProAtomicCas(&worker.sleeping, 1, 0))
+        {
+            worker.wakeCond.Signal();
+            break;
+        }
+    }
+}
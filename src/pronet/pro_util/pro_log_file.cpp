@@ -20,32 +20,51 @@
 #include "pro_log_file.h"
 #include "pro_bsd_wrapper.h"
 #include "pro_memory_pool.h"
+#include "pro_ref_count.h"
 #include "pro_stl.h"
+#include "pro_thread.h"
 #include "pro_thread_mutex.h"
 #include "pro_time_util.h"
 #include "pro_z.h"
 #include <cassert>
 #include <cstdio>
+#include <cstring>
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
 #define REOPEN_INTERVAL_MS 1000
+#define WRITE_INTERVAL_MS  10
+#define RING_MASK          (PRO_LOG_RING_BYTES - 1)
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
 CProLogFile::CProLogFile()
 {
-    m_fileName   = "";
-    m_file       = NULL;
-    m_reopenTick = 0;
-    m_greenLevel = 0;
-    m_maxSize    = 0;
+    m_fileName      = "";
+    m_file          = NULL;
+    m_reopenTick    = 0;
+    m_greenLevel    = 0;
+    m_maxSize       = 0;
+
+    m_async         = false;
+    m_blockIfFull   = false;
+    m_asyncStopping = false;
+    m_ringCount     = 1; /* the shared one */
+    m_dropCount     = 0;
 }
 
 CProLogFile::~CProLogFile()
 {
+    DisableAsync();
+
+    for (int i = 0; i < PRO_LOG_RING_COUNT; ++i)
+    {
+        ProFree(m_rings[i].buffer);
+        m_rings[i].buffer = NULL;
+    }
+
     if (m_file != NULL)
     {
         fclose(m_file);
@@ -150,6 +169,11 @@ CProLogFile::Log(const char* text,
         return;
     }
 
+    if (level < m_greenLevel) /* before formatting */
+    {
+        return;
+    }
+
     CProStlString totalString = "";
 
     if (showTime)
@@ -169,53 +193,278 @@ CProLogFile::Log(const char* text,
 
     totalString += text;
 
+    if (m_async && PushToRing(totalString.c_str(), totalString.length()))
+    {
+        return;
+    }
+
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (level < m_greenLevel)
+        Write(totalString.c_str(), totalString.length());
+    }
+}
+
+bool
+CProLogFile::EnableAsync(bool blockIfFull) /* = false */
+{
+    CProThreadMutexGuard mon(m_asyncLock);
+
+    if (m_async)
+    {
+        return (true);
+    }
+
+    if (m_rings[0].buffer == NULL)
+    {
+        m_rings[0].buffer = (char*)ProMalloc(PRO_LOG_RING_BYTES);
+        if (m_rings[0].buffer == NULL)
         {
-            return;
+            return (false);
         }
+    }
+
+    m_blockIfFull   = blockIfFull;
+    m_asyncStopping = false;
+
+    if (!Spawn(false))
+    {
+        return (false);
+    }
+
+    m_async = true;
+
+    return (true);
+}
 
-        if (m_file == NULL &&
-            ProGetTickCount64() - m_reopenTick >= REOPEN_INTERVAL_MS)
+void
+CProLogFile::DisableAsync()
+{
+    CProThreadMutexGuard mon(m_asyncLock);
+
+    if (!m_async)
+    {
+        return;
+    }
+
+    m_async         = false;
+    m_asyncStopping = true;
+
+    WaitAll(); /* the writer drains the rings before exiting */
+}
+
+PRO_UINT64
+CProLogFile::GetDroppedCount() const
+{
+    const PRO_UINT64 count =
+        (unsigned long)ProAtomicLoad((volatile long*)&m_dropCount);
+
+    return (count);
+}
+
+void
+CProLogFile::Svc()
+{
+    CProStlString batch;
+
+    while (1)
+    {
+        const bool stopping = m_asyncStopping; /* read before the last drain */
+
+        batch.resize(0);
+        if (DrainRings(batch))
         {
-            Reopen(true); /* reopen the file at this moment */
+            CProThreadMutexGuard mon(m_lock);
+
+            Write(batch.c_str(), batch.length());
         }
-        if (m_file == NULL)
+
+        if (stopping)
         {
-            return;
+            break;
         }
 
-        const PRO_INT32 pos = (PRO_INT32)ftell(m_file);
-        if (
-            pos < 0
-            ||
-            (m_maxSize > 0 && pos >= m_maxSize)
-           )
+        ProSleep(WRITE_INTERVAL_MS);
+    }
+}
+
+bool
+CProLogFile::PushToRing(const char* text,
+                        size_t      size)
+{
+    if (size > PRO_LOG_RING_BYTES)
+    {
+        return (false);
+    }
+
+    PRO_LOG_RING* const ring = GetRing();
+    if (ring == NULL)
+    {
+        return (false);
+    }
+
+    const bool shared = ring == &m_rings[0];
+    if (shared)
+    {
+        m_ringLock.Lock();
+    }
+
+    const unsigned long tail = ring->tail; /* only the producer writes it */
+
+    while (1)
+    {
+        const unsigned long head = (unsigned long)ProAtomicLoad((volatile long*)&ring->head);
+        if (PRO_LOG_RING_BYTES - (tail - head) >= size)
+        {
+            break;
+        }
+
+        if (!m_blockIfFull || m_asyncStopping)
         {
-            fclose(m_file);
-            m_file = NULL;
+            ProAtomicAdd((volatile long*)&m_dropCount, 1);
 
-            Move_1();
-            Reopen(false); /* remake the file at this moment */
+            if (shared)
+            {
+                m_ringLock.Unlock();
+            }
+
+            return (true); /* dropped */
         }
-        if (m_file == NULL)
+
+        ProSleep(1);
+    }
+
+    const size_t offset = tail & RING_MASK;
+    const size_t size1  = size < PRO_LOG_RING_BYTES - offset
+                        ? size : PRO_LOG_RING_BYTES - offset;
+
+    memcpy(ring->buffer + offset, text, size1);
+    memcpy(ring->buffer, text + size1, size - size1);
+    ProAtomicStore((volatile long*)&ring->tail, (long)(tail + (unsigned long)size));
+
+    if (shared)
+    {
+        m_ringLock.Unlock();
+    }
+
+    return (true);
+}
+
+PRO_LOG_RING*
+CProLogFile::GetRing()
+{
+    const PRO_UINT64    threadId = ProGetThreadId();
+    const unsigned long count    = (unsigned long)ProAtomicLoad((volatile long*)&m_ringCount);
+
+    for (unsigned long i = 1; i < count; ++i)
+    {
+        if (m_rings[i].threadId == threadId)
+        {
+            return (&m_rings[i]);
+        }
+    }
+
+    /*
+     * only this thread claims a ring for itself, so it can't be claimed
+     * since the scan above
+     */
+    {
+        CProThreadMutexGuard mon(m_ringLock);
+
+        if (m_ringCount < PRO_LOG_RING_COUNT)
         {
-            return;
+            PRO_LOG_RING& ring = m_rings[m_ringCount];
+
+            ring.buffer = (char*)ProMalloc(PRO_LOG_RING_BYTES);
+            if (ring.buffer == NULL)
+            {
+                return (NULL);
+            }
+
+            ring.threadId = threadId;
+            ProAtomicStore((volatile long*)&m_ringCount, (long)(m_ringCount + 1)); /* publish it */
+
+            return (&ring);
         }
+    }
+
+    return (&m_rings[0]);
+}
+
+bool
+CProLogFile::DrainRings(CProStlString& batch)
+{
+    const unsigned long count = (unsigned long)ProAtomicLoad((volatile long*)&m_ringCount);
 
-        const size_t ret = fwrite(
-            totalString.c_str(), 1, totalString.length(), m_file);
-        if (ret != totalString.length())
+    for (unsigned long i = 0; i < count; ++i)
+    {
+        PRO_LOG_RING& ring = m_rings[i];
+        if (ring.buffer == NULL)
         {
-            fclose(m_file);
-            m_file = NULL;
+            continue;
         }
-        else
+
+        const unsigned long head = ring.head; /* only the writer writes it */
+        const unsigned long tail = (unsigned long)ProAtomicLoad((volatile long*)&ring.tail);
+        if (tail == head)
         {
-            fflush(m_file);
+            continue;
         }
+
+        const size_t size   = tail - head;
+        const size_t offset = head & RING_MASK;
+        const size_t size1  = size < PRO_LOG_RING_BYTES - offset
+                            ? size : PRO_LOG_RING_BYTES - offset;
+
+        batch.append(ring.buffer + offset, size1);
+        batch.append(ring.buffer, size - size1);
+        ProAtomicStore((volatile long*)&ring.head, (long)tail);
+    }
+
+    return (!batch.empty());
+}
+
+void
+CProLogFile::Write(const char* data,
+                   size_t      size)
+{
+    if (m_file == NULL &&
+        ProGetTickCount64() - m_reopenTick >= REOPEN_INTERVAL_MS)
+    {
+        Reopen(true); /* reopen the file at this moment */
+    }
+    if (m_file == NULL)
+    {
+        return;
+    }
+
+    const PRO_INT32 pos = (PRO_INT32)ftell(m_file);
+    if (
+        pos < 0
+        ||
+        (m_maxSize > 0 && pos >= m_maxSize)
+       )
+    {
+        fclose(m_file);
+        m_file = NULL;
+
+        Move_1();
+        Reopen(false); /* remake the file at this moment */
+    }
+    if (m_file == NULL)
+    {
+        return;
+    }
+
+    const size_t ret = fwrite(data, 1, size, m_file);
+    if (ret != size)
+    {
+        fclose(m_file);
+        m_file = NULL;
+    }
+    else
+    {
+        fflush(m_file);
     }
 }
 
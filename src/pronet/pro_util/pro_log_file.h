@@ -22,6 +22,7 @@
 #include "pro_a.h"
 #include "pro_memory_pool.h"
 #include "pro_stl.h"
+#include "pro_thread.h"
 #include "pro_thread_mutex.h"
 #include <cstdio>
 
@@ -36,10 +37,40 @@
 #define PRO_LL_FATAL  3
 #define PRO_LL_MAX    9
 
+#define PRO_LOG_RING_COUNT 64          /* the 1st one is shared by the extra threads */
+#define PRO_LOG_RING_BYTES (64 * 1024) /* a power of 2 */
+
+struct PRO_LOG_RING
+{
+    PRO_LOG_RING()
+    {
+        threadId = 0;
+        buffer   = NULL;
+        head     = 0;
+        tail     = 0;
+    }
+
+    PRO_UINT64             threadId; /* the producer, set once */
+    char*                  buffer;
+    volatile unsigned long head;     /* advanced by the writer */
+    volatile unsigned long tail;     /* advanced by the producer */
+
+    DECLARE_SGI_POOL(0)
+};
+
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-class CProLogFile
+/*
+ * In the async mode, Log() appends the text to a ring of the calling thread
+ * without locking, and a background thread drains the rings every few
+ * milliseconds, writes them in one batch and rotates the file. The texts of
+ * one thread keep their order, but those of different threads may not.
+ *
+ * If a ring is full, the text is dropped and counted, or the caller waits
+ * for the writer if "blockIfFull" is true.
+ */
+class CProLogFile : public CProThreadBase
 {
 public:
 
@@ -71,8 +102,33 @@ public:
         bool        showTime
         );
 
+    bool EnableAsync(bool blockIfFull = false);
+
+    /*
+     * writes the pending texts, and stops the writer thread
+     */
+    void DisableAsync();
+
+    PRO_UINT64 GetDroppedCount() const;
+
 private:
 
+    virtual void Svc();
+
+    bool PushToRing(
+        const char* text,
+        size_t      size
+        );
+
+    PRO_LOG_RING* GetRing();
+
+    bool DrainRings(CProStlString& batch);
+
+    void Write(
+        const char* data,
+        size_t      size
+        );
+
     void Reopen(bool append);
 
     void Move_1();
@@ -82,10 +138,19 @@ private:
     CProStlString           m_fileName;
     FILE*                   m_file;
     PRO_INT64               m_reopenTick;
-    long                    m_greenLevel;
+    volatile long           m_greenLevel; /* read without locking */
     PRO_INT32               m_maxSize;
     mutable CProThreadMutex m_lock;
 
+    volatile bool           m_async;
+    bool                    m_blockIfFull;
+    volatile bool           m_asyncStopping;
+    PRO_LOG_RING            m_rings[PRO_LOG_RING_COUNT];
+    volatile unsigned long  m_ringCount;  /* the claimed ones */
+    volatile unsigned long  m_dropCount;
+    CProThreadMutex         m_ringLock;   /* for claiming and the shared ring */
+    CProThreadMutex         m_asyncLock;  /* for enabling and disabling */
+
     DECLARE_SGI_POOL(0)
 };
 
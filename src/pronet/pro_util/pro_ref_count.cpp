@@ -28,6 +28,13 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#if !defined(_WIN32) && !defined(_WIN32_WCE) && !defined(PRO_HAS_ATOMOP)
+static CProThreadMutex g_s_atomLock;
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 unsigned long
 PRO_CALLTYPE
 CProRefCount::AddRef()
@@ -66,3 +73,155 @@ CProRefCount::Release()
 
     return (refCount);
 }
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+long
+PRO_CALLTYPE
+ProAtomicLoad(const volatile long* p)
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    const long value = ::InterlockedExchangeAdd((long*)p, 0);
+#elif defined(PRO_HAS_ATOMOP)
+    const long value = __sync_add_and_fetch((volatile long*)p, 0);
+#else
+    g_s_atomLock.Lock();
+    const long value = *p;
+    g_s_atomLock.Unlock();
+#endif
+
+    return (value);
+}
+
+void
+PRO_CALLTYPE
+ProAtomicStore(volatile long* p,
+               long           value)
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    ::InterlockedExchange((long*)p, value);
+#elif defined(PRO_HAS_ATOMOP)
+    __sync_synchronize();
+    __sync_lock_test_and_set(p, value);
+#else
+    g_s_atomLock.Lock();
+    *p = value;
+    g_s_atomLock.Unlock();
+#endif
+}
+
+long
+PRO_CALLTYPE
+ProAtomicAdd(volatile long* p,
+             long           delta)
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    const long value = ::InterlockedExchangeAdd((long*)p, delta) + delta;
+#elif defined(PRO_HAS_ATOMOP)
+    const long value = __sync_add_and_fetch(p, delta);
+#else
+    g_s_atomLock.Lock();
+    *p += delta;
+    const long value = *p;
+    g_s_atomLock.Unlock();
+#endif
+
+    return (value);
+}
+
+bool
+PRO_CALLTYPE
+ProAtomicCas(volatile long* p,
+             long           oldValue,
+             long           newValue)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200) /* VC6 */
+    const bool ret = (long)::InterlockedCompareExchange(
+        (void**)p, (void*)newValue, (void*)oldValue) == oldValue;
+#elif defined(_WIN32) || defined(_WIN32_WCE)
+    const bool ret =
+        ::InterlockedCompareExchange((long*)p, newValue, oldValue) == oldValue;
+#elif defined(PRO_HAS_ATOMOP)
+    const bool ret = __sync_bool_compare_and_swap(p, oldValue, newValue);
+#else
+    g_s_atomLock.Lock();
+    const bool ret = *p == oldValue;
+    if (ret)
+    {
+        *p = newValue;
+    }
+    g_s_atomLock.Unlock();
+#endif
+
+    return (ret);
+}
+
+void*
+PRO_CALLTYPE
+ProAtomicLoadPtr(void* const volatile* p)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200) /* VC6 */
+    void* const value = ::InterlockedCompareExchange((void**)p, NULL, NULL);
+#elif defined(_WIN32) || defined(_WIN32_WCE)
+    void* const value = ::InterlockedCompareExchangePointer((void**)p, NULL, NULL);
+#elif defined(PRO_HAS_ATOMOP)
+    __sync_synchronize();
+    void* const value = *p;
+#else
+    g_s_atomLock.Lock();
+    void* const value = *p;
+    g_s_atomLock.Unlock();
+#endif
+
+    return (value);
+}
+
+void*
+PRO_CALLTYPE
+ProAtomicExchangePtr(void* volatile* p,
+                     void*           value)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200) /* VC6 */
+    void* const oldValue = (void*)::InterlockedExchange((long*)p, (long)value);
+#elif defined(_WIN32) || defined(_WIN32_WCE)
+    void* const oldValue = ::InterlockedExchangePointer((void**)p, value);
+#elif defined(PRO_HAS_ATOMOP)
+    __sync_synchronize();
+    void* const oldValue = __sync_lock_test_and_set(p, value);
+#else
+    g_s_atomLock.Lock();
+    void* const oldValue = *p;
+    *p = value;
+    g_s_atomLock.Unlock();
+#endif
+
+    return (oldValue);
+}
+
+bool
+PRO_CALLTYPE
+ProAtomicCasPtr(void* volatile* p,
+                void*           oldValue,
+                void*           newValue)
+{
+#if defined(_MSC_VER) && (_MSC_VER <= 1200) /* VC6 */
+    const bool ret = ::InterlockedCompareExchange(
+        (void**)p, newValue, oldValue) == oldValue;
+#elif defined(_WIN32) || defined(_WIN32_WCE)
+    const bool ret = ::InterlockedCompareExchangePointer(
+        (void**)p, newValue, oldValue) == oldValue;
+#elif defined(PRO_HAS_ATOMOP)
+    const bool ret = __sync_bool_compare_and_swap(p, oldValue, newValue);
+#else
+    g_s_atomLock.Lock();
+    const bool ret = *p == oldValue;
+    if (ret)
+    {
+        *p = newValue;
+    }
+    g_s_atomLock.Unlock();
+#endif
+
+    return (ret);
+}
@@ -60,4 +60,53 @@ private:
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+/*
+ * The atomic operations of the lock-free paths. Each one is a full barrier,
+ * and falls back to a global lock without PRO_HAS_ATOMOP.
+ */
+
+long
+PRO_CALLTYPE
+ProAtomicLoad(const volatile long* p);
+
+void
+PRO_CALLTYPE
+ProAtomicStore(volatile long* p,
+               long           value);
+
+/*
+ * returns the new value
+ */
+long
+PRO_CALLTYPE
+ProAtomicAdd(volatile long* p,
+             long           delta);
+
+bool
+PRO_CALLTYPE
+ProAtomicCas(volatile long* p,
+             long           oldValue,
+             long           newValue);
+
+void*
+PRO_CALLTYPE
+ProAtomicLoadPtr(void* const volatile* p);
+
+/*
+ * returns the old value
+ */
+void*
+PRO_CALLTYPE
+ProAtomicExchangePtr(void* volatile* p,
+                     void*           value);
+
+bool
+PRO_CALLTYPE
+ProAtomicCasPtr(void* volatile* p,
+                void*           oldValue,
+                void*           newValue);
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 #endif /* ____PRO_REF_COUNT_H____ */
@@ -343,6 +343,33 @@ ProSha256All(const void* buf,
     ProSha256Delete(ctx);
 }
 
+void
+PRO_CALLTYPE
+ProHmacSha256All(const void* key,
+                 size_t      keySize,
+                 const void* buf,
+                 size_t      size,
+                 char        hashValue[32])
+{
+    memset(hashValue, 0, 32);
+
+    const mbedtls_md_info_t* const info =
+        mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (info == NULL)
+    {
+        return;
+    }
+
+    mbedtls_md_hmac(
+        info,
+        (const unsigned char*)key,
+        keySize,
+        (const unsigned char*)buf,
+        size,
+        (unsigned char*)hashValue
+        );
+}
+
 /*-------------------------------------------------------------------------*/
 
 void*
@@ -365,3 +365,24 @@ CProStatAvgValue::Reset()
     m_sum       = 0;
     m_avgValue  = 0;
 }
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+unsigned long
+PRO_CALLTYPE
+ProStatHistogramIndex(PRO_INT64 durationInUs)
+{
+    unsigned long index = 0;
+    PRO_INT64     bound = 10;
+
+    for (; index < PRO_STAT_HISTOGRAM_SIZE - 1; ++index, bound *= 10)
+    {
+        if (durationInUs < bound)
+        {
+            break;
+        }
+    }
+
+    return (index);
+}
@@ -27,11 +27,14 @@
 #endif
 
 #include <algorithm>
+#include <cstring>
 #include <deque>
 #include <list>
 #include <map>
+#include <new>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 /////////////////////////////////////////////////////////////////////////////
@@ -103,4 +106,567 @@ typedef std::basic_string<wchar_t, std::char_traits<wchar_t>, std::pro_allocator
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+/*
+ * Hash functions for CProStlHashMap and CProStlHashSet.
+ *
+ * For another key type, define a ProStlHash(const KEY&) overload in the
+ * namespace of the key type, or give the containers a functor.
+ */
+
+inline
+PRO_UINT32
+ProStlHash(PRO_UINT32 key)
+{
+    /*
+     * the finalizer of MurmurHash3
+     */
+    key ^= key >> 16;
+    key *= 0x85EBCA6B;
+    key ^= key >> 13;
+    key *= 0xC2B2AE35;
+    key ^= key >> 16;
+
+    return (key);
+}
+
+inline
+PRO_UINT32
+ProStlHash(PRO_UINT64 key)
+{
+    return (ProStlHash((PRO_UINT32)key ^ ProStlHash((PRO_UINT32)(key >> 32))));
+}
+
+inline
+PRO_UINT32
+ProStlHash(PRO_INT64 key)
+{
+    return (ProStlHash((PRO_UINT64)key));
+}
+
+inline
+PRO_UINT32
+ProStlHash(unsigned long key)
+{
+    return (ProStlHash((PRO_UINT64)key));
+}
+
+inline
+PRO_UINT32
+ProStlHash(long key)
+{
+    return (ProStlHash((PRO_UINT64)key));
+}
+
+inline
+PRO_UINT32
+ProStlHash(PRO_INT32 key)
+{
+    return (ProStlHash((PRO_UINT32)key));
+}
+
+inline
+PRO_UINT32
+ProStlHash(PRO_UINT16 key)
+{
+    return (ProStlHash((PRO_UINT32)key));
+}
+
+inline
+PRO_UINT32
+ProStlHash(const void* key)
+{
+    return (ProStlHash((PRO_UINT64)(size_t)key));
+}
+
+template<class ____K>
+struct CProStlHash
+{
+    PRO_UINT32 operator()(const ____K& key) const
+    {
+        return (ProStlHash(key));
+    }
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+template<class ____V, class ____S>
+class CProStlHashIterator
+{
+public:
+
+    CProStlHashIterator()
+    {
+        m_values   = NULL;
+        m_states   = NULL;
+        m_capacity = 0;
+        m_index    = 0;
+    }
+
+    CProStlHashIterator(
+        ____V*               values,
+        const unsigned char* states,
+        size_t               capacity,
+        size_t               index
+        )
+    {
+        m_values   = values;
+        m_states   = states;
+        m_capacity = capacity;
+        m_index    = index;
+
+        SkipFree();
+    }
+
+    /*
+     * from the iterator to the const_iterator
+     */
+    template<class ____V2>
+    CProStlHashIterator(const CProStlHashIterator<____V2, ____S>& itr)
+    {
+        m_values   = itr.m_values;
+        m_states   = itr.m_states;
+        m_capacity = itr.m_capacity;
+        m_index    = itr.m_index;
+    }
+
+    ____V& operator*() const
+    {
+        return (m_values[m_index]);
+    }
+
+    ____V* operator->() const
+    {
+        return (&m_values[m_index]);
+    }
+
+    CProStlHashIterator& operator++()
+    {
+        ++m_index;
+        SkipFree();
+
+        return (*this);
+    }
+
+    CProStlHashIterator operator++(int)
+    {
+        const CProStlHashIterator itr = *this;
+        ++m_index;
+        SkipFree();
+
+        return (itr);
+    }
+
+    bool operator==(const CProStlHashIterator& itr) const
+    {
+        return (m_index == itr.m_index && m_values == itr.m_values);
+    }
+
+    bool operator!=(const CProStlHashIterator& itr) const
+    {
+        return (!(*this == itr));
+    }
+
+    size_t Index() const
+    {
+        return (m_index);
+    }
+
+private:
+
+    void SkipFree()
+    {
+        while (m_index < m_capacity && m_states[m_index] != ____S::STATE_USED)
+        {
+            ++m_index;
+        }
+    }
+
+public: /* for the conversion */
+
+    ____V*               m_values;
+    const unsigned char* m_states;
+    size_t               m_capacity;
+    size_t               m_index;
+};
+
+/*
+ * An open-addressing hash table with linear probing, on the pool allocator.
+ *
+ * The capacity is a power of 2, and the table grows when 3/4 of the slots
+ * are used or deleted. Erasing only marks the slot, so erasing with
+ * "erase(itr++)" while iterating is fine, but inserting may rehash and
+ * invalidate all the iterators. The order of iteration is not sorted.
+ */
+template<class ____K, class ____V, class ____KeyOf, class ____Hash, unsigned long ____poolIndex>
+class CProStlHashTable
+{
+public:
+
+    enum
+    {
+        STATE_FREE    = 0,
+        STATE_USED    = 1,
+        STATE_DELETED = 2
+    };
+
+    typedef ____K                                                     key_type;
+    typedef ____V                                                     value_type;
+    typedef size_t                                                    size_type;
+    typedef CProStlHashTable<____K, ____V, ____KeyOf, ____Hash, ____poolIndex> _Myt;
+    typedef CProStlHashIterator<____V, _Myt>                          iterator;
+    typedef CProStlHashIterator<const ____V, _Myt>                    const_iterator;
+
+    CProStlHashTable()
+    {
+        Zero();
+    }
+
+    CProStlHashTable(const CProStlHashTable& table)
+    {
+        Zero();
+        *this = table;
+    }
+
+    ~CProStlHashTable()
+    {
+        Destroy();
+    }
+
+    CProStlHashTable& operator=(const CProStlHashTable& table)
+    {
+        if (this == &table)
+        {
+            return (*this);
+        }
+
+        clear();
+        reserve(table.m_size);
+
+        for (size_t i = 0; i < table.m_capacity; ++i)
+        {
+            if (table.m_states[i] == STATE_USED)
+            {
+                InsertNew(table.m_values[i]);
+            }
+        }
+
+        return (*this);
+    }
+
+    iterator begin()
+    {
+        return (iterator(m_values, m_states, m_capacity, 0));
+    }
+
+    const_iterator begin() const
+    {
+        return (const_iterator(m_values, m_states, m_capacity, 0));
+    }
+
+    iterator end()
+    {
+        return (iterator(m_values, m_states, m_capacity, m_capacity));
+    }
+
+    const_iterator end() const
+    {
+        return (const_iterator(m_values, m_states, m_capacity, m_capacity));
+    }
+
+    size_t size() const
+    {
+        return (m_size);
+    }
+
+    bool empty() const
+    {
+        return (m_size == 0);
+    }
+
+    iterator find(const ____K& key)
+    {
+        return (iterator(m_values, m_states, m_capacity, Find(key)));
+    }
+
+    const_iterator find(const ____K& key) const
+    {
+        return (const_iterator(m_values, m_states, m_capacity, Find(key)));
+    }
+
+    size_t count(const ____K& key) const
+    {
+        return (Find(key) < m_capacity ? 1 : 0);
+    }
+
+    std::pair<iterator, bool> insert(const ____V& value)
+    {
+        const size_t index = Find(____KeyOf()(value));
+        if (index < m_capacity)
+        {
+            return (std::pair<iterator, bool>(
+                iterator(m_values, m_states, m_capacity, index), false));
+        }
+
+        return (std::pair<iterator, bool>(
+            iterator(m_values, m_states, m_capacity, InsertNew(value)), true));
+    }
+
+    void erase(iterator itr)
+    {
+        if (itr.Index() < m_capacity && m_states[itr.Index()] == STATE_USED)
+        {
+            EraseAt(itr.Index());
+        }
+    }
+
+    size_t erase(const ____K& key)
+    {
+        const size_t index = Find(key);
+        if (index >= m_capacity)
+        {
+            return (0);
+        }
+
+        EraseAt(index);
+
+        return (1);
+    }
+
+    void clear()
+    {
+        for (size_t i = 0; i < m_capacity; ++i)
+        {
+            if (m_states[i] == STATE_USED)
+            {
+                m_values[i].~____V();
+            }
+
+            m_states[i] = STATE_FREE;
+        }
+
+        m_size    = 0;
+        m_deleted = 0;
+    }
+
+    void swap(CProStlHashTable& table)
+    {
+        std::swap(m_values  , table.m_values);
+        std::swap(m_states  , table.m_states);
+        std::swap(m_capacity, table.m_capacity);
+        std::swap(m_size    , table.m_size);
+        std::swap(m_deleted , table.m_deleted);
+    }
+
+    /*
+     * makes room for "count" elements without rehashing
+     */
+    void reserve(size_t count)
+    {
+        size_t capacity = 16;
+        while (capacity / 4 * 3 < count)
+        {
+            capacity *= 2;
+        }
+
+        if (capacity > m_capacity)
+        {
+            Rehash(capacity);
+        }
+    }
+
+protected:
+
+    size_t Find(const ____K& key) const
+    {
+        if (m_size == 0)
+        {
+            return (m_capacity);
+        }
+
+        const size_t mask  = m_capacity - 1;
+        size_t       index = ____Hash()(key) & mask;
+
+        while (m_states[index] != STATE_FREE)
+        {
+            if (m_states[index] == STATE_USED &&
+                ____KeyOf()(m_values[index]) == key)
+            {
+                return (index);
+            }
+
+            index = (index + 1) & mask;
+        }
+
+        return (m_capacity);
+    }
+
+    /*
+     * the key must be absent
+     */
+    size_t InsertNew(const ____V& value)
+    {
+        if ((m_size + m_deleted + 1) * 4 > m_capacity * 3)
+        {
+            /*
+             * grow, or only purge the deleted slots
+             */
+            Rehash((m_size + 1) * 2 > m_capacity ? m_capacity * 2 : m_capacity);
+        }
+
+        const size_t mask  = m_capacity - 1;
+        size_t       index = ____Hash()(____KeyOf()(value)) & mask;
+
+        while (m_states[index] == STATE_USED)
+        {
+            index = (index + 1) & mask;
+        }
+
+        if (m_states[index] == STATE_DELETED)
+        {
+            --m_deleted;
+        }
+
+        new (&m_values[index]) ____V(value);
+        m_states[index] = STATE_USED;
+        ++m_size;
+
+        return (index);
+    }
+
+    void EraseAt(size_t index)
+    {
+        m_values[index].~____V();
+        m_states[index] = STATE_DELETED;
+        --m_size;
+        ++m_deleted;
+
+        if (m_size == 0)
+        {
+            memset(m_states, STATE_FREE, m_capacity);
+            m_deleted = 0;
+        }
+    }
+
+    void Rehash(size_t capacity)
+    {
+        if (capacity < 16)
+        {
+            capacity = 16;
+        }
+
+        ____V* const         oldValues   = m_values;
+        unsigned char* const oldStates   = m_states;
+        const size_t         oldCapacity = m_capacity;
+
+        m_values   = std::pro_allocator<____V, ____poolIndex>().allocate(capacity);
+        m_states   = std::pro_allocator<unsigned char, ____poolIndex>().allocate(capacity);
+        m_capacity = capacity;
+        m_size     = 0;
+        m_deleted  = 0;
+        memset(m_states, STATE_FREE, capacity);
+
+        for (size_t i = 0; i < oldCapacity; ++i)
+        {
+            if (oldStates[i] == STATE_USED)
+            {
+                InsertNew(oldValues[i]);
+                oldValues[i].~____V();
+            }
+        }
+
+        if (oldValues != NULL)
+        {
+            std::pro_allocator<____V, ____poolIndex>().deallocate(oldValues, oldCapacity);
+            std::pro_allocator<unsigned char, ____poolIndex>().deallocate(oldStates, oldCapacity);
+        }
+    }
+
+    void Destroy()
+    {
+        clear();
+
+        if (m_values != NULL)
+        {
+            std::pro_allocator<____V, ____poolIndex>().deallocate(m_values, m_capacity);
+            std::pro_allocator<unsigned char, ____poolIndex>().deallocate(m_states, m_capacity);
+        }
+
+        Zero();
+    }
+
+    void Zero()
+    {
+        m_values   = NULL;
+        m_states   = NULL;
+        m_capacity = 0;
+        m_size     = 0;
+        m_deleted  = 0;
+    }
+
+private:
+
+    ____V*         m_values;
+    unsigned char* m_states;
+    size_t         m_capacity;
+    size_t         m_size;
+    size_t         m_deleted;
+};
+
+template<class ____K, class ____Ty>
+struct CProStlHashMapKeyOf
+{
+    const ____K& operator()(const std::pair<const ____K, ____Ty>& value) const
+    {
+        return (value.first);
+    }
+};
+
+template<class ____K>
+struct CProStlHashSetKeyOf
+{
+    const ____K& operator()(const ____K& value) const
+    {
+        return (value);
+    }
+};
+
+/*
+ * Flat replacements for CProStlMap and CProStlSet, where the order doesn't
+ * matter and the lookups are hot.
+ */
+template<class ____K, class ____Ty, unsigned long ____poolIndex = 0, class ____Hash = CProStlHash<____K> >
+class CProStlHashMap
+: public CProStlHashTable<____K, std::pair<const ____K, ____Ty>,
+                          CProStlHashMapKeyOf<____K, ____Ty>, ____Hash, ____poolIndex>
+{
+public:
+
+    typedef ____Ty mapped_type;
+
+    ____Ty& operator[](const ____K& key)
+    {
+        typename CProStlHashMap::iterator itr = this->find(key);
+        if (itr == this->end())
+        {
+            itr = this->insert(std::pair<const ____K, ____Ty>(key, ____Ty())).first;
+        }
+
+        return (itr->second);
+    }
+
+    DECLARE_SGI_POOL(0)
+};
+
+template<class ____K, unsigned long ____poolIndex = 0, class ____Hash = CProStlHash<____K> >
+class CProStlHashSet
+: public CProStlHashTable<____K, ____K,
+                          CProStlHashSetKeyOf<____K>, ____Hash, ____poolIndex>
+{
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 #endif /* ____PRO_STL_H____ */
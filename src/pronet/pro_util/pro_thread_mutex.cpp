@@ -25,7 +25,9 @@
 #if defined(_WIN32) || defined(_WIN32_WCE)
 #include <windows.h>
 #else
+#include <errno.h>
 #include <pthread.h>
+#include <sys/time.h>
 #endif
 
 /////////////////////////////////////////////////////////////////////////////
@@ -112,6 +114,27 @@ public:
         }
     }
 
+    bool TimedWait(
+        CProThreadMutex* mutex,
+        unsigned long    milliseconds
+        )
+    {
+        if (mutex != NULL)
+        {
+            mutex->Unlock();
+        }
+
+        const bool signalled =
+            ::WaitForSingleObject(m_sem, milliseconds) == WAIT_OBJECT_0;
+
+        if (mutex != NULL)
+        {
+            mutex->Lock();
+        }
+
+        return (signalled);
+    }
+
     void Signal()
     {
         ::ReleaseSemaphore(m_sem, 1, NULL);
@@ -227,6 +250,54 @@ public:
         }
     }
 
+    bool TimedWait(
+        CProThreadMutex* mutex,
+        unsigned long    milliseconds
+        )
+    {
+        struct timeval now;
+        gettimeofday(&now, NULL);
+
+        const PRO_INT64 nsec = (PRO_INT64)now.tv_usec * 1000 +
+            (PRO_INT64)(milliseconds % 1000) * 1000000;
+
+        struct timespec deadline;
+        deadline.tv_sec  = now.tv_sec + milliseconds / 1000 + (time_t)(nsec / 1000000000);
+        deadline.tv_nsec = (long)(nsec % 1000000000);
+
+        if (mutex != NULL)
+        {
+            mutex->Unlock();
+        }
+
+        m_mutex.Lock();   /* [[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[ */
+
+        while (!m_signal)
+        {
+            ++m_waiters;
+            const int err =
+                pthread_cond_timedwait(&m_condt, &m_mutex.m_mutext, &deadline);
+            --m_waiters;
+
+            if (err == ETIMEDOUT)
+            {
+                break;
+            }
+        }
+
+        const bool signalled = m_signal;
+        m_signal = false;
+
+        m_mutex.Unlock(); /* ]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]]] */
+
+        if (mutex != NULL)
+        {
+            mutex->Lock();
+        }
+
+        return (signalled);
+    }
+
     void Signal()
     {
         m_mutex.Lock();   /* [[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[[ */
@@ -526,6 +597,13 @@ CProThreadMutexCondition::Waitrc(CProRecursiveThreadMutex* rcmutex)
     m_impl->Waitrc(rcmutex);
 }
 
+bool
+CProThreadMutexCondition::TimedWait(CProThreadMutex* mutex,
+                                    unsigned long    milliseconds)
+{
+    return (m_impl->TimedWait(mutex, milliseconds));
+}
+
 void
 CProThreadMutexCondition::Signal()
 {
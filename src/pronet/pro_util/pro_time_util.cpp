@@ -25,6 +25,8 @@
 
 #if defined(_WIN32) || defined(_WIN32_WCE)
 #include <windows.h>
+#else
+#include <time.h>
 #endif
 
 #include <cassert>
@@ -39,6 +41,43 @@ ProGetTickCount64()
     return (ProGetTickCount64_s());
 }
 
+PRO_INT64
+PRO_CALLTYPE
+ProGetTickCount64Us()
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+
+    LARGE_INTEGER freq;
+    LARGE_INTEGER count;
+    if (!::QueryPerformanceFrequency(&freq) || freq.QuadPart <= 0 ||
+        !::QueryPerformanceCounter(&count))
+    {
+        return (ProGetTickCount64_s() * 1000);
+    }
+
+    PRO_INT64 ret = count.QuadPart / freq.QuadPart * 1000000;
+    ret += count.QuadPart % freq.QuadPart * 1000000 / freq.QuadPart;
+
+    return (ret);
+
+#elif !defined(PRO_LACKS_CLOCK_GETTIME) /* for non-MacOS */
+
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    PRO_INT64 ret = ts.tv_sec;
+    ret *= 1000000;
+    ret += ts.tv_nsec / 1000;
+
+    return (ret);
+
+#else
+
+    return (ProGetTickCount64_s() * 1000);
+
+#endif
+}
+
 void
 PRO_CALLTYPE
 ProSleep(PRO_UINT32 milliseconds)
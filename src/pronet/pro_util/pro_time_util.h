@@ -159,6 +159,13 @@ PRO_INT64
 PRO_CALLTYPE
 ProGetTickCount64();
 
+/*
+ * monotonic tick in microseconds, for measuring short intervals
+ */
+PRO_INT64
+PRO_CALLTYPE
+ProGetTickCount64Us();
+
 void
 PRO_CALLTYPE
 ProSleep(PRO_UINT32 milliseconds);
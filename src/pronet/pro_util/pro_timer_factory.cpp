@@ -21,6 +21,7 @@
 #include "pro_functor_command.h"
 #include "pro_functor_command_task.h"
 #include "pro_memory_pool.h"
+#include "pro_stat.h"
 #include "pro_stl.h"
 #include "pro_thread_mutex.h"
 #include "pro_time_util.h"
@@ -56,6 +57,35 @@ typedef void (CProTimerFactory::* ACTION)(PRO_INT64*);
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+static
+void
+PRO_CALLTYPE
+AddStats_i(PRO_TIMER_STATS&       stats,
+           const PRO_TIMER_STATS& delta)
+{
+    stats.loopCount   += delta.loopCount;
+    stats.upcallCount += delta.upcallCount;
+    stats.upcallUs    += delta.upcallUs;
+    stats.lagUs       += delta.lagUs;
+
+    if (delta.upcallMaxUs > stats.upcallMaxUs)
+    {
+        stats.upcallMaxUs = delta.upcallMaxUs;
+    }
+    if (delta.lagMaxUs > stats.lagMaxUs)
+    {
+        stats.lagMaxUs = delta.lagMaxUs;
+    }
+
+    for (int i = 0; i < PRO_STAT_HISTOGRAM_SIZE; ++i)
+    {
+        stats.lagHistogram[i] += delta.lagHistogram[i];
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CProTimerFactory::CProTimerFactory()
 {
     m_task         = NULL;
@@ -112,6 +142,7 @@ CProTimerFactory::Start(bool mmTimer)
 #endif
 
         m_mmTimer = mmTimer;
+        m_stats.Reset();
 
         int       i = 0;
         const int c = (int)m_htbtCounts.size();
@@ -365,6 +396,14 @@ CProTimerFactory::GetTimerCount() const
     return (count);
 }
 
+void
+CProTimerFactory::GetStats(PRO_TIMER_STATS& stats) const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    stats = m_stats;
+}
+
 bool
 CProTimerFactory::UpdateHeartbeatTimers(unsigned long htbtIntervalInSeconds)
 {
@@ -471,13 +510,23 @@ CProTimerFactory::GetHeartbeatInterval() const
 void
 CProTimerFactory::WorkerRun(PRO_INT64* args)
 {
+    PRO_TIMER_STATS delta;
+
     while (1)
     {
         CProStlVector<PRO_TIMER_NODE> timers;
+        CProStlVector<PRO_INT64>      expireTicks;
+        PRO_INT64                     tick = 0;
 
         {
             CProThreadMutexGuard mon(m_lock);
 
+            /*
+             * publish the counters of the previous round
+             */
+            AddStats_i(m_stats, delta);
+            delta.Reset();
+
             while (1)
             {
                 if (m_wantExit || m_timers.size() > 0)
@@ -493,7 +542,7 @@ CProTimerFactory::WorkerRun(PRO_INT64* args)
                 break;
             }
 
-            const PRO_INT64 tick = ProGetTickCount64();
+            tick = ProGetTickCount64();
 
             CProStlSet<PRO_TIMER_NODE>::iterator       itr = m_timers.begin();
             CProStlSet<PRO_TIMER_NODE>::iterator const end = m_timers.end();
@@ -507,6 +556,7 @@ CProTimerFactory::WorkerRun(PRO_INT64* args)
                 }
 
                 timers.push_back(node);
+                expireTicks.push_back(node.expireTick);
             }
 
             int       i = 0;
@@ -549,26 +599,60 @@ CProTimerFactory::WorkerRun(PRO_INT64* args)
             } /* end of for (...) */
         }
 
+        ++delta.loopCount;
+
         if (timers.size() == 0)
         {
             ProSleep(1); /* 1ms */
             continue;
         }
 
+        /*
+         * one clock read per upcall. the end of an upcall is the start of
+         * the next one, and the lag is the tick of this round plus the time
+         * spent since then
+         */
+        const PRO_INT64 baseUs  = ProGetTickCount64Us();
+        PRO_INT64       startUs = baseUs;
+
         int       i = 0;
         const int c = (int)timers.size();
 
         for (int j = 0; i < c; ++i)
         {
             const PRO_TIMER_NODE& node = timers[i];
+
+            PRO_INT64 lagUs = (tick - expireTicks[i]) * 1000 + startUs - baseUs;
+            if (lagUs < 0)
+            {
+                lagUs = 0;
+            }
+
             node.onTimer->OnTimer(this, node.timerId, node.userData);
+            const PRO_INT64 endUs    = ProGetTickCount64Us();
+            const PRO_INT64 upcallUs = endUs - startUs;
+            startUs = endUs;
             node.onTimer->Release();
 
+            ++delta.upcallCount;
+            delta.upcallUs += upcallUs;
+            delta.lagUs    += lagUs;
+            ++delta.lagHistogram[ProStatHistogramIndex(lagUs)];
+            if ((PRO_UINT64)upcallUs > delta.upcallMaxUs)
+            {
+                delta.upcallMaxUs = upcallUs;
+            }
+            if ((PRO_UINT64)lagUs > delta.lagMaxUs)
+            {
+                delta.lagMaxUs = lagUs;
+            }
+
             ++j;
             if (j == PRO_TIMER_UPCALL_COUNT)
             {
                 j = 0;
                 ProSleep(1); /* 1ms */
+                startUs = ProGetTickCount64Us();
             }
         }
     } /* end of while (...) */
@@ -35,6 +35,107 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+static
+void
+PRO_CALLTYPE
+ReactorStats2String_i(const PRO_REACTOR_STATS* prevStats,
+                      const PRO_REACTOR_STATS* stats,
+                      size_t                   count,
+                      PRO_INT64                elapsedMs,
+                      CProStlString&           traceInfo)
+{
+    char theBuf[1024] = "";
+
+    snprintf_pro(
+        theBuf,
+        sizeof(theBuf),
+        "\n"
+        " reactor stats (last %u ms, max since start) \n"
+        " [[[ begin \n"
+        ,
+        (unsigned int)elapsedMs
+        );
+    traceInfo += theBuf;
+
+    int ioIndex = 0;
+
+    for (int i = 0; i < (int)count; ++i)
+    {
+        const PRO_REACTOR_STATS& prev = prevStats[i];
+        const PRO_REACTOR_STATS& cur  = stats[i];
+
+        const PRO_UINT64 loops   = cur.loopCount   - prev.loopCount;
+        const PRO_UINT64 events  = cur.eventCount  - prev.eventCount;
+        const PRO_UINT64 upcalls = cur.upcallCount - prev.upcallCount;
+        const PRO_UINT64 us      = cur.upcallUs    - prev.upcallUs;
+
+        PRO_UINT64 slow = 0; /* >= 10ms */
+        for (int j = 4; j < PRO_STAT_HISTOGRAM_SIZE; ++j)
+        {
+            slow += cur.histogram[j] - prev.histogram[j];
+        }
+
+        if (cur.threadType == PRO_RTT_TIMER || cur.threadType == PRO_RTT_MMTIMER)
+        {
+            const PRO_UINT64 lagUs = cur.timerLagUs - prev.timerLagUs;
+
+            snprintf_pro(
+                theBuf,
+                sizeof(theBuf),
+                "\t %-8s: timers %u, fired %u (avg %uus, max %uus),"
+                " lag avg %.2fms (max %.2fms, >=10ms %u) \n"
+                ,
+                cur.threadType == PRO_RTT_TIMER ? "timer" : "mmtimer",
+                (unsigned int)cur.timerCount,
+                (unsigned int)upcalls,
+                (unsigned int)(upcalls > 0 ? us / upcalls : 0),
+                (unsigned int)cur.upcallMaxUs,
+                upcalls > 0 ? (double)lagUs / upcalls / 1000 : 0.0,
+                (double)cur.timerLagMaxUs / 1000,
+                (unsigned int)slow
+                );
+        }
+        else
+        {
+            char name[32] = "accept";
+            if (cur.threadType == PRO_RTT_IO)
+            {
+                snprintf_pro(name, sizeof(name), "io-%d", ++ioIndex);
+            }
+
+            const PRO_UINT64 busyUs = cur.loopBusyUs - prev.loopBusyUs;
+
+            snprintf_pro(
+                theBuf,
+                sizeof(theBuf),
+                "\t %-8s: socks %u, loops %u, events %u (max %u),"
+                " upcalls %u (avg %uus, max %uus), busy %.2f%% (max %uus,"
+                " >=10ms %u), wakeups %u \n"
+                ,
+                name,
+                (unsigned int)cur.handlerCount,
+                (unsigned int)loops,
+                (unsigned int)events,
+                (unsigned int)cur.eventMaxPerLoop,
+                (unsigned int)upcalls,
+                (unsigned int)(upcalls > 0 ? us / upcalls : 0),
+                (unsigned int)cur.upcallMaxUs,
+                elapsedMs > 0 ? (double)busyUs / elapsedMs / 10 : 0.0,
+                (unsigned int)cur.loopBusyMaxUs,
+                (unsigned int)slow,
+                (unsigned int)(cur.notifyCount - prev.notifyCount)
+                );
+        }
+
+        traceInfo += theBuf;
+    }
+
+    traceInfo += " ]]] end \n";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CC2sServer*
 CC2sServer::CreateInstance(CProLogFile& logFile)
 {
@@ -51,6 +152,8 @@ CC2sServer::CC2sServer(CProLogFile& logFile)
     m_localSslConfig  = NULL;
     m_msgC2s          = NULL;
     m_onOkTick        = 0;
+    m_statsTimerId    = 0;
+    m_statsTick       = 0;
 }
 
 CC2sServer::~CC2sServer()
@@ -273,6 +376,12 @@ CC2sServer::Init(IProReactor*                  reactor,
         m_localSslConfig  = localSslConfig;
         m_msgC2s          = msgC2s;
 
+        if (configInfo.c2ss_log_stats_interval > 0)
+        {
+            m_statsTimerId = reactor->ScheduleTimer(
+                this, (PRO_UINT64)configInfo.c2ss_log_stats_interval * 1000, true);
+        }
+
         if (!m_configInfo.c2ss_uplink_password.empty())
         {
             ProZeroMemory(
@@ -309,6 +418,9 @@ CC2sServer::Fini()
             return;
         }
 
+        m_reactor->CancelTimer(m_statsTimerId);
+        m_statsTimerId = 0;
+
         msgC2s = m_msgC2s;
         m_msgC2s = NULL;
         localSslConfig = m_localSslConfig;
@@ -357,6 +469,24 @@ CC2sServer::Reconfig(const C2S_SERVER_CONFIG_INFO& configInfo)
 
         m_logFile.SetMaxSize(configInfo.c2ss_log_loop_bytes);
         m_logFile.SetGreenLevel(configInfo.c2ss_log_level_green);
+
+        if (configInfo.c2ss_log_stats_interval !=
+            m_configInfo.c2ss_log_stats_interval)
+        {
+            m_configInfo.c2ss_log_stats_interval =
+                configInfo.c2ss_log_stats_interval;
+
+            m_reactor->CancelTimer(m_statsTimerId);
+            m_statsTimerId = 0;
+            m_statsTick    = 0;
+            m_stats.clear();
+
+            if (configInfo.c2ss_log_stats_interval > 0)
+            {
+                m_statsTimerId = m_reactor->ScheduleTimer(
+                    this, (PRO_UINT64)configInfo.c2ss_log_stats_interval * 1000, true);
+            }
+        }
     }
 
     {{{
@@ -365,10 +495,11 @@ CC2sServer::Reconfig(const C2S_SERVER_CONFIG_INFO& configInfo)
             traceInfo,
             sizeof(traceInfo),
             "\n"
-            " CC2sServer::Reconfig(%u, %d) \n"
+            " CC2sServer::Reconfig(%u, %d, %u) \n"
             ,
             configInfo.c2ss_log_loop_bytes,
-            configInfo.c2ss_log_level_green
+            configInfo.c2ss_log_level_green,
+            configInfo.c2ss_log_stats_interval
             );
         m_logFile.Log(traceInfo, PRO_LL_MAX, true);
     }}}
@@ -610,3 +741,66 @@ CC2sServer::OnCloseUser(IRtpMsgC2s*         msgC2s,
         m_logFile.Log(traceInfo, PRO_LL_INFO, true);
     }}}
 }
+
+void
+PRO_CALLTYPE
+CC2sServer::OnTimer(void*      factory,
+                    PRO_UINT64 timerId,
+                    PRO_INT64  userData)
+{
+    IProReactor* reactor = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL || m_msgC2s == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_statsTimerId)
+        {
+            return;
+        }
+
+        reactor = m_reactor;
+    }
+
+    CProStlVector<PRO_REACTOR_STATS> stats;
+    stats.resize(reactor->GetStats(NULL, 0));
+    if (stats.size() == 0)
+    {
+        return;
+    }
+    stats.resize(reactor->GetStats(&stats[0], (unsigned long)stats.size()));
+
+    const PRO_INT64 tick = ProGetTickCount64();
+
+    CProStlString traceInfo = "";
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL || timerId != m_statsTimerId)
+        {
+            return;
+        }
+
+        /*
+         * the first round only takes the baseline
+         */
+        if (m_stats.size() == stats.size() && tick > m_statsTick)
+        {
+            ReactorStats2String_i(
+                &m_stats[0], &stats[0], stats.size(), tick - m_statsTick, traceInfo);
+        }
+
+        m_stats     = stats;
+        m_statsTick = tick;
+    }
+
+    if (!traceInfo.empty())
+    {{{
+        m_logFile.Log(traceInfo.c_str(), PRO_LL_INFO, true);
+    }}}
+}
@@ -61,6 +61,8 @@ struct C2S_SERVER_CONFIG_INFO
 
         c2ss_log_loop_bytes             = 50 * 1000 * 1000;
         c2ss_log_level_green            = 0;
+        c2ss_log_stats_interval         = 0;
+        c2ss_log_async                  = 1;
 
         RtpMsgString2User("1-10000001-1", &c2ss_uplink_id);
 
@@ -122,6 +124,8 @@ struct C2S_SERVER_CONFIG_INFO
 
         configStream.AddUint("c2ss_log_loop_bytes"            , c2ss_log_loop_bytes);
         configStream.AddInt ("c2ss_log_level_green"           , c2ss_log_level_green);
+        configStream.AddUint("c2ss_log_stats_interval"        , c2ss_log_stats_interval);
+        configStream.AddUint("c2ss_log_async"                 , c2ss_log_async);
 
         configStream.Get(configs);
     }
@@ -155,6 +159,8 @@ struct C2S_SERVER_CONFIG_INFO
 
     unsigned int                 c2ss_log_loop_bytes;
     int                          c2ss_log_level_green;
+    unsigned int                 c2ss_log_stats_interval; /* 0 ~ 3600, 0 disables */
+    unsigned int                 c2ss_log_async;          /* 0: sync, 1: async (drop if full), 2: async (block if full) */
 
     DECLARE_SGI_POOL(0)
 };
@@ -162,7 +168,11 @@ struct C2S_SERVER_CONFIG_INFO
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-class CC2sServer : public IRtpMsgC2sObserver, public CProRefCount
+class CC2sServer
+:
+public IRtpMsgC2sObserver,
+public IProOnTimer,
+public CProRefCount
 {
 public:
 
@@ -228,6 +238,12 @@ private:
     {
     }
 
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
 private:
 
     CProLogFile&           m_logFile;
@@ -237,6 +253,9 @@ private:
     PRO_SSL_SERVER_CONFIG* m_localSslConfig;
     IRtpMsgC2s*            m_msgC2s;
     PRO_INT64              m_onOkTick;
+    PRO_UINT64             m_statsTimerId;
+    PRO_INT64              m_statsTick;
+    CProStlVector<PRO_REACTOR_STATS> m_stats;
     CProThreadMutex        m_lock;
 
     DECLARE_SGI_POOL(0)
@@ -367,6 +367,22 @@ int main(int argc, char* argv[])
             {
                 configInfo.c2ss_log_level_green    = atoi(configValue.c_str());
             }
+            else if (stricmp(configName.c_str(), "c2ss_log_stats_interval") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value >= 0 && value <= 3600)
+                {
+                    configInfo.c2ss_log_stats_interval = value;
+                }
+            }
+            else if (stricmp(configName.c_str(), "c2ss_log_async") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value >= 0 && value <= 2)
+                {
+                    configInfo.c2ss_log_async = value;
+                }
+            }
             else
             {
             }
@@ -375,6 +391,10 @@ int main(int argc, char* argv[])
 
     logFile->SetMaxSize(configInfo.c2ss_log_loop_bytes);
     logFile->SetGreenLevel(configInfo.c2ss_log_level_green);
+    if (configInfo.c2ss_log_async > 0)
+    {
+        logFile->EnableAsync(configInfo.c2ss_log_async == 2);
+    }
 
     reactor = ProCreateReactor(configInfo.c2ss_thread_count);
     if (reactor == NULL)
@@ -554,6 +574,14 @@ int main(int argc, char* argv[])
                 {
                     configInfo.c2ss_log_level_green    = atoi(configValue.c_str());
                 }
+                else if (stricmp(configName.c_str(), "c2ss_log_stats_interval") == 0)
+                {
+                    const int value = atoi(configValue.c_str());
+                    if (value >= 0 && value <= 3600)
+                    {
+                        configInfo.c2ss_log_stats_interval = value;
+                    }
+                }
                 else
                 {
                 }
@@ -28,6 +28,11 @@
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+#define MAX_CACHED_STMTS 64
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 static
 int
 PRO_CALLTYPE
@@ -102,6 +107,7 @@ CDbConnection::CDbConnection()
 {
     m_db          = NULL;
     m_transacting = false;
+    m_cursor      = NULL;
 }
 
 CDbConnection::~CDbConnection()
@@ -125,7 +131,8 @@ CDbConnection::Open(const char* fileName) /* UTF-8 */
         CProThreadMutexGuard mon(m_lock);
 
         assert(m_db == NULL);
-        if (m_db != NULL)
+        assert(m_cursor == NULL);
+        if (m_db != NULL || m_cursor != NULL)
         {
             return (false);
         }
@@ -149,6 +156,10 @@ CDbConnection::Open(const char* fileName) /* UTF-8 */
             sqlite3_close_v2(m_db);
             m_db = NULL;
         }
+        else
+        {
+            m_fileName = fileName;
+        }
     }
 
     return (err == SQLITE_OK);
@@ -160,7 +171,8 @@ CDbConnection::Close()
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return;
         }
@@ -180,11 +192,27 @@ CDbConnection::Close()
             m_transacting = false;
         }
 
+        FinalizeStmts_i();
         sqlite3_close_v2(m_db);
-        m_db = NULL;
+        m_db       = NULL;
+        m_fileName = "";
     }
 }
 
+CProStlString
+CDbConnection::GetFileName() const
+{
+    CProStlString fileName;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        fileName = m_fileName;
+    }
+
+    return (fileName);
+}
+
 bool
 CDbConnection::BeginTransaction()
 {
@@ -193,7 +221,8 @@ CDbConnection::BeginTransaction()
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return (false);
         }
@@ -230,7 +259,8 @@ CDbConnection::CommitTransaction()
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return (false);
         }
@@ -265,7 +295,8 @@ CDbConnection::RollbackTransaction()
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return;
         }
@@ -327,7 +358,8 @@ CDbConnection::DoSelect(const char* sql,
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return (false);
         }
@@ -414,7 +446,8 @@ CDbConnection::DoOther(const char* sql)
     {
         CProThreadMutexGuard mon(m_lock);
 
-        if (m_db == NULL)
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
         {
             return (false);
         }
@@ -431,3 +464,308 @@ CDbConnection::DoOther(const char* sql)
 
     return (err == SQLITE_DONE);
 }
+
+bool
+CDbConnection::DoOther(const char*          sql,
+                       const DB_PARAM_UNIT* params,
+                       int                  count)
+{
+    assert(sql != NULL);
+    assert(sql[0] != '\0');
+    assert(params != NULL || count == 0);
+    assert(count >= 0);
+    if (sql == NULL || sql[0] == '\0' || (params == NULL && count != 0) ||
+        count < 0)
+    {
+        return (false);
+    }
+
+    int err = SQLITE_ERROR;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_cursor == NULL);
+        if (m_db == NULL || m_cursor != NULL)
+        {
+            return (false);
+        }
+
+        sqlite3_stmt* const stmt = GetStmt_i(sql);
+        if (stmt == NULL)
+        {
+            return (false);
+        }
+
+        err = SQLITE_OK;
+
+        int       i = 0;
+        const int c = count;
+
+        for (; i < c && err == SQLITE_OK; ++i)
+        {
+            const DB_PARAM_UNIT& param = params[i];
+
+            if (param.type == DB_CT_I64)
+            {
+                err = sqlite3_bind_int64(stmt, i + 1, param.i64);
+            }
+            else if (param.type == DB_CT_DBL)
+            {
+                err = sqlite3_bind_double(stmt, i + 1, param.dbl);
+            }
+            else if (param.type == DB_CT_TXT && param.txt != NULL)
+            {
+                err = sqlite3_bind_text(stmt, i + 1, param.txt, param.txtLen,
+                    SQLITE_STATIC);
+            }
+            else
+            {
+                err = SQLITE_MISUSE;
+            }
+        }
+
+        if (err == SQLITE_OK)
+        {
+            err = sqlite3_step_i(stmt);
+        }
+
+        /*
+         * the texts are bound without copies, so don't keep them
+         */
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+    }
+
+    return (err == SQLITE_DONE);
+}
+
+sqlite3_stmt*
+CDbConnection::GetStmt_i(const char* sql)
+{
+    assert(m_db != NULL);
+
+    const CProStlString key = sql;
+
+    CProStlMap<CProStlString, sqlite3_stmt*>::const_iterator const itr =
+        m_stmts.find(key);
+    if (itr != m_stmts.end())
+    {
+        return (itr->second);
+    }
+
+    /*
+     * the callers use a few fixed texts. the rest are one-offs
+     */
+    if (m_stmts.size() >= MAX_CACHED_STMTS)
+    {
+        FinalizeStmts_i();
+    }
+
+    sqlite3_stmt* stmt = NULL;
+    const int err = sqlite3_prepare_v2_i(m_db, sql, -1, &stmt, NULL);
+    if (err != SQLITE_OK)
+    {
+        sqlite3_finalize_i(stmt);
+
+        return (NULL);
+    }
+
+    assert(stmt != NULL);
+    m_stmts[key] = stmt;
+
+    return (stmt);
+}
+
+void
+CDbConnection::FinalizeStmts_i()
+{
+    CProStlMap<CProStlString, sqlite3_stmt*>::const_iterator       itr = m_stmts.begin();
+    CProStlMap<CProStlString, sqlite3_stmt*>::const_iterator const end = m_stmts.end();
+
+    for (; itr != end; ++itr)
+    {
+        sqlite3_finalize_i(itr->second);
+    }
+
+    m_stmts.clear();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CDbCursor::CDbCursor(CDbConnection& db)
+: m_db(db)
+{
+    m_stmt = NULL;
+    m_done = false;
+}
+
+CDbCursor::~CDbCursor()
+{
+    Close();
+}
+
+bool
+CDbCursor::Open(const char* sql)
+{
+    assert(sql != NULL);
+    assert(sql[0] != '\0');
+    if (sql == NULL || sql[0] == '\0')
+    {
+        return (false);
+    }
+
+    assert(m_stmt == NULL);
+    if (m_stmt != NULL)
+    {
+        return (false);
+    }
+
+    m_db.m_lock.Lock();
+
+    assert(m_db.m_cursor == NULL); /* one cursor at a time */
+    if (m_db.m_db != NULL && m_db.m_cursor == NULL)
+    {
+        m_stmt = m_db.GetStmt_i(sql);
+    }
+
+    if (m_stmt == NULL)
+    {
+        m_db.m_lock.Unlock();
+
+        return (false);
+    }
+
+    m_db.m_cursor = this;
+    m_done        = false;
+
+    return (true);
+}
+
+void
+CDbCursor::Close()
+{
+    if (m_stmt == NULL)
+    {
+        return;
+    }
+
+    sqlite3_reset(m_stmt); /* back to the cache */
+    sqlite3_clear_bindings(m_stmt);
+    m_stmt        = NULL;
+    m_db.m_cursor = NULL;
+
+    m_db.m_lock.Unlock();
+}
+
+bool
+CDbCursor::BindI64(int       index,
+                   PRO_INT64 value)
+{
+    assert(m_stmt != NULL);
+    if (m_stmt == NULL)
+    {
+        return (false);
+    }
+
+    return (sqlite3_bind_int64(m_stmt, index, value) == SQLITE_OK);
+}
+
+bool
+CDbCursor::BindDbl(int    index,
+                   double value)
+{
+    assert(m_stmt != NULL);
+    if (m_stmt == NULL)
+    {
+        return (false);
+    }
+
+    return (sqlite3_bind_double(m_stmt, index, value) == SQLITE_OK);
+}
+
+bool
+CDbCursor::BindTxt(int         index,
+                   const char* value)
+{
+    assert(m_stmt != NULL);
+    assert(value != NULL);
+    if (m_stmt == NULL || value == NULL)
+    {
+        return (false);
+    }
+
+    return (sqlite3_bind_text(m_stmt, index, value, -1, SQLITE_STATIC) == SQLITE_OK);
+}
+
+bool
+CDbCursor::Next()
+{
+    if (m_stmt == NULL || m_done)
+    {
+        return (false);
+    }
+
+    const int err = sqlite3_step_i(m_stmt);
+    if (err == SQLITE_ROW)
+    {
+        return (true);
+    }
+
+    if (err == SQLITE_DONE)
+    {
+        m_done = true;
+    }
+
+    return (false);
+}
+
+int
+CDbCursor::GetColumnCount() const
+{
+    if (m_stmt == NULL)
+    {
+        return (0);
+    }
+
+    return (sqlite3_data_count(m_stmt));
+}
+
+PRO_INT64
+CDbCursor::GetI64(int column) const
+{
+    assert(m_stmt != NULL);
+    if (m_stmt == NULL)
+    {
+        return (0);
+    }
+
+    return (sqlite3_column_int64(m_stmt, column));
+}
+
+double
+CDbCursor::GetDbl(int column) const
+{
+    assert(m_stmt != NULL);
+    if (m_stmt == NULL)
+    {
+        return (0);
+    }
+
+    return (sqlite3_column_double(m_stmt, column));
+}
+
+const char*
+CDbCursor::GetTxt(int column) const
+{
+    assert(m_stmt != NULL);
+    if (m_stmt == NULL)
+    {
+        return ("");
+    }
+
+    const char* const txt = (char*)sqlite3_column_text(m_stmt, column);
+
+    return (txt != NULL ? txt : "");
+}
@@ -21,18 +21,23 @@
 
 #include "db_struct.h"
 #include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread_mutex.h"
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+class  CDbCursor;
 struct sqlite3;
+struct sqlite3_stmt;
 
 /////////////////////////////////////////////////////////////////////////////
 ////
 
 class CDbConnection
 {
+    friend class CDbCursor;
+
 public:
 
     CDbConnection();
@@ -43,6 +48,8 @@ public:
 
     void Close();
 
+    CProStlString GetFileName() const;
+
     bool BeginTransaction();
 
     bool CommitTransaction();
@@ -56,11 +63,111 @@ public:
 
     bool DoOther(const char* sql);
 
+    /*
+     * binds the "params" to ?1, ?2, ... and runs the "sql". the statement is
+     * prepared once, and cached by the connection
+     */
+    bool DoOther(
+        const char*          sql,
+        const DB_PARAM_UNIT* params,
+        int                  count
+        );
+
+private:
+
+    sqlite3_stmt* GetStmt_i(const char* sql);
+
+    void FinalizeStmts_i();
+
+private:
+
+    sqlite3*                                 m_db;
+    CProStlString                            m_fileName;
+    bool                                     m_transacting;
+    CProStlMap<CProStlString, sqlite3_stmt*> m_stmts;  /* sql ---> stmt */
+    const CDbCursor*                         m_cursor; /* the open one */
+    mutable CProRecursiveThreadMutex         m_lock;   /* held by the open cursor */
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * Reads the rows of a cached statement one by one, without copying them.
+ *
+ *     CDbCursor cursor(db);
+ *     if (cursor.Open("SELECT _uid_, _passwd_ FROM t WHERE _cid_=?1"))
+ *     {
+ *         cursor.BindI64(1, cid);
+ *         while (cursor.Next())
+ *         {
+ *             ... cursor.GetI64(0), cursor.GetTxt(1) ...
+ *         }
+ *     }
+ *     ok = cursor.IsDone();
+ *
+ * The connection is locked from Open() to Close(). The other threads wait
+ * for it, and the calls of the connection in between, or a second cursor,
+ * fail on the same thread. A text is valid until the next call of Next().
+ */
+class CDbCursor
+{
+public:
+
+    CDbCursor(CDbConnection& db);
+
+    ~CDbCursor();
+
+    bool Open(const char* sql);
+
+    void Close();
+
+    /*
+     * the parameters are numbered from 1. the text is not copied
+     */
+    bool BindI64(
+        int       index,
+        PRO_INT64 value
+        );
+
+    bool BindDbl(
+        int    index,
+        double value
+        );
+
+    bool BindTxt(
+        int         index,
+        const char* value
+        );
+
+    bool Next();
+
+    /*
+     * true if all the rows have been read
+     */
+    bool IsDone() const
+    {
+        return (m_done);
+    }
+
+    /*
+     * the columns are numbered from 0
+     */
+    int GetColumnCount() const;
+
+    PRO_INT64 GetI64(int column) const;
+
+    double GetDbl(int column) const;
+
+    const char* GetTxt(int column) const; /* never NULL */
+
 private:
 
-    sqlite3*        m_db;
-    bool            m_transacting;
-    CProThreadMutex m_lock;
+    CDbConnection& m_db;
+    sqlite3_stmt*  m_stmt;
+    bool           m_done;
 
     DECLARE_SGI_POOL(0)
 };
@@ -53,6 +53,30 @@ struct DB_CELL_UNIT
     DECLARE_SGI_POOL(0)
 };
 
+/*
+ * a parameter to bind. the "txt" is not copied, and "txtLen" can be -1 if
+ * it's null-terminated
+ */
+struct DB_PARAM_UNIT
+{
+    DB_PARAM_UNIT()
+    {
+        type   = DB_CT_I64;
+        i64    = 0;
+        dbl    = 0;
+        txt    = "";
+        txtLen = -1;
+    }
+
+    DB_COLUMN_TYPE type;
+    PRO_INT64      i64;
+    double         dbl;
+    const char*    txt;
+    int            txtLen;
+
+    DECLARE_SGI_POOL(0)
+};
+
 struct DB_ROW_UNIT
 {
     CProStlVector<DB_CELL_UNIT> cells;
@@ -171,6 +171,22 @@ int main(int argc, char* argv[])
             {
                 configInfo.msgs_db_readonly = atoi(configValue.c_str()) != 0;
             }
+            else if (stricmp(configName.c_str(), "msgs_db_write_batch") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value >= 0 && value <= 10000)
+                {
+                    configInfo.msgs_db_write_batch = value;
+                }
+            }
+            else if (stricmp(configName.c_str(), "msgs_db_write_delay") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value > 0 && value <= 10000)
+                {
+                    configInfo.msgs_db_write_delay = value;
+                }
+            }
             else if (stricmp(configName.c_str(), "msgs_enable_ssl") == 0)
             {
                 configInfo.msgs_enable_ssl = atoi(configValue.c_str()) != 0;
@@ -252,6 +268,14 @@ int main(int argc, char* argv[])
 
                 configInfo.msgs_ssl_keyfile = configValue;
             }
+            else if (stricmp(configName.c_str(), "msgs_ssl_lean_buffers") == 0)
+            {
+                configInfo.msgs_ssl_lean_buffers = atoi(configValue.c_str()) != 0;
+            }
+            else if (stricmp(configName.c_str(), "msgs_ssl_ktls") == 0)
+            {
+                configInfo.msgs_ssl_ktls = atoi(configValue.c_str()) != 0;
+            }
             else if (stricmp(configName.c_str(), "msgs_log_loop_bytes") == 0)
             {
                 const int value = atoi(configValue.c_str());
@@ -264,6 +288,22 @@ int main(int argc, char* argv[])
             {
                 configInfo.msgs_log_level_green    = atoi(configValue.c_str());
             }
+            else if (stricmp(configName.c_str(), "msgs_log_stats_interval") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value >= 0 && value <= 3600)
+                {
+                    configInfo.msgs_log_stats_interval = value;
+                }
+            }
+            else if (stricmp(configName.c_str(), "msgs_log_async") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value >= 0 && value <= 2)
+                {
+                    configInfo.msgs_log_async = value;
+                }
+            }
             else
             {
             }
@@ -272,6 +312,10 @@ int main(int argc, char* argv[])
 
     logFile->SetMaxSize(configInfo.msgs_log_loop_bytes);
     logFile->SetGreenLevel(configInfo.msgs_log_level_green);
+    if (configInfo.msgs_log_async > 0)
+    {
+        logFile->EnableAsync(configInfo.msgs_log_async == 2);
+    }
 
     if (!db->Open(dbFileName.c_str()))
     {
@@ -571,6 +615,14 @@ int main(int argc, char* argv[])
                 {
                     configInfo.msgs_log_level_green    = atoi(configValue.c_str());
                 }
+                else if (stricmp(configName.c_str(), "msgs_log_stats_interval") == 0)
+                {
+                    const int value = atoi(configValue.c_str());
+                    if (value >= 0 && value <= 3600)
+                    {
+                        configInfo.msgs_log_stats_interval = value;
+                    }
+                }
                 else
                 {
                 }
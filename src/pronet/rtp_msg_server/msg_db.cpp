@@ -36,59 +36,39 @@ GetMsgUserRow(CDbConnection&      db,
               const RTP_MSG_USER& user,
               TBL_MSG_USER_ROW&   row)
 {
-    char sql[1024] = "";
-    snprintf_pro(
-        sql,
-        sizeof(sql),
+    const char* const sql =
         " SELECT _cid_, _uid_, _maxiids_, _isc2s_, _passwd_, _bindedip_ "
-        " FROM tbl_msg01_user WHERE _cid_=%u AND _uid_=" PRO_PRT64U,
-        (unsigned int)user.classId,
-        user.UserId()
-        );
-
-    DB_ROW_SET dbrows;
-    dbrows.types_in.push_back(DB_CT_I64); /* _cid_ */
-    dbrows.types_in.push_back(DB_CT_I64); /* _uid_ */
-    dbrows.types_in.push_back(DB_CT_I64); /* _maxiids_ */
-    dbrows.types_in.push_back(DB_CT_I64); /* _isc2s_ */
-    dbrows.types_in.push_back(DB_CT_TXT); /* _passwd_ */
-    dbrows.types_in.push_back(DB_CT_TXT); /* _bindedip_ */
+        " FROM tbl_msg01_user WHERE _cid_=?1 AND _uid_=?2 ";
 
-    if (!db.DoSelect(sql, dbrows))
+    CDbCursor cursor(db);
+    if (!cursor.Open(sql))
     {
         return (-1);
     }
 
-    if (dbrows.rows_out.size() == 0)
-    {
-        return (0);
-    }
+    cursor.BindI64(1, user.classId);
+    cursor.BindI64(2, user.UserId());
 
+    if (!cursor.Next())
     {
-        const DB_ROW_UNIT& dbrow = dbrows.rows_out[0];
-
-        row._cid_      = dbrow.cells[0].i64;
-        row._uid_      = dbrow.cells[1].i64;
-        row._maxiids_  = dbrow.cells[2].i64;
-        row._isc2s_    = dbrow.cells[3].i64;
-        row._passwd_   = dbrow.cells[4].txt;
-        row._bindedip_ = dbrow.cells[5].txt;
+        return (cursor.IsDone() ? 0 : -1);
     }
 
-    int       i = 0;
-    const int c = (int)dbrows.rows_out.size();
-
-    for (; i < c; ++i)
+    if (cursor.GetColumnCount() != 6)
     {
-        DB_ROW_UNIT& dbrow = dbrows.rows_out[i];
-        if (!dbrow.cells[4].txt.empty())
-        {
-            ProZeroMemory(
-                &dbrow.cells[4].txt[0], dbrow.cells[4].txt.length());
-            dbrow.cells[4].txt = "";
-        }
+        return (-1);
     }
 
+    /*
+     * the password goes from sqlite to the row without copies in between
+     */
+    row._cid_      = cursor.GetI64(0);
+    row._uid_      = cursor.GetI64(1);
+    row._maxiids_  = cursor.GetI64(2);
+    row._isc2s_    = cursor.GetI64(3);
+    row._passwd_   = cursor.GetTxt(4);
+    row._bindedip_ = cursor.GetTxt(5);
+
     row.Adjust();
 
     return (1);
@@ -104,31 +84,32 @@ GetMsgKickoutRows(CDbConnection&                      db,
     const char* const sql =
         " SELECT _cid_, _uid_, _iid_ FROM tbl_msg02_kickout ";
 
-    DB_ROW_SET dbrows;
-    dbrows.types_in.push_back(DB_CT_I64); /* _cid_ */
-    dbrows.types_in.push_back(DB_CT_I64); /* _uid_ */
-    dbrows.types_in.push_back(DB_CT_I64); /* _iid_ */
-
-    if (!db.DoSelect(sql, dbrows))
+    CDbCursor cursor(db);
+    if (!cursor.Open(sql))
     {
         return;
     }
 
-    int       i = 0;
-    const int c = (int)dbrows.rows_out.size();
-
-    for (; i < c; ++i)
+    while (cursor.Next())
     {
-        const DB_ROW_UNIT& dbrow = dbrows.rows_out[i];
+        if (cursor.GetColumnCount() != 3)
+        {
+            break;
+        }
 
         TBL_MSG_KICKOUT_ROW row;
-        row._cid_ = dbrow.cells[0].i64;
-        row._uid_ = dbrow.cells[1].i64;
-        row._iid_ = dbrow.cells[2].i64;
+        row._cid_ = cursor.GetI64(0);
+        row._uid_ = cursor.GetI64(1);
+        row._iid_ = cursor.GetI64(2);
 
         row.Adjust();
         rows.push_back(row);
     }
+
+    if (!cursor.IsDone())
+    {
+        rows.clear();
+    }
 }
 
 void
@@ -155,57 +136,26 @@ AddMsgOnlineRow(CDbConnection&      db,
     CProStlString timeString = "";
     ProGetLocalTimeString(timeString);
 
+    /*
+     * (_cid_, _uid_, _iid_) is the primary key
+     */
     char sql[1024] = "";
     snprintf_pro(
         sql,
         sizeof(sql),
-        " SELECT _cid_ FROM tbl_msg03_online "
-        " WHERE _cid_=%u AND _uid_=" PRO_PRT64U " AND _iid_=%u ",
+        " INSERT OR REPLACE INTO tbl_msg03_online "
+        " (_cid_, _uid_, _iid_, "
+        " _fromip_, _fromc2s_, _sslsuite_, _logontime_) "
+        " VALUES (%u, " PRO_PRT64U ", %u, '%s', '%s', '%s', '%s') ",
         (unsigned int)user.classId,
         user.UserId(),
-        (unsigned int)user.instId
+        (unsigned int)user.instId,
+        userPublicIp.c_str(),
+        c2sIdString.c_str(),
+        sslSuiteName.c_str(),
+        timeString.c_str()
         );
 
-    DB_ROW_SET dbrows;
-    dbrows.types_in.push_back(DB_CT_I64); /* _cid_ */
-
-    if (db.DoSelect(sql, dbrows) && dbrows.rows_out.size() > 0)
-    {
-        snprintf_pro(
-            sql,
-            sizeof(sql),
-            " UPDATE tbl_msg03_online "
-            " SET _fromip_='%s', _fromc2s_='%s', "
-            " _sslsuite_='%s', _logontime_='%s' "
-            " WHERE _cid_=%u AND _uid_=" PRO_PRT64U " AND _iid_=%u ",
-            userPublicIp.c_str(),
-            c2sIdString.c_str(),
-            sslSuiteName.c_str(),
-            timeString.c_str(),
-            (unsigned int)user.classId,
-            user.UserId(),
-            (unsigned int)user.instId
-            );
-    }
-    else
-    {
-        snprintf_pro(
-            sql,
-            sizeof(sql),
-            " INSERT INTO tbl_msg03_online "
-            " (_cid_, _uid_, _iid_, "
-            " _fromip_, _fromc2s_, _sslsuite_, _logontime_) "
-            " VALUES (%u, " PRO_PRT64U ", %u, '%s', '%s', '%s', '%s') ",
-            (unsigned int)user.classId,
-            user.UserId(),
-            (unsigned int)user.instId,
-            userPublicIp.c_str(),
-            c2sIdString.c_str(),
-            sslSuiteName.c_str(),
-            timeString.c_str()
-            );
-    }
-
     db.DoOther(sql);
 }
 
@@ -0,0 +1,407 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+#include "msg_db_writer.h"
+#include "db_connection.h"
+#include "db_struct.h"
+#include "msg_db.h"
+#include "../pro_rtp/rtp_base.h"
+#include "../pro_rtp/rtp_msg.h"
+#include "../pro_util/pro_log_file.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_z.h"
+#include <cassert>
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define DEFAULT_BATCH_SIZE  256
+#define DEFAULT_DELAY_MS    100
+#define STOP_TRIES          3
+
+/*
+ * (_cid_, _uid_, _iid_) is the primary key. there's no "ON CONFLICT DO
+ * UPDATE" before sqlite 3.24
+ */
+static const char* const UPSERT_SQL =
+    " INSERT OR REPLACE INTO tbl_msg03_online "
+    " (_cid_, _uid_, _iid_, "
+    " _fromip_, _fromc2s_, _sslsuite_, _logontime_) "
+    " VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7) ";
+
+static const char* const DELETE_SQL =
+    " DELETE FROM tbl_msg03_online "
+    " WHERE _cid_=?1 AND _uid_=?2 AND _iid_=?3 ";
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CMsgDbWriter::CMsgDbWriter(CProLogFile&   logFile,
+                           CDbConnection& db)
+                           :
+m_logFile(logFile),
+m_db(db)
+{
+    m_batchSize       = DEFAULT_BATCH_SIZE;
+    m_delayInMs       = DEFAULT_DELAY_MS;
+    m_started         = false;
+    m_stopping        = false;
+    m_firstChangeTick = 0;
+}
+
+CMsgDbWriter::~CMsgDbWriter()
+{
+    Stop();
+}
+
+bool
+CMsgDbWriter::Start(unsigned long batchSize,
+                    unsigned long delayInMs)
+{
+    CProThreadMutexGuard mon(m_startLock);
+
+    if (m_started)
+    {
+        return (true);
+    }
+
+    if (batchSize == 0)
+    {
+        batchSize = DEFAULT_BATCH_SIZE;
+    }
+    if (delayInMs == 0)
+    {
+        delayInMs = DEFAULT_DELAY_MS;
+    }
+
+    /*
+     * the writer's own connection, so that its transaction takes in nothing
+     * but the batch
+     */
+    const CProStlString fileName = m_db.GetFileName();
+    if (fileName.empty() || !m_writerDb.Open(fileName.c_str()))
+    {
+        return (false);
+    }
+
+    m_batchSize = batchSize;
+    m_delayInMs = delayInMs;
+
+    {
+        CProThreadMutexGuard mon2(m_lock);
+
+        m_started  = true;
+        m_stopping = false;
+    }
+
+    if (!Spawn(false))
+    {
+        {
+            CProThreadMutexGuard mon2(m_lock);
+
+            m_started = false;
+        }
+
+        m_writerDb.Close();
+
+        return (false);
+    }
+
+    return (true);
+}
+
+void
+CMsgDbWriter::Stop()
+{
+    CProThreadMutexGuard mon(m_startLock);
+
+    {
+        CProThreadMutexGuard mon2(m_lock);
+
+        if (!m_started)
+        {
+            return;
+        }
+
+        m_stopping = true;
+    }
+
+    m_cond.Signal();
+
+    /*
+     * the writer drains the changes, and then the later changes are written
+     * at once, after the queued ones
+     */
+    WaitAll();
+
+    m_writerDb.Close();
+}
+
+void
+CMsgDbWriter::AddRow(const RTP_MSG_USER& user,
+                     const char*         userPublicIp,
+                     const char*         c2sIdString,
+                     const char*         sslSuiteName)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_started)
+        {
+            Enqueue_i();
+
+            MSG_ONLINE_CHANGE& change = m_changes[user];
+            change.online       = true;
+            change.userPublicIp = CProStlString(userPublicIp).substr(0, 64);
+            change.c2sIdString  = CProStlString(c2sIdString).substr (0, 64);
+            change.sslSuiteName = CProStlString(sslSuiteName).substr(0, 64);
+            ProGetLocalTimeString(change.timeString);
+
+            return;
+        }
+    }
+
+    AddMsgOnlineRow(m_db, user, userPublicIp, c2sIdString, sslSuiteName);
+}
+
+void
+CMsgDbWriter::RemoveRow(const RTP_MSG_USER& user)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_started)
+        {
+            Enqueue_i();
+
+            MSG_ONLINE_CHANGE& change = m_changes[user];
+            change = MSG_ONLINE_CHANGE(); /* a logon not written yet is dropped */
+
+            return;
+        }
+    }
+
+    RemoveMsgOnlineRow(m_db, user);
+}
+
+void
+CMsgDbWriter::Enqueue_i()
+{
+    if (m_changes.size() == 0)
+    {
+        m_firstChangeTick = ProGetTickCount64();
+        m_cond.Signal(); /* the delay starts */
+    }
+    else if (m_changes.size() + 1 >= m_batchSize)
+    {
+        m_cond.Signal();
+    }
+    else
+    {
+    }
+}
+
+void
+CMsgDbWriter::Svc()
+{
+    int tries = STOP_TRIES;
+
+    while (1)
+    {
+        bool                                        draining = false;
+        bool                                        exiting  = false;
+        CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE> changes;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            while (1)
+            {
+                if (m_stopping)
+                {
+                    draining = true;
+                    break;
+                }
+
+                if (m_changes.size() == 0)
+                {
+                    m_cond.Wait(&m_lock);
+                    continue;
+                }
+
+                const PRO_INT64 elapsed = ProGetTickCount64() - m_firstChangeTick;
+                if (m_changes.size() >= m_batchSize || elapsed >= (PRO_INT64)m_delayInMs)
+                {
+                    break;
+                }
+
+                m_cond.TimedWait(&m_lock, (unsigned long)(m_delayInMs - elapsed));
+            }
+
+            if (draining && (m_changes.size() == 0 || tries == 0))
+            {
+                exiting   = true;
+                m_started = false; /* the later changes are written at once */
+            }
+
+            changes.swap(m_changes); /* the rest can't be written if exiting */
+            m_firstChangeTick = 0;
+        }
+
+        if (exiting)
+        {
+            if (changes.size() > 0)
+            {
+                LogDropped(changes);
+            }
+            break;
+        }
+
+        if (!Write(changes) && draining)
+        {
+            --tries;
+        }
+    }
+}
+
+bool
+CMsgDbWriter::Write(const CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>& changes)
+{
+    /*
+     * (_cid_, _uid_, _iid_) and then (_fromip_, _fromc2s_, _sslsuite_,
+     * _logontime_). the texts point into the changes
+     */
+    DB_PARAM_UNIT upsertParams[7];
+    DB_PARAM_UNIT deleteParams[3];
+
+    int       i = 3;
+    const int c = sizeof(upsertParams) / sizeof(upsertParams[0]);
+    const int d = sizeof(deleteParams) / sizeof(deleteParams[0]);
+
+    for (; i < c; ++i)
+    {
+        upsertParams[i].type = DB_CT_TXT;
+    }
+
+    /*
+     * one fsync for the batch. if it can't begin, the changes are still
+     * written one by one
+     */
+    const bool transacting = m_writerDb.BeginTransaction();
+    bool       ok          = true;
+
+    CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>::const_iterator       itr = changes.begin();
+    CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>::const_iterator const end = changes.end();
+
+    for (; itr != end; ++itr)
+    {
+        const RTP_MSG_USER&      user   = itr->first;
+        const MSG_ONLINE_CHANGE& change = itr->second;
+
+        if (change.online)
+        {
+            upsertParams[0].i64    = user.classId;
+            upsertParams[1].i64    = user.UserId();
+            upsertParams[2].i64    = user.instId;
+            upsertParams[3].txt    = change.userPublicIp.c_str();
+            upsertParams[3].txtLen = (int)change.userPublicIp.length();
+            upsertParams[4].txt    = change.c2sIdString.c_str();
+            upsertParams[4].txtLen = (int)change.c2sIdString.length();
+            upsertParams[5].txt    = change.sslSuiteName.c_str();
+            upsertParams[5].txtLen = (int)change.sslSuiteName.length();
+            upsertParams[6].txt    = change.timeString.c_str();
+            upsertParams[6].txtLen = (int)change.timeString.length();
+
+            ok = m_writerDb.DoOther(UPSERT_SQL, upsertParams, c) && ok;
+        }
+        else
+        {
+            deleteParams[0].i64 = user.classId;
+            deleteParams[1].i64 = user.UserId();
+            deleteParams[2].i64 = user.instId;
+
+            ok = m_writerDb.DoOther(DELETE_SQL, deleteParams, d) && ok;
+        }
+    }
+
+    if (!transacting)
+    {
+        return (true); /* the failed ones are lost, as without the writer */
+    }
+
+    if (ok && m_writerDb.CommitTransaction())
+    {
+        return (true);
+    }
+
+    m_writerDb.RollbackTransaction();
+
+    /*
+     * retry with the next batch, unless the user has changed again
+     */
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_changes.size() == 0)
+        {
+            m_firstChangeTick = ProGetTickCount64();
+        }
+
+        for (itr = changes.begin(); itr != end; ++itr)
+        {
+            m_changes.insert(*itr);
+        }
+    }
+
+    return (false);
+}
+
+void
+CMsgDbWriter::LogDropped(const CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>& changes)
+{
+    char countString[64] = "";
+    snprintf_pro(countString, sizeof(countString), "%u", (unsigned int)changes.size());
+
+    CProStlString traceInfo = "";
+    traceInfo += '\n';
+    traceInfo += " CMsgDbWriter::Svc() failed to write the online users, ";
+    traceInfo += countString;
+    traceInfo += " dropped \n";
+    traceInfo += " [[[ begin \n";
+
+    CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>::const_iterator       itr = changes.begin();
+    CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>::const_iterator const end = changes.end();
+
+    for (; itr != end; ++itr)
+    {
+        char idString[64] = "";
+        RtpMsgUser2String(&itr->first, idString);
+        traceInfo += "\t ";
+        traceInfo += idString;
+        traceInfo += itr->second.online ? " online \n" : " offline \n";
+    }
+
+    traceInfo += " ]]] end \n";
+
+    m_logFile.Log(traceInfo.c_str(), PRO_LL_ERROR, true);
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+
+/*
+ * Write-behind of the table "tbl_msg03_online".
+ *
+ * AddRow() and RemoveRow() only record the change of a user, the last one
+ * wins, and a background thread writes the changes in one transaction when
+ * "batchSize" users have changed or the oldest change is "delayInMs" old.
+ * The thread has its own connection to the database, so the transaction
+ * never takes in the statements of the others.
+ *
+ * Stop() writes what's left before returning. The changes that still can't
+ * be written after the retries are logged as dropped.
+ *
+ * Without Start(), the changes are written at once, as before.
+ */
+
+#if !defined(MSG_DB_WRITER_H)
+#define MSG_DB_WRITER_H
+
+#include "db_connection.h"
+#include "db_struct.h"
+#include "../pro_rtp/rtp_base.h"
+#include "../pro_rtp/rtp_msg.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread.h"
+#include "../pro_util/pro_thread_mutex.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CProLogFile;
+
+struct MSG_ONLINE_CHANGE
+{
+    MSG_ONLINE_CHANGE()
+    {
+        online       = false;
+        userPublicIp = "";
+        c2sIdString  = "";
+        sslSuiteName = "";
+        timeString   = "";
+    }
+
+    bool          online; /* false for a removal */
+    CProStlString userPublicIp;
+    CProStlString c2sIdString;
+    CProStlString sslSuiteName;
+    CProStlString timeString;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CMsgDbWriter : public CProThreadBase
+{
+public:
+
+    CMsgDbWriter(
+        CProLogFile&   logFile,
+        CDbConnection& db
+        );
+
+    ~CMsgDbWriter();
+
+    bool Start(
+        unsigned long batchSize,
+        unsigned long delayInMs
+        );
+
+    /*
+     * writes the pending changes, and stops the writer thread
+     */
+    void Stop();
+
+    void AddRow(
+        const RTP_MSG_USER& user,
+        const char*         userPublicIp,
+        const char*         c2sIdString,
+        const char*         sslSuiteName
+        );
+
+    void RemoveRow(const RTP_MSG_USER& user);
+
+private:
+
+    virtual void Svc();
+
+    void Enqueue_i();
+
+    bool Write(const CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>& changes);
+
+    void LogDropped(const CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE>& changes);
+
+private:
+
+    CProLogFile&                                m_logFile;
+    CDbConnection&                              m_db;
+    CDbConnection                               m_writerDb;
+    unsigned long                               m_batchSize;
+    unsigned long                               m_delayInMs;
+    bool                                        m_started;
+    bool                                        m_stopping;
+    CProStlMap<RTP_MSG_USER, MSG_ONLINE_CHANGE> m_changes;
+    PRO_INT64                                   m_firstChangeTick;
+    CProThreadMutexCondition                    m_cond; /* signalled on the first change and a full batch */
+    CProThreadMutex                             m_lock;
+    CProThreadMutex                             m_startLock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* MSG_DB_WRITER_H */
@@ -30,6 +30,7 @@
 #include "../pro_util/pro_ssl_util.h"
 #include "../pro_util/pro_stl.h"
 #include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
 #include "../pro_util/pro_z.h"
 #include <cassert>
 
@@ -41,6 +42,107 @@ static const unsigned char SERVER_CID = 1; /* 1-... */
 /////////////////////////////////////////////////////////////////////////////
 ////
 
+static
+void
+PRO_CALLTYPE
+ReactorStats2String_i(const PRO_REACTOR_STATS* prevStats,
+                      const PRO_REACTOR_STATS* stats,
+                      size_t                   count,
+                      PRO_INT64                elapsedMs,
+                      CProStlString&           traceInfo)
+{
+    char theBuf[1024] = "";
+
+    snprintf_pro(
+        theBuf,
+        sizeof(theBuf),
+        "\n"
+        " reactor stats (last %u ms, max since start) \n"
+        " [[[ begin \n"
+        ,
+        (unsigned int)elapsedMs
+        );
+    traceInfo += theBuf;
+
+    int ioIndex = 0;
+
+    for (int i = 0; i < (int)count; ++i)
+    {
+        const PRO_REACTOR_STATS& prev = prevStats[i];
+        const PRO_REACTOR_STATS& cur  = stats[i];
+
+        const PRO_UINT64 loops   = cur.loopCount   - prev.loopCount;
+        const PRO_UINT64 events  = cur.eventCount  - prev.eventCount;
+        const PRO_UINT64 upcalls = cur.upcallCount - prev.upcallCount;
+        const PRO_UINT64 us      = cur.upcallUs    - prev.upcallUs;
+
+        PRO_UINT64 slow = 0; /* >= 10ms */
+        for (int j = 4; j < PRO_STAT_HISTOGRAM_SIZE; ++j)
+        {
+            slow += cur.histogram[j] - prev.histogram[j];
+        }
+
+        if (cur.threadType == PRO_RTT_TIMER || cur.threadType == PRO_RTT_MMTIMER)
+        {
+            const PRO_UINT64 lagUs = cur.timerLagUs - prev.timerLagUs;
+
+            snprintf_pro(
+                theBuf,
+                sizeof(theBuf),
+                "\t %-8s: timers %u, fired %u (avg %uus, max %uus),"
+                " lag avg %.2fms (max %.2fms, >=10ms %u) \n"
+                ,
+                cur.threadType == PRO_RTT_TIMER ? "timer" : "mmtimer",
+                (unsigned int)cur.timerCount,
+                (unsigned int)upcalls,
+                (unsigned int)(upcalls > 0 ? us / upcalls : 0),
+                (unsigned int)cur.upcallMaxUs,
+                upcalls > 0 ? (double)lagUs / upcalls / 1000 : 0.0,
+                (double)cur.timerLagMaxUs / 1000,
+                (unsigned int)slow
+                );
+        }
+        else
+        {
+            char name[32] = "accept";
+            if (cur.threadType == PRO_RTT_IO)
+            {
+                snprintf_pro(name, sizeof(name), "io-%d", ++ioIndex);
+            }
+
+            const PRO_UINT64 busyUs = cur.loopBusyUs - prev.loopBusyUs;
+
+            snprintf_pro(
+                theBuf,
+                sizeof(theBuf),
+                "\t %-8s: socks %u, loops %u, events %u (max %u),"
+                " upcalls %u (avg %uus, max %uus), busy %.2f%% (max %uus,"
+                " >=10ms %u), wakeups %u \n"
+                ,
+                name,
+                (unsigned int)cur.handlerCount,
+                (unsigned int)loops,
+                (unsigned int)events,
+                (unsigned int)cur.eventMaxPerLoop,
+                (unsigned int)upcalls,
+                (unsigned int)(upcalls > 0 ? us / upcalls : 0),
+                (unsigned int)cur.upcallMaxUs,
+                elapsedMs > 0 ? (double)busyUs / elapsedMs / 10 : 0.0,
+                (unsigned int)cur.loopBusyMaxUs,
+                (unsigned int)slow,
+                (unsigned int)(cur.notifyCount - prev.notifyCount)
+                );
+        }
+
+        traceInfo += theBuf;
+    }
+
+    traceInfo += " ]]] end \n";
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
 CMsgServer*
 CMsgServer::CreateInstance(CProLogFile&   logFile,
                            CDbConnection& db)
@@ -54,11 +156,14 @@ CMsgServer::CMsgServer(CProLogFile&   logFile,
                        CDbConnection& db)
                        :
 m_logFile(logFile),
-m_db(db)
+m_db(db),
+m_dbWriter(logFile, db)
 {
-    m_reactor   = NULL;
-    m_sslConfig = NULL;
-    m_msgServer = NULL;
+    m_reactor      = NULL;
+    m_sslConfig    = NULL;
+    m_msgServer    = NULL;
+    m_statsTimerId = 0;
+    m_statsTick    = 0;
 }
 
 CMsgServer::~CMsgServer()
@@ -139,6 +244,10 @@ CMsgServer::Init(IProReactor*                  reactor,
 
                 ProSslServerConfig_EnableSha1Cert(
                     sslConfig, configInfo.msgs_ssl_enable_sha1cert);
+                ProSslServerConfig_EnableLeanBuffers(
+                    sslConfig, configInfo.msgs_ssl_lean_buffers);
+                ProSslServerConfig_EnableKtls(
+                    sslConfig, configInfo.msgs_ssl_ktls);
 
                 if (!ProSslServerConfig_SetCaList(
                     sslConfig,
@@ -181,10 +290,25 @@ CMsgServer::Init(IProReactor*                  reactor,
         msgServer->SetOutputRedlineToC2s(configInfo.msgs_redline_bytes_c2s);
         msgServer->SetOutputRedlineToUsr(configInfo.msgs_redline_bytes_usr);
 
+        /*
+         * if it can't start, the online users are written at once
+         */
+        if (!configInfo.msgs_db_readonly && configInfo.msgs_db_write_batch > 0)
+        {
+            m_dbWriter.Start(
+                configInfo.msgs_db_write_batch, configInfo.msgs_db_write_delay);
+        }
+
         m_reactor    = reactor;
         m_configInfo = configInfo;
         m_sslConfig  = sslConfig;
         m_msgServer  = msgServer;
+
+        if (configInfo.msgs_log_stats_interval > 0)
+        {
+            m_statsTimerId = reactor->ScheduleTimer(
+                this, (PRO_UINT64)configInfo.msgs_log_stats_interval * 1000, true);
+        }
     }
 
     return (true);
@@ -211,6 +335,9 @@ CMsgServer::Fini()
             return;
         }
 
+        m_reactor->CancelTimer(m_statsTimerId);
+        m_statsTimerId = 0;
+
         msgServer = m_msgServer;
         m_msgServer = NULL;
         sslConfig = m_sslConfig;
@@ -220,6 +347,7 @@ CMsgServer::Fini()
 
     DeleteRtpMsgServer(msgServer);
     ProSslServerConfig_Delete(sslConfig);
+    m_dbWriter.Stop(); /* flushes the online users */
 }
 
 unsigned long
@@ -306,6 +434,24 @@ CMsgServer::Reconfig(const MSG_SERVER_CONFIG_INFO& configInfo)
 
         m_logFile.SetMaxSize(configInfo.msgs_log_loop_bytes);
         m_logFile.SetGreenLevel(configInfo.msgs_log_level_green);
+
+        if (configInfo.msgs_log_stats_interval !=
+            m_configInfo.msgs_log_stats_interval)
+        {
+            m_configInfo.msgs_log_stats_interval =
+                configInfo.msgs_log_stats_interval;
+
+            m_reactor->CancelTimer(m_statsTimerId);
+            m_statsTimerId = 0;
+            m_statsTick    = 0;
+            m_stats.clear();
+
+            if (configInfo.msgs_log_stats_interval > 0)
+            {
+                m_statsTimerId = m_reactor->ScheduleTimer(
+                    this, (PRO_UINT64)configInfo.msgs_log_stats_interval * 1000, true);
+            }
+        }
     }
 
     {{{
@@ -314,10 +460,11 @@ CMsgServer::Reconfig(const MSG_SERVER_CONFIG_INFO& configInfo)
             traceInfo,
             sizeof(traceInfo),
             "\n"
-            " CMsgServer::Reconfig(%u, %d) \n"
+            " CMsgServer::Reconfig(%u, %d, %u) \n"
             ,
             configInfo.msgs_log_loop_bytes,
-            configInfo.msgs_log_level_green
+            configInfo.msgs_log_level_green,
+            configInfo.msgs_log_stats_interval
             );
         m_logFile.Log(traceInfo, PRO_LL_MAX, true);
     }}}
@@ -378,7 +525,7 @@ CMsgServer::OnCheckUser(IRtpMsgServer*      msgServer,
 
         const MSG_USER_CTX* ctx = NULL;
 
-        CProStlMap<PRO_UINT64, MSG_USER_CTX>::iterator const itr =
+        CProStlHashMap<PRO_UINT64, MSG_USER_CTX>::iterator const itr =
             m_uid2Ctx[user->classId].find(user->UserId());
         if (itr != m_uid2Ctx[user->classId].end())
         {
@@ -543,7 +690,7 @@ CMsgServer::OnOkUser(IRtpMsgServer*      msgServer,
 
         if (!m_configInfo.msgs_db_readonly)
         {
-            AddMsgOnlineRow(m_db, *user, userPublicIp, c2sIdString, suiteName);
+            m_dbWriter.AddRow(*user, userPublicIp, c2sIdString, suiteName);
         }
     }
 
@@ -600,7 +747,7 @@ CMsgServer::OnCloseUser(IRtpMsgServer*      msgServer,
             return;
         }
 
-        CProStlMap<PRO_UINT64, MSG_USER_CTX>::iterator const itr =
+        CProStlHashMap<PRO_UINT64, MSG_USER_CTX>::iterator const itr =
             m_uid2Ctx[user->classId].find(user->UserId());
         if (itr == m_uid2Ctx[user->classId].end())
         {
@@ -616,7 +763,7 @@ CMsgServer::OnCloseUser(IRtpMsgServer*      msgServer,
 
         if (!m_configInfo.msgs_db_readonly)
         {
-            RemoveMsgOnlineRow(m_db, *user);
+            m_dbWriter.RemoveRow(*user);
         }
     }
 
@@ -644,3 +791,66 @@ CMsgServer::OnCloseUser(IRtpMsgServer*      msgServer,
         m_logFile.Log(traceInfo, PRO_LL_INFO, true);
     }}}
 }
+
+void
+PRO_CALLTYPE
+CMsgServer::OnTimer(void*      factory,
+                    PRO_UINT64 timerId,
+                    PRO_INT64  userData)
+{
+    IProReactor* reactor = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL || m_msgServer == NULL)
+        {
+            return;
+        }
+
+        if (timerId != m_statsTimerId)
+        {
+            return;
+        }
+
+        reactor = m_reactor;
+    }
+
+    CProStlVector<PRO_REACTOR_STATS> stats;
+    stats.resize(reactor->GetStats(NULL, 0));
+    if (stats.size() == 0)
+    {
+        return;
+    }
+    stats.resize(reactor->GetStats(&stats[0], (unsigned long)stats.size()));
+
+    const PRO_INT64 tick = ProGetTickCount64();
+
+    CProStlString traceInfo = "";
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL || timerId != m_statsTimerId)
+        {
+            return;
+        }
+
+        /*
+         * the first round only takes the baseline
+         */
+        if (m_stats.size() == stats.size() && tick > m_statsTick)
+        {
+            ReactorStats2String_i(
+                &m_stats[0], &stats[0], stats.size(), tick - m_statsTick, traceInfo);
+        }
+
+        m_stats     = stats;
+        m_statsTick = tick;
+    }
+
+    if (!traceInfo.empty())
+    {{{
+        m_logFile.Log(traceInfo.c_str(), PRO_LL_INFO, true);
+    }}}
+}
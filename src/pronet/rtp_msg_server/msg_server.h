@@ -19,6 +19,7 @@
 #if !defined(MSG_SERVER_H)
 #define MSG_SERVER_H
 
+#include "msg_db_writer.h"
 #include "../pro_rtp/rtp_base.h"
 #include "../pro_rtp/rtp_msg.h"
 #include "../pro_util/pro_config_file.h"
@@ -45,14 +46,20 @@ struct MSG_SERVER_CONFIG_INFO
         msgs_redline_bytes_c2s   = 8192000;
         msgs_redline_bytes_usr   = 1024000;
         msgs_db_readonly         = true;
+        msgs_db_write_batch      = 256;
+        msgs_db_write_delay      = 100;
 
         msgs_enable_ssl          = true;
         msgs_ssl_forced          = false;
         msgs_ssl_enable_sha1cert = true;
         msgs_ssl_keyfile         = "./server.key";
+        msgs_ssl_lean_buffers    = false;
+        msgs_ssl_ktls            = false;
 
         msgs_log_loop_bytes      = 50 * 1000 * 1000;
         msgs_log_level_green     = 0;
+        msgs_log_stats_interval  = 0;
+        msgs_log_async           = 1;
 
         msgs_ssl_cafiles.push_back("./ca.crt");
         msgs_ssl_cafiles.push_back("");
@@ -73,6 +80,8 @@ struct MSG_SERVER_CONFIG_INFO
         configStream.AddUint("msgs_redline_bytes_c2s"  , msgs_redline_bytes_c2s);
         configStream.AddUint("msgs_redline_bytes_usr"  , msgs_redline_bytes_usr);
         configStream.AddInt ("msgs_db_readonly"        , msgs_db_readonly);
+        configStream.AddUint("msgs_db_write_batch"     , msgs_db_write_batch);
+        configStream.AddUint("msgs_db_write_delay"     , msgs_db_write_delay);
 
         configStream.AddInt ("msgs_enable_ssl"         , msgs_enable_ssl);
         configStream.AddInt ("msgs_ssl_forced"         , msgs_ssl_forced);
@@ -81,9 +90,13 @@ struct MSG_SERVER_CONFIG_INFO
         configStream.Add    ("msgs_ssl_crlfile"        , msgs_ssl_crlfiles);
         configStream.Add    ("msgs_ssl_certfile"       , msgs_ssl_certfiles);
         configStream.Add    ("msgs_ssl_keyfile"        , msgs_ssl_keyfile);
+        configStream.AddInt ("msgs_ssl_lean_buffers"   , msgs_ssl_lean_buffers);
+        configStream.AddInt ("msgs_ssl_ktls"           , msgs_ssl_ktls);
 
         configStream.AddUint("msgs_log_loop_bytes"     , msgs_log_loop_bytes);
         configStream.AddInt ("msgs_log_level_green"    , msgs_log_level_green);
+        configStream.AddUint("msgs_log_stats_interval" , msgs_log_stats_interval);
+        configStream.AddUint("msgs_log_async"          , msgs_log_async);
 
         configStream.Get(configs);
     }
@@ -95,6 +108,8 @@ struct MSG_SERVER_CONFIG_INFO
     unsigned int                 msgs_redline_bytes_c2s;
     unsigned int                 msgs_redline_bytes_usr;
     bool                         msgs_db_readonly;
+    unsigned int                 msgs_db_write_batch;     /* 0 ~ 10000, 0 writes the online users at once */
+    unsigned int                 msgs_db_write_delay;     /* 1 ~ 10000 ms */
 
     bool                         msgs_enable_ssl;
     bool                         msgs_ssl_forced;
@@ -103,9 +118,13 @@ struct MSG_SERVER_CONFIG_INFO
     CProStlVector<CProStlString> msgs_ssl_crlfiles;
     CProStlVector<CProStlString> msgs_ssl_certfiles;
     CProStlString                msgs_ssl_keyfile;
+    bool                         msgs_ssl_lean_buffers;   /* release the record buffers of idle sessions */
+    bool                         msgs_ssl_ktls;           /* hand the record layer over to kernel TLS */
 
     unsigned int                 msgs_log_loop_bytes;
     int                          msgs_log_level_green;
+    unsigned int                 msgs_log_stats_interval; /* 0 ~ 3600, 0 disables */
+    unsigned int                 msgs_log_async;          /* 0: sync, 1: async (drop if full), 2: async (block if full) */
 
     DECLARE_SGI_POOL(0)
 };
@@ -120,7 +139,11 @@ struct MSG_USER_CTX
 /////////////////////////////////////////////////////////////////////////////
 ////
 
-class CMsgServer : public IRtpMsgServerObserver, public CProRefCount
+class CMsgServer
+:
+public IRtpMsgServerObserver,
+public IProOnTimer,
+public CProRefCount
 {
 public:
 
@@ -199,18 +222,28 @@ private:
     {
     }
 
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
 private:
 
-    CProLogFile&                         m_logFile;
-    CDbConnection&                       m_db;
-    IProReactor*                         m_reactor;
-    MSG_SERVER_CONFIG_INFO               m_configInfo;
-    PRO_SSL_SERVER_CONFIG*               m_sslConfig;
-    IRtpMsgServer*                       m_msgServer;
+    CProLogFile&                             m_logFile;
+    CDbConnection&                           m_db;
+    CMsgDbWriter                             m_dbWriter;
+    IProReactor*                             m_reactor;
+    MSG_SERVER_CONFIG_INFO                   m_configInfo;
+    PRO_SSL_SERVER_CONFIG*                   m_sslConfig;
+    IRtpMsgServer*                           m_msgServer;
+    PRO_UINT64                               m_statsTimerId;
+    PRO_INT64                                m_statsTick;
+    CProStlVector<PRO_REACTOR_STATS>         m_stats;
 
-    CProStlMap<PRO_UINT64, MSG_USER_CTX> m_uid2Ctx[256]; /* cid[0]<> ~ cid[255]<> */
+    CProStlHashMap<PRO_UINT64, MSG_USER_CTX> m_uid2Ctx[256]; /* cid[0]<> ~ cid[255]<> */
 
-    CProThreadMutex                      m_lock;
+    CProThreadMutex                          m_lock;
 
     DECLARE_SGI_POOL(0)
 };
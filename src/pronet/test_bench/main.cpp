@@ -0,0 +1,810 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "test.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_rtp/rtp_base.h"
+#include "../pro_util/pro_config_file.h"
+#include "../pro_util/pro_config_stream.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_version.h"
+#include "../pro_util/pro_z.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define CONFIG_FILE_NAME "test_bench.cfg"
+
+static const char* const g_s_scenarios[] =
+{
+    "conn_rate",
+    "bulk_conn_rate",
+    "echo_tput",
+    "rtp_pps",
+    "msg_fanout",
+    "tcp_resume",
+    "stl_hash",
+    "task_pool",
+    "task_mpsc",
+    "rtp_parse",
+    "crypto_tput",
+    "ssl_tput",
+    "dtls_pps"
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * a relative file name is relative to the directory of the executable
+ */
+static
+void
+MakeFileName_i(const char*    exeRoot,
+               CProStlString& fileName)
+{
+    if (fileName.empty())
+    {
+        return;
+    }
+
+    if (fileName[0] == '.' ||
+        fileName.find_first_of("\\/") == CProStlString::npos)
+    {
+        CProStlString fileName2 = exeRoot;
+        fileName2 += fileName;
+        fileName = fileName2;
+    }
+}
+
+static
+void
+ReadConfig_i(const char*        exeRoot,
+             BENCH_CONFIG_INFO& configInfo)
+{
+    CProStlString configFileName = exeRoot;
+    configFileName += CONFIG_FILE_NAME;
+
+    CProConfigFile configFile;
+    configFile.Init(configFileName.c_str());
+
+    CProStlVector<PRO_CONFIG_ITEM> configs;
+    if (!configFile.Read(configs))
+    {
+        configInfo.ToConfigs(configs);
+        configFile.Write(configs);
+    }
+
+    int       i = 0;
+    const int c = (int)configs.size();
+
+    for (; i < c; ++i)
+    {
+        const CProStlString& configName  = configs[i].configName;
+        const CProStlString& configValue = configs[i].configValue;
+        const int            value       = atoi(configValue.c_str());
+
+        if (stricmp(configName.c_str(), "bench_thread_count") == 0)
+        {
+            if (value > 0 && value <= 100)
+            {
+                configInfo.bench_thread_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_io_uring") == 0)
+        {
+            configInfo.bench_io_uring = value != 0 ? 1 : 0;
+        }
+        else if (stricmp(configName.c_str(), "bench_duration") == 0)
+        {
+            if (value > 0 && value <= 3600)
+            {
+                configInfo.bench_duration = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_tolerance") == 0)
+        {
+            if (value >= 0 && value <= 1000)
+            {
+                configInfo.bench_tolerance = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_conn_count") == 0)
+        {
+            if (value > 0 && value <= 60000)
+            {
+                configInfo.bench_conn_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_conn_pending_count") == 0)
+        {
+            if (value > 0 && value <= 1000)
+            {
+                configInfo.bench_conn_pending_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_echo_conn_count") == 0)
+        {
+            if (value > 0 && value <= 1000)
+            {
+                configInfo.bench_echo_conn_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_echo_msg_size") == 0)
+        {
+            if (value >= 16 && value <= 65536)
+            {
+                configInfo.bench_echo_msg_size = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_echo_window") == 0)
+        {
+            if (value > 0 && value <= 64)
+            {
+                configInfo.bench_echo_window = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_rtp_packet_rate") == 0)
+        {
+            if (value > 0)
+            {
+                configInfo.bench_rtp_packet_rate = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_rtp_packet_size") == 0)
+        {
+            if (value >= 16 && value <= 1400)
+            {
+                configInfo.bench_rtp_packet_size = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_msg_hub_port") == 0)
+        {
+            if (value > 0 && value <= 65535)
+            {
+                configInfo.bench_msg_hub_port = (unsigned short)value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_msg_recver_count") == 0)
+        {
+            if (value > 0 && value <= 255)
+            {
+                configInfo.bench_msg_recver_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_msg_rate") == 0)
+        {
+            if (value > 0)
+            {
+                configInfo.bench_msg_rate = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_msg_size") == 0)
+        {
+            if (value >= 16 && value <= 4096)
+            {
+                configInfo.bench_msg_size = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_hash_entry_count") == 0)
+        {
+            if (value > 0 && value <= 10000000)
+            {
+                configInfo.bench_hash_entry_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_task_command_count") == 0)
+        {
+            if (value > 0 && value <= 10000000)
+            {
+                configInfo.bench_task_command_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_parse_packet_count") == 0)
+        {
+            if (value > 0 && value <= 10000000)
+            {
+                configInfo.bench_parse_packet_count = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_crypto_record_size") == 0)
+        {
+            if (value >= 64 && value <= 16384)
+            {
+                configInfo.bench_crypto_record_size = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_ssl_stream_size") == 0)
+        {
+            if (value > 0 && value <= 4096)
+            {
+                configInfo.bench_ssl_stream_size = value;
+            }
+        }
+        else if (stricmp(configName.c_str(), "bench_ssl_cafile") == 0)
+        {
+            configInfo.bench_ssl_cafile = configValue;
+        }
+        else if (stricmp(configName.c_str(), "bench_ssl_certfile") == 0)
+        {
+            configInfo.bench_ssl_certfile = configValue;
+        }
+        else if (stricmp(configName.c_str(), "bench_ssl_keyfile") == 0)
+        {
+            configInfo.bench_ssl_keyfile = configValue;
+        }
+        else if (stricmp(configName.c_str(), "bench_ssl_sni") == 0)
+        {
+            configInfo.bench_ssl_sni = configValue;
+        }
+        else
+        {
+        }
+    } /* end of for (...) */
+
+    MakeFileName_i(exeRoot, configInfo.bench_ssl_cafile);
+    MakeFileName_i(exeRoot, configInfo.bench_ssl_certfile);
+    MakeFileName_i(exeRoot, configInfo.bench_ssl_keyfile);
+}
+
+static
+bool
+RunScenario_i(const char*                  scenario,
+              IProReactor*                 reactor,
+              const BENCH_CONFIG_INFO&     configInfo,
+              CProStlVector<BENCH_METRIC>& metrics)
+{
+    bool ret = false;
+
+    if (stricmp(scenario, "conn_rate") == 0)
+    {
+        CBenchConnRate* const bench = CBenchConnRate::CreateInstance(false);
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "bulk_conn_rate") == 0)
+    {
+        CBenchConnRate* const bench = CBenchConnRate::CreateInstance(true);
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "echo_tput") == 0)
+    {
+        CBenchEchoTput* const bench = CBenchEchoTput::CreateInstance();
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "rtp_pps") == 0)
+    {
+        CBenchRtpPps* const bench = CBenchRtpPps::CreateInstance(false);
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "dtls_pps") == 0)
+    {
+        CBenchRtpPps* const bench = CBenchRtpPps::CreateInstance(true);
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "msg_fanout") == 0)
+    {
+        CBenchMsgFanout* const bench = CBenchMsgFanout::CreateInstance();
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "tcp_resume") == 0)
+    {
+        CBenchTcpResume* const bench = CBenchTcpResume::CreateInstance();
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else if (stricmp(scenario, "stl_hash") == 0)
+    {
+        ret = CBenchStlHash::Run(configInfo, metrics);
+    }
+    else if (stricmp(scenario, "task_pool") == 0)
+    {
+        ret = CBenchTaskPool::Run(configInfo, metrics);
+    }
+    else if (stricmp(scenario, "task_mpsc") == 0)
+    {
+        ret = CBenchTaskMpsc::Run(configInfo, metrics);
+    }
+    else if (stricmp(scenario, "rtp_parse") == 0)
+    {
+        ret = CBenchRtpParse::Run(configInfo, metrics);
+    }
+    else if (stricmp(scenario, "crypto_tput") == 0)
+    {
+        ret = CBenchCryptoTput::Run(configInfo, metrics);
+    }
+    else if (stricmp(scenario, "ssl_tput") == 0)
+    {
+        CBenchSslTput* const bench = CBenchSslTput::CreateInstance();
+        ret = bench->Run(reactor, configInfo, metrics);
+        bench->Release();
+    }
+    else
+    {
+    }
+
+    return (ret);
+}
+
+/*
+ * the baseline is a csv file written by a previous run
+ */
+static
+bool
+ReadBaseline_i(const char*                         fileName,
+               CProStlMap<CProStlString, double>& key2Value)
+{
+    FILE* const file = fopen(fileName, "r");
+    if (file == NULL)
+    {
+        return (false);
+    }
+
+    char line[1024] = "";
+
+    while (fgets(line, sizeof(line), file) != NULL)
+    {
+        char scenario[256] = "";
+        char metric[256]   = "";
+        char value[64]     = "";
+
+        if (sscanf(line, "%255[^,],%255[^,],%63[^,]",
+            scenario, metric, value) != 3)
+        {
+            continue;
+        }
+        if (strcmp(scenario, "scenario") == 0) /* the header */
+        {
+            continue;
+        }
+
+        CProStlString key = scenario;
+        key += ".";
+        key += metric;
+        key2Value[key] = atof(value);
+    }
+
+    fclose(file);
+
+    return (true);
+}
+
+/*
+ * returns true if the metric is worse than the baseline by more than
+ * tolerance percent
+ */
+static
+bool
+IsRegression_i(const BENCH_METRIC& metric,
+               double              baseValue,
+               double              tolerance,
+               double*             deltaPercent)
+{
+    *deltaPercent = 0;
+
+    if (baseValue == 0)
+    {
+        return (!metric.higherBetter && metric.value > 0);
+    }
+
+    *deltaPercent = (metric.value - baseValue) * 100 / baseValue;
+
+    if (metric.higherBetter)
+    {
+        return (*deltaPercent < -tolerance);
+    }
+    else
+    {
+        return (*deltaPercent > tolerance);
+    }
+}
+
+static
+bool
+WriteCsv_i(const char*                        fileName,
+           const CProStlVector<BENCH_METRIC>& metrics)
+{
+    FILE* const file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        return (false);
+    }
+
+    fprintf(file, "scenario,metric,value,unit,better\n");
+
+    int       i = 0;
+    const int c = (int)metrics.size();
+
+    for (; i < c; ++i)
+    {
+        const BENCH_METRIC& metric = metrics[i];
+
+        fprintf(
+            file,
+            "%s,%s,%.3f,%s,%s\n",
+            metric.scenario.c_str(),
+            metric.metric.c_str(),
+            metric.value,
+            metric.unit.c_str(),
+            metric.higherBetter ? "higher" : "lower"
+            );
+    }
+
+    fclose(file);
+
+    return (true);
+}
+
+static
+bool
+WriteJson_i(const char*                              fileName,
+            const BENCH_CONFIG_INFO&                 configInfo,
+            const CProStlVector<BENCH_METRIC>&       metrics,
+            const CProStlMap<CProStlString, double>& key2BaseValue,
+            bool                                     hasBaseline)
+{
+    FILE* const file = fopen(fileName, "w");
+    if (file == NULL)
+    {
+        return (false);
+    }
+
+    CProStlString timeString = "";
+    ProGetLocalTimeString(timeString);
+
+    fprintf(
+        file,
+        "{\n"
+        "  \"version\": \"%d.%d.%d\",\n"
+        "  \"time\": \"%s\",\n"
+        "  \"config\": {\n"
+        ,
+        PRO_VER_MAJOR,
+        PRO_VER_MINOR,
+        PRO_VER_PATCH,
+        timeString.c_str()
+        );
+
+    CProStlVector<PRO_CONFIG_ITEM> configs;
+    configInfo.ToConfigs(configs);
+
+    int i = 0;
+    int c = (int)configs.size();
+
+    for (; i < c; ++i)
+    {
+        fprintf(
+            file,
+            "    \"%s\": %s%s\n",
+            configs[i].configName.c_str(),
+            configs[i].configValue.c_str(),
+            i + 1 < c ? "," : ""
+            );
+    }
+
+    fprintf(
+        file,
+        "  },\n"
+        "  \"results\": [\n"
+        );
+
+    i = 0;
+    c = (int)metrics.size();
+
+    for (; i < c; ++i)
+    {
+        const BENCH_METRIC& metric = metrics[i];
+
+        fprintf(
+            file,
+            "    { \"scenario\": \"%s\", \"metric\": \"%s\","
+            " \"value\": %.3f, \"unit\": \"%s\", \"better\": \"%s\""
+            ,
+            metric.scenario.c_str(),
+            metric.metric.c_str(),
+            metric.value,
+            metric.unit.c_str(),
+            metric.higherBetter ? "higher" : "lower"
+            );
+
+        CProStlString key = metric.scenario;
+        key += ".";
+        key += metric.metric;
+
+        CProStlMap<CProStlString, double>::const_iterator const itr =
+            key2BaseValue.find(key);
+        if (hasBaseline && itr != key2BaseValue.end())
+        {
+            double      deltaPercent = 0;
+            const bool  regression   = IsRegression_i(
+                metric, itr->second, configInfo.bench_tolerance, &deltaPercent);
+
+            fprintf(
+                file,
+                ", \"baseline\": %.3f, \"delta_percent\": %.2f,"
+                " \"regression\": %s"
+                ,
+                itr->second,
+                deltaPercent,
+                regression ? "true" : "false"
+                );
+        }
+
+        fprintf(file, " }%s\n", i + 1 < c ? "," : "");
+    }
+
+    fprintf(
+        file,
+        "  ]\n"
+        "}\n"
+        );
+
+    fclose(file);
+
+    return (true);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+int main(int argc, char* argv[])
+{
+    printf(
+        "\n"
+        " usage: \n"
+        " test_bench [-o <json_file>] [-c <csv_file>] [-b <baseline_csv_file>] \n"
+        "            [-d <seconds>] [-t <tolerance_percent>] [scenario ...] \n"
+        "\n"
+        " scenarios: \n"
+        " conn_rate bulk_conn_rate echo_tput rtp_pps msg_fanout tcp_resume \n"
+        " stl_hash task_pool task_mpsc rtp_parse crypto_tput ssl_tput dtls_pps \n"
+        " (default: all) \n"
+        "\n"
+        " for example: \n"
+        " test_bench \n"
+        " test_bench -o result.json -c result.csv \n"
+        " test_bench -b baseline.csv echo_tput rtp_pps \n"
+        );
+
+    ProNetInit();
+    ProRtpInit();
+
+    const char*                       jsonFileName = NULL;
+    const char*                       csvFileName  = NULL;
+    const char*                       baseFileName = NULL;
+    int                               duration     = 0;
+    int                               tolerance    = -1;
+    IProReactor*                      reactor      = NULL;
+    bool                              hasBaseline  = false;
+    unsigned long                     failedCount  = 0;
+    unsigned long                     regressCount = 0;
+    int                               exitCode     = 0;
+    BENCH_CONFIG_INFO                 configInfo;
+    CProStlVector<CProStlString>      scenarios;
+    CProStlVector<BENCH_METRIC>       metrics;
+    CProStlMap<CProStlString, double> key2BaseValue;
+
+    int i = 1;
+    int c = argc;
+
+    for (; i < c; ++i)
+    {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < c)
+        {
+            jsonFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-c") == 0 && i + 1 < c)
+        {
+            csvFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < c)
+        {
+            baseFileName = argv[++i];
+        }
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < c)
+        {
+            duration = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < c)
+        {
+            tolerance = atoi(argv[++i]);
+        }
+        else
+        {
+            scenarios.push_back(argv[i]);
+        }
+    }
+
+    if (scenarios.empty())
+    {
+        for (i = 0; i < (int)(sizeof(g_s_scenarios) / sizeof(char*)); ++i)
+        {
+            scenarios.push_back(g_s_scenarios[i]);
+        }
+    }
+
+    CProStlString timeString = "";
+    ProGetLocalTimeString(timeString);
+
+    char exeRoot[1024] = "";
+    ProGetExeDir_(exeRoot);
+
+    ReadConfig_i(exeRoot, configInfo);
+
+    if (duration > 0 && duration <= 3600)
+    {
+        configInfo.bench_duration = duration;
+    }
+    if (tolerance >= 0 && tolerance <= 1000)
+    {
+        configInfo.bench_tolerance = tolerance;
+    }
+
+    if (baseFileName != NULL)
+    {
+        hasBaseline = ReadBaseline_i(baseFileName, key2BaseValue);
+        if (!hasBaseline)
+        {
+            printf(
+                "\n"
+                "%s \n"
+                " test_bench --- warning! can't read the baseline file. \n"
+                " [%s] \n"
+                ,
+                timeString.c_str(),
+                baseFileName
+                );
+        }
+    }
+
+    reactor = ProCreateReactorEx(
+        configInfo.bench_thread_count,
+        0,
+        configInfo.bench_io_uring != 0 ? PRO_RB_IO_URING : PRO_RB_DEFAULT
+        );
+    if (reactor == NULL)
+    {
+        printf(
+            "\n"
+            "%s \n"
+            " test_bench --- error! can't create reactor. \n"
+            ,
+            timeString.c_str()
+            );
+
+        exitCode = 2;
+
+        goto EXIT;
+    }
+
+    {
+        PRO_REACTOR_STATS stats[2]; /* the accept thread, the 1st io thread */
+        memset(stats, 0, sizeof(stats));
+        reactor->GetStats(stats, 2);
+
+        printf(
+            "\n"
+            "%s \n"
+            " test_bench [ver-%d.%d.%d] --- [threads : %u, duration : %us, backend : %s] \n"
+            ,
+            timeString.c_str(),
+            PRO_VER_MAJOR,
+            PRO_VER_MINOR,
+            PRO_VER_PATCH,
+            configInfo.bench_thread_count,
+            configInfo.bench_duration,
+            stats[1].backend == PRO_RB_IO_URING ? "io_uring" : "default"
+            );
+    }
+
+    c = (int)scenarios.size();
+
+    for (i = 0; i < c; ++i)
+    {
+        printf("\n running %s... \n", scenarios[i].c_str());
+        fflush(stdout);
+
+        if (!RunScenario_i(scenarios[i].c_str(), reactor, configInfo, metrics))
+        {
+            printf(" %s --- failed! \n", scenarios[i].c_str());
+            ++failedCount;
+        }
+    }
+
+    printf("\n");
+
+    c = (int)metrics.size();
+
+    for (i = 0; i < c; ++i)
+    {
+        const BENCH_METRIC& metric = metrics[i];
+
+        CProStlString key = metric.scenario;
+        key += ".";
+        key += metric.metric;
+
+        printf(" %-40s %14.3f %-7s", key.c_str(), metric.value, metric.unit.c_str());
+
+        CProStlMap<CProStlString, double>::const_iterator const itr =
+            key2BaseValue.find(key);
+        if (hasBaseline && itr != key2BaseValue.end())
+        {
+            double     deltaPercent = 0;
+            const bool regression   = IsRegression_i(
+                metric, itr->second, configInfo.bench_tolerance, &deltaPercent);
+            if (regression)
+            {
+                ++regressCount;
+            }
+
+            printf(" (base %.3f, %+.2f%%)%s", itr->second, deltaPercent,
+                regression ? " <<< REGRESSION" : "");
+        }
+
+        printf("\n");
+    }
+
+    if (jsonFileName != NULL &&
+        !WriteJson_i(jsonFileName, configInfo, metrics, key2BaseValue, hasBaseline))
+    {
+        printf("\n test_bench --- error! can't write [%s] \n", jsonFileName);
+        ++failedCount;
+    }
+    if (csvFileName != NULL && !WriteCsv_i(csvFileName, metrics))
+    {
+        printf("\n test_bench --- error! can't write [%s] \n", csvFileName);
+        ++failedCount;
+    }
+
+    if (failedCount > 0)
+    {
+        exitCode = 2;
+    }
+    else if (regressCount > 0)
+    {
+        exitCode = 1;
+    }
+    else
+    {
+    }
+
+    printf(
+        "\n"
+        " test_bench --- %u failed, %u regressed (tolerance : %u%%) \n"
+        ,
+        (unsigned int)failedCount,
+        (unsigned int)regressCount,
+        configInfo.bench_tolerance
+        );
+
+EXIT:
+
+    ProDeleteReactor(reactor);
+
+    return (exitCode);
+}
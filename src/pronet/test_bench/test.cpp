@@ -0,0 +1,4441 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#include "test.h"
+#include "../pro_net/pro_net.h"
+#include "../pro_rtp/rtp_base.h"
+#include "../pro_rtp/rtp_msg.h"
+#include "../pro_rtp/rtp_packet.h"
+#include "../pro_util/pro_bsd_wrapper.h"
+#include "../pro_util/pro_functor_command.h"
+#include "../pro_util/pro_functor_command_task.h"
+#include "../pro_util/pro_functor_command_task_pool.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_ssl_util.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread.h"
+#include "../pro_util/pro_thread_mutex.h"
+#include "../pro_util/pro_time_util.h"
+#include "../pro_util/pro_z.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/chacha20.h"
+#include "mbedtls/cipher.h"
+#include "mbedtls/poly1305.h"
+
+#include <cassert>
+
+#if defined(_WIN32) || defined(_WIN32_WCE)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define LOOPBACK_IP          "127.0.0.1"
+#define HISTOGRAM_BUCKETS    12701
+#define CONNECT_TIMEOUT      20
+#define READY_TIMEOUT_MS     20000
+#define DRAIN_TIMEOUT_MS     1000
+#define RTP_MEDIA_MM_TYPE    RTP_MMT_VIDEO
+#define RTP_PAYLOAD_TYPE     109
+#define RTP_REDLINE_BYTES    (1024 * 1024 * 8)
+#define MSG_REDLINE_BYTES    (1024 * 1024 * 8)
+#define MSG_LOGIN_WINDOW     8
+#define RESUME_MM_TYPE       RTP_MMT_CTRL /* not the frame buckets of the video */
+#define RESUME_TIMEOUT       2
+#define RESUME_BATCH         100
+#define RESUME_PACKET_SIZE   64
+#define SETTLE_MS            200
+#define PROBE_TIMEOUT        (-1)
+#define PROBE_REFUSED        0
+#define PROBE_OK             1
+#define PROBE_PENDING        2
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+PRO_INT64
+BenchGetTickUs()
+{
+#if defined(_WIN32) || defined(_WIN32_WCE)
+    static LARGE_INTEGER s_freq = { 0 };
+    if (s_freq.QuadPart == 0)
+    {
+        ::QueryPerformanceFrequency(&s_freq);
+    }
+
+    LARGE_INTEGER counter;
+    ::QueryPerformanceCounter(&counter);
+
+    return ((PRO_INT64)(counter.QuadPart * 1000000.0 / s_freq.QuadPart));
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((PRO_INT64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+#endif
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchHistogram::CBenchHistogram()
+{
+    Reset();
+}
+
+void
+CBenchHistogram::Reset()
+{
+    m_buckets.clear();
+    m_buckets.resize(HISTOGRAM_BUCKETS, 0);
+    m_count = 0;
+    m_sum   = 0;
+    m_max   = 0;
+}
+
+unsigned long
+CBenchHistogram::Us2Index(PRO_INT64 us)
+{
+    if (us < 0)
+    {
+        return (0);
+    }
+    if (us < 1000)
+    {
+        return ((unsigned long)us);
+    }
+    if (us < 10000)
+    {
+        return ((unsigned long)(1000 + (us - 1000) / 10));
+    }
+    if (us < 100000)
+    {
+        return ((unsigned long)(1900 + (us - 10000) / 100));
+    }
+    if (us < 10000000)
+    {
+        return ((unsigned long)(2800 + (us - 100000) / 1000));
+    }
+
+    return (HISTOGRAM_BUCKETS - 1);
+}
+
+PRO_INT64
+CBenchHistogram::Index2Us(unsigned long index)
+{
+    if (index < 1000)
+    {
+        return (index);
+    }
+    if (index < 1900)
+    {
+        return (1000 + (PRO_INT64)(index - 1000) * 10);
+    }
+    if (index < 2800)
+    {
+        return (10000 + (PRO_INT64)(index - 1900) * 100);
+    }
+
+    return (100000 + (PRO_INT64)(index - 2800) * 1000);
+}
+
+void
+CBenchHistogram::Add(PRO_INT64 us)
+{
+    if (us < 0)
+    {
+        us = 0;
+    }
+
+    ++m_buckets[Us2Index(us)];
+    ++m_count;
+    m_sum += (double)us;
+    if (us > m_max)
+    {
+        m_max = us;
+    }
+}
+
+void
+CBenchHistogram::Merge(const CBenchHistogram& other)
+{
+    int       i = 0;
+    const int c = (int)m_buckets.size();
+
+    for (; i < c; ++i)
+    {
+        m_buckets[i] += other.m_buckets[i];
+    }
+
+    m_count += other.m_count;
+    m_sum   += other.m_sum;
+    if (other.m_max > m_max)
+    {
+        m_max = other.m_max;
+    }
+}
+
+double
+CBenchHistogram::GetMean() const
+{
+    if (m_count == 0)
+    {
+        return (0);
+    }
+
+    return (m_sum / m_count);
+}
+
+PRO_INT64
+CBenchHistogram::GetPercentile(double percent) const
+{
+    if (m_count == 0)
+    {
+        return (0);
+    }
+
+    PRO_UINT64 target = (PRO_UINT64)(m_count * percent / 100 + 0.5);
+    if (target == 0)
+    {
+        target = 1;
+    }
+
+    PRO_UINT64 sum = 0;
+    int        i   = 0;
+    const int  c   = (int)m_buckets.size();
+
+    for (; i < c; ++i)
+    {
+        sum += m_buckets[i];
+        if (sum >= target)
+        {
+            break;
+        }
+    }
+
+    const PRO_INT64 us = Index2Us(i);
+
+    return (us < m_max ? us : m_max);
+}
+
+void
+CBenchHistogram::ToMetrics(const char*                  scenario,
+                           const char*                  prefix,
+                           CProStlVector<BENCH_METRIC>& metrics) const
+{
+    static const char* const s_names[]    = { "p50", "p90", "p99", "p999" };
+    static const double      s_percents[] = { 50, 90, 99, 99.9 };
+
+    BENCH_METRIC metric;
+    metric.scenario     = scenario;
+    metric.unit         = "us";
+    metric.higherBetter = false;
+
+    for (int i = 0; i < (int)(sizeof(s_percents) / sizeof(double)); ++i)
+    {
+        metric.metric  = prefix;
+        metric.metric += "_";
+        metric.metric += s_names[i];
+        metric.value   = (double)GetPercentile(s_percents[i]);
+        metrics.push_back(metric);
+    }
+
+    metric.metric  = prefix;
+    metric.metric += "_max";
+    metric.value   = (double)m_max;
+    metrics.push_back(metric);
+
+    metric.metric  = prefix;
+    metric.metric += "_mean";
+    metric.value   = GetMean();
+    metrics.push_back(metric);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+void
+AddMetric_i(CProStlVector<BENCH_METRIC>& metrics,
+            const char*                  scenario,
+            const char*                  name,
+            double                       value,
+            const char*                  unit,
+            bool                         higherBetter)
+{
+    BENCH_METRIC metric;
+    metric.scenario     = scenario;
+    metric.metric       = name;
+    metric.value        = value;
+    metric.unit         = unit;
+    metric.higherBetter = higherBetter;
+
+    metrics.push_back(metric);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchConnRate*
+CBenchConnRate::CreateInstance(bool bulk)
+{
+    CBenchConnRate* const bench = new CBenchConnRate(bulk);
+
+    return (bench);
+}
+
+CBenchConnRate::CBenchConnRate(bool bulk)
+: m_bulk(bulk)
+{
+    m_reactor       = NULL;
+    m_bulkConnector = NULL;
+    m_bulkStartUs   = 0;
+    m_port          = 0;
+    m_total         = 0;
+    m_maxPending    = 0;
+    m_issued        = 0;
+    m_okCount       = 0;
+    m_errorCount    = 0;
+}
+
+CBenchConnRate::~CBenchConnRate()
+{
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchConnRate::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchConnRate::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchConnRate::Run(IProReactor*                 reactor,
+                    const BENCH_CONFIG_INFO&     configInfo,
+                    CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    IProAcceptor* const acceptor =
+        ProCreateAcceptor(this, reactor, LOOPBACK_IP, 0);
+    if (acceptor == NULL)
+    {
+        return (false);
+    }
+
+    IProBulkConnector* bulkConnector = NULL;
+    if (m_bulk)
+    {
+        bulkConnector = ProCreateBulkConnector(false, 0, 0, this, reactor,
+            configInfo.bench_conn_count, CONNECT_TIMEOUT);
+        if (bulkConnector == NULL)
+        {
+            ProDeleteAcceptor(acceptor);
+
+            return (false);
+        }
+    }
+
+    PRO_INT64 startUs = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_reactor       = reactor;
+        m_bulkConnector = bulkConnector;
+        m_port          = ProGetAcceptorPort(acceptor);
+        m_total         = configInfo.bench_conn_count;
+        m_maxPending    = configInfo.bench_conn_pending_count;
+
+        startUs = BenchGetTickUs();
+        if (m_bulk)
+        {
+            m_bulkStartUs = startUs;
+        }
+        else
+        {
+            IssueConnectors();
+        }
+    }
+
+    if (m_bulk)
+    {
+        PRO_CONNECT_TARGET target;
+        target.remoteIp    = LOOPBACK_IP;
+        target.remotePort  = m_port;
+        target.localBindIp = NULL;
+
+        CProStlVector<PRO_CONNECT_TARGET> targets;
+        targets.resize(m_total, target);
+        ProBulkConnect(bulkConnector, &targets[0], m_total);
+    }
+
+    const PRO_INT64 deadlineUs =
+        startUs + (PRO_INT64)(configInfo.bench_duration + CONNECT_TIMEOUT) * 1000000;
+    PRO_INT64       stopUs     = startUs;
+
+    while (1)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        stopUs = BenchGetTickUs();
+        if (m_okCount + m_errorCount >= m_total || stopUs >= deadlineUs)
+        {
+            break;
+        }
+    }
+
+    CProStlVector<IProConnector*> connectors;
+    CProStlVector<PRO_INT64>      acceptedSockIds;
+    unsigned long                 okCount    = 0;
+    unsigned long                 errorCount = 0;
+    CBenchHistogram               histogram;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlMap<IProConnector*, PRO_INT64>::const_iterator       itr =
+            m_connector2StartUs.begin();
+        CProStlMap<IProConnector*, PRO_INT64>::const_iterator const end =
+            m_connector2StartUs.end();
+
+        for (; itr != end; ++itr)
+        {
+            connectors.push_back(itr->first);
+        }
+
+        okCount    = m_okCount;
+        errorCount = m_errorCount + (unsigned long)connectors.size();
+        histogram  = m_histogram;
+        if (m_bulk)
+        {
+            errorCount = m_total - m_okCount; /* the unfinished too */
+        }
+
+        acceptedSockIds = m_acceptedSockIds;
+        m_connector2StartUs.clear();
+        m_acceptedSockIds.clear();
+        m_reactor = NULL;
+        m_bulkConnector = NULL;
+    }
+
+    ProDeleteBulkConnector(bulkConnector);
+
+    int i = 0;
+    int c = (int)connectors.size();
+
+    for (; i < c; ++i)
+    {
+        ProDeleteConnector(connectors[i]);
+    }
+
+    ProDeleteAcceptor(acceptor);
+
+    c = (int)acceptedSockIds.size();
+
+    for (i = 0; i < c; ++i)
+    {
+        ProCloseSockId(acceptedSockIds[i]);
+    }
+
+    const double      seconds  = (stopUs - startUs) / 1000000.0;
+    const char* const scenario = m_bulk ? "bulk_conn_rate" : "conn_rate";
+
+    AddMetric_i(metrics, scenario, "conns_per_sec",
+        seconds > 0 ? okCount / seconds : 0, "conn/s", true);
+    AddMetric_i(metrics, scenario, "errors",
+        errorCount, "conn", false);
+    histogram.ToMetrics(scenario, "connect", metrics);
+
+    return (true);
+}
+
+void
+CBenchConnRate::IssueConnectors()
+{
+    while (m_issued < m_total && m_connector2StartUs.size() < m_maxPending)
+    {
+        ++m_issued;
+
+        const PRO_INT64      startUs   = BenchGetTickUs();
+        IProConnector* const connector = ProCreateConnector(
+            false, this, m_reactor, LOOPBACK_IP, m_port, NULL, CONNECT_TIMEOUT);
+        if (connector == NULL)
+        {
+            ++m_errorCount;
+            continue;
+        }
+
+        m_connector2StartUs[connector] = startUs;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchConnRate::OnAccept(IProAcceptor*    acceptor,
+                         PRO_INT64        sockId,
+                         bool             unixSocket,
+                         const char*      remoteIp,
+                         unsigned short   remotePort,
+                         unsigned char    serviceId,
+                         unsigned char    serviceOpt,
+                         const PRO_NONCE* nonce)
+{
+    /*
+     * the connector treats a readable socket as a failure, so the server
+     * side is kept open until the run ends
+     */
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor != NULL)
+        {
+            m_acceptedSockIds.push_back(sockId);
+
+            return;
+        }
+    }
+
+    ProCloseSockId(sockId);
+}
+
+void
+PRO_CALLTYPE
+CBenchConnRate::OnConnectOk(IProConnector*   connector,
+                            PRO_INT64        sockId,
+                            bool             unixSocket,
+                            const char*      remoteIp,
+                            unsigned short   remotePort,
+                            unsigned char    serviceId,
+                            unsigned char    serviceOpt,
+                            const PRO_NONCE* nonce)
+{
+    ProCloseSockId(sockId);
+
+    OnConnectDone(connector, true);
+}
+
+void
+PRO_CALLTYPE
+CBenchConnRate::OnConnectError(IProConnector* connector,
+                               const char*    remoteIp,
+                               unsigned short remotePort,
+                               unsigned char  serviceId,
+                               unsigned char  serviceOpt,
+                               bool           timeout)
+{
+    OnConnectDone(connector, false);
+}
+
+void
+CBenchConnRate::OnConnectDone(IProConnector* connector,
+                              bool           ok)
+{
+    assert(connector != NULL);
+    if (connector == NULL)
+    {
+        return;
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL)
+        {
+            return;
+        }
+
+        if (m_bulk)
+        {
+            /*
+             * the latency includes the wait in the lane of the connector
+             */
+            if ((IProBulkConnector*)connector != m_bulkConnector)
+            {
+                return;
+            }
+
+            if (ok)
+            {
+                m_histogram.Add(BenchGetTickUs() - m_bulkStartUs);
+                ++m_okCount;
+            }
+            else
+            {
+                ++m_errorCount;
+            }
+
+            return;
+        }
+
+        CProStlMap<IProConnector*, PRO_INT64>::iterator const itr =
+            m_connector2StartUs.find(connector);
+        if (itr == m_connector2StartUs.end())
+        {
+            return;
+        }
+
+        if (ok)
+        {
+            m_histogram.Add(BenchGetTickUs() - itr->second);
+            ++m_okCount;
+        }
+        else
+        {
+            ++m_errorCount;
+        }
+
+        m_connector2StartUs.erase(itr);
+        IssueConnectors();
+    }
+
+    ProDeleteConnector(connector);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchEchoConn*
+CBenchEchoConn::CreateInstance(bool          client,
+                               unsigned long msgSize,
+                               unsigned long window)
+{
+    assert(msgSize >= sizeof(PRO_INT64));
+    assert(window > 0);
+    if (msgSize < sizeof(PRO_INT64) || window == 0)
+    {
+        return (NULL);
+    }
+
+    CBenchEchoConn* const conn = new CBenchEchoConn(client, msgSize, window);
+
+    return (conn);
+}
+
+CBenchEchoConn::CBenchEchoConn(bool          client,
+                               unsigned long msgSize,
+                               unsigned long window)
+                               :
+m_client(client),
+m_msgSize(msgSize),
+m_window(window)
+{
+    m_trans     = NULL;
+    m_running   = false;
+    m_broken    = false;
+    m_echoCount = 0;
+    m_buf       = (char*)ProMalloc(msgSize);
+}
+
+CBenchEchoConn::~CBenchEchoConn()
+{
+    Fini();
+
+    ProFree(m_buf);
+    m_buf = NULL;
+}
+
+bool
+CBenchEchoConn::Init(IProReactor* reactor,
+                     PRO_INT64    sockId,
+                     bool         unixSocket)
+{
+    assert(reactor != NULL);
+    assert(sockId != -1);
+    if (reactor == NULL || sockId == -1 || m_buf == NULL)
+    {
+        return (false);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_trans == NULL);
+        if (m_trans != NULL)
+        {
+            return (false);
+        }
+
+        m_trans = ProCreateTcpTransport(this, reactor, sockId, unixSocket);
+        if (m_trans == NULL)
+        {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+void
+CBenchEchoConn::Fini()
+{
+    IProTransport* trans = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_trans == NULL)
+        {
+            return;
+        }
+
+        m_running = false;
+        trans = m_trans;
+        m_trans = NULL;
+    }
+
+    ProDeleteTransport(trans);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchEchoConn::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchEchoConn::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+void
+CBenchEchoConn::Start()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (!m_client || m_trans == NULL || m_running)
+    {
+        return;
+    }
+
+    m_running = true;
+
+    for (int i = 0; i < (int)m_window; ++i)
+    {
+        AppendMsg();
+    }
+
+    FlushPending();
+}
+
+void
+CBenchEchoConn::Stop()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    m_running = false;
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoConn::OnRecv(IProTransport*          trans,
+                       const pbsd_sockaddr_in* remoteAddr)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    IProRecvPool& recvPool = *trans->GetRecvPool();
+    unsigned long dataSize = recvPool.PeekDataSize();
+
+    if (m_client)
+    {
+        const PRO_INT64 nowUs = BenchGetTickUs();
+
+        for (; dataSize >= m_msgSize; dataSize -= m_msgSize)
+        {
+            recvPool.PeekData(m_buf, m_msgSize);
+            recvPool.Flush(m_msgSize);
+
+            PRO_INT64 sendUs = 0;
+            memcpy(&sendUs, m_buf, sizeof(PRO_INT64));
+
+            m_histogram.Add(nowUs - sendUs);
+            ++m_echoCount;
+
+            if (m_running)
+            {
+                AppendMsg();
+            }
+        }
+    }
+    else
+    {
+        while (dataSize > 0)
+        {
+            const unsigned long size =
+                dataSize < m_msgSize ? dataSize : m_msgSize;
+
+            recvPool.PeekData(m_buf, size);
+            recvPool.Flush(size);
+            m_pending.append(m_buf, size);
+
+            dataSize -= size;
+        }
+    }
+
+    FlushPending();
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoConn::OnSend(IProTransport* trans,
+                       PRO_UINT64     actionId)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    FlushPending();
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoConn::OnClose(IProTransport* trans,
+                        long           errorCode,
+                        long           sslCode)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    m_running = false;
+    m_broken  = true;
+}
+
+void
+CBenchEchoConn::AppendMsg()
+{
+    const PRO_INT64 nowUs = BenchGetTickUs();
+
+    m_pending.append((const char*)&nowUs, sizeof(PRO_INT64));
+    m_pending.append(m_msgSize - sizeof(PRO_INT64), '\0');
+}
+
+void
+CBenchEchoConn::FlushPending()
+{
+    if (m_trans == NULL || m_pending.empty())
+    {
+        return;
+    }
+
+    if (m_trans->SendData(m_pending.data(), m_pending.size()))
+    {
+        m_pending.clear();
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchEchoTput*
+CBenchEchoTput::CreateInstance()
+{
+    CBenchEchoTput* const bench = new CBenchEchoTput;
+
+    return (bench);
+}
+
+CBenchEchoTput::CBenchEchoTput()
+{
+    m_reactor    = NULL;
+    m_msgSize    = 0;
+    m_window     = 0;
+    m_errorCount = 0;
+}
+
+CBenchEchoTput::~CBenchEchoTput()
+{
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchEchoTput::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchEchoTput::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchEchoTput::Run(IProReactor*                 reactor,
+                    const BENCH_CONFIG_INFO&     configInfo,
+                    CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    IProAcceptor* const acceptor =
+        ProCreateAcceptor(this, reactor, LOOPBACK_IP, 0);
+    if (acceptor == NULL)
+    {
+        return (false);
+    }
+
+    const unsigned long connCount = configInfo.bench_echo_conn_count;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_reactor = reactor;
+        m_msgSize = configInfo.bench_echo_msg_size;
+        m_window  = configInfo.bench_echo_window;
+
+        const unsigned short port = ProGetAcceptorPort(acceptor);
+
+        for (int i = 0; i < (int)connCount; ++i)
+        {
+            IProConnector* const connector = ProCreateConnector(
+                false, this, reactor, LOOPBACK_IP, port, NULL, CONNECT_TIMEOUT);
+            if (connector == NULL)
+            {
+                ++m_errorCount;
+                continue;
+            }
+
+            m_connectors.insert(connector);
+        }
+    }
+
+    /*
+     * wait for both sides of every connection
+     */
+    CProStlVector<CBenchEchoConn*> conns;
+
+    for (int j = 0; j < READY_TIMEOUT_MS / 10; ++j)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_conns.size() + m_errorCount * 2 >= connCount * 2)
+        {
+            break;
+        }
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        conns = m_conns;
+    }
+
+    int       i = 0;
+    const int c = (int)conns.size();
+
+    for (i = 0; i < c; ++i)
+    {
+        conns[i]->Start();
+    }
+
+    const PRO_INT64 startUs = BenchGetTickUs();
+    ProSleep(configInfo.bench_duration * 1000);
+
+    for (i = 0; i < c; ++i)
+    {
+        conns[i]->Stop();
+    }
+
+    const PRO_INT64 stopUs = BenchGetTickUs();
+
+    PRO_UINT64 echoCount = 0;
+
+    for (i = 0; i < c; ++i)
+    {
+        echoCount += conns[i]->GetEchoCount();
+    }
+
+    ProSleep(DRAIN_TIMEOUT_MS / 10);
+
+    CProStlSet<IProConnector*> connectors;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        conns      = m_conns;
+        connectors = m_connectors;
+        m_conns.clear();
+        m_connectors.clear();
+        m_reactor = NULL;
+    }
+
+    CProStlSet<IProConnector*>::const_iterator       itr = connectors.begin();
+    CProStlSet<IProConnector*>::const_iterator const end = connectors.end();
+
+    for (; itr != end; ++itr)
+    {
+        ProDeleteConnector(*itr);
+    }
+
+    ProDeleteAcceptor(acceptor);
+
+    CBenchHistogram histogram;
+    unsigned long   brokenCount = 0;
+    unsigned long   clientCount = 0;
+
+    /*
+     * collect the results before closing anything, or the peers would see
+     * the remote close and report themselves broken
+     */
+    for (i = 0; i < (int)conns.size(); ++i)
+    {
+        if (conns[i]->IsClient())
+        {
+            histogram.Merge(conns[i]->GetHistogram());
+            ++clientCount;
+        }
+        if (conns[i]->IsBroken())
+        {
+            ++brokenCount;
+        }
+    }
+
+    for (i = 0; i < (int)conns.size(); ++i)
+    {
+        conns[i]->Fini();
+        conns[i]->Release();
+    }
+
+    const double seconds = (stopUs - startUs) / 1000000.0;
+
+    AddMetric_i(metrics, "echo_tput", "msgs_per_sec",
+        seconds > 0 ? echoCount / seconds : 0, "msg/s", true);
+    AddMetric_i(metrics, "echo_tput", "mbps",
+        seconds > 0 ? echoCount * m_msgSize * 8 / seconds / 1000000 : 0,
+        "Mbit/s", true);
+    AddMetric_i(metrics, "echo_tput", "errors",
+        m_errorCount + (connCount - clientCount) + brokenCount, "conn", false);
+    histogram.ToMetrics("echo_tput", "rtt", metrics);
+
+    return (true);
+}
+
+void
+CBenchEchoTput::AddConn(bool      client,
+                        PRO_INT64 sockId,
+                        bool      unixSocket)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_reactor == NULL)
+    {
+        ProCloseSockId(sockId);
+
+        return;
+    }
+
+    CBenchEchoConn* const conn =
+        CBenchEchoConn::CreateInstance(client, m_msgSize, m_window);
+    if (conn == NULL)
+    {
+        ProCloseSockId(sockId);
+        ++m_errorCount;
+
+        return;
+    }
+
+    if (!conn->Init(m_reactor, sockId, unixSocket))
+    {
+        conn->Release();
+        ProCloseSockId(sockId);
+        ++m_errorCount;
+
+        return;
+    }
+
+    m_conns.push_back(conn);
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoTput::OnAccept(IProAcceptor*    acceptor,
+                         PRO_INT64        sockId,
+                         bool             unixSocket,
+                         const char*      remoteIp,
+                         unsigned short   remotePort,
+                         unsigned char    serviceId,
+                         unsigned char    serviceOpt,
+                         const PRO_NONCE* nonce)
+{
+    AddConn(false, sockId, unixSocket);
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoTput::OnConnectOk(IProConnector*   connector,
+                            PRO_INT64        sockId,
+                            bool             unixSocket,
+                            const char*      remoteIp,
+                            unsigned short   remotePort,
+                            unsigned char    serviceId,
+                            unsigned char    serviceOpt,
+                            const PRO_NONCE* nonce)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_connectors.find(connector) == m_connectors.end())
+        {
+            ProCloseSockId(sockId);
+
+            return;
+        }
+
+        m_connectors.erase(connector);
+    }
+
+    ProDeleteConnector(connector);
+
+    AddConn(true, sockId, unixSocket);
+}
+
+void
+PRO_CALLTYPE
+CBenchEchoTput::OnConnectError(IProConnector* connector,
+                               const char*    remoteIp,
+                               unsigned short remotePort,
+                               unsigned char  serviceId,
+                               unsigned char  serviceOpt,
+                               bool           timeout)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_connectors.find(connector) == m_connectors.end())
+        {
+            return;
+        }
+
+        m_connectors.erase(connector);
+        ++m_errorCount;
+    }
+
+    ProDeleteConnector(connector);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchRtpPps*
+CBenchRtpPps::CreateInstance(bool dtls)
+{
+    CBenchRtpPps* const bench = new CBenchRtpPps(dtls);
+
+    return (bench);
+}
+
+CBenchRtpPps::CBenchRtpPps(bool dtls)
+: m_dtls(dtls)
+{
+    m_reactor    = NULL;
+    m_sender     = NULL;
+    m_recver     = NULL;
+    m_timerId    = 0;
+    m_packetRate = 0;
+    m_packetSize = 0;
+    m_startUs    = 0;
+    m_sentCount  = 0;
+    m_busyCount  = 0;
+    m_recvCount  = 0;
+    m_sequence   = 0;
+    m_running    = false;
+    m_broken     = false;
+}
+
+CBenchRtpPps::~CBenchRtpPps()
+{
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchRtpPps::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchRtpPps::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchRtpPps::Run(IProReactor*                 reactor,
+                  const BENCH_CONFIG_INFO&     configInfo,
+                  CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    const char* const scenario = m_dtls ? "dtls_pps" : "rtp_pps";
+
+    PRO_SSL_SERVER_CONFIG* serverConfig = NULL;
+    PRO_SSL_CLIENT_CONFIG* clientConfig = NULL;
+
+    if (m_dtls)
+    {
+        const char* caFiles[]   = { configInfo.bench_ssl_cafile.c_str() };
+        const char* certFiles[] = { configInfo.bench_ssl_certfile.c_str() };
+
+        serverConfig = ProSslServerConfig_Create();
+        clientConfig = ProSslClientConfig_Create();
+        if (serverConfig == NULL || clientConfig == NULL)
+        {
+            ProSslServerConfig_Delete(serverConfig);
+            ProSslClientConfig_Delete(clientConfig);
+
+            return (false);
+        }
+
+        ProSslServerConfig_EnableSha1Cert(serverConfig, true);
+        ProSslClientConfig_EnableSha1Cert(clientConfig, true);
+
+        if (!ProSslServerConfig_SetCaList(serverConfig, caFiles, 1, NULL, 0) ||
+            !ProSslServerConfig_AppendCertChain(serverConfig, certFiles, 1,
+            configInfo.bench_ssl_keyfile.c_str(), NULL)                      ||
+            !ProSslClientConfig_SetCaList(clientConfig, caFiles, 1, NULL, 0))
+        {
+            ProSslServerConfig_Delete(serverConfig);
+            ProSslClientConfig_Delete(clientConfig);
+
+            return (false);
+        }
+    }
+
+    RTP_SESSION_INFO localInfo;
+    memset(&localInfo, 0, sizeof(RTP_SESSION_INFO));
+    localInfo.mmType = RTP_MEDIA_MM_TYPE;
+
+    RTP_INIT_ARGS initArgs;
+    memset(&initArgs, 0, sizeof(RTP_INIT_ARGS));
+
+    IRtpSession* recver = NULL;
+    if (m_dtls)
+    {
+        initArgs.dtlsserverEx.observer  = this;
+        initArgs.dtlsserverEx.reactor   = reactor;
+        initArgs.dtlsserverEx.sslConfig = serverConfig;
+        strncpy_pro(initArgs.dtlsserverEx.localIp,
+            sizeof(initArgs.dtlsserverEx.localIp), LOOPBACK_IP);
+
+        recver = CreateRtpSessionWrapper(
+            RTP_ST_DTLSSERVER_EX, &initArgs, &localInfo);
+    }
+    else
+    {
+        initArgs.udpserver.observer = this;
+        initArgs.udpserver.reactor  = reactor;
+        strncpy_pro(initArgs.udpserver.localIp,
+            sizeof(initArgs.udpserver.localIp), LOOPBACK_IP);
+
+        recver = CreateRtpSessionWrapper(
+            RTP_ST_UDPSERVER, &initArgs, &localInfo);
+    }
+    if (recver == NULL)
+    {
+        ProSslServerConfig_Delete(serverConfig);
+        ProSslClientConfig_Delete(clientConfig);
+
+        return (false);
+    }
+
+    memset(&initArgs, 0, sizeof(RTP_INIT_ARGS));
+
+    IRtpSession* sender = NULL;
+    if (m_dtls)
+    {
+        initArgs.dtlsclientEx.observer   = this;
+        initArgs.dtlsclientEx.reactor    = reactor;
+        initArgs.dtlsclientEx.sslConfig  = clientConfig;
+        initArgs.dtlsclientEx.remotePort = recver->GetLocalPort();
+        strncpy_pro(initArgs.dtlsclientEx.sslSni,
+            sizeof(initArgs.dtlsclientEx.sslSni),
+            configInfo.bench_ssl_sni.c_str());
+        strncpy_pro(initArgs.dtlsclientEx.remoteIp,
+            sizeof(initArgs.dtlsclientEx.remoteIp), LOOPBACK_IP);
+        strncpy_pro(initArgs.dtlsclientEx.localIp,
+            sizeof(initArgs.dtlsclientEx.localIp), LOOPBACK_IP);
+
+        sender = CreateRtpSessionWrapper(
+            RTP_ST_DTLSCLIENT_EX, &initArgs, &localInfo);
+    }
+    else
+    {
+        initArgs.udpclient.observer = this;
+        initArgs.udpclient.reactor  = reactor;
+        strncpy_pro(initArgs.udpclient.localIp,
+            sizeof(initArgs.udpclient.localIp), LOOPBACK_IP);
+
+        sender = CreateRtpSessionWrapper(
+            RTP_ST_UDPCLIENT, &initArgs, &localInfo);
+    }
+    if (sender == NULL)
+    {
+        DeleteRtpSessionWrapper(recver);
+        ProSslServerConfig_Delete(serverConfig);
+        ProSslClientConfig_Delete(clientConfig);
+
+        return (false);
+    }
+
+    if (!m_dtls)
+    {
+        sender->SetRemoteIpAndPort(LOOPBACK_IP, recver->GetLocalPort());
+    }
+    sender->SetOutputRedline(RTP_REDLINE_BYTES, 0, 0);
+
+    for (int i = 0; i < READY_TIMEOUT_MS / 10; ++i)
+    {
+        if (sender->IsReady())
+        {
+            break;
+        }
+
+        ProSleep(10);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_reactor    = reactor;
+        m_sender     = sender;
+        m_recver     = recver;
+        m_packetRate = configInfo.bench_rtp_packet_rate;
+        m_packetSize = configInfo.bench_rtp_packet_size;
+        m_startUs    = BenchGetTickUs();
+        m_running    = true;
+        m_timerId    = reactor->ScheduleMmTimer(this, 1, true);
+    }
+
+    ProSleep(configInfo.bench_duration * 1000);
+
+    PRO_INT64 stopUs = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_running = false;
+        stopUs    = BenchGetTickUs();
+        reactor->CancelMmTimer(m_timerId);
+        m_timerId = 0;
+    }
+
+    for (int j = 0; j < DRAIN_TIMEOUT_MS / 10; ++j)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_recvCount >= m_sentCount)
+        {
+            break;
+        }
+    }
+
+    PRO_UINT64      sentCount = 0;
+    PRO_UINT64      busyCount = 0;
+    PRO_UINT64      recvCount = 0;
+    bool            broken    = false;
+    CBenchHistogram histogram;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        sentCount = m_sentCount;
+        busyCount = m_busyCount;
+        recvCount = m_recvCount;
+        broken    = m_broken;
+        histogram = m_histogram;
+        m_reactor = NULL;
+        m_sender  = NULL;
+        m_recver  = NULL;
+    }
+
+    DeleteRtpSessionWrapper(sender);
+    DeleteRtpSessionWrapper(recver);
+    ProSslServerConfig_Delete(serverConfig);
+    ProSslClientConfig_Delete(clientConfig);
+
+    const double seconds = (stopUs - m_startUs) / 1000000.0;
+
+    AddMetric_i(metrics, scenario, "sent_pps",
+        seconds > 0 ? sentCount / seconds : 0, "pkt/s", true);
+    AddMetric_i(metrics, scenario, "recv_pps",
+        seconds > 0 ? recvCount / seconds : 0, "pkt/s", true);
+    AddMetric_i(metrics, scenario, "loss_percent",
+        sentCount > 0 && sentCount > recvCount
+        ? (sentCount - recvCount) * 100.0 / sentCount : 0, "%", false);
+    AddMetric_i(metrics, scenario, "errors",
+        (double)busyCount + (broken ? 1 : 0), "pkt", false);
+    histogram.ToMetrics(scenario, "delay", metrics);
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CBenchRtpPps::OnRecvSession(IRtpSession* session,
+                            IRtpPacket*  packet)
+{
+    assert(session != NULL);
+    assert(packet != NULL);
+    if (session == NULL || packet == NULL ||
+        packet->GetPayloadSize() < sizeof(PRO_INT64))
+    {
+        return;
+    }
+
+    PRO_INT64 sendUs = 0;
+    memcpy(&sendUs, packet->GetPayloadBuffer(), sizeof(PRO_INT64));
+
+    const PRO_INT64 nowUs = BenchGetTickUs();
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (session != m_recver)
+        {
+            return;
+        }
+
+        m_histogram.Add(nowUs - sendUs);
+        ++m_recvCount;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchRtpPps::OnCloseSession(IRtpSession* session,
+                             long         errorCode,
+                             long         sslCode,
+                             bool         tcpConnected)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (session == m_sender || session == m_recver)
+    {
+        m_broken = true;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchRtpPps::OnTimer(void*      factory,
+                      PRO_UINT64 timerId,
+                      PRO_INT64  userData)
+{
+    IRtpSession* sender = NULL;
+    PRO_UINT64   count  = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (!m_running || timerId != m_timerId)
+        {
+            return;
+        }
+
+        const PRO_UINT64 due = (PRO_UINT64)(
+            (BenchGetTickUs() - m_startUs) / 1000000.0 * m_packetRate);
+        const PRO_UINT64 done = m_sentCount + m_busyCount;
+        if (due <= done)
+        {
+            return;
+        }
+
+        /*
+         * no more than 20ms of packets at once after a stall
+         */
+        count = due - done;
+        if (count > m_packetRate / 50 + 1)
+        {
+            m_busyCount += count - (m_packetRate / 50 + 1);
+            count        = m_packetRate / 50 + 1;
+        }
+
+        sender = m_sender;
+        sender->AddRef();
+    }
+
+    PRO_UINT64 sentCount = 0;
+    PRO_UINT64 busyCount = 0;
+
+    for (PRO_UINT64 i = 0; i < count; ++i)
+    {
+        IRtpPacket* const packet = CreateRtpPacketSpace(m_packetSize);
+        if (packet == NULL)
+        {
+            ++busyCount;
+            continue;
+        }
+
+        const PRO_INT64 nowUs = BenchGetTickUs();
+
+        packet->SetMarker(true);
+        packet->SetPayloadType(RTP_PAYLOAD_TYPE);
+        packet->SetSequence(m_sequence++);
+        packet->SetTimeStamp((PRO_UINT32)(nowUs / 1000 * 90));
+        packet->SetMmType(RTP_MEDIA_MM_TYPE);
+        memcpy(packet->GetPayloadBuffer(), &nowUs, sizeof(PRO_INT64));
+
+        if (sender->SendPacket(packet))
+        {
+            ++sentCount;
+        }
+        else
+        {
+            ++busyCount;
+        }
+
+        packet->Release();
+    }
+
+    sender->Release();
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_sentCount += sentCount;
+        m_busyCount += busyCount;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchMsgFanout*
+CBenchMsgFanout::CreateInstance()
+{
+    CBenchMsgFanout* const bench = new CBenchMsgFanout;
+
+    return (bench);
+}
+
+CBenchMsgFanout::CBenchMsgFanout()
+{
+    m_reactor   = NULL;
+    m_hub       = NULL;
+    m_msgServer = NULL;
+    m_sender    = NULL;
+    m_timerId   = 0;
+    m_msgRate   = 0;
+    m_msgSize   = 0;
+    m_okCount   = 0;
+    m_startUs   = 0;
+    m_sentCount = 0;
+    m_busyCount = 0;
+    m_recvCount = 0;
+    m_running   = false;
+    m_broken    = false;
+    m_buf       = NULL;
+}
+
+CBenchMsgFanout::~CBenchMsgFanout()
+{
+    ProFree(m_buf);
+    m_buf = NULL;
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchMsgFanout::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchMsgFanout::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchMsgFanout::Run(IProReactor*                 reactor,
+                     const BENCH_CONFIG_INFO&     configInfo,
+                     CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    const unsigned short port        = configInfo.bench_msg_hub_port;
+    const unsigned long  recverCount = configInfo.bench_msg_recver_count;
+
+    m_buf = (char*)ProMalloc(configInfo.bench_msg_size);
+    if (m_buf == NULL)
+    {
+        return (false);
+    }
+    memset(m_buf, 0, configInfo.bench_msg_size);
+
+    IProServiceHub* const hub = ProCreateServiceHub(reactor, port);
+    if (hub == NULL)
+    {
+        return (false);
+    }
+
+    IRtpMsgServer* const msgServer = CreateRtpMsgServer(
+        this, reactor, RTP_MMT_MSG, NULL, false, port, 0);
+    if (msgServer == NULL)
+    {
+        ProDeleteServiceHub(hub);
+
+        return (false);
+    }
+    msgServer->SetOutputRedlineToUsr(MSG_REDLINE_BYTES);
+
+    CProStlVector<IRtpMsgClient*> clients;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_reactor   = reactor;
+        m_hub       = hub;
+        m_msgServer = msgServer;
+        m_msgRate   = configInfo.bench_msg_rate;
+        m_msgSize   = configInfo.bench_msg_size;
+    }
+
+    /*
+     * the msg server registers its service at the hub asynchronously, and
+     * the hub drops the connections arriving before that. So the sender
+     * logs in first, and it's retried until the registration is done
+     */
+    for (int j = 0; j < READY_TIMEOUT_MS / 10; ++j)
+    {
+        const RTP_MSG_USER user(2, 1, 1);
+
+        IRtpMsgClient* const client = CreateRtpMsgClient(
+            this, reactor, RTP_MMT_MSG, NULL, NULL,
+            LOOPBACK_IP, port, &user, "", NULL, 0);
+        if (client == NULL)
+        {
+            break;
+        }
+
+        bool ok = false;
+
+        for (int k = 0; k < READY_TIMEOUT_MS / 10; ++k)
+        {
+            ProSleep(10);
+
+            CProThreadMutexGuard mon(m_lock);
+
+            if (m_okCount > 0 || m_broken)
+            {
+                ok = m_okCount > 0;
+                break;
+            }
+        }
+
+        if (ok)
+        {
+            client->SetOutputRedline(MSG_REDLINE_BYTES);
+            clients.push_back(client);
+
+            CProThreadMutexGuard mon(m_lock);
+
+            m_sender = client;
+            break;
+        }
+
+        DeleteRtpMsgClient(client);
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_broken = false;
+        }
+
+        ProSleep(10);
+    }
+
+    /*
+     * the logins are kept within a window, so that the handshakes pending
+     * at the hub stay bounded
+     */
+    for (int i = 1; m_sender != NULL && i <= (int)recverCount; ++i)
+    {
+        for (int j = 0; j < READY_TIMEOUT_MS; ++j)
+        {
+            {
+                CProThreadMutexGuard mon(m_lock);
+
+                if (m_broken || clients.size() < m_okCount + MSG_LOGIN_WINDOW)
+                {
+                    break;
+                }
+            }
+
+            ProSleep(1);
+        }
+
+        const RTP_MSG_USER user(2, 1 + i, 1);
+
+        IRtpMsgClient* const client = CreateRtpMsgClient(
+            this, reactor, RTP_MMT_MSG, NULL, NULL,
+            LOOPBACK_IP, port, &user, "", NULL, 0);
+        if (client == NULL)
+        {
+            continue;
+        }
+
+        client->SetOutputRedline(MSG_REDLINE_BYTES);
+        clients.push_back(client);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        m_recvers.insert(client);
+        m_dstUsers.push_back(user);
+    }
+
+    bool ready = false;
+
+    for (int j = 0; j < READY_TIMEOUT_MS / 10; ++j)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_okCount >= clients.size())
+        {
+            ready = true;
+            break;
+        }
+    }
+
+    PRO_INT64 stopUs = 0;
+
+    if (ready && m_sender != NULL && !m_dstUsers.empty())
+    {
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_startUs = BenchGetTickUs();
+            m_running = true;
+            m_timerId = reactor->ScheduleMmTimer(this, 1, true);
+        }
+
+        ProSleep(configInfo.bench_duration * 1000);
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_running = false;
+            stopUs    = BenchGetTickUs();
+            reactor->CancelMmTimer(m_timerId);
+            m_timerId = 0;
+        }
+
+        for (int k = 0; k < DRAIN_TIMEOUT_MS / 10; ++k)
+        {
+            ProSleep(10);
+
+            CProThreadMutexGuard mon(m_lock);
+
+            if (m_recvCount >= m_sentCount * m_dstUsers.size())
+            {
+                break;
+            }
+        }
+    }
+
+    PRO_UINT64      sentCount = 0;
+    PRO_UINT64      busyCount = 0;
+    PRO_UINT64      recvCount = 0;
+    unsigned long   dstCount  = 0;
+    bool            broken    = false;
+    CBenchHistogram histogram;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        sentCount = m_sentCount;
+        busyCount = m_busyCount;
+        recvCount = m_recvCount;
+        dstCount  = (unsigned long)m_dstUsers.size();
+        broken    = m_broken || !ready;
+        histogram = m_histogram;
+
+        m_reactor   = NULL;
+        m_hub       = NULL;
+        m_msgServer = NULL;
+        m_sender    = NULL;
+        m_recvers.clear();
+    }
+
+    int       i = 0;
+    const int c = (int)clients.size();
+
+    for (; i < c; ++i)
+    {
+        DeleteRtpMsgClient(clients[i]);
+    }
+
+    DeleteRtpMsgServer(msgServer);
+    ProDeleteServiceHub(hub);
+
+    if (!ready)
+    {
+        return (false);
+    }
+
+    const double seconds = (stopUs - m_startUs) / 1000000.0;
+
+    AddMetric_i(metrics, "msg_fanout", "sent_msgs_per_sec",
+        seconds > 0 ? sentCount / seconds : 0, "msg/s", true);
+    AddMetric_i(metrics, "msg_fanout", "delivered_msgs_per_sec",
+        seconds > 0 ? recvCount / seconds : 0, "msg/s", true);
+    AddMetric_i(metrics, "msg_fanout", "loss_percent",
+        sentCount > 0 && sentCount * dstCount > recvCount
+        ? (sentCount * dstCount - recvCount) * 100.0 / (sentCount * dstCount)
+        : 0, "%", false);
+    AddMetric_i(metrics, "msg_fanout", "errors",
+        (double)busyCount + (broken ? 1 : 0), "msg", false);
+    histogram.ToMetrics("msg_fanout", "delay", metrics);
+
+    return (true);
+}
+
+bool
+PRO_CALLTYPE
+CBenchMsgFanout::OnCheckUser(IRtpMsgServer*      msgServer,
+                             const RTP_MSG_USER* user,
+                             const char*         userPublicIp,
+                             const RTP_MSG_USER* c2sUser, /* = NULL */
+                             const char          hash[32],
+                             const char          nonce[32],
+                             PRO_UINT64*         userId,
+                             PRO_UINT16*         instId,
+                             PRO_INT64*          appData,
+                             bool*               isC2s)
+{
+    assert(user != NULL);
+    assert(userId != NULL);
+    assert(instId != NULL);
+    assert(appData != NULL);
+    assert(isC2s != NULL);
+    if (user == NULL || userId == NULL || instId == NULL ||
+        appData == NULL || isC2s == NULL)
+    {
+        return (false);
+    }
+
+    /*
+     * every user is welcome here
+     */
+    *userId  = user->UserId();
+    *instId  = user->instId;
+    *appData = 0;
+    *isC2s   = false;
+
+    return (true);
+}
+
+void
+PRO_CALLTYPE
+CBenchMsgFanout::OnOkMsg(IRtpMsgClient*      msgClient,
+                         const RTP_MSG_USER* myUser,
+                         const char*         myPublicIp)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_reactor == NULL)
+    {
+        return;
+    }
+
+    ++m_okCount;
+}
+
+void
+PRO_CALLTYPE
+CBenchMsgFanout::OnRecvMsg(IRtpMsgClient*      msgClient,
+                           const void*         buf,
+                           unsigned long       size,
+                           PRO_UINT16          charset,
+                           const RTP_MSG_USER* srcUser)
+{
+    assert(buf != NULL);
+    if (buf == NULL || size < sizeof(PRO_INT64))
+    {
+        return;
+    }
+
+    PRO_INT64 sendUs = 0;
+    memcpy(&sendUs, buf, sizeof(PRO_INT64));
+
+    const PRO_INT64 nowUs = BenchGetTickUs();
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_recvers.find(msgClient) == m_recvers.end())
+        {
+            return;
+        }
+
+        m_histogram.Add(nowUs - sendUs);
+        ++m_recvCount;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchMsgFanout::OnCloseMsg(IRtpMsgClient* msgClient,
+                            long           errorCode,
+                            long           sslCode,
+                            bool           tcpConnected)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_reactor != NULL)
+    {
+        m_broken = true;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchMsgFanout::OnTimer(void*      factory,
+                         PRO_UINT64 timerId,
+                         PRO_INT64  userData)
+{
+    IRtpMsgClient* sender = NULL;
+    PRO_UINT64     count  = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (!m_running || timerId != m_timerId || m_sender == NULL)
+        {
+            return;
+        }
+
+        const PRO_UINT64 due = (PRO_UINT64)(
+            (BenchGetTickUs() - m_startUs) / 1000000.0 * m_msgRate);
+        const PRO_UINT64 done = m_sentCount + m_busyCount;
+        if (due <= done)
+        {
+            return;
+        }
+
+        /*
+         * no more than 20ms of messages at once after a stall
+         */
+        count = due - done;
+        if (count > m_msgRate / 50 + 1)
+        {
+            m_busyCount += count - (m_msgRate / 50 + 1);
+            count        = m_msgRate / 50 + 1;
+        }
+
+        sender = m_sender;
+        sender->AddRef();
+    }
+
+    PRO_UINT64 sentCount = 0;
+    PRO_UINT64 busyCount = 0;
+
+    for (PRO_UINT64 i = 0; i < count; ++i)
+    {
+        const PRO_INT64 nowUs = BenchGetTickUs();
+        memcpy(m_buf, &nowUs, sizeof(PRO_INT64));
+
+        if (sender->SendMsg(m_buf, m_msgSize, 0,
+            &m_dstUsers[0], (unsigned char)m_dstUsers.size()))
+        {
+            ++sentCount;
+        }
+        else
+        {
+            ++busyCount;
+        }
+    }
+
+    sender->Release();
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_sentCount += sentCount;
+        m_busyCount += busyCount;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * the same as the resume of pro_rtp. the prober has to build the handshake
+ * by hand
+ */
+static
+void
+CalcResumeId_i(const char token[16],
+               char       resumeId[16])
+{
+    char hashValue[32];
+    ProSha256All(token, 16, hashValue);
+    memcpy(resumeId, hashValue, 16);
+}
+
+static
+void
+CalcResumeMac_i(const char       token[16],
+                char             role,
+                const PRO_NONCE& nonce,
+                const char       userData[64],
+                char             mac[16])
+{
+    char buf[1 + 32 + 64 + 2];
+    buf[0] = role;
+    memcpy(buf + 1     , nonce.nonce, 32);
+    memcpy(buf + 1 + 32, userData   , 64);
+    buf[1 + 32 + 64]     = (char)RESUME_MM_TYPE;
+    buf[1 + 32 + 64 + 1] = (char)RTP_EPM_DEFAULT;
+
+    char hashValue[32];
+    ProHmacSha256All(token, 16, buf, sizeof(buf), hashValue);
+    memcpy(mac, hashValue, 16);
+}
+
+CBenchTcpResume*
+CBenchTcpResume::CreateInstance()
+{
+    CBenchTcpResume* const bench = new CBenchTcpResume;
+
+    return (bench);
+}
+
+CBenchTcpResume::CBenchTcpResume()
+{
+    m_reactor       = NULL;
+    m_client        = NULL;
+    m_server        = NULL;
+    m_sendSequence  = 0;
+    m_recvSequence  = 0;
+    m_recvCount     = 0;
+    m_seqErrorCount = 0;
+
+    m_connector     = NULL;
+    m_handshaker    = NULL;
+    m_probeResume   = false;
+    m_probeSockId   = -1;
+    m_probeResult   = PROBE_PENDING;
+
+    memset(m_probeToken   , 0, sizeof(m_probeToken));
+    memset(m_probeMacToken, 0, sizeof(m_probeMacToken));
+    memset(m_probeUserData, 0, sizeof(m_probeUserData));
+    memset(&m_probeNonce  , 0, sizeof(PRO_NONCE));
+    memset(&m_probeAck    , 0, sizeof(RTP_SESSION_ACK));
+}
+
+CBenchTcpResume::~CBenchTcpResume()
+{
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchTcpResume::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchTcpResume::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchTcpResume::Run(IProReactor*                 reactor,
+                     const BENCH_CONFIG_INFO&     configInfo,
+                     CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    const unsigned short port            = configInfo.bench_msg_hub_port;
+    const unsigned long  resumeInSeconds = GetRtpTcpResumeTimeout(RESUME_MM_TYPE);
+
+    SetRtpTcpResumeTimeout(RESUME_MM_TYPE, RESUME_TIMEOUT);
+
+    IProServiceHub* const hub = ProCreateServiceHub(reactor, port);
+    if (hub == NULL)
+    {
+        SetRtpTcpResumeTimeout(RESUME_MM_TYPE, resumeInSeconds);
+
+        return (false);
+    }
+
+    IRtpService* const service = CreateRtpService(
+        NULL, this, reactor, RESUME_MM_TYPE, port);
+    if (service == NULL)
+    {
+        ProDeleteServiceHub(hub);
+        SetRtpTcpResumeTimeout(RESUME_MM_TYPE, resumeInSeconds);
+
+        return (false);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_reactor = reactor;
+    }
+
+    double        resumeMs   = 0;
+    double        expireMs   = 0;
+    PRO_UINT64    seqErrors  = 0;
+    PRO_UINT64    statLoss   = 0;
+    unsigned long errorCount = 0;
+
+    IRtpSession* const client = Login(port);
+    if (client == NULL)
+    {
+        ++errorCount;
+    }
+    else
+    {
+        /*
+         * drop and resume. the socket is shut down before the second batch,
+         * so no byte of it is in the kernel at the drop. The packet that the
+         * old transport took goes out again on the new one, the others wait
+         * in the bucket. Every packet has to arrive once and in order
+         */
+        IRtpSession* server = NULL;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            server = m_server;
+        }
+
+        SendBatch(client, RESUME_BATCH);
+        WaitRecv();
+
+        /*
+         * the resume is hidden from the application, even the socket of the
+         * wrapper, so it's timed by the first packet through the new
+         * connection. The packets wait in the bucket meanwhile
+         */
+        const PRO_INT64 dropUs = BenchGetTickUs();
+        pbsd_shutdown_send(client->GetSockId());
+        pbsd_shutdown_recv(client->GetSockId());
+
+        SendBatch(client, RESUME_BATCH);
+
+        bool resumed = false;
+
+        for (int i = 0; i < READY_TIMEOUT_MS; ++i)
+        {
+            {
+                CProThreadMutexGuard mon(m_lock);
+
+                if (m_recvCount > RESUME_BATCH)
+                {
+                    resumeMs = (BenchGetTickUs() - dropUs) / 1000.0;
+                    resumed  = true;
+                    break;
+                }
+            }
+
+            ProSleep(1);
+        }
+
+        WaitRecv();
+
+        ProSleep(DRAIN_TIMEOUT_MS); /* the statistics are published late */
+        server->GetInputStat(NULL, NULL, NULL, &statLoss);
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            seqErrors = m_seqErrorCount;
+
+            /*
+             * the same pair of sessions goes on, with no close and no new
+             * session at the service. The receiver keeps its statistics
+             * across the resume, and they have no loss
+             */
+            if (!resumed || m_servers.size() != 1 ||
+                m_recvCount != RESUME_BATCH * 2 || seqErrors != 0 ||
+                statLoss != 0 ||
+                m_closeUs.find(client) != m_closeUs.end() ||
+                m_closeUs.find(server) != m_closeUs.end())
+            {
+                ++errorCount;
+            }
+        }
+
+        /*
+         * the prober logs in, and keeps its connection open
+         */
+        PRO_INT64       sockId = -1;
+        RTP_SESSION_ACK ack;
+        PRO_NONCE       nonce;
+
+        const char zeroToken[16] = { 0 };
+
+        if (Probe(port, NULL, NULL, sockId, ack, nonce) != PROBE_OK ||
+            memcmp(ack.resumeToken, zeroToken, 16) == 0)
+        {
+            ProCloseSockId(sockId);
+            ++errorCount;
+        }
+        else
+        {
+            char token[16];
+            char wrongToken[16];
+            memcpy(token     , ack.resumeToken, 16);
+            memcpy(wrongToken, ack.resumeToken, 16);
+            wrongToken[0] ^= 1;
+
+            const PRO_INT64 liveSockId = sockId;
+
+            {
+                CProThreadMutexGuard mon(m_lock);
+
+                server = m_servers.back();
+                memcpy(m_probeUserData, ack.userData, 64);
+            }
+
+            /*
+             * a live session is never taken over, even with the right token
+             */
+            if (Probe(port, token, token, sockId, ack, nonce) != PROBE_REFUSED)
+            {
+                ++errorCount;
+            }
+            ProCloseSockId(sockId);
+
+            ProCloseSockId(liveSockId);
+            ProSleep(SETTLE_MS);
+
+            /*
+             * the session is detached now. a wrong mac and an unknown token
+             * are refused, and the right one gets the proof of the server
+             */
+            if (Probe(port, token, wrongToken, sockId, ack, nonce) != PROBE_REFUSED)
+            {
+                ++errorCount;
+            }
+            ProCloseSockId(sockId);
+
+            if (Probe(port, wrongToken, wrongToken, sockId, ack, nonce) != PROBE_REFUSED)
+            {
+                ++errorCount;
+            }
+            ProCloseSockId(sockId);
+
+            if (Probe(port, token, token, sockId, ack, nonce) != PROBE_OK)
+            {
+                ++errorCount;
+            }
+            else
+            {
+                char mac[16];
+                CalcResumeMac_i(token, 's', nonce, m_probeUserData, mac);
+                if (memcmp(mac, ack.resumeToken, 16) != 0)
+                {
+                    ++errorCount;
+                }
+
+                /*
+                 * then it's left to expire
+                 */
+                const PRO_INT64 closeUs = BenchGetTickUs();
+                ProCloseSockId(sockId);
+
+                PRO_INT64 expireUs = 0;
+
+                for (int j = 0; j < (RESUME_TIMEOUT + 5) * 100; ++j)
+                {
+                    ProSleep(10);
+
+                    CProThreadMutexGuard mon(m_lock);
+
+                    CProStlMap<IRtpSession*, PRO_INT64>::const_iterator const itr =
+                        m_closeUs.find(server);
+                    if (itr != m_closeUs.end())
+                    {
+                        expireUs = itr->second;
+                        break;
+                    }
+                }
+
+                expireMs = (expireUs - closeUs) / 1000.0;
+                if (expireUs == 0 || expireMs < RESUME_TIMEOUT * 1000 - SETTLE_MS)
+                {
+                    ++errorCount;
+                }
+            }
+        }
+    }
+
+    IProConnector*              connector  = NULL;
+    IProTcpHandshaker*          handshaker = NULL;
+    CProStlVector<IRtpSession*> servers;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        connector  = m_connector;
+        handshaker = m_handshaker;
+        servers    = m_servers;
+        m_reactor    = NULL;
+        m_client     = NULL;
+        m_server     = NULL;
+        m_connector  = NULL;
+        m_handshaker = NULL;
+        m_servers.clear();
+    }
+
+    ProDeleteConnector(connector);
+    ProDeleteTcpHandshaker(handshaker);
+    DeleteRtpSessionWrapper(client);
+
+    int       i = 0;
+    const int c = (int)servers.size();
+
+    for (; i < c; ++i)
+    {
+        DeleteRtpSessionWrapper(servers[i]);
+    }
+
+    DeleteRtpService(service);
+    ProDeleteServiceHub(hub);
+    SetRtpTcpResumeTimeout(RESUME_MM_TYPE, resumeInSeconds);
+
+    AddMetric_i(metrics, "tcp_resume", "resume_ms",
+        resumeMs, "ms", false);
+    AddMetric_i(metrics, "tcp_resume", "seq_errors",
+        (double)seqErrors, "pkt", false);
+    AddMetric_i(metrics, "tcp_resume", "stat_loss",
+        (double)statLoss, "pkt", false);
+    AddMetric_i(metrics, "tcp_resume", "expire_ms",
+        expireMs, "ms", false);
+    AddMetric_i(metrics, "tcp_resume", "errors",
+        (double)errorCount, "case", false);
+
+    return (errorCount == 0);
+}
+
+IRtpSession*
+CBenchTcpResume::Login(unsigned short port)
+{
+    IProReactor* reactor = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        reactor = m_reactor;
+    }
+
+    /*
+     * the rtp service registers at the hub asynchronously, and the hub drops
+     * the connections arriving before that. So it's retried
+     */
+    for (int i = 0; i < READY_TIMEOUT_MS / 1000; ++i)
+    {
+        RTP_SESSION_INFO localInfo;
+        memset(&localInfo, 0, sizeof(RTP_SESSION_INFO));
+        localInfo.mmType   = RESUME_MM_TYPE;
+        localInfo.packMode = RTP_EPM_DEFAULT;
+
+        RTP_INIT_ARGS initArgs;
+        memset(&initArgs, 0, sizeof(RTP_INIT_ARGS));
+        initArgs.tcpclientEx.observer   = this;
+        initArgs.tcpclientEx.reactor    = reactor;
+        initArgs.tcpclientEx.remotePort = port;
+        strncpy_pro(initArgs.tcpclientEx.remoteIp,
+            sizeof(initArgs.tcpclientEx.remoteIp), LOOPBACK_IP);
+
+        IRtpSession* const client = CreateRtpSessionWrapper(
+            RTP_ST_TCPCLIENT_EX, &initArgs, &localInfo);
+        if (client == NULL)
+        {
+            return (NULL);
+        }
+
+        client->SetOutputRedline(RTP_REDLINE_BYTES, 0, 0);
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_client = client;
+        }
+
+        for (int j = 0; j < 100; ++j)
+        {
+            ProSleep(10);
+
+            const bool ready = client->IsReady();
+
+            CProThreadMutexGuard mon(m_lock);
+
+            if (m_closeUs.find(client) != m_closeUs.end())
+            {
+                break;
+            }
+
+            if (ready && m_servers.size() > 0)
+            {
+                m_server = m_servers.back();
+
+                return (client);
+            }
+        }
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_client = NULL;
+        }
+
+        DeleteRtpSessionWrapper(client);
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            m_closeUs.erase(client);
+        }
+    }
+
+    return (NULL);
+}
+
+void
+CBenchTcpResume::SendBatch(IRtpSession*  client,
+                           unsigned long count)
+{
+    unsigned long i = 0;
+
+    for (; i < count; ++i)
+    {
+        IRtpPacket* const packet = CreateRtpPacketSpace(RESUME_PACKET_SIZE);
+        if (packet == NULL)
+        {
+            continue;
+        }
+
+        memset(packet->GetPayloadBuffer(), 0, RESUME_PACKET_SIZE);
+        packet->SetMarker(true);
+        packet->SetPayloadType(RTP_PAYLOAD_TYPE);
+        packet->SetSequence(m_sendSequence++);
+        packet->SetMmType(RESUME_MM_TYPE);
+
+        client->SendPacket(packet);
+        packet->Release();
+    }
+}
+
+void
+CBenchTcpResume::WaitRecv()
+{
+    for (int i = 0; i < READY_TIMEOUT_MS / 10; ++i)
+    {
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            if (m_recvSequence == m_sendSequence)
+            {
+                break;
+            }
+        }
+
+        ProSleep(10);
+    }
+}
+
+int
+CBenchTcpResume::Probe(unsigned short   port,
+                       const char       resumeToken[16], /* NULL for a login */
+                       const char       macToken[16],
+                       PRO_INT64&       sockId,
+                       RTP_SESSION_ACK& ack,
+                       PRO_NONCE&       nonce)
+{
+    sockId = -1;
+
+    IProReactor* reactor = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_connector == NULL);
+        assert(m_handshaker == NULL);
+
+        reactor       = m_reactor;
+        m_probeResume = resumeToken != NULL;
+        if (m_probeResume)
+        {
+            memcpy(m_probeToken   , resumeToken, 16);
+            memcpy(m_probeMacToken, macToken   , 16);
+        }
+        m_probeSockId = -1;
+        m_probeResult = PROBE_PENDING;
+    }
+
+    IProConnector* const connector = ProCreateConnectorEx(
+        false, RESUME_MM_TYPE, 0, this, reactor, LOOPBACK_IP, port,
+        NULL, CONNECT_TIMEOUT);
+    if (connector == NULL)
+    {
+        return (PROBE_TIMEOUT);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_connector = connector;
+    }
+
+    for (int i = 0; i < READY_TIMEOUT_MS / 10; ++i)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_probeResult != PROBE_PENDING)
+        {
+            sockId = m_probeSockId;
+            ack    = m_probeAck;
+            nonce  = m_probeNonce;
+
+            return (m_probeResult);
+        }
+    }
+
+    return (PROBE_TIMEOUT);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnAcceptSession(IRtpService*            service,
+                                 PRO_INT64               sockId,
+                                 bool                    unixSocket,
+                                 const char*             remoteIp,
+                                 unsigned short          remotePort,
+                                 const RTP_SESSION_INFO* remoteInfo,
+                                 const PRO_NONCE*        nonce)
+{
+    assert(remoteInfo != NULL);
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_reactor == NULL)
+    {
+        ProCloseSockId(sockId);
+
+        return;
+    }
+
+    RTP_SESSION_INFO localInfo;
+    memset(&localInfo, 0, sizeof(RTP_SESSION_INFO));
+    localInfo.remoteVersion = remoteInfo->localVersion;
+    localInfo.mmType        = RESUME_MM_TYPE;
+    localInfo.packMode      = remoteInfo->packMode;
+
+    /*
+     * the ack data stands for the user, and the mac of a resume covers it
+     */
+    RTP_INIT_ARGS initArgs;
+    memset(&initArgs, 0, sizeof(RTP_INIT_ARGS));
+    initArgs.tcpserverEx.observer   = this;
+    initArgs.tcpserverEx.reactor    = m_reactor;
+    initArgs.tcpserverEx.sockId     = sockId;
+    initArgs.tcpserverEx.unixSocket = unixSocket;
+    initArgs.tcpserverEx.useAckData = true;
+    strncpy_pro(initArgs.tcpserverEx.ackData,
+        sizeof(initArgs.tcpserverEx.ackData), "tcp_resume");
+
+    IRtpSession* const server = CreateRtpSessionWrapper(
+        RTP_ST_TCPSERVER_EX, &initArgs, &localInfo);
+    if (server == NULL)
+    {
+        ProCloseSockId(sockId);
+
+        return;
+    }
+
+    m_servers.push_back(server);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnAcceptSession(IRtpService*            service,
+                                 PRO_SSL_CTX*            sslCtx,
+                                 PRO_INT64               sockId,
+                                 bool                    unixSocket,
+                                 const char*             remoteIp,
+                                 unsigned short          remotePort,
+                                 const RTP_SESSION_INFO* remoteInfo,
+                                 const PRO_NONCE*        nonce)
+{
+    ProSslCtx_Delete(sslCtx);
+    ProCloseSockId(sockId);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnRecvSession(IRtpSession* session,
+                               IRtpPacket*  packet)
+{
+    assert(session != NULL);
+    assert(packet != NULL);
+    if (session == NULL || packet == NULL)
+    {
+        return;
+    }
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (session != m_server)
+    {
+        return;
+    }
+
+    if (packet->GetSequence() != m_recvSequence)
+    {
+        ++m_seqErrorCount;
+    }
+
+    m_recvSequence = (PRO_UINT16)(packet->GetSequence() + 1);
+    ++m_recvCount;
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnCloseSession(IRtpSession* session,
+                                long         errorCode,
+                                long         sslCode,
+                                bool         tcpConnected)
+{
+    const PRO_INT64 nowUs = BenchGetTickUs();
+
+    CProThreadMutexGuard mon(m_lock);
+
+    m_closeUs[session] = nowUs;
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnConnectOk(IProConnector*   connector,
+                             PRO_INT64        sockId,
+                             bool             unixSocket,
+                             const char*      remoteIp,
+                             unsigned short   remotePort,
+                             unsigned char    serviceId,
+                             unsigned char    serviceOpt,
+                             const PRO_NONCE* nonce)
+{
+    assert(nonce != NULL);
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_reactor == NULL || connector != m_connector)
+        {
+            ProCloseSockId(sockId);
+
+            return;
+        }
+
+        m_connector = NULL;
+
+        RTP_SESSION_INFO localInfo;
+        memset(&localInfo, 0, sizeof(RTP_SESSION_INFO));
+        localInfo.localVersion = pbsd_hton16(2);
+        localInfo.sessionType  = RTP_ST_TCPCLIENT_EX;
+        localInfo.mmType       = RESUME_MM_TYPE;
+        localInfo.packMode     = RTP_EPM_DEFAULT;
+        ProCalcPasswordHash(nonce->nonce, "", localInfo.passwordHash);
+        if (m_probeResume)
+        {
+            CalcResumeId_i(m_probeToken, localInfo.resumeId);
+            CalcResumeMac_i(m_probeMacToken, 'c', *nonce, m_probeUserData,
+                localInfo.resumeMac);
+        }
+
+        m_probeNonce = *nonce;
+
+        IRtpPacket* const packet =
+            CreateRtpPacket(&localInfo, sizeof(RTP_SESSION_INFO));
+        if (packet != NULL)
+        {
+            packet->SetMmType(RESUME_MM_TYPE);
+
+            m_handshaker = ProCreateTcpHandshaker(
+                this,
+                m_reactor,
+                sockId,
+                unixSocket,
+                (char*)packet->GetPayloadBuffer() - sizeof(RTP_HEADER) - sizeof(RTP_EXT),
+                packet->GetPayloadSize() + sizeof(RTP_HEADER) + sizeof(RTP_EXT),
+                sizeof(RTP_EXT) + sizeof(RTP_HEADER) + sizeof(RTP_SESSION_ACK),
+                false,
+                CONNECT_TIMEOUT
+                );
+            packet->Release();
+        }
+
+        if (m_handshaker == NULL)
+        {
+            ProCloseSockId(sockId);
+            m_probeResult = PROBE_TIMEOUT;
+        }
+    }
+
+    ProDeleteConnector(connector);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnConnectError(IProConnector* connector,
+                                const char*    remoteIp,
+                                unsigned short remotePort,
+                                unsigned char  serviceId,
+                                unsigned char  serviceOpt,
+                                bool           timeout)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (connector != m_connector)
+        {
+            return;
+        }
+
+        m_connector   = NULL;
+        m_probeResult = PROBE_TIMEOUT;
+    }
+
+    ProDeleteConnector(connector);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnHandshakeOk(IProTcpHandshaker* handshaker,
+                               PRO_INT64          sockId,
+                               bool               unixSocket,
+                               const void*        buf,
+                               unsigned long      size)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (handshaker != m_handshaker)
+        {
+            ProCloseSockId(sockId);
+
+            return;
+        }
+
+        m_handshaker = NULL;
+
+        if (buf == NULL ||
+            size != sizeof(RTP_EXT) + sizeof(RTP_HEADER) + sizeof(RTP_SESSION_ACK))
+        {
+            ProCloseSockId(sockId);
+            m_probeResult = PROBE_TIMEOUT;
+        }
+        else
+        {
+            memcpy(
+                &m_probeAck,
+                (char*)buf + sizeof(RTP_EXT) + sizeof(RTP_HEADER),
+                sizeof(RTP_SESSION_ACK)
+                );
+            m_probeSockId = sockId;
+            m_probeResult = PROBE_OK;
+        }
+    }
+
+    ProDeleteTcpHandshaker(handshaker);
+}
+
+void
+PRO_CALLTYPE
+CBenchTcpResume::OnHandshakeError(IProTcpHandshaker* handshaker,
+                                  long               errorCode)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (handshaker != m_handshaker)
+        {
+            return;
+        }
+
+        m_handshaker  = NULL;
+        m_probeResult = PROBE_REFUSED;
+    }
+
+    ProDeleteTcpHandshaker(handshaker);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+PRO_UINT64
+BenchRand64_i(PRO_UINT64& seed)
+{
+    /*
+     * xorshift64
+     */
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+
+    return (seed);
+}
+
+template<class ____Map, class ____K>
+static
+bool
+BenchMap_i(const char*                  name,
+           const CProStlVector<____K>&  keys,
+           const CProStlVector<____K>&  misses,
+           CProStlVector<BENCH_METRIC>& metrics)
+{
+    ____Map* const map = new ____Map;
+    const size_t   c   = keys.size();
+    size_t         hit = 0;
+    size_t         i   = 0;
+
+    PRO_INT64 startUs = BenchGetTickUs();
+    for (i = 0; i < c; ++i)
+    {
+        (*map)[keys[i]] = (PRO_UINT32)i;
+    }
+    const PRO_INT64 insertUs = BenchGetTickUs() - startUs;
+
+    startUs = BenchGetTickUs();
+    for (i = 0; i < c; ++i)
+    {
+        if (map->find(keys[i]) != map->end())
+        {
+            ++hit;
+        }
+    }
+    const PRO_INT64 findUs = BenchGetTickUs() - startUs;
+
+    startUs = BenchGetTickUs();
+    for (i = 0; i < c; ++i)
+    {
+        if (map->find(misses[i]) != map->end())
+        {
+            --hit;
+        }
+    }
+    const PRO_INT64 missUs = BenchGetTickUs() - startUs;
+
+    startUs = BenchGetTickUs();
+    for (i = 0; i < c; ++i)
+    {
+        map->erase(keys[i]);
+    }
+    const PRO_INT64 eraseUs = BenchGetTickUs() - startUs;
+
+    const bool ret = hit == c && map->size() == 0;
+    delete map;
+
+    CProStlString metric = "";
+
+    metric = name;
+    metric += "_insert";
+    AddMetric_i(metrics, "stl_hash", metric.c_str(),
+        (double)c / (insertUs > 0 ? insertUs : 1), "mops", true);
+    metric = name;
+    metric += "_find";
+    AddMetric_i(metrics, "stl_hash", metric.c_str(),
+        (double)c / (findUs > 0 ? findUs : 1), "mops", true);
+    metric = name;
+    metric += "_miss";
+    AddMetric_i(metrics, "stl_hash", metric.c_str(),
+        (double)c / (missUs > 0 ? missUs : 1), "mops", true);
+    metric = name;
+    metric += "_erase";
+    AddMetric_i(metrics, "stl_hash", metric.c_str(),
+        (double)c / (eraseUs > 0 ? eraseUs : 1), "mops", true);
+
+    return (ret);
+}
+
+bool
+CBenchStlHash::Run(const BENCH_CONFIG_INFO&     configInfo,
+                   CProStlVector<BENCH_METRIC>& metrics)
+{
+    const size_t c    = configInfo.bench_hash_entry_count;
+    PRO_UINT64   seed = 0x2545F491;
+    bool         ret  = true;
+    size_t       i    = 0;
+
+    seed <<= 32;
+    seed |=  0x4F6CDD1D;
+
+    /*
+     * 64-bit ids. the misses are odd, and the keys are even
+     */
+    {
+        CProStlVector<PRO_UINT64> keys;
+        CProStlVector<PRO_UINT64> misses;
+        keys.resize(c);
+        misses.resize(c);
+
+        for (i = 0; i < c; ++i)
+        {
+            keys[i]   = BenchRand64_i(seed) & ~(PRO_UINT64)1;
+            misses[i] = BenchRand64_i(seed) | 1;
+        }
+
+        ret = BenchMap_i<CProStlMap<PRO_UINT64, PRO_UINT32>, PRO_UINT64>(
+            "id_tree", keys, misses, metrics) && ret;
+        ret = BenchMap_i<CProStlHashMap<PRO_UINT64, PRO_UINT32>, PRO_UINT64>(
+            "id_hash", keys, misses, metrics) && ret;
+    }
+
+    /*
+     * pointers, as the heap gives them
+     */
+    {
+        CProStlVector<const void*> keys;
+        CProStlVector<const void*> misses;
+        keys.resize(c);
+        misses.resize(c);
+
+        for (i = 0; i < c; ++i)
+        {
+            keys[i]   = (const char*)0x10000 + i * 64;
+            misses[i] = (const char*)0x10000 + i * 64 + 32;
+        }
+
+        ret = BenchMap_i<CProStlMap<const void*, PRO_UINT32>, const void*>(
+            "ptr_tree", keys, misses, metrics) && ret;
+        ret = BenchMap_i<CProStlHashMap<const void*, PRO_UINT32>, const void*>(
+            "ptr_hash", keys, misses, metrics) && ret;
+    }
+
+    /*
+     * users of a few classes, as a msg server sees them
+     */
+    {
+        CProStlVector<RTP_MSG_USER> keys;
+        CProStlVector<RTP_MSG_USER> misses;
+        keys.resize(c);
+        misses.resize(c);
+
+        for (i = 0; i < c; ++i)
+        {
+            keys[i]   = RTP_MSG_USER((unsigned char)(2 + i % 4), 10000 + i, 1);
+            misses[i] = RTP_MSG_USER((unsigned char)(2 + i % 4), 10000 + i, 2);
+        }
+
+        ret = BenchMap_i<CProStlMap<RTP_MSG_USER, PRO_UINT32>, RTP_MSG_USER>(
+            "user_tree", keys, misses, metrics) && ret;
+        ret = BenchMap_i<CProStlHashMap<RTP_MSG_USER, PRO_UINT32>, RTP_MSG_USER>(
+            "user_hash", keys, misses, metrics) && ret;
+    }
+
+    return (ret);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define TASK_KEY_COUNT  1000
+#define TASK_SPIN_COUNT 2000 /* a few microseconds */
+
+class CBenchTaskTarget
+{
+public:
+
+    CBenchTaskTarget()
+    {
+        m_doneCount   = 0;
+        m_errorCount  = 0;
+        m_totalWaitUs = 0;
+        m_maxWaitUs   = 0;
+        m_result      = 0;
+
+        for (int i = 0; i < TASK_KEY_COUNT; ++i)
+        {
+            m_seqs[i] = 0;
+        }
+    }
+
+    void Action(PRO_INT64* args)
+    {
+        const int       key    = (int)args[0];
+        const PRO_INT64 seq    = args[1];
+        const PRO_INT64 waitUs = BenchGetTickUs() - args[2];
+
+        PRO_UINT64 seed = (PRO_UINT64)seq + 1;
+        for (int i = 0; i < TASK_SPIN_COUNT; ++i)
+        {
+            BenchRand64_i(seed);
+        }
+
+        /*
+         * one thread at a time per key
+         */
+        const bool ordered = m_seqs[key] == seq;
+        m_seqs[key] = seq + 1;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            ++m_doneCount;
+            if (!ordered)
+            {
+                ++m_errorCount;
+            }
+            m_totalWaitUs += waitUs;
+            if (waitUs > m_maxWaitUs)
+            {
+                m_maxWaitUs = waitUs;
+            }
+            m_result ^= seed;
+        }
+    }
+
+    PRO_UINT64 GetDoneCount() const
+    {
+        PRO_UINT64 doneCount = 0;
+
+        {
+            CProThreadMutexGuard mon(m_lock);
+
+            doneCount = m_doneCount;
+        }
+
+        return (doneCount);
+    }
+
+public:
+
+    PRO_INT64               m_seqs[TASK_KEY_COUNT];
+    PRO_UINT64              m_doneCount;
+    PRO_UINT64              m_errorCount;
+    PRO_INT64               m_totalWaitUs;
+    PRO_INT64               m_maxWaitUs;
+    PRO_UINT64              m_result;
+    mutable CProThreadMutex m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+typedef void (CBenchTaskTarget::* TASK_ACTION)(PRO_INT64*);
+
+static
+void
+PutTask_i(CProFunctorCommandTask& task,
+          PRO_UINT64              key,
+          IProFunctorCommand*     command)
+{
+    task.Put(command);
+}
+
+static
+void
+PutTask_i(CProFunctorCommandTaskPool& pool,
+          PRO_UINT64                  key,
+          IProFunctorCommand*         command)
+{
+    pool.Put(key, command);
+}
+
+template<class ____Task>
+static
+bool
+BenchTask_i(const char*                  name,
+            ____Task&                    task,
+            size_t                       commandCount,
+            CProStlVector<BENCH_METRIC>& metrics)
+{
+    CBenchTaskTarget* const target  = new CBenchTaskTarget;
+    const PRO_INT64         startUs = BenchGetTickUs();
+
+    for (size_t i = 0; i < commandCount; ++i)
+    {
+        IProFunctorCommand* const command =
+            CProFunctorCommand_cpp<CBenchTaskTarget, TASK_ACTION>::CreateInstance(
+            *target,
+            &CBenchTaskTarget::Action,
+            (PRO_INT64)(i % TASK_KEY_COUNT),
+            (PRO_INT64)(i / TASK_KEY_COUNT),
+            BenchGetTickUs()
+            );
+        PutTask_i(task, i % TASK_KEY_COUNT, command);
+    }
+
+    while (target->GetDoneCount() < commandCount)
+    {
+        ProSleep(1);
+    }
+
+    const PRO_INT64 elapsedUs = BenchGetTickUs() - startUs;
+    const bool      ret       = target->m_errorCount == 0;
+
+    CProStlString metric = "";
+
+    metric = name;
+    metric += "_rate";
+    AddMetric_i(metrics, "task_pool", metric.c_str(),
+        (double)commandCount * 1000 / (elapsedUs > 0 ? elapsedUs : 1),
+        "kcmds", true);
+    metric = name;
+    metric += "_wait_avg";
+    AddMetric_i(metrics, "task_pool", metric.c_str(),
+        (double)target->m_totalWaitUs / commandCount / 1000, "ms", false);
+    metric = name;
+    metric += "_wait_max";
+    AddMetric_i(metrics, "task_pool", metric.c_str(),
+        (double)target->m_maxWaitUs / 1000, "ms", false);
+    metric = name;
+    metric += "_order_errors";
+    AddMetric_i(metrics, "task_pool", metric.c_str(),
+        (double)target->m_errorCount, "count", false);
+
+    delete target;
+
+    return (ret);
+}
+
+bool
+CBenchTaskPool::Run(const BENCH_CONFIG_INFO&     configInfo,
+                    CProStlVector<BENCH_METRIC>& metrics)
+{
+    const size_t c   = configInfo.bench_task_command_count;
+    bool         ret = true;
+
+    {
+        CProFunctorCommandTask task;
+        if (!task.Start())
+        {
+            return (false);
+        }
+
+        ret = BenchTask_i("single", task, c, metrics) && ret;
+        task.Stop();
+    }
+
+    {
+        CProFunctorCommandTaskPool pool;
+        if (!pool.Start())
+        {
+            return (false);
+        }
+
+        ret = BenchTask_i("pool", pool, c, metrics) && ret;
+
+        PRO_TASK_POOL_STATS stats;
+        pool.GetStats(&stats);
+        pool.Stop();
+
+        AddMetric_i(metrics, "task_pool", "pool_threads",
+            (double)stats.threadCount, "count", true);
+        AddMetric_i(metrics, "task_pool", "pool_depth_max",
+            (double)stats.maxPendingCount, "count", false);
+        AddMetric_i(metrics, "task_pool", "pool_steals",
+            (double)stats.stealCount, "count", true);
+    }
+
+    return (ret);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+class CBenchTaskCounter
+{
+public:
+
+    CBenchTaskCounter()
+    {
+        m_count = 0;
+    }
+
+    void Action(PRO_INT64* args)
+    {
+        ++m_count; /* by the only consumer */
+    }
+
+public:
+
+    volatile long m_count;
+
+    DECLARE_SGI_POOL(0)
+};
+
+typedef void (CBenchTaskCounter::* COUNTER_ACTION)(PRO_INT64*);
+
+class CBenchTaskProducer : public CProThreadBase
+{
+public:
+
+    CBenchTaskProducer(CProFunctorCommandTask& task,
+                       CBenchTaskCounter&      counter,
+                       size_t                  commandCount)
+    : m_task(task), m_counter(counter), m_commandCount(commandCount)
+    {
+    }
+
+    bool Start(unsigned long threadCount)
+    {
+        for (int i = 0; i < (int)threadCount; ++i)
+        {
+            if (!Spawn(false))
+            {
+                return (false);
+            }
+        }
+
+        return (true);
+    }
+
+    void Wait()
+    {
+        WaitAll();
+    }
+
+private:
+
+    virtual void Svc()
+    {
+        for (size_t i = 0; i < m_commandCount; ++i)
+        {
+            IProFunctorCommand* const command =
+                CProFunctorCommand_cpp<CBenchTaskCounter, COUNTER_ACTION>::CreateInstance(
+                m_counter,
+                &CBenchTaskCounter::Action
+                );
+            m_task.Put(command);
+        }
+    }
+
+private:
+
+    CProFunctorCommandTask& m_task;
+    CBenchTaskCounter&      m_counter;
+    const size_t            m_commandCount;
+
+    DECLARE_SGI_POOL(0)
+};
+
+bool
+CBenchTaskMpsc::Run(const BENCH_CONFIG_INFO&     configInfo,
+                    CProStlVector<BENCH_METRIC>& metrics)
+{
+    static const unsigned long s_producerCounts[] = { 1, 2, 4, 8, 16, 32, 64 };
+
+    bool ret = true;
+
+    for (int i = 0; i < (int)(sizeof(s_producerCounts) / sizeof(unsigned long)); ++i)
+    {
+        const unsigned long producerCount = s_producerCounts[i];
+        const size_t        perProducer   =
+            configInfo.bench_task_command_count / producerCount + 1;
+        const size_t        total         = perProducer * producerCount;
+
+        for (int j = 0; j < 2; ++j)
+        {
+            const bool             lockFree = j == 1;
+            CBenchTaskCounter      counter;
+            CProFunctorCommandTask task;
+            if (!task.Start(false, 1, lockFree))
+            {
+                return (false);
+            }
+
+            CBenchTaskProducer* const producer =
+                new CBenchTaskProducer(task, counter, perProducer);
+            const PRO_INT64           startUs  = BenchGetTickUs();
+
+            if (!producer->Start(producerCount))
+            {
+                ret = false;
+            }
+            producer->Wait();
+
+            while ((size_t)counter.m_count < total && ret)
+            {
+                ProSleep(1);
+            }
+
+            const PRO_INT64 elapsedUs = BenchGetTickUs() - startUs;
+            task.Stop();
+            delete producer;
+
+            char metric[64] = "";
+            snprintf_pro(metric, sizeof(metric), "%s_p%u_rate",
+                lockFree ? "lockfree" : "locked", (unsigned int)producerCount);
+            AddMetric_i(metrics, "task_mpsc", metric,
+                (double)total * 1000 / (elapsedUs > 0 ? elapsedUs : 1),
+                "kcmds", true);
+        }
+    }
+
+    return (ret);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+static
+inline
+PRO_UINT32
+PRO_CALLTYPE
+NextRand_i(PRO_UINT32& seed)
+{
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+
+    return (seed);
+}
+
+/*
+ * mostly common packets, plus csrcs, extensions, paddings, truncated ones
+ * and noise
+ */
+static
+void
+PRO_CALLTYPE
+MakeRtpStream_i(PRO_UINT32&          seed,
+                CProStlVector<char>& stream)
+{
+    const PRO_UINT32 kind = NextRand_i(seed) % 100;
+    const PRO_UINT32 cc   = kind < 60 ? 0 : NextRand_i(seed) % 16;
+    const PRO_UINT32 ext  = kind >= 70 && kind < 80 ? NextRand_i(seed) % 8 : 0;
+    const PRO_UINT32 pad  = kind >= 80 && kind < 85 ? NextRand_i(seed) % 256 : 0;
+
+    stream.resize(12 + cc * 4 + (kind >= 70 && kind < 80 ? 4 + ext * 4 : 0) +
+        NextRand_i(seed) % 1400);
+
+    size_t i = 0;
+    for (; i < stream.size(); ++i)
+    {
+        stream[i] = (char)NextRand_i(seed);
+    }
+
+    unsigned char b0 = (unsigned char)(0x80 | cc);
+    if (kind >= 70 && kind < 80)
+    {
+        b0 |= 0x10;
+        stream[12 + cc * 4 + 2] = (char)(ext >> 8);
+        stream[12 + cc * 4 + 3] = (char)ext;
+    }
+    if (kind >= 80 && kind < 85)
+    {
+        b0 |= 0x20;
+        stream[stream.size() - 1] = (char)pad;
+    }
+    stream[0] = (char)b0;
+
+    if (kind >= 85 && kind < 90)
+    {
+        stream.resize(NextRand_i(seed) % (12 + cc * 4 + 1)); /* truncated */
+    }
+    else if (kind >= 90 && kind < 95)
+    {
+        stream[0] = (char)NextRand_i(seed); /* noise */
+    }
+    else if (kind >= 95)
+    {
+        stream.resize(NextRand_i(seed) % 12 + 1); /* too short */
+    }
+    else
+    {
+    }
+}
+
+bool
+CBenchRtpParse::Run(const BENCH_CONFIG_INFO&     configInfo,
+                    CProStlVector<BENCH_METRIC>& metrics)
+{
+    const size_t c    = configInfo.bench_parse_packet_count;
+    PRO_UINT32   seed = 20180101;
+
+    CProStlVector<char>        arena;
+    CProStlVector<size_t>      offsets;
+    CProStlVector<PRO_UINT16>  sizes;
+    CProStlVector<const void*> buffers;
+    CProStlVector<char>        stream;
+    offsets.resize(c);
+    sizes.resize(c);
+    buffers.resize(c);
+
+    size_t i = 0;
+    for (i = 0; i < c; ++i)
+    {
+        MakeRtpStream_i(seed, stream);
+
+        offsets[i] = arena.size();
+        sizes[i]   = (PRO_UINT16)stream.size();
+        arena.insert(arena.end(), stream.begin(), stream.end());
+    }
+    arena.resize(arena.size() + 1);
+
+    for (i = 0; i < c; ++i)
+    {
+        buffers[i] = &arena[0] + offsets[i];
+    }
+
+    CProStlVector<RTP_STREAM_INFO> batchInfos;
+    CProStlVector<RTP_STREAM_INFO> singleInfos;
+    batchInfos.resize(c);
+    singleInfos.resize(c);
+
+    PRO_INT64 startUs = BenchGetTickUs();
+    const unsigned long validCount =
+        ParseRtpStreams(&buffers[0], &sizes[0], (unsigned long)c, &batchInfos[0]);
+    const PRO_INT64 batchUs = BenchGetTickUs() - startUs;
+
+    startUs = BenchGetTickUs();
+    for (i = 0; i < c; ++i)
+    {
+        ParseRtpStreams(&buffers[i], &sizes[i], 1, &singleInfos[i]);
+    }
+    const PRO_INT64 singleUs = BenchGetTickUs() - startUs;
+
+    unsigned long mismatchCount = 0;
+    for (i = 0; i < c; ++i)
+    {
+        if (memcmp(&batchInfos[i], &singleInfos[i], sizeof(RTP_STREAM_INFO)) != 0)
+        {
+            ++mismatchCount;
+        }
+    }
+
+    AddMetric_i(metrics, "rtp_parse", "batch_rate",
+        (double)c / (batchUs > 0 ? batchUs : 1), "mpps", true);
+    AddMetric_i(metrics, "rtp_parse", "single_rate",
+        (double)c / (singleUs > 0 ? singleUs : 1), "mpps", true);
+    AddMetric_i(metrics, "rtp_parse", "valid_percent",
+        (double)validCount * 100 / c, "%", true);
+    AddMetric_i(metrics, "rtp_parse", "mismatches",
+        mismatchCount, "pkt", false);
+
+    return (mismatchCount == 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+struct CRYPTO_CASE
+{
+    const char*           name;
+    mbedtls_cipher_type_t type;
+};
+
+static
+void
+PRO_CALLTYPE
+SetCryptoAccel_i(bool enable)
+{
+    mbedtls_aes_set_accel(enable ? 1 : 0);
+    mbedtls_chacha20_set_accel(enable ? 1 : 0);
+    mbedtls_poly1305_set_accel(enable ? 1 : 0);
+}
+
+/*
+ * seals the record again and again for about "us" microseconds, the way the
+ * TLS record layer does (12-byte nonce, 13-byte additional data, 16-byte tag),
+ * and returns the bytes per microsecond, or -1 on failure. the first sealed
+ * record goes to "sealed"
+ */
+static
+double
+PRO_CALLTYPE
+SealRecords_i(mbedtls_cipher_type_t               type,
+              const CProStlVector<unsigned char>& record,
+              PRO_INT64                           us,
+              CProStlVector<unsigned char>&       sealed)
+{
+    const mbedtls_cipher_info_t* const info = mbedtls_cipher_info_from_type(type);
+    if (info == NULL)
+    {
+        return (-1);
+    }
+
+    unsigned char key[32];
+    unsigned char nonce[12];
+    unsigned char ad[13];
+    memset(key  , 0x5A, sizeof(key));
+    memset(nonce, 0   , sizeof(nonce));
+    memset(ad   , 0x17, sizeof(ad));
+
+    mbedtls_cipher_context_t ctx;
+    mbedtls_cipher_init(&ctx);
+
+    if (mbedtls_cipher_setup(&ctx, info) != 0 ||
+        mbedtls_cipher_setkey(&ctx, key, info->key_bitlen, MBEDTLS_ENCRYPT) != 0)
+    {
+        mbedtls_cipher_free(&ctx);
+
+        return (-1);
+    }
+
+    const size_t size = record.size();
+
+    CProStlVector<unsigned char> out;
+    out.resize(size + 16);
+
+    PRO_UINT64      seq       = 0;
+    PRO_INT64       elapsedUs = 0;
+    const PRO_INT64 startUs   = BenchGetTickUs();
+
+    do
+    {
+        for (int i = 0; i < 16; ++i, ++seq)
+        {
+            for (int j = 0; j < 8; ++j)
+            {
+                nonce[4 + j] = (unsigned char)(seq >> (56 - j * 8));
+            }
+
+            size_t outSize = 0;
+            if (mbedtls_cipher_auth_encrypt(&ctx, nonce, sizeof(nonce),
+                ad, sizeof(ad), &record[0], size, &out[0], &outSize,
+                &out[size], 16) != 0)
+            {
+                mbedtls_cipher_free(&ctx);
+
+                return (-1);
+            }
+
+            if (seq == 0)
+            {
+                sealed = out;
+            }
+        }
+
+        elapsedUs = BenchGetTickUs() - startUs;
+    }
+    while (elapsedUs < us);
+
+    mbedtls_cipher_free(&ctx);
+
+    return ((double)(seq * size) / (elapsedUs > 0 ? elapsedUs : 1));
+}
+
+bool
+CBenchCryptoTput::Run(const BENCH_CONFIG_INFO&     configInfo,
+                      CProStlVector<BENCH_METRIC>& metrics)
+{
+    static const CRYPTO_CASE s_cases[] =
+    {
+        { "aes_128_gcm"      , MBEDTLS_CIPHER_AES_128_GCM        },
+        { "aes_256_gcm"      , MBEDTLS_CIPHER_AES_256_GCM        },
+        { "chacha20_poly1305", MBEDTLS_CIPHER_CHACHA20_POLY1305 }
+    };
+
+    const size_t    caseCount = sizeof(s_cases) / sizeof(CRYPTO_CASE);
+    const PRO_INT64 us        =
+        (PRO_INT64)configInfo.bench_duration * 1000000 / (caseCount * 2);
+    PRO_UINT32      seed      = 20180101;
+
+    CProStlVector<unsigned char> record;
+    record.resize(configInfo.bench_crypto_record_size);
+
+    size_t i = 0;
+    for (i = 0; i < record.size(); ++i)
+    {
+        record[i] = (unsigned char)NextRand_i(seed);
+    }
+
+    bool          ok            = true;
+    unsigned long mismatchCount = 0;
+
+    for (i = 0; i < caseCount; ++i)
+    {
+        CProStlVector<unsigned char> sealed1;
+        CProStlVector<unsigned char> sealed2;
+
+        SetCryptoAccel_i(false);
+        const double portable = SealRecords_i(s_cases[i].type, record, us, sealed1);
+        SetCryptoAccel_i(true);
+        const double accel    = SealRecords_i(s_cases[i].type, record, us, sealed2);
+
+        if (portable < 0 || accel < 0)
+        {
+            ok = false;
+            continue;
+        }
+
+        if (sealed1 != sealed2)
+        {
+            ++mismatchCount;
+        }
+
+        CProStlString name = s_cases[i].name;
+
+        AddMetric_i(metrics, "crypto_tput", (name + "_portable").c_str(),
+            portable, "MB/s", true);
+        AddMetric_i(metrics, "crypto_tput", (name + "_accel").c_str(),
+            accel, "MB/s", true);
+        AddMetric_i(metrics, "crypto_tput", (name + "_speedup").c_str(),
+            accel / (portable > 0 ? portable : 1), "x", true);
+    }
+
+    AddMetric_i(metrics, "crypto_tput", "aes_hw",
+        mbedtls_aes_has_accel(), "bool", true);
+    AddMetric_i(metrics, "crypto_tput", "mismatches",
+        mismatchCount, "case", false);
+
+    return (ok && mismatchCount == 0);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#define SSL_CHUNK_SIZE 16384 /* a full record */
+
+/*
+ * the byte at "pos" of the stream of "tag". any range can be regenerated
+ * alone, so the receiver can check the chunks however they are split
+ */
+static
+void
+BenchFillStream_i(unsigned char tag,
+                  PRO_UINT64    pos,
+                  char*         buf,
+                  unsigned long size)
+{
+    PRO_UINT64 word = 0;
+
+    for (unsigned long i = 0; i < size; ++i, ++pos)
+    {
+        const unsigned long shift = (unsigned long)(pos % 8) * 8;
+
+        if (i == 0 || shift == 0)
+        {
+            word = ((pos / 8) << 1 | 1) ^ ((PRO_UINT64)tag << 56);
+            BenchRand64_i(word);
+            BenchRand64_i(word);
+        }
+
+        buf[i] = (char)(word >> shift);
+    }
+}
+
+CBenchSslPeer*
+CBenchSslPeer::CreateInstance(bool       client,
+                              PRO_UINT64 streamSize)
+{
+    CBenchSslPeer* const peer = new CBenchSslPeer(client, streamSize);
+
+    return (peer);
+}
+
+CBenchSslPeer::CBenchSslPeer(bool       client,
+                             PRO_UINT64 streamSize)
+                             :
+m_client(client),
+m_streamSize(streamSize)
+{
+    m_trans         = NULL;
+    m_running       = false;
+    m_broken        = false;
+    m_sentBytes     = 0;
+    m_recvBytes     = 0;
+    m_mismatchCount = 0;
+    m_sendBuf       = (char*)ProMalloc(SSL_CHUNK_SIZE);
+    m_recvBuf       = (char*)ProMalloc(SSL_CHUNK_SIZE);
+    m_expectBuf     = (char*)ProMalloc(SSL_CHUNK_SIZE);
+}
+
+CBenchSslPeer::~CBenchSslPeer()
+{
+    Fini();
+
+    ProFree(m_sendBuf);
+    ProFree(m_recvBuf);
+    ProFree(m_expectBuf);
+    m_sendBuf   = NULL;
+    m_recvBuf   = NULL;
+    m_expectBuf = NULL;
+}
+
+bool
+CBenchSslPeer::Init(IProReactor* reactor,
+                    PRO_SSL_CTX* ctx,
+                    PRO_INT64    sockId,
+                    bool         unixSocket)
+{
+    assert(reactor != NULL);
+    assert(ctx != NULL);
+    assert(sockId != -1);
+    if (reactor == NULL || ctx == NULL || sockId == -1 ||
+        m_sendBuf == NULL || m_recvBuf == NULL || m_expectBuf == NULL)
+    {
+        return (false);
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        assert(m_trans == NULL);
+        if (m_trans != NULL)
+        {
+            return (false);
+        }
+
+        m_trans = ProCreateSslTransport(this, reactor, ctx, sockId, unixSocket);
+        if (m_trans == NULL)
+        {
+            return (false);
+        }
+    }
+
+    return (true);
+}
+
+void
+CBenchSslPeer::Fini()
+{
+    IProTransport* trans = NULL;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_trans == NULL)
+        {
+            return;
+        }
+
+        m_running = false;
+        trans = m_trans;
+        m_trans = NULL;
+    }
+
+    ProDeleteTransport(trans);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchSslPeer::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchSslPeer::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+void
+CBenchSslPeer::Start()
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_trans == NULL || m_running)
+    {
+        return;
+    }
+
+    m_running = true;
+
+    SendChunk();
+}
+
+bool
+CBenchSslPeer::IsDone() const
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    return (m_sentBytes >= m_streamSize && m_recvBytes >= m_streamSize);
+}
+
+unsigned long
+CBenchSslPeer::GetKtls() const
+{
+    PRO_TRANSPORT_STATS stats;
+    memset(&stats, 0, sizeof(PRO_TRANSPORT_STATS));
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_trans != NULL)
+        {
+            m_trans->GetStats(&stats);
+        }
+    }
+
+    return ((unsigned long)stats.tlsKtls);
+}
+
+void
+PRO_CALLTYPE
+CBenchSslPeer::OnRecv(IProTransport*          trans,
+                      const pbsd_sockaddr_in* remoteAddr)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    IProRecvPool& recvPool = *trans->GetRecvPool();
+    unsigned long dataSize = recvPool.PeekDataSize();
+
+    while (dataSize > 0)
+    {
+        const unsigned long size =
+            dataSize < SSL_CHUNK_SIZE ? dataSize : SSL_CHUNK_SIZE;
+
+        recvPool.PeekData(m_recvBuf, size);
+        recvPool.Flush(size);
+
+        BenchFillStream_i(m_client ? 2 : 1, m_recvBytes, m_expectBuf, size);
+        if (m_recvBytes + size > m_streamSize ||
+            memcmp(m_recvBuf, m_expectBuf, size) != 0)
+        {
+            ++m_mismatchCount;
+        }
+
+        m_recvBytes += size;
+        dataSize    -= size;
+    }
+}
+
+void
+PRO_CALLTYPE
+CBenchSslPeer::OnSend(IProTransport* trans,
+                      PRO_UINT64     actionId)
+{
+    assert(trans != NULL);
+    if (trans == NULL)
+    {
+        return;
+    }
+
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    SendChunk();
+}
+
+void
+PRO_CALLTYPE
+CBenchSslPeer::OnClose(IProTransport* trans,
+                       long           errorCode,
+                       long           sslCode)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (trans != m_trans)
+    {
+        return;
+    }
+
+    m_running = false;
+    m_broken  = true;
+}
+
+void
+CBenchSslPeer::SendChunk()
+{
+    if (m_trans == NULL || !m_running || m_sentBytes >= m_streamSize)
+    {
+        return;
+    }
+
+    const unsigned long size = m_streamSize - m_sentBytes < SSL_CHUNK_SIZE
+        ? (unsigned long)(m_streamSize - m_sentBytes) : SSL_CHUNK_SIZE;
+
+    BenchFillStream_i(m_client ? 1 : 2, m_sentBytes, m_sendBuf, size);
+    if (m_trans->SendData(m_sendBuf, size))
+    {
+        m_sentBytes += size;
+    }
+}
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+CBenchSslTput*
+CBenchSslTput::CreateInstance()
+{
+    CBenchSslTput* const bench = new CBenchSslTput;
+
+    return (bench);
+}
+
+CBenchSslTput::CBenchSslTput()
+{
+    m_reactor      = NULL;
+    m_serverConfig = NULL;
+    m_clientConfig = NULL;
+    m_streamSize   = 0;
+    m_errorCount   = 0;
+}
+
+CBenchSslTput::~CBenchSslTput()
+{
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchSslTput::AddRef()
+{
+    const unsigned long refCount = CProRefCount::AddRef();
+
+    return (refCount);
+}
+
+unsigned long
+PRO_CALLTYPE
+CBenchSslTput::Release()
+{
+    const unsigned long refCount = CProRefCount::Release();
+
+    return (refCount);
+}
+
+bool
+CBenchSslTput::Run(IProReactor*                 reactor,
+                   const BENCH_CONFIG_INFO&     configInfo,
+                   CProStlVector<BENCH_METRIC>& metrics)
+{
+    assert(reactor != NULL);
+    if (reactor == NULL)
+    {
+        return (false);
+    }
+
+    double        mbps1          = 0;
+    double        mbps2          = 0;
+    unsigned long ktlsDirs1      = 0;
+    unsigned long ktlsDirs2      = 0;
+    PRO_UINT64    mismatchCount1 = 0;
+    PRO_UINT64    mismatchCount2 = 0;
+
+    const bool ok1 = RunPass(
+        reactor, configInfo, false, mbps1, ktlsDirs1, mismatchCount1);
+    const bool ok2 = RunPass(
+        reactor, configInfo, true , mbps2, ktlsDirs2, mismatchCount2);
+
+    AddMetric_i(metrics, "ssl_tput", "mbedtls_mbps", mbps1, "Mbit/s", true);
+    AddMetric_i(metrics, "ssl_tput", "ktls_mbps"   , mbps2, "Mbit/s", true);
+    AddMetric_i(metrics, "ssl_tput", "ktls_speedup",
+        mbps2 / (mbps1 > 0 ? mbps1 : 1), "x", true);
+    AddMetric_i(metrics, "ssl_tput", "ktls_dirs"   , ktlsDirs2, "dir", true);
+    AddMetric_i(metrics, "ssl_tput", "mismatches"  ,
+        (double)(mismatchCount1 + mismatchCount2), "chunk", false);
+    AddMetric_i(metrics, "ssl_tput", "errors"      , m_errorCount, "conn", false);
+
+    return (ok1 && ok2 && ktlsDirs1 == 0 &&
+        mismatchCount1 == 0 && mismatchCount2 == 0);
+}
+
+bool
+CBenchSslTput::RunPass(IProReactor*             reactor,
+                       const BENCH_CONFIG_INFO& configInfo,
+                       bool                     ktls,
+                       double&                  mbps,
+                       unsigned long&           ktlsDirs,
+                       PRO_UINT64&              mismatchCount)
+{
+    mbps          = 0;
+    ktlsDirs      = 0;
+    mismatchCount = 0;
+
+    const char* caFiles[]   = { configInfo.bench_ssl_cafile.c_str() };
+    const char* certFiles[] = { configInfo.bench_ssl_certfile.c_str() };
+
+    PRO_SSL_SERVER_CONFIG* const serverConfig = ProSslServerConfig_Create();
+    PRO_SSL_CLIENT_CONFIG* const clientConfig = ProSslClientConfig_Create();
+    if (serverConfig == NULL || clientConfig == NULL)
+    {
+        ProSslServerConfig_Delete(serverConfig);
+        ProSslClientConfig_Delete(clientConfig);
+
+        return (false);
+    }
+
+    ProSslServerConfig_EnableSha1Cert(serverConfig, true);
+    ProSslClientConfig_EnableSha1Cert(clientConfig, true);
+    ProSslServerConfig_EnableKtls(serverConfig, ktls);
+    ProSslClientConfig_EnableKtls(clientConfig, ktls);
+
+    if (!ProSslServerConfig_SetCaList(serverConfig, caFiles, 1, NULL, 0) ||
+        !ProSslServerConfig_AppendCertChain(serverConfig, certFiles, 1,
+        configInfo.bench_ssl_keyfile.c_str(), NULL)                      ||
+        !ProSslClientConfig_SetCaList(clientConfig, caFiles, 1, NULL, 0))
+    {
+        ProSslServerConfig_Delete(serverConfig);
+        ProSslClientConfig_Delete(clientConfig);
+
+        return (false);
+    }
+
+    IProAcceptor* const acceptor =
+        ProCreateAcceptor(this, reactor, LOOPBACK_IP, 0);
+    if (acceptor == NULL)
+    {
+        ProSslServerConfig_Delete(serverConfig);
+        ProSslClientConfig_Delete(clientConfig);
+
+        return (false);
+    }
+
+    unsigned long errorCount = 0;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        errorCount = m_errorCount;
+
+        m_reactor      = reactor;
+        m_serverConfig = serverConfig;
+        m_clientConfig = clientConfig;
+        m_sni          = configInfo.bench_ssl_sni;
+        m_streamSize   = (PRO_UINT64)configInfo.bench_ssl_stream_size * 1024 * 1024;
+
+        IProConnector* const connector = ProCreateConnector(false, this,
+            reactor, LOOPBACK_IP, ProGetAcceptorPort(acceptor), NULL,
+            CONNECT_TIMEOUT);
+        if (connector != NULL)
+        {
+            m_connectors.insert(connector);
+        }
+        else
+        {
+            ++m_errorCount;
+        }
+    }
+
+    /*
+     * wait for both sides of the connection
+     */
+    CProStlVector<CBenchSslPeer*> peers;
+
+    for (int j = 0; j < READY_TIMEOUT_MS / 10; ++j)
+    {
+        ProSleep(10);
+
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_peers.size() >= 2 || m_errorCount != errorCount)
+        {
+            break;
+        }
+    }
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        peers = m_peers;
+    }
+
+    int       i = 0;
+    const int c = (int)peers.size();
+
+    for (i = 0; i < c; ++i)
+    {
+        peers[i]->Start();
+    }
+
+    /*
+     * the streams are finite. the pass ends when both are checked, or when
+     * the time is up
+     */
+    const PRO_INT64 startUs   = BenchGetTickUs();
+    const PRO_INT64 timeoutUs =
+        ((PRO_INT64)configInfo.bench_duration * 1000 + READY_TIMEOUT_MS) * 1000;
+    PRO_INT64       stopUs    = startUs;
+    bool            done      = false;
+    bool            broken    = false;
+
+    while (c == 2 && !done && !broken && stopUs - startUs < timeoutUs)
+    {
+        ProSleep(1);
+
+        done = true;
+
+        for (i = 0; i < c; ++i)
+        {
+            if (peers[i]->IsBroken())
+            {
+                broken = true;
+            }
+            if (!peers[i]->IsDone())
+            {
+                done = false;
+            }
+        }
+
+        stopUs = BenchGetTickUs();
+    }
+
+    CProStlSet<IProConnector*>           connectors;
+    CProStlMap<IProSslHandshaker*, bool> handshakers;
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        peers       = m_peers;
+        connectors  = m_connectors;
+        handshakers = m_handshakers;
+        m_peers.clear();
+        m_connectors.clear();
+        m_handshakers.clear();
+        m_reactor      = NULL;
+        m_serverConfig = NULL;
+        m_clientConfig = NULL;
+    }
+
+    CProStlSet<IProConnector*>::const_iterator       itr = connectors.begin();
+    CProStlSet<IProConnector*>::const_iterator const end = connectors.end();
+
+    for (; itr != end; ++itr)
+    {
+        ProDeleteConnector(*itr);
+    }
+
+    CProStlMap<IProSslHandshaker*, bool>::const_iterator       itr2 =
+        handshakers.begin();
+    CProStlMap<IProSslHandshaker*, bool>::const_iterator const end2 =
+        handshakers.end();
+
+    for (; itr2 != end2; ++itr2)
+    {
+        ProDeleteSslHandshaker(itr2->first);
+    }
+
+    ProDeleteAcceptor(acceptor);
+
+    /*
+     * collect the results before closing anything, or the peers would see
+     * the remote close and report themselves broken
+     */
+    unsigned long brokenCount = 0;
+
+    for (i = 0; i < (int)peers.size(); ++i)
+    {
+        mismatchCount += peers[i]->GetMismatchCount();
+        ktlsDirs      += (peers[i]->GetKtls() & PRO_SSL_KTLS_TX) != 0 ? 1 : 0;
+        ktlsDirs      += (peers[i]->GetKtls() & PRO_SSL_KTLS_RX) != 0 ? 1 : 0;
+        if (peers[i]->IsBroken())
+        {
+            ++brokenCount;
+        }
+    }
+
+    for (i = 0; i < (int)peers.size(); ++i)
+    {
+        peers[i]->Fini();
+        peers[i]->Release();
+    }
+
+    ProSslServerConfig_Delete(serverConfig);
+    ProSslClientConfig_Delete(clientConfig);
+
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        m_errorCount += brokenCount;
+    }
+
+    const double seconds = (stopUs - startUs) / 1000000.0;
+    if (done && seconds > 0)
+    {
+        mbps = m_streamSize * 2 * 8 / seconds / 1000000;
+    }
+
+    return (done);
+}
+
+void
+CBenchSslTput::AddHandshaker(bool      client,
+                             PRO_INT64 sockId,
+                             bool      unixSocket)
+{
+    CProThreadMutexGuard mon(m_lock);
+
+    if (m_reactor == NULL)
+    {
+        ProCloseSockId(sockId);
+
+        return;
+    }
+
+    PRO_SSL_CTX* const ctx = client
+        ? ProSslCtx_Createc(m_clientConfig, m_sni.c_str(), sockId, NULL)
+        : ProSslCtx_Creates(m_serverConfig, sockId, NULL);
+    if (ctx == NULL)
+    {
+        ProCloseSockId(sockId);
+        ++m_errorCount;
+
+        return;
+    }
+
+    IProSslHandshaker* const handshaker = ProCreateSslHandshaker(
+        this, m_reactor, ctx, sockId, unixSocket, NULL, 0, 0, false,
+        CONNECT_TIMEOUT);
+    if (handshaker == NULL)
+    {
+        ProSslCtx_Delete(ctx);
+        ProCloseSockId(sockId);
+        ++m_errorCount;
+
+        return;
+    }
+
+    m_handshakers[handshaker] = client;
+}
+
+void
+PRO_CALLTYPE
+CBenchSslTput::OnAccept(IProAcceptor*    acceptor,
+                        PRO_INT64        sockId,
+                        bool             unixSocket,
+                        const char*      remoteIp,
+                        unsigned short   remotePort,
+                        unsigned char    serviceId,
+                        unsigned char    serviceOpt,
+                        const PRO_NONCE* nonce)
+{
+    AddHandshaker(false, sockId, unixSocket);
+}
+
+void
+PRO_CALLTYPE
+CBenchSslTput::OnConnectOk(IProConnector*   connector,
+                           PRO_INT64        sockId,
+                           bool             unixSocket,
+                           const char*      remoteIp,
+                           unsigned short   remotePort,
+                           unsigned char    serviceId,
+                           unsigned char    serviceOpt,
+                           const PRO_NONCE* nonce)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_connectors.find(connector) == m_connectors.end())
+        {
+            ProCloseSockId(sockId);
+
+            return;
+        }
+
+        m_connectors.erase(connector);
+    }
+
+    ProDeleteConnector(connector);
+
+    AddHandshaker(true, sockId, unixSocket);
+}
+
+void
+PRO_CALLTYPE
+CBenchSslTput::OnConnectError(IProConnector* connector,
+                              const char*    remoteIp,
+                              unsigned short remotePort,
+                              unsigned char  serviceId,
+                              unsigned char  serviceOpt,
+                              bool           timeout)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_connectors.find(connector) == m_connectors.end())
+        {
+            return;
+        }
+
+        m_connectors.erase(connector);
+        ++m_errorCount;
+    }
+
+    ProDeleteConnector(connector);
+}
+
+void
+PRO_CALLTYPE
+CBenchSslTput::OnHandshakeOk(IProSslHandshaker* handshaker,
+                             PRO_SSL_CTX*       ctx,
+                             PRO_INT64          sockId,
+                             bool               unixSocket,
+                             const void*        buf,
+                             unsigned long      size)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        CProStlMap<IProSslHandshaker*, bool>::iterator const itr =
+            m_handshakers.find(handshaker);
+        if (itr == m_handshakers.end())
+        {
+            ProSslCtx_Delete(ctx);
+            ProCloseSockId(sockId);
+
+            return;
+        }
+
+        const bool client = itr->second;
+        m_handshakers.erase(itr);
+
+        CBenchSslPeer* const peer =
+            CBenchSslPeer::CreateInstance(client, m_streamSize);
+        if (!peer->Init(m_reactor, ctx, sockId, unixSocket))
+        {
+            peer->Release();
+            ProSslCtx_Delete(ctx);
+            ProCloseSockId(sockId);
+            ++m_errorCount;
+        }
+        else
+        {
+            m_peers.push_back(peer);
+        }
+    }
+
+    ProDeleteSslHandshaker(handshaker);
+}
+
+void
+PRO_CALLTYPE
+CBenchSslTput::OnHandshakeError(IProSslHandshaker* handshaker,
+                                long               errorCode,
+                                long               sslCode)
+{
+    {
+        CProThreadMutexGuard mon(m_lock);
+
+        if (m_handshakers.find(handshaker) == m_handshakers.end())
+        {
+            return;
+        }
+
+        m_handshakers.erase(handshaker);
+        ++m_errorCount;
+    }
+
+    ProDeleteSslHandshaker(handshaker);
+}
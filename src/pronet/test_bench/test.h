@@ -0,0 +1,1207 @@
+/*
+ * Copyright (C) 2018-2019 Eric Tung <libpronet@gmail.com>
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"),
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This file is part of LibProNet (https://github.com/libpronet/libpronet)
+ */
+
+#if !defined(TEST_H)
+#define TEST_H
+
+#include "../pro_net/pro_net.h"
+#include "../pro_net/pro_ssl.h"
+#include "../pro_rtp/rtp_base.h"
+#include "../pro_rtp/rtp_msg.h"
+#include "../pro_util/pro_config_stream.h"
+#include "../pro_util/pro_memory_pool.h"
+#include "../pro_util/pro_ref_count.h"
+#include "../pro_util/pro_stl.h"
+#include "../pro_util/pro_thread_mutex.h"
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+struct BENCH_CONFIG_INFO
+{
+    BENCH_CONFIG_INFO()
+    {
+        bench_thread_count       = 4;
+        bench_io_uring           = 0;
+        bench_duration           = 5;
+        bench_tolerance          = 10;
+
+        bench_conn_count         = 5000;
+        bench_conn_pending_count = 100;
+
+        bench_echo_conn_count    = 16;
+        bench_echo_msg_size      = 1024;
+        bench_echo_window        = 8;
+
+        bench_rtp_packet_rate    = 20000;
+        bench_rtp_packet_size    = 1024;
+
+        bench_msg_hub_port       = 3900;
+        bench_msg_recver_count   = 100;
+        bench_msg_rate           = 200;
+        bench_msg_size           = 256;
+
+        bench_hash_entry_count   = 1000000;
+
+        bench_task_command_count = 200000;
+
+        bench_parse_packet_count = 1000000;
+
+        bench_crypto_record_size = 16384;
+
+        bench_ssl_stream_size    = 64;
+        bench_ssl_cafile         = "./ca.crt";
+        bench_ssl_certfile       = "./server.crt";
+        bench_ssl_keyfile        = "./server.key";
+        bench_ssl_sni            = "server.libpro.org";
+    }
+
+    void ToConfigs(CProStlVector<PRO_CONFIG_ITEM>& configs) const
+    {
+        CProConfigStream configStream;
+
+        configStream.AddUint("bench_thread_count"      , bench_thread_count);
+        configStream.AddUint("bench_io_uring"          , bench_io_uring);
+        configStream.AddUint("bench_duration"          , bench_duration);
+        configStream.AddUint("bench_tolerance"         , bench_tolerance);
+
+        configStream.AddUint("bench_conn_count"        , bench_conn_count);
+        configStream.AddUint("bench_conn_pending_count", bench_conn_pending_count);
+
+        configStream.AddUint("bench_echo_conn_count"   , bench_echo_conn_count);
+        configStream.AddUint("bench_echo_msg_size"     , bench_echo_msg_size);
+        configStream.AddUint("bench_echo_window"       , bench_echo_window);
+
+        configStream.AddUint("bench_rtp_packet_rate"   , bench_rtp_packet_rate);
+        configStream.AddUint("bench_rtp_packet_size"   , bench_rtp_packet_size);
+
+        configStream.AddUint("bench_msg_hub_port"      , bench_msg_hub_port);
+        configStream.AddUint("bench_msg_recver_count"  , bench_msg_recver_count);
+        configStream.AddUint("bench_msg_rate"          , bench_msg_rate);
+        configStream.AddUint("bench_msg_size"          , bench_msg_size);
+
+        configStream.AddUint("bench_hash_entry_count"  , bench_hash_entry_count);
+
+        configStream.AddUint("bench_task_command_count", bench_task_command_count);
+
+        configStream.AddUint("bench_parse_packet_count", bench_parse_packet_count);
+
+        configStream.AddUint("bench_crypto_record_size", bench_crypto_record_size);
+
+        configStream.AddUint("bench_ssl_stream_size"   , bench_ssl_stream_size);
+        configStream.Add    ("bench_ssl_cafile"        , bench_ssl_cafile);
+        configStream.Add    ("bench_ssl_certfile"      , bench_ssl_certfile);
+        configStream.Add    ("bench_ssl_keyfile"       , bench_ssl_keyfile);
+        configStream.Add    ("bench_ssl_sni"           , bench_ssl_sni);
+
+        configStream.Get(configs);
+    }
+
+    unsigned int   bench_thread_count;       /* 1 ~ 100 */
+    unsigned int   bench_io_uring;           /* 0 ~ 1. Linux only */
+    unsigned int   bench_duration;           /* seconds per scenario */
+    unsigned int   bench_tolerance;          /* percent. for baseline comparison */
+
+    unsigned int   bench_conn_count;         /* 1 ~ 60000 */
+    unsigned int   bench_conn_pending_count; /* 1 ~ 1000 */
+
+    unsigned int   bench_echo_conn_count;    /* 1 ~ 1000 */
+    unsigned int   bench_echo_msg_size;      /* 16 ~ 65536 */
+    unsigned int   bench_echo_window;        /* 1 ~ 64 */
+
+    unsigned int   bench_rtp_packet_rate;    /* packets per second */
+    unsigned int   bench_rtp_packet_size;    /* 16 ~ 1400 */
+
+    unsigned short bench_msg_hub_port;
+    unsigned int   bench_msg_recver_count;   /* 1 ~ 255 */
+    unsigned int   bench_msg_rate;           /* messages per second */
+    unsigned int   bench_msg_size;           /* 16 ~ 4096 */
+
+    unsigned int   bench_hash_entry_count;   /* 1 ~ 10000000 */
+
+    unsigned int   bench_task_command_count; /* 1 ~ 10000000 */
+
+    unsigned int   bench_parse_packet_count; /* 1 ~ 10000000 */
+
+    unsigned int   bench_crypto_record_size; /* 64 ~ 16384 */
+
+    unsigned int   bench_ssl_stream_size;    /* MB per direction. 1 ~ 4096 */
+    CProStlString  bench_ssl_cafile;
+    CProStlString  bench_ssl_certfile;
+    CProStlString  bench_ssl_keyfile;
+    CProStlString  bench_ssl_sni;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/*
+ * one line of the report. "scenario.metric = value unit"
+ */
+struct BENCH_METRIC
+{
+    BENCH_METRIC()
+    {
+        value        = 0;
+        higherBetter = true;
+    }
+
+    CProStlString scenario;
+    CProStlString metric;
+    double        value;
+    CProStlString unit;
+    bool          higherBetter;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * latency histogram in microseconds.
+ *
+ * 1us steps below 1ms, 10us steps below 10ms, 100us steps below 100ms and
+ * 1ms steps below 10s. the relative error of a percentile is about 1%
+ */
+class CBenchHistogram
+{
+public:
+
+    CBenchHistogram();
+
+    void Reset();
+
+    void Add(PRO_INT64 us);
+
+    void Merge(const CBenchHistogram& other);
+
+    PRO_UINT64 GetCount() const
+    {
+        return (m_count);
+    }
+
+    double GetMean() const;
+
+    PRO_INT64 GetMax() const
+    {
+        return (m_max);
+    }
+
+    PRO_INT64 GetPercentile(double percent) const; /* 0 ~ 100 */
+
+    void ToMetrics(
+        const char*                  scenario,
+        const char*                  prefix,
+        CProStlVector<BENCH_METRIC>& metrics
+        ) const;
+
+private:
+
+    static unsigned long Us2Index(PRO_INT64 us);
+
+    static PRO_INT64 Index2Us(unsigned long index);
+
+private:
+
+    CProStlVector<PRO_UINT32> m_buckets;
+    PRO_UINT64                m_count;
+    double                    m_sum;
+    PRO_INT64                 m_max;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * conn_rate: tcp connections per second to a loopback acceptor
+ *
+ * bulk_conn_rate: the same, with all the targets handed to one bulk
+ * connector at once
+ */
+class CBenchConnRate
+:
+public IProAcceptorObserver,
+public IProConnectorObserver,
+public CProRefCount
+{
+public:
+
+    static CBenchConnRate* CreateInstance(bool bulk); /* bulk_conn_rate if true */
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchConnRate(bool bulk);
+
+    virtual ~CBenchConnRate();
+
+    virtual void PRO_CALLTYPE OnAccept(
+        IProAcceptor*    acceptor,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectOk(
+        IProConnector*   connector,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectError(
+        IProConnector* connector,
+        const char*    remoteIp,
+        unsigned short remotePort,
+        unsigned char  serviceId,
+        unsigned char  serviceOpt,
+        bool           timeout
+        );
+
+    void OnConnectDone(
+        IProConnector* connector,
+        bool           ok
+        );
+
+    void IssueConnectors();
+
+private:
+
+    const bool                            m_bulk;
+    IProReactor*                          m_reactor;
+    IProBulkConnector*                    m_bulkConnector;
+    PRO_INT64                             m_bulkStartUs;
+    unsigned short                        m_port;
+    unsigned long                         m_total;
+    unsigned long                         m_maxPending;
+    unsigned long                         m_issued;
+    unsigned long                         m_okCount;
+    unsigned long                         m_errorCount;
+    CProStlMap<IProConnector*, PRO_INT64> m_connector2StartUs;
+    CProStlVector<PRO_INT64>              m_acceptedSockIds;
+    CBenchHistogram                       m_histogram;
+    CProThreadMutex                       m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * one connection of the echo_tput scenario. the server side echoes bytes,
+ * the client side stamps and measures messages. each connection owns its
+ * histogram, so the recv path takes no shared lock.
+ *
+ * the tcp transport accepts one pending write at a time, so the outgoing
+ * bytes are gathered in m_pending and flushed on OnSend()
+ */
+class CBenchEchoConn : public IProTransportObserver, public CProRefCount
+{
+public:
+
+    static CBenchEchoConn* CreateInstance(
+        bool          client,
+        unsigned long msgSize,
+        unsigned long window
+        );
+
+    bool Init(
+        IProReactor* reactor,
+        PRO_INT64    sockId,
+        bool         unixSocket
+        );
+
+    void Fini();
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+    void Start();
+
+    void Stop();
+
+    bool IsClient() const
+    {
+        return (m_client);
+    }
+
+    bool IsBroken() const
+    {
+        return (m_broken);
+    }
+
+    PRO_UINT64 GetEchoCount() const
+    {
+        return (m_echoCount);
+    }
+
+    const CBenchHistogram& GetHistogram() const
+    {
+        return (m_histogram);
+    }
+
+private:
+
+    CBenchEchoConn(
+        bool          client,
+        unsigned long msgSize,
+        unsigned long window
+        );
+
+    virtual ~CBenchEchoConn();
+
+    virtual void PRO_CALLTYPE OnRecv(
+        IProTransport*          trans,
+        const pbsd_sockaddr_in* remoteAddr
+        );
+
+    virtual void PRO_CALLTYPE OnSend(
+        IProTransport* trans,
+        PRO_UINT64     actionId
+        );
+
+    virtual void PRO_CALLTYPE OnClose(
+        IProTransport* trans,
+        long           errorCode,
+        long           sslCode
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeat(IProTransport* trans)
+    {
+    }
+
+    void AppendMsg();
+
+    void FlushPending();
+
+private:
+
+    const bool          m_client;
+    const unsigned long m_msgSize;
+    const unsigned long m_window;
+    IProTransport*      m_trans;
+    bool                m_running;
+    volatile bool       m_broken;
+    PRO_UINT64          m_echoCount;
+    CBenchHistogram     m_histogram;
+    CProStlString       m_pending;
+    char*               m_buf;
+    CProThreadMutex     m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/*
+ * echo_tput: fixed-size messages echoed over loopback tcp, with a window of
+ * messages in flight per connection
+ */
+class CBenchEchoTput
+:
+public IProAcceptorObserver,
+public IProConnectorObserver,
+public CProRefCount
+{
+public:
+
+    static CBenchEchoTput* CreateInstance();
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchEchoTput();
+
+    virtual ~CBenchEchoTput();
+
+    virtual void PRO_CALLTYPE OnAccept(
+        IProAcceptor*    acceptor,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectOk(
+        IProConnector*   connector,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectError(
+        IProConnector* connector,
+        const char*    remoteIp,
+        unsigned short remotePort,
+        unsigned char  serviceId,
+        unsigned char  serviceOpt,
+        bool           timeout
+        );
+
+    void AddConn(
+        bool      client,
+        PRO_INT64 sockId,
+        bool      unixSocket
+        );
+
+private:
+
+    IProReactor*                   m_reactor;
+    unsigned long                  m_msgSize;
+    unsigned long                  m_window;
+    unsigned long                  m_errorCount;
+    CProStlSet<IProConnector*>     m_connectors;
+    CProStlVector<CBenchEchoConn*> m_conns;
+    CProThreadMutex                m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * rtp_pps: paced rtp packets from a udp client session to a udp server
+ * session. the one-way delay is measured with the shared process clock
+ */
+class CBenchRtpPps : public IRtpSessionObserver, public IProOnTimer, public CProRefCount
+{
+public:
+
+    static CBenchRtpPps* CreateInstance(bool dtls); /* dtls_pps if true */
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchRtpPps(bool dtls);
+
+    virtual ~CBenchRtpPps();
+
+    virtual void PRO_CALLTYPE OnOkSession(IRtpSession* session)
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnRecvSession(
+        IRtpSession* session,
+        IRtpPacket*  packet
+        );
+
+    virtual void PRO_CALLTYPE OnSendSession(
+        IRtpSession* session,
+        bool         packetErased
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnCloseSession(
+        IRtpSession* session,
+        long         errorCode,
+        long         sslCode,
+        bool         tcpConnected
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeatSession(
+        IRtpSession* session,
+        PRO_INT64    peerAliveTick
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+private:
+
+    const bool      m_dtls;
+    IProReactor*    m_reactor;
+    IRtpSession*    m_sender;
+    IRtpSession*    m_recver;
+    PRO_UINT64      m_timerId;
+    unsigned long   m_packetRate;
+    unsigned long   m_packetSize;
+    PRO_INT64       m_startUs;
+    PRO_UINT64      m_sentCount;
+    PRO_UINT64      m_busyCount;
+    PRO_UINT64      m_recvCount;
+    PRO_UINT16      m_sequence;
+    bool            m_running;
+    bool            m_broken;
+    CBenchHistogram m_histogram;
+    CProThreadMutex m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * msg_fanout: one msg client sends to many msg clients through an in-process
+ * msg server behind an in-process service hub
+ */
+class CBenchMsgFanout
+:
+public IRtpMsgServerObserver,
+public IRtpMsgClientObserver,
+public IProOnTimer,
+public CProRefCount
+{
+public:
+
+    static CBenchMsgFanout* CreateInstance();
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchMsgFanout();
+
+    virtual ~CBenchMsgFanout();
+
+    virtual bool PRO_CALLTYPE OnCheckUser(
+        IRtpMsgServer*      msgServer,
+        const RTP_MSG_USER* user,
+        const char*         userPublicIp,
+        const RTP_MSG_USER* c2sUser,
+        const char          hash[32],
+        const char          nonce[32],
+        PRO_UINT64*         userId,
+        PRO_UINT16*         instId,
+        PRO_INT64*          appData,
+        bool*               isC2s
+        );
+
+    virtual void PRO_CALLTYPE OnOkUser(
+        IRtpMsgServer*      msgServer,
+        const RTP_MSG_USER* user,
+        const char*         userPublicIp,
+        const RTP_MSG_USER* c2sUser,
+        PRO_INT64           appData
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnCloseUser(
+        IRtpMsgServer*      msgServer,
+        const RTP_MSG_USER* user,
+        long                errorCode,
+        long                sslCode
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnHeartbeatUser(
+        IRtpMsgServer*      msgServer,
+        const RTP_MSG_USER* user,
+        PRO_INT64           peerAliveTick
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnRecvMsg(
+        IRtpMsgServer*      msgServer,
+        const void*         buf,
+        unsigned long       size,
+        PRO_UINT16          charset,
+        const RTP_MSG_USER* srcUser
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnOkMsg(
+        IRtpMsgClient*      msgClient,
+        const RTP_MSG_USER* myUser,
+        const char*         myPublicIp
+        );
+
+    virtual void PRO_CALLTYPE OnRecvMsg(
+        IRtpMsgClient*      msgClient,
+        const void*         buf,
+        unsigned long       size,
+        PRO_UINT16          charset,
+        const RTP_MSG_USER* srcUser
+        );
+
+    virtual void PRO_CALLTYPE OnCloseMsg(
+        IRtpMsgClient* msgClient,
+        long           errorCode,
+        long           sslCode,
+        bool           tcpConnected
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeatMsg(
+        IRtpMsgClient* msgClient,
+        PRO_INT64      peerAliveTick
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnTimer(
+        void*      factory,
+        PRO_UINT64 timerId,
+        PRO_INT64  userData
+        );
+
+private:
+
+    IProReactor*                 m_reactor;
+    IProServiceHub*              m_hub;
+    IRtpMsgServer*               m_msgServer;
+    IRtpMsgClient*               m_sender;
+    CProStlVector<RTP_MSG_USER>  m_dstUsers;
+    CProStlSet<IRtpMsgClient*>   m_recvers;
+    PRO_UINT64                   m_timerId;
+    unsigned long                m_msgRate;
+    unsigned long                m_msgSize;
+    unsigned long                m_okCount;
+    PRO_INT64                    m_startUs;
+    PRO_UINT64                   m_sentCount;
+    PRO_UINT64                   m_busyCount;
+    PRO_UINT64                   m_recvCount;
+    bool                         m_running;
+    bool                         m_broken;
+    char*                        m_buf;
+    CBenchHistogram              m_histogram;
+    CProThreadMutex              m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * tcp_resume: a tcp_ex session through an in-process rtp service is dropped
+ * and resumed, with the sequence numbers and the statistics checked. then a
+ * raw prober goes through the resume handshake by hand. it tries to take over
+ * a live session, and to resume with a wrong mac and with an unknown token.
+ * at last, a detached session is left to expire
+ */
+class CBenchTcpResume
+:
+public IRtpServiceObserver,
+public IRtpSessionObserver,
+public IProConnectorObserver,
+public IProTcpHandshakerObserver,
+public CProRefCount
+{
+public:
+
+    static CBenchTcpResume* CreateInstance();
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchTcpResume();
+
+    virtual ~CBenchTcpResume();
+
+    IRtpSession* Login(unsigned short port);
+
+    void SendBatch(
+        IRtpSession*  client,
+        unsigned long count
+        );
+
+    void WaitRecv();
+
+    /*
+     * returns PROBE_OK if the server answers, PROBE_REFUSED if it closes the
+     * connection, and PROBE_TIMEOUT otherwise. the connection answered is
+     * kept open in "sockId"
+     */
+    int Probe(
+        unsigned short   port,
+        const char       resumeToken[16], /* NULL for a login */
+        const char       macToken[16],    /* the token of the mac */
+        PRO_INT64&       sockId,
+        RTP_SESSION_ACK& ack,
+        PRO_NONCE&       nonce
+        );
+
+    virtual void PRO_CALLTYPE OnAcceptSession(
+        IRtpService*            service,
+        PRO_INT64               sockId,
+        bool                    unixSocket,
+        const char*             remoteIp,
+        unsigned short          remotePort,
+        const RTP_SESSION_INFO* remoteInfo,
+        const PRO_NONCE*        nonce
+        );
+
+    virtual void PRO_CALLTYPE OnAcceptSession(
+        IRtpService*            service,
+        PRO_SSL_CTX*            sslCtx,
+        PRO_INT64               sockId,
+        bool                    unixSocket,
+        const char*             remoteIp,
+        unsigned short          remotePort,
+        const RTP_SESSION_INFO* remoteInfo,
+        const PRO_NONCE*        nonce
+        );
+
+    virtual void PRO_CALLTYPE OnOkSession(IRtpSession* session)
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnRecvSession(
+        IRtpSession* session,
+        IRtpPacket*  packet
+        );
+
+    virtual void PRO_CALLTYPE OnSendSession(
+        IRtpSession* session,
+        bool         packetErased
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnCloseSession(
+        IRtpSession* session,
+        long         errorCode,
+        long         sslCode,
+        bool         tcpConnected
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeatSession(
+        IRtpSession* session,
+        PRO_INT64    peerAliveTick
+        )
+    {
+    }
+
+    virtual void PRO_CALLTYPE OnConnectOk(
+        IProConnector*   connector,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectError(
+        IProConnector* connector,
+        const char*    remoteIp,
+        unsigned short remotePort,
+        unsigned char  serviceId,
+        unsigned char  serviceOpt,
+        bool           timeout
+        );
+
+    virtual void PRO_CALLTYPE OnHandshakeOk(
+        IProTcpHandshaker* handshaker,
+        PRO_INT64          sockId,
+        bool               unixSocket,
+        const void*        buf,
+        unsigned long      size
+        );
+
+    virtual void PRO_CALLTYPE OnHandshakeError(
+        IProTcpHandshaker* handshaker,
+        long               errorCode
+        );
+
+private:
+
+    IProReactor*                        m_reactor;
+    IRtpSession*                        m_client;
+    IRtpSession*                        m_server;   /* the peer of m_client */
+    CProStlVector<IRtpSession*>         m_servers;
+    CProStlMap<IRtpSession*, PRO_INT64> m_closeUs;
+    PRO_UINT16                          m_sendSequence;
+    PRO_UINT16                          m_recvSequence;
+    PRO_UINT64                          m_recvCount;
+    PRO_UINT64                          m_seqErrorCount;
+
+    IProConnector*                      m_connector;
+    IProTcpHandshaker*                  m_handshaker;
+    bool                                m_probeResume;
+    char                                m_probeToken[16];
+    char                                m_probeMacToken[16];
+    char                                m_probeUserData[64];
+    PRO_NONCE                           m_probeNonce;
+    RTP_SESSION_ACK                     m_probeAck;
+    PRO_INT64                           m_probeSockId;
+    int                                 m_probeResult;
+    CProThreadMutex                     m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * stl_hash: CProStlHashMap against CProStlMap, with 64-bit ids, pointers and
+ * RTP_MSG_USER keys. no reactor is involved
+ */
+class CBenchStlHash
+{
+public:
+
+    static bool Run(
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+};
+
+/*
+ * task_pool: CProFunctorCommandTaskPool against CProFunctorCommandTask, with
+ * keyed commands of a few microseconds each. the order per key is checked
+ */
+class CBenchTaskPool
+{
+public:
+
+    static bool Run(
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+};
+
+/*
+ * task_mpsc: CProFunctorCommandTask with the lock-free queue against the
+ * locked one, with 1 ~ 64 producer threads and empty commands
+ */
+class CBenchTaskMpsc
+{
+public:
+
+    static bool Run(
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+};
+
+/*
+ * rtp_parse: ParseRtpStreams() over whole batches against one stream per
+ * call, which takes the scalar path. the streams are fuzzed, and the results
+ * of both ways must be the same
+ */
+class CBenchRtpParse
+{
+public:
+
+    static bool Run(
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+};
+
+/*
+ * crypto_tput: seals TLS-sized records with the ciphers of the default suites,
+ * through the portable code against the accelerated one (AES-NI/PCLMUL, SIMD
+ * ChaCha20, 64-bit Poly1305). the results of both ways must be the same
+ */
+class CBenchCryptoTput
+{
+public:
+
+    static bool Run(
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+/*
+ * one side of ssl_tput. it sends a generated stream, and checks the stream
+ * received against the generator of the other side, so the transcript is
+ * verified byte by byte whichever record layer carries it.
+ *
+ * the ssl transport accepts one pending write at a time, so the next chunk is
+ * sent on OnSend()
+ */
+class CBenchSslPeer : public IProTransportObserver, public CProRefCount
+{
+public:
+
+    static CBenchSslPeer* CreateInstance(
+        bool       client,
+        PRO_UINT64 streamSize
+        );
+
+    bool Init(
+        IProReactor* reactor,
+        PRO_SSL_CTX* ctx,
+        PRO_INT64    sockId,
+        bool         unixSocket
+        );
+
+    void Fini();
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+    void Start();
+
+    bool IsDone() const;
+
+    bool IsBroken() const
+    {
+        return (m_broken);
+    }
+
+    PRO_UINT64 GetMismatchCount() const
+    {
+        return (m_mismatchCount);
+    }
+
+    /*
+     * PRO_SSL_KTLS_TX | PRO_SSL_KTLS_RX
+     */
+    unsigned long GetKtls() const;
+
+private:
+
+    CBenchSslPeer(
+        bool       client,
+        PRO_UINT64 streamSize
+        );
+
+    virtual ~CBenchSslPeer();
+
+    virtual void PRO_CALLTYPE OnRecv(
+        IProTransport*          trans,
+        const pbsd_sockaddr_in* remoteAddr
+        );
+
+    virtual void PRO_CALLTYPE OnSend(
+        IProTransport* trans,
+        PRO_UINT64     actionId
+        );
+
+    virtual void PRO_CALLTYPE OnClose(
+        IProTransport* trans,
+        long           errorCode,
+        long           sslCode
+        );
+
+    virtual void PRO_CALLTYPE OnHeartbeat(IProTransport* trans)
+    {
+    }
+
+    void SendChunk();
+
+private:
+
+    const bool              m_client;
+    const PRO_UINT64        m_streamSize;
+    IProTransport*          m_trans;
+    bool                    m_running;
+    volatile bool           m_broken;
+    PRO_UINT64              m_sentBytes;
+    PRO_UINT64              m_recvBytes;
+    PRO_UINT64              m_mismatchCount; /* chunks */
+    char*                   m_sendBuf;
+    char*                   m_recvBuf;
+    char*                   m_expectBuf;
+    mutable CProThreadMutex m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/*
+ * ssl_tput: a stream each way over a loopback tls connection, through the
+ * mbedtls record layer and then through kernel TLS. where the kernel has no
+ * tls support, the second pass falls back to mbedtls, and the "ktls_dirs"
+ * metric says so
+ */
+class CBenchSslTput
+:
+public IProAcceptorObserver,
+public IProConnectorObserver,
+public IProSslHandshakerObserver,
+public CProRefCount
+{
+public:
+
+    static CBenchSslTput* CreateInstance();
+
+    bool Run(
+        IProReactor*                 reactor,
+        const BENCH_CONFIG_INFO&     configInfo,
+        CProStlVector<BENCH_METRIC>& metrics
+        );
+
+    virtual unsigned long PRO_CALLTYPE AddRef();
+
+    virtual unsigned long PRO_CALLTYPE Release();
+
+private:
+
+    CBenchSslTput();
+
+    virtual ~CBenchSslTput();
+
+    bool RunPass(
+        IProReactor*             reactor,
+        const BENCH_CONFIG_INFO& configInfo,
+        bool                     ktls,
+        double&                  mbps,
+        unsigned long&           ktlsDirs,
+        PRO_UINT64&              mismatchCount
+        );
+
+    virtual void PRO_CALLTYPE OnAccept(
+        IProAcceptor*    acceptor,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectOk(
+        IProConnector*   connector,
+        PRO_INT64        sockId,
+        bool             unixSocket,
+        const char*      remoteIp,
+        unsigned short   remotePort,
+        unsigned char    serviceId,
+        unsigned char    serviceOpt,
+        const PRO_NONCE* nonce
+        );
+
+    virtual void PRO_CALLTYPE OnConnectError(
+        IProConnector* connector,
+        const char*    remoteIp,
+        unsigned short remotePort,
+        unsigned char  serviceId,
+        unsigned char  serviceOpt,
+        bool           timeout
+        );
+
+    virtual void PRO_CALLTYPE OnHandshakeOk(
+        IProSslHandshaker* handshaker,
+        PRO_SSL_CTX*       ctx,
+        PRO_INT64          sockId,
+        bool               unixSocket,
+        const void*        buf,
+        unsigned long      size
+        );
+
+    virtual void PRO_CALLTYPE OnHandshakeError(
+        IProSslHandshaker* handshaker,
+        long               errorCode,
+        long               sslCode
+        );
+
+    void AddHandshaker(
+        bool      client,
+        PRO_INT64 sockId,
+        bool      unixSocket
+        );
+
+private:
+
+    IProReactor*                         m_reactor;
+    PRO_SSL_SERVER_CONFIG*               m_serverConfig;
+    PRO_SSL_CLIENT_CONFIG*               m_clientConfig;
+    CProStlString                        m_sni;
+    PRO_UINT64                           m_streamSize;
+    unsigned long                        m_errorCount;
+    CProStlSet<IProConnector*>           m_connectors;
+    CProStlMap<IProSslHandshaker*, bool> m_handshakers; /* client or not */
+    CProStlVector<CBenchSslPeer*>        m_peers;
+    CProThreadMutex                      m_lock;
+
+    DECLARE_SGI_POOL(0)
+};
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+PRO_INT64
+BenchGetTickUs();
+
+/////////////////////////////////////////////////////////////////////////////
+////
+
+#endif /* TEST_H */
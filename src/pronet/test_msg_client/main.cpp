@@ -239,6 +239,23 @@ int main(int argc, char* argv[])
             {
                 configInfo.msgc_ssl_aes256 = atoi(configValue.c_str()) != 0;
             }
+            else if (stricmp(configName.c_str(), "msgc_ssl_lean_buffers") == 0)
+            {
+                configInfo.msgc_ssl_lean_buffers = atoi(configValue.c_str()) != 0;
+            }
+            else if (stricmp(configName.c_str(), "msgc_ssl_ktls") == 0)
+            {
+                configInfo.msgc_ssl_ktls = atoi(configValue.c_str()) != 0;
+            }
+            else if (stricmp(configName.c_str(), "msgc_ssl_max_frag_len") == 0)
+            {
+                const int value = atoi(configValue.c_str());
+                if (value == 0 || value == 512 || value == 1024 ||
+                    value == 2048 || value == 4096)
+                {
+                    configInfo.msgc_ssl_max_frag_len = value;
+                }
+            }
             else
             {
             }
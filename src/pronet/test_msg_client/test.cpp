@@ -152,6 +152,10 @@ CTest::Init(IProReactor*                  reactor,
 
                 ProSslClientConfig_EnableSha1Cert(
                     sslConfig, configInfo.msgc_ssl_enable_sha1cert);
+                ProSslClientConfig_EnableLeanBuffers(
+                    sslConfig, configInfo.msgc_ssl_lean_buffers);
+                ProSslClientConfig_EnableKtls(
+                    sslConfig, configInfo.msgc_ssl_ktls);
 
                 if (!ProSslClientConfig_SetCaList(
                     sslConfig,
@@ -172,6 +176,12 @@ CTest::Init(IProReactor*                  reactor,
                 {
                     goto EXIT;
                 }
+
+                if (!ProSslClientConfig_SetMaxFragLen(
+                    sslConfig, configInfo.msgc_ssl_max_frag_len))
+                {
+                    goto EXIT;
+                }
             }
         }
 
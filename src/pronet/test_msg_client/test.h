@@ -48,6 +48,9 @@ struct MSG_CLIENT_CONFIG_INFO
         msgc_ssl_enable_sha1cert = true;
         msgc_ssl_sni             = "server.libpro.org";
         msgc_ssl_aes256          = false;
+        msgc_ssl_lean_buffers    = false;
+        msgc_ssl_ktls            = false;
+        msgc_ssl_max_frag_len    = 0;
 
         RtpMsgString2User("2-0-0", &msgc_id);
 
@@ -88,6 +91,9 @@ struct MSG_CLIENT_CONFIG_INFO
         configStream.Add    ("msgc_ssl_crlfile"        , msgc_ssl_crlfiles);
         configStream.Add    ("msgc_ssl_sni"            , msgc_ssl_sni);
         configStream.AddInt ("msgc_ssl_aes256"         , msgc_ssl_aes256);
+        configStream.AddInt ("msgc_ssl_lean_buffers"   , msgc_ssl_lean_buffers);
+        configStream.AddInt ("msgc_ssl_ktls"           , msgc_ssl_ktls);
+        configStream.AddUint("msgc_ssl_max_frag_len"   , msgc_ssl_max_frag_len);
 
         configStream.Get(configs);
     }
@@ -107,6 +113,9 @@ struct MSG_CLIENT_CONFIG_INFO
     CProStlVector<CProStlString> msgc_ssl_crlfiles;
     CProStlString                msgc_ssl_sni;
     bool                         msgc_ssl_aes256;
+    bool                         msgc_ssl_lean_buffers;
+    bool                         msgc_ssl_ktls;
+    unsigned int                 msgc_ssl_max_frag_len; /* 0, 512, 1024, 2048, 4096 */
 
     DECLARE_SGI_POOL(0)
 };